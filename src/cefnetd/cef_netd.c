@@ -80,8 +80,25 @@ typedef	enum	{
 	CefC_Connection_Type_Csm,
 	CefC_Connection_Type_Num,
 	CefC_Connection_Type_Local = 99,
+#ifdef CefC_Netd_Reactor
+	CefC_Connection_Type_Accept,				/* TCP listen socket 					*/
+	CefC_Connection_Type_Timer,					/* timerfd for housekeeping 			*/
+	CefC_Connection_Type_Wakeup,				/* eventfd to wake up the main loop 	*/
+#endif // CefC_Netd_Reactor
+#ifdef CefC_Netd_Shmring
+	CefC_Connection_Type_Shmring,				/* eventfd of the rings of an app 		*/
+#endif // CefC_Netd_Shmring
 }	CefC_Connection_Type;
 
+#ifdef CefC_Netd_Reactor
+/* Packs/unpacks the registration into/from epoll_data (type|faceid|fd) 	*/
+#define CefC_Reactor_Data(_type, _faceid, _fd) 				\
+	(((uint64_t)(_type) << 48) | ((uint64_t)(uint16_t)(_faceid) << 32) | (uint32_t)(_fd))
+#define CefC_Reactor_Type(_u64)		((int)((_u64) >> 48))
+#define CefC_Reactor_Faceid(_u64)	((int)(((_u64) >> 32) & 0xFFFF))
+#define CefC_Reactor_Fd(_u64)		((int)((_u64) & 0xFFFFFFFF))
+#endif // CefC_Netd_Reactor
+
 
 #define CefC_App_MatchType_Exact		0
 #define CefC_App_MatchType_Prefix		1
@@ -104,6 +121,73 @@ typedef struct {
 }	CefT_Netd_TxWorker;
 #endif // CefC_TxMultiThread
 
+#ifdef CefC_Netd_RxWorker
+typedef struct {
+	int					worker_id;		/* worker id */
+	CefT_Netd_Handle	*hdl_cefnetd;	/* cefnetd handle */
+	CefT_Rngque* 		rx_que;
+	int					fd_num;
+	int					fds[CefC_RxWorkerFaceMax];			/* sockets of this worker */
+	int					listen_fds[CefC_RxWorkerFaceMax];	/* cloned listen sockets */
+	int					faceids[CefC_RxWorkerFaceMax];
+	uint64_t			rx_packets, drop_packets;
+}	CefT_Netd_RxWorker;
+
+/***** Datagram received by a worker thread 	*****/
+typedef struct {
+	int					fd;				/* FD of the UDP listen face */
+	int					faceid;			/* Face-ID of the UDP listen face */
+	struct sockaddr_storage	sas;		/* source address */
+	socklen_t			sas_len;
+	size_t				msg_len;
+	unsigned char		msg[];
+}	CefT_Rx_Dgram;
+#endif // CefC_Netd_RxWorker
+
+#ifdef CefC_Netd_VerifyWorker
+typedef struct {
+	int					worker_id;		/* worker id */
+	CefT_Netd_Handle	*hdl_cefnetd;	/* cefnetd handle */
+	CefT_Rngque* 		req_que;		/* messages to verify */
+	CefT_Rngque* 		done_que;		/* messages verified */
+	int					inflight;		/* messages in req_que or done_que (main loop only) */
+	pthread_mutex_t		verify_worker_mutex;
+	pthread_cond_t		verify_worker_cond;
+	uint64_t			verify_packets, fail_packets;
+	uint64_t			inline_packets;	/* verified by the main loop since all queues were full */
+}	CefT_Netd_VerifyWorker;
+
+/***** Message whose signature is verified by a worker thread 	*****/
+typedef struct {
+	int					faceid;			/* Face-ID where the message arrived at */
+	int					peer_faceid;	/* Face-ID to reply to the origin of the message */
+	int					fd;				/* FD of the peer Face at the reception */
+	int					res;			/* result of cef_valid_msg_verify */
+	uint16_t			payload_len;
+	uint16_t			header_len;
+	char				user_id[512];
+	unsigned char		msg[];
+}	CefT_Verify_Job;
+#endif // CefC_Netd_VerifyWorker
+
+/***** Messages popped from a TX queue, grouped by the outgoing Face 	*****/
+typedef struct {
+	uint16_t			faceid;
+	int					num;
+	unsigned char*		msgs[CefC_Face_Batch_Max];
+	size_t				lens[CefC_Face_Batch_Max];
+}	CefT_Tx_FaceBatch;
+
+typedef struct {
+	CefT_Mp_Handle 		tx_que_mp;		/* pool of the held elements */
+	int					elem_num;
+	CefT_Tx_Elem*		elems[CefC_Face_Batch_Max];
+	int					face_num;
+	CefT_Tx_FaceBatch	faces[CefC_Face_Batch_Max];
+	uint64_t			tx_packets, tx_bytes;
+	uint64_t			drop_packets, drop_bytes;
+}	CefT_Tx_Batch;
+
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
@@ -138,6 +222,14 @@ static CefT_Netd_TxWorker transmit_worker_hdl[CefC_TxWorkerMax];
 #endif // CefC_TxMultiThread
 static	pthread_t cefnetd_transmit_main_th;
 static	pthread_t cefnetd_cefstatus_th;
+#ifdef CefC_Netd_RxWorker
+static	pthread_t cefnetd_receive_worker_th;
+static CefT_Netd_RxWorker receive_worker_hdl[CefC_RxWorkerMax];
+#endif // CefC_Netd_RxWorker
+#ifdef CefC_Netd_VerifyWorker
+static	pthread_t cefnetd_verify_worker_th;
+static CefT_Netd_VerifyWorker verify_worker_hdl[CefC_VerifyWorkerMax];
+#endif // CefC_Netd_VerifyWorker
 
 static	pthread_mutex_t cefnetd_txqueue_mutex;
 static	pthread_cond_t  cefnetd_txqueue_cond;
@@ -564,6 +656,15 @@ cefnetd_pit_cleanup (
 	CefT_Netd_Handle* hdl, 						/* cefnetd handle						*/
 	uint64_t nowt								/* current time (usec) 					*/
 );
+/*--------------------------------------------------------------------------------------
+	Cleans the PIT entries whose Down Faces or lifetime expired
+----------------------------------------------------------------------------------------*/
+static int										/* Number of the checked entries		*/
+cefnetd_pit_expiry_process (
+	CefT_Netd_Handle* hdl, 						/* cefnetd handle						*/
+	CefT_Hash_Handle pit,						/* PIT									*/
+	uint64_t nowt								/* current time (usec) 					*/
+);
 /*--------------------------------------------------------------------------------------
 	Clean Face entries
 ----------------------------------------------------------------------------------------*/
@@ -638,10 +739,101 @@ cefnetd_incoming_command_process (
 	CefT_CcnMsg_MsgBdy* pm					/* Structure to set parsed CEFORE message	*/
 );
 /*--------------------------------------------------------------------------------------
-	Accepts and receives the frame(s) from local face
+	Handles the local socket which is readable (the listen socket, an application
+	or cefbabeld)
 ----------------------------------------------------------------------------------------*/
 static int									/* No care now								*/
 cefnetd_input_from_local_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int fd, 								/* FD which is readable						*/
+	int faceid								/* Face-ID of the FD						*/
+);
+/*--------------------------------------------------------------------------------------
+	Accepts the connections from local processes
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_accept_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int sock								/* FD of the local listen socket			*/
+);
+/*--------------------------------------------------------------------------------------
+	Receives the frame(s) from the application which is readable
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_app_input_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int index								/* index of the application in app_fds		*/
+);
+/*--------------------------------------------------------------------------------------
+	Handles the bytes received from the application via the socket or the rings
+----------------------------------------------------------------------------------------*/
+static int									/* negative if the application is closed	*/
+cefnetd_local_app_msg_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int index,								/* index of the application in app_fds		*/
+	unsigned char* buff,					/* received bytes							*/
+	int len									/* length of the bytes						*/
+);
+/*--------------------------------------------------------------------------------------
+	Closes the connection from the application
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_app_close (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int index								/* index of the application in app_fds		*/
+);
+/*--------------------------------------------------------------------------------------
+	Creates the rings shared with the application, and passes them over the socket
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_shmring_attach (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int index								/* index of the application in app_fds		*/
+);
+#ifdef CefC_Netd_Shmring
+/*--------------------------------------------------------------------------------------
+	Handles the frames which the application has put into the rings
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_shmring_input_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int fd, 								/* eventfd of the rings						*/
+	int faceid								/* Face-ID of the application				*/
+);
+/*--------------------------------------------------------------------------------------
+	Reads the frames in the rings up to the specified number of reads
+----------------------------------------------------------------------------------------*/
+static int									/* negative if the application is closed, 	*/
+											/* 0 if the rings are empty					*/
+cefnetd_local_shmring_drain (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int index,								/* index of the application in app_fds		*/
+	CefT_Shmring* shm,						/* rings of the application					*/
+	int max_segs							/* maximum number of reads					*/
+);
+#endif // CefC_Netd_Shmring
+/*--------------------------------------------------------------------------------------
+	Sends the response to the control message to the local process
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_response_send (
+	int fd,									/* FD of the local process					*/
+	unsigned char* rsp_msg,					/* response									*/
+	int rsp_len								/* length of the response					*/
+);
+/*--------------------------------------------------------------------------------------
+	Accepts the connection from cefbabeld
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_babel_accept_process (
+	CefT_Netd_Handle* hdl,					/* cefnetd handle							*/
+	int sock								/* FD of the cefbabeld listen socket		*/
+);
+/*--------------------------------------------------------------------------------------
+	Receives the frame from cefbabeld
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_babel_input_process (
 	CefT_Netd_Handle* hdl					/* cefnetd handle							*/
 );
 
@@ -659,6 +851,7 @@ static int										/* No care now							*/
 	cefnetd_check_state_of_port_use (
 	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
 );
+#ifndef CefC_Netd_Reactor
 /*--------------------------------------------------------------------------------------
 	Prepares the UDP and TCP sockets to be polled
 ----------------------------------------------------------------------------------------*/
@@ -669,6 +862,161 @@ cefnetd_poll_socket_prepare (
 	CefC_Connection_Type fd_type[],
 	int faceids[]
 );
+#endif // CefC_Netd_Reactor
+/*--------------------------------------------------------------------------------------
+	Runs the periodic jobs (PIT/Face cleaning, excache push)
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_housekeeping_process (
+	CefT_Netd_Handle* hdl, 						/* cefnetd handle						*/
+	uint64_t nowt								/* current time (usec) 					*/
+);
+#ifdef CefC_Netd_Reactor
+/*--------------------------------------------------------------------------------------
+	Creates the epoll set, the housekeeping timer and the wakeup event
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cefnetd_reactor_init (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+/*--------------------------------------------------------------------------------------
+	Closes the epoll set, the housekeeping timer and the wakeup event
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_reactor_destroy (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+/*--------------------------------------------------------------------------------------
+	Registers the specified FD to the epoll set
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cefnetd_reactor_fd_add (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int fd,										/* FD to register						*/
+	CefC_Connection_Type type,					/* type of the connection				*/
+	int faceid									/* Face-ID of the FD					*/
+);
+/*--------------------------------------------------------------------------------------
+	Removes the specified FD from the epoll set
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_reactor_fd_del (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int fd										/* FD to remove							*/
+);
+/*--------------------------------------------------------------------------------------
+	Registers the TCP faces which were created after the last call
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_reactor_faces_sync (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+#endif // CefC_Netd_Reactor
+#ifdef CefC_Netd_RecvMmsg
+/*--------------------------------------------------------------------------------------
+	Allocates the buffers for the batched UDP input
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cefnetd_udp_input_batch_init (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+/*--------------------------------------------------------------------------------------
+	Releases the buffers for the batched UDP input
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_udp_input_batch_destroy (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+#endif // CefC_Netd_RecvMmsg
+#ifdef CefC_Netd_RxWorker
+/*--------------------------------------------------------------------------------------
+	Creates the UDP input workers
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cefnetd_receive_workers_start (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+/*--------------------------------------------------------------------------------------
+	Handles the datagrams received by the UDP input workers
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_receive_workers_input_process (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+#endif // CefC_Netd_RxWorker
+#ifdef CefC_Netd_VerifyWorker
+/*--------------------------------------------------------------------------------------
+	Creates the signature verification workers
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cefnetd_verify_workers_start (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+/*--------------------------------------------------------------------------------------
+	Handles the messages whose signatures have been verified by the workers
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_verify_workers_done_process (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+);
+static struct timespec *
+cefnetd_get_waittime(
+	struct timespec *ts,
+	long			wait_us		// micro-seconds
+);
+#endif // CefC_Netd_VerifyWorker
+/*--------------------------------------------------------------------------------------
+	Passes the message signed with a public key to a signature verification worker
+----------------------------------------------------------------------------------------*/
+static int										/* 1 if a worker takes the message, or	*/
+												/* a negative value if it should be		*/
+												/* handled now							*/
+cefnetd_verify_workers_dispatch (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int faceid, 								/* Face-ID where messages arrived at	*/
+	int peer_faceid, 							/* Face-ID to reply to the origin of 	*/
+												/* transmission of the message(s)		*/
+	unsigned char* msg, 						/* received message to handle			*/
+	uint16_t payload_len, 						/* Payload Length of this message		*/
+	uint16_t header_len,						/* Header Length of this message		*/
+	char* user_id
+);
+/*--------------------------------------------------------------------------------------
+	Checks the Validation of the message, reusing the result of the verification
+	worker if the message has come from it
+----------------------------------------------------------------------------------------*/
+static int 										/* If the return value is 0 the code is	*/
+												/* equal, otherwise it is different		*/
+cefnetd_valid_msg_verify (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	const unsigned char* msg,
+	int msg_len
+);
+/*--------------------------------------------------------------------------------------
+	Queues a message to the TX batch of the specified Face
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_tx_batch_add (
+	CefT_Tx_Batch* batch,						/* TX batch								*/
+	uint16_t faceid,							/* Face-ID indicating the destination 	*/
+	unsigned char* msg,							/* a message to send					*/
+	size_t msg_len								/* length of the message to send 		*/
+);
+/*--------------------------------------------------------------------------------------
+	Keeps the TX element until the messages referring to it are sent
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_tx_batch_hold (
+	CefT_Tx_Batch* batch,						/* TX batch								*/
+	CefT_Tx_Elem* tx_elem						/* TX element							*/
+);
+/*--------------------------------------------------------------------------------------
+	Sends the queued messages and frees the held TX elements
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_tx_batch_flush (
+	CefT_Tx_Batch* batch						/* TX batch								*/
+);
 /*--------------------------------------------------------------------------------------
 	Obtains my NodeID (IP Address)
 ----------------------------------------------------------------------------------------*/
@@ -759,6 +1107,99 @@ cefnetd_adv_route_process (
 	CefT_CcnMsg_MsgBdy*	pm				/* Structure to set parsed CEFORE message	*/
 );
 
+/*--------------------------------------------------------------------------------------
+	Queues a message to the TX batch of the specified Face
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_tx_batch_add (
+	CefT_Tx_Batch* batch,						/* TX batch								*/
+	uint16_t faceid,							/* Face-ID indicating the destination 	*/
+	unsigned char* msg,							/* a message to send					*/
+	size_t msg_len								/* length of the message to send 		*/
+) {
+	CefT_Tx_FaceBatch* fb = NULL;
+	int i;
+
+	for (i = 0 ; i < batch->face_num ; i++) {
+		if (batch->faces[i].faceid == faceid) {
+			fb = &batch->faces[i];
+			break;
+		}
+	}
+	if (fb && fb->num == CefC_Face_Batch_Max) {
+		cefnetd_tx_batch_flush (batch);
+		fb = NULL;
+	}
+	if (!fb) {
+		if (batch->face_num == CefC_Face_Batch_Max) {
+			cefnetd_tx_batch_flush (batch);
+		}
+		fb = &batch->faces[batch->face_num++];
+		fb->faceid = faceid;
+		fb->num = 0;
+	}
+	fb->msgs[fb->num] = msg;
+	fb->lens[fb->num] = msg_len;
+	fb->num++;
+}
+/*--------------------------------------------------------------------------------------
+	Keeps the TX element until the messages referring to it are sent
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_tx_batch_hold (
+	CefT_Tx_Batch* batch,						/* TX batch								*/
+	CefT_Tx_Elem* tx_elem						/* TX element							*/
+) {
+	if (batch->elem_num == CefC_Face_Batch_Max) {
+		cefnetd_tx_batch_flush (batch);
+	}
+	batch->elems[batch->elem_num++] = tx_elem;
+}
+/*--------------------------------------------------------------------------------------
+	Sends the queued messages and frees the held TX elements
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_tx_batch_flush (
+	CefT_Tx_Batch* batch						/* TX batch								*/
+) {
+	CefT_Tx_FaceBatch* fb;
+	int i, j, sent;
+	size_t bytes;
+
+	for (i = 0 ; i < batch->face_num ; i++) {
+		fb = &batch->faces[i];
+		for (bytes = 0, j = 0 ; j < fb->num ; j++) {
+			bytes += fb->lens[j];
+		}
+		sent = cef_face_frame_send_batch (fb->faceid, fb->msgs, fb->lens, fb->num);
+		if (sent == fb->num) {
+			batch->tx_packets += fb->num;
+			batch->tx_bytes += bytes;
+			continue;
+		}
+		if (sent < 0) {
+			sent = 0;
+		}
+		cef_log_write (CefC_Log_Warn, "Face#%d lost %d of %d messages, err=%d:%s\n",
+			fb->faceid, (fb->num - sent), fb->num, errno, strerror(errno));
+		/* The messages are sent in order, so the unsent ones are the tail 	*/
+		for (j = sent ; j < fb->num ; j++) {
+			bytes -= fb->lens[j];
+			batch->drop_bytes += fb->lens[j];
+		}
+		batch->tx_packets += sent;
+		batch->tx_bytes += bytes;
+		batch->drop_packets += (fb->num - sent);
+	}
+	batch->face_num = 0;
+
+	for (i = 0 ; i < batch->elem_num ; i++) {
+		/* Free the pooled block 	*/
+		cef_plugin_tx_elem_free (batch->tx_que_mp, batch->elems[i]);
+	}
+	batch->elem_num = 0;
+}
+
 #ifdef CefC_TxMultiThread
 static void *
 cefnetd_transmit_worker_thread (
@@ -820,6 +1261,12 @@ cefnetd_handle_create (
 	hdl->tx_worker_num = CefC_TxWorkerDefault;
 #endif  // CefC_TxMultiThread
 	hdl->tx_que_size = CefC_TxQueueDefault;
+#ifdef CefC_Netd_RxWorker
+	hdl->rx_worker_num = CefC_RxWorkerDefault;
+#endif // CefC_Netd_RxWorker
+#ifdef CefC_Netd_VerifyWorker
+	hdl->verify_worker_num = CefC_VerifyWorkerDefault;
+#endif // CefC_Netd_VerifyWorker
 	hdl->face_lifetime = -1;
 
 	hdl->ccninfo_access_policy = CefC_Default_CcninfoAccessPolicy;
@@ -841,6 +1288,11 @@ cefnetd_handle_create (
 	hdl->Buffer_Cache_Time		= CefC_Default_BUFFER_CACHE_TIME * 1000;
 	hdl->cefstatus_pipe_fd[0]	= -1;
 	hdl->cefstatus_pipe_fd[1]	= -1;
+#ifdef CefC_Netd_Reactor
+	hdl->ep_fd					= -1;
+	hdl->ep_timer_fd			= -1;
+	hdl->ep_wakeup_fd			= -1;
+#endif // CefC_Netd_Reactor
 	//202108
 	hdl->IR_Option				= 0;	//Not
 	memset (hdl->IR_enable, 0, sizeof (hdl->IR_enable));
@@ -951,12 +1403,21 @@ cefnetd_handle_create (
 	cef_pit_init (hdl->ccninfo_reply_timeout, hdl->Symbolic_max_lifetime, hdl->Regular_max_lifetime); //0.8.3
 	hdl->pit = cef_lhash_tbl_create_ext (hdl->pit_max_size, CefC_Hash_Coef_PIT);
 	hdl->pit_clean_t = cef_client_present_timeus_calc () + CefC_Pit_CleaningTime;
+	if (cef_pit_expiry_init (hdl->pit, cef_client_present_timeus_calc ()) < 0) {
+		cef_log_write (CefC_Log_Error, "Failed to cef_pit_expiry_init(pit)\n");
+		/* NG */
+		cefnetd_handle_destroy (hdl);
+		return (NULL);
+	}
 	cef_log_write (CefC_Log_Info, "Creation PIT ... OK\n");
 
 	/* Prepares sockets for applications 	*/
 	for (res = 0 ; res < CefC_App_Conn_Num ; res++) {
 		hdl->app_fds[res] = -1;
 		hdl->app_faces[res] = -1;
+#ifdef CefC_Netd_Shmring
+		hdl->app_shmrings[res] = NULL;
+#endif // CefC_Netd_Shmring
 	}
 	hdl->app_fds_num = 0;
 
@@ -1022,9 +1483,16 @@ cefnetd_handle_create (
 		cefnetd_handle_destroy (hdl);
 		return (NULL);
 	}
+	if (cef_pit_expiry_init (hdl->app_pit, cef_client_present_timeus_calc ()) < 0) {
+		cef_log_write (CefC_Log_Error, "Failed to cef_pit_expiry_init(app_pit)\n");
+		/* NG */
+		cefnetd_handle_destroy (hdl);
+		return (NULL);
+	}
 
 	/* Creates the tx buffer (main)								*/
-	hdl->tx_que = cef_rngque_create (hdl->tx_que_size);	// 100%
+	/* Only cefnetd_transmit_main_thread pops the tx buffers 	*/
+	hdl->tx_que = cef_rngque_create_ext (hdl->tx_que_size, CefC_Rngque_Mpsc);	// 100%
 	if ( !hdl->tx_que ){
 #ifdef CefC_Debug
 		cef_dbg_write (CefC_Dbg_Fine,
@@ -1037,7 +1505,7 @@ cefnetd_handle_create (
 		return (NULL);
 	}
 	/* Creates the tx buffer (priolity:high)					*/
-	hdl->tx_que_high = cef_rngque_create (hdl->tx_que_size);	// 100%
+	hdl->tx_que_high = cef_rngque_create_ext (hdl->tx_que_size, CefC_Rngque_Mpsc);	// 100%
 	if ( !hdl->tx_que_high ){
 #ifdef CefC_Debug
 		cef_dbg_write (CefC_Dbg_Fine,
@@ -1050,7 +1518,7 @@ cefnetd_handle_create (
 		return (NULL);
 	}
 	/* Creates the tx buffer (priolity:low)						*/
-	hdl->tx_que_low = cef_rngque_create ((hdl->tx_que_size * 25) / 100);	// 25%
+	hdl->tx_que_low = cef_rngque_create_ext ((hdl->tx_que_size * 25) / 100, CefC_Rngque_Mpsc);	// 25%
 	if ( !hdl->tx_que_low ){
 #ifdef CefC_Debug
 		cef_dbg_write (CefC_Dbg_Fine,
@@ -1065,7 +1533,7 @@ cefnetd_handle_create (
 #ifdef CefC_TxMultiThread
 	for (int i = 0; i < hdl->tx_worker_num; i++ ){
 		int		worker_que_size = hdl->tx_que_size / hdl->tx_worker_num;
-		hdl->tx_worker_que[i] = cef_rngque_create (worker_que_size);
+		hdl->tx_worker_que[i] = cef_rngque_create_ext (worker_que_size, CefC_Rngque_Spsc);
 		if ( !hdl->tx_worker_que[i] ){
 #ifdef CefC_Debug
 			cef_dbg_write (CefC_Dbg_Fine,
@@ -1282,6 +1750,46 @@ cefnetd_handle_create (
 		}
 	}
 
+#ifdef CefC_Netd_RecvMmsg
+	/* Allocates the buffers for the batched UDP input 	*/
+	if (cefnetd_udp_input_batch_init (hdl) < 0) {
+		cefnetd_handle_destroy (hdl);
+		cef_log_write (CefC_Log_Error, "%s UDP input buffer allocation failed (%s)\n"
+						, __func__, strerror(errno));
+		return (NULL);
+	}
+#endif // CefC_Netd_RecvMmsg
+
+#ifdef CefC_Netd_Reactor
+	/* Creates the epoll set for the main loop 		*/
+	if (cefnetd_reactor_init (hdl) < 0) {
+		cefnetd_handle_destroy (hdl);
+		cef_log_write (CefC_Log_Error, "%s Failed to create the epoll set (%s)\n"
+						, __func__, strerror(errno));
+		return (NULL);
+	}
+#endif // CefC_Netd_Reactor
+
+#ifdef CefC_Netd_RxWorker
+	/* Creates the UDP input workers 		*/
+	if (cefnetd_receive_workers_start (hdl) < 0) {
+		cefnetd_handle_destroy (hdl);
+		cef_log_write (CefC_Log_Error
+					, "%s Failed to create the new thread(cefnetd_receive_worker_thread)\n"
+					, __func__);
+		return (NULL);
+	}
+#endif // CefC_Netd_RxWorker
+#ifdef CefC_Netd_VerifyWorker
+	/* Creates the signature verification workers 	*/
+	if (cefnetd_verify_workers_start (hdl) < 0) {
+		cefnetd_handle_destroy (hdl);
+		cef_log_write (CefC_Log_Error
+					, "%s Failed to create the new thread(cefnetd_verify_worker_thread)\n"
+					, __func__);
+		return (NULL);
+	}
+#endif // CefC_Netd_VerifyWorker
 
 	return (hdl);
 }
@@ -1315,10 +1823,50 @@ cefnetd_handle_destroy (
 	cef_rngque_destroy (hdl->tx_que_high);
 	cef_rngque_destroy (hdl->tx_que);
 	cef_mpool_destroy (hdl->tx_que_mp);
+	cef_pit_expiry_destroy (hdl->pit);
+	cef_pit_expiry_destroy (hdl->app_pit);
 
 	pthread_mutex_destroy(&cefnetd_txqueue_mutex);
 	pthread_cond_destroy(&cefnetd_txqueue_cond);
 
+#ifdef CefC_Netd_Reactor
+	cefnetd_reactor_destroy (hdl);
+#endif // CefC_Netd_Reactor
+#ifdef CefC_Netd_RecvMmsg
+	cefnetd_udp_input_batch_destroy (hdl);
+#endif // CefC_Netd_RecvMmsg
+#ifdef CefC_Netd_RxWorker
+	for (int i = 0; i < hdl->rx_worker_num; i++ ){
+		void* rx_dgram;
+		if ( hdl->rx_worker_que[i] ){
+			while ((rx_dgram = cef_rngque_pop (hdl->rx_worker_que[i])) != NULL) {
+				free (rx_dgram);
+			}
+			cef_rngque_destroy (hdl->rx_worker_que[i]);
+			hdl->rx_worker_que[i] = NULL;
+		}
+	}
+#endif // CefC_Netd_RxWorker
+#ifdef CefC_Netd_VerifyWorker
+	for (int i = 0; i < hdl->verify_worker_num; i++ ){
+		void* job;
+		if ( hdl->verify_req_que[i] ){
+			while ((job = cef_rngque_pop (hdl->verify_req_que[i])) != NULL) {
+				free (job);
+			}
+			cef_rngque_destroy (hdl->verify_req_que[i]);
+			hdl->verify_req_que[i] = NULL;
+		}
+		if ( hdl->verify_done_que[i] ){
+			while ((job = cef_rngque_pop (hdl->verify_done_que[i])) != NULL) {
+				free (job);
+			}
+			cef_rngque_destroy (hdl->verify_done_que[i]);
+			hdl->verify_done_que[i] = NULL;
+		}
+	}
+#endif // CefC_Netd_VerifyWorker
+
 	if (hdl->fwd_strtgy_hdl && hdl->fwd_strtgy_hdl->destroy) {
 		hdl->fwd_strtgy_hdl->destroy();
 	}
@@ -1351,6 +1899,25 @@ cefnetd_handle_destroy (
 										transmit_worker_hdl[i].drop_packets);
 	}
 #endif // CefC_TxMultiThread
+#ifdef CefC_Netd_RxWorker
+	for (int i = 0; i < hdl->rx_worker_num; i++ ){
+		cef_dbg_write (CefC_Dbg_Fine,
+			"<STAT> Rx Thread:%02d     = packets "FMTU64" drops "FMTU64" \n",
+										receive_worker_hdl[i].worker_id,
+										receive_worker_hdl[i].rx_packets,
+										receive_worker_hdl[i].drop_packets);
+	}
+#endif // CefC_Netd_RxWorker
+#ifdef CefC_Netd_VerifyWorker
+	for (int i = 0; i < hdl->verify_worker_num; i++ ){
+		cef_dbg_write (CefC_Dbg_Fine,
+			"<STAT> Verify Thread:%02d = packets "FMTU64" fails "FMTU64" inline "FMTU64" \n",
+										verify_worker_hdl[i].worker_id,
+										verify_worker_hdl[i].verify_packets,
+										verify_worker_hdl[i].fail_packets,
+										verify_worker_hdl[i].inline_packets);
+	}
+#endif // CefC_Netd_VerifyWorker
 	cef_dbg_write (CefC_Dbg_Fine,
 		"<STAT> No PIT Frames    = "FMTU64"\n", stat_nopit_frames);
 	cef_dbg_write (CefC_Dbg_Fine,
@@ -1393,38 +1960,422 @@ cefnetd_handle_destroy (
 	cef_log_write (CefC_Log_Info, "Stop\n");
 }
 /*--------------------------------------------------------------------------------------
-	Main Loop Function
+	Runs the periodic jobs (PIT/Face cleaning, excache push)
 ----------------------------------------------------------------------------------------*/
-void
-cefnetd_event_dispatch (
-	CefT_Netd_Handle* hdl 						/* cefnetd handle						*/
+static void
+cefnetd_housekeeping_process (
+	CefT_Netd_Handle* hdl, 						/* cefnetd handle						*/
+	uint64_t nowt								/* current time (usec) 					*/
 ) {
-	int i;
-	int res;
+	/* Cleans PIT entries 		*/
+	cefnetd_pit_cleanup (hdl, nowt);
 
-	uint64_t nowt = cef_client_present_timeus_calc ();
+	/* Cleans Face entries 		*/
+	if ( 0 < hdl->face_lifetime ){
+		cefnetd_faces_cleanup (hdl, nowt);
+	}
 
-	cef_log_write (CefC_Log_Info, "Running\n");
-	cefnetd_running_f = 1;
+#if CefC_IsEnable_ContentStore
+	if ((hdl->cs_stat->cache_type != CefC_Cache_Type_None) &&
+		(nowt > ccninfo_push_time)) {
+		if (hdl->cs_stat->cache_type == CefC_Cache_Type_Excache) {
+			cef_csmgr_excache_item_push (hdl->cs_stat);
+			ccninfo_push_time = nowt + 500000;
+		}
+#ifdef	CefC_CefnetdCache
+		else
+		if (hdl->cs_stat->cache_type == CefC_Cache_Type_Localcache) {
+			; /* NOP */
+		}
+#endif	//CefC_CefnetdCache
+	}
+#endif // CefC_IsEnable_ContentStore
+}
+#ifdef CefC_Netd_Reactor
+/*--------------------------------------------------------------------------------------
+	Creates the epoll set, the housekeeping timer and the wakeup event
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cefnetd_reactor_init (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	struct itimerspec its;
+	int fd;
+	int i;
 
-	struct pollfd fds[CefC_Listen_Face_Max * 2];
-	CefC_Connection_Type fd_type[CefC_Listen_Face_Max * 2];
-	int faceids[CefC_Listen_Face_Max * 2];
-	int fdnum;
+	for (i = 0 ; i < CefC_Face_Router_Max ; i++) {
+		hdl->ep_face_fd[i] = -1;
+	}
 
-	while (cefnetd_running_f) {
+	hdl->ep_fd = epoll_create1 (EPOLL_CLOEXEC);
+	if (hdl->ep_fd < 0) {
+		return (-1);
+	}
+
+	/* Housekeeping timer replaces the checks at every iteration 	*/
+	hdl->ep_timer_fd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (hdl->ep_timer_fd < 0) {
+		return (-1);
+	}
+	memset (&its, 0, sizeof (its));
+	its.it_interval.tv_sec  = CefC_Netd_Reactor_Tick / 1000000;
+	its.it_interval.tv_nsec = (CefC_Netd_Reactor_Tick % 1000000) * 1000;
+	its.it_value = its.it_interval;
+	if (timerfd_settime (hdl->ep_timer_fd, 0, &its, NULL) < 0) {
+		return (-1);
+	}
+	if (cefnetd_reactor_fd_add (
+			hdl, hdl->ep_timer_fd, CefC_Connection_Type_Timer, 0) < 0) {
+		return (-1);
+	}
+
+	hdl->ep_wakeup_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (hdl->ep_wakeup_fd < 0) {
+		return (-1);
+	}
+	if (cefnetd_reactor_fd_add (
+			hdl, hdl->ep_wakeup_fd, CefC_Connection_Type_Wakeup, 0) < 0) {
+		return (-1);
+	}
+
+	/* UDP listen faces do not change after the initialization 	*/
+	for (i = 0 ; i < hdl->inudpfdc ; i++) {
+		if (cefnetd_reactor_fd_add (hdl, hdl->inudpfds[i].fd,
+				CefC_Connection_Type_Udp, hdl->inudpfaces[i]) < 0) {
+			return (-1);
+		}
+		hdl->ep_face_fd[hdl->inudpfaces[i]] = hdl->inudpfds[i].fd;
+	}
+
+	/* TCP listen sockets are accepted when readable 			*/
+	fd = cef_face_get_fd_from_faceid (CefC_Faceid_ListenTcpv4);
+	if (fd > CefC_Fd_Invalid) {
+		if (cefnetd_reactor_fd_add (hdl, fd,
+				CefC_Connection_Type_Accept, CefC_Faceid_ListenTcpv4) < 0) {
+			return (-1);
+		}
+	}
+	fd = cef_face_get_fd_from_faceid (CefC_Faceid_ListenTcpv6);
+	if (fd > CefC_Fd_Invalid) {
+		if (cefnetd_reactor_fd_add (hdl, fd,
+				CefC_Connection_Type_Accept, CefC_Faceid_ListenTcpv6) < 0) {
+			return (-1);
+		}
+	}
+
+	/* Local sockets (applications and cefbabeld) 				*/
+	fd = cef_face_get_fd_from_faceid (CefC_Faceid_Local);
+	if (cefnetd_reactor_fd_add (
+			hdl, fd, CefC_Connection_Type_Local, CefC_Faceid_Local) < 0) {
+		return (-1);
+	}
+	if (hdl->babel_use_f) {
+		fd = cef_face_get_fd_from_faceid (CefC_Faceid_ListenBabel);
+		if (cefnetd_reactor_fd_add (
+				hdl, fd, CefC_Connection_Type_Local, CefC_Faceid_ListenBabel) < 0) {
+			return (-1);
+		}
+	}
+
+#if CefC_IsEnable_ContentStore
+	if (hdl->cs_stat->local_sock != -1) {
+		if (cefnetd_reactor_fd_add (hdl, hdl->cs_stat->local_sock,
+				CefC_Connection_Type_Csm, 0) < 0) {
+			return (-1);
+		}
+	}
+	if (hdl->cs_stat->tcp_sock != -1) {
+		if (cefnetd_reactor_fd_add (hdl, hdl->cs_stat->tcp_sock,
+				CefC_Connection_Type_Csm, 0) < 0) {
+			return (-1);
+		}
+	}
+#endif // CefC_IsEnable_ContentStore
+
+	/* TCP faces created from cefnetd.fib 						*/
+	hdl->ep_face_gen = cef_face_tbl_generation_get () - 1;
+	cefnetd_reactor_faces_sync (hdl);
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Closes the epoll set, the housekeeping timer and the wakeup event
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_reactor_destroy (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	if (hdl->ep_wakeup_fd != -1) {
+		close (hdl->ep_wakeup_fd);
+		hdl->ep_wakeup_fd = -1;
+	}
+	if (hdl->ep_timer_fd != -1) {
+		close (hdl->ep_timer_fd);
+		hdl->ep_timer_fd = -1;
+	}
+	if (hdl->ep_fd != -1) {
+		close (hdl->ep_fd);
+		hdl->ep_fd = -1;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Registers the specified FD to the epoll set
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cefnetd_reactor_fd_add (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int fd,										/* FD to register						*/
+	CefC_Connection_Type type,					/* type of the connection				*/
+	int faceid									/* Face-ID of the FD					*/
+) {
+	struct epoll_event ev;
+
+	if (fd < 0) {
+		return (-1);
+	}
+	memset (&ev, 0, sizeof (ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = CefC_Reactor_Data (type, faceid, fd);
+
+	if (epoll_ctl (hdl->ep_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		/* The FD number was reused before its registration was refreshed 	*/
+		if ((errno != EEXIST) ||
+			(epoll_ctl (hdl->ep_fd, EPOLL_CTL_MOD, fd, &ev) < 0)) {
+			cef_log_write (CefC_Log_Warn, "%s epoll_ctl(fd=%d) error (%s)\n"
+							, __func__, fd, strerror(errno));
+			return (-1);
+		}
+	}
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Removes the specified FD from the epoll set
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_reactor_fd_del (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int fd										/* FD to remove							*/
+) {
+	if (fd < 0) {
+		return;
+	}
+	/* close() does not remove an FD whose file description is still open in	*/
+	/* another process (e.g. an eventfd passed with SCM_RIGHTS) 				*/
+	if (epoll_ctl (hdl->ep_fd, EPOLL_CTL_DEL, fd, NULL) < 0) {
+		cef_log_write (CefC_Log_Warn, "%s epoll_ctl(fd=%d) error (%s)\n"
+						, __func__, fd, strerror(errno));
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Registers the TCP faces which were created after the last call
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_reactor_faces_sync (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	uint32_t gen;
+	int faceid;
+	int i;
+
+	gen = cef_face_tbl_generation_get ();
+	if (gen == hdl->ep_face_gen) {
+		return;
+	}
+	hdl->ep_face_gen = gen;
+
+	/* Closed FDs have already left the epoll set, only forgets them 	*/
+	for (i = 0 ; i < hdl->intcpfdc ; i++) {
+		faceid = hdl->intcpfaces[i];
+		if (cef_face_get_fd_from_faceid (faceid) != hdl->ep_face_fd[faceid]) {
+			hdl->ep_face_fd[faceid] = -1;
+		}
+	}
+
+	cef_face_update_listen_faces (
+			hdl->inudpfds, hdl->inudpfaces, &hdl->inudpfdc,
+			hdl->intcpfds, hdl->intcpfaces, &hdl->intcpfdc);
+
+	for (i = 0 ; i < hdl->intcpfdc ; i++) {
+		faceid = hdl->intcpfaces[i];
+		if (hdl->ep_face_fd[faceid] == hdl->intcpfds[i].fd) {
+			continue;
+		}
+		if (cefnetd_reactor_fd_add (hdl, hdl->intcpfds[i].fd,
+				CefC_Connection_Type_Tcp, faceid) > 0) {
+			hdl->ep_face_fd[faceid] = hdl->intcpfds[i].fd;
+		}
+	}
+}
+#endif // CefC_Netd_Reactor
+/*--------------------------------------------------------------------------------------
+	Wakes up the main loop from other threads
+----------------------------------------------------------------------------------------*/
+void
+cefnetd_event_wakeup (
+	CefT_Netd_Handle* hdl 						/* cefnetd handle						*/
+) {
+#ifdef CefC_Netd_Reactor
+	uint64_t val = 1;
+
+	if (hdl->ep_wakeup_fd != -1) {
+		if (write (hdl->ep_wakeup_fd, &val, sizeof (val)) < 0) {
+			/* NOP: the counter is already non-zero */;
+		}
+	}
+#endif // CefC_Netd_Reactor
+	/* The poll based loop wakes up every 1 msec by itself 	*/
+}
+/*--------------------------------------------------------------------------------------
+	Main Loop Function
+----------------------------------------------------------------------------------------*/
+#ifdef CefC_Netd_Reactor
+void
+cefnetd_event_dispatch (
+	CefT_Netd_Handle* hdl 						/* cefnetd handle						*/
+) {
+	struct epoll_event evs[CefC_Netd_Reactor_Events];
+	uint64_t nowt;
+	uint64_t val;
+	int evnum;
+	int timeout = -1;
+	int type, fd, faceid;
+	int i;
+	int res;
+
+	cef_log_write (CefC_Log_Info, "Running\n");
+	cefnetd_running_f = 1;
+
+	while (cefnetd_running_f) {
+
+		/* Registers the TCP faces created by the previous iteration 	*/
+		cefnetd_reactor_faces_sync (hdl);
+
+		evnum = epoll_wait (hdl->ep_fd, evs, CefC_Netd_Reactor_Events, timeout);
+		if (evnum < 0) {
+			if (errno != EINTR) {
+				cef_log_write (CefC_Log_Error, "%s epoll_wait error (%s)\n"
+								, __func__, strerror(errno));
+			}
+			continue;
+		}
 
 		/* Calculates the present time 						*/
 		nowt = cef_client_present_timeus_calc ();
 		hdl->nowtus = nowt;
 
-		/* Cleans PIT entries 		*/
-		cefnetd_pit_cleanup (hdl, nowt);
+		for (i = 0 ; i < evnum ; i++) {
+			type 	= CefC_Reactor_Type (evs[i].data.u64);
+			faceid 	= CefC_Reactor_Faceid (evs[i].data.u64);
+			fd 		= CefC_Reactor_Fd (evs[i].data.u64);
+
+			switch (type) {
+				case CefC_Connection_Type_Timer: {
+					if (read (fd, &val, sizeof (val)) > 0) {
+						cefnetd_housekeeping_process (hdl, nowt);
+					}
+					break;
+				}
+				case CefC_Connection_Type_Wakeup: {
+					if (read (fd, &val, sizeof (val)) < 0) {
+						/* NOP */;
+					}
+#ifdef CefC_Netd_RxWorker
+					cefnetd_receive_workers_input_process (hdl);
+#endif // CefC_Netd_RxWorker
+#ifdef CefC_Netd_VerifyWorker
+					cefnetd_verify_workers_done_process (hdl);
+#endif // CefC_Netd_VerifyWorker
+					break;
+				}
+				case CefC_Connection_Type_Accept: {
+					/* Accepts the TCP socket 	*/
+					res = cef_face_accept_connect ();
+					if ((res > 0) && (hdl->intcpfdc < CefC_Listen_Face_Max)) {
+						hdl->intcpfaces[hdl->intcpfdc] = (uint16_t) res;
+						hdl->intcpfds[hdl->intcpfdc].fd
+							= cef_face_get_fd_from_faceid ((uint16_t) res);
+						hdl->intcpfds[hdl->intcpfdc].events = POLLIN | POLLERR;
+						hdl->intcpfdc++;
+					}
+					break;
+				}
+				case CefC_Connection_Type_Local: {
+					/* The hang-up of an application is detected by recv() 	*/
+					cefnetd_input_from_local_process (hdl, fd, faceid);
+					break;
+				}
+#ifdef CefC_Netd_Shmring
+				case CefC_Connection_Type_Shmring: {
+					cefnetd_local_shmring_input_process (hdl, fd, faceid);
+					break;
+				}
+#endif // CefC_Netd_Shmring
+				default: {
+					/* The face may have been closed by the preceding event 	*/
+					if ((type != CefC_Connection_Type_Csm) &&
+						(cef_face_get_fd_from_faceid (faceid) != fd)) {
+						break;
+					}
+					if (evs[i].events & EPOLLIN) {
+						(*cefnetd_input_process[type]) (hdl, fd, faceid);
+					}
+					if (evs[i].events & (EPOLLERR | EPOLLHUP)) {
+						if ((type < CefC_Connection_Type_Csm) &&
+							(cef_face_get_fd_from_faceid (faceid) == fd)) {
+							cef_face_close (faceid);
+							cef_fib_faceid_cleanup (hdl->fib);
+						}
+					}
+					break;
+				}
+			}
+		}
+
+		cefnetd_input_from_csque_process (hdl);
+
+#if CefC_IsEnable_ContentStore
+		/* Sends the lookups of this pass to csmgrd in one write 	*/
+		if (hdl->cs_stat->cache_type == CefC_Cache_Type_Excache) {
+			cef_csmgr_excache_lookup_flush (hdl->cs_stat);
+		}
+#endif // CefC_IsEnable_ContentStore
 
-		/* Cleans Face entries 		*/
-		if ( 0 < hdl->face_lifetime ){
-			cefnetd_faces_cleanup (hdl, nowt);
+		/* Rate-limited Cobs left in cs_stat TX queue need the next wakeup 	*/
+		timeout = -1;
+#if CefC_IsEnable_ContentStore
+		if ((hdl->cs_stat->cache_type != CefC_Default_Cache_Type) &&
+			(cef_rngque_read (hdl->cs_stat->tx_que) != NULL)) {
+			timeout = 1;
 		}
+#endif // CefC_IsEnable_ContentStore
+	}
+}
+#else // CefC_Netd_Reactor
+void
+cefnetd_event_dispatch (
+	CefT_Netd_Handle* hdl 						/* cefnetd handle						*/
+) {
+	int i;
+	int res;
+
+	uint64_t nowt = cef_client_present_timeus_calc ();
+
+	cef_log_write (CefC_Log_Info, "Running\n");
+	cefnetd_running_f = 1;
+
+	struct pollfd fds[CefC_Listen_Face_Max * 2];
+	CefC_Connection_Type fd_type[CefC_Listen_Face_Max * 2];
+	int faceids[CefC_Listen_Face_Max * 2];
+	int fdnum;
+
+	while (cefnetd_running_f) {
+
+		/* Calculates the present time 						*/
+		nowt = cef_client_present_timeus_calc ();
+		hdl->nowtus = nowt;
+
+		/* Cleans PIT/Face entries 		*/
+		cefnetd_housekeeping_process (hdl, nowt);
 
 		/* Accepts the TCP socket 	*/
 		res = cef_face_accept_connect ();
@@ -1437,8 +2388,6 @@ cefnetd_event_dispatch (
 			hdl->intcpfdc++;
 		}
 
-		/* Receives the frame(s) from local process 		*/
-		cefnetd_input_from_local_process (hdl);
 		cef_face_update_listen_faces (
 				hdl->inudpfds, hdl->inudpfaces, &hdl->inudpfdc,
 				hdl->intcpfds, hdl->intcpfaces, &hdl->intcpfdc);
@@ -1450,10 +2399,12 @@ cefnetd_event_dispatch (
 
 			if (fds[i].revents != 0) {
 				res--;
+				if (fd_type[i] == CefC_Connection_Type_Local) {
+					/* The hang-up of an application is detected by recv() 	*/
+					cefnetd_input_from_local_process (hdl, fds[i].fd, faceids[i]);
+					continue;
+				}
 				if (fds[i].revents & POLLIN) {
-					if (fd_type[i] == CefC_Connection_Type_Local) {
-						continue;
-					}
 					(*cefnetd_input_process[fd_type[i]]) (
 										hdl, fds[i].fd, faceids[i]);
 				}
@@ -1474,24 +2425,14 @@ cefnetd_event_dispatch (
 		cefnetd_input_from_csque_process (hdl);
 
 #if CefC_IsEnable_ContentStore
-		if ((hdl->cs_stat->cache_type != CefC_Cache_Type_None) &&
-			(nowt > ccninfo_push_time)) {
-			if (hdl->cs_stat->cache_type == CefC_Cache_Type_Excache) {
-				cef_csmgr_excache_item_push (hdl->cs_stat);
-				ccninfo_push_time = nowt + 500000;
-			}
-#ifdef	CefC_CefnetdCache
-			else
-			if (hdl->cs_stat->cache_type == CefC_Cache_Type_Localcache) {
-				; /* NOP */
-			}
-#endif	//CefC_CefnetdCache
+		/* Sends the lookups of this pass to csmgrd in one write 	*/
+		if (hdl->cs_stat->cache_type == CefC_Cache_Type_Excache) {
+			cef_csmgr_excache_lookup_flush (hdl->cs_stat);
 		}
 #endif // CefC_IsEnable_ContentStore
-
-
 	}
 }
+#endif // CefC_Netd_Reactor
 /*--------------------------------------------------------------------------------------
 	Ccninfo Full discobery authentication & authorization
 	NOTE: Stub function for future expansion
@@ -1631,6 +2572,7 @@ static int										/* No care now							*/
 	return (0);
 }
 
+#ifndef CefC_Netd_Reactor
 /*--------------------------------------------------------------------------------------
 	Prepares the UDP and TCP sockets to be polled
 ----------------------------------------------------------------------------------------*/
@@ -1699,18 +2641,42 @@ cefnetd_poll_socket_prepare (
 	}
 #endif // CefC_IsEnable_ContentStore
 
+	/* Local sockets (applications and cefbabeld) 				*/
+	fds[res].events = POLLIN | POLLERR;
+	fds[res].fd = cef_face_get_fd_from_faceid (CefC_Faceid_Local);
+	fd_type[res] = CefC_Connection_Type_Local;
+	faceids[res] = CefC_Faceid_Local;
+	res++;
+
+	if (hdl->babel_use_f) {
+		fds[res].events = POLLIN | POLLERR;
+		fds[res].fd = cef_face_get_fd_from_faceid (CefC_Faceid_ListenBabel);
+		fd_type[res] = CefC_Connection_Type_Local;
+		faceids[res] = CefC_Faceid_ListenBabel;
+		res++;
+
+		if (hdl->babel_sock > 0) {
+			fds[res].events = POLLIN | POLLERR;
+			fds[res].fd = hdl->babel_sock;
+			fd_type[res] = CefC_Connection_Type_Local;
+			faceids[res] = hdl->babel_face;
+			res++;
+		}
+	}
+
 	for (i = 0 ; i < hdl->app_fds_num ; i++) {
 		if (hdl->app_fds[i] != -1) {
 			fds[res].events = POLLIN | POLLERR;
 			fds[res].fd = hdl->app_fds[i] ;
 			fd_type[res] = CefC_Connection_Type_Local;
-			faceids[res] = 0;
+			faceids[res] = hdl->app_faces[i];
 			res++;
 		}
 	}
 
 	return (res);
 }
+#endif // CefC_Netd_Reactor
 /*--------------------------------------------------------------------------------------
 	Handles the elements of cs_stat TX queue
 ----------------------------------------------------------------------------------------*/
@@ -1844,181 +2810,417 @@ cef_dbg_write (CefC_Dbg_Fine, "Failure:length=%zu, send_len=%d\n", length, send_
 }
 
 /*--------------------------------------------------------------------------------------
-	Accepts and receives the frame(s) from local face
+	Handles the local socket which is readable (the listen socket, an application
+	or cefbabeld)
 ----------------------------------------------------------------------------------------*/
 static int										/* No care now							*/
 cefnetd_input_from_local_process (
-	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int fd, 									/* FD which is readable					*/
+	int faceid									/* Face-ID of the FD					*/
 ) {
-	int sock;
-	int work_peer_sock;
-	struct sockaddr_un peeraddr;
-	socklen_t addrlen = (socklen_t) sizeof (peeraddr);
-	int len;
-	int flag;
 	int i;
-	int peer_faceid;
-	unsigned char buff[CefC_Max_Length];
-	unsigned char* rsp_msg = hdl->app_rsp_msg;
-	char	user_id[512];
-
-	/* Obtains the FD for local face 	*/
-	sock = cef_face_get_fd_from_faceid (CefC_Faceid_Local);
-
-	/* Accepts the interrupt from local process */
-	if ((work_peer_sock = accept (sock, (struct sockaddr*)&peeraddr, &addrlen)) < 0) {
-		/* NOP */;
-	} else {
-		if (hdl->app_fds_num < CefC_App_Conn_Num) {
-			hdl->app_fds[hdl->app_fds_num] = work_peer_sock;
-
-			flag = fcntl (hdl->app_fds[hdl->app_fds_num], F_GETFL, 0);
-			if (flag < 0) {
-				cef_log_write (CefC_Log_Info,
-					"<Fail> cefnetd_input_from_local_process (fcntl)\n");
-				work_peer_sock = -1;
-			} else {
-				if (fcntl (hdl->app_fds[hdl->app_fds_num]
-									, F_SETFL, flag | O_NONBLOCK) < 0) {
-					cef_log_write (CefC_Log_Info,
-						"<Fail> cefnetd_input_from_local_process (fcntl)\n");
-					work_peer_sock = -1;
-				}
-			}
-			if (work_peer_sock != -1) {
-				peer_faceid = cef_face_lookup_local_faceid (work_peer_sock);
 
-				if (peer_faceid < 0) {
-					char errmsg[BUFSIZ_8K];
-					sprintf(errmsg,"ERROR:cefnetd is resource busy, #%d.\n", work_peer_sock);
-					write(work_peer_sock, errmsg, strlen(errmsg));
-					close (hdl->app_steps[hdl->app_fds_num]);
-					hdl->app_fds[hdl->app_fds_num] = -1;
-				} else {
-					hdl->app_faces[hdl->app_fds_num] = peer_faceid;
-					hdl->app_steps[hdl->app_fds_num] = 0;
-					hdl->app_fds_num++;
-				}
-			} else {
-				close (hdl->app_steps[hdl->app_fds_num]);
-				hdl->app_fds[hdl->app_fds_num] = -1;
-			}
-		} else {
-			close (work_peer_sock);
-		}
+	if (faceid == CefC_Faceid_Local) {
+		cefnetd_local_accept_process (hdl, fd);
+		return (1);
+	}
+	if (faceid == CefC_Faceid_ListenBabel) {
+		cefnetd_babel_accept_process (hdl, fd);
+		return (1);
 	}
 
-	/* Checks whether frame(s) arrivals from the active local faces */
+	/* The connection may have been closed by the preceding event 	*/
+	if (cef_face_get_fd_from_faceid (faceid) != fd) {
+		return (1);
+	}
+	if (fd == hdl->babel_sock) {
+		cefnetd_babel_input_process (hdl);
+		return (1);
+	}
 	for (i = 0 ; i < hdl->app_fds_num ; i++) {
-		len = recv (hdl->app_fds[i], buff, CefC_Max_Length, 0);
-
-		if (len > 0) {
-			hdl->app_steps[i] = 0;
-
-			if (memcmp (buff, CefC_Ctrl, CefC_Ctrl_Len) == 0) {
-				flag = cefnetd_input_control_message (
-						hdl, buff, len, &rsp_msg, hdl->app_fds[i]);
-				if (flag > 0){
-					int	fblocks;
-					int rem_size;
-					int counter;
-					int fcntlfl;
-					fcntlfl = fcntl (hdl->app_fds[i], F_GETFL, 0);
-					fcntl (hdl->app_fds[i], F_SETFL, fcntlfl & ~O_NONBLOCK);
-					fblocks = flag / 65535;
-					rem_size = flag % 65535;
-					for (counter=0; counter<fblocks; counter++){
-						cefnetd_localsend (hdl->app_fds[i], &rsp_msg[counter*65535], 65535, 0);
-					}
-					if (rem_size != 0){
-						cefnetd_localsend (hdl->app_fds[i], &rsp_msg[fblocks*65535], rem_size, 0);
-					}
-					fcntl (hdl->app_fds[i], F_SETFL, fcntlfl | O_NONBLOCK);
-				}
-			} else if (memcmp (buff, CefC_Face_Close, len) == 0) {
-
-				cef_face_close (hdl->app_faces[i]);
-				hdl->app_fds[i] = -1;
-				hdl->app_fds_num--;
-
-				for (flag = i ; flag < hdl->app_fds_num ; flag++) {
-					hdl->app_fds[flag] = hdl->app_fds[flag + 1];
-					hdl->app_faces[flag] = hdl->app_faces[flag + 1];
-					hdl->app_steps[flag] = hdl->app_steps[flag + 1];
-				}
-				i--;
-			} else {
-				cefnetd_input_message_process (
-						hdl, CefC_Faceid_Local, hdl->app_faces[i], buff, len, user_id);
-			}
-		}
-		else {
-			struct pollfd fds[1];
-			fds[0].fd = hdl->app_fds[i];
-			fds[0].events = POLLIN | POLLERR;
-			poll (fds, 1, 0);
-			if ((fds[0].revents & POLLIN) && (fds[0].revents & POLLHUP)) {
-				cef_face_close (hdl->app_faces[i]);
-				hdl->app_fds[i] = -1;
-				hdl->app_fds_num--;
-
-				for (flag = i ; flag < hdl->app_fds_num ; flag++) {
-					hdl->app_fds[flag] = hdl->app_fds[flag + 1];
-					hdl->app_faces[flag] = hdl->app_faces[flag + 1];
-					hdl->app_steps[flag] = hdl->app_steps[flag + 1];
-				}
-				i--;
-			}
+		if (hdl->app_fds[i] == fd) {
+			cefnetd_local_app_input_process (hdl, i);
+			break;
 		}
 	}
 
-	if (!hdl->babel_use_f) {
-		return (1);
-	}
-
-	/* Obtains the FD for local face 	*/
-	sock = cef_face_get_fd_from_faceid (CefC_Faceid_ListenBabel);
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Accepts the connections from local processes
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_accept_process (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int sock									/* FD of the local listen socket		*/
+) {
+	int work_peer_sock;
+	struct sockaddr_un peeraddr;
+	socklen_t addrlen;
+	int flag;
+	int peer_faceid;
 
-	/* Accepts the interrupt from local process */
-	if ((work_peer_sock = accept (sock, (struct sockaddr*)&peeraddr, &addrlen)) < 0) {
-		/* NOP */;
-	} else {
-		if (hdl->babel_sock > 0) {
-			cef_face_close (hdl->babel_face);
-			hdl->babel_sock = -1;
-			hdl->babel_face = -1;
+	while (1) {
+		addrlen = (socklen_t) sizeof (peeraddr);
+		if ((work_peer_sock = accept (sock, (struct sockaddr*)&peeraddr, &addrlen)) < 0) {
+			break;
+		}
+		if (hdl->app_fds_num >= CefC_App_Conn_Num) {
+			close (work_peer_sock);
+			continue;
 		}
+
 		flag = fcntl (work_peer_sock, F_GETFL, 0);
-		if (flag < 0) {
+		if ((flag < 0) || (fcntl (work_peer_sock, F_SETFL, flag | O_NONBLOCK) < 0)) {
 			cef_log_write (CefC_Log_Info,
-				"<Fail> cefnetd_input_from_local_process (fcntl)\n");
-			work_peer_sock = -1;
-		} else {
-			if (fcntl (work_peer_sock, F_SETFL, flag | O_NONBLOCK) < 0) {
-				cef_log_write (CefC_Log_Info,
-					"<Fail> cefnetd_input_from_local_process (fcntl)\n");
-				work_peer_sock = -1;
+				"<Fail> cefnetd_local_accept_process (fcntl)\n");
+			close (work_peer_sock);
+			continue;
+		}
+
+		peer_faceid = cef_face_lookup_local_faceid (work_peer_sock);
+		if (peer_faceid < 0) {
+			char errmsg[BUFSIZ_8K];
+			sprintf(errmsg,"ERROR:cefnetd is resource busy, #%d.\n", work_peer_sock);
+			write(work_peer_sock, errmsg, strlen(errmsg));
+			close (work_peer_sock);
+			continue;
+		}
+
+		hdl->app_fds[hdl->app_fds_num] = work_peer_sock;
+		hdl->app_faces[hdl->app_fds_num] = peer_faceid;
+		hdl->app_steps[hdl->app_fds_num] = 0;
+#ifdef CefC_Netd_Shmring
+		hdl->app_shmrings[hdl->app_fds_num] = NULL;
+#endif // CefC_Netd_Shmring
+#ifdef CefC_Netd_Reactor
+		cefnetd_reactor_fd_add (hdl, work_peer_sock,
+					CefC_Connection_Type_Local, peer_faceid);
+#endif // CefC_Netd_Reactor
+		hdl->app_fds_num++;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Receives the frame(s) from the application which is readable
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_app_input_process (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int index									/* index of the application in app_fds	*/
+) {
+	int fd = hdl->app_fds[index];
+	unsigned char buff[CefC_Max_Length];
+	int len;
+	int n;
+
+	for (n = 0 ; n < CefC_Max_LocalInputSegs ; n++) {
+		len = recv (fd, buff, CefC_Max_Length, 0);
+
+		if (len <= 0) {
+			if ((len == 0) ||
+				((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))) {
+				/* The application has closed the connection 	*/
+				cefnetd_local_app_close (hdl, index);
 			}
+			return;
 		}
-		if (work_peer_sock != -1) {
-			peer_faceid = cef_face_lookup_local_faceid (work_peer_sock);
+		hdl->app_steps[index] = 0;
 
-			if (peer_faceid < 0) {
-				close (work_peer_sock);
-			} else {
-				hdl->babel_sock = work_peer_sock;
-				hdl->babel_face = peer_faceid;
+		if (cefnetd_local_app_msg_process (hdl, index, buff, len) < 0) {
+			return;
+		}
+
+		/* The socket has been drained 	*/
+		if (len < CefC_Max_Length) {
+			break;
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Handles the bytes received from the application via the socket or the rings
+----------------------------------------------------------------------------------------*/
+static int										/* negative if the application is closed*/
+cefnetd_local_app_msg_process (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int index,									/* index of the application in app_fds	*/
+	unsigned char* buff,						/* received bytes						*/
+	int len										/* length of the bytes					*/
+) {
+	int fd = hdl->app_fds[index];
+	int peer_faceid = hdl->app_faces[index];
+	CefT_Face* face;
+	unsigned char* rsp_msg = hdl->app_rsp_msg;
+	char	user_id[512];
+	int flag;
+
+	user_id[0] = 0x00;
+
+	/* A frame split over the reads is completed in the receive buffer of the 	*/
+	/* Face, so the commands are only looked for at the boundary of frames 		*/
+	face = cef_face_get_face_from_faceid (peer_faceid);
+
+	if ((face->rcvbuf.rcv_len == 0) &&
+		(len >= CefC_Ctrl_Len) && (memcmp (buff, CefC_Ctrl, CefC_Ctrl_Len) == 0)) {
+		flag = cefnetd_input_control_message (hdl, buff, len, &rsp_msg, fd);
+		if (flag > 0) {
+			cefnetd_local_response_send (fd, rsp_msg, flag);
+		}
+	} else if ((face->rcvbuf.rcv_len == 0) &&
+		(len == strlen (CefC_Face_Close)) && (memcmp (buff, CefC_Face_Close, len) == 0)) {
+		cefnetd_local_app_close (hdl, index);
+		return (-1);
+	} else if ((face->rcvbuf.rcv_len == 0) &&
+		(len == strlen (CefC_Shmring_Attach)) &&
+		(memcmp (buff, CefC_Shmring_Attach, len) == 0)) {
+		cefnetd_local_shmring_attach (hdl, index);
+	} else {
+		cefnetd_input_message_process (
+				hdl, CefC_Faceid_Local, peer_faceid, buff, len, user_id);
+	}
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Closes the connection from the application
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_app_close (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int index									/* index of the application in app_fds	*/
+) {
+	int i;
+#ifdef CefC_Netd_Shmring
+	CefT_Shmring* shm = hdl->app_shmrings[index];
+
+	if (shm) {
+		cefnetd_reactor_fd_del (hdl, cef_shmring_event_fd (shm));
+
+		/* The frames put into the rings before the close are handled first. 	*/
+		/* If one of them closes the application, it has been done already 		*/
+		hdl->app_shmrings[index] = NULL;
+		if (cefnetd_local_shmring_drain (hdl, index, shm, INT_MAX) < 0) {
+			cef_shmring_destroy (shm);
+			return;
+		}
+		cef_face_shmring_set (hdl->app_faces[index], NULL);
+		cef_shmring_destroy (shm);
+	}
+#endif // CefC_Netd_Shmring
+
+	cef_face_close (hdl->app_faces[index]);
+	hdl->app_fds[index] = -1;
+	hdl->app_fds_num--;
+
+	for (i = index ; i < hdl->app_fds_num ; i++) {
+		hdl->app_fds[i] = hdl->app_fds[i + 1];
+		hdl->app_faces[i] = hdl->app_faces[i + 1];
+		hdl->app_steps[i] = hdl->app_steps[i + 1];
+#ifdef CefC_Netd_Shmring
+		hdl->app_shmrings[i] = hdl->app_shmrings[i + 1];
+#endif // CefC_Netd_Shmring
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Creates the rings shared with the application, and passes them over the socket
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_shmring_attach (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int index									/* index of the application in app_fds	*/
+) {
+	int fd = hdl->app_fds[index];
+	CefT_Shmring* shm = NULL;
+
+#ifdef CefC_Netd_Shmring
+	if (hdl->shmring_use_f && (hdl->app_shmrings[index] == NULL)) {
+		shm = cef_shmring_create ();
+	}
+	if (shm &&
+		(cefnetd_reactor_fd_add (hdl, cef_shmring_event_fd (shm),
+			CefC_Connection_Type_Shmring, hdl->app_faces[index]) < 0)) {
+		cef_shmring_destroy (shm);
+		shm = NULL;
+	}
+	if (shm) {
+		if (cef_shmring_fds_send (fd, shm,
+				CefC_Shmring_Attach_Ok, strlen (CefC_Shmring_Attach_Ok)) < 0) {
+			cefnetd_reactor_fd_del (hdl, cef_shmring_event_fd (shm));
+			cef_shmring_destroy (shm);
+			return;
+		}
+		hdl->app_shmrings[index] = shm;
+		cef_face_shmring_set (hdl->app_faces[index], shm);
+		return;
+	}
+#endif // CefC_Netd_Shmring
+
+	/* The application keeps using the socket 	*/
+	cef_shmring_fds_send (fd, NULL,
+		CefC_Shmring_Attach_Ng, strlen (CefC_Shmring_Attach_Ng));
+}
+#ifdef CefC_Netd_Shmring
+/*--------------------------------------------------------------------------------------
+	Handles the frames which the application has put into the rings
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_shmring_input_process (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int fd, 									/* eventfd of the rings					*/
+	int faceid									/* Face-ID of the application			*/
+) {
+	CefT_Shmring* shm;
+	int index;
+	int res;
+
+	/* The application may have been closed by the preceding event 	*/
+	for (index = 0 ; index < hdl->app_fds_num ; index++) {
+		if ((hdl->app_faces[index] == faceid) && hdl->app_shmrings[index] &&
+			(cef_shmring_event_fd (hdl->app_shmrings[index]) == fd)) {
+			break;
+		}
+	}
+	if (index == hdl->app_fds_num) {
+		return;
+	}
+	shm = hdl->app_shmrings[index];
+
+	while (1) {
+		res = cefnetd_local_shmring_drain (hdl, index, shm, CefC_Max_ShmringInputSegs);
+		if (res < 0) {
+			return;
+		}
+		if (res > 0) {
+			/* The rest is handled after the other events 	*/
+			cef_shmring_kick (shm);
+			return;
+		}
+		if (cef_shmring_sleep (shm)) {
+			return;
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Reads the frames in the rings up to the specified number of reads
+----------------------------------------------------------------------------------------*/
+static int										/* negative if the application is closed,*/
+												/* 0 if the rings are empty				*/
+cefnetd_local_shmring_drain (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int index,									/* index of the application in app_fds	*/
+	CefT_Shmring* shm,							/* rings of the application				*/
+	int max_segs								/* maximum number of reads				*/
+) {
+	unsigned char buff[CefC_Max_Length];
+	int len;
+	int n;
+
+	for (n = 0 ; n < max_segs ; n++) {
+		len = cef_shmring_recv (shm, buff, CefC_Max_Length);
+		if (len == 0) {
+			return (0);
+		}
+		if (len < 0) {
+			cef_log_write (CefC_Log_Warn,
+				"The application of Face#%d has broken the shared memory\n",
+				hdl->app_faces[index]);
+			if (hdl->app_shmrings[index] == shm) {
+				cefnetd_local_app_close (hdl, index);
+				return (-1);
 			}
-		} else {
-			close (work_peer_sock);
+			/* Called from the close, which goes on 	*/
+			return (0);
+		}
+		hdl->app_steps[index] = 0;
+
+		if (cefnetd_local_app_msg_process (hdl, index, buff, len) < 0) {
+			return (-1);
 		}
 	}
+	return (1);
+}
+#endif // CefC_Netd_Shmring
+/*--------------------------------------------------------------------------------------
+	Sends the response to the control message to the local process
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_local_response_send (
+	int fd,										/* FD of the local process				*/
+	unsigned char* rsp_msg,						/* response								*/
+	int rsp_len									/* length of the response				*/
+) {
+	int	fblocks;
+	int rem_size;
+	int counter;
+	int fcntlfl;
+
+	fcntlfl = fcntl (fd, F_GETFL, 0);
+	fcntl (fd, F_SETFL, fcntlfl & ~O_NONBLOCK);
+	fblocks = rsp_len / 65535;
+	rem_size = rsp_len % 65535;
+	for (counter=0; counter<fblocks; counter++){
+		cefnetd_localsend (fd, &rsp_msg[counter*65535], 65535, 0);
+	}
+	if (rem_size != 0){
+		cefnetd_localsend (fd, &rsp_msg[fblocks*65535], rem_size, 0);
+	}
+	fcntl (fd, F_SETFL, fcntlfl | O_NONBLOCK);
+}
+/*--------------------------------------------------------------------------------------
+	Accepts the connection from cefbabeld
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_babel_accept_process (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int sock									/* FD of the cefbabeld listen socket	*/
+) {
+	int work_peer_sock;
+	struct sockaddr_un peeraddr;
+	socklen_t addrlen = (socklen_t) sizeof (peeraddr);
+	int flag;
+	int peer_faceid;
 
-	if (hdl->babel_sock < 0) {
-		return (1);
+	/* Accepts the interrupt from local process */
+	if ((work_peer_sock = accept (sock, (struct sockaddr*)&peeraddr, &addrlen)) < 0) {
+		return;
+	}
+	if (hdl->babel_sock > 0) {
+		cef_face_close (hdl->babel_face);
+		hdl->babel_sock = -1;
+		hdl->babel_face = -1;
+	}
+	flag = fcntl (work_peer_sock, F_GETFL, 0);
+	if ((flag < 0) || (fcntl (work_peer_sock, F_SETFL, flag | O_NONBLOCK) < 0)) {
+		cef_log_write (CefC_Log_Info,
+			"<Fail> cefnetd_babel_accept_process (fcntl)\n");
+		close (work_peer_sock);
+		return;
+	}
+	peer_faceid = cef_face_lookup_local_faceid (work_peer_sock);
+
+	if (peer_faceid < 0) {
+		close (work_peer_sock);
+	} else {
+		hdl->babel_sock = work_peer_sock;
+		hdl->babel_face = peer_faceid;
+#ifdef CefC_Netd_Reactor
+		cefnetd_reactor_fd_add (hdl, work_peer_sock,
+					CefC_Connection_Type_Local, peer_faceid);
+#endif // CefC_Netd_Reactor
 	}
+}
+/*--------------------------------------------------------------------------------------
+	Receives the frame from cefbabeld
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_babel_input_process (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	int len;
+	int flag;
+	unsigned char buff[CefC_Max_Length];
+	unsigned char* rsp_msg = hdl->app_rsp_msg;
 
-	/* Checks whether frame(s) arrivals from the active local faces */
 	len = recv (hdl->babel_sock, buff, CefC_Max_Length, 0);
 
 	if (len > 0) {
@@ -2028,23 +3230,7 @@ cefnetd_input_from_local_process (
 			flag = cefnetd_input_control_message (
 					hdl, buff, len, &rsp_msg, hdl->babel_sock);
 			if (flag > 0) {
-				{
-					int	fblocks;
-					int rem_size;
-					int counter;
-					int fcntlfl;
-					fcntlfl = fcntl (hdl->babel_sock, F_GETFL, 0);
-					fcntl (hdl->babel_sock, F_SETFL, fcntlfl & ~O_NONBLOCK);
-					fblocks = flag / 65535;
-					rem_size = flag % 65535;
-					for (counter=0; counter<fblocks; counter++){
-						cefnetd_localsend (hdl->babel_sock, &rsp_msg[counter*65535], 65535, 0);
-					}
-					if (rem_size != 0){
-						cefnetd_localsend (hdl->babel_sock, &rsp_msg[fblocks*65535], rem_size, 0);
-					}
-					fcntl (hdl->babel_sock, F_SETFL, fcntlfl | O_NONBLOCK);
-				}
+				cefnetd_local_response_send (hdl->babel_sock, rsp_msg, flag);
 			}
 		} else if (memcmp (buff, CefC_Face_Close, len) == 0) {
 			cef_face_close (hdl->babel_face);
@@ -2054,25 +3240,12 @@ cefnetd_input_from_local_process (
 			/* NOP */;
 		}
 	}
-	else {
-		struct pollfd fds[1];
-		int kerrno;
-		kerrno = errno;
-		fds[0].fd = hdl->babel_sock;
-		fds[0].events = POLLIN | POLLERR;
-		poll (fds, 1, 0);
-		if (fds[0].revents & (POLLIN | POLLHUP)) {
-			if((fds[0].revents == POLLIN) && (kerrno == EAGAIN || kerrno == EWOULDBLOCK)) {
-				; // NOP
-			} else {
-				cef_face_close (hdl->babel_face);
-				hdl->babel_sock = -1;
-				hdl->babel_face = -1;
-			}
-		}
+	else if ((len == 0) ||
+		((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))) {
+		cef_face_close (hdl->babel_face);
+		hdl->babel_sock = -1;
+		hdl->babel_face = -1;
 	}
-
-	return (1);
 }
 /*--------------------------------------------------------------------------------------
 	Handles the message to reg/dereg application name
@@ -2710,124 +3883,629 @@ static int
 cefnetd_udp_input_process_core (
 	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
 	int fd, 									/* FD which is polled POLLIN			*/
-	int faceid									/* Face-ID that message arrived 		*/
+	int faceid,									/* Face-ID that message arrived 		*/
+	unsigned char* buff,						/* received datagram					*/
+	size_t recv_len,							/* length of the datagram				*/
+	struct sockaddr_storage* sas_p,				/* source address of the datagram		*/
+	socklen_t sas_len							/* length of the source address			*/
 ) {
 	int protocol;
-	size_t recv_len;
 	int peer_faceid;
+	char user_id[512];	//0.8.3
+
+	if ( cefnetd_broadcast_filter(hdl, (struct sockaddr_in *)sas_p, sas_len) ){
+		return (-1);
+	}
+
+	// TBD: process for the special message
+
+	/* Looks up the peer Face-ID 		*/
+	protocol = cef_face_get_protocol_from_fd (fd);
+	peer_faceid = cef_face_lookup_peer_faceid ((struct addrinfo *)sas_p, sas_len, protocol, user_id);	//0.8.3
+	if (peer_faceid < 0) {
+		cef_log_write (CefC_Log_Error, "cef_face_lookup_peer_faceid() missing the fd=%d, sas_len=%d.\n", fd, sas_len);
+		return (-1);
+	}
+
+#ifdef __APPLE__
+	{
+		CefT_Face*	face;
+		int			ifindex;
+		int			rc;
+
+		struct sockaddr_storage ss;
+		socklen_t sslen = sizeof(ss);
+
+		if ((rc = getsockname(fd, (struct sockaddr *)&ss, &sslen)) < 0){
+			return (-1);
+		}
+		if (((struct sockaddr *)&ss)->sa_family == AF_INET6) {
+			face = cef_face_get_face_from_faceid (peer_faceid);
+			if (face->ifindex == -1) {
+				CefT_Hash_Handle* sock_tbl;
+				CefT_Sock* sock;
+				struct in6_pktinfo pinfo;
+				char dst_addr[256];
+				sock_tbl = cef_face_return_sock_table ();
+				sock = (CefT_Sock*) cef_hash_tbl_item_get_from_index (*sock_tbl, face->index);
+
+				{/* get ifindex */
+					char	*ifname_p;
+					char	hostname[NI_MAXHOST];
+					int		result;
+					result = getnameinfo ((struct sockaddr*) sas_p, sas_len,
+											hostname, sizeof (hostname), 0, 0, NI_NUMERICHOST);
+					if (result != 0) {
+						cef_log_write (CefC_Log_Error, "%s (getnameinfo:%s)\n", __func__, gai_strerror(result));
+						return (-1);
+					}
+					ifname_p = strchr(hostname, '%');
+					if(ifname_p == NULL){
+						cef_log_write (CefC_Log_Error, "%s IPv6 UDP recive error\n", __func__);
+						return (-1);
+					}
+					ifindex = if_nametoindex(ifname_p+1);
+					if (ifindex == 0) {
+						cef_log_write (CefC_Log_Error, "%s if_nametoindex(%s) error: %s\n",
+										__func__, ifname_p, strerror(errno));
+						return (-1);
+					 }
+				}
+				face->ifindex = ifindex;
+				if(face->ifindex != -1){
+					getnameinfo (sock->ai_addr, sock->ai_addrlen, dst_addr, sizeof(dst_addr),
+									NULL, 0, NI_NUMERICHOST);
+					if(strncmp(dst_addr, "fe80::", 6) == 0) { /* IPv6 linklocal address */
+						pinfo.ipi6_addr = in6addr_any;
+						pinfo.ipi6_ifindex = face->ifindex;
+						if(setsockopt(sock->skfd, IPPROTO_IPV6, IPV6_PKTINFO, &pinfo, sizeof(struct in6_pktinfo)) == -1){
+							return(-1);
+						}
+					}
+				}
+			}
+		}
+	}
+#endif
+
+	/* Handles the received CEFORE message 	*/
+	cefnetd_input_message_process (hdl, faceid, peer_faceid, buff, (int) recv_len, user_id);
+
+	return (1);
+}
+
+#ifdef CefC_Netd_RecvMmsg
+static int
+cefnetd_udp_input_process (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int fd, 									/* FD which is polled POLLIN			*/
+	int faceid									/* Face-ID that message arrived 		*/
+) {
+	int i, num;
+	int ret = -1;
+
+	for (i = 0 ; i < CefC_Max_UdpInputSegs ; i++) {
+		hdl->udp_rx_msg[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_storage);
+		hdl->udp_rx_msg[i].msg_len = 0;
+	}
+
+	/* Receives the datagrams queued on the FD at once. The FD stays readable 	*/
+	/* if more than CefC_Max_UdpInputSegs datagrams are queued. 				*/
+	num = recvmmsg (fd, hdl->udp_rx_msg, CefC_Max_UdpInputSegs, MSG_DONTWAIT, NULL);
+
+	for (i = 0 ; i < num ; i++) {
+		ret = cefnetd_udp_input_process_core (hdl, fd, faceid,
+						&hdl->udp_rx_buf[i * CefC_Max_Length],
+						(size_t) hdl->udp_rx_msg[i].msg_len,
+						&hdl->udp_rx_sas[i], hdl->udp_rx_msg[i].msg_hdr.msg_namelen);
+	}
+
+	return (ret);
+}
+/*--------------------------------------------------------------------------------------
+	Allocates the buffers for the batched UDP input
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cefnetd_udp_input_batch_init (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	int i;
+
+	hdl->udp_rx_buf = (unsigned char*) malloc (CefC_Max_Length * CefC_Max_UdpInputSegs);
+	hdl->udp_rx_msg = (struct mmsghdr*) calloc (
+						CefC_Max_UdpInputSegs, sizeof (struct mmsghdr));
+	hdl->udp_rx_iov = (struct iovec*) calloc (
+						CefC_Max_UdpInputSegs, sizeof (struct iovec));
+	hdl->udp_rx_sas = (struct sockaddr_storage*) calloc (
+						CefC_Max_UdpInputSegs, sizeof (struct sockaddr_storage));
+	if (!hdl->udp_rx_buf || !hdl->udp_rx_msg || !hdl->udp_rx_iov || !hdl->udp_rx_sas) {
+		return (-1);
+	}
+
+	for (i = 0 ; i < CefC_Max_UdpInputSegs ; i++) {
+		hdl->udp_rx_iov[i].iov_base = &hdl->udp_rx_buf[i * CefC_Max_Length];
+		hdl->udp_rx_iov[i].iov_len  = CefC_Max_Length;
+		hdl->udp_rx_msg[i].msg_hdr.msg_name   = &hdl->udp_rx_sas[i];
+		hdl->udp_rx_msg[i].msg_hdr.msg_iov    = &hdl->udp_rx_iov[i];
+		hdl->udp_rx_msg[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Releases the buffers for the batched UDP input
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_udp_input_batch_destroy (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	free (hdl->udp_rx_buf);
+	free (hdl->udp_rx_msg);
+	free (hdl->udp_rx_iov);
+	free (hdl->udp_rx_sas);
+	hdl->udp_rx_buf = NULL;
+	hdl->udp_rx_msg = NULL;
+	hdl->udp_rx_iov = NULL;
+	hdl->udp_rx_sas = NULL;
+}
+#else // CefC_Netd_RecvMmsg
+static int
+cefnetd_udp_input_process (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int fd, 									/* FD which is polled POLLIN			*/
+	int faceid									/* Face-ID that message arrived 		*/
+) {
+	int i, ret = 1;
+	ssize_t recv_len;
 	struct sockaddr_storage sas;
-	struct addrinfo *sas_p = (struct addrinfo *)&sas;
-	socklen_t sas_len = (socklen_t) sizeof (struct addrinfo);
+	socklen_t sas_len;
 	unsigned char buff[CefC_Max_Length];
-	char user_id[512];	//0.8.3
 
-	/* Receives the message(s) from the specified FD */
-	recv_len
-		= recvfrom (fd, buff, CefC_Max_Length, 0, (struct sockaddr*) &sas, &sas_len);
+	for ( i = 0; 0 < ret && i < CefC_Max_UdpInputSegs; i++ ){
+		struct pollfd pollfd;
+
+		sas_len = (socklen_t) sizeof (struct addrinfo);
+		recv_len
+			= recvfrom (fd, buff, CefC_Max_Length, 0, (struct sockaddr*) &sas, &sas_len);
+		ret = cefnetd_udp_input_process_core (
+						hdl, fd, faceid, buff, (size_t) recv_len, &sas, sas_len);
+
+		pollfd.fd = fd;
+		pollfd.events = POLLIN;
+		pollfd.revents = 0;
+		poll (&pollfd, 1, 0);
+		if (!(pollfd.revents & POLLIN))
+			break;
+	}
+
+	return (ret);
+}
+#endif // CefC_Netd_RecvMmsg
+
+#ifdef CefC_Netd_RxWorker
+/*--------------------------------------------------------------------------------------
+	Reads the datagrams from the sockets of a UDP input worker
+----------------------------------------------------------------------------------------*/
+static void *
+cefnetd_receive_worker_thread (
+	void *p
+) {
+	CefT_Netd_RxWorker* hdl_wkr = p;
+	CefT_Netd_Handle* hdl = hdl_wkr->hdl_cefnetd;
+	struct mmsghdr msgs[CefC_Max_UdpInputSegs];
+	struct iovec iovs[CefC_Max_UdpInputSegs];
+	struct sockaddr_storage sass[CefC_Max_UdpInputSegs];
+	struct pollfd fds[CefC_RxWorkerFaceMax];
+	unsigned char* buff;
+	CefT_Rx_Dgram* rx_dgram;
+	void* rx_dgrams[CefC_Max_UdpInputSegs];
+	int i, n, num, res, cnt, pushed;
+
+	buff = (unsigned char*) malloc (CefC_Max_Length * CefC_Max_UdpInputSegs);
+	if (buff == NULL) {
+		cef_log_write (CefC_Log_Error, "Worker#%d UDP input buffer allocation failed (%s)\n"
+						, hdl_wkr->worker_id, strerror(errno));
+		pthread_exit (NULL);
+	}
+	memset (msgs, 0, sizeof (msgs));
+	for (i = 0 ; i < CefC_Max_UdpInputSegs ; i++) {
+		iovs[i].iov_base = &buff[i * CefC_Max_Length];
+		iovs[i].iov_len  = CefC_Max_Length;
+		msgs[i].msg_hdr.msg_name   = &sass[i];
+		msgs[i].msg_hdr.msg_iov    = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+	for (n = 0 ; n < hdl_wkr->fd_num ; n++) {
+		fds[n].fd = hdl_wkr->fds[n];
+		fds[n].events = POLLIN;
+	}
+
+	while (!cefnetd_running_f) {
+		const struct timespec ts = { 0, 100*1000*1000 };
+		nanosleep(&ts, NULL);
+	}
+
+	while (cefnetd_running_f) {
+		/* Wakes up periodically to check the running flag 	*/
+		res = poll (fds, hdl_wkr->fd_num, 100);
+		if (res <= 0) {
+			continue;
+		}
+		pushed = 0;
+
+		for (n = 0 ; n < hdl_wkr->fd_num ; n++) {
+			if (!(fds[n].revents & POLLIN)) {
+				continue;
+			}
+			for (i = 0 ; i < CefC_Max_UdpInputSegs ; i++) {
+				msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_storage);
+			}
+			num = recvmmsg (fds[n].fd, msgs, CefC_Max_UdpInputSegs, MSG_DONTWAIT, NULL);
 
-	if ( cefnetd_broadcast_filter(hdl, (struct sockaddr_in *)&sas, sas_len) ){
+			for (cnt = 0, i = 0 ; i < num ; i++) {
+				rx_dgram = (CefT_Rx_Dgram*) malloc (sizeof (CefT_Rx_Dgram) + msgs[i].msg_len);
+				if (rx_dgram == NULL) {
+					hdl_wkr->drop_packets++;
+					continue;
+				}
+				rx_dgram->fd 		= hdl_wkr->listen_fds[n];
+				rx_dgram->faceid 	= hdl_wkr->faceids[n];
+				rx_dgram->sas_len 	= msgs[i].msg_hdr.msg_namelen;
+				rx_dgram->msg_len 	= msgs[i].msg_len;
+				memcpy (&rx_dgram->sas, &sass[i], rx_dgram->sas_len);
+				memcpy (rx_dgram->msg, iovs[i].iov_base, msgs[i].msg_len);
+				rx_dgrams[cnt++] = rx_dgram;
+			}
+
+			res = cef_rngque_push_bulk (hdl_wkr->rx_que, rx_dgrams, cnt);
+			hdl_wkr->rx_packets += res;
+			pushed += res;
+			/* The main loop is behind, so the rest is dropped 	*/
+			for (i = res ; i < cnt ; i++) {
+				free (rx_dgrams[i]);
+				hdl_wkr->drop_packets++;
+			}
+		}
+		if (pushed) {
+			cefnetd_event_wakeup (hdl);
+		}
+	}
+
+	for (n = 0 ; n < hdl_wkr->fd_num ; n++) {
+		close (hdl_wkr->fds[n]);
+	}
+	free (buff);
+	pthread_exit (NULL);
+
+	return NULL;
+}
+/*--------------------------------------------------------------------------------------
+	Creates the socket which shares the address of the specified UDP listen socket
+----------------------------------------------------------------------------------------*/
+static int										/* FD, or a negative value if it fails	*/
+cefnetd_receive_worker_socket_clone (
+	int listen_fd								/* FD of the UDP listen face			*/
+) {
+	struct sockaddr_storage ss;
+	socklen_t ss_len = sizeof (ss);
+	int fd;
+	int optval = 1;
+	int v6only = 0;
+	socklen_t optlen = sizeof (v6only);
+
+	if (getsockname (listen_fd, (struct sockaddr*) &ss, &ss_len) < 0) {
+		return (-1);
+	}
+	fd = socket (ss.ss_family, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		return (-1);
+	}
+	setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof (optval));
+	setsockopt (fd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof (optval));
+	if ((ss.ss_family == AF_INET6) &&
+		(getsockopt (listen_fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, &optlen) == 0)) {
+		setsockopt (fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof (v6only));
+	}
+	if (bind (fd, (struct sockaddr*) &ss, ss_len) < 0) {
+		close (fd);
 		return (-1);
 	}
+	return (fd);
+}
+/*--------------------------------------------------------------------------------------
+	Creates the UDP input workers
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cefnetd_receive_workers_start (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	CefT_Netd_RxWorker* hdl_wkr;
+	int i, n, fd;
 
-	// TBD: process for the special message
+	for (i = 0 ; i < hdl->rx_worker_num ; i++) {
+		hdl_wkr = &receive_worker_hdl[i];
+		memset (hdl_wkr, 0x00, sizeof (CefT_Netd_RxWorker));
+		hdl_wkr->worker_id = i;
+		hdl_wkr->hdl_cefnetd = hdl;
+
+		hdl->rx_worker_que[i] = cef_rngque_create_ext (CefC_RxWorkerQueue, CefC_Rngque_Spsc);
+		if (hdl->rx_worker_que[i] == NULL) {
+			cef_log_write (CefC_Log_Error,
+				"Failed to cef_rngque_create [%d/%d]\n", i, hdl->rx_worker_num);
+			return (-1);
+		}
+		hdl_wkr->rx_que = hdl->rx_worker_que[i];
+
+		for (n = 0 ; n < hdl->inudpfdc && hdl_wkr->fd_num < CefC_RxWorkerFaceMax ; n++) {
+			fd = cefnetd_receive_worker_socket_clone (hdl->inudpfds[n].fd);
+			if (fd < 0) {
+				cef_log_write (CefC_Log_Warn, "Worker#%d could not share Face#%d (%s)\n"
+								, i, hdl->inudpfaces[n], strerror(errno));
+				continue;
+			}
+			hdl_wkr->fds[hdl_wkr->fd_num] 			= fd;
+			hdl_wkr->listen_fds[hdl_wkr->fd_num] 	= hdl->inudpfds[n].fd;
+			hdl_wkr->faceids[hdl_wkr->fd_num] 		= hdl->inudpfaces[n];
+			hdl_wkr->fd_num++;
+		}
+
+		if (cef_pthread_create (&cefnetd_receive_worker_th, NULL
+				, &cefnetd_receive_worker_thread, hdl_wkr) == -1) {
+			return (-1);
+		}
+	}
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Handles the datagrams received by the UDP input workers
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_receive_workers_input_process (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	CefT_Rx_Dgram* rx_dgram;
+	void* rx_dgrams[CefC_Max_UdpInputSegs];
+	int i, n, num;
+
+	for (i = 0 ; i < hdl->rx_worker_num ; i++) {
+		while ((num = cef_rngque_pop_bulk (
+				hdl->rx_worker_que[i], rx_dgrams, CefC_Max_UdpInputSegs)) > 0) {
+			for (n = 0 ; n < num ; n++) {
+				rx_dgram = (CefT_Rx_Dgram*) rx_dgrams[n];
+				/* The listen face may have been closed after the reception 	*/
+				if (cef_face_get_fd_from_faceid (rx_dgram->faceid) == rx_dgram->fd) {
+					cefnetd_udp_input_process_core (hdl, rx_dgram->fd, rx_dgram->faceid,
+						rx_dgram->msg, rx_dgram->msg_len, &rx_dgram->sas, rx_dgram->sas_len);
+				}
+				free (rx_dgram);
+			}
+		}
+	}
+}
+#endif // CefC_Netd_RxWorker
+
+#ifdef CefC_Netd_VerifyWorker
+/*--------------------------------------------------------------------------------------
+	Verifies the signatures of the messages passed by the main loop
+----------------------------------------------------------------------------------------*/
+static void *
+cefnetd_verify_worker_thread (
+	void *p
+) {
+	CefT_Netd_VerifyWorker* hdl_wkr = p;
+	CefT_Netd_Handle* hdl = hdl_wkr->hdl_cefnetd;
+	CefT_Verify_Job* job;
+
+	while (!cefnetd_running_f) {
+		const struct timespec ts = { 0, 100*1000*1000 };
+		nanosleep(&ts, NULL);
+	}
+
+	while (cefnetd_running_f) {
+		job = (CefT_Verify_Job*) cef_rngque_pop (hdl_wkr->req_que);
+
+		if (!job) {
+			struct timespec ts = { 0, 0 };
+
+			/* Wakes up periodically to check the running flag 	*/
+			cefnetd_get_waittime (&ts, 100000);
+			pthread_mutex_lock (&hdl_wkr->verify_worker_mutex);
+			if (cef_rngque_read (hdl_wkr->req_que) == NULL) {
+				pthread_cond_timedwait (&hdl_wkr->verify_worker_cond,
+								&hdl_wkr->verify_worker_mutex, &ts);
+			}
+			pthread_mutex_unlock (&hdl_wkr->verify_worker_mutex);
+			continue;
+		}
+
+		job->res = cef_valid_msg_verify (job->msg, job->payload_len + job->header_len);
+		hdl_wkr->verify_packets++;
+		if (job->res != 0) {
+			hdl_wkr->fail_packets++;
+		}
+
+		/* The main loop keeps the messages in flight within the queue size, 	*/
+		/* so that this never fails 											*/
+		cef_rngque_push (hdl_wkr->done_que, job);
+		cefnetd_event_wakeup (hdl);
+	}
+
+	pthread_exit (NULL);
+
+	return NULL;
+}
+/*--------------------------------------------------------------------------------------
+	Creates the signature verification workers
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails */
+cefnetd_verify_workers_start (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	CefT_Netd_VerifyWorker* hdl_wkr;
+	int i;
+
+	for (i = 0 ; i < hdl->verify_worker_num ; i++) {
+		hdl_wkr = &verify_worker_hdl[i];
+		memset (hdl_wkr, 0x00, sizeof (CefT_Netd_VerifyWorker));
+		hdl_wkr->worker_id = i;
+		hdl_wkr->hdl_cefnetd = hdl;
+		pthread_mutex_init (&hdl_wkr->verify_worker_mutex, NULL);
+		pthread_cond_init (&hdl_wkr->verify_worker_cond, NULL);
+
+		hdl->verify_req_que[i]
+			= cef_rngque_create_ext (CefC_VerifyWorkerQueue, CefC_Rngque_Spsc);
+		hdl->verify_done_que[i]
+			= cef_rngque_create_ext (CefC_VerifyWorkerQueue, CefC_Rngque_Spsc);
+		if ((hdl->verify_req_que[i] == NULL) || (hdl->verify_done_que[i] == NULL)) {
+			cef_log_write (CefC_Log_Error,
+				"Failed to cef_rngque_create [%d/%d]\n", i, hdl->verify_worker_num);
+			return (-1);
+		}
+		hdl_wkr->req_que  = hdl->verify_req_que[i];
+		hdl_wkr->done_que = hdl->verify_done_que[i];
+
+		if (cef_pthread_create (&cefnetd_verify_worker_th, NULL
+				, &cefnetd_verify_worker_thread, hdl_wkr) == -1) {
+			return (-1);
+		}
+	}
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Handles the messages whose signatures have been verified by the workers
+----------------------------------------------------------------------------------------*/
+static void
+cefnetd_verify_workers_done_process (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	CefT_Verify_Job* job;
+	void* jobs[CefC_Max_UdpInputSegs];
+	int i, n, num;
+
+	for (i = 0 ; i < hdl->verify_worker_num ; i++) {
+		while ((num = cef_rngque_pop_bulk (
+				hdl->verify_done_que[i], jobs, CefC_Max_UdpInputSegs)) > 0) {
+			verify_worker_hdl[i].inflight -= num;
+			for (n = 0 ; n < num ; n++) {
+				job = (CefT_Verify_Job*) jobs[n];
+				/* The Face may have been closed during the verification 	*/
+				if (cef_face_get_fd_from_faceid (job->peer_faceid) == job->fd) {
+					hdl->verified_msg = job->msg;
+					hdl->verified_res = job->res;
+					(*cefnetd_incoming_msg_process[job->msg[1]])
+						(hdl, job->faceid, job->peer_faceid,
+							job->msg, job->payload_len, job->header_len, job->user_id);
+					hdl->verified_msg = NULL;
+				}
+				free (job);
+			}
+		}
+	}
+}
+#endif // CefC_Netd_VerifyWorker
+/*--------------------------------------------------------------------------------------
+	Passes the message signed with a public key to a signature verification worker
+----------------------------------------------------------------------------------------*/
+static int										/* 1 if a worker takes the message, or	*/
+												/* a negative value if it should be		*/
+												/* handled now							*/
+cefnetd_verify_workers_dispatch (
+	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
+	int faceid, 								/* Face-ID where messages arrived at	*/
+	int peer_faceid, 							/* Face-ID to reply to the origin of 	*/
+												/* transmission of the message(s)		*/
+	unsigned char* msg, 						/* received message to handle			*/
+	uint16_t payload_len, 						/* Payload Length of this message		*/
+	uint16_t header_len,						/* Header Length of this message		*/
+	char* user_id
+) {
+#ifdef CefC_Netd_VerifyWorker
+	CefT_Netd_VerifyWorker* hdl_wkr = NULL;
+	CefT_Verify_Job* job;
+	int i, n;
 
-	/* Looks up the peer Face-ID 		*/
-	protocol = cef_face_get_protocol_from_fd (fd);
-	peer_faceid = cef_face_lookup_peer_faceid (sas_p/*&sas*/, sas_len, protocol, user_id);	//0.8.3
-	if (peer_faceid < 0) {
-		cef_log_write (CefC_Log_Error, "cef_face_lookup_peer_faceid() missing the fd=%d, sas_len=%d.\n", fd, sas_len);
+	if (hdl->verify_worker_num == 0) {
 		return (-1);
 	}
-
-#ifdef __APPLE__
-	{
-		CefT_Face*	face;
-		int			ifindex;
-		int			rc;
-
-		struct sockaddr_storage ss;
-		socklen_t sslen = sizeof(ss);
-
-		if ((rc = getsockname(fd, (struct sockaddr *)&ss, &sslen)) < 0){
+	switch (msg[1]) {
+		case CefC_PT_INTEREST:
+		case CefC_PT_OBJECT: {
+			break;
+		}
+		case CefC_PT_INTRETURN: {
+			/* Interest Return is not verified when it is not handled 	*/
+			if (hdl->IR_Option == 0) {
+				return (-1);
+			}
+			break;
+		}
+		default: {
 			return (-1);
 		}
-		if (((struct sockaddr *)&ss)->sa_family == AF_INET6) {
-			face = cef_face_get_face_from_faceid (peer_faceid);
-			if (face->ifindex == -1) {
-				CefT_Hash_Handle* sock_tbl;
-				CefT_Sock* sock;
-				struct in6_pktinfo pinfo;
-				char dst_addr[256];
-				sock_tbl = cef_face_return_sock_table ();
-				sock = (CefT_Sock*) cef_hash_tbl_item_get_from_index (*sock_tbl, face->index);
+	}
+	if (cef_valid_msg_pubkey_signed (msg, payload_len + header_len) == 0) {
+		return (-1);
+	}
 
-				{/* get ifindex */
-					char	*ifname_p;
-					char	hostname[NI_MAXHOST];
-					int		result;
-					result = getnameinfo ((struct sockaddr*) sas_p, sas_len,
-											hostname, sizeof (hostname), 0, 0, NI_NUMERICHOST);
-					if (result != 0) {
-						cef_log_write (CefC_Log_Error, "%s (getnameinfo:%s)\n", __func__, gai_strerror(result));
-						return (-1);
-					}
-					ifname_p = strchr(hostname, '%');
-					if(ifname_p == NULL){
-						cef_log_write (CefC_Log_Error, "%s IPv6 UDP recive error\n", __func__);
-						return (-1);
-					}
-					ifindex = if_nametoindex(ifname_p+1);
-					if (ifindex == 0) {
-						cef_log_write (CefC_Log_Error, "%s if_nametoindex(%s) error: %s\n",
-										__func__, ifname_p, strerror(errno));
-						return (-1);
-					 }
-				}
-				face->ifindex = ifindex;
-				if(face->ifindex != -1){
-					getnameinfo (sock->ai_addr, sock->ai_addrlen, dst_addr, sizeof(dst_addr),
-									NULL, 0, NI_NUMERICHOST);
-					if(strncmp(dst_addr, "fe80::", 6) == 0) { /* IPv6 linklocal address */
-						pinfo.ipi6_addr = in6addr_any;
-						pinfo.ipi6_ifindex = face->ifindex;
-						if(setsockopt(sock->skfd, IPPROTO_IPV6, IPV6_PKTINFO, &pinfo, sizeof(struct in6_pktinfo)) == -1){
-							return(-1);
-						}
-					}
-				}
-			}
+	/* Selects the worker in round robin, skipping the busy ones 	*/
+	for (i = 0 ; i < hdl->verify_worker_num ; i++) {
+		n = (hdl->verify_worker_next + i) % hdl->verify_worker_num;
+		if (verify_worker_hdl[n].inflight < CefC_VerifyWorkerQueue) {
+			hdl_wkr = &verify_worker_hdl[n];
+			hdl->verify_worker_next = (n + 1) % hdl->verify_worker_num;
+			break;
 		}
 	}
-#endif
+	if (hdl_wkr == NULL) {
+		verify_worker_hdl[hdl->verify_worker_next].inline_packets++;
+		return (-1);
+	}
 
-	/* Handles the received CEFORE message 	*/
-	cefnetd_input_message_process (hdl, faceid, peer_faceid, buff, (int) recv_len, user_id);
+	job = (CefT_Verify_Job*) malloc (sizeof (CefT_Verify_Job) + payload_len + header_len);
+	if (job == NULL) {
+		return (-1);
+	}
+	job->faceid 		= faceid;
+	job->peer_faceid 	= peer_faceid;
+	job->fd 			= cef_face_get_fd_from_faceid (peer_faceid);
+	job->res 			= -1;
+	job->payload_len 	= payload_len;
+	job->header_len 	= header_len;
+	if (user_id) {
+		snprintf (job->user_id, sizeof (job->user_id), "%s", user_id);
+	} else {
+		job->user_id[0] = 0x00;
+	}
+	memcpy (job->msg, msg, payload_len + header_len);
+
+	cef_rngque_push (hdl_wkr->req_que, job);
+	hdl_wkr->inflight++;
+	pthread_mutex_lock (&hdl_wkr->verify_worker_mutex);
+	pthread_cond_signal (&hdl_wkr->verify_worker_cond);
+	pthread_mutex_unlock (&hdl_wkr->verify_worker_mutex);
 
 	return (1);
+#else // CefC_Netd_VerifyWorker
+	return (-1);
+#endif // CefC_Netd_VerifyWorker
 }
-
-#define	CefC_Max_UdpInputSegs	32
-static int
-cefnetd_udp_input_process (
+/*--------------------------------------------------------------------------------------
+	Checks the Validation of the message, reusing the result of the verification
+	worker if the message has come from it
+----------------------------------------------------------------------------------------*/
+static int 										/* If the return value is 0 the code is	*/
+												/* equal, otherwise it is different		*/
+cefnetd_valid_msg_verify (
 	CefT_Netd_Handle* hdl,						/* cefnetd handle						*/
-	int fd, 									/* FD which is polled POLLIN			*/
-	int faceid									/* Face-ID that message arrived 		*/
+	const unsigned char* msg,
+	int msg_len
 ) {
-	int i, ret = 1;
-
-	for ( i = 0; 0 < ret && i < CefC_Max_UdpInputSegs; i++ ){
-		struct pollfd pollfd;
-
-		pollfd.fd = fd;
-		pollfd.events = POLLIN;
-		pollfd.revents = 0;
-		ret = cefnetd_udp_input_process_core (hdl, fd, faceid);
-		poll (&pollfd, 1, 0);
-		if (!(pollfd.revents & POLLIN))
-			break;
+#ifdef CefC_Netd_VerifyWorker
+	if (msg == hdl->verified_msg) {
+		return (hdl->verified_res);
 	}
-
-	return (ret);
+#endif // CefC_Netd_VerifyWorker
+	return (cef_valid_msg_verify (msg, msg_len));
 }
 
 /*--------------------------------------------------------------------------------------
@@ -3130,7 +4808,8 @@ cef_dbg_write (CefC_Dbg_Finer, "invalid message:res=%d, rcv_len=%u, fdv_payload_
 					"Detects the unknown PT_XXX=%d\n", packet[1]);
 				face->rcvbuf.rcv_len = 0;
 				break;
-			} else {
+			} else if (cefnetd_verify_workers_dispatch (hdl, faceid, peer_faceid,
+							packet, fdv_payload_len, fdv_header_len, user_id) < 0) {
 				(*cefnetd_incoming_msg_process[packet[1]])
 					(hdl, faceid, peer_faceid,
 							packet, fdv_payload_len, fdv_header_len, user_id);
@@ -3192,6 +4871,29 @@ cef_dbg_write (CefC_Dbg_Finer, "rcv_len=%u, move_len=%u, msg_size=%u\n", hdl->cs
 		msg += move_len;
 
 		while (hdl->cs_stat->rcvbuf.rcv_len > 0) {
+			/* Answers to the batched lookups are framed like CCNx messages 	*/
+			if ((hdl->cs_stat->rcvbuf.rcv_len >= CefC_Csmgr_Answer_HeaderLen) &&
+				(hdl->cs_stat->rcvbuf.rcv_buff[CefC_O_Fix_Ver] == CefC_Version) &&
+				(hdl->cs_stat->rcvbuf.rcv_buff[CefC_O_Fix_Type] == CefC_Csmgr_PT_Answer)) {
+				uint16_t pkt_len;
+
+				memcpy (&pkt_len,
+					&hdl->cs_stat->rcvbuf.rcv_buff[CefC_O_Fix_PacketLength], CefC_S_Length);
+				pkt_len = ntohs (pkt_len);
+				if (pkt_len >= CefC_Csmgr_Answer_HeaderLen) {
+					if (pkt_len > hdl->cs_stat->rcvbuf.rcv_len) {
+						break;
+					}
+					cef_csmgr_link_answer_process (
+						hdl->cs_stat, hdl->cs_stat->rcvbuf.rcv_buff, pkt_len);
+					memmove (hdl->cs_stat->rcvbuf.rcv_buff,
+						hdl->cs_stat->rcvbuf.rcv_buff + pkt_len,
+						hdl->cs_stat->rcvbuf.rcv_len - pkt_len);
+					hdl->cs_stat->rcvbuf.rcv_len -= pkt_len;
+					continue;
+				}
+			}
+
 			/* Seeks the top of the message */
 			res = cefnetd_messege_head_seek (-1,
 						&(hdl->cs_stat->rcvbuf), &fdv_payload_len, &fdv_header_len);
@@ -3284,7 +4986,7 @@ cefnetd_incoming_interest_process (
 	}
 
 	/* Checks the Validation 			*/
-	res = cef_valid_msg_verify (msg, payload_len + header_len);
+	res = cefnetd_valid_msg_verify (hdl, msg, payload_len + header_len);
 	if (res != 0) {
 		/***********************************************************************
 			[rfc8569] 2.4.4. Interest Pipeline
@@ -4278,7 +5980,7 @@ cefnetd_incoming_object_process_core (
 	}
 
 	/* Checks the Validation 			*/
-	res = cef_valid_msg_verify (msg, payload_len + header_len);
+	res = cefnetd_valid_msg_verify (hdl, msg, payload_len + header_len);
 	if (res != 0) {
 		cef_log_write (CefC_Log_Info, "Drops a malformed Object.\n");
 		return (-1);
@@ -4621,7 +6323,7 @@ cefnetd_incoming_intreturn_process (
 	}
 
 	/* Checks the Validation 			*/
-	res = cef_valid_msg_verify (msg, payload_len + header_len);
+	res = cefnetd_valid_msg_verify (hdl, msg, payload_len + header_len);
 	if (res != 0) {
 		cef_log_write (CefC_Log_Info, "Drops a malformed Interest Return.\n");
 		return (-1);
@@ -5961,6 +7663,13 @@ cefnetd_config_read (
 				return (-1);
 			}
 			hdl->babel_use_f = res;
+		} else if (strcmp (pname, CefC_ParamName_LocalShmRing) == 0) {
+			res = atoi (ws);
+			if ((res != 0) && (res != 1)) {
+				cef_log_write (CefC_Log_Error, "LOCAL_SHM_RING must be 0 or 1.\n");
+				return (-1);
+			}
+			hdl->shmring_use_f = res;
 		} else if (strcmp (pname, CefC_ParamName_Babel_Route) == 0) {
 			if (strcmp (ws, "udp") == 0) {
 				hdl->babel_route = 0x02;
@@ -6305,6 +8014,26 @@ cefnetd_config_read (
 			hdl->tx_worker_num = num;
 		}
 #endif // CefC_TxMultiThread
+#ifdef CefC_Netd_RxWorker
+		else if (strcmp (pname, "RX_WORKER_NUM") == 0) {
+			long num = strtol (ws, NULL, 10);
+			if ( num < 0 || CefC_RxWorkerMax < num ){
+				cef_log_write (CefC_Log_Error, "RX_WORKER_NUM must be lower than %d.\n", CefC_RxWorkerMax+1);
+				return (-1);
+			}
+			hdl->rx_worker_num = num;
+		}
+#endif // CefC_Netd_RxWorker
+#ifdef CefC_Netd_VerifyWorker
+		else if (strcmp (pname, "VERIFY_WORKER_NUM") == 0) {
+			long num = strtol (ws, NULL, 10);
+			if ( num < 0 || CefC_VerifyWorkerMax < num ){
+				cef_log_write (CefC_Log_Error, "VERIFY_WORKER_NUM must be lower than %d.\n", CefC_VerifyWorkerMax+1);
+				return (-1);
+			}
+			hdl->verify_worker_num = num;
+		}
+#endif // CefC_Netd_VerifyWorker
 		else if (strcmp (pname, "TX_QUEUE_SIZE") == 0) {
 			long num = strtol (ws, NULL, 10);
 			if ( num < CefC_Tx_Que_Size ){
@@ -6388,6 +8117,13 @@ cefnetd_config_read (
 	cef_dbg_write (CefC_Dbg_Fine, "TX_WORKER_NUM = %d\n", hdl->tx_worker_num);
 #endif // CefC_TxMultiThread
 	cef_dbg_write (CefC_Dbg_Fine, "TX_QUEUE_SIZE = %d\n", hdl->tx_que_size);
+#ifdef CefC_Netd_RxWorker
+	cef_dbg_write (CefC_Dbg_Fine, "RX_WORKER_NUM = %d\n", hdl->rx_worker_num);
+#endif // CefC_Netd_RxWorker
+#ifdef CefC_Netd_VerifyWorker
+	cef_dbg_write (CefC_Dbg_Fine, "VERIFY_WORKER_NUM = %d\n", hdl->verify_worker_num);
+#endif // CefC_Netd_VerifyWorker
+	cef_dbg_write (CefC_Dbg_Fine, "LOCAL_SHM_RING = %d\n", hdl->shmring_use_f);
 	cef_dbg_write (CefC_Dbg_Fine, "UDP_LISTEN_ADDR = %s\n", hdl->udp_listen_addr);
 
 	if ( hdl->My_Node_Name != NULL ) {
@@ -7000,14 +8736,7 @@ cef_dbg_write (CefC_Dbg_Finer, "\t entry=%p, now="FMTU64", adv_lifetime_us="FMTU
 		return;
 	}
 
-	if (now < entry->clean_us) {
-#ifdef	__PIT_CLEAN__
-cef_dbg_write (CefC_Dbg_Finer, "\t(now < entry->clean_us) RETURN\n" );
-#endif
-		return;
-	}
-	entry->clean_us = now + CefC_Pit_CleaningTime;
-
+	/* The expiry wheel calls this when a Down Face expires 		*/
 	dnface = &(entry->dnfaces);
 	dnface_prv = dnface;
 
@@ -7049,167 +8778,87 @@ cefnetd_pit_cleanup (
 	CefT_Netd_Handle* hdl, 						/* cefnetd handle						*/
 	uint64_t nowt								/* current time (usec) 					*/
 ) {
-	CefT_Pit_Entry* pe;
-	CefT_Down_Faces* face;
-	int idx;
-	int clean_num = 0;
-	int rec_index = 0;
-	int end_index;
-	int end_flag = 0;
+
+	cefnetd_pit_expiry_process (hdl, hdl->pit, nowt);
+	cefnetd_pit_expiry_process (hdl, hdl->app_pit, nowt);
 
 	if ( nowt < hdl->pit_clean_t )
 		return;
+	hdl->pit_clean_t = nowt + CefC_Pit_CleaningTime;
 
-	int pit_num = cef_lhash_tbl_item_num_get(hdl->pit);
-	end_index = hdl->pit_clean_i;
-
-#ifdef	__PIT_CLEAN__
-	if (pit_num > 0) {
-		fprintf(stderr, "[%s] pit_num=%d, end_index=%d\n", __func__, pit_num, end_index);
-	}
-#endif
+	cef_log_flush ();
 
-	for (end_flag = clean_num = 0; clean_num < pit_num; ) {
-		uint32_t elem_num, elem_index, eidx;
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Cleans the PIT entries whose Down Faces or lifetime expired
+----------------------------------------------------------------------------------------*/
+static int										/* Number of the checked entries		*/
+cefnetd_pit_expiry_process (
+	CefT_Netd_Handle* hdl, 						/* cefnetd handle						*/
+	CefT_Hash_Handle pit,						/* PIT									*/
+	uint64_t nowt								/* current time (usec) 					*/
+) {
+	CefT_Pit_Entry* pe;
+	CefT_Down_Faces* face;
+	int idx;
+	int clean_num = 0;
 
-		pe = (CefT_Pit_Entry*) cef_lhash_tbl_elem_get (hdl->pit, &(hdl->pit_clean_i), &elem_num);
+	/* Only the entries whose timer expired are visited 		*/
+	if (cef_pit_expiry_advance (pit, nowt) < 1) {
+		return (0);
+	}
 
-		if (hdl->pit_clean_i == end_index) {
-			end_flag++;
-			if (end_flag > 1) {
-				break;
-			}
-		}
-		rec_index = hdl->pit_clean_i;
-		hdl->pit_clean_i++;
+	while ((pe = cef_pit_expiry_pop (pit)) != NULL) {
 
-		if (pe == NULL) {
-			break;
+		if (!cef_pit_entry_lock (pe)) {
+			/* Retries at the next tick 		*/
+			cef_pit_entry_expiry_refresh (pe);
+			continue;
 		}
-#ifdef	__PIT_CLEAN__
-fprintf( stderr, "[%s] elem_get rec_index=%d, elm_num=%d\n", __func__, rec_index, elem_num);
-#endif
+		clean_num++;
+		cefnetd_pit_entry_clean (hdl, pit, pe);
 
-		for (eidx = 0, elem_index = 0; elem_index < elem_num; elem_index++) {
-			pe = (CefT_Pit_Entry*)
-					cef_lhash_tbl_item_get_from_index (hdl->pit, rec_index, eidx);
+		/* Indicates that a PIT entry was deleted to Transport  	*/
+		if ((pit == hdl->pit) && (hdl->plugin_hdl.tp[pe->tp_variant].pit)) {
+			CefT_Rx_Elem_Sig_DelPit sig_delpit;
 
-			if (!pe || !cef_pit_entry_lock(pe) ){
-				eidx++;
-				continue;
-			}
-
-			clean_num++;
-			cefnetd_pit_entry_clean (hdl, hdl->pit, pe);
-
-			/* Indicates that a PIT entry was deleted to Transport  	*/
-			if (hdl->plugin_hdl.tp[pe->tp_variant].pit) {
-				CefT_Rx_Elem_Sig_DelPit sig_delpit;
-
-				memset(&sig_delpit, 0x00, sizeof(sig_delpit));
-
-				/* Records PIT entries ware deleted  	*/
-				face = &(pe->clean_dnfaces);
-				idx = 0;
-
-				while (face->next) {
-					face = face->next;
-					sig_delpit.faceids[idx] = face->faceid;
-					idx++;
-				}
-
-				if (idx > 0) {
-
-					sig_delpit.faceid_num = idx;
-					sig_delpit.hashv = pe->hashv;
-
-					(*(hdl->plugin_hdl.tp)[pe->tp_variant].pit)(
-						&(hdl->plugin_hdl.tp[pe->tp_variant]), &sig_delpit);
-				}
-			}
-
-			if (pe->drp_lifetime_us < nowt) {	// 2023/04/05 by iD
-#ifdef	__PIT_CLEAN__
-fprintf( stderr, "[%s] cef_pit_entry_free()\n", __func__ );
-#endif
-#ifdef	CefC_Debug
-cef_dbg_write (CefC_Dbg_Finest, "now_t="FMTU64" , pe->drp_lifetime_us= "FMTU64"\n", nowt, pe->drp_lifetime_us );
-#endif // CefC_Debug
+			memset(&sig_delpit, 0x00, sizeof(sig_delpit));
 
-				cef_pit_entry_free (hdl->pit, pe);
+			/* Records PIT entries ware deleted  	*/
+			face = &(pe->clean_dnfaces);
+			idx = 0;
 
-			} else {
-				cef_pit_entry_unlock(pe);
-				eidx++;
+			while (face->next) {
+				face = face->next;
+				sig_delpit.faceids[idx] = face->faceid;
+				idx++;
 			}
-		}
-	}
 
-	pit_num = cef_lhash_tbl_item_num_get(hdl->app_pit);
-	end_index = hdl->app_pit_clean_i;
+			if (idx > 0) {
 
-#ifdef	CefC_Debug
-	if (pit_num > 0) {
-		cef_dbg_write (CefC_Dbg_Finest, "app_pit_num=%d, end_index=%d\n", pit_num, end_index);
-	}
-#endif
-
-	for (end_flag = clean_num = 0; clean_num < pit_num; ) {
-		uint32_t elem_num, elem_index, eidx;
+				sig_delpit.faceid_num = idx;
+				sig_delpit.hashv = pe->hashv;
 
-		pe = (CefT_Pit_Entry*) cef_lhash_tbl_elem_get (hdl->app_pit, &(hdl->app_pit_clean_i), &elem_num);
-
-		if (hdl->app_pit_clean_i == end_index) {
-			end_flag++;
-			if (end_flag > 1) {
-				break;
+				(*(hdl->plugin_hdl.tp)[pe->tp_variant].pit)(
+					&(hdl->plugin_hdl.tp[pe->tp_variant]), &sig_delpit);
 			}
 		}
-		rec_index = hdl->app_pit_clean_i;
-		hdl->app_pit_clean_i++;
-
-		if (pe == NULL) {
-			break;
-		}
-#ifdef	__PIT_CLEAN__
-fprintf( stderr, "[%s:%d] elem_get end_index=%d, rec_index=%d, elem_num=%d\n", __func__, __LINE__,
-	end_index, rec_index, elem_num);
-#endif
-
-		for (eidx = 0, elem_index = 0; elem_index < elem_num; elem_index++) {
-			pe = (CefT_Pit_Entry*)
-					cef_lhash_tbl_item_get_from_index (hdl->app_pit, rec_index, eidx);
-
-			if (!pe || !cef_pit_entry_lock(pe) ){
-#ifdef	CefC_Debug
-cef_dbg_write (CefC_Dbg_Fine, "pe=%p, lock failure.\n", pe);
-#endif // CefC_Debug
-				eidx++;
-				continue;
-			}
 
-			clean_num++;
-			cefnetd_pit_entry_clean (hdl, hdl->app_pit, pe);
-
-			if (pe->drp_lifetime_us < nowt) {	// 2023/04/05 by iD
+		if (pe->drp_lifetime_us < nowt) {	// 2023/04/05 by iD
 #ifdef	CefC_Debug
 cef_dbg_write (CefC_Dbg_Finest, "now_t="FMTU64" , pe->drp_lifetime_us= "FMTU64"\n", nowt, pe->drp_lifetime_us );
 #endif // CefC_Debug
 
-				cef_pit_entry_free (hdl->app_pit, pe);
+			cef_pit_entry_free (pit, pe);
 
-			} else {
-				cef_pit_entry_unlock(pe);
-				eidx++;
-			}
+		} else {
+			cef_pit_entry_expiry_refresh (pe);
+			cef_pit_entry_unlock(pe);
 		}
 	}
 
-	hdl->pit_clean_t = nowt + CefC_Pit_CleaningTime;
-
-	cef_log_flush ();
-
-	return;
+	return (clean_num);
 }
 /*--------------------------------------------------------------------------------------
 	Obtains my NodeID (IP Address)
@@ -8723,6 +10372,10 @@ cefnetd_transmit_worker_thread (
 	int		   worker_id = hdl_wkr->worker_id;	/* worker id */
 	long	   t_sleep = 0;
 	struct timeval tv_prev = { 0, 0 };
+	CefT_Tx_Batch batch;
+
+	memset (&batch, 0, sizeof (CefT_Tx_Batch));
+	batch.tx_que_mp = hdl_wkr->tx_que_mp;
 
 	while (!cefnetd_running_f) {
 		const struct timespec ts = { 0, 100*1000*1000 };
@@ -8744,6 +10397,16 @@ cef_dbg_write (CefC_Dbg_Finer, "tv_interval=%ld.%06ld.\n", hdl_wkr->tx_packet_in
 		if (!tx_elem){
 			struct timespec ts = { 0, 0 };
 
+			/* Sends the messages coalesced while the queue was not empty 	*/
+			if ( batch.elem_num ){
+				cefnetd_tx_batch_flush (&batch);
+				hdl_wkr->tx_packets   = batch.tx_packets;
+				hdl_wkr->tx_bytes     = batch.tx_bytes;
+				hdl_wkr->drop_packets = batch.drop_packets;
+				hdl_wkr->drop_bytes   = batch.drop_bytes;
+				continue;
+			}
+
 			if ( CefC_Sleep_Max < ++t_sleep )
 				t_sleep = CefC_Sleep_Max;
 
@@ -8783,7 +10446,7 @@ cef_dbg_write (CefC_Dbg_Finer, "tv_sleep=%ld.%06ld.\n", tv_sleep.tv_sec, tv_slee
 cef_dbg_write (CefC_Dbg_Fine, "ASSERT tx_elem=%p, faceid=%d, msg_type=0x%02x, msg_len=%d\n", tx_elem, faceid, tx_elem->msg[CefC_O_Fix_Type], tx_elem->msg_len);
 #endif // CefC_Debug
 			/* Free the pooled block 	*/
-			cef_mpool_free (hdl_wkr->tx_que_mp, tx_elem);
+			cef_plugin_tx_elem_free (hdl_wkr->tx_que_mp, tx_elem);
 			continue;
 		}
 
@@ -8791,19 +10454,21 @@ cef_dbg_write (CefC_Dbg_Fine, "ASSERT tx_elem=%p, faceid=%d, msg_type=0x%02x, ms
 cef_dbg_write (CefC_Dbg_Finer, "tx_elem=%p, faceid=%d, msg_type=0x%02x, msg_len=%d\n", tx_elem, faceid, tx_elem->msg[CefC_O_Fix_Type], tx_elem->msg_len);
 #endif // CefC_Debug
 
-		if (cef_face_check_active (faceid)){
+		if (cef_face_check_active (faceid)
+				&& cef_frame_get_opt_seqnum_f() && tx_elem->msg[CefC_O_Fix_Type] == CefC_PT_OBJECT) {
 			unsigned char new_buff[CefC_Max_Length];
-			unsigned char *ptr_msg = tx_elem->msg;
-			size_t   msg_len = tx_elem->msg_len;
-			int		ret = msg_len;
-
-			if (cef_frame_get_opt_seqnum_f() && tx_elem->msg[CefC_O_Fix_Type] == CefC_PT_OBJECT) {
-				uint32_t	seqnum;
-				seqnum = cef_face_get_seqnum_from_faceid (faceid);
-				msg_len =
-					cef_frame_seqence_update (new_buff, tx_elem->msg, seqnum);
-				ptr_msg = new_buff;
-			}
+			unsigned char *ptr_msg = new_buff;
+			size_t   msg_len;
+			int		ret;
+			uint32_t	seqnum;
+
+			/* Each copy carries its own sequence number, so it is sent at once 	*/
+			cefnetd_tx_batch_flush (&batch);
+
+			seqnum = cef_face_get_seqnum_from_faceid (faceid);
+			msg_len =
+				cef_frame_seqence_update (new_buff, tx_elem->msg, seqnum);
+			ret = msg_len;
 			/* In transmit threads, the default value of 0 is treated as a special value of 1. */
 			/* If less than 0, it will not be transmit. */
 			if ( tx_elem->tx_copies == 0 ){	tx_elem->tx_copies = 1; }	/* default:1 */
@@ -8834,17 +10499,34 @@ cef_dbg_write (CefC_Dbg_Finer, "tx_elem=%p, faceid=%d, msg_type=0x%02x, msg_len=
 					cef_log_write (CefC_Log_Warn, "Worker#%d Face#%d send err=%d:%s\n",
 						worker_id, faceid, errno, strerror(errno));
 				}
-				hdl_wkr->drop_packets++;
-				hdl_wkr->drop_bytes += (msg_len - ret);
-				continue;
+				batch.drop_packets++;
+				batch.drop_bytes += (msg_len - ret);
+			} else {
+				batch.tx_packets++;
+				batch.tx_bytes += msg_len;
+			}
+		} else if (cef_face_check_active (faceid)) {
+			/* In transmit threads, the default value of 0 is treated as a special value of 1. */
+			/* If less than 0, it will not be transmit. */
+			if ( tx_elem->tx_copies == 0 ){	tx_elem->tx_copies = 1; }	/* default:1 */
+			for (int j = 0 ; j < tx_elem->tx_copies ; j++) {
+				cefnetd_tx_batch_add (&batch, faceid, tx_elem->msg, tx_elem->msg_len);
 			}
-			hdl_wkr->tx_packets++;
-			hdl_wkr->tx_bytes += msg_len;
 		}
 
-		/* Free the pooled block 	*/
-		cef_mpool_free (hdl_wkr->tx_que_mp, tx_elem);
+		/* The pooled block is freed when the batch is flushed 	*/
+		cefnetd_tx_batch_hold (&batch, tx_elem);
+
+		/* Pacing is applied per message, so nothing is coalesced 	*/
+		if ( 0 < (hdl_wkr->tx_packet_interval.tv_usec) ){
+			cefnetd_tx_batch_flush (&batch);
+		}
+		hdl_wkr->tx_packets   = batch.tx_packets;
+		hdl_wkr->tx_bytes     = batch.tx_bytes;
+		hdl_wkr->drop_packets = batch.drop_packets;
+		hdl_wkr->drop_bytes   = batch.drop_bytes;
 	}
+	cefnetd_tx_batch_flush (&batch);
 #ifdef CefC_Debug
 cef_dbg_write (CefC_Dbg_Finer, " worker#%d thread exit..\n", worker_id);
 #endif // CefC_Debug
@@ -8908,7 +10590,7 @@ cefnetd_txque_throwaway (
 cef_dbg_write (CefC_Dbg_Finer, "tx_elem=%p, msg_type=0x%02x, msg_len=%d\n", tx_elem, tx_elem->msg[CefC_O_Fix_Type], tx_elem->msg_len);
 #endif // CefC_Debug
 		/* Free the pooled block 	*/
-		cef_mpool_free (hdl->tx_que_mp, tx_elem);
+		cef_plugin_tx_elem_free (hdl->tx_que_mp, tx_elem);
 	}
 
 	pthread_mutex_unlock(&cefnetd_txqueue_mutex);
@@ -8922,8 +10604,14 @@ cefnetd_transmit_main_thread (
 	int	t_sleep = 0;
 
 	CefT_Rngque		*tx_class[CefC_TxQueClass_Num];	/* 0:high, 1:normal, 2:low */
-	CefT_TxQueClass		tx_prio;
+	CefT_TxQueClass		tx_prio = CefT_TxQue_High;
 	int					tx_cnt = 0;
+#ifndef CefC_TxMultiThread
+	CefT_Tx_Batch		batch;
+
+	memset (&batch, 0, sizeof (CefT_Tx_Batch));
+	batch.tx_que_mp = hdl->tx_que_mp;
+#endif // CefC_TxMultiThread
 
 	tx_class[CefT_TxQue_High] = hdl->tx_que_high;
 	tx_class[CefT_TxQue_Normal] = hdl->tx_que;
@@ -8945,6 +10633,10 @@ cef_dbg_write (CefC_Dbg_Finer, "thread start..\n");
 		tx_elem = (CefT_Tx_Elem*) cef_rngque_pop (tx_class[tx_prio]);
 
 		if (!tx_elem){
+#ifndef CefC_TxMultiThread
+			/* Sends the messages coalesced while the queue was not empty 	*/
+			cefnetd_tx_batch_flush (&batch);
+#endif // CefC_TxMultiThread
 
 			tx_cnt = 0;
 			if ( ++tx_prio < CefC_TxQueClass_Num )
@@ -8971,7 +10663,7 @@ cef_dbg_write (CefC_Dbg_Finer, "tx_elem=%p, msg_type=0x%02x, msg_len=%d\n", tx_e
 
 		if (tx_elem->type > CefC_Elem_Type_Object) {
 			/* Free the pooled block 	*/
-			cef_mpool_free (hdl->tx_que_mp, tx_elem);
+			cef_plugin_tx_elem_free (hdl->tx_que_mp, tx_elem);
 			continue;
 		}
 
@@ -8985,13 +10677,18 @@ cef_dbg_write (CefC_Dbg_Finer, "tx_elem=%p, msg_type=0x%02x, msg_len=%d\n", tx_e
 			CefT_Tx_Elem *worker_elem;
 			int		j = 0;
 
-			/* Creates the forward packet buffer 				*/
+			/* Creates the forward packet, which shares the message of tx_elem 	*/
 			worker_elem = (CefT_Tx_Elem*) cef_mpool_alloc (hdl->tx_que_mp);
+			if ( !worker_elem ){
+				cef_log_write (CefC_Log_Error, "%s cef_mpool_alloc(%s)\n", __func__, strerror(errno));
+				break;
+			}
 			worker_elem->type = tx_elem->type;
-			memcpy(worker_elem->msg, tx_elem->msg, tx_elem->msg_len);
-			worker_elem->msg_len = tx_elem->msg_len;
+			cef_plugin_tx_elem_msg_share (worker_elem, tx_elem);
 			worker_elem->faceids[0] = tx_elem->faceids[i];
 			worker_elem->faceid_num = 1;
+			worker_elem->tx_prio = tx_elem->tx_prio;
+			worker_elem->tx_copies = tx_elem->tx_copies;
 
 			worker = cefnetd_transmit_worker_assign(hdl, worker_elem);
 
@@ -9007,42 +10704,54 @@ cef_dbg_write (CefC_Dbg_Finer, "tx_elem=%p, msg_type=0x%02x, msg_len=%d\n", tx_e
 				if ( ++j == CefC_QueuingRetryLimit ){
 					/* error:packet discard. */
 					cef_log_write (CefC_Log_Info, "Failed to dispatch to Worker#%d, discarded packet.\n", worker);
-					cef_mpool_free (hdl->tx_que_mp, worker_elem);
+					cef_plugin_tx_elem_free (hdl->tx_que_mp, worker_elem);
 					break;
 				}
 			}
 		}
 }
+		/* Free the pooled block 	*/
+		cef_plugin_tx_elem_free (hdl->tx_que_mp, tx_elem);
 #else // CefC_TxMultiThread
 		/*==============================================================*
 			Single thread
 		 *==============================================================*/
 		for (int i = 0 ; i < tx_elem->faceid_num ; i++) {
 			unsigned char new_buff[CefC_Max_Length];
-			unsigned char *ptr_msg = tx_elem->msg;
-			size_t   msg_len = tx_elem->msg_len;
-			int		ret = msg_len;
+			size_t   msg_len;
+			int		ret;
 
 			if (!cef_face_check_active (tx_elem->faceids[i]))
 				continue;
 
-			if (cef_frame_get_opt_seqnum_f() && tx_elem->msg[CefC_O_Fix_Type] == CefC_PT_OBJECT) {
+			/* In transmit threads, the default value of 0 is treated as a special value of 1. */
+			/* If less than 0, it will not be transmit. */
+			if ( tx_elem->tx_copies == 0 ){	tx_elem->tx_copies = 1; }	/* default:1 */
+
+			if (!(cef_frame_get_opt_seqnum_f() && tx_elem->msg[CefC_O_Fix_Type] == CefC_PT_OBJECT)) {
+				for (int j = 0 ; j < tx_elem->tx_copies ; j++) {
+					cefnetd_tx_batch_add (&batch,
+						tx_elem->faceids[i], tx_elem->msg, tx_elem->msg_len);
+				}
+				continue;
+			}
+
+			/* Each copy carries its own sequence number, so it is sent at once 	*/
+			cefnetd_tx_batch_flush (&batch);
+			{
 				uint32_t	seqnum;
 				seqnum = cef_face_get_seqnum_from_faceid (tx_elem->faceids[i]);
 				msg_len =
 					cef_frame_seqence_update (new_buff, tx_elem->msg, seqnum);
-				ptr_msg = new_buff;
 			}
-			/* In transmit threads, the default value of 0 is treated as a special value of 1. */
-			/* If less than 0, it will not be transmit. */
-			if ( tx_elem->tx_copies == 0 ){	tx_elem->tx_copies = 1; }	/* default:1 */
+			ret = msg_len;
 			for (int j = 0 ; ret == msg_len && j < tx_elem->tx_copies ; j++) {
-				ret = cef_face_frame_send (tx_elem->faceids[i], ptr_msg, msg_len);
+				ret = cef_face_frame_send (tx_elem->faceids[i], new_buff, msg_len);
 			}
 		}
+		/* The pooled block is freed when the batch is flushed 	*/
+		cefnetd_tx_batch_hold (&batch, tx_elem);
 #endif // CefC_TxMultiThread
-		/* Free the pooled block 	*/
-		cef_mpool_free (hdl->tx_que_mp, tx_elem);
 
 		if ( CefC_TxNormal_Threshold < ++tx_cnt ){
 			cefnetd_txque_throwaway(hdl, hdl->tx_que_low);
@@ -9108,8 +10817,11 @@ cef_dbg_write (CefC_Dbg_Finer, "tx_elem=%p, msg_type=0x%02x, msg_len=%zu\n", tx_
 	memcpy(tx_elem->faceids, faceid, sizeof(faceid[0])*faceid_num);
 	tx_elem->faceid_num = faceid_num;
 
-	tx_elem->msg_len = msg_len;
-	memcpy (tx_elem->msg, msg, msg_len);
+	if (cef_plugin_tx_elem_msg_set (tx_elem, msg, msg_len) < 0) {
+		cef_log_write (CefC_Log_Error, "%s cef_pktbuf_alloc(%zu) failed\n", __func__, msg_len);
+		cef_mpool_free (hdl->tx_que_mp, tx_elem);
+		return;
+	}
 
 	tx_elem->tx_prio = tx_prio;
 	tx_elem->tx_copies = tx_copies;
@@ -9149,7 +10861,7 @@ cef_dbg_write (CefC_Dbg_Finer, "tx_elem=%p, msg_type=0x%02x, msg_len=%zu\n", tx_
 #ifdef CefC_Debug
 cef_dbg_write (CefC_Dbg_Fine, "cef_rngque_push failed, discarded packet.\n");
 #endif // CefC_Debug
-		cef_mpool_free (hdl->tx_que_mp, tx_elem);
+		cef_plugin_tx_elem_free (hdl->tx_que_mp, tx_elem);
 	} else if ( j ){
 #ifdef CefC_Debug
 		cef_dbg_write (CefC_Dbg_Fine, "cef_rngque_push retry, %d times.\n", j);
@@ -55,6 +55,12 @@
 
 #include <openssl/sha.h>	//0.8.3
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#endif // __linux__
+
 #include <cefore/cef_define.h>
 #include <cefore/cef_fib.h>
 #include <cefore/cef_pit.h>
@@ -114,6 +120,59 @@
 #define CefC_Cefstatus_MsgSize		128
 
 #define CefC_Listen_Face_Max		CefC_Face_Router_Max
+
+/*------------------------------------------------------------------*/
+/* Event dispatch													*/
+/*------------------------------------------------------------------*/
+/* On Linux, the main loop waits on a persistent epoll set 			*/
+/* instead of rebuilding the poll set at every iteration			*/
+#ifdef __linux__
+#define CefC_Netd_Reactor
+#endif // __linux__
+#define CefC_Netd_Reactor_Events	256		/* Events returned by one epoll_wait	*/
+#define CefC_Netd_Reactor_Tick		100000	/* Interval of housekeeping (usec)		*/
+
+/*------------------------------------------------------------------*/
+/* UDP input														*/
+/*------------------------------------------------------------------*/
+/* On Linux, the datagrams queued on a UDP face are read by one 	*/
+/* recvmmsg call into the buffers held in the cefnetd handle		*/
+#ifdef __linux__
+#define CefC_Netd_RecvMmsg
+#endif // __linux__
+#define	CefC_Max_UdpInputSegs		32		/* Datagrams read per input event		*/
+#define	CefC_Max_LocalInputSegs		8		/* Reads from an application per event	*/
+
+/* With RX_WORKER_NUM, each worker thread binds its own SO_REUSEPORT	*/
+/* socket to every UDP listen address. The kernel spreads the flows 	*/
+/* over the workers, which only receive and queue the datagrams. 	*/
+/* This offloads the receive path; the forwarding (PIT, FIB and 	*/
+/* Content Store) is not sharded and stays on the main loop.		*/
+#if defined(CefC_Netd_Reactor) && defined(CefC_Netd_RecvMmsg)
+#define CefC_Netd_RxWorker
+#endif // CefC_Netd_Reactor && CefC_Netd_RecvMmsg
+#define	CefC_RxWorkerMax			32
+#define	CefC_RxWorkerDefault		0
+#define	CefC_RxWorkerFaceMax		16		/* UDP listen faces a worker clones		*/
+#define	CefC_RxWorkerQueue			4096	/* Datagrams queued by a worker			*/
+
+/* With VERIFY_WORKER_NUM, the RSA-SHA256 signatures of the received	*/
+/* messages are verified by worker threads, and the main loop handles	*/
+/* each message when the verification completes.					*/
+#ifdef CefC_Netd_Reactor
+#define CefC_Netd_VerifyWorker
+#endif // CefC_Netd_Reactor
+#define	CefC_VerifyWorkerMax		32
+#define	CefC_VerifyWorkerDefault	0
+#define	CefC_VerifyWorkerQueue		1024	/* Messages in flight to a worker		*/
+
+/* With LOCAL_SHM_RING, an application exchanges the frames with	*/
+/* cefnetd through the rings in a shared memory, and the socket is	*/
+/* only used for the control messages.								*/
+#ifdef CefC_Netd_Reactor
+#define CefC_Netd_Shmring
+#endif // CefC_Netd_Reactor
+#define	CefC_Max_ShmringInputSegs	64		/* Reads from the rings per event		*/
 #define	CefC_TxWorkerMax			32
 #define	CefC_TxWorkerDefault		(CefC_TxWorkerMax/4)
 #define	CefC_TxQueueDefault			(CefC_Tx_Que_Size*CefC_TxWorkerMax)
@@ -262,11 +321,14 @@ typedef struct {
 	int 				app_faces[CefC_App_Conn_Num];
 	int 				app_steps[CefC_App_Conn_Num];
 	uint8_t				app_fds_num;
+	uint8_t				shmring_use_f;			/* LOCAL_SHM_RING 						*/
+#ifdef CefC_Netd_Shmring
+	CefT_Shmring* 		app_shmrings[CefC_App_Conn_Num];
+												/* Rings shared with the application	*/
+#endif // CefC_Netd_Shmring
 
 	/********** Timers				***********/
 	uint64_t			pit_clean_t;
-	uint32_t 			pit_clean_i;
-	uint32_t 			app_pit_clean_i;
 	uint64_t			face_clean_t;
 	int16_t				face_lifetime;
 
@@ -328,6 +390,40 @@ typedef struct {
 	uint	 			tx_que_size;
 	CefT_Mp_Handle 		tx_que_mp;
 
+#ifdef CefC_Netd_Reactor
+	/********** Reactor 			***********/
+	int 				ep_fd;					/* epoll instance						*/
+	int 				ep_timer_fd;			/* timerfd for housekeeping				*/
+	int 				ep_wakeup_fd;			/* eventfd to wake up the main loop		*/
+	uint32_t 			ep_face_gen;			/* Face Table generation registered		*/
+	int 				ep_face_fd[CefC_Face_Router_Max];
+												/* FD registered for each Face-ID		*/
+#endif // CefC_Netd_Reactor
+
+#ifdef CefC_Netd_RxWorker
+	/********** UDP input workers 	***********/
+	uint16_t 			rx_worker_num;
+	CefT_Rngque* 		rx_worker_que[CefC_RxWorkerMax];
+#endif // CefC_Netd_RxWorker
+
+#ifdef CefC_Netd_VerifyWorker
+	/********** Signature verification workers 	***********/
+	uint16_t 			verify_worker_num;
+	uint16_t 			verify_worker_next;		/* Worker tried first by the next one	*/
+	CefT_Rngque* 		verify_req_que[CefC_VerifyWorkerMax];
+	CefT_Rngque* 		verify_done_que[CefC_VerifyWorkerMax];
+	const unsigned char* verified_msg;			/* Message handled after the worker		*/
+	int 				verified_res;			/* verified it, and the result			*/
+#endif // CefC_Netd_VerifyWorker
+
+#ifdef CefC_Netd_RecvMmsg
+	/********** Batched UDP input 	***********/
+	unsigned char* 		udp_rx_buf;				/* CefC_Max_UdpInputSegs buffers		*/
+	struct mmsghdr* 	udp_rx_msg;				/* headers passed to recvmmsg			*/
+	struct iovec* 		udp_rx_iov;
+	struct sockaddr_storage* udp_rx_sas;		/* source address of each datagram		*/
+#endif // CefC_Netd_RecvMmsg
+
 } CefT_Netd_Handle;
 
 typedef struct {
@@ -376,6 +472,13 @@ void
 cefnetd_event_dispatch (
 	CefT_Netd_Handle* hdl 						/* cefnetd handle						*/
 );
+/*--------------------------------------------------------------------------------------
+	Wakes up the main loop from other threads
+----------------------------------------------------------------------------------------*/
+void
+cefnetd_event_wakeup (
+	CefT_Netd_Handle* hdl 						/* cefnetd handle						*/
+);
 /*--------------------------------------------------------------------------------------
 	Forwards the specified Interest
 ----------------------------------------------------------------------------------------*/
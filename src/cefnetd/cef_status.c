@@ -144,6 +144,20 @@ static int
 cef_status_add_output_to_rsp_buf(
 	char* buff
 );
+/*--------------------------------------------------------------------------------------
+	Output PIT expiry status
+----------------------------------------------------------------------------------------*/
+static int
+cef_status_pit_expiry_output (
+	CefT_Netd_Handle* hdl
+);
+/*--------------------------------------------------------------------------------------
+	Output Memory Pool status
+----------------------------------------------------------------------------------------*/
+static int
+cef_status_mpool_output (
+	CefT_Netd_Handle* hdl
+);
 #if ((defined CefC_CefnetdCache) && (defined CefC_Develop))
 /*--------------------------------------------------------------------------------------
 	Output LocalCache status
@@ -251,6 +265,23 @@ cef_status_stats_output (
 			(unsigned long long)hdl->stat_send_frames,
 			cache_type,
 			hdl->forwarding_strategy);
+	if (hdl->cs_stat && hdl->cs_stat->shm_base) {
+		sprintf (work_str, "Cache Index Hits : %llu\n"
+			, (unsigned long long) hdl->cs_stat->shm_hits);
+		if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+			goto endfunc;
+		}
+	}
+	if (hdl->cs_stat && hdl->cs_stat->link_req_tbl) {
+		sprintf (work_str, "Cache Lookups    : hit %llu, miss %llu, skip %llu, pending %u\n"
+			, (unsigned long long) hdl->cs_stat->link_hits
+			, (unsigned long long) hdl->cs_stat->link_misses
+			, (unsigned long long) hdl->cs_stat->link_skips
+			, hdl->cs_stat->link_pending);
+		if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+			goto endfunc;
+		}
+	}
 #ifdef CefC_INTEREST_RETURN
 	sprintf (work_str, "Interest Return  : %s\n"
 		, (hdl->IR_Option != 1) ? "Disabled" : "Enabled");
@@ -301,6 +332,24 @@ cef_status_stats_output (
 		goto endfunc;
 	}
 
+	/* output PIT expiry	*/
+	if (output_opt_f & CefC_Ctrl_StatusOpt_Stat) {
+		if ((fret=cef_status_pit_expiry_output (hdl)) != 0){
+			goto endfunc;
+		}
+	}
+
+	/* output Memory Pools	*/
+	if (output_opt_f & CefC_Ctrl_StatusOpt_Stat) {
+		sprintf (work_str, "Memory Pools :");
+		if ((fret=cef_status_add_output_to_rsp_buf(work_str)) != 0){
+			goto endfunc;
+		}
+		if ((fret=cef_status_mpool_output (hdl)) != 0){
+			goto endfunc;
+		}
+	}
+
 #if ((defined CefC_CefnetdCache) && (defined CefC_Develop))
 	if (hdl->cs_mode == 1) {
 		if ((fret=cef_status_localcache_output (output_opt_f)) != 0){
@@ -318,6 +367,92 @@ endfunc:;
 		return (0);
 	}
 }
+/*--------------------------------------------------------------------------------------
+	Output PIT expiry status
+----------------------------------------------------------------------------------------*/
+static int
+cef_status_pit_expiry_output (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	CefT_Hash_Handle pits[2] = { hdl->app_pit, hdl->pit };
+	const char* names[2] = { "PIT(App)", "PIT" };
+	CefT_Pit_Expiry_Stat stat;
+	char work_str[CefC_Max_Length];
+	int header_f = 0;
+	int i;
+
+	for (i = 0 ; i < 2 ; i++) {
+		if (cef_pit_expiry_stat_get (pits[i], &stat) < 0) {
+			continue;
+		}
+		if (!header_f) {
+			header_f = 1;
+			sprintf (work_str, "PIT Expiry (Tick=%uus) :\n", stat.tick_us);
+			if (cef_status_add_output_to_rsp_buf(work_str) != 0) {
+				return (-1);
+			}
+		}
+		sprintf (work_str,
+			"  %-16s : Scheduled=%u, Expired=%llu (Last=%u, Max/Tick=%u, Avg/Tick=%.3f)\n",
+			names[i], stat.scheduled, (unsigned long long) stat.expired,
+			stat.last_expired, stat.max_tick_expired,
+			stat.ticks ? (double) stat.expired / (double) stat.ticks : 0.0);
+		if (cef_status_add_output_to_rsp_buf(work_str) != 0) {
+			return (-1);
+		}
+	}
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Output Memory Pool status
+----------------------------------------------------------------------------------------*/
+static int
+cef_status_mpool_output (
+	CefT_Netd_Handle* hdl						/* cefnetd handle						*/
+) {
+	CefT_Mp_Handle mps[4 + CefC_Pit_Mpool_Max + CefC_PktBuf_Classes];
+	CefT_Mp_Stat stats[4 + CefC_Pit_Mpool_Max + CefC_PktBuf_Classes];
+	CefT_Mp_Stat* stat;
+	char work_str[CefC_Max_Length];
+	uint64_t total;
+	int mp_num = 0;
+	int stat_num = 0;
+	int i;
+
+	mps[mp_num++] = hdl->tx_que_mp;
+	if (hdl->cs_stat) {
+		mps[mp_num++] = hdl->cs_stat->tx_cob_mp;
+		mps[mp_num++] = hdl->cs_stat->tx_que_mp;
+		mps[mp_num++] = hdl->cs_stat->cs_cob_entry_mp;
+	}
+	mp_num += cef_pit_mpool_handles_get (&mps[mp_num], CefC_Pit_Mpool_Max);
+	mp_num += cef_pktbuf_mpool_handles_get (&mps[mp_num], CefC_PktBuf_Classes);
+
+	for (i = 0 ; i < mp_num ; i++) {
+		if (cef_mpool_stat_get (mps[i], &stats[stat_num]) > 0) {
+			stat_num++;
+		}
+	}
+	sprintf (work_str, " %d\n", stat_num);
+	if (cef_status_add_output_to_rsp_buf(work_str) != 0) {
+		return (-1);
+	}
+
+	for (i = 0 ; i < stat_num ; i++) {
+		stat = &stats[i];
+		total = stat->cache_hits + stat->cache_misses;
+		sprintf (work_str,
+			"  %-16s : Blocks=%zu (Free=%zu, Size=%zu, Segments=%zu) CacheHit=%.1f%%\n",
+			stat->key, stat->block_num, stat->free_num, stat->block_size, stat->seg_num,
+			total ? (double) stat->cache_hits * 100.0 / (double) total : 0.0);
+		if (cef_status_add_output_to_rsp_buf(work_str) != 0) {
+			return (-1);
+		}
+	}
+
+	return (0);
+}
 /*--------------------------------------------------------------------------------------
 	Output Face status
 ----------------------------------------------------------------------------------------*/
@@ -995,7 +1130,7 @@ cef_status_app_forward_output (
 	char work_str[CefC_Max_Length*2];
 	int fret = 0;
 
-	CefT_Hash* ht = (CefT_Hash*)(*handle);	//20210104
+	uint32_t index = 0;
 	int		elem_cnt = 0;
 
 	/* get table num		*/
@@ -1013,9 +1148,9 @@ cef_status_app_forward_output (
 		return (-1);
 	}
 
-	for ( i = 0; i < ht->elem_max; i++ ) {
-		if (ht->tbl[i].klen > 0) {
-			entry = (CefT_App_Reg *)ht->tbl[i].elem;
+	for ( i = 0; i < table_num; i++, index++ ) {
+		entry = (CefT_App_Reg *) cef_hash_tbl_item_check_from_index (*handle, &index);
+		if (entry) {
 			elem_cnt++;
 			res = cef_frame_conversion_name_to_uri (entry->name, entry->name_len, uri);
 			if (res < 0) {
@@ -1035,6 +1170,8 @@ cef_status_app_forward_output (
 			if ( elem_cnt >= table_num ) {
 				break;
 			}
+		} else {
+			break;
 		}
 	}
 
@@ -3970,7 +3970,7 @@ conpubd_publish_content_create (
 	/* CefC_T_OPT_APP_REG */
 	{
 		CefT_Connect connect;
-		connect.ai = 0;
+		memset (&connect, 0, sizeof (CefT_Connect));
 		connect.sock = hdl->cefnetd_sock;
 		CefT_Client_Handle fhdl;
 		fhdl = (CefT_Client_Handle) &connect;
@@ -4007,7 +4007,7 @@ conpubd_publish_content_delete (
 
 	{
 		CefT_Connect connect;
-		connect.ai = 0;
+		memset (&connect, 0, sizeof (CefT_Connect));
 		connect.sock = hdl->cefnetd_sock;
 		CefT_Client_Handle fhdl;
 		fhdl = (CefT_Client_Handle) &connect;
@@ -4163,7 +4163,7 @@ conpubd_connect_conpubd_and_regApp (
 				/* App_Reg */
 				{
 					CefT_Connect connect;
-					connect.ai = 0;
+					memset (&connect, 0, sizeof (CefT_Connect));
 					connect.sock = hdl->cefnetd_sock;
 					CefT_Client_Handle fhdl;
 					fhdl = (CefT_Client_Handle) &connect;
@@ -4644,7 +4644,7 @@ conpubd_incoming_cont_add_msg (
 		/* CefC_T_OPT_APP_REG */
 		{
 			CefT_Connect connect;
-			connect.ai = 0;
+			memset (&connect, 0, sizeof (CefT_Connect));
 			connect.sock = hdl->cefnetd_sock;
 			CefT_Client_Handle fhdl;
 			fhdl = (CefT_Client_Handle) &connect;
@@ -31,6 +31,8 @@
  */
 #define __CONPUBD_FILESYSTEM_CACHE_SOURCE__
 
+#define _GNU_SOURCE
+
 /*
 	filesystem_cache.c is a primitive filesystem cache implementation.
 */
@@ -62,6 +64,7 @@
 #include <cefore/cef_conpub.h>
 #include <cefore/cef_frame.h>
 #include <conpubd/conpubd_plugin.h>
+#include <cefore/cef_uring.h>
 
 
 /****************************************************************************************
@@ -91,6 +94,9 @@
 
 #define FSC_RECORD_CORRECT_SIZE		CefC_Max_Header_Size
 
+#define FscC_Io_Depth_Max		CefC_Uring_Depth_Max
+#define FscC_Io_Direct_Align	512				/* Record size aligned for O_DIRECT	*/
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
@@ -121,6 +127,9 @@ static CsmgrT_Stat_Handle 		conpub_stat_hdl;
 static pthread_mutex_t 			conpub_fsc_cs_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static ConpubdT_Content_Entry* 	fsc_proc_cob_buff = NULL;
+static CefT_Uring*				fsc_io_ring = NULL;		/* NULL if stdio is used		*/
+static int						fsc_io_direct_f = 0;
+static int						fsc_io_wr_num = 0;		/* Writes in flight				*/
 
 /****************************************************************************************
  Static Function Declaration
@@ -243,6 +252,24 @@ static int							/* The return value is negative if an error occurs	*/
 fsc_recursive_dir_clear (
 	char* filepath								/* file path							*/
 );
+/*--------------------------------------------------------------------------------------
+	Queues the write of a record of the page file to io_uring
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_io_write_queue (
+	int fd,										/* FD of the page file					*/
+	int64_t offset,								/* offset of the record					*/
+	unsigned char* msg,							/* Cob									*/
+	uint16_t msg_len,							/* length of the Cob					*/
+	int rcdsize									/* size of a record						*/
+);
+/*--------------------------------------------------------------------------------------
+	Waits for the completions of all the writes in flight
+----------------------------------------------------------------------------------------*/
+static void
+fsc_io_write_drain (
+	void
+);
 
 
 /****************************************************************************************
@@ -306,6 +333,22 @@ fsc_cs_create (
 	strcpy (cobpub_hdl->fsc_root_path, conf_param.cache_path);
 	cobpub_hdl->cache_default_rct = conf_param.cache_default_rct;
 
+	/* Creates io_uring to write the page files, or falls back to stdio 	*/
+	if (conf_param.io_depth > 0) {
+		fsc_io_ring = cef_uring_create (
+				conf_param.io_depth, sizeof (uint16_t) + CefC_Max_Msg_Size + FscC_Io_Direct_Align);
+		if (fsc_io_ring) {
+#ifdef O_DIRECT
+			fsc_io_direct_f = conf_param.io_direct;
+#endif // O_DIRECT
+			conpubd_log_write (CefC_Log_Info, "I/O : io_uring (depth=%d%s)\n",
+				conf_param.io_depth, fsc_io_direct_f ? ", O_DIRECT" : "");
+		} else {
+			conpubd_log_write (CefC_Log_Warn,
+				"io_uring is not available, the page files are written with stdio\n");
+		}
+	}
+
 	/* Check and create root directory	*/
 	if (fsc_root_dir_check (cobpub_hdl->fsc_root_path) < 0) {
 		conpubd_log_write (CefC_Log_Error,
@@ -350,6 +393,11 @@ fsc_cs_destroy (
 
 	pthread_mutex_destroy (&conpub_fsc_cs_mutex);
 
+	if (fsc_io_ring) {
+		fsc_io_write_drain ();
+		cef_uring_destroy (fsc_io_ring);
+		fsc_io_ring = NULL;
+	}
 	if (cobpub_hdl == NULL) {
 		return;
 	}
@@ -669,6 +717,7 @@ fsc_cache_cob_write (
 	int 			rcdsize;
 	char			cont_path[PATH_MAX];
 	FILE*			fp = NULL;
+	int				wfd = -1;
 	int				rbpflag = 0;
 	int				swindx[FscC_Page_Cob_Num];
 	uint32_t		file_msglen;
@@ -724,6 +773,12 @@ fsc_cache_cob_write (
 		/* Control record size */
 		if (rcd->file_msglen == 0) {
 			rcd->file_msglen = cobs[index].msg_len + 255;
+			if (fsc_io_direct_f) {
+				/* O_DIRECT requires the offsets and the lengths of the records aligned 	*/
+				rcd->file_msglen = (uint32_t)(sizeof (uint16_t) + rcd->file_msglen
+					+ FscC_Io_Direct_Align - 1) / FscC_Io_Direct_Align * FscC_Io_Direct_Align
+					- sizeof (uint16_t);
+			}
 		} else {
 			;
 		}
@@ -736,6 +791,32 @@ fsc_cache_cob_write (
 		/* Update the page to write the received cob 		*/
 		work_page_index = chunk_num / FscC_Page_Cob_Num / FscC_File_Page_Num;
 		cob_block_index = (chunk_num / FscC_Page_Cob_Num) % FscC_File_Page_Num;
+		if (work_page_index != prev_page_index && fsc_io_ring) {
+			/* The writes to the previous page file complete before it is closed 	*/
+			if (wfd >= 0) {
+				fsc_io_write_drain ();
+				close (wfd);
+				wfd = -1;
+			}
+			prev_page_index = work_page_index;
+			sprintf (file_path,
+				"%s/%d/%d", cobpub_hdl->fsc_cache_path, work_con_index, work_page_index);
+#ifdef O_DIRECT
+			if (fsc_io_direct_f) {
+				wfd = open (file_path, O_RDWR | O_CREAT | O_DIRECT, 0666);
+			}
+#endif // O_DIRECT
+			if (wfd < 0) {
+				/* The filesystem may not support O_DIRECT (e.g. tmpfs) 	*/
+				wfd = open (file_path, O_RDWR | O_CREAT, 0666);
+			}
+			if (wfd < 0) {
+				conpubd_log_write (CefC_Log_Error,
+					"Failed to open the cache file (%s)\n", file_path);
+				prev_page_index = -1;
+				goto NEXTCOB;
+			}
+		}
 		if (work_page_index != prev_page_index) {
 			if (fp != NULL) {
 #ifdef CefC_Debug
@@ -783,6 +864,17 @@ fsc_cache_cob_write (
 		/* Set to write buffer 							*/
 		unsigned char wbuff[sizeof (uint16_t) + UINT16_MAX];
 		int write_index = chunk_num % FscC_Page_Cob_Num;
+		if (fsc_io_ring) {
+			/* The caller holds the lock until all the writes complete 	*/
+			if (fsc_io_write_queue (wfd, (int64_t)cob_block_index * FscC_Page_Cob_Num * (int64_t)rcdsize
+					+ (int64_t)write_index * (int64_t)rcdsize,
+					cobs[index].msg, cobs[index].msg_len, rcdsize) < 0) {
+				conpubd_log_write (CefC_Log_Error,
+					"Failed to queue the write of the cache file (%s)\n", file_path);
+			}
+			cobpub_hdl->cache_cobs++;
+			goto NEXTCOB;
+		}
 		fseek (fp, (int64_t)cob_block_index * FscC_Page_Cob_Num * (int64_t)rcdsize
 					+ (int64_t)write_index * (int64_t)rcdsize, SEEK_SET);
 		memcpy (wbuff, &cobs[index].msg_len, sizeof (uint16_t));
@@ -802,6 +894,10 @@ NEXTCOB:
 		fflush (fp);
 		fclose (fp);
 	}
+	if (wfd >= 0) {
+		fsc_io_write_drain ();
+		close (wfd);
+	}
 	return (0);
 }
 /*--------------------------------------------------------------------------------------
@@ -902,6 +998,8 @@ fsc_config_read (
 	params->cache_capacity 			= CefC_CnpbDefault_Contents_Capacity;
 	strcpy(params->cache_path, 		  conpub_conf_dir);
 	params->cache_default_rct = CefC_CnpbDefault_Cache_Default_Rct;
+	params->io_depth = 0;
+	params->io_direct = 0;
 
 	/* Obtains the directory path where the conpubd's config file is located. */
 #if 0 //+++++ GCC v9 +++++
@@ -995,6 +1093,25 @@ fsc_config_read (
 				fclose (fp);
 				return (-1);
 			}
+		} else
+		if (strcmp (option, "CACHE_IO_DEPTH") == 0) {
+			res = atoi (value);
+			if ((res < 0) || (res > FscC_Io_Depth_Max)) {
+				conpubd_log_write (CefC_Log_Error,
+					"CACHE_IO_DEPTH must be between 0 and %d inclusive.\n", FscC_Io_Depth_Max);
+				fclose (fp);
+				return (-1);
+			}
+			params->io_depth = res;
+		} else
+		if (strcmp (option, "CACHE_IO_DIRECT") == 0) {
+			res = atoi (value);
+			if ((res != 0) && (res != 1)) {
+				conpubd_log_write (CefC_Log_Error, "CACHE_IO_DIRECT must be 0 or 1.\n");
+				fclose (fp);
+				return (-1);
+			}
+			params->io_direct = res;
 		} else {
 			/* NOP */;
 		}
@@ -1167,4 +1284,65 @@ fsc_recursive_dir_clear (
 
 	return (0);
 }
+/*--------------------------------------------------------------------------------------
+	Queues the write of a record of the page file to io_uring
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_io_write_queue (
+	int fd,										/* FD of the page file					*/
+	int64_t offset,								/* offset of the record					*/
+	unsigned char* msg,							/* Cob									*/
+	uint16_t msg_len,							/* length of the Cob					*/
+	int rcdsize									/* size of a record						*/
+) {
+	unsigned char* buff;
+	uint16_t tag;
+	int buff_idx;
+	int io_fd, io_res;
+
+	/* Waits for a buffer if all of them are in flight 	*/
+	while ((buff = cef_uring_buff_get (fsc_io_ring, &buff_idx)) == NULL) {
+		if (cef_uring_reap (fsc_io_ring, 1, &tag, &io_fd, &io_res) <= 0) {
+			return (-1);
+		}
+		fsc_io_wr_num--;
+		if (io_res < 0) {
+			conpubd_log_write (CefC_Log_Error,
+				"Failed to write the cache file (%s)\n", strerror (-io_res));
+		}
+	}
+	memcpy (buff, &msg_len, sizeof (uint16_t));
+	memcpy (&buff[sizeof (uint16_t)], msg, msg_len);
+	memset (&buff[sizeof (uint16_t) + msg_len], 0, rcdsize - sizeof (uint16_t) - msg_len);
 
+	if (cef_uring_write (fsc_io_ring, fd, buff_idx, rcdsize, offset, 0) < 0) {
+		return (-1);
+	}
+	fsc_io_wr_num++;
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Waits for the completions of all the writes in flight
+----------------------------------------------------------------------------------------*/
+static void
+fsc_io_write_drain (
+	void
+) {
+	uint16_t tag;
+	int io_fd, io_res;
+
+	cef_uring_submit (fsc_io_ring);
+	while (fsc_io_wr_num > 0) {
+		if (cef_uring_reap (fsc_io_ring, 1, &tag, &io_fd, &io_res) <= 0) {
+			conpubd_log_write (CefC_Log_Error, "Failed to wait for the writes of the cache\n");
+			fsc_io_wr_num = 0;
+			break;
+		}
+		fsc_io_wr_num--;
+		if (io_res < 0) {
+			conpubd_log_write (CefC_Log_Error,
+				"Failed to write the cache file (%s)\n", strerror (-io_res));
+		}
+	}
+}
@@ -61,6 +61,9 @@ typedef struct {
 	char				cache_path[CefC_Conpubd_File_Path_Length];
 														/* FileSystemCache root dir		*/
 	uint32_t			cache_default_rct;
+	int					io_depth;						/* I/Os in flight with io_uring		*/
+														/* (0: written by stdio)			*/
+	int					io_direct;						/* opened with O_DIRECT				*/
 	
 } FscT_Config_Param;
 
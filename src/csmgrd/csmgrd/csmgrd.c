@@ -102,6 +102,8 @@ static int xpthread_mutex_lock (const char* pname, int pline, pthread_mutex_t *m
 
 #define CSMGR_LOCAL_SOCK_NAME_STATUS_THREAD			"/tmp/csmgr_status_process_thread"
 #define CSMGR_LOCAL_SOCK_NAME_OTHER_THREAD			"/tmp/csmgr_other_process_thread"
+/* The other thread is the first lookup thread, and the rest are named after it 	*/
+#define CSMGR_LOCAL_SOCK_NAME_LOOKUP_THREAD			"/tmp/csmgr_other_process_thread_%d"
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
@@ -259,7 +261,7 @@ csmgrd_input_message_process (
 /*--------------------------------------------------------------------------------------
 	Incoming Interest Message
 ----------------------------------------------------------------------------------------*/
-static void
+static int							/* Returns CefC_Csmgr_Cob_Exist if the Cob is sent	*/
 csmgrd_incoming_interest (
 	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
 	int sock,									/* recv socket							*/
@@ -267,6 +269,16 @@ csmgrd_incoming_interest (
 	int buff_len,								/* receive message length				*/
 	uint8_t type								/* receive message type					*/
 );
+/*--------------------------------------------------------------------------------------
+	Incoming Batch of Interest Messages
+----------------------------------------------------------------------------------------*/
+static void
+csmgrd_incoming_batch_msg (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	int sock,									/* recv socket							*/
+	unsigned char* buff,						/* receive message						*/
+	int buff_len								/* receive message length				*/
+);
 /*--------------------------------------------------------------------------------------
 	Parse Interest message
 ----------------------------------------------------------------------------------------*/
@@ -526,6 +538,58 @@ csmgrd_input_message_transfer_process (
 	int fds_index
 );
 
+/*--------------------------------------------------------------------------------------
+	Sends the message to the thread through the connection for the peer
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+csmgrd_thread_msg_send (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	int sock,									/* recv socket							*/
+	unsigned char* msg,							/* message								*/
+	int msg_len,								/* message length						*/
+	char* local_sock_name,						/* local socket name of the thread		*/
+	int* th_fd									/* connection to the thread				*/
+);
+/*--------------------------------------------------------------------------------------
+	Selects the lookup thread from the name of the Interest
+----------------------------------------------------------------------------------------*/
+static int							/* Index of the lookup thread						*/
+csmgrd_lookup_thread_select (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	unsigned char* msg,							/* csmgr Interest message				*/
+	int msg_len									/* message length						*/
+);
+/*--------------------------------------------------------------------------------------
+	Transfers the lookup message to the lookup thread
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+csmgrd_lookup_msg_transfer (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	int sock,									/* recv socket							*/
+	unsigned char* msg,							/* message								*/
+	int msg_len,								/* message length						*/
+	int fds_index,
+	int thread_index							/* index of the lookup thread			*/
+);
+/*--------------------------------------------------------------------------------------
+	Splits the batch of lookups by the lookup threads
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+csmgrd_batch_msg_transfer (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	int sock,									/* recv socket							*/
+	unsigned char* msg,							/* batch message						*/
+	int msg_len,								/* message length						*/
+	int fds_index
+);
+/*--------------------------------------------------------------------------------------
+	Closes the connections to the threads for the peer
+----------------------------------------------------------------------------------------*/
+static void
+csmgrd_thread_sock_close (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	int fds_index
+);
 /*--------------------------------------------------------------------------------------
 	Check accept from thread local socket
 ----------------------------------------------------------------------------------------*/
@@ -653,7 +717,7 @@ csmgrd_handle_create (
 ) {
 	CefT_Csmgrd_Handle* hdl = NULL;
 	CsmgrT_Config_Param conf_param;
-	int i;
+	int i, n;
 	char*	envp;
 
 	/* create handle */
@@ -696,6 +760,7 @@ csmgrd_handle_create (
 		return (NULL);
 	}
 	hdl->interval = conf_param.interval;
+	hdl->lookup_thread_num = conf_param.lookup_threads;
 
 #ifdef CefC_Debug
 	cef_dbg_write (CefC_Dbg_Fine, "Create the listen socket.\n");
@@ -719,11 +784,25 @@ csmgrd_handle_create (
 		return (NULL);
 	}
 	hdl->port_num = conf_param.port_num;
+
+	/* Creates the index which cefnetd on this node probes before the socket 	*/
+	if (conf_param.shm_size > 0) {
+		if (cef_csmgr_shm_create (csmgr_local_sock_name, conf_param.shm_size) < 0) {
+			cef_log_write (CefC_Log_Error, "Fail to create the shared memory index.\n");
+			csmgrd_handle_destroy (&hdl, csmgr_local_sock_name);
+			return (NULL);
+		}
+		cef_log_write (CefC_Log_Info,
+			"Creation the shared memory index (%u MB) ... OK\n", conf_param.shm_size);
+	}
 	for (i = 0 ; i < CsmgrdC_Max_Sock_Num ; i++) {
 		hdl->tcp_fds[i] 	= -1;
 		hdl->tcp_index[i] 	= 0;
 		hdl->th_fds[i]		= -1;
 		hdl->snd_fds[i]		= -1;
+		for (n = 0 ; n < CsmgrdC_Max_Lookup_Threads ; n++) {
+			hdl->lk_fds[i][n] = -1;
+		}
 	}
 	cef_log_write (CefC_Log_Info, "Creation the TCP listen socket ... OK\n");
 
@@ -857,7 +936,7 @@ csmgrd_thread_handle_create (
 	char* local_sock_name
 ) {
 	CefT_Csmgrd_Handle* hdl = NULL;
-	int i;
+	int i, n;
 
 	/* create handle */
 	hdl = (CefT_Csmgrd_Handle*) malloc (sizeof (CefT_Csmgrd_Handle));
@@ -894,6 +973,9 @@ csmgrd_thread_handle_create (
 		hdl->tcp_index[i] 	= 0;
 		hdl->th_fds[i]		= -1;
 		hdl->snd_fds[i]		= -1;
+		for (n = 0 ; n < CsmgrdC_Max_Lookup_Threads ; n++) {
+			hdl->lk_fds[i][n] = -1;
+		}
 	}
 	cef_log_write (CefC_Log_Info, "Creation the local listen socket ... OK\n");
 
@@ -935,7 +1017,11 @@ csmgrd_event_dispatch (
 	pthread_t		csmgrd_resource_mon_th;
 	pthread_t		csmgrd_incoming_status_msg_th;
 	pthread_t		csmgrd_incoming_other_msg_th;
+	pthread_t		csmgrd_incoming_lookup_msg_th[CsmgrdC_Max_Lookup_Threads];
+	char			lookup_sock_name[PATH_MAX];
+	int				lookup_thread_num = 1;
 	void*			status;
+	int				i;
 
 	CefT_Csmgrd_Handle* thread_hdl = NULL;
 
@@ -1006,11 +1092,37 @@ csmgrd_event_dispatch (
 		csmgrd_handle_destroy (&thread_hdl, CSMGR_LOCAL_SOCK_NAME_OTHER_THREAD);
 	}
 
+	for (i = 1 ; i < hdl->lookup_thread_num && csmgrd_running_f ; i++) {
+		sprintf (lookup_sock_name, CSMGR_LOCAL_SOCK_NAME_LOOKUP_THREAD, i);
+		thread_hdl = csmgrd_thread_handle_create (hdl, lookup_sock_name);
+		if (thread_hdl == NULL) {
+			cef_log_write (CefC_Log_Error, "Unable to create csmgrd thread handle.\n");
+			unlink (lookup_sock_name);
+			csmgrd_running_f = 0;
+			break;
+		}
+		if (cef_pthread_create (&csmgrd_incoming_lookup_msg_th[i], NULL,
+				csmgrd_incoming_msg_thread, thread_hdl) == -1) {
+			cef_log_write (CefC_Log_Error,
+				"Failed to create the new thread(csmgrd_incoming_msg_thread(lookup#%d))\n", i);
+			csmgrd_running_f = 0;
+			csmgrd_handle_destroy (&thread_hdl, lookup_sock_name);
+			break;
+		}
+		lookup_thread_num++;
+	}
+	if (csmgrd_running_f) {
+		cef_log_write (CefC_Log_Info, "Lookup threads : %d\n", lookup_thread_num);
+	}
+
 	csmgrd_event_main_loop (hdl);
 
 	pthread_cond_signal (&csmgr_comn_buff_cond);		/* To avoid deadlock */
 	pthread_join (csmgrd_incoming_status_msg_th, &status);
 	pthread_join (csmgrd_incoming_other_msg_th, &status);
+	for (i = 1 ; i < lookup_thread_num ; i++) {
+		pthread_join (csmgrd_incoming_lookup_msg_th[i], &status);
+	}
 	pthread_join (csmgrd_msg_process_th, &status);
 	pthread_join (csmgrd_expire_check_th, &status);
 	pthread_join (push_bytes_process_th, &status);
@@ -1097,15 +1209,7 @@ csmgrd_event_main_loop (
 					/* Reset buffer */
 					hdl->tcp_index[fds_index[i]] = 0;
 				}
-				if (hdl->th_fds[fds_index[i]] != -1) {
-#ifdef CefC_Debug
-					cef_dbg_write (CefC_Dbg_Fine, "close sock:%d\n",
-						hdl->th_fds[fds_index[i]]);
-#endif // CefC_Debug
-					close (hdl->th_fds[fds_index[i]]);
-					hdl->th_fds[fds_index[i]] = -1;
-				}
-				hdl->snd_fds[fds_index[i]] = -1;
+				csmgrd_thread_sock_close (hdl, fds_index[i]);
 				res--;
 				continue;
 			}
@@ -1154,15 +1258,7 @@ cef_dbg_write (CefC_Dbg_Finer, "i=%d, len=%d, last_len=%d\n",
 						/* Reset buffer */
 						hdl->tcp_index[fds_index[i]] = 0;
 					}
-					if (hdl->th_fds[fds_index[i]] != -1) {
-#ifdef CefC_Debug
-						cef_dbg_write (CefC_Dbg_Fine, "close sock:%d\n",
-							hdl->th_fds[fds_index[i]]);
-#endif // CefC_Debug
-						close (hdl->th_fds[fds_index[i]]);
-						hdl->th_fds[fds_index[i]] = -1;
-					}
-					hdl->snd_fds[fds_index[i]] = -1;
+					csmgrd_thread_sock_close (hdl, fds_index[i]);
 				} else {
 #ifdef CefC_Debug
 cef_dbg_write (CefC_Dbg_Fine, "errno=%d:%s\n", errno, strerror (errno));
@@ -1194,15 +1290,7 @@ cef_dbg_write (CefC_Dbg_Fine, "errno=%d:%s\n", errno, strerror (errno));
 							/* Reset buffer */
 							hdl->tcp_index[fds_index[i]] = 0;
 						}
-						if (hdl->th_fds[fds_index[i]] != -1) {
-#ifdef CefC_Debug
-							cef_dbg_write (CefC_Dbg_Fine, "close sock:%d\n",
-								hdl->th_fds[fds_index[i]]);
-#endif // CefC_Debug
-							close (hdl->th_fds[fds_index[i]]);
-							hdl->th_fds[fds_index[i]] = -1;
-						}
-						hdl->snd_fds[fds_index[i]] = -1;
+						csmgrd_thread_sock_close (hdl, fds_index[i]);
 					}
 				}
 			}
@@ -1636,7 +1724,7 @@ csmgrd_handle_destroy (
 	char* local_sock_name
 ) {
 	CefT_Csmgrd_Handle* hdl = *csmgrd_hdl;
-	int i;
+	int i, n;
 	int		Last_Node_f = 0;
 
 	/* Check handle */
@@ -1669,6 +1757,11 @@ csmgrd_handle_destroy (
 			if (hdl->th_fds[i] > 0) {
 				close (hdl->th_fds[i]);
 			}
+			for (n = 0 ; n < CsmgrdC_Max_Lookup_Threads ; n++) {
+				if (hdl->lk_fds[i][n] > 0) {
+					close (hdl->lk_fds[i][n]);
+				}
+			}
 		}
 		close (hdl->tcp_listen_fd);
 #ifdef CefC_Debug
@@ -1734,6 +1827,10 @@ csmgrd_handle_destroy (
 		}
 	}
 
+	if (hdl->task == CsmgrdC_Task_Main_Process) {
+		cef_csmgr_shm_destroy ();
+	}
+
 	//0.8.3c S
 	if (hdl->task == CsmgrdC_Task_Main_Process &&
 		Last_Node_f == 0 ) {
@@ -1797,6 +1894,8 @@ csmgrd_config_read (
 	strcpy (conf_param->fsc_cache_path, csmgr_conf_dir);
 	conf_param->port_num 	= CefC_Default_Tcp_Prot;
 	strcpy (conf_param->local_sock_id, "0");
+	conf_param->shm_size 	= 0;
+	conf_param->lookup_threads = 1;
 
 	/* get parameter */
 	while (fgets (param_buff, sizeof (param_buff), fp) != NULL) {
@@ -1845,6 +1944,8 @@ csmgrd_config_read (
 			if (!(strcmp (conf_param->cs_mod_name, "filesystem") == 0
 				    ||
 				  strcmp (conf_param->cs_mod_name, "memory") == 0
+				    ||
+				  strcmp (conf_param->cs_mod_name, "segment") == 0
 			     )) {
 				cef_log_write (CefC_Log_Error,
 					"EXCACHE_PLUGIN (Invalid value CACHE_TYPE=%s)\n", conf_param->cs_mod_name);
@@ -1878,12 +1979,33 @@ csmgrd_config_read (
 				return (-1);
 			}
 			strcpy (conf_param->local_sock_id, value);
+		} else if (strcmp (option, CefC_ParamName_CsShmSize) == 0) {
+			res = csmgrd_config_value_get (option, value);
+			if ((res < 0) || (res > CefC_Csmgr_Shm_Size_Max)) {
+				cef_log_write (CefC_Log_Error,
+					"%s must be higher than or equal to 0 and lower than or equal to %d.\n",
+						CefC_ParamName_CsShmSize, CefC_Csmgr_Shm_Size_Max);
+				fclose (fp);
+				return (-1);
+			}
+			conf_param->shm_size = res;
+		} else if (strcmp (option, "LOOKUP_THREADS") == 0) {
+			res = csmgrd_config_value_get (option, value);
+			if ((res < 1) || (res > CsmgrdC_Max_Lookup_Threads)) {
+				cef_log_write (CefC_Log_Error,
+					"LOOKUP_THREADS must be higher than 0 and lower than or equal to %d.\n",
+						CsmgrdC_Max_Lookup_Threads);
+				fclose (fp);
+				return (-1);
+			}
+			conf_param->lookup_threads = res;
 		} else {
 			continue;
 		}
 	}
 
-	if (strcmp (conf_param->cs_mod_name, "filesystem") == 0) {
+	if ((strcmp (conf_param->cs_mod_name, "filesystem") == 0) ||
+		(strcmp (conf_param->cs_mod_name, "segment") == 0)) {
 		if (!(    access (conf_param->fsc_cache_path, F_OK) == 0
 			   && access (conf_param->fsc_cache_path, R_OK) == 0
 	   		   && access (conf_param->fsc_cache_path, W_OK) == 0
@@ -2369,6 +2491,13 @@ csmgrd_input_message_process (
 			csmgrd_incoming_interest (hdl, sock, msg, msg_len, type);
 			break;
 		}
+		case CefC_Csmgr_Msg_Type_Batch: {
+#ifdef CefC_Debug
+			cef_dbg_write (CefC_Dbg_Finest, "Receive the Batch Message\n");
+#endif // CefC_Debug
+			csmgrd_incoming_batch_msg (hdl, sock, msg, msg_len);
+			break;
+		}
 
 		case CefC_Csmgr_Msg_Type_Ccninfo: {
 #ifdef CefC_Debug
@@ -2449,7 +2578,7 @@ csmgrd_input_message_process (
 /*--------------------------------------------------------------------------------------
 	Incoming Interest Message
 ----------------------------------------------------------------------------------------*/
-static void
+static int							/* Returns CefC_Csmgr_Cob_Exist if the Cob is sent	*/
 csmgrd_incoming_interest (
 	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
 	int sock,									/* recv socket							*/
@@ -2458,13 +2587,15 @@ csmgrd_incoming_interest (
 	uint8_t type								/* receive message type					*/
 ) {
 	int res;
-	unsigned char name[CefC_Max_Msg_Size] = {0};
+	int exist_f = CefC_Csmgr_Cob_NotExist;
+	/* Filled up to the parsed lengths, so they are not cleared for each Interest 	*/
+	unsigned char name[CefC_Max_Msg_Size];
 	uint16_t name_len;
 	uint32_t chunk_num = 0;
 	uint8_t int_type;
-	unsigned char op_data[CefC_Max_Msg_Size] = {0};
+	unsigned char op_data[CefC_Max_Msg_Size];
 	uint16_t op_data_len = 0;
-	unsigned char ver[CefC_Max_Msg_Size] = {0};
+	unsigned char ver[CefC_Max_Msg_Size];
 	uint16_t ver_len = 0;
 	unsigned char* csact_val = NULL;
 	uint16_t csact_len = 0;
@@ -2480,7 +2611,7 @@ csmgrd_incoming_interest (
 #ifdef CefC_Debug
 		cef_dbg_write (CefC_Dbg_Fine, "Parse message error (interest)\n");
 #endif // CefC_Debug
-		return;
+		return (exist_f);
 	}
 
 	/* Checks Interest Type */
@@ -2492,8 +2623,8 @@ csmgrd_incoming_interest (
 			csmgrd_stat_request_count_update (stat_hdl, name, name_len);
 
 			/* Searches and sends a Cob */
-			hdl->cs_mod_int->cache_item_get (name, name_len, chunk_num, sock, ver, ver_len,
-				csact_val, csact_len, signature_val, signature_len);
+			exist_f = hdl->cs_mod_int->cache_item_get (name, name_len, chunk_num, sock,
+				ver, ver_len, csact_val, csact_len, signature_val, signature_len);
 			break;
 		}
 		default: {
@@ -2504,6 +2635,69 @@ csmgrd_incoming_interest (
 	free(csact_val);
 	free(signature_val);
 
+	return (exist_f);
+}
+/*--------------------------------------------------------------------------------------
+	Incoming Batch of Interest Messages
+----------------------------------------------------------------------------------------*/
+static void
+csmgrd_incoming_batch_msg (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	int sock,									/* recv socket							*/
+	unsigned char* buff,						/* receive message						*/
+	int buff_len								/* receive message length				*/
+) {
+	unsigned char ret_buff[CefC_Max_Length];
+	uint16_t ret_len = CefC_Csmgr_Answer_HeaderLen;
+	uint16_t value16;
+	uint16_t len;
+	int index = 0;
+	int exist_f;
+
+	/*
+	 * Each record is [Request ID (4)][csmgr Interest message], and one answer
+	 * [Request ID (4)][CefC_Csmgr_Cob_Exist or NotExist (1)] is returned for it
+	 * after the Cobs, so that cefnetd completes its requests in any order.
+	 */
+	while (index + CefC_Csmgr_Link_ReqId_Len + CefC_Csmgr_Msg_HeaderLen <= buff_len) {
+		unsigned char* mp = &buff[index + CefC_Csmgr_Link_ReqId_Len];
+
+		memcpy (&value16, &mp[CefC_O_Fix_PacketLength], CefC_S_Length);
+		len = ntohs (value16);
+		if ((mp[CefC_O_Fix_Ver] != CefC_Version) ||
+			(len < CefC_Csmgr_Msg_HeaderLen) ||
+			(index + CefC_Csmgr_Link_ReqId_Len + len > buff_len)) {
+			cef_log_write (CefC_Log_Warn, "Broken record in the batch message\n");
+			break;
+		}
+
+		exist_f = CefC_Csmgr_Cob_NotExist;
+		if (mp[CefC_O_Fix_Type] == CefC_Csmgr_Msg_Type_Interest) {
+			exist_f = csmgrd_incoming_interest (hdl, sock, mp + CefC_Csmgr_Msg_HeaderLen,
+				len - CefC_Csmgr_Msg_HeaderLen, CefC_Csmgr_Msg_Type_Interest);
+		}
+		if (ret_len + CefC_Csmgr_Link_Answer_Len <= CefC_Max_Length) {
+			memcpy (&ret_buff[ret_len], &buff[index], CefC_Csmgr_Link_ReqId_Len);
+			ret_buff[ret_len + CefC_Csmgr_Link_ReqId_Len] =
+				(exist_f == CefC_Csmgr_Cob_Exist) ? CefC_Csmgr_Cob_Exist : CefC_Csmgr_Cob_NotExist;
+			ret_len += CefC_Csmgr_Link_Answer_Len;
+		}
+		index += CefC_Csmgr_Link_ReqId_Len + len;
+	}
+
+	/* Sets the header of the answer 	*/
+	memset (ret_buff, 0, CefC_Csmgr_Answer_HeaderLen);
+	ret_buff[CefC_O_Fix_Ver]  = CefC_Version;
+	ret_buff[CefC_O_Fix_Type] = CefC_Csmgr_PT_Answer;
+	value16 = htons (ret_len);
+	memcpy (&ret_buff[CefC_O_Fix_PacketLength], &value16, CefC_S_Length);
+	value16 = htons (CefC_Csmgr_Link_Credit);
+	memcpy (&ret_buff[CefC_O_Csmgr_Answer_Credit], &value16, sizeof (uint16_t));
+	ret_buff[CefC_Csmgr_Answer_HeaderLen - 1] = CefC_Csmgr_Answer_HeaderLen;
+
+	/* Retries a partial send in the same way as for the Cobs 	*/
+	csmgrd_plugin_cob_msg_send (sock, ret_buff, ret_len);
+
 	return;
 }
 /*--------------------------------------------------------------------------------------
@@ -2696,6 +2890,26 @@ csmgrd_incoming_status_msg (
 
 	index += sizeof (struct CefT_Csmgr_Status_Hdr);
 
+	if (option_f & CefC_Csmgr_Stat_Opt_Memory) {
+		struct CefT_Csmgr_Status_Mem stat_mem;
+		CsmgrdT_Mem_Stat mem_stat;
+
+		memset (&stat_mem, 0, sizeof (struct CefT_Csmgr_Status_Mem));
+		if ((hdl->cs_mod_int->mem_stat_get) &&
+			(hdl->cs_mod_int->mem_stat_get (&mem_stat) > 0)) {
+			stat_mem.mem_f 			= htons (1);
+			stat_mem.cob_num 		= cef_client_htonb (mem_stat.cob_num);
+			stat_mem.entry_bytes 	= cef_client_htonb (mem_stat.entry_bytes);
+			stat_mem.block_bytes 	= cef_client_htonb (mem_stat.block_bytes);
+			stat_mem.slab_bytes 	= cef_client_htonb (mem_stat.slab_bytes);
+			stat_mem.slab_num 		= cef_client_htonb (mem_stat.slab_num);
+			stat_mem.large_bytes 	= cef_client_htonb (mem_stat.large_bytes);
+			stat_mem.index_bytes 	= cef_client_htonb (mem_stat.index_bytes);
+		}
+		memcpy (&wbuf[index], &stat_mem, sizeof (struct CefT_Csmgr_Status_Mem));
+		index += sizeof (struct CefT_Csmgr_Status_Mem);
+	}
+
 	if (buff_x) {
 		res = csmgrd_stat_content_info_gets (stat_hdl, key, klen, 1, stat);
 		if (con_num == 0) {
@@ -3642,7 +3856,8 @@ csmgrd_resource_mon_thread (
 
 	if (strcmp (hdl->cs_mod_name, "memory") == 0) {
 		cs_type = 'M';
-	} else if (strcmp (hdl->cs_mod_name, "filesystem") == 0) {
+	} else if ((strcmp (hdl->cs_mod_name, "filesystem") == 0) ||
+			   (strcmp (hdl->cs_mod_name, "segment") == 0)) {
 		cs_type = 'F';
 	} else {
 		cs_type = 'M';
@@ -3704,7 +3919,8 @@ csmgrd_resource_mon_thread (
 			}
 //@@@fprintf(stderr, "[%s(%d)]: ===== Lack_of_M_resources = %d ======\n", __FUNCTION__, __LINE__, Lack_of_M_resources);
 		}
-		else if (strcmp (hdl->cs_mod_name, "filesystem") == 0) {
+		else if ((strcmp (hdl->cs_mod_name, "filesystem") == 0) ||
+				 (strcmp (hdl->cs_mod_name, "segment") == 0)) {
 			if (max_cob_limit == 0) {
 				if (m_used > CSMGR_MAXIMUM_MEM_USAGE_FOR_FILE) {
 					Lack_of_M_resources = 1;
@@ -3724,13 +3940,16 @@ csmgrd_resource_mon_thread (
 				}
 			}
 
-			if (f_used > CSMGR_MAXIMUM_FILE_USAGE_FOR_FILE) {
-				Lack_of_F_resources = 1;
-				file_out = 1;
-			} else {
-				if (file_out == 1) {
-					if (f_used <= CSMGR_THRSHLD_FILE_USAGE_FOR_FILE) {
-						Lack_of_F_resources = 0;
+			/* Segment files are allocated at startup, so the usage does not grow 	*/
+			if (strcmp (hdl->cs_mod_name, "filesystem") == 0) {
+				if (f_used > CSMGR_MAXIMUM_FILE_USAGE_FOR_FILE) {
+					Lack_of_F_resources = 1;
+					file_out = 1;
+				} else {
+					if (file_out == 1) {
+						if (f_used <= CSMGR_THRSHLD_FILE_USAGE_FOR_FILE) {
+							Lack_of_F_resources = 0;
+						}
 					}
 				}
 			}
@@ -4201,10 +4420,20 @@ csmgrd_input_message_transfer_process (
 ) {
 	int res = 0;
 	CefT_Cs_Stat cs_stat = {0};
-	int con_sock;
 	int index;
 	unsigned char* wk_msg = NULL;
 
+	/* Lookups are spread over the lookup threads by the hash of the name 	*/
+	if (hdl->lookup_thread_num > 1) {
+		if (type == CefC_Csmgr_Msg_Type_Interest) {
+			return (csmgrd_lookup_msg_transfer (hdl, sock, msg, msg_len, fds_index,
+						csmgrd_lookup_thread_select (hdl, msg, msg_len)));
+		}
+		if (type == CefC_Csmgr_Msg_Type_Batch) {
+			return (csmgrd_batch_msg_transfer (hdl, sock, msg, msg_len, fds_index));
+		}
+	}
+
 	switch (type) {
 		case CefC_Csmgr_Msg_Type_Kill: {
 			res = csmgrd_input_message_process (hdl, sock, msg + CefC_Csmgr_Msg_HeaderLen,
@@ -4234,23 +4463,8 @@ csmgrd_input_message_transfer_process (
 
 	index = fds_index;
 	if (index >= 0) {
-		if (hdl->th_fds[index] < 0) {
-			con_sock = cef_csmgr_csmgr_connect_local (&cs_stat);
-			if (con_sock >= 0) {
-#ifdef CefC_Debug
-				cef_dbg_write (CefC_Dbg_Fine, "connect sock:%d\n", con_sock);
-#endif // CefC_Debug
-				hdl->th_fds[index] = con_sock;
-				csmgrd_sockid_msg_send (hdl, con_sock, sock);
-			} else {
-				res = -1;
-			}
-		} else {
-			con_sock = hdl->th_fds[index];
-		}
-		if (con_sock >= 0) {
-			cef_csmgr_send_msg (con_sock, msg, msg_len);
-		}
+		res = csmgrd_thread_msg_send (
+				hdl, sock, msg, msg_len, cs_stat.local_sock_name, &hdl->th_fds[index]);
 	} else {
 		res = -1;
 	}
@@ -4261,6 +4475,192 @@ csmgrd_input_message_transfer_process (
 
 	return (res);
 }
+/*--------------------------------------------------------------------------------------
+	Sends the message to the thread through the connection for the peer
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+csmgrd_thread_msg_send (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	int sock,									/* recv socket							*/
+	unsigned char* msg,							/* message								*/
+	int msg_len,								/* message length						*/
+	char* local_sock_name,						/* local socket name of the thread		*/
+	int* th_fd									/* connection to the thread				*/
+) {
+	CefT_Cs_Stat cs_stat = {0};
+	int con_sock;
+
+	if (*th_fd < 0) {
+		strcpy (cs_stat.local_sock_name, local_sock_name);
+		con_sock = cef_csmgr_csmgr_connect_local (&cs_stat);
+		if (con_sock < 0) {
+			return (-1);
+		}
+#ifdef CefC_Debug
+		cef_dbg_write (CefC_Dbg_Fine, "connect sock:%d\n", con_sock);
+#endif // CefC_Debug
+		*th_fd = con_sock;
+		csmgrd_sockid_msg_send (hdl, con_sock, sock);
+	}
+	cef_csmgr_send_msg (*th_fd, msg, msg_len);
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Selects the lookup thread from the name of the Interest
+----------------------------------------------------------------------------------------*/
+static int							/* Index of the lookup thread						*/
+csmgrd_lookup_thread_select (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	unsigned char* msg,							/* csmgr Interest message				*/
+	int msg_len									/* message length						*/
+) {
+	uint32_t hash = 2166136261u;
+	uint16_t value16;
+	int key_len;
+	int i;
+
+	/* The body is [Interest Type][Chunk Num Flag][Name Length][Name][Chunk Num] 	*/
+	if (msg_len < CefC_Csmgr_Msg_HeaderLen + 2 + CefC_S_Length) {
+		return (0);
+	}
+	msg += CefC_Csmgr_Msg_HeaderLen + 2;
+	msg_len -= CefC_Csmgr_Msg_HeaderLen + 2;
+	memcpy (&value16, msg, CefC_S_Length);
+
+	/* The chunk number is not hashed, so that the chunks of a content are 	*/
+	/* looked up in order by one thread. The cache plugins send the chunks 	*/
+	/* which follow the requested one, and the lookups out of order would 	*/
+	/* make them send the following chunks again 								*/
+	key_len = CefC_S_Length + ntohs (value16);
+	if (key_len > msg_len) {
+		key_len = msg_len;
+	}
+
+	/* FNV-1a 	*/
+	for (i = 0 ; i < key_len ; i++) {
+		hash = (hash ^ msg[i]) * 16777619u;
+	}
+	return ((int)(hash % (uint32_t) hdl->lookup_thread_num));
+}
+/*--------------------------------------------------------------------------------------
+	Transfers the lookup message to the lookup thread
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+csmgrd_lookup_msg_transfer (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	int sock,									/* recv socket							*/
+	unsigned char* msg,							/* message								*/
+	int msg_len,								/* message length						*/
+	int fds_index,
+	int thread_index							/* index of the lookup thread			*/
+) {
+	char local_sock_name[PATH_MAX];
+
+	if (fds_index < 0) {
+		return (-1);
+	}
+	if (thread_index == 0) {
+		return (csmgrd_thread_msg_send (hdl, sock, msg, msg_len,
+					CSMGR_LOCAL_SOCK_NAME_OTHER_THREAD, &hdl->th_fds[fds_index]));
+	}
+	sprintf (local_sock_name, CSMGR_LOCAL_SOCK_NAME_LOOKUP_THREAD, thread_index);
+
+	return (csmgrd_thread_msg_send (hdl, sock, msg, msg_len,
+				local_sock_name, &hdl->lk_fds[fds_index][thread_index]));
+}
+/*--------------------------------------------------------------------------------------
+	Splits the batch of lookups by the lookup threads
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+csmgrd_batch_msg_transfer (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	int sock,									/* recv socket							*/
+	unsigned char* msg,							/* batch message						*/
+	int msg_len,								/* message length						*/
+	int fds_index
+) {
+	unsigned char sub_msg[CefC_Csmgr_Link_Batch_Size];
+	uint8_t rec_th[CefC_Csmgr_Link_Batch_Size / (CefC_Csmgr_Link_ReqId_Len + CefC_Csmgr_Msg_HeaderLen)];
+	uint16_t value16;
+	uint16_t len;
+	int rec_num = 0;
+	int index, sub_len;
+	int th, n;
+	int res = 0;
+
+	if (msg_len > CefC_Csmgr_Link_Batch_Size) {
+		return (csmgrd_lookup_msg_transfer (hdl, sock, msg, msg_len, fds_index, 0));
+	}
+
+	/* Each thread answers its own part, since the answers are matched by Request ID 	*/
+	for (index = CefC_Csmgr_Msg_HeaderLen ;
+		 index + CefC_Csmgr_Link_ReqId_Len + CefC_Csmgr_Msg_HeaderLen <= msg_len ; ) {
+		unsigned char* mp = &msg[index + CefC_Csmgr_Link_ReqId_Len];
+
+		memcpy (&value16, &mp[CefC_O_Fix_PacketLength], CefC_S_Length);
+		len = ntohs (value16);
+		if ((len < CefC_Csmgr_Msg_HeaderLen) ||
+			(index + CefC_Csmgr_Link_ReqId_Len + len > msg_len)) {
+			break;
+		}
+		rec_th[rec_num++] = (uint8_t) csmgrd_lookup_thread_select (hdl, mp, len);
+		index += CefC_Csmgr_Link_ReqId_Len + len;
+	}
+	msg_len = index;
+
+	for (th = 0 ; th < hdl->lookup_thread_num ; th++) {
+		sub_len = CefC_Csmgr_Msg_HeaderLen;
+		n = 0;
+		for (index = CefC_Csmgr_Msg_HeaderLen ; index < msg_len ; n++) {
+			memcpy (&value16,
+				&msg[index + CefC_Csmgr_Link_ReqId_Len + CefC_O_Fix_PacketLength], CefC_S_Length);
+			len = CefC_Csmgr_Link_ReqId_Len + ntohs (value16);
+			if (rec_th[n] == th) {
+				memcpy (&sub_msg[sub_len], &msg[index], len);
+				sub_len += len;
+			}
+			index += len;
+		}
+		if (sub_len == CefC_Csmgr_Msg_HeaderLen) {
+			continue;
+		}
+		memcpy (sub_msg, msg, CefC_Csmgr_Msg_HeaderLen);
+		value16 = htons ((uint16_t) sub_len);
+		memcpy (&sub_msg[CefC_O_Fix_PacketLength], &value16, CefC_S_Length);
+
+		if (csmgrd_lookup_msg_transfer (hdl, sock, sub_msg, sub_len, fds_index, th) < 0) {
+			res = -1;
+		}
+	}
+
+	return (res);
+}
+/*--------------------------------------------------------------------------------------
+	Closes the connections to the threads for the peer
+----------------------------------------------------------------------------------------*/
+static void
+csmgrd_thread_sock_close (
+	CefT_Csmgrd_Handle* hdl,					/* csmgr daemon handle					*/
+	int fds_index
+) {
+	int n;
+
+	if (hdl->th_fds[fds_index] != -1) {
+#ifdef CefC_Debug
+		cef_dbg_write (CefC_Dbg_Fine, "close sock:%d\n", hdl->th_fds[fds_index]);
+#endif // CefC_Debug
+		close (hdl->th_fds[fds_index]);
+		hdl->th_fds[fds_index] = -1;
+	}
+	for (n = 0 ; n < CsmgrdC_Max_Lookup_Threads ; n++) {
+		if (hdl->lk_fds[fds_index][n] != -1) {
+			close (hdl->lk_fds[fds_index][n]);
+			hdl->lk_fds[fds_index][n] = -1;
+		}
+	}
+	hdl->snd_fds[fds_index] = -1;
+}
 
 /*--------------------------------------------------------------------------------------
 	Check accept from thread local socket
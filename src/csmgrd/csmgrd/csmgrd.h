@@ -56,6 +56,7 @@
 #define CsmgrdC_Max_Sock_Num		32					/* Max number of TCP peer		*/
 #define CsmgrdC_Task_Main_Process	1					/* main process task			*/
 #define CsmgrdC_Task_Thread			2					/* thread task					*/
+#define CsmgrdC_Max_Lookup_Threads	16					/* Max number of lookup threads	*/
 
 /* Library name				*/
 #ifdef __APPLE__
@@ -77,6 +78,8 @@ typedef struct {
 	char			fsc_cache_path[CefC_Csmgr_File_Path_Length]; /* FSC cache path		*/
 	uint16_t 		port_num;					/* PORT_NUM in csmgrd.conf 				*/
 	char 			local_sock_id[CefC_LOCAL_SOCK_ID_SIZ+1];
+	uint32_t 		shm_size;					/* CS_SHM_SIZE in csmgrd.conf (MB)		*/
+	uint16_t 		lookup_threads;				/* LOOKUP_THREADS in csmgrd.conf 		*/
 
 } CsmgrT_Config_Param;
 
@@ -108,6 +111,8 @@ typedef struct {
 	unsigned char* 		tcp_buff[CsmgrdC_Max_Sock_Num];
 	int 				th_fds[CsmgrdC_Max_Sock_Num];
 	int 				snd_fds[CsmgrdC_Max_Sock_Num];
+	int 				lk_fds[CsmgrdC_Max_Sock_Num][CsmgrdC_Max_Lookup_Threads];
+												/* Sockets to the lookup threads		*/
 	char				peer_id_str[CsmgrdC_Max_Sock_Num][NI_MAXHOST];
 	char				peer_sv_str[CsmgrdC_Max_Sock_Num][NI_MAXSERV];
 	uint16_t 			peer_num;
@@ -134,6 +139,7 @@ typedef struct {
 	int					First_Node_f;		/* */
 
 	int					task;					/* Tasks using handle					*/
+	int					lookup_thread_num;		/* Number of the lookup threads			*/
 
 } CefT_Csmgrd_Handle;
 
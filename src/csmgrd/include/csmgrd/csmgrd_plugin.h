@@ -61,6 +61,14 @@
 
 #define CsmgrC_UCINC_Extend_Lifetime 	100000llu
 
+/* Bytes which an entry of mem_cache holds besides the name and the Cob, 	*/
+/* including the chunk number appended to the name to be used as the key 	*/
+#define CsmgrdC_Mem_Entry_Overhead		128
+
+/* Flags passed to the mode API of the cache algorithm library 			*/
+#define CsmgrdC_Lib_Mode_Chunk_Aware	0x01	/* Treats the chunks of a content	*/
+												/* as one entry						*/
+
 /****************************************************************************************
  Structure Declarations
  ****************************************************************************************/
@@ -81,8 +89,26 @@ typedef struct {
 	uint64_t		ins_time;					/* Insert time(use mem cache only)		*/
 	unsigned char*	version;					/* version								*/
 	uint16_t		ver_len;					/* Length of version					*/
+
+	void*			algo_h;						/* Handle of the entry which the cache	*/
+												/* algorithm library sets before it 	*/
+												/* calls the store API					*/
 } CsmgrdT_Content_Entry;
 
+/********** Memory usage of the cache		***********/
+typedef struct {
+	uint64_t		cob_num;					/* Cached Cobs							*/
+	uint64_t		entry_bytes;				/* Bytes of the entries which hold the	*/
+												/* Cobs									*/
+	uint64_t		block_bytes;				/* Bytes of the blocks allocated to the	*/
+												/* entries								*/
+	uint64_t		slab_bytes;					/* Bytes mapped for the slabs			*/
+	uint64_t		slab_num;					/* Number of the slabs					*/
+	uint64_t		large_bytes;				/* Bytes of the entries which are too	*/
+												/* large for the slabs					*/
+	uint64_t		index_bytes;				/* Bytes of the lookup table			*/
+} CsmgrdT_Mem_Stat;
+
 typedef struct CsmgrdT_Plugin_Interface {
 	/* Initialize process */
 	int (*init)(CsmgrT_Stat_Handle, int);		//0.8.3c
@@ -106,6 +132,9 @@ typedef struct CsmgrdT_Plugin_Interface {
 
 	int (*content_lifetime_get) (unsigned char*, uint16_t, uint32_t*, uint32_t*, uint8_t);
 
+	/* Get the memory usage (optional) */
+	int (*mem_stat_get)(CsmgrdT_Mem_Stat*);
+
 } CsmgrdT_Plugin_Interface;
 
 typedef struct CsmgrdT_Lib_Interface {
@@ -157,6 +186,34 @@ typedef struct CsmgrdT_Lib_Interface {
 		void*
 	);
 
+	/* Walk API (optional) 	*/
+	/* Calls the callback for each entry from the one which is evicted first, 	*/
+	/* with the key, the length of the key, the frequency and the argument 		*/
+	void
+	(*walk) (
+		void (*callback)(unsigned char*, int, int, void*),
+		void*
+	);
+
+	/* Mode API (optional) 	*/
+	/* Sets CsmgrdC_Lib_Mode_XXX flags, it is called before the init API 		*/
+	void
+	(*mode_set) (
+		int
+	);
+
+	/* Handle APIs (optional) 	*/
+	/* Same as the hit and erase APIs, but take algo_h of the stored entry 		*/
+	/* instead of the key, so the library does not look up the key again 		*/
+	void
+	(*hit_by_handle) (
+		void*
+	);
+	void
+	(*erase_by_handle) (
+		void*
+	);
+
 } CsmgrdT_Lib_Interface;
 
 /****************************************************************************************
@@ -45,10 +45,12 @@
 #include <stdio.h>
 #include <time.h>
 #include <limits.h>
+#include <pthread.h>
 
 #include <cefore/cef_client.h>
 #include <csmgrd/csmgrd_plugin.h>
 #include <cefore/cef_frame.h>
+#include <cefore/cef_hash.h>
 
 /****************************************************************************************
  Macros
@@ -56,6 +58,7 @@
 #define ALGO_MAX_MEM_USAGE				55
 
 #define	SEND_RETRY_LIMIT		10
+#define	SEND_LOCK_NUM			16		/* Number of the locks of the send sockets	*/
 
 /****************************************************************************************
  Structures Declaration
@@ -73,10 +76,25 @@ static char dbg_proc[256] = {0};
 static int 	dbg_lv = CefC_Dbg_None;
 #endif // CefC_Debug
 
+/* The lookup threads of csmgrd send Cobs to the same socket 	*/
+static pthread_mutex_t 	send_mutex[SEND_LOCK_NUM];
+static pthread_once_t 	send_mutex_once = PTHREAD_ONCE_INIT;
+
 /****************************************************************************************
  Static Function Declaration
  ****************************************************************************************/
 
+static void
+csmgrd_plugin_send_mutex_init (
+	void
+);
+static int
+csmgrd_plugin_cob_msg_send_core (
+	int fd,									/* socket fd								*/
+	unsigned char* msg,						/* send message								*/
+	uint16_t msg_len						/* message length							*/
+);
+
 static int
 csmgrd_log_trim_line_string (
 	const char* p1, 							/* target string for trimming 			*/
@@ -104,6 +122,47 @@ csmgrd_plugin_cob_msg_send (
 	int fd,									/* socket fd								*/
 	unsigned char* msg,						/* send message								*/
 	uint16_t msg_len						/* message length							*/
+) {
+	pthread_mutex_t* mp;
+	int res;
+
+	if (msg_len == 0) {
+		return (0);
+	}
+	if (fd < 0) {
+		return (-1);
+	}
+	pthread_once (&send_mutex_once, csmgrd_plugin_send_mutex_init);
+
+	/* The rest of a partial send must not be interleaved with other messages 	*/
+	mp = &send_mutex[fd % SEND_LOCK_NUM];
+	pthread_mutex_lock (mp);
+	res = csmgrd_plugin_cob_msg_send_core (fd, msg, msg_len);
+	pthread_mutex_unlock (mp);
+
+	return (res);
+}
+/*--------------------------------------------------------------------------------------
+	Initializes the locks of the send sockets
+----------------------------------------------------------------------------------------*/
+static void
+csmgrd_plugin_send_mutex_init (
+	void
+) {
+	int i;
+
+	for (i = 0 ; i < SEND_LOCK_NUM ; i++) {
+		pthread_mutex_init (&send_mutex[i], NULL);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Sends the Cob message, and retries the rest of a partial send
+----------------------------------------------------------------------------------------*/
+static int
+csmgrd_plugin_cob_msg_send_core (
+	int fd,									/* socket fd								*/
+	unsigned char* msg,						/* send message								*/
+	uint16_t msg_len						/* message length							*/
 ) {
 	unsigned char* p = msg;
 	int len = msg_len;
@@ -183,6 +242,10 @@ csmgrd_lib_api_get (
 	algo_apis->hit = dlsym (*algo_lib, "hit");
 	algo_apis->miss = dlsym (*algo_lib, "miss");
 	algo_apis->status = dlsym (*algo_lib, "status");
+	algo_apis->walk = dlsym (*algo_lib, "walk");
+	algo_apis->mode_set = dlsym (*algo_lib, "mode_set");
+	algo_apis->hit_by_handle = dlsym (*algo_lib, "hit_by_handle");
+	algo_apis->erase_by_handle = dlsym (*algo_lib, "erase_by_handle");
 
 	return (1);
 }
@@ -470,8 +533,9 @@ csmgrd_cache_algo_availability_check (
 	est_resource += capacity * (uint64_t)(8+32+name_size);
 
 	if (strcmp (cs_type, "memory") == 0) {
-		/* Cache Resource Estimate */
-		est_resource += capacity * (uint64_t)(8+40+name_size+cob_size);
+		/* Cache Resource Estimate (an entry of mem_cache and a bucket of its table) */
+		est_resource += capacity * (uint64_t)(CsmgrdC_Mem_Entry_Overhead
+			+ sizeof (void*) * CefC_Hash_Coef_Cache + name_size + cob_size);
 	} else {
 		est_resource += free_kiro * 1024 * 0.3;
 	}
@@ -31,6 +31,8 @@
  */
 #define __CSMGRD_FILE_SYSTEM_CACHE_SOURCE__
 
+#define _GNU_SOURCE
+
 //#define __FSCACHE_VERSION__
 
 /*
@@ -68,6 +70,7 @@
 #include <cefore/cef_frame.h>
 #include <csmgrd/csmgrd_plugin.h>
 #include <cefore/cef_pthread.h>
+#include <cefore/cef_uring.h>
 
 /****************************************************************************************
  Macros
@@ -94,13 +97,108 @@
 
 #define FscC_Page_Cob_Num		4096
 #define FscC_File_Page_Num		1000
+#define FscC_Page_Map_Num		16				/* Number of mapped blocks kept		*/
+
+#define FscC_Io_Depth_Max		CefC_Uring_Depth_Max
+#define FscC_Io_Direct_Align	512				/* Record size aligned for O_DIRECT	*/
+#define FscC_Io_Tag_Write		1				/* Write of a record				*/
+#define FscC_Io_Tag_Readahead	2				/* Read-ahead of the next block		*/
 
 #define FSC_RECORD_CORRECT_SIZE		CefC_Max_Header_Size
 
+#define FscC_Ckpt_File			"csmgr_fsc.ckpt"	/* Checkpoint in the root directory	*/
+#define FscC_Ckpt_Magic			0x4B435346			/* "FSCK"							*/
+#define FscC_Ckpt_Version		1
+#define FscC_Ckpt_Worker_Max	8					/* Threads to validate the contents	*/
+#define FscC_Ckpt_Align(n)		(((n) + 7) & ~((size_t) 7))
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/********** Block of a page file mapped for reading ***********/
+typedef struct {
+	uint32_t		index;						/* Index of the content					*/
+	int				page_index;					/* Page file number						*/
+	int				block_index;				/* Block number in the page file		*/
+	int				rcdsize;					/* Size of a record in the block		*/
+	unsigned char*	map_base;					/* Head of the mapping (NULL if unused)	*/
+	size_t			map_len;					/* Length of the mapping				*/
+	unsigned char*	block;						/* Head of the block in the mapping		*/
+	int				rec_num;					/* Number of records in the mapping		*/
+	uint64_t		map_time;					/* Time when the block was mapped		*/
+	uint64_t		used_seq;					/* Sequence of the last access			*/
+} FscT_Page_Map;
+
+/********** Header of the checkpoint of the cache index ***********/
+typedef struct {
+	uint32_t		magic;						/* FscC_Ckpt_Magic						*/
+	uint32_t		version;					/* FscC_Ckpt_Version					*/
+	uint32_t		fsc_id;						/* ID of the cache directory			*/
+	uint32_t		page_cob_num;				/* FscC_Page_Cob_Num					*/
+	uint32_t		file_page_num;				/* FscC_File_Page_Num					*/
+	uint32_t		rcd_num;					/* Number of the contents				*/
+	uint64_t		order_num;					/* Number of the entries of the order	*/
+	uint64_t		snap_time;					/* Time when the snapshot was taken		*/
+	uint64_t		body_len;					/* Length following the header			*/
+	uint32_t		checksum;					/* FNV-1a of the following part			*/
+	uint32_t		reserved;
+	char			algo_name[256];				/* Library of the cache algorithm		*/
+} FscT_Ckpt_Head;
+
+/********** Content in the checkpoint (followed by name, version and bitmap) ***********/
+typedef struct {
+	uint32_t		index;						/* Index of the content directory		*/
+	uint16_t		name_len;					/* Length of the name					*/
+	uint16_t		ver_len;					/* Length of the version				*/
+	uint32_t		map_num;					/* Number of the elements of bitmap		*/
+	uint32_t		file_msglen;				/* Size of a record in the page files	*/
+	uint32_t		detect_chunkno;
+	uint32_t		cob_size;
+	uint32_t		last_cob_size;
+	uint32_t		last_chunk_num;
+	uint64_t		cob_num;
+	uint64_t		con_size;
+	uint64_t		access;
+	uint64_t		expiry;
+	uint64_t		cached_time;
+} FscT_Ckpt_Rcd;
+
+/********** Entry of the order of the cache algorithm (followed by key) ***********/
+typedef struct {
+	uint16_t		key_len;					/* Length of the key					*/
+	uint16_t		freq;						/* Frequency of the entry				*/
+} FscT_Ckpt_Order;
+
+/********** Content whose page files are synced before the checkpoint ***********/
+typedef struct {
+	uint32_t		index;						/* Index of the content directory		*/
+	uint32_t		page_num;					/* Number of the page files				*/
+} FscT_Ckpt_Sync;
+
+/********** Buffer which the snapshot is serialized into ***********/
+typedef struct {
+	unsigned char*	data;
+	size_t			len;
+	size_t			size;
+	int				err;						/* 1 if the allocation failed			*/
+	uint32_t		rcd_num;
+	uint64_t		order_num;
+	FscT_Ckpt_Sync*	sync;						/* Contents written since the last one	*/
+	uint32_t		sync_num;
+	uint32_t		sync_size;
+} FscT_Ckpt_Buff;
+
+/********** Thread to validate the contents in the checkpoint ***********/
+typedef struct {
+	pthread_t		th;
+	int				worker_id;
+	int				worker_num;
+	const size_t*	offs;						/* Offsets of the contents				*/
+	uint32_t		rcd_num;					/* Number of the contents				*/
+	unsigned char*	valid;						/* Results of the validation			*/
+} FscT_Ckpt_Worker;
+
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
@@ -121,6 +219,20 @@ static pthread_mutex_t 			fsc_cs_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static uint64_t					fsc_extend_lifetime = CsmgrC_UCINC_Extend_Lifetime;
 
+static FscT_Page_Map			fsc_page_map[FscC_Page_Map_Num];
+static uint64_t					fsc_page_map_seq = 0;
+
+static CefT_Uring*				fsc_io_ring = NULL;		/* NULL if stdio is used		*/
+static int						fsc_io_depth = 0;
+static int						fsc_io_direct_f = 0;
+static int						fsc_io_wr_num = 0;		/* Writes in flight				*/
+
+static unsigned char*			fsc_ckpt_map = NULL;	/* Checkpoint mapped at startup	*/
+static size_t					fsc_ckpt_map_len = 0;
+static char						fsc_ckpt_prev_path[CefC_Csmgr_File_Path_Length + 32];
+												/* Cache directory of the checkpoint	*/
+static uint64_t					fsc_ckpt_sync_time = 0;	/* Snapshot of the last checkpoint	*/
+
 /****************************************************************************************
  Static Function Declaration
  ****************************************************************************************/
@@ -171,6 +283,59 @@ fsc_cache_item_puts (
 	unsigned char* msg,
 	int msg_len
 );
+/*--------------------------------------------------------------------------------------
+	Returns the mapped block of the page file which caches the specified record
+----------------------------------------------------------------------------------------*/
+static FscT_Page_Map*				/* NULL if the block could not be mapped			*/
+fsc_page_map_get (
+	CsmgrT_Stat* rcd,							/* information of the content			*/
+	int page_index,								/* page file number						*/
+	int block_index,							/* block number in the page file		*/
+	int pos_index,								/* record number in the block			*/
+	int rcdsize,								/* size of a record						*/
+	uint64_t nowt								/* current time							*/
+);
+/*--------------------------------------------------------------------------------------
+	Unmaps the blocks of the specified content (all blocks if index is UINT32_MAX)
+----------------------------------------------------------------------------------------*/
+static void
+fsc_page_map_purge (
+	uint32_t index								/* index of the content					*/
+);
+/*--------------------------------------------------------------------------------------
+	Returns the length of the record area for the Cob
+----------------------------------------------------------------------------------------*/
+static uint32_t
+fsc_record_msglen (
+	uint16_t msg_len							/* length of the Cob					*/
+);
+/*--------------------------------------------------------------------------------------
+	Queues the write of a record of the page file to io_uring
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_io_write_queue (
+	int fd,										/* FD of the page file					*/
+	int64_t offset,								/* offset of the record					*/
+	unsigned char* msg,							/* Cob									*/
+	uint16_t msg_len,							/* length of the Cob					*/
+	int rcdsize									/* size of a record						*/
+);
+/*--------------------------------------------------------------------------------------
+	Waits for the completions of all the writes in flight
+----------------------------------------------------------------------------------------*/
+static void
+fsc_io_write_drain (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Handles a completion of io_uring
+----------------------------------------------------------------------------------------*/
+static void
+fsc_io_complete (
+	uint16_t tag,								/* FscC_Io_Tag_XXX						*/
+	int fd,										/* FD of the I/O						*/
+	int res										/* result of the I/O					*/
+);
 /*--------------------------------------------------------------------------------------
 	Store API
 ----------------------------------------------------------------------------------------*/
@@ -244,7 +409,8 @@ fsc_root_dir_check (
 ----------------------------------------------------------------------------------------*/
 static uint32_t						/* The return value is FSCID						*/
 fsc_cache_id_create (
-	FscT_Cache_Handle* hdl
+	FscT_Cache_Handle* hdl,
+	uint32_t prev_id							/* ID which must not be used			*/
 );
 /*--------------------------------------------------------------------------------------
 	delete file in this directory
@@ -267,6 +433,42 @@ static int							/* The return value is negative if an error occurs	*/
 fsc_recursive_dir_clear (
 	char* filepath								/* file path							*/
 );
+/*--------------------------------------------------------------------------------------
+	Takes the snapshot of the cache index (fsc_cs_mutex must be held)
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_ckpt_snapshot (
+	FscT_Ckpt_Buff* buff,						/* buffer to serialize into				*/
+	uint64_t nowt								/* current time							*/
+);
+/*--------------------------------------------------------------------------------------
+	Flushes the page files of the contents in the snapshot to the disk
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_ckpt_page_sync (
+	FscT_Ckpt_Buff* buff						/* snapshot								*/
+);
+/*--------------------------------------------------------------------------------------
+	Writes the snapshot to the checkpoint file
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_ckpt_write (
+	FscT_Ckpt_Buff* buff						/* snapshot								*/
+);
+/*--------------------------------------------------------------------------------------
+	Maps the checkpoint saved by the previous csmgrd
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_ckpt_open (
+	uint32_t* prev_id							/* ID of the previous cache directory	*/
+);
+/*--------------------------------------------------------------------------------------
+	Restores the cache index from the mapped checkpoint
+----------------------------------------------------------------------------------------*/
+static int							/* Number of the restored contents					*/
+fsc_ckpt_load (
+	void
+);
 
 /****************************************************************************************
  ****************************************************************************************/
@@ -306,6 +508,9 @@ fsc_cs_create (
 	FscT_Config_Param conf_param;
 	int i;
 	int res;
+	uint32_t prev_id = 0xFFFFFFFF;
+	char ckpt_path[PATH_MAX];
+	struct timeval tv;
 
 	/* Check handle */
 	if (hdl) {
@@ -330,9 +535,29 @@ fsc_cs_create (
 	strcpy (hdl->algo_name, conf_param.algo_name);
 	hdl->algo_name_size = conf_param.algo_name_size;
 	hdl->algo_cob_size = conf_param.algo_cob_size;
+	hdl->algo_chunk_aware = conf_param.algo_chunk_aware;
 	hdl->cache_cobs = 0;
 	strcpy (hdl->fsc_root_path, conf_param.fsc_root_path);
 	fsc_extend_lifetime = conf_param.extend_lifetime;
+	hdl->index_persist = conf_param.index_persist;
+	hdl->ckpt_interval = conf_param.ckpt_interval * 1000000llu;
+
+	/* Creates io_uring to write the page files, or falls back to stdio 	*/
+	if (conf_param.io_depth > 0) {
+		fsc_io_ring = cef_uring_create (
+				conf_param.io_depth, sizeof (uint16_t) + CefC_Max_Msg_Size + FscC_Io_Direct_Align);
+		if (fsc_io_ring) {
+			fsc_io_depth = conf_param.io_depth;
+#ifdef O_DIRECT
+			fsc_io_direct_f = conf_param.io_direct;
+#endif // O_DIRECT
+			csmgrd_log_write (CefC_Log_Info, "I/O : io_uring (depth=%d%s)\n",
+				conf_param.io_depth, fsc_io_direct_f ? ", O_DIRECT" : "");
+		} else {
+			csmgrd_log_write (CefC_Log_Warn,
+				"io_uring is not available, the page files are written with stdio\n");
+		}
+	}
 
 	/* Check for excessive or insufficient memory resources for cache algorithm library */
 	if (strcmp (hdl->algo_name, "None") != 0) {
@@ -351,8 +576,16 @@ fsc_cs_create (
 		return (-1);
 	}
 
+	/* Maps the checkpoint saved by the previous csmgrd, otherwise it is stale 	*/
+	if (hdl->index_persist) {
+		fsc_ckpt_open (&prev_id);
+	} else {
+		snprintf (ckpt_path, sizeof (ckpt_path), "%s/%s", hdl->fsc_root_path, FscC_Ckpt_File);
+		unlink (ckpt_path);
+	}
+
 	/* Creates the directory to store cache files		*/
-	hdl->fsc_id = fsc_cache_id_create (hdl);
+	hdl->fsc_id = fsc_cache_id_create (hdl, prev_id);
 	if (hdl->fsc_id == 0xFFFFFFFF) {
 		csmgrd_log_write (CefC_Log_Error, "FileSystemCache init error\n");
 		return (-1);
@@ -373,6 +606,14 @@ fsc_cs_create (
 			return (-1);
 		}
 		csmgrd_log_write (CefC_Log_Info, "Library : %s ... OK\n", hdl->algo_name);
+		if (hdl->algo_chunk_aware) {
+			if (hdl->algo_apis.mode_set) {
+				(*(hdl->algo_apis.mode_set))(CsmgrdC_Lib_Mode_Chunk_Aware);
+			} else {
+				csmgrd_log_write (CefC_Log_Warn,
+					"%s does not support CACHE_ALGO_CHUNK_AWARE\n", hdl->algo_name);
+			}
+		}
 		if (hdl->algo_apis.init) {
 			(*(hdl->algo_apis.init))(hdl->cache_capacity, fsc_cs_store, fsc_cs_remove);
 		}
@@ -423,8 +664,21 @@ fsc_cs_create (
 	} else {
 		csmgrd_log_write (CefC_Log_Info, "Library  : Not Specified\n");
 	}
+	csmgrd_log_write (CefC_Log_Info, "Index Persist  : %s\n", hdl->index_persist ? "Yes" : "No");
 	csmgr_stat_hdl = stat_hdl;
 	csmgrd_stat_cache_capacity_update (csmgr_stat_hdl, hdl->cache_capacity);
+
+	/* Restores the cache index from the checkpoint. This must follow the 	*/
+	/* capacity update, which clears the content information.				*/
+	if (fsc_ckpt_map) {
+		pthread_mutex_lock (&fsc_cs_mutex);
+		res = fsc_ckpt_load ();
+		pthread_mutex_unlock (&fsc_cs_mutex);
+		csmgrd_log_write (CefC_Log_Info, "Checkpoint : %d contents are restored\n", res);
+	}
+	gettimeofday (&tv, NULL);
+	hdl->ckpt_time = tv.tv_sec * 1000000llu + tv.tv_usec;
+
 	return (0);
 }
 /*--------------------------------------------------------------------------------------
@@ -556,6 +810,7 @@ fsc_cs_remove (
 					if (rcd->cob_num == 1) {
 						char file_path[PATH_MAX];
 						sprintf (file_path, "%s/%d", hdl->fsc_cache_path, (int) rcd->index);
+						fsc_page_map_purge (rcd->index);
 						fsc_recursive_dir_clear (file_path);
 					}
 					csmgrd_stat_cob_remove (
@@ -579,6 +834,9 @@ fsc_cs_destroy (
 ) {
 	int i = 0;
 	void* status;
+	FscT_Ckpt_Buff buff;
+	struct timeval tv;
+	int persist_f = 0;
 
 	pthread_mutex_destroy (&fsc_cs_mutex);
 
@@ -591,6 +849,14 @@ fsc_cs_destroy (
 	sem_close (fsc_comn_buff_sem);
 	sem_unlink (FcsC_SEMNAME);
 
+	/* Unmap the blocks of the page files 		*/
+	fsc_page_map_purge (UINT32_MAX);
+	if (fsc_io_ring) {
+		fsc_io_write_drain ();
+		cef_uring_destroy (fsc_io_ring);
+		fsc_io_ring = NULL;
+	}
+
 	/* Destroy the common work buffer 		*/
 	for (i = 0 ; i < FscC_Max_Buff ; i++) {
 		if (fsc_proc_cob_buff[i]) {
@@ -604,7 +870,19 @@ fsc_cs_destroy (
 		return;
 	}
 
-	if (hdl->fsc_cache_path[0] != 0x00) {
+	/* Keeps the page files if the checkpoint is saved 		*/
+	if (hdl->index_persist && (hdl->fsc_cache_path[0] != 0x00)) {
+		gettimeofday (&tv, NULL);
+		if ((fsc_ckpt_snapshot (&buff, tv.tv_sec * 1000000llu + tv.tv_usec) < 0) ||
+			(fsc_ckpt_write (&buff) < 0)) {
+			csmgrd_log_write (CefC_Log_Warn, "Failed to save the checkpoint\n");
+		} else {
+			csmgrd_log_write (CefC_Log_Info,
+				"Checkpoint : %u contents are saved\n", buff.rcd_num);
+			persist_f = 1;
+		}
+	}
+	if ((hdl->fsc_cache_path[0] != 0x00) && !persist_f) {
 		fsc_recursive_dir_clear (hdl->fsc_cache_path);
 	}
 
@@ -641,6 +919,10 @@ fsc_cs_expire_check (
 	int 			trg_key_len = 0;
 	int 			name_len;
 	uint64_t		cob_cnt;
+	FscT_Ckpt_Buff	buff;
+	int				ckpt_f = 0;
+	uint64_t		nowt;
+	struct timeval	tv;
 
 	if (pthread_mutex_trylock (&fsc_cs_mutex) != 0) {
 		return;
@@ -653,6 +935,7 @@ fsc_cs_expire_check (
 		}
 
 		sprintf (file_path, "%s/%d", hdl->fsc_cache_path, (int) rcd->index);
+		fsc_page_map_purge (rcd->index);
 		fsc_recursive_dir_clear (file_path);
 
 		cob_cnt = rcd->cob_num;
@@ -698,8 +981,22 @@ fsc_cs_expire_check (
 LOOP_END:;
 
 	}
+
+	/* Takes the snapshot periodically, and writes it after the unlock 	*/
+	if (hdl->index_persist && hdl->ckpt_interval) {
+		gettimeofday (&tv, NULL);
+		nowt = tv.tv_sec * 1000000llu + tv.tv_usec;
+		if (nowt >= hdl->ckpt_time + hdl->ckpt_interval) {
+			ckpt_f = (fsc_ckpt_snapshot (&buff, nowt) == 0);
+			hdl->ckpt_time = nowt;
+		}
+	}
 	pthread_mutex_unlock (&fsc_cs_mutex);
 
+	if (ckpt_f && (fsc_ckpt_write (&buff) < 0)) {
+		csmgrd_log_write (CefC_Log_Warn, "Failed to save the checkpoint\n");
+	}
+
 	return;
 
 }
@@ -725,13 +1022,12 @@ fsc_cache_item_get (
 	uint64_t 	mask;
 	uint32_t 	x;
 	char		file_path[PATH_MAX];
-	static char	red_file_path[PATH_MAX] = {0};
 	int 		cob_block_index;
-	static int  red_cob_block_index = -1;
-	int			rtc;
 	int 		page_index;
 	int 		pos_index;
-	FILE*		fp = NULL;
+	FscT_Page_Map*	pmap;
+	unsigned char*	rec;
+	uint16_t	mlen;
 	int 		i;
 	int 		tx_cnt = 0;
 	int			resend_1cob_f = 0;
@@ -740,13 +1036,8 @@ fsc_cache_item_get (
 	int 			trg_key_len;
 	uint64_t nowt;
 	struct timeval tv;
-	static unsigned char*	page_cob_buf = NULL;
-	static uint64_t		page_read_time = 0L;
 	int				rcdsize;
 	int			rc = CefC_CV_Inconsistent;
-	int			update_ver = 1;
-	static uint16_t red_ver_len = 0;
-	static unsigned char red_version[PATH_MAX] = {0};
 	uint16_t ucinc_stat;
 	int ret;
 	uint64_t plaint = 0;
@@ -770,6 +1061,7 @@ fsc_cache_item_get (
 #ifdef CefC_Debug
 		csmgrd_dbg_write (CefC_Dbg_Fine, "Delete the expired content = %s\n", file_path);
 #endif // CefC_Debug
+		fsc_page_map_purge (rcd->index);
 		fsc_recursive_dir_clear (file_path);
 		csmgrd_stat_content_info_delete (csmgr_stat_hdl, key, key_size);
 		hdl->cache_cobs -= rcd->cob_num;
@@ -895,94 +1187,43 @@ fsc_cache_item_get (
 		rcd->tx_time = nowt + FscC_Sent_Reset_Time;
 	}
 
-	/* Open the file that specified cob is cached 		*/
+	/* Obtain the mapped block that specified cob is cached 		*/
 	cob_block_index = (int)(seqno / FscC_Page_Cob_Num) % FscC_File_Page_Num;
 	page_index = (int)(seqno / FscC_Page_Cob_Num/FscC_File_Page_Num);
 	pos_index = (int)(seqno % FscC_Page_Cob_Num);
-	sprintf (file_path, "%s/%d/%d", hdl->fsc_cache_path, (int) rcd->index, page_index);
 
-	if (ver_len) {
-		if (red_ver_len == ver_len &&
-			memcmp (version, red_version, red_ver_len) == 0) {
-			update_ver = 0;
-		}
-	} else if ( rcd->fsc_write_time < page_read_time ){
-		update_ver = 0;
-	}
-
-	if ( strcmp (red_file_path, file_path) != 0 || cob_block_index != red_cob_block_index ||
-		(strcmp (red_file_path, file_path) == 0 && update_ver != 0)) {
-		int i;
-		if (page_cob_buf != NULL) {
-			free (page_cob_buf);
-			page_cob_buf = NULL;
-			page_read_time = 0L;
-		}
-
-		fp = fopen (file_path, "rb");
-		if (fp == NULL) {
-			csmgrd_log_write (CefC_Log_Error, "Failed to open the cache file (%s)\n", file_path);
-			goto ItemGetPost;
-		}
-		strcpy (red_file_path, file_path);
-		red_cob_block_index = cob_block_index;
-		page_cob_buf = calloc (FscC_Page_Cob_Num, rcdsize);
-		if (fp == NULL) {
-			csmgrd_log_write (CefC_Log_Error, "Failed to allocate page_cob_buf (size=%u)\n", FscC_Page_Cob_Num*rcdsize);
-			goto ItemGetPost;
-		}
-		page_read_time = nowt;
-		fseek (fp, (int64_t)cob_block_index * (int64_t)rcdsize * FscC_Page_Cob_Num, SEEK_SET);
-		for (i=0; i<FscC_Page_Cob_Num; i++) {
-			rtc = fread (&page_cob_buf[i*rcdsize], rcdsize, 1, fp);
-			if (rtc != 1) {
-				break;
-			}
-		}
-		if (i < pos_index) {
+	pmap = fsc_page_map_get (rcd, page_index, cob_block_index, pos_index, rcdsize, nowt);
+	if (pmap == NULL) {
 #ifdef CefC_Debug
-			csmgrd_dbg_write (CefC_Dbg_Finer, "Failed to read the request chunk (%s, chunk_num=%d)\n", file_path, seqno);
+		csmgrd_dbg_write (CefC_Dbg_Finer,
+			"Failed to read the request chunk (%s/%d/%d, chunk_num=%d)\n",
+			hdl->fsc_cache_path, (int) rcd->index, page_index, seqno);
 #endif // CefC_Debug
-			goto ItemGetPost;
-		}
-		if (red_ver_len) {
-			memset (red_version, 0, PATH_MAX);
-		}
-		red_ver_len = ver_len;
-		if (ver_len) {
-			memcpy (red_version, version, ver_len);
-		}
-	} else {
-		fp = NULL;
+		pthread_mutex_unlock (&fsc_cs_mutex);
+		return (CefC_Csmgr_Cob_Exist);
 	}
 
-	/* Send the cobs 		*/
+	/* Send the cobs from the mapping 		*/
+	rec = &pmap->block[pos_index * rcdsize];
+	memcpy (&mlen, rec, sizeof (uint16_t));
 #ifdef CefC_Debug
-	{
-		uint16_t mlen;
-		memcpy (&mlen, &page_cob_buf[pos_index*rcdsize], sizeof (uint16_t));
-		csmgrd_dbg_write (CefC_Dbg_Finest, "send seqno = %u (%u bytes)\n", seqno, mlen);
-	}
+	csmgrd_dbg_write (CefC_Dbg_Finest, "send seqno = %u (%u bytes)\n", seqno, mlen);
 #endif // CefC_Debug
 	csmgrd_stat_access_count_update (
 			csmgr_stat_hdl, key, key_size);
 
 	/* Send Cob to cefnetd */
-	uint16_t mlen;
-	memcpy (&mlen, &page_cob_buf[pos_index*rcdsize], sizeof (uint16_t));
-	csmgrd_plugin_cob_msg_send (
-						sock, &page_cob_buf[pos_index*rcdsize+sizeof (uint16_t)], mlen);
+	if (CefC_S_Fix_Header < mlen && mlen < rcdsize) {
+		csmgrd_plugin_cob_msg_send (sock, &rec[sizeof (uint16_t)], mlen);
+	}
 	if (resend_1cob_f == 1) {
-		if (fp != NULL) {
-			fclose (fp);
-		}
 		pthread_mutex_unlock (&fsc_cs_mutex);
 		return (CefC_Csmgr_Cob_Exist);
 	}
 	tx_cnt++;
 	seqno++;
 
-	for (i = pos_index + 1 ; i < FscC_Page_Cob_Num ; i++) {
+	for (i = pos_index + 1 ; i < pmap->rec_num ; i++) {
 		if (tx_cnt < FscC_Tx_Cob_Num) {
 			mask = 1;
 			x = seqno / 64;
@@ -992,18 +1233,13 @@ fsc_cache_item_get (
 				seqno++;
 				continue;
 			}
+			rec = &pmap->block[i * rcdsize];
+			memcpy (&mlen, rec, sizeof (uint16_t));
 #ifdef CefC_Debug
-			{
-				uint16_t mlen;
-				memcpy (&mlen, &page_cob_buf[i*rcdsize], sizeof (uint16_t));
-				csmgrd_dbg_write (CefC_Dbg_Finest, "send seqno = %u (%u bytes)\n", seqno, mlen);
-			}
+			csmgrd_dbg_write (CefC_Dbg_Finest, "send seqno = %u (%u bytes)\n", seqno, mlen);
 #endif // CefC_Debug
-			uint16_t mlen;
-			memcpy (&mlen, &page_cob_buf[i*rcdsize], sizeof (uint16_t));
 			if (CefC_S_Fix_Header < mlen && mlen < rcdsize) {
-				csmgrd_plugin_cob_msg_send (
-					sock, &page_cob_buf[i*rcdsize+sizeof (uint16_t)], mlen);
+				csmgrd_plugin_cob_msg_send (sock, &rec[sizeof (uint16_t)], mlen);
 			}
 			tx_cnt++;
 			seqno++;
@@ -1012,13 +1248,245 @@ fsc_cache_item_get (
 		}
 	}
 
-ItemGetPost:
-	if (fp != NULL) {
-		fclose (fp);
-	}
 	pthread_mutex_unlock (&fsc_cs_mutex);
 	return (CefC_Csmgr_Cob_Exist);
 }
+/*--------------------------------------------------------------------------------------
+	Returns the mapped block of the page file which caches the specified record
+----------------------------------------------------------------------------------------*/
+static FscT_Page_Map*				/* NULL if the block could not be mapped			*/
+fsc_page_map_get (
+	CsmgrT_Stat* rcd,							/* information of the content			*/
+	int page_index,								/* page file number						*/
+	int block_index,							/* block number in the page file		*/
+	int pos_index,								/* record number in the block			*/
+	int rcdsize,								/* size of a record						*/
+	uint64_t nowt								/* current time							*/
+) {
+	FscT_Page_Map* pmap = NULL;
+	FscT_Page_Map* lru = &fsc_page_map[0];
+	char file_path[PATH_MAX];
+	struct stat st;
+	off_t block_off;
+	off_t map_off;
+	size_t map_len;
+	long page_size;
+	void* base;
+	int fd;
+	int i;
+
+	/* Collects the read-ahead which have completed 	*/
+	if (fsc_io_ring) {
+		uint16_t tag;
+		int io_fd, io_res;
+		while (cef_uring_reap (fsc_io_ring, 0, &tag, &io_fd, &io_res) > 0) {
+			fsc_io_complete (tag, io_fd, io_res);
+		}
+	}
+
+	/* Looks up the blocks which are already mapped 	*/
+	for (i = 0 ; i < FscC_Page_Map_Num ; i++) {
+		if (fsc_page_map[i].map_base == NULL) {
+			if (lru->map_base != NULL) {
+				lru = &fsc_page_map[i];
+			}
+			continue;
+		}
+		if (fsc_page_map[i].index == rcd->index &&
+			fsc_page_map[i].page_index == page_index &&
+			fsc_page_map[i].block_index == block_index &&
+			fsc_page_map[i].rcdsize == rcdsize) {
+			pmap = &fsc_page_map[i];
+			break;
+		}
+		if (lru->map_base != NULL && fsc_page_map[i].used_seq < lru->used_seq) {
+			lru = &fsc_page_map[i];
+		}
+	}
+	if (pmap) {
+		/* The records written after mapping may be beyond the end of the mapping 	*/
+		if (rcd->fsc_write_time < pmap->map_time && pos_index < pmap->rec_num) {
+			pmap->used_seq = ++fsc_page_map_seq;
+			return (pmap);
+		}
+		lru = pmap;
+	}
+	if (lru->map_base != NULL) {
+		munmap (lru->map_base, lru->map_len);
+		lru->map_base = NULL;
+	}
+
+	/* Maps the block of the page file 		*/
+	sprintf (file_path, "%s/%d/%d", hdl->fsc_cache_path, (int) rcd->index, page_index);
+	fd = open (file_path, O_RDONLY);
+	if (fd < 0) {
+		csmgrd_log_write (CefC_Log_Error, "Failed to open the cache file (%s)\n", file_path);
+		return (NULL);
+	}
+	if (fstat (fd, &st) < 0) {
+		close (fd);
+		return (NULL);
+	}
+	block_off = (off_t) block_index * FscC_Page_Cob_Num * rcdsize;
+	if (st.st_size < block_off + (off_t)(pos_index + 1) * rcdsize) {
+		close (fd);
+		return (NULL);
+	}
+	page_size = sysconf (_SC_PAGESIZE);
+	map_off = block_off - (block_off % page_size);
+	map_len = (size_t)(block_off - map_off) + (size_t) FscC_Page_Cob_Num * rcdsize;
+	if (map_off + (off_t) map_len > st.st_size) {
+		map_len = (size_t)(st.st_size - map_off);
+	}
+	base = mmap (NULL, map_len, PROT_READ, MAP_SHARED, fd, map_off);
+	if (base != MAP_FAILED && fsc_io_ring &&
+		block_index + 1 < FscC_File_Page_Num &&
+		st.st_size > block_off + (off_t) FscC_Page_Cob_Num * rcdsize) {
+		/* Reads the next block ahead so that the consumer which goes on to it 	*/
+		/* does not wait for the disk. The FD is closed on the completion 		*/
+		if (cef_uring_fadvise (fsc_io_ring, fd, block_off + (off_t) FscC_Page_Cob_Num * rcdsize,
+				(uint32_t) FscC_Page_Cob_Num * rcdsize, POSIX_FADV_WILLNEED,
+				FscC_Io_Tag_Readahead) == 0) {
+			cef_uring_submit (fsc_io_ring);
+			fd = -1;
+		}
+	}
+	if (fd >= 0) {
+		close (fd);
+	}
+	if (base == MAP_FAILED) {
+		csmgrd_log_write (CefC_Log_Error,
+			"Failed to map the cache file (%s, %s)\n", file_path, strerror (errno));
+		return (NULL);
+	}
+
+	lru->index 			= rcd->index;
+	lru->page_index 	= page_index;
+	lru->block_index 	= block_index;
+	lru->rcdsize 		= rcdsize;
+	lru->map_base 		= (unsigned char*) base;
+	lru->map_len 		= map_len;
+	lru->block 			= lru->map_base + (block_off - map_off);
+	lru->rec_num 		= (int)((map_len - (size_t)(block_off - map_off)) / rcdsize);
+	lru->map_time 		= nowt;
+	lru->used_seq 		= ++fsc_page_map_seq;
+
+	return (lru);
+}
+/*--------------------------------------------------------------------------------------
+	Unmaps the blocks of the specified content (all blocks if index is UINT32_MAX)
+----------------------------------------------------------------------------------------*/
+static void
+fsc_page_map_purge (
+	uint32_t index								/* index of the content					*/
+) {
+	int i;
+
+	for (i = 0 ; i < FscC_Page_Map_Num ; i++) {
+		if (fsc_page_map[i].map_base == NULL) {
+			continue;
+		}
+		if (index == UINT32_MAX || fsc_page_map[i].index == index) {
+			munmap (fsc_page_map[i].map_base, fsc_page_map[i].map_len);
+			fsc_page_map[i].map_base = NULL;
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Returns the length of the record area for the Cob
+----------------------------------------------------------------------------------------*/
+static uint32_t
+fsc_record_msglen (
+	uint16_t msg_len							/* length of the Cob					*/
+) {
+	uint32_t len;
+
+	len = ((msg_len + FSC_RECORD_CORRECT_SIZE) < CefC_Max_Msg_Size ?
+			(msg_len + FSC_RECORD_CORRECT_SIZE) : CefC_Max_Msg_Size);
+	if (fsc_io_direct_f) {
+		/* O_DIRECT requires the offsets and the lengths of the records aligned 	*/
+		len = (uint32_t)(sizeof (uint16_t) + len + FscC_Io_Direct_Align - 1)
+				/ FscC_Io_Direct_Align * FscC_Io_Direct_Align - sizeof (uint16_t);
+	}
+	return (len);
+}
+/*--------------------------------------------------------------------------------------
+	Queues the write of a record of the page file to io_uring
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_io_write_queue (
+	int fd,										/* FD of the page file					*/
+	int64_t offset,								/* offset of the record					*/
+	unsigned char* msg,							/* Cob									*/
+	uint16_t msg_len,							/* length of the Cob					*/
+	int rcdsize									/* size of a record						*/
+) {
+	unsigned char* buff;
+	uint16_t tag;
+	int buff_idx;
+	int io_fd, io_res;
+
+	/* Waits for a buffer if all of them are in flight 	*/
+	while ((buff = cef_uring_buff_get (fsc_io_ring, &buff_idx)) == NULL) {
+		if (cef_uring_reap (fsc_io_ring, 1, &tag, &io_fd, &io_res) <= 0) {
+			return (-1);
+		}
+		fsc_io_complete (tag, io_fd, io_res);
+	}
+	memcpy (buff, &msg_len, sizeof (uint16_t));
+	memcpy (&buff[sizeof (uint16_t)], msg, msg_len);
+	memset (&buff[sizeof (uint16_t) + msg_len], 0, rcdsize - sizeof (uint16_t) - msg_len);
+
+	while (cef_uring_write (fsc_io_ring, fd, buff_idx, rcdsize, offset, FscC_Io_Tag_Write) < 0) {
+		/* The submission queue is full of the read-ahead 	*/
+		if (cef_uring_reap (fsc_io_ring, 1, &tag, &io_fd, &io_res) <= 0) {
+			return (-1);
+		}
+		fsc_io_complete (tag, io_fd, io_res);
+	}
+	fsc_io_wr_num++;
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Waits for the completions of all the writes in flight
+----------------------------------------------------------------------------------------*/
+static void
+fsc_io_write_drain (
+	void
+) {
+	uint16_t tag;
+	int io_fd, io_res;
+
+	cef_uring_submit (fsc_io_ring);
+	while (fsc_io_wr_num > 0) {
+		if (cef_uring_reap (fsc_io_ring, 1, &tag, &io_fd, &io_res) <= 0) {
+			csmgrd_log_write (CefC_Log_Error, "Failed to wait for the writes of the cache\n");
+			fsc_io_wr_num = 0;
+			break;
+		}
+		fsc_io_complete (tag, io_fd, io_res);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Handles a completion of io_uring
+----------------------------------------------------------------------------------------*/
+static void
+fsc_io_complete (
+	uint16_t tag,								/* FscC_Io_Tag_XXX						*/
+	int fd,										/* FD of the I/O						*/
+	int res										/* result of the I/O					*/
+) {
+	if (tag == FscC_Io_Tag_Write) {
+		fsc_io_wr_num--;
+		if (res < 0) {
+			csmgrd_log_write (CefC_Log_Error,
+				"Failed to write the cache file (%s)\n", strerror (-res));
+		}
+	} else if (tag == FscC_Io_Tag_Readahead) {
+		close (fd);
+	}
+}
 /*--------------------------------------------------------------------------------------
 	Upload content byte steream
 ----------------------------------------------------------------------------------------*/
@@ -1123,6 +1591,8 @@ fsc_cache_cob_write (
 	int 			rcdsize;
 	char			cont_path[PATH_MAX];
 	FILE*			fp = NULL;
+	int				wfd = -1;
+	int				cs_lock_f = 0;
 	uint64_t 		mask;
 	uint32_t 		x;
 	int*			indxs = NULL;
@@ -1170,13 +1640,16 @@ fsc_cache_cob_write (
 #ifdef COBS_SORT
 		index = indxs[cnt];
 #endif
-		res = pthread_mutex_lock (&fsc_cs_mutex);
-		if ( res ){
+		if (!cs_lock_f) {
+			res = pthread_mutex_lock (&fsc_cs_mutex);
+			if ( res ){
 #ifdef CefC_Debug
-			csmgrd_dbg_write (CefC_Dbg_Fine, "%s(%d): res=%d, chunk_num=%u, pthread_mutex_lock error:%s\n",
-				__FUNCTION__, __LINE__, res, cobs[index].chunk_num, strerror (errno));
+				csmgrd_dbg_write (CefC_Dbg_Fine, "%s(%d): res=%d, chunk_num=%u, pthread_mutex_lock error:%s\n",
+					__FUNCTION__, __LINE__, res, cobs[index].chunk_num, strerror (errno));
 #endif // CefC_Debug
-			break;
+				break;
+			}
+			cs_lock_f = 1;
 		}
 
 		if (!fsc_thread_f) {
@@ -1235,6 +1708,7 @@ fsc_cache_cob_write (
 						char file_path[PATH_MAX];
 						/* Delete old files */
 						sprintf (file_path, "%s/%d", hdl->fsc_cache_path, (int) rcd->index);
+						fsc_page_map_purge (rcd->index);
 						fsc_recursive_dir_clear (file_path);
 
 						/* Old Stat */
@@ -1297,16 +1771,12 @@ fsc_cache_cob_write (
 
 		/* Control record size */
 		if (rcd->file_msglen == 0) {
-			rcd->file_msglen
-					= ((cobs[index].msg_len + FSC_RECORD_CORRECT_SIZE) < CefC_Max_Msg_Size ?
-						(cobs[index].msg_len + FSC_RECORD_CORRECT_SIZE) : CefC_Max_Msg_Size);
+			rcd->file_msglen = fsc_record_msglen (cobs[index].msg_len);
 			rcd->detect_chunkno = chunk_num;
 		} else {
 			if (rcd->cob_num == 1) {
 				if (rcd->detect_chunkno > chunk_num) {
-					int new_file_msglen
-								= ((cobs[index].msg_len + FSC_RECORD_CORRECT_SIZE) < CefC_Max_Msg_Size ?
-									(cobs[index].msg_len + FSC_RECORD_CORRECT_SIZE) : CefC_Max_Msg_Size);
+					int new_file_msglen = fsc_record_msglen (cobs[index].msg_len);
 					if (rcd->file_msglen < new_file_msglen) {
 						rcd->file_msglen = new_file_msglen;
 						memcpy (del_name, cobs[index].name, cobs[index].name_len);
@@ -1333,6 +1803,32 @@ fsc_cache_cob_write (
 		/* Update the page to write the received cob 		*/
 		work_page_index = chunk_num / FscC_Page_Cob_Num / FscC_File_Page_Num;
 		cob_block_index = (chunk_num / FscC_Page_Cob_Num) % FscC_File_Page_Num;
+		if (work_page_index != prev_page_index && fsc_io_ring) {
+			/* The writes to the previous page file complete before it is closed 	*/
+			if (wfd >= 0) {
+				fsc_io_write_drain ();
+				close (wfd);
+				wfd = -1;
+			}
+			prev_page_index = work_page_index;
+			sprintf (file_path,
+				"%s/%d/%d", hdl->fsc_cache_path, work_con_index, work_page_index);
+#ifdef O_DIRECT
+			if (fsc_io_direct_f) {
+				wfd = open (file_path, O_RDWR | O_CREAT | O_DIRECT, 0666);
+			}
+#endif // O_DIRECT
+			if (wfd < 0) {
+				/* The filesystem may not support O_DIRECT (e.g. tmpfs) 	*/
+				wfd = open (file_path, O_RDWR | O_CREAT, 0666);
+			}
+			if (wfd < 0) {
+				csmgrd_log_write (CefC_Log_Error,
+					"Failed to open the cache file (%s)\n", file_path);
+				prev_page_index = -1;
+				goto NEXTCOB;
+			}
+		}
 		if (work_page_index != prev_page_index) {
 			if (fp != NULL) {
 #ifdef CefC_Debug
@@ -1448,6 +1944,19 @@ fsc_cache_cob_write (
 		int write_index = chunk_num % FscC_Page_Cob_Num;
 		int64_t seek_pos = (int64_t)cob_block_index * FscC_Page_Cob_Num + write_index;
 		seek_pos *= rcdsize;
+		if (fsc_io_ring) {
+			/* The write completes before fsc_cs_mutex is released 	*/
+			if (fsc_io_write_queue (
+					wfd, seek_pos, cobs[index].msg, cobs[index].msg_len, rcdsize) < 0) {
+				csmgrd_log_write (CefC_Log_Error,
+					"Failed to queue the write of the cache file (%s)\n", file_path);
+			}
+			rcd->fsc_write_time = nowt;
+			if (!(hdl->algo_apis.insert)) {
+				hdl->cache_cobs++;
+			}
+			goto NEXTCOB;
+		}
 		if ( (fseek (fp, seek_pos, SEEK_SET) != 0) && (ftell (fp) != seek_pos) ){
 #ifdef CefC_Debug
 			csmgrd_dbg_write (CefC_Dbg_Fine, "%s(%d): index=%d, chunk_num=%u, fseek error:%s\n",
@@ -1489,6 +1998,27 @@ NEXTCOB:
 #else
 		index++;
 #endif
+		if (fsc_io_ring) {
+			/* Keeps fsc_cs_mutex to queue the writes up to the depth, so that 	*/
+			/* the lookups never read the records which are being written 		*/
+#ifdef COBS_SORT
+			if (fsc_io_wr_num > 0 && fsc_io_wr_num < fsc_io_depth
+				&& cnt < cob_num && fsc_thread_f) {
+#else
+			if (fsc_io_wr_num > 0 && fsc_io_wr_num < fsc_io_depth
+				&& index < cob_num && fsc_thread_f) {
+#endif
+				continue;
+			}
+			fsc_io_write_drain ();
+		}
+		pthread_mutex_unlock (&fsc_cs_mutex);
+		cs_lock_f = 0;
+	}
+	if (cs_lock_f) {
+		if (fsc_io_ring) {
+			fsc_io_write_drain ();
+		}
 		pthread_mutex_unlock (&fsc_cs_mutex);
 	}
 
@@ -1496,6 +2026,9 @@ NEXTCOB:
 		fflush (fp);
 		fclose (fp);
 	}
+	if (wfd >= 0) {
+		close (wfd);
+	}
 #ifdef COBS_SORT
 	free (indxs);
 #endif
@@ -1572,6 +2105,10 @@ fsc_config_read (
 	strcpy (params->algo_name, "None");
 	params->algo_name_size = 256;
 	params->algo_cob_size = 2048;
+	params->io_depth = 0;
+	params->io_direct = 0;
+	params->index_persist = 0;
+	params->ckpt_interval = 0;
 
 	/* Obtains the directory path where the csmgrd's config file is located. */
 #if 0 //+++++ GCC v9 +++++
@@ -1656,6 +2193,14 @@ fsc_config_read (
 				return (-1);
 			}
 			params->algo_cob_size = res;
+		} else if (strcmp (option, "CACHE_ALGO_CHUNK_AWARE") == 0) {
+			res = atoi (value);
+			if ((res != 0) && (res != 1)) {
+				csmgrd_log_write (CefC_Log_Error, "CACHE_ALGO_CHUNK_AWARE must be 0 or 1.\n");
+				fclose (fp);
+				return (-1);
+			}
+			params->algo_chunk_aware = res;
 		} else if (strcmp (option, "CACHE_CAPACITY") == 0) {
 			char *endptr = "";
 			params->cache_capacity = strtoul (value, &endptr, 0);
@@ -1680,6 +2225,40 @@ fsc_config_read (
 				return (-1);
 			}
 			params->extend_lifetime = res * 1000llu;
+		} else if (strcmp (option, "CACHE_IO_DEPTH") == 0) {
+			res = atoi (value);
+			if ((res < 0) || (res > FscC_Io_Depth_Max)) {
+				csmgrd_log_write (CefC_Log_Error,
+					"CACHE_IO_DEPTH must be between 0 and %d inclusive.\n", FscC_Io_Depth_Max);
+				fclose (fp);
+				return (-1);
+			}
+			params->io_depth = res;
+		} else if (strcmp (option, "CACHE_IO_DIRECT") == 0) {
+			res = atoi (value);
+			if ((res != 0) && (res != 1)) {
+				csmgrd_log_write (CefC_Log_Error, "CACHE_IO_DIRECT must be 0 or 1.\n");
+				fclose (fp);
+				return (-1);
+			}
+			params->io_direct = res;
+		} else if (strcmp (option, "CACHE_INDEX_PERSIST") == 0) {
+			res = atoi (value);
+			if ((res != 0) && (res != 1)) {
+				csmgrd_log_write (CefC_Log_Error, "CACHE_INDEX_PERSIST must be 0 or 1.\n");
+				fclose (fp);
+				return (-1);
+			}
+			params->index_persist = res;
+		} else if (strcmp (option, "CACHE_CHECKPOINT_INTERVAL") == 0) {
+			res = atoi (value);
+			if ((res < 0) || (res > 86400)) {
+				csmgrd_log_write (CefC_Log_Error,
+					"CACHE_CHECKPOINT_INTERVAL must be between 0 and 86400 inclusive.\n");
+				fclose (fp);
+				return (-1);
+			}
+			params->ckpt_interval = (uint32_t) res;
 		} else {
 			/* NOP */;
 		}
@@ -1704,20 +2283,11 @@ fsc_config_read (
 						params->algo_cob_size);
 #endif // CefC_Debug
 	if (strcmp (params->algo_name, "None") != 0) {
-		if (strcmp (params->algo_name, "libcsmgrd_lfu") == 0) {
-			if (params->cache_capacity > 819200) {
-				csmgrd_log_write (CefC_Log_Error,
-				"Cache capacity value must be less than or equal to 819200 when using algorithms lfu.\n");
-				fclose (fp);
-				return (-1);
-			}
-		} else {
-			if (params->cache_capacity > 2147483647) {
-				csmgrd_log_write (CefC_Log_Error,
-				"Cache capacity value must be less than or equal to 2147483647 when using algorithms lfu, fifo, etc..\n");
-				fclose (fp);
+		if (params->cache_capacity > 2147483647) {
+			csmgrd_log_write (CefC_Log_Error,
+			"Cache capacity value must be less than or equal to 2147483647 when using algorithms lfu, fifo, etc..\n");
+			fclose (fp);
 			return (-1);
-    }
 		}
 	}
 	fclose (fp);
@@ -1804,7 +2374,8 @@ fsc_root_dir_check (
 ----------------------------------------------------------------------------------------*/
 static uint32_t						/* The return value is FSCID						*/
 fsc_cache_id_create (
-	FscT_Cache_Handle* hdl
+	FscT_Cache_Handle* hdl,
+	uint32_t prev_id							/* ID which must not be used			*/
 ) {
 	DIR* cache_dir;
 	int cache_id;
@@ -1813,7 +2384,10 @@ fsc_cache_id_create (
 
 	srand ((unsigned int) time (NULL));
 
-	cache_id = rand () % FscC_Max_Node_Inf_Num;
+	/* The directory of the checkpoint is kept until the contents are moved 	*/
+	do {
+		cache_id = rand () % FscC_Max_Node_Inf_Num;
+	} while ((uint32_t) cache_id == prev_id);
 //	sprintf (cache_path, "%s/%d", hdl->fsc_root_path, cache_id);
 	int rc = snprintf (cache_path, sizeof (cache_path),"%s/csmgr_fsc_%d", hdl->fsc_root_path, cache_id);
 	if ( rc < 0 ) {
@@ -1944,3 +2518,767 @@ fsc_recursive_dir_clear (
 
 	return (0);
 }
+
+/****************************************************************************************
+ Checkpoint of the cache index
+ ****************************************************************************************/
+/*--------------------------------------------------------------------------------------
+	Calculates FNV-1a of the checkpoint
+----------------------------------------------------------------------------------------*/
+static uint32_t
+fsc_ckpt_checksum (
+	const unsigned char* data,
+	size_t len
+) {
+	uint32_t hash = 2166136261u;
+	size_t i;
+
+	for (i = 0 ; i < len ; i++) {
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	return (hash);
+}
+/*--------------------------------------------------------------------------------------
+	Appends the data to the snapshot (zeros if data is NULL)
+----------------------------------------------------------------------------------------*/
+static void
+fsc_ckpt_buff_add (
+	FscT_Ckpt_Buff* buff,
+	const void* data,
+	size_t len
+) {
+	unsigned char* ptr;
+	size_t size;
+
+	if (buff->err || (len == 0)) {
+		return;
+	}
+	if (buff->len + len > buff->size) {
+		size = buff->size ? buff->size : 65536;
+		while (size < buff->len + len) {
+			size *= 2;
+		}
+		ptr = (unsigned char*) realloc (buff->data, size);
+		if (ptr == NULL) {
+			buff->err = 1;
+			return;
+		}
+		buff->data = ptr;
+		buff->size = size;
+	}
+	if (data) {
+		memcpy (&buff->data[buff->len], data, len);
+	} else {
+		memset (&buff->data[buff->len], 0, len);
+	}
+	buff->len += len;
+}
+/*--------------------------------------------------------------------------------------
+	Serializes the information of a content (called by csmgrd_stat_content_info_walk)
+----------------------------------------------------------------------------------------*/
+static void
+fsc_ckpt_rcd_add (
+	CsmgrT_Stat* rcd,
+	void* arg
+) {
+	FscT_Ckpt_Buff* buff = (FscT_Ckpt_Buff*) arg;
+	FscT_Ckpt_Rcd crcd;
+	uint32_t map_num;
+	size_t len;
+
+	if (rcd->expire_f || (rcd->cob_num == 0) || (rcd->file_msglen == 0)) {
+		return;
+	}
+	map_num = rcd->map_max;
+	while ((map_num > 0) && (rcd->cob_map[map_num - 1] == 0)) {
+		map_num--;
+	}
+
+	memset (&crcd, 0, sizeof (FscT_Ckpt_Rcd));
+	crcd.index 			= rcd->index;
+	crcd.name_len 		= rcd->name_len;
+	crcd.ver_len 		= rcd->ver_len;
+	crcd.map_num 		= map_num;
+	crcd.file_msglen 	= rcd->file_msglen;
+	crcd.detect_chunkno = rcd->detect_chunkno;
+	crcd.cob_size 		= rcd->cob_size;
+	crcd.last_cob_size 	= rcd->last_cob_size;
+	crcd.last_chunk_num = rcd->last_chunk_num;
+	crcd.cob_num 		= rcd->cob_num;
+	crcd.con_size 		= rcd->con_size;
+	crcd.access 		= rcd->access;
+	crcd.expiry 		= rcd->expiry;
+	crcd.cached_time 	= rcd->cached_time;
+
+	/* The bitmap is aligned to 8 bytes in the checkpoint 		*/
+	len = rcd->name_len + rcd->ver_len;
+	fsc_ckpt_buff_add (buff, &crcd, sizeof (FscT_Ckpt_Rcd));
+	fsc_ckpt_buff_add (buff, rcd->name, rcd->name_len);
+	fsc_ckpt_buff_add (buff, rcd->version, rcd->ver_len);
+	fsc_ckpt_buff_add (buff, NULL, FscC_Ckpt_Align (len) - len);
+	fsc_ckpt_buff_add (buff, rcd->cob_map, sizeof (uint64_t) * map_num);
+	buff->rcd_num++;
+
+	/* The page files written after the last checkpoint may still be only 	*/
+	/* in the page cache, so they are flushed before this one is saved 		*/
+	if (buff->err || (rcd->fsc_write_time < fsc_ckpt_sync_time)) {
+		return;
+	}
+	if (buff->sync_num == buff->sync_size) {
+		FscT_Ckpt_Sync* ptr;
+		uint32_t size = buff->sync_size ? buff->sync_size * 2 : 256;
+
+		ptr = (FscT_Ckpt_Sync*) realloc (buff->sync, sizeof (FscT_Ckpt_Sync) * size);
+		if (ptr == NULL) {
+			buff->err = 1;
+			return;
+		}
+		buff->sync = ptr;
+		buff->sync_size = size;
+	}
+	buff->sync[buff->sync_num].index 	= rcd->index;
+	buff->sync[buff->sync_num].page_num =
+		(uint32_t)(((uint64_t) map_num * 64 + FscC_Page_Cob_Num * FscC_File_Page_Num - 1)
+					/ (FscC_Page_Cob_Num * FscC_File_Page_Num));
+	buff->sync_num++;
+}
+/*--------------------------------------------------------------------------------------
+	Serializes an entry of the cache algorithm (called by the walk API)
+----------------------------------------------------------------------------------------*/
+static void
+fsc_ckpt_order_add (
+	unsigned char* key,
+	int key_len,
+	int freq,
+	void* arg
+) {
+	FscT_Ckpt_Buff* buff = (FscT_Ckpt_Buff*) arg;
+	FscT_Ckpt_Order cord;
+
+	cord.key_len 	= (uint16_t) key_len;
+	cord.freq 		= (uint16_t) freq;
+	fsc_ckpt_buff_add (buff, &cord, sizeof (FscT_Ckpt_Order));
+	fsc_ckpt_buff_add (buff, key, key_len);
+	buff->order_num++;
+}
+/*--------------------------------------------------------------------------------------
+	Takes the snapshot of the cache index (fsc_cs_mutex must be held)
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_ckpt_snapshot (
+	FscT_Ckpt_Buff* buff,						/* buffer to serialize into				*/
+	uint64_t nowt								/* current time							*/
+) {
+	FscT_Ckpt_Head head;
+	size_t len;
+
+	memset (buff, 0, sizeof (FscT_Ckpt_Buff));
+	fsc_ckpt_buff_add (buff, NULL, sizeof (FscT_Ckpt_Head));
+
+	/* The contents, and then the entries from the one which is evicted first 	*/
+	csmgrd_stat_content_info_walk (csmgr_stat_hdl, fsc_ckpt_rcd_add, buff);
+	if (hdl->algo_apis.walk) {
+		(*(hdl->algo_apis.walk))(fsc_ckpt_order_add, buff);
+	}
+	if (buff->err) {
+		free (buff->data);
+		free (buff->sync);
+		memset (buff, 0, sizeof (FscT_Ckpt_Buff));
+		return (-1);
+	}
+
+	memset (&head, 0, sizeof (FscT_Ckpt_Head));
+	head.magic 			= FscC_Ckpt_Magic;
+	head.version 		= FscC_Ckpt_Version;
+	head.fsc_id 		= hdl->fsc_id;
+	head.page_cob_num 	= FscC_Page_Cob_Num;
+	head.file_page_num 	= FscC_File_Page_Num;
+	head.rcd_num 		= buff->rcd_num;
+	head.order_num 		= buff->order_num;
+	head.snap_time 		= nowt;
+	head.body_len 		= buff->len - sizeof (FscT_Ckpt_Head);
+	if (hdl->algo_lib) {
+		len = strlen (hdl->algo_name);
+		if (len > sizeof (head.algo_name) - 1) {
+			len = sizeof (head.algo_name) - 1;
+		}
+		memcpy (head.algo_name, hdl->algo_name, len);
+	}
+	memcpy (buff->data, &head, sizeof (FscT_Ckpt_Head));
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Writes the snapshot to the checkpoint file
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_ckpt_write (
+	FscT_Ckpt_Buff* buff						/* snapshot								*/
+) {
+	char file_path[PATH_MAX];
+	char tmp_path[PATH_MAX + 8];
+	FscT_Ckpt_Head head;
+	size_t off = 0;
+	ssize_t len;
+	int fd, err = 0;
+
+	/* The checksum is calculated here so as not to hold fsc_cs_mutex long 	*/
+	memcpy (&head, buff->data, sizeof (FscT_Ckpt_Head));
+	head.checksum = fsc_ckpt_checksum (&buff->data[sizeof (FscT_Ckpt_Head)], head.body_len);
+	memcpy (buff->data, &head, sizeof (FscT_Ckpt_Head));
+
+	/* The checkpoint must not refer to the records which are not on the disk 	*/
+	if (fsc_ckpt_page_sync (buff) < 0) {
+		free (buff->data);
+		buff->data = NULL;
+		return (-1);
+	}
+
+	snprintf (file_path, sizeof (file_path), "%s/%s", hdl->fsc_root_path, FscC_Ckpt_File);
+	snprintf (tmp_path, sizeof (tmp_path), "%s.tmp", file_path);
+	fd = open (tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		err = 1;
+	}
+	while (!err && (off < buff->len)) {
+		len = write (fd, &buff->data[off], buff->len - off);
+		if (len < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			err = 1;
+			break;
+		}
+		off += (size_t) len;
+	}
+	if (fd >= 0) {
+		if (!err && (fsync (fd) != 0)) {
+			err = 1;
+		}
+		close (fd);
+		/* Replaces the previous checkpoint only when the new one is complete 	*/
+		if (err || (rename (tmp_path, file_path) != 0)) {
+			unlink (tmp_path);
+			err = 1;
+		}
+	}
+	if (!err) {
+		/* The pages written before this snapshot need not be flushed again 	*/
+		fsc_ckpt_sync_time = head.snap_time;
+		fd = open (hdl->fsc_root_path, O_RDONLY | O_DIRECTORY);
+		if (fd >= 0) {
+			fsync (fd);
+			close (fd);
+		}
+	}
+	free (buff->data);
+	buff->data = NULL;
+
+	return (err ? -1 : 0);
+}
+/*--------------------------------------------------------------------------------------
+	Flushes the page files of the contents in the snapshot to the disk
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_ckpt_page_sync (
+	FscT_Ckpt_Buff* buff						/* snapshot								*/
+) {
+	char file_path[PATH_MAX];
+	uint32_t i, n;
+	int fd, err = 0;
+
+	for (i = 0 ; (i < buff->sync_num) && !err ; i++) {
+		for (n = 0 ; n < buff->sync[i].page_num ; n++) {
+			snprintf (file_path, sizeof (file_path), "%s/%u/%u",
+				hdl->fsc_cache_path, buff->sync[i].index, n);
+			fd = open (file_path, O_RDONLY);
+			if (fd < 0) {
+				/* The page has no record, or the content has been removed 	*/
+				/* since the snapshot 										*/
+				continue;
+			}
+			if (fdatasync (fd) != 0) {
+				csmgrd_log_write (CefC_Log_Error,
+					"Failed to flush the cache file (%s) - %s\n", file_path, strerror (errno));
+				err = 1;
+			}
+			close (fd);
+			if (err) {
+				break;
+			}
+		}
+
+		/* The entries of the page files created in the directory 	*/
+		snprintf (file_path, sizeof (file_path), "%s/%u", hdl->fsc_cache_path, buff->sync[i].index);
+		fd = open (file_path, O_RDONLY | O_DIRECTORY);
+		if (fd >= 0) {
+			fsync (fd);
+			close (fd);
+		}
+	}
+	free (buff->sync);
+	buff->sync = NULL;
+	buff->sync_num = 0;
+	buff->sync_size = 0;
+
+	return (err ? -1 : 0);
+}
+/*--------------------------------------------------------------------------------------
+	Maps the checkpoint saved by the previous csmgrd
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_ckpt_open (
+	uint32_t* prev_id							/* ID of the previous cache directory	*/
+) {
+	char file_path[PATH_MAX];
+	FscT_Ckpt_Head head;
+	struct stat st;
+	unsigned char* map;
+	int fd;
+
+	snprintf (file_path, sizeof (file_path), "%s/%s", hdl->fsc_root_path, FscC_Ckpt_File);
+	fd = open (file_path, O_RDONLY);
+	if (fd < 0) {
+		return (-1);
+	}
+	if ((fstat (fd, &st) != 0) || (st.st_size < (off_t) sizeof (FscT_Ckpt_Head))) {
+		close (fd);
+		csmgrd_log_write (CefC_Log_Warn, "Checkpoint (%s) is broken, ignored\n", file_path);
+		unlink (file_path);
+		return (-1);
+	}
+	map = (unsigned char*) mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (map == MAP_FAILED) {
+		csmgrd_log_write (CefC_Log_Warn,
+			"Failed to map the checkpoint (%s) - %s\n", file_path, strerror (errno));
+		return (-1);
+	}
+
+	memcpy (&head, map, sizeof (FscT_Ckpt_Head));
+	if ((head.magic != FscC_Ckpt_Magic) || (head.version != FscC_Ckpt_Version) ||
+		(head.page_cob_num != FscC_Page_Cob_Num) ||
+		(head.file_page_num != FscC_File_Page_Num) ||
+		(head.fsc_id >= FscC_Max_Node_Inf_Num) ||
+		(head.body_len != (uint64_t) st.st_size - sizeof (FscT_Ckpt_Head)) ||
+		(head.checksum != fsc_ckpt_checksum (
+							&map[sizeof (FscT_Ckpt_Head)], (size_t) head.body_len))) {
+		munmap (map, (size_t) st.st_size);
+		csmgrd_log_write (CefC_Log_Warn, "Checkpoint (%s) is broken, ignored\n", file_path);
+		unlink (file_path);
+		return (-1);
+	}
+	snprintf (fsc_ckpt_prev_path, sizeof (fsc_ckpt_prev_path),
+		"%s/csmgr_fsc_%u", hdl->fsc_root_path, head.fsc_id);
+	if (fsc_root_dir_check (fsc_ckpt_prev_path) < 0) {
+		munmap (map, (size_t) st.st_size);
+		csmgrd_log_write (CefC_Log_Warn,
+			"Cache directory (%s) of the checkpoint is not found\n", fsc_ckpt_prev_path);
+		unlink (file_path);
+		return (-1);
+	}
+
+	fsc_ckpt_map 		= map;
+	fsc_ckpt_map_len 	= (size_t) st.st_size;
+	*prev_id 			= head.fsc_id;
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Checks that the page file covers the record of the specified chunk
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+fsc_ckpt_page_check (
+	uint32_t index,								/* index of the content					*/
+	uint32_t chunk_num,							/* last chunk in the page file			*/
+	int rcdsize									/* size of a record						*/
+) {
+	char file_path[PATH_MAX];
+	struct stat st;
+	int64_t rcd_end;
+
+	snprintf (file_path, sizeof (file_path), "%s/%u/%u", fsc_ckpt_prev_path, index,
+		chunk_num / FscC_Page_Cob_Num / FscC_File_Page_Num);
+	if (stat (file_path, &st) != 0) {
+		return (-1);
+	}
+	rcd_end = (int64_t)((chunk_num / FscC_Page_Cob_Num) % FscC_File_Page_Num) * FscC_Page_Cob_Num;
+	rcd_end = (rcd_end + chunk_num % FscC_Page_Cob_Num + 1) * rcdsize;
+
+	return ((st.st_size >= rcd_end) ? 0 : -1);
+}
+/*--------------------------------------------------------------------------------------
+	Validates a content in the checkpoint with its page files
+----------------------------------------------------------------------------------------*/
+static int							/* 1 if the content is valid						*/
+fsc_ckpt_rcd_validate (
+	const unsigned char* p,						/* content in the checkpoint			*/
+	unsigned char* rbuff						/* buffer to read a record				*/
+) {
+	FscT_Ckpt_Rcd crcd;
+	const unsigned char* name;
+	const uint64_t* map;
+	char file_path[PATH_MAX];
+	struct tlv_hdr tlv;
+	struct fixed_hdr fixed;
+	uint64_t word;
+	uint64_t cob_num = 0;
+	uint32_t i, chunk_num, last_chunk = 0;
+	uint32_t first_chunk = UINT32_MAX;
+	uint32_t page, cur_page = UINT32_MAX;
+	int64_t offset;
+	int rcdsize, rlen, fd;
+	uint16_t mlen;
+
+	memcpy (&crcd, p, sizeof (FscT_Ckpt_Rcd));
+	name = p + sizeof (FscT_Ckpt_Rcd);
+	map  = (const uint64_t*)(name + FscC_Ckpt_Align (crcd.name_len + crcd.ver_len));
+	if ((crcd.cob_num == 0) || (crcd.file_msglen == 0) || (crcd.name_len == 0)) {
+		return (0);
+	}
+	rcdsize = (int)(sizeof (uint16_t) + crcd.file_msglen);
+
+	/* Each page file must cover the last record which the bitmap refers to 	*/
+	for (i = 0 ; i < crcd.map_num ; i++) {
+		word = map[i];
+		while (word) {
+			chunk_num = i * 64 + (uint32_t) __builtin_ctzll (word);
+			word &= word - 1;
+			cob_num++;
+			if (first_chunk == UINT32_MAX) {
+				first_chunk = chunk_num;
+			}
+			page = chunk_num / FscC_Page_Cob_Num / FscC_File_Page_Num;
+			if (page != cur_page) {
+				if ((cur_page != UINT32_MAX) &&
+					(fsc_ckpt_page_check (crcd.index, last_chunk, rcdsize) < 0)) {
+					return (0);
+				}
+				cur_page = page;
+			}
+			last_chunk = chunk_num;
+		}
+	}
+	if ((cob_num != crcd.cob_num) ||
+		(fsc_ckpt_page_check (crcd.index, last_chunk, rcdsize) < 0)) {
+		return (0);
+	}
+
+	/* The name in the first record tells whether the directory was reused 	*/
+	/* by another content after the checkpoint 								*/
+	snprintf (file_path, sizeof (file_path), "%s/%u/%u", fsc_ckpt_prev_path, crcd.index,
+		first_chunk / FscC_Page_Cob_Num / FscC_File_Page_Num);
+	offset = (int64_t)((first_chunk / FscC_Page_Cob_Num) % FscC_File_Page_Num) * FscC_Page_Cob_Num;
+	offset = (offset + first_chunk % FscC_Page_Cob_Num) * rcdsize;
+	rlen = (int)(sizeof (uint16_t) + CefC_Max_Header_Size
+				+ sizeof (struct tlv_hdr) * 2 + crcd.name_len);
+	if (rlen > rcdsize) {
+		rlen = rcdsize;
+	}
+	fd = open (file_path, O_RDONLY);
+	if (fd < 0) {
+		return (0);
+	}
+	if (pread (fd, rbuff, rlen, (off_t) offset) != rlen) {
+		close (fd);
+		return (0);
+	}
+	close (fd);
+
+	memcpy (&mlen, rbuff, sizeof (uint16_t));
+	if ((mlen < sizeof (struct fixed_hdr)) || (mlen > crcd.file_msglen)) {
+		return (0);
+	}
+	memcpy (&fixed, &rbuff[sizeof (uint16_t)], sizeof (struct fixed_hdr));
+	if ((fixed.hdr_len + sizeof (struct tlv_hdr) * 2 + crcd.name_len > mlen) ||
+		(sizeof (uint16_t) + fixed.hdr_len + sizeof (struct tlv_hdr) * 2 + crcd.name_len
+			> (size_t) rlen)) {
+		return (0);
+	}
+	memcpy (&tlv, &rbuff[sizeof (uint16_t) + fixed.hdr_len], sizeof (struct tlv_hdr));
+	if (ntohs (tlv.type) != CefC_T_OBJECT) {
+		return (0);
+	}
+	memcpy (&tlv, &rbuff[sizeof (uint16_t) + fixed.hdr_len + sizeof (struct tlv_hdr)],
+		sizeof (struct tlv_hdr));
+	if ((ntohs (tlv.type) != CefC_T_NAME) || (ntohs (tlv.length) < crcd.name_len)) {
+		return (0);
+	}
+	if (memcmp (&rbuff[sizeof (uint16_t) + fixed.hdr_len + sizeof (struct tlv_hdr) * 2],
+			name, crcd.name_len) != 0) {
+		return (0);
+	}
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Thread to validate every worker_num-th content in the checkpoint
+----------------------------------------------------------------------------------------*/
+static void*
+fsc_ckpt_validate_thread (
+	void* arg
+) {
+	FscT_Ckpt_Worker* wkr = (FscT_Ckpt_Worker*) arg;
+	unsigned char* rbuff;
+	uint32_t i;
+
+	rbuff = (unsigned char*) malloc (sizeof (uint16_t) + CefC_Max_Header_Size
+							+ sizeof (struct tlv_hdr) * 2 + CsmgrT_Name_Max);
+	if (rbuff == NULL) {
+		return (NULL);
+	}
+	for (i = (uint32_t) wkr->worker_id ; i < wkr->rcd_num ; i += (uint32_t) wkr->worker_num) {
+		wkr->valid[i] = (unsigned char) fsc_ckpt_rcd_validate (&fsc_ckpt_map[wkr->offs[i]], rbuff);
+	}
+	free (rbuff);
+
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Inserts a restored Cob into the cache algorithm
+----------------------------------------------------------------------------------------*/
+static void
+fsc_ckpt_entry_insert (
+	unsigned char* key,							/* name with the chunk number			*/
+	int key_len,								/* length of the key					*/
+	int freq									/* frequency of the entry				*/
+) {
+	CsmgrdT_Content_Entry entry;
+	struct value32_tlv tlv32;
+	CsmgrT_Stat* rcd;
+	uint32_t chunk_num;
+	int i;
+
+	if (key_len <= (int) sizeof (struct value32_tlv)) {
+		return;
+	}
+	/* The key is created by csmgrd_name_chunknum_concatenate 	*/
+	memcpy (&tlv32, &key[key_len - sizeof (struct value32_tlv)], sizeof (struct value32_tlv));
+	chunk_num = ntohl (tlv32.value);
+
+	/* Only the Cobs which were restored are inserted 		*/
+	rcd = csmgrd_stat_content_info_get (
+			csmgr_stat_hdl, key, key_len - sizeof (struct value32_tlv));
+	if (!rcd || (rcd->map_max <= chunk_num / 64) ||
+		!(rcd->cob_map[chunk_num / 64] & (1llu << (chunk_num % 64)))) {
+		return;
+	}
+	memset (&entry, 0, sizeof (CsmgrdT_Content_Entry));
+	entry.name 		= key;
+	entry.name_len 	= key_len - sizeof (struct value32_tlv);
+	entry.chunk_num = chunk_num;
+	(*(hdl->algo_apis.insert))(&entry);
+
+	if (hdl->algo_apis.hit) {
+		for (i = 0 ; i < freq ; i++) {
+			(*(hdl->algo_apis.hit))(key, key_len);
+		}
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Restores the cache index from the mapped checkpoint
+----------------------------------------------------------------------------------------*/
+static int							/* Number of the restored contents					*/
+fsc_ckpt_load (
+	void
+) {
+	FscT_Ckpt_Head head;
+	FscT_Ckpt_Rcd crcd;
+	FscT_Ckpt_Order cord;
+	FscT_Ckpt_Worker workers[FscC_Ckpt_Worker_Max];
+	int th_f[FscC_Ckpt_Worker_Max] = {0};
+	CsmgrT_DB_COB_MAP* cob_map = NULL;
+	CsmgrT_Stat* rcd;
+	char file_path[PATH_MAX];
+	char src_path[PATH_MAX];
+	char dst_path[PATH_MAX];
+	unsigned char key[CsmgrdC_Key_Max];
+	size_t* offs = NULL;
+	unsigned char* valid = NULL;
+	const unsigned char* p;
+	unsigned char* name;
+	const uint64_t* map;
+	size_t off, len;
+	uint64_t nowt, n, word;
+	struct timeval tv;
+	uint32_t i, k, chunk_num;
+	int worker_num, w, key_len;
+	int restored = 0;
+
+	memcpy (&head, fsc_ckpt_map, sizeof (FscT_Ckpt_Head));
+	offs  = (size_t*) malloc (sizeof (size_t) * (head.rcd_num + 1));
+	valid = (unsigned char*) calloc (head.rcd_num + 1, sizeof (unsigned char));
+	if ((offs == NULL) || (valid == NULL)) {
+		csmgrd_log_write (CefC_Log_Warn, "Failed to allocate memory to load the checkpoint\n");
+		goto LOAD_END;
+	}
+
+	/* Locates the contents 		*/
+	off = sizeof (FscT_Ckpt_Head);
+	for (i = 0 ; i < head.rcd_num ; i++) {
+		if (off + sizeof (FscT_Ckpt_Rcd) > fsc_ckpt_map_len) {
+			break;
+		}
+		memcpy (&crcd, &fsc_ckpt_map[off], sizeof (FscT_Ckpt_Rcd));
+		len = sizeof (FscT_Ckpt_Rcd) + FscC_Ckpt_Align (crcd.name_len + crcd.ver_len)
+				+ sizeof (uint64_t) * crcd.map_num;
+		if (off + len > fsc_ckpt_map_len) {
+			break;
+		}
+		offs[i] = off;
+		off += len;
+	}
+	if (i < head.rcd_num) {
+		csmgrd_log_write (CefC_Log_Warn, "Checkpoint is broken, ignored\n");
+		goto LOAD_END;
+	}
+
+	/* Validates the contents with the page files in parallel 		*/
+	worker_num = (int) sysconf (_SC_NPROCESSORS_ONLN);
+	if (worker_num > FscC_Ckpt_Worker_Max) {
+		worker_num = FscC_Ckpt_Worker_Max;
+	}
+	if ((uint32_t) worker_num > head.rcd_num) {
+		worker_num = (int) head.rcd_num;
+	}
+	if (worker_num < 1) {
+		worker_num = 1;
+	}
+	for (w = 0 ; w < worker_num ; w++) {
+		workers[w].worker_id 	= w;
+		workers[w].worker_num 	= worker_num;
+		workers[w].offs 		= offs;
+		workers[w].rcd_num 		= head.rcd_num;
+		workers[w].valid 		= valid;
+		if ((w > 0) && (cef_pthread_create (
+				&workers[w].th, NULL, fsc_ckpt_validate_thread, &workers[w]) != -1)) {
+			th_f[w] = 1;
+		}
+	}
+	for (w = 0 ; w < worker_num ; w++) {
+		if (!th_f[w]) {
+			fsc_ckpt_validate_thread (&workers[w]);
+		}
+	}
+	for (w = 0 ; w < worker_num ; w++) {
+		if (th_f[w]) {
+			pthread_join (workers[w].th, NULL);
+		}
+	}
+
+	/* Restores the content information, and moves the page files into the 	*/
+	/* directory of the new index of each content 								*/
+	gettimeofday (&tv, NULL);
+	nowt = tv.tv_sec * 1000000llu + tv.tv_usec;
+
+	for (i = 0 ; i < head.rcd_num ; i++) {
+		if (!valid[i]) {
+			continue;
+		}
+		valid[i] = 0;
+		p = &fsc_ckpt_map[offs[i]];
+		memcpy (&crcd, p, sizeof (FscT_Ckpt_Rcd));
+		name = (unsigned char*) p + sizeof (FscT_Ckpt_Rcd);
+		map  = (const uint64_t*)(name + FscC_Ckpt_Align (crcd.name_len + crcd.ver_len));
+
+		if (crcd.expiry < nowt) {
+			continue;
+		}
+		if (!(hdl->algo_apis.insert) &&
+			(hdl->cache_cobs + crcd.cob_num > hdl->cache_capacity)) {
+			continue;
+		}
+		if (csmgrd_stat_content_info_get (csmgr_stat_hdl, name, crcd.name_len)) {
+			continue;
+		}
+		rcd = csmgrd_stat_content_info_init (csmgr_stat_hdl, name, crcd.name_len, &cob_map);
+		if (!rcd) {
+			break;
+		}
+		if ((csmgrd_stat_content_info_version_init (
+				csmgr_stat_hdl, rcd, &name[crcd.name_len], crcd.ver_len) < 0) ||
+			(csmgrd_stat_cob_map_restore (
+				csmgr_stat_hdl, rcd, map, crcd.map_num, crcd.cob_num, crcd.con_size) < 0)) {
+			csmgrd_stat_content_info_delete (csmgr_stat_hdl, name, crcd.name_len);
+			continue;
+		}
+		rcd->cob_size 		= crcd.cob_size;
+		rcd->last_cob_size 	= crcd.last_cob_size;
+		rcd->last_chunk_num = crcd.last_chunk_num;
+		rcd->access 		= crcd.access;
+		rcd->expiry 		= crcd.expiry;
+		rcd->cached_time 	= crcd.cached_time;
+		rcd->file_msglen 	= crcd.file_msglen;
+		rcd->detect_chunkno = crcd.detect_chunkno;
+		rcd->fsc_write_time = nowt;
+
+		snprintf (src_path, sizeof (src_path), "%s/%u", fsc_ckpt_prev_path, crcd.index);
+		snprintf (dst_path, sizeof (dst_path), "%s/%u", hdl->fsc_cache_path, rcd->index);
+		if (rename (src_path, dst_path) != 0) {
+			csmgrd_stat_content_info_delete (csmgr_stat_hdl, name, crcd.name_len);
+			continue;
+		}
+		if (!(hdl->algo_apis.insert)) {
+			hdl->cache_cobs += crcd.cob_num;
+		}
+		valid[i] = 1;
+		restored++;
+	}
+	for ( ; i < head.rcd_num ; i++) {
+		valid[i] = 0;
+	}
+
+	/* Rebuilds the order of the cache algorithm. If the checkpoint was saved 	*/
+	/* with another algorithm, the Cobs are inserted in the order of the names 	*/
+	if (hdl->algo_apis.insert && restored) {
+		if ((head.order_num > 0) && hdl->algo_lib &&
+			(strncmp (head.algo_name, hdl->algo_name, sizeof (head.algo_name) - 1) == 0)) {
+			for (n = 0 ; n < head.order_num ; n++) {
+				if (off + sizeof (FscT_Ckpt_Order) > fsc_ckpt_map_len) {
+					break;
+				}
+				memcpy (&cord, &fsc_ckpt_map[off], sizeof (FscT_Ckpt_Order));
+				off += sizeof (FscT_Ckpt_Order);
+				if (off + cord.key_len > fsc_ckpt_map_len) {
+					break;
+				}
+				fsc_ckpt_entry_insert (&fsc_ckpt_map[off], cord.key_len, cord.freq);
+				off += cord.key_len;
+			}
+		} else {
+			for (i = 0 ; i < head.rcd_num ; i++) {
+				if (!valid[i]) {
+					continue;
+				}
+				p = &fsc_ckpt_map[offs[i]];
+				memcpy (&crcd, p, sizeof (FscT_Ckpt_Rcd));
+				name = (unsigned char*) p + sizeof (FscT_Ckpt_Rcd);
+				map  = (const uint64_t*)(name + FscC_Ckpt_Align (crcd.name_len + crcd.ver_len));
+				for (k = 0 ; k < crcd.map_num ; k++) {
+					word = map[k];
+					while (word) {
+						chunk_num = k * 64 + (uint32_t) __builtin_ctzll (word);
+						word &= word - 1;
+						key_len = csmgrd_name_chunknum_concatenate (
+										name, crcd.name_len, chunk_num, key);
+						fsc_ckpt_entry_insert (key, key_len, 0);
+					}
+				}
+			}
+		}
+	}
+
+LOAD_END:
+	free (offs);
+	free (valid);
+	munmap (fsc_ckpt_map, fsc_ckpt_map_len);
+	fsc_ckpt_map = NULL;
+	fsc_ckpt_map_len = 0;
+
+	/* The checkpoint and the page files which were not restored are stale 	*/
+	snprintf (file_path, sizeof (file_path), "%s/%s", hdl->fsc_root_path, FscC_Ckpt_File);
+	unlink (file_path);
+	fsc_recursive_dir_clear (fsc_ckpt_prev_path);
+
+	return (restored);
+}
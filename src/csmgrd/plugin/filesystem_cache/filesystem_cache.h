@@ -72,10 +72,20 @@ typedef struct {
 												/* by algorithm							*/
 	int				algo_cob_size;				/* average Cob size of Cob processed 	*/
                                   				/* by algorithm							*/
+	int				algo_chunk_aware;			/* algorithm treats the chunks of a		*/
+												/* content as one entry					*/
 
 	uint64_t 		cache_capacity;				/* size of cache capacity 				*/
 
 	uint64_t 		extend_lifetime;			/* time to extend lifetime 				*/
+
+	int				io_depth;					/* I/Os in flight with io_uring			*/
+												/* (0: page files are written by stdio)	*/
+	int				io_direct;					/* page files are opened with O_DIRECT	*/
+
+	int				index_persist;				/* keeps the cache over a restart		*/
+	uint32_t		ckpt_interval;				/* interval of the checkpoint (sec)		*/
+												/* (0: only when csmgrd shuts down)		*/
 	
 } FscT_Config_Param;
 
@@ -105,10 +115,17 @@ typedef struct {
 												/* by algorithm							*/
 	int				algo_cob_size;				/* average Cob size of Cob processed 	*/
                                   				/* by algorithm							*/
+	int				algo_chunk_aware;			/* algorithm treats the chunks of a		*/
+												/* content as one entry					*/
 	uint64_t 		cache_cobs;
 	uint64_t		cache_capacity;
 	CefT_Mp_Handle	mem_rm_key;
 
+	/********** checkpoint of the cache index **********/
+	int				index_persist;				/* keeps the cache over a restart		*/
+	uint64_t		ckpt_interval;				/* interval of the checkpoint (usec)	*/
+	uint64_t		ckpt_time;					/* time of the last checkpoint			*/
+
 } FscT_Cache_Handle;
 
 #endif // __CSMGRD_FILESYSTEM_CACHE_HEADER__
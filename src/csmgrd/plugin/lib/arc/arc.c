@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * arc.c
+ */
+
+/*
+	arc.c is an implementation of ARC (Adaptive Replacement Cache). The objects
+	accessed once are kept in T1 and the objects accessed again in T2, and the keys
+	evicted from them are remembered in the ghost lists B1 and B2. The hits in the
+	ghost lists adapt the target size of T1, so a sequential download only cycles
+	through T1 while the objects in T2 survive.
+*/
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <csmgrd/csmgrd_plugin.h>
+#include "cache_replace_lib.h"
+#include "cache_object_lib.h"
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static int cache_cap = 0;					/* Maximum number of entries that can be 	*/
+											/* listed (it is the same value as the 		*/
+											/* maximum value of the cache table) 		*/
+static int lib_mode = 0;					/* CsmgrdC_Lib_Mode_XXX flags				*/
+
+static CrlibT_Queue t1_q;					/* objects accessed once					*/
+static CrlibT_Queue t2_q;					/* objects accessed more than once			*/
+static CrlibT_Ghost b1_g;					/* keys evicted from T1						*/
+static CrlibT_Ghost b2_g;					/* keys evicted from T2						*/
+static int arc_p;							/* target number of chunks in T1			*/
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static void arc_replace(int in_b2);
+static void arc_ghost_trim(void);
+static int arc_object_freq(CrlibT_Object* obj);
+static void arc_chunk_hit(CrlibT_Chunk* chunk);
+static void arc_chunk_erase(CrlibT_Chunk* chunk);
+
+/****************************************************************************************
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Init API
+----------------------------------------------------------------------------------------*/
+int 							/* If the error occurs, this value is a negative value	*/
+init (
+	int capacity, 							/* Maximum number of entries that can be 	*/
+											/* listed (it is the same value as the 		*/
+											/* maximum value of the cache table) 		*/
+	int (*store)(CsmgrdT_Content_Entry*), 	/* store a content entry API 				*/
+	void (*remove)(unsigned char*, int)		/* remove a content entry API 				*/
+) {
+	/* Records the capacity of cache		*/
+	if (capacity < 1) {
+		fprintf (stderr, "[ARC LIB] Invalid Cacacity\n");
+		return (-1);
+	}
+	cache_cap = capacity;
+
+	/* Records store and remove APIs 		*/
+	if ((store == NULL) || (remove == NULL)) {
+		fprintf (stderr, "[ARC LIB] Not specified store or remove API\n");
+		return (-1);
+	}
+
+	memset(&t1_q, 0, sizeof(CrlibT_Queue));
+	memset(&t2_q, 0, sizeof(CrlibT_Queue));
+	arc_p = 0;
+	if (crlib_ghost_init(&b1_g, cache_cap) < 0 ||
+		crlib_ghost_init(&b2_g, cache_cap) < 0 ||
+		crlib_object_init(cache_cap,
+			(lib_mode & CsmgrdC_Lib_Mode_Chunk_Aware) ? 1 : 0, store, remove) < 0) {
+		fprintf (stderr, "[ARC LIB] Failed to create the lookup table\n");
+		crlib_ghost_destroy(&b1_g);
+		crlib_ghost_destroy(&b2_g);
+		return (-1);
+	}
+
+	return (0);
+}
+
+/*--------------------------------------------------------------------------------------
+	Destroy API
+----------------------------------------------------------------------------------------*/
+void
+destroy (
+	void
+) {
+	crlib_queue_clear(&t1_q);
+	crlib_queue_clear(&t2_q);
+	crlib_ghost_destroy(&b1_g);
+	crlib_ghost_destroy(&b2_g);
+	crlib_object_destroy();
+	cache_cap = 0;
+	arc_p = 0;
+}
+
+/*--------------------------------------------------------------------------------------
+	Insert API
+----------------------------------------------------------------------------------------*/
+void
+insert (
+	CsmgrdT_Content_Entry* entry			/* content entry 							*/
+) {
+	unsigned char 	key[CsmgrdC_Key_Max];
+	int 			key_len;
+	int 			obj_key_len;
+	CrlibT_Queue*	place = &t1_q;
+	CrlibT_Object* 	obj;
+	int 			in_b2 = 0;
+	int 			ghost_num;
+	int 			b1_num, b2_num;
+	int 			new_f;
+
+	/* Adapts the target size of T1 when the key of a new object is in a ghost list	*/
+	key_len = crlib_object_entry_key(entry, key);
+	if (crlib_object_lookup(key, key_len) == NULL) {
+		obj_key_len = crlib_object_key_len(key, key_len);
+
+		if ((ghost_num = crlib_ghost_take(&b1_g, key, obj_key_len)) > 0) {
+			b1_num = b1_g.chunk_num + ghost_num;
+			b2_num = b2_g.chunk_num;
+			arc_p += (b2_num > b1_num) ? ghost_num * (b2_num / b1_num) : ghost_num;
+			if (arc_p > cache_cap) {
+				arc_p = cache_cap;
+			}
+			place = &t2_q;
+		} else if ((ghost_num = crlib_ghost_take(&b2_g, key, obj_key_len)) > 0) {
+			b1_num = b1_g.chunk_num;
+			b2_num = b2_g.chunk_num + ghost_num;
+			arc_p -= (b1_num > b2_num) ? ghost_num * (b1_num / b2_num) : ghost_num;
+			if (arc_p < 0) {
+				arc_p = 0;
+			}
+			place = &t2_q;
+			in_b2 = 1;
+		}
+	}
+
+	while (crlib_object_chunk_total() >= cache_cap) {
+		arc_replace(in_b2);
+	}
+	obj = crlib_object_store(entry, &new_f);
+	if (obj == NULL) {
+		fprintf(stderr, "[ARC LIB] failed to insert\n");
+		return;
+	}
+	if (new_f) {
+		crlib_queue_push(place, obj);
+		arc_ghost_trim();
+	}
+}
+
+/*--------------------------------------------------------------------------------------
+	Erase API
+----------------------------------------------------------------------------------------*/
+void
+erase (
+	unsigned char* key, 					/* key of content entry removed from cache 	*/
+											/* table									*/
+	int key_len								/* length of the key 						*/
+) {
+	CrlibT_Chunk* chunk = crlib_object_chunk_lookup(key, key_len);
+
+	if (chunk == NULL) {
+		fprintf(stderr, "[ARC LIB] failed to erace\n");
+		return;
+	}
+	arc_chunk_erase(chunk);
+}
+
+/*--------------------------------------------------------------------------------------
+	Hit API
+----------------------------------------------------------------------------------------*/
+void
+hit (
+	unsigned char* key, 					/* key of the content entry hits in the 	*/
+											/* cache table 								*/
+	int key_len								/* length of the key 						*/
+) {
+	CrlibT_Chunk* chunk = crlib_object_chunk_lookup(key, key_len);
+
+	if (chunk == NULL) {
+		fprintf(stderr, "[ARC LIB] invalid hit\n");
+		return;
+	}
+	arc_chunk_hit(chunk);
+}
+
+/*--------------------------------------------------------------------------------------
+	Miss API
+----------------------------------------------------------------------------------------*/
+void
+miss (
+	unsigned char* key, 					/* key of the content entry fails to hit 	*/
+											/* in the cache table						*/
+	int key_len								/* length of the key 						*/
+) {
+	// NOTHING TO DO
+	return;
+}
+
+/*--------------------------------------------------------------------------------------
+	Status API
+----------------------------------------------------------------------------------------*/
+void
+status (
+	void* arg								/* state information						*/
+) {
+	return;
+}
+
+/*--------------------------------------------------------------------------------------
+	Walk API
+----------------------------------------------------------------------------------------*/
+void
+walk (
+	void (*callback)(unsigned char*, int, int, void*),
+											/* called with the key, the length of the 	*/
+											/* key and the frequency of each entry 		*/
+	void* arg								/* argument of the callback 				*/
+) {
+	/* The hit given with the objects in T2 moves them from T1 to T2 again 	*/
+	crlib_queue_walk(&t1_q, arc_object_freq, callback, arg);
+	crlib_queue_walk(&t2_q, arc_object_freq, callback, arg);
+}
+
+/*--------------------------------------------------------------------------------------
+	Mode API
+----------------------------------------------------------------------------------------*/
+void
+mode_set (
+	int mode								/* CsmgrdC_Lib_Mode_XXX flags 				*/
+) {
+	lib_mode = mode;
+}
+
+/*--------------------------------------------------------------------------------------
+	Handle APIs
+----------------------------------------------------------------------------------------*/
+void
+hit_by_handle (
+	void* handle							/* algo_h of the content entry hits in the 	*/
+											/* cache table 								*/
+) {
+	arc_chunk_hit((CrlibT_Chunk*) handle);
+}
+
+void
+erase_by_handle (
+	void* handle							/* algo_h of content entry removed from 	*/
+											/* cache table 								*/
+) {
+	arc_chunk_erase((CrlibT_Chunk*) handle);
+}
+
+/*--------------------------------------------------------------------------------------
+	Static Functions
+----------------------------------------------------------------------------------------*/
+
+/* Removes a chunk from T1 or T2, and remembers the key of the object in the ghost	*/
+/* list when its last chunk is removed 												*/
+static void arc_replace(int in_b2) {
+	CrlibT_Object* 	victim;
+	CrlibT_Ghost*	ghost;
+
+	if (t1_q.chunk_num > 0 &&
+		(t1_q.chunk_num > arc_p || (in_b2 && t1_q.chunk_num == arc_p) ||
+		 t2_q.chunk_num == 0)) {
+		victim = t1_q.tail;
+		ghost = &b1_g;
+	} else {
+		victim = t2_q.tail;
+		ghost = &b2_g;
+	}
+	crlib_object_chunk_evict(victim);
+	if (victim->chunk_num == 0) {
+		crlib_ghost_add(ghost, victim);
+		crlib_queue_unlink(victim);
+		crlib_object_free(victim);
+		arc_ghost_trim();
+	}
+}
+
+/* Keeps |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c 	*/
+static void arc_ghost_trim(void) {
+	while (t1_q.chunk_num + b1_g.chunk_num > cache_cap && b1_g.entry_num > 0) {
+		crlib_ghost_drop(&b1_g);
+	}
+	while (t1_q.chunk_num + t2_q.chunk_num + b1_g.chunk_num + b2_g.chunk_num
+			> 2 * cache_cap && b2_g.entry_num > 0) {
+		crlib_ghost_drop(&b2_g);
+	}
+}
+
+static int arc_object_freq(CrlibT_Object* obj) {
+	return (obj->queue == &t2_q) ? 1 : 0;
+}
+
+static void arc_chunk_hit(CrlibT_Chunk* chunk) {
+	crlib_queue_push(&t2_q, chunk->obj);
+}
+
+static void arc_chunk_erase(CrlibT_Chunk* chunk) {
+	CrlibT_Object* obj = crlib_object_chunk_forget(chunk);
+
+	if (obj->chunk_num == 0) {
+		crlib_queue_unlink(obj);
+		crlib_object_free(obj);
+	}
+}
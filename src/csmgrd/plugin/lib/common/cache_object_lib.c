@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cache_object_lib.c
+ */
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cache_replace_lib.h"
+#include "cache_object_lib.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+/* Bytes of the chunk number which csmgrd_name_chunknum_concatenate appends to the name */
+#define CrlibC_Chunk_Field_Len		8
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static int 	obj_chunk_aware = 0;			/* chunks of a content form one object		*/
+static int 	obj_chunk_total = 0;			/* number of cached chunks					*/
+static CefT_Hash_Handle obj_table = 0;		/* key of object to CrlibT_Object			*/
+
+/* pointers of functions which stores and removes the content entry into/from the cache */
+/* table (implementation of the functions are in a plugin which uses this library) 		*/
+static int (*obj_store_api)(CsmgrdT_Content_Entry*);
+static void (*obj_remove_api)(unsigned char*, int);
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static CrlibT_Object* crlib_object_create(const unsigned char* key, int key_len);
+static void crlib_object_chunk_unlink(CrlibT_Chunk* chunk);
+
+/****************************************************************************************
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Functions for Objects
+----------------------------------------------------------------------------------------*/
+int crlib_object_init(
+	int capacity,
+	int chunk_aware,
+	int (*store)(CsmgrdT_Content_Entry*),
+	void (*remove)(unsigned char*, int)
+) {
+	obj_table = cef_lhash_tbl_create_ext(capacity, CefC_Hash_Coef_Cache);
+	if (obj_table == 0) {
+		return (-1);
+	}
+	crlib_lookup_table_init(capacity);
+	obj_chunk_aware = chunk_aware;
+	obj_chunk_total = 0;
+	obj_store_api 	= store;
+	obj_remove_api 	= remove;
+	return (0);
+}
+
+void crlib_object_destroy() {
+	if (obj_table) {
+		cef_lhash_tbl_destroy(obj_table);
+		crlib_lookup_table_destroy();
+	}
+	obj_table 		= 0;
+	obj_chunk_total = 0;
+	obj_store_api 	= NULL;
+	obj_remove_api 	= NULL;
+}
+
+int crlib_object_chunk_aware() {
+	return obj_chunk_aware;
+}
+
+int crlib_object_chunk_total() {
+	return obj_chunk_total;
+}
+
+/* Length of the key of the object which the key of the chunk belongs to 	*/
+int crlib_object_key_len(const unsigned char* key, int key_len) {
+	const unsigned char* fld;
+
+	if (!obj_chunk_aware || key_len <= CrlibC_Chunk_Field_Len) {
+		return key_len;
+	}
+	fld = key + key_len - CrlibC_Chunk_Field_Len;
+	if (fld[0] != 0x00 || fld[1] != 0x10 || fld[2] != 0x00 || fld[3] != 0x04) {
+		return key_len;
+	}
+	return key_len - CrlibC_Chunk_Field_Len;
+}
+
+CrlibT_Object* crlib_object_lookup(const unsigned char* key, int key_len) {
+	return (CrlibT_Object*) cef_lhash_tbl_item_get(
+				obj_table, key, crlib_object_key_len(key, key_len));
+}
+
+CrlibT_Chunk* crlib_object_chunk_lookup(const unsigned char* key, int key_len) {
+	return (CrlibT_Chunk*) crlib_lookup_table_search_v(key, key_len);
+}
+
+int crlib_object_entry_key(CsmgrdT_Content_Entry* entry, unsigned char* key) {
+	return csmgrd_name_chunknum_concatenate(
+				entry->name, entry->name_len, entry->chunk_num, key);
+}
+
+/* Stores the content entry, and returns the object which holds it 	*/
+CrlibT_Object* crlib_object_store(CsmgrdT_Content_Entry* entry, int* new_f) {
+	unsigned char 	key[CsmgrdC_Key_Max];
+	int 			key_len;
+	CrlibT_Object*	obj;
+	CrlibT_Chunk*	chunk;
+
+	*new_f = 0;
+	key_len = crlib_object_entry_key(entry, key);
+
+	/* Replaces the entry which has been cached 	*/
+	chunk = crlib_object_chunk_lookup(key, key_len);
+	if (chunk) {
+		entry->algo_h = chunk;
+		if ((*obj_store_api)(entry) < 0) {
+			return NULL;
+		}
+		return chunk->obj;
+	}
+
+	obj = crlib_object_lookup(key, key_len);
+	if (obj == NULL) {
+		obj = crlib_object_create(key, crlib_object_key_len(key, key_len));
+		if (obj == NULL) {
+			return NULL;
+		}
+		*new_f = 1;
+	}
+	chunk = (CrlibT_Chunk*) calloc(1, sizeof(CrlibT_Chunk) + key_len);
+	entry->algo_h = chunk;
+	if (chunk == NULL || (*obj_store_api)(entry) < 0) {
+		free(chunk);
+		if (*new_f) {
+			crlib_object_free(obj);
+			*new_f = 0;
+		}
+		return NULL;
+	}
+	chunk->key = (unsigned char*) chunk + sizeof(CrlibT_Chunk);
+	chunk->key_len = key_len;
+	memcpy(chunk->key, key, key_len);
+	chunk->obj = obj;
+	crlib_lookup_table_add_v(chunk->key, chunk->key_len, chunk);
+
+	chunk->prev = obj->chunk_tail;
+	if (obj->chunk_tail) {
+		obj->chunk_tail->next = chunk;
+	} else {
+		obj->chunk_head = chunk;
+	}
+	obj->chunk_tail = chunk;
+	obj->chunk_num++;
+	if (obj->chunk_num > obj->chunk_peak) {
+		obj->chunk_peak = obj->chunk_num;
+	}
+	if (obj->queue) {
+		obj->queue->chunk_num++;
+	}
+	obj_chunk_total++;
+
+	return obj;
+}
+
+/* Removes the newest chunk of the object from the cache 	*/
+void crlib_object_chunk_evict(CrlibT_Object* obj) {
+	CrlibT_Chunk* chunk = obj->chunk_tail;
+
+	if (chunk == NULL) {
+		return;
+	}
+	crlib_object_chunk_unlink(chunk);
+	(*obj_remove_api)(chunk->key, chunk->key_len);
+	free(chunk);
+}
+
+/* Forgets the chunk removed by the plugin, and returns the object which held it 	*/
+CrlibT_Object* crlib_object_chunk_forget(CrlibT_Chunk* chunk) {
+	CrlibT_Object*	obj = chunk->obj;
+
+	crlib_object_chunk_unlink(chunk);
+	free(chunk);
+	return obj;
+}
+
+/* Frees the object which has been unlinked from the queue 	*/
+void crlib_object_free(CrlibT_Object* obj) {
+	CrlibT_Chunk* chunk;
+
+	while ((chunk = obj->chunk_head) != NULL) {
+		crlib_object_chunk_unlink(chunk);
+		free(chunk);
+	}
+	cef_lhash_tbl_item_remove(obj_table, obj->key, obj->key_len);
+	free(obj);
+}
+
+static CrlibT_Object* crlib_object_create(const unsigned char* key, int key_len) {
+	CrlibT_Object* obj;
+
+	obj = (CrlibT_Object*) calloc(1, sizeof(CrlibT_Object) + key_len);
+	if (obj == NULL) {
+		return NULL;
+	}
+	obj->key = (unsigned char*) obj + sizeof(CrlibT_Object);
+	obj->key_len = key_len;
+	memcpy(obj->key, key, key_len);
+	if (cef_lhash_tbl_item_set(obj_table, obj->key, obj->key_len, obj) < 0) {
+		free(obj);
+		return NULL;
+	}
+	return obj;
+}
+
+static void crlib_object_chunk_unlink(CrlibT_Chunk* chunk) {
+	CrlibT_Object* obj = chunk->obj;
+
+	if (chunk->prev) {
+		chunk->prev->next = chunk->next;
+	} else {
+		obj->chunk_head = chunk->next;
+	}
+	if (chunk->next) {
+		chunk->next->prev = chunk->prev;
+	} else {
+		obj->chunk_tail = chunk->prev;
+	}
+	obj->chunk_num--;
+	if (obj->queue) {
+		obj->queue->chunk_num--;
+	}
+	obj_chunk_total--;
+	crlib_lookup_table_remove(chunk->key, chunk->key_len);
+}
+
+/*--------------------------------------------------------------------------------------
+	Functions for Queues
+----------------------------------------------------------------------------------------*/
+void crlib_queue_push(CrlibT_Queue* q, CrlibT_Object* obj) {
+	crlib_queue_unlink(obj);
+	obj->prev = NULL;
+	obj->next = q->head;
+	if (q->head) {
+		q->head->prev = obj;
+	} else {
+		q->tail = obj;
+	}
+	q->head = obj;
+	obj->queue = q;
+	q->obj_num++;
+	q->chunk_num += obj->chunk_num;
+}
+
+void crlib_queue_unlink(CrlibT_Object* obj) {
+	CrlibT_Queue* q = obj->queue;
+
+	if (q == NULL) {
+		return;
+	}
+	if (obj->prev) {
+		obj->prev->next = obj->next;
+	} else {
+		q->head = obj->next;
+	}
+	if (obj->next) {
+		obj->next->prev = obj->prev;
+	} else {
+		q->tail = obj->prev;
+	}
+	q->obj_num--;
+	q->chunk_num -= obj->chunk_num;
+	obj->queue = NULL;
+	obj->next = NULL;
+	obj->prev = NULL;
+}
+
+/* Frees the objects without removing the chunks from the cache 	*/
+void crlib_queue_clear(CrlibT_Queue* q) {
+	CrlibT_Object* obj;
+
+	while ((obj = q->tail) != NULL) {
+		crlib_queue_unlink(obj);
+		crlib_object_free(obj);
+	}
+}
+
+/* Calls the callback for each chunk from the tail of the queue. The frequency 	*/
+/* is given with the oldest chunk of the object 									*/
+void crlib_queue_walk(
+	CrlibT_Queue* q,
+	int (*freq)(CrlibT_Object*),
+	void (*callback)(unsigned char*, int, int, void*),
+	void* arg
+) {
+	CrlibT_Object* 	obj;
+	CrlibT_Chunk*	chunk;
+
+	for (obj = q->tail ; obj ; obj = obj->prev) {
+		for (chunk = obj->chunk_head ; chunk ; chunk = chunk->next) {
+			(*callback)(chunk->key, chunk->key_len,
+				(chunk == obj->chunk_head) ? (*freq)(obj) : 0, arg);
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------------------
+	Functions for Ghosts
+----------------------------------------------------------------------------------------*/
+int crlib_ghost_init(CrlibT_Ghost* g, int capacity) {
+	memset(g, 0, sizeof(CrlibT_Ghost));
+	g->tbl = cef_lhash_tbl_create_ext(capacity, CefC_Hash_Coef_Cache);
+	return (g->tbl ? 0 : -1);
+}
+
+void crlib_ghost_destroy(CrlibT_Ghost* g) {
+	while (g->tail) {
+		crlib_ghost_drop(g);
+	}
+	if (g->tbl) {
+		cef_lhash_tbl_destroy(g->tbl);
+	}
+	memset(g, 0, sizeof(CrlibT_Ghost));
+}
+
+/* Records the key of the object evicted from the cache 	*/
+void crlib_ghost_add(CrlibT_Ghost* g, CrlibT_Object* obj) {
+	CrlibT_Ghost_Entry* ent;
+
+	/* Moves the key to the head if it has been recorded 	*/
+	crlib_ghost_take(g, obj->key, obj->key_len);
+	ent = (CrlibT_Ghost_Entry*) calloc(1, sizeof(CrlibT_Ghost_Entry) + obj->key_len);
+	if (ent == NULL) {
+		return;
+	}
+	ent->key = (unsigned char*) ent + sizeof(CrlibT_Ghost_Entry);
+	ent->key_len = obj->key_len;
+	memcpy(ent->key, obj->key, obj->key_len);
+	ent->chunk_num = (obj->chunk_peak > 0) ? obj->chunk_peak : 1;
+	if (cef_lhash_tbl_item_set(g->tbl, ent->key, ent->key_len, ent) < 0) {
+		free(ent);
+		return;
+	}
+	ent->next = g->head;
+	if (g->head) {
+		g->head->prev = ent;
+	} else {
+		g->tail = ent;
+	}
+	g->head = ent;
+	g->entry_num++;
+	g->chunk_num += ent->chunk_num;
+}
+
+/* Removes the key, and returns the number of chunks the object had, or 0 if the 	*/
+/* key is not recorded 																*/
+int crlib_ghost_take(CrlibT_Ghost* g, const unsigned char* key, int key_len) {
+	CrlibT_Ghost_Entry* ent;
+	int chunk_num;
+
+	ent = (CrlibT_Ghost_Entry*) cef_lhash_tbl_item_remove(g->tbl, key, key_len);
+	if (ent == NULL) {
+		return 0;
+	}
+	if (ent->prev) {
+		ent->prev->next = ent->next;
+	} else {
+		g->head = ent->next;
+	}
+	if (ent->next) {
+		ent->next->prev = ent->prev;
+	} else {
+		g->tail = ent->prev;
+	}
+	g->entry_num--;
+	g->chunk_num -= ent->chunk_num;
+	chunk_num = ent->chunk_num;
+	free(ent);
+	return chunk_num;
+}
+
+/* Forgets the oldest key 	*/
+void crlib_ghost_drop(CrlibT_Ghost* g) {
+	if (g->tail) {
+		crlib_ghost_take(g, g->tail->key, g->tail->key_len);
+	}
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cache_object_lib.h
+ */
+
+/*
+	cache_object_lib groups the content entries into the objects which the cache
+	replacement policies rank. An object is a chunk, or all chunks of a content in
+	the chunk-aware mode. The capacity is counted in chunks in both modes.
+*/
+
+#ifndef __CACHE_OBJECT_LIB_HEADER__
+#define __CACHE_OBJECT_LIB_HEADER__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <cefore/cef_hash.h>
+#include <csmgrd/csmgrd_plugin.h>
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+struct _CrlibT_Object;
+struct _CrlibT_Queue;
+
+/***** cached chunk *****/
+typedef struct _CrlibT_Chunk {
+	unsigned char*			key;			/* key of content entry (name + chunk)		*/
+	int 					key_len;		/* length of key							*/
+	struct _CrlibT_Object*	obj;			/* object which holds the chunk				*/
+	struct _CrlibT_Chunk*	next;			/* chunk cached after this one				*/
+	struct _CrlibT_Chunk*	prev;			/* chunk cached before this one				*/
+} CrlibT_Chunk;
+
+/***** object ranked by the policy *****/
+typedef struct _CrlibT_Object {
+	unsigned char*			key;			/* key of the chunk, or name of the content	*/
+											/* in the chunk-aware mode					*/
+	int 					key_len;		/* length of key							*/
+	int 					chunk_num;		/* number of cached chunks					*/
+	int 					chunk_peak;		/* max number of chunks cached at once		*/
+	CrlibT_Chunk*			chunk_head;		/* oldest chunk								*/
+	CrlibT_Chunk*			chunk_tail;		/* newest chunk								*/
+	struct _CrlibT_Queue*	queue;			/* queue which links the object				*/
+	struct _CrlibT_Object*	next;			/* object towards the tail of the queue		*/
+	struct _CrlibT_Object*	prev;			/* object towards the head of the queue		*/
+	int 					freq;			/* frequency kept by the policy				*/
+} CrlibT_Object;
+
+/***** queue of objects *****/
+typedef struct _CrlibT_Queue {
+	CrlibT_Object*			head;			/* object pushed last						*/
+	CrlibT_Object*			tail;			/* object pushed first						*/
+	int 					obj_num;		/* number of objects						*/
+	int 					chunk_num;		/* number of chunks held by the objects		*/
+} CrlibT_Queue;
+
+/***** key of the evicted object *****/
+typedef struct _CrlibT_Ghost_Entry {
+	unsigned char*				key;		/* key of the object						*/
+	int 						key_len;	/* length of key							*/
+	int 						chunk_num;	/* number of chunks the object had			*/
+	struct _CrlibT_Ghost_Entry*	next;		/* entry towards the tail					*/
+	struct _CrlibT_Ghost_Entry*	prev;		/* entry towards the head					*/
+} CrlibT_Ghost_Entry;
+
+/***** FIFO of the keys of the evicted objects *****/
+typedef struct _CrlibT_Ghost {
+	CefT_Hash_Handle		tbl;			/* key to CrlibT_Ghost_Entry				*/
+	CrlibT_Ghost_Entry*		head;			/* entry added last							*/
+	CrlibT_Ghost_Entry*		tail;			/* entry added first						*/
+	int 					entry_num;		/* number of entries						*/
+	int 					chunk_num;		/* sum of chunk_num of the entries			*/
+} CrlibT_Ghost;
+
+/****************************************************************************************
+ Function Declaration
+ ****************************************************************************************/
+
+/* objects */
+int crlib_object_init(
+	int capacity, int chunk_aware,
+	int (*store)(CsmgrdT_Content_Entry*), void (*remove)(unsigned char*, int));
+void crlib_object_destroy();
+int crlib_object_chunk_aware();
+int crlib_object_chunk_total();
+int crlib_object_key_len(const unsigned char* key, int key_len);
+CrlibT_Object* crlib_object_lookup(const unsigned char* key, int key_len);
+CrlibT_Chunk* crlib_object_chunk_lookup(const unsigned char* key, int key_len);
+int crlib_object_entry_key(CsmgrdT_Content_Entry* entry, unsigned char* key);
+CrlibT_Object* crlib_object_store(CsmgrdT_Content_Entry* entry, int* new_f);
+void crlib_object_chunk_evict(CrlibT_Object* obj);
+CrlibT_Object* crlib_object_chunk_forget(CrlibT_Chunk* chunk);
+void crlib_object_free(CrlibT_Object* obj);
+
+/* queues */
+void crlib_queue_push(CrlibT_Queue* q, CrlibT_Object* obj);
+void crlib_queue_unlink(CrlibT_Object* obj);
+void crlib_queue_clear(CrlibT_Queue* q);
+void crlib_queue_walk(
+	CrlibT_Queue* q, int (*freq)(CrlibT_Object*),
+	void (*callback)(unsigned char*, int, int, void*), void* arg);
+
+/* ghosts */
+int crlib_ghost_init(CrlibT_Ghost* g, int capacity);
+void crlib_ghost_destroy(CrlibT_Ghost* g);
+void crlib_ghost_add(CrlibT_Ghost* g, CrlibT_Object* obj);
+int crlib_ghost_take(CrlibT_Ghost* g, const unsigned char* key, int key_len);
+void crlib_ghost_drop(CrlibT_Ghost* g);
+
+#endif // __CACHE_OBJECT_LIB_HEADER__
@@ -50,17 +50,43 @@
  Macros
  ****************************************************************************************/
 
+#define CrlibC_Arena_Block_Size	(256 * 1024)	/* size of a block of the key arena	*/
+#define CrlibC_Arena_Unit		8				/* keys are rounded up to this size	*/
+#define CrlibC_Arena_Classes	(CsmgrdC_Key_Max / CrlibC_Arena_Unit + 1)
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/***** slot of the lookup table *****/
+typedef struct {
+	const unsigned char*	key;			/* key owned by the caller, or NULL if the	*/
+											/* slot is empty							*/
+	void*					value;			/* value of the key							*/
+	uint32_t				hash;			/* hash value of the key					*/
+	int 					key_len;		/* length of key							*/
+} CrlibT_Lookup_Slot;
+
+/***** block of the key arena *****/
+typedef struct _CrlibT_Arena_Block {
+	struct _CrlibT_Arena_Block*	next;		/* block allocated before this one			*/
+} CrlibT_Arena_Block;
+
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
 
-static CefT_Hash_Handle lookup_table;       /* hash-table to look-up cache entries      */
+static CrlibT_Lookup_Slot*	lookup_slots;   /* open addressing table allocated at init  */
+static uint32_t         lookup_mask;        /* number of slots - 1                      */
 static int              count;              /* the number of entries in lookup table    */
 
+static CrlibT_Arena_Block*	arena_blocks;   /* blocks which hold the keys               */
+static unsigned char*   arena_cur;          /* unused area of the newest block          */
+static size_t           arena_rest;         /* size of the unused area                  */
+static void*            arena_free[CrlibC_Arena_Classes];
+                                            /* freed keys of each size class, which     */
+                                            /* are linked through their first bytes     */
+
 /****************************************************************************************
  Function Declaration
  ****************************************************************************************/
@@ -71,16 +97,33 @@ static int              count;              /* the number of entries in lookup t
 /*--------------------------------------------------------------------------------------
 	Functions for Lookup Table
 ----------------------------------------------------------------------------------------*/
+/* The table is linear probing over the slots allocated by init, and it refers to the	*/
+/* key of the caller instead of copying it, so the key must be kept until it is 		*/
+/* removed. Nothing is allocated while the entries are added and removed. 				*/
 static void* crlib_lookup_table_encode_val(int idx);
 static int crlib_lookup_table_decode_val(void* val);
+static CrlibT_Lookup_Slot* crlib_lookup_table_find(
+	const unsigned char* key, int key_len, uint32_t hash);
 
 void crlib_lookup_table_init(int capacity) {
-    lookup_table = cef_lhash_tbl_create_ext(capacity, CefC_Hash_Coef_Cache);
+    uint32_t slots = 16;
+    /* Keeps the load factor under 2/3 		*/
+    while (slots < (uint32_t) capacity + (uint32_t) capacity / 2 && slots < 0x80000000u) {
+        slots <<= 1;
+    }
+    lookup_slots = (CrlibT_Lookup_Slot*) calloc(slots, sizeof(CrlibT_Lookup_Slot));
+    if (lookup_slots == NULL) {
+        fprintf(stderr, "[CRLIB] failed to allocate the lookup table\n");
+        slots = 0;
+    }
+    lookup_mask = slots - 1;
     count = 0;
 }
 
 void crlib_lookup_table_destroy() {
-    cef_lhash_tbl_destroy(lookup_table);
+    free(lookup_slots);
+    lookup_slots = NULL;
+    lookup_mask = 0;
     count = 0;
 }
 
@@ -92,29 +135,87 @@ static int crlib_lookup_table_decode_val(void* val) {
     return ((intptr_t)val) - 1;
 }
 
+static CrlibT_Lookup_Slot* crlib_lookup_table_find(
+	const unsigned char* key, int key_len, uint32_t hash
+) {
+    uint32_t i;
+    CrlibT_Lookup_Slot* slot;
+
+    if (lookup_slots == NULL) {
+        return NULL;
+    }
+    /* Returns the empty slot which ends the probe if the key is not found 	*/
+    for (i = hash & lookup_mask ; ; i = (i + 1) & lookup_mask) {
+        slot = &lookup_slots[i];
+        if (slot->key == NULL) {
+            return slot;
+        }
+        if (slot->hash == hash && slot->key_len == key_len &&
+            memcmp(slot->key, key, key_len) == 0) {
+            return slot;
+        }
+    }
+}
+
 int crlib_lookup_table_search(const unsigned char* key, int key_len) {
-    void* val = cef_lhash_tbl_item_get(lookup_table, key, key_len);
-    return crlib_lookup_table_decode_val(val);    
+    return crlib_lookup_table_decode_val(crlib_lookup_table_search_v(key, key_len));
 }
 
 void crlib_lookup_table_add(const unsigned char* key, int key_len, int idx) {
-    cef_lhash_tbl_item_set(
-        lookup_table, key, key_len, crlib_lookup_table_encode_val(idx));  
-    count++;
+    crlib_lookup_table_add_v(key, key_len, crlib_lookup_table_encode_val(idx));
 }
 
 void* crlib_lookup_table_search_v(const unsigned char* key, int key_len) {
-    void* val = cef_lhash_tbl_item_get(lookup_table, key, key_len);
-    return val;
+    CrlibT_Lookup_Slot* slot;
+
+    slot = crlib_lookup_table_find(key, key_len, crlib_xhash_get_str(key, key_len, 0));
+    if (slot == NULL || slot->key == NULL) {
+        return NULL;
+    }
+    return slot->value;
 }
 
 void crlib_lookup_table_add_v(const unsigned char* key, int key_len, void* value) {
-    cef_lhash_tbl_item_set(lookup_table, key, key_len, value);
-    count++;
+    uint32_t hash = crlib_xhash_get_str(key, key_len, 0);
+    CrlibT_Lookup_Slot* slot;
+
+    slot = crlib_lookup_table_find(key, key_len, hash);
+    if (slot == NULL) {
+        return;
+    }
+    if (slot->key == NULL) {
+        /* One slot is always left empty to stop the probe 	*/
+        if ((uint32_t) count >= lookup_mask) {
+            fprintf(stderr, "[CRLIB] lookup table is full\n");
+            return;
+        }
+        slot->hash    = hash;
+        slot->key_len = key_len;
+        count++;
+    }
+    slot->key   = key;
+    slot->value = value;
 }
 
 void crlib_lookup_table_remove(const unsigned char* key, int key_len) {
-    cef_lhash_tbl_item_remove(lookup_table, key, key_len);
+    CrlibT_Lookup_Slot* slot;
+    uint32_t i, j, home;
+
+    slot = crlib_lookup_table_find(key, key_len, crlib_xhash_get_str(key, key_len, 0));
+    if (slot == NULL || slot->key == NULL) {
+        return;
+    }
+    /* Shifts back the following entries of the probe instead of leaving a 	*/
+    /* tombstone, so the probes do not get longer as the entries are replaced 	*/
+    i = (uint32_t)(slot - lookup_slots);
+    for (j = (i + 1) & lookup_mask ; lookup_slots[j].key != NULL ; j = (j + 1) & lookup_mask) {
+        home = lookup_slots[j].hash & lookup_mask;
+        if (((j - home) & lookup_mask) >= ((j - i) & lookup_mask)) {
+            lookup_slots[i] = lookup_slots[j];
+            i = j;
+        }
+    }
+    lookup_slots[i].key = NULL;
     count--;
 }
 
@@ -122,6 +223,83 @@ int crlib_lookup_table_count(const unsigned char* key, int key_len) {
     return count;    
 }
 
+/*--------------------------------------------------------------------------------------
+	Functions for Key Arena
+----------------------------------------------------------------------------------------*/
+/* The keys are carved from large blocks without the header of malloc, and the freed	*/
+/* keys are reused by the keys of the same size class. 									*/
+void crlib_key_arena_init() {
+    int i;
+    arena_blocks = NULL;
+    arena_cur = NULL;
+    arena_rest = 0;
+    for (i = 0; i < CrlibC_Arena_Classes; i++) {
+        arena_free[i] = NULL;
+    }
+}
+
+void crlib_key_arena_destroy() {
+    CrlibT_Arena_Block* block;
+    while ((block = arena_blocks) != NULL) {
+        arena_blocks = block->next;
+        free(block);
+    }
+    crlib_key_arena_init();
+}
+
+unsigned char* crlib_key_arena_alloc(const unsigned char* key, int key_len) {
+    int cls = (key_len + CrlibC_Arena_Unit - 1) / CrlibC_Arena_Unit;
+    size_t size;
+    unsigned char* p;
+    CrlibT_Arena_Block* block;
+
+    if (cls == 0) {
+        cls = 1;
+    }
+    size = (size_t) cls * CrlibC_Arena_Unit;
+    if (cls >= CrlibC_Arena_Classes) {
+        p = (unsigned char*) malloc(size);
+    } else if (arena_free[cls]) {
+        p = (unsigned char*) arena_free[cls];
+        arena_free[cls] = *((void**) p);
+    } else {
+        if (arena_rest < size) {
+            block = (CrlibT_Arena_Block*) malloc(CrlibC_Arena_Block_Size);
+            if (block == NULL) {
+                return NULL;
+            }
+            block->next = arena_blocks;
+            arena_blocks = block;
+            arena_cur  = (unsigned char*) block + sizeof(CrlibT_Arena_Block);
+            arena_rest = CrlibC_Arena_Block_Size - sizeof(CrlibT_Arena_Block);
+        }
+        p = arena_cur;
+        arena_cur  += size;
+        arena_rest -= size;
+    }
+    if (p) {
+        memcpy(p, key, key_len);
+    }
+    return p;
+}
+
+void crlib_key_arena_free(unsigned char* key, int key_len) {
+    int cls = (key_len + CrlibC_Arena_Unit - 1) / CrlibC_Arena_Unit;
+
+    if (key == NULL) {
+        return;
+    }
+    if (cls == 0) {
+        cls = 1;
+    }
+    if (cls >= CrlibC_Arena_Classes) {
+        free(key);
+        return;
+    }
+    *((void**) key) = arena_free[cls];
+    arena_free[cls] = key;
+}
+
 /*--------------------------------------------------------------------------------------
 	+ xx_hash (c.f. https://github.com/Cyan4973/xxHash/blob/dev/xxhash.c)
 ----------------------------------------------------------------------------------------*/
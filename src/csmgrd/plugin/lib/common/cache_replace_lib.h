@@ -46,7 +46,7 @@
  Function Declaration
  ****************************************************************************************/
 
-/* lookup table (capsulation) */
+/* lookup table (capsulation), which refers to the key until it is removed */
 void crlib_lookup_table_init(int capacity);
 void crlib_lookup_table_destroy();
 int crlib_lookup_table_search(const unsigned char* key, int key_len);
@@ -56,6 +56,12 @@ void crlib_lookup_table_add_v(const unsigned char* key, int key_len, void* value
 void crlib_lookup_table_remove(const unsigned char* key, int key_len);
 int crlib_lookup_table_count(const unsigned char* key, int key_len);
 
+/* key arena */
+void crlib_key_arena_init();
+void crlib_key_arena_destroy();
+unsigned char* crlib_key_arena_alloc(const unsigned char* key, int key_len);
+void crlib_key_arena_free(unsigned char* key, int key_len);
+
 /* xxHash */
 uint32_t crlib_xhash_mask_max(int max);
 uint32_t crlib_xhash_mask_width(int width);
@@ -138,6 +138,7 @@ init (
     
     /* Creates lookup table */
     crlib_lookup_table_init (capacity);
+    crlib_key_arena_init ();
     
 	return (0);
 }
@@ -154,16 +155,11 @@ destroy (
 	store_api 		= NULL;
 	remove_api 		= NULL;
 
-	for (int i=0; i< cache_cap; i++) {
-		if (cache_entry_list[i].key != NULL) {
-			free (cache_entry_list[i].key);
-		}
-	}
-
     free (cache_entry_list);
     free (empty_entry_list);
     fifo_head_index = -1;
     fifo_tail_index = -1;
+    crlib_key_arena_destroy ();
     crlib_lookup_table_destroy ();
 }
 
@@ -234,6 +230,46 @@ status (
 	return;
 }
 
+/*--------------------------------------------------------------------------------------
+	Walk API
+----------------------------------------------------------------------------------------*/
+void
+walk (
+	void (*callback)(unsigned char*, int, int, void*),
+											/* called with the key, the length of the 	*/
+											/* key and the frequency of each entry 		*/
+	void* arg								/* argument of the callback 				*/
+) {
+    int index = fifo_tail_index;
+
+    /* From the oldest entry, so that inserting in this order rebuilds the list 	*/
+    while (index >= 0) {
+        (*callback)(cache_entry_list[index].key, cache_entry_list[index].key_len, 0, arg);
+        index = cache_entry_list[index].prev;
+    }
+}
+
+
+/*--------------------------------------------------------------------------------------
+	Handle APIs
+----------------------------------------------------------------------------------------*/
+void
+hit_by_handle (
+	void* handle							/* algo_h of the content entry hits in the 	*/
+											/* cache table 								*/
+) {
+    // NOTHING TO DO
+	return;
+}
+
+void
+erase_by_handle (
+	void* handle							/* algo_h of content entry removed from 	*/
+											/* cache table 								*/
+) {
+    fifo_remove_entry ((int)((FifofT_Entry*) handle - cache_entry_list), 1);
+}
+
 
 /*--------------------------------------------------------------------------------------
 	Static Functions
@@ -245,17 +281,15 @@ static void fifo_store_entry (
     unsigned char 	key[CsmgrdC_Key_Max];
     int 			key_len;
     FifofT_Entry*    rsentry;
-	unsigned char* q;
     
     key_len = csmgrd_name_chunknum_concatenate (
                     entry->name, entry->name_len, entry->chunk_num, key);
     rsentry = &cache_entry_list[index];
     rsentry->key_len = key_len;
-  	q = calloc (1, key_len);
-    memcpy (q, key, key_len);
-	rsentry->key = q;
+	rsentry->key = crlib_key_arena_alloc (key, key_len);
     fifo_set (index);
     crlib_lookup_table_add (rsentry->key, rsentry->key_len, index);
+    entry->algo_h = rsentry;
     (*store_api)(entry);
     cache_count++;
 }
@@ -272,7 +306,7 @@ static void fifo_remove_entry (
 		(*remove_api)(rsentry->key, rsentry->key_len);
 	}
 
-	free (rsentry->key);
+	crlib_key_arena_free (rsentry->key, rsentry->key_len);
     memset (rsentry, 0, sizeof (FifofT_Entry));
     cache_count--;
     empty_entry_list[cache_count] = index;
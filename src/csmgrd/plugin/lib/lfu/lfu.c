@@ -33,6 +33,9 @@
 /*
 	lfu.c is a primitive LFU implementation, 
     which is a low-overhead approximation of LRU.
+	The entries are linked to the bucket of their frequency, and the entry which
+	came to the lowest non-empty bucket first is evicted, so each API works in
+	constant time. The frequency saturates at LfuC_Max_Frequency - 1.
 */
 
 /****************************************************************************************
@@ -58,14 +61,24 @@
  ****************************************************************************************/
 
 /***** structure for listing content entries *****/
-typedef struct {
-	unsigned char 	*key;					/* key of content entry 					*/
+typedef struct _LfuT_Entry {
+	unsigned char 	*key;					/* key of content entry (in the key arena)	*/
 
 	int 			key_len;				/* length of key 							*/
-    int             freq;
-    int             track;
+    int             freq;                   /* frequency, or -1 if the entry is free    */
+    struct _LfuT_Entry* next;               /* entry which came to the bucket before    */
+                                            /* this one, or next free entry             */
+    struct _LfuT_Entry* prev;               /* entry which came to the bucket after     */
+                                            /* this one                                 */
 } LfuT_Entry;
 
+/***** entries of the same frequency *****/
+typedef struct {
+    LfuT_Entry*     head;                   /* entry which came last                    */
+    LfuT_Entry*     tail;                   /* entry which came first                   */
+    int             num;                    /* number of entries                        */
+} LfuT_Bucket;
+
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
@@ -79,10 +92,10 @@ static int cache_cap = 0;					/* Maximum number of entries that can be 	*/
 static int (*store_api)(CsmgrdT_Content_Entry*);
 static void (*remove_api)(unsigned char*, int);
 
-static int              max_freq;         /* position of hand                         */
-static CefT_Rngque*     rings[LfuC_Max_Frequency];
-static int              counts[LfuC_Max_Frequency];
-static CefT_Mp_Handle   lfu_mp;
+static int              min_freq;           /* lowest frequency which has entries       */
+static LfuT_Bucket      buckets[LfuC_Max_Frequency];
+static LfuT_Entry*      entry_pool;         /* entries allocated at init                */
+static LfuT_Entry*      free_entry;         /* list of the free entries                 */
 
 static int              cache_count;        /* number of cache entries                  */
 
@@ -92,7 +105,9 @@ static int              cache_count;        /* number of cache entries
 
 static void lfu_store_entry(CsmgrdT_Content_Entry* entry);
 static void lfu_remove_entry(LfuT_Entry* entry, int is_removed);
-static int  lfu_get_min_freq_ring_having_entry();
+static void lfu_hit_entry(LfuT_Entry* entry);
+static void lfu_bucket_push(LfuT_Entry* entry, int freq);
+static void lfu_bucket_unlink(LfuT_Entry* entry);
 static int  lfu_is_already_cached(CsmgrdT_Content_Entry* entry);
 
 
@@ -111,7 +126,7 @@ init (
 	void (*remove)(unsigned char*, int)		/* remove a content entry API 				*/
 ) {
     int i;
-    max_freq = 0;
+    min_freq = 0;
     cache_count = 0;
     
 	/* Records the capacity of cache		*/
@@ -131,13 +146,22 @@ init (
     
     /* Creates lookup table */
     crlib_lookup_table_init(capacity);
+    crlib_key_arena_init();
     
-	/* Creates the memory pool 				*/
-    lfu_mp = cef_mpool_init("LfuEntry", sizeof(LfuT_Entry), capacity);
-    for (i = 0; i < LfuC_Max_Frequency; i++) {
-        rings[i] = cef_rngque_create(capacity);
-        counts[i] = 0;
+	/* Creates the entries 					*/
+    entry_pool = (LfuT_Entry*) calloc(cache_cap, sizeof(LfuT_Entry));
+    if (entry_pool == NULL) {
+		fprintf (stderr, "[LFU LIB] Failed to allocate the entries\n");
+        crlib_lookup_table_destroy();
+		return (-1);
     }
+    free_entry = NULL;
+    for (i = cache_cap - 1; i >= 0; i--) {
+        entry_pool[i].freq = -1;
+        entry_pool[i].next = free_entry;
+        free_entry = &entry_pool[i];
+    }
+    memset(buckets, 0, sizeof(buckets));
 
 	return (0);
 }
@@ -149,14 +173,16 @@ void
 destroy (
 	void
 ) {
-    max_freq = 0;
+    min_freq = 0;
     cache_count = 0;
 	cache_cap 		= 0;
 	store_api 		= NULL;
 	remove_api 		= NULL;
-	if (lfu_mp) {
-		cef_mpool_destroy (lfu_mp);
-	}
+    free(entry_pool);
+    entry_pool = NULL;
+    free_entry = NULL;
+    memset(buckets, 0, sizeof(buckets));
+    crlib_key_arena_destroy();
     crlib_lookup_table_destroy();
 }
 
@@ -167,27 +193,16 @@ void
 insert (
 	CsmgrdT_Content_Entry* entry			/* content entry 							*/
 ) {
-    int removing_freq;
     if (lfu_is_already_cached(entry)) {
         fprintf(stderr, "[LFU LIB] insert: ERROR: specified entry is already cached.\n");
         return;
     }
     if (cache_count >= cache_cap) {
-        LfuT_Entry* victim_entry;
-        while (1) {
-            removing_freq = lfu_get_min_freq_ring_having_entry();
-            victim_entry = (LfuT_Entry*)cef_rngque_pop(rings[removing_freq]);
-            {
-                fprintf(stderr, "[LFU LIB] %s:  FREQ:%d=%d, ", __func__, victim_entry->freq, removing_freq); 
-                crlib_force_print_name(victim_entry->key, victim_entry->key_len); 
-                fprintf (stderr, "\n"); 
-            }
-            victim_entry->track--;
-            if (removing_freq == victim_entry->freq) break;
-            if (victim_entry->track <= 0) cef_mpool_free(lfu_mp, victim_entry);
+        if (buckets[min_freq].tail == NULL) {
+            fprintf(stderr, "[LFU LIB] insert: ERROR: no entry to evict.\n");
+            return;
         }
-        lfu_remove_entry(victim_entry, 0);
-        if (victim_entry->track <= 0) cef_mpool_free(lfu_mp, victim_entry);
+        lfu_remove_entry(buckets[min_freq].tail, 0);
     }
     lfu_store_entry(entry);
 }
@@ -219,21 +234,12 @@ hit (
 											/* cache table 								*/
 	int key_len								/* length of the key 						*/
 ) {
-    int preFreq, proFreq;
     LfuT_Entry* entry = (LfuT_Entry*) crlib_lookup_table_search_v(key, key_len);
     if (entry == NULL) {
-        fprintf(stderr, "[LFU LIB] failed to erace\n");
+        fprintf(stderr, "[LFU LIB] invalid hit\n");
         return;
     }
-    if (entry->freq >= LfuC_Max_Frequency - 1) return;
-    preFreq = entry->freq;
-    proFreq = entry->freq + 1;
-    cef_rngque_push(rings[proFreq], entry);
-    entry->freq = proFreq;
-    entry->track++;
-    counts[preFreq]--;
-    counts[proFreq]++;
-    if (proFreq > max_freq) max_freq = proFreq;
+    lfu_hit_entry(entry);
 }
 
 /*--------------------------------------------------------------------------------------
@@ -260,6 +266,47 @@ status (
 	return;
 }
 
+/*--------------------------------------------------------------------------------------
+	Walk API
+----------------------------------------------------------------------------------------*/
+void
+walk (
+	void (*callback)(unsigned char*, int, int, void*),
+											/* called with the key, the length of the 	*/
+											/* key and the frequency of each entry 		*/
+	void* arg								/* argument of the callback 				*/
+) {
+    LfuT_Entry* entry;
+    int freq;
+
+    /* From the lowest bucket, and in the order the entries came to the bucket, */
+    /* so that inserting and hitting in this order rebuilds the buckets 		*/
+    for (freq = 0 ; freq < LfuC_Max_Frequency ; freq++) {
+        for (entry = buckets[freq].tail ; entry != NULL ; entry = entry->prev) {
+            (*callback)(entry->key, entry->key_len, freq, arg);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+	Handle APIs
+----------------------------------------------------------------------------------------*/
+void
+hit_by_handle (
+	void* handle							/* algo_h of the content entry hits in the 	*/
+											/* cache table 								*/
+) {
+    lfu_hit_entry((LfuT_Entry*) handle);
+}
+
+void
+erase_by_handle (
+	void* handle							/* algo_h of content entry removed from 	*/
+											/* cache table 								*/
+) {
+    lfu_remove_entry((LfuT_Entry*) handle, 1);
+}
+
 /*--------------------------------------------------------------------------------------
 	Static Functions
 ----------------------------------------------------------------------------------------*/
@@ -269,21 +316,22 @@ static void lfu_store_entry(
     unsigned char 	key[CsmgrdC_Key_Max];
     int 			key_len;
     LfuT_Entry*   rsentry;
-	unsigned char* q;
     
     key_len = csmgrd_name_chunknum_concatenate (
                     entry->name, entry->name_len, entry->chunk_num, key);
-    rsentry = (LfuT_Entry*)cef_mpool_alloc(lfu_mp);
+    rsentry = free_entry;
+    rsentry->key = crlib_key_arena_alloc(key, key_len);
+    if (rsentry->key == NULL) {
+        fprintf(stderr, "[LFU LIB] failed to allocate the key\n");
+        return;
+    }
+    free_entry = rsentry->next;
     rsentry->key_len = key_len;
-  	q = calloc(1, key_len);
-    memcpy(q, key, key_len);
-	rsentry->key = q;
-    rsentry->freq = 0;
-    rsentry->track = 1;
-    cef_rngque_push(rings[0], rsentry);
-    counts[0]++;
+    lfu_bucket_push(rsentry, 0);
+    min_freq = 0;
     cache_count++;
     crlib_lookup_table_add_v(rsentry->key, rsentry->key_len, rsentry);
+    entry->algo_h = rsentry;
     (*store_api)(entry);
 }
 
@@ -291,22 +339,78 @@ static void lfu_remove_entry(
     LfuT_Entry* entry,
     int is_removed
 ) {
+    int freq = entry->freq;
+
     crlib_lookup_table_remove(entry->key, entry->key_len);
-    counts[entry->freq]--;
+    lfu_bucket_unlink(entry);
     cache_count--;
-    entry->freq = -1;
+
+    /* Finds the lowest bucket which has entries, it takes at most 			*/
+    /* LfuC_Max_Frequency steps. The eviction is followed by a store which	*/
+    /* resets min_freq to 0, so this only matters to erase 					*/
+    if (buckets[freq].num == 0 && freq == min_freq) {
+        while (min_freq < LfuC_Max_Frequency - 1 && buckets[min_freq].num == 0) {
+            min_freq++;
+        }
+    }
     if (!is_removed) (*remove_api)(entry->key, entry->key_len);
 
-	free(entry->key);
+    crlib_key_arena_free(entry->key, entry->key_len);
+    entry->key = NULL;
+    entry->freq = -1;
+    entry->next = free_entry;
+    free_entry = entry;
 }
 
-static int lfu_get_min_freq_ring_having_entry() {
-    int freq = 0;
-    while (counts[freq] == 0) {
-        freq++;
-        if (freq > max_freq) return -1;
+static void lfu_hit_entry(
+    LfuT_Entry* entry
+) {
+    int freq = entry->freq;
+
+    if (freq >= LfuC_Max_Frequency - 1) return;
+    lfu_bucket_unlink(entry);
+    lfu_bucket_push(entry, freq + 1);
+
+    /* The entry has moved to the next bucket, which cannot be empty 		*/
+    if (buckets[freq].num == 0 && freq == min_freq) {
+        min_freq = freq + 1;
     }
-    return freq;
+}
+
+static void lfu_bucket_push(
+    LfuT_Entry* entry,
+    int freq
+) {
+    LfuT_Bucket* bucket = &buckets[freq];
+
+    entry->freq = freq;
+    entry->prev = NULL;
+    entry->next = bucket->head;
+    if (bucket->head) {
+        bucket->head->prev = entry;
+    } else {
+        bucket->tail = entry;
+    }
+    bucket->head = entry;
+    bucket->num++;
+}
+
+static void lfu_bucket_unlink(
+    LfuT_Entry* entry
+) {
+    LfuT_Bucket* bucket = &buckets[entry->freq];
+
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        bucket->head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        bucket->tail = entry->prev;
+    }
+    bucket->num--;
 }
 
 static int lfu_is_already_cached(CsmgrdT_Content_Entry* entry) {
@@ -318,4 +422,3 @@ static int lfu_is_already_cached(CsmgrdT_Content_Entry* entry) {
     LfuT_Entry* tmpentry = (LfuT_Entry*) crlib_lookup_table_search_v(key, key_len);
     return tmpentry != NULL;
 }
-
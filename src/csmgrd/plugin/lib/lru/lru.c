@@ -138,6 +138,7 @@ init (
     
     /* Creates lookup table */
     crlib_lookup_table_init(capacity);
+    crlib_key_arena_init();
     
 	return (0);
 }
@@ -154,16 +155,11 @@ destroy (
 	store_api 		= NULL;
 	remove_api 		= NULL;
 
-	for (int i=0; i< cache_cap; i++) {
-		if (cache_entry_list[i].key != NULL){
-			free(cache_entry_list[i].key);
-		}
-	}
-
     free(cache_entry_list);
     free(empty_entry_list);
     lru_index = -1;
     mru_index = -1;
+    crlib_key_arena_destroy();
     crlib_lookup_table_destroy();
 }
 
@@ -239,6 +235,47 @@ status (
 	return;
 }
 
+/*--------------------------------------------------------------------------------------
+	Walk API
+----------------------------------------------------------------------------------------*/
+void
+walk (
+	void (*callback)(unsigned char*, int, int, void*),
+											/* called with the key, the length of the 	*/
+											/* key and the frequency of each entry 		*/
+	void* arg								/* argument of the callback 				*/
+) {
+    int index = lru_index;
+
+    /* From LRU to MRU, so that inserting in this order rebuilds the list 	*/
+    while (index >= 0) {
+        (*callback)(cache_entry_list[index].key, cache_entry_list[index].key_len, 0, arg);
+        index = cache_entry_list[index].prev;
+    }
+}
+
+
+/*--------------------------------------------------------------------------------------
+	Handle APIs
+----------------------------------------------------------------------------------------*/
+void
+hit_by_handle (
+	void* handle							/* algo_h of the content entry hits in the 	*/
+											/* cache table 								*/
+) {
+    int index = (int)((LrufT_Entry*) handle - cache_entry_list);
+    lru_relink_neighbors_of(index);
+    lru_set_mru(index);
+}
+
+void
+erase_by_handle (
+	void* handle							/* algo_h of content entry removed from 	*/
+											/* cache table 								*/
+) {
+    lru_remove_entry((int)((LrufT_Entry*) handle - cache_entry_list), 1);
+}
+
 
 /*--------------------------------------------------------------------------------------
 	Static Functions
@@ -250,17 +287,15 @@ static void lru_store_entry(
     unsigned char 	key[CsmgrdC_Key_Max];
     int 			key_len;
     LrufT_Entry*    rsentry;
-	unsigned char* q;
     
     key_len = csmgrd_name_chunknum_concatenate (
                     entry->name, entry->name_len, entry->chunk_num, key);
     rsentry = &cache_entry_list[index];
     rsentry->key_len = key_len;
-  	q = calloc(1, key_len);
-    memcpy(q, key, key_len);
-	rsentry->key = q;
+	rsentry->key = crlib_key_arena_alloc(key, key_len);
     lru_set_mru(index);
     crlib_lookup_table_add(rsentry->key, rsentry->key_len, index);
+    entry->algo_h = rsentry;
     (*store_api)(entry);
     cache_count++;
 }
@@ -275,7 +310,7 @@ static void lru_remove_entry(
     crlib_lookup_table_remove(rsentry->key, rsentry->key_len);
     if (!is_removed) (*remove_api)(rsentry->key, rsentry->key_len);
 
-	free(rsentry->key);
+	crlib_key_arena_free(rsentry->key, rsentry->key_len);
     memset(rsentry, 0, sizeof(LrufT_Entry));
     cache_count--;
     empty_entry_list[cache_count] = index;
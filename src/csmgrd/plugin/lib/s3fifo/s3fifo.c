@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * s3fifo.c
+ */
+
+/*
+	s3fifo.c is an implementation of S3-FIFO. A new object enters the small FIFO,
+	and only the objects accessed while they are in it are moved to the main FIFO
+	when they reach its tail. The others are evicted early and their keys are
+	remembered in the ghost FIFO, so that they enter the main FIFO directly when
+	they are requested again. The main FIFO gives the objects accessed in it
+	another round instead of evicting them.
+*/
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <csmgrd/csmgrd_plugin.h>
+#include "cache_replace_lib.h"
+#include "cache_object_lib.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define S3fifoC_Small_Ratio 		10		/* small FIFO size (% of the capacity)		*/
+#define S3fifoC_Max_Freq 			3		/* frequency saturates with 2 bits			*/
+#define S3fifoC_Promote_Freq 		1		/* frequency moved from the small FIFO to	*/
+											/* the main FIFO							*/
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static int cache_cap = 0;					/* Maximum number of entries that can be 	*/
+											/* listed (it is the same value as the 		*/
+											/* maximum value of the cache table) 		*/
+static int lib_mode = 0;					/* CsmgrdC_Lib_Mode_XXX flags				*/
+
+static CrlibT_Queue small_q;				/* small FIFO								*/
+static CrlibT_Queue main_q;					/* main FIFO								*/
+static CrlibT_Ghost ghost_g;				/* keys evicted from the small FIFO			*/
+static int small_cap;						/* chunks of the small FIFO					*/
+static int main_cap;						/* chunks of the main FIFO					*/
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static void s3fifo_evict(void);
+static int s3fifo_object_freq(CrlibT_Object* obj);
+static void s3fifo_chunk_hit(CrlibT_Chunk* chunk);
+static void s3fifo_chunk_erase(CrlibT_Chunk* chunk);
+
+/****************************************************************************************
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Init API
+----------------------------------------------------------------------------------------*/
+int 							/* If the error occurs, this value is a negative value	*/
+init (
+	int capacity, 							/* Maximum number of entries that can be 	*/
+											/* listed (it is the same value as the 		*/
+											/* maximum value of the cache table) 		*/
+	int (*store)(CsmgrdT_Content_Entry*), 	/* store a content entry API 				*/
+	void (*remove)(unsigned char*, int)		/* remove a content entry API 				*/
+) {
+	/* Records the capacity of cache		*/
+	if (capacity < 1) {
+		fprintf (stderr, "[S3-FIFO LIB] Invalid Cacacity\n");
+		return (-1);
+	}
+	cache_cap = capacity;
+
+	/* Records store and remove APIs 		*/
+	if ((store == NULL) || (remove == NULL)) {
+		fprintf (stderr, "[S3-FIFO LIB] Not specified store or remove API\n");
+		return (-1);
+	}
+
+	/* Splits the capacity into the small and the main 	*/
+	small_cap = cache_cap * S3fifoC_Small_Ratio / 100;
+	if (small_cap < 1) {
+		small_cap = 1;
+	}
+	main_cap = cache_cap - small_cap;
+	memset(&small_q, 0, sizeof(CrlibT_Queue));
+	memset(&main_q, 0, sizeof(CrlibT_Queue));
+
+	if (crlib_ghost_init(&ghost_g, cache_cap) < 0 ||
+		crlib_object_init(cache_cap,
+			(lib_mode & CsmgrdC_Lib_Mode_Chunk_Aware) ? 1 : 0, store, remove) < 0) {
+		fprintf (stderr, "[S3-FIFO LIB] Failed to create the lookup table\n");
+		crlib_ghost_destroy(&ghost_g);
+		return (-1);
+	}
+
+	return (0);
+}
+
+/*--------------------------------------------------------------------------------------
+	Destroy API
+----------------------------------------------------------------------------------------*/
+void
+destroy (
+	void
+) {
+	crlib_queue_clear(&small_q);
+	crlib_queue_clear(&main_q);
+	crlib_ghost_destroy(&ghost_g);
+	crlib_object_destroy();
+	cache_cap = 0;
+}
+
+/*--------------------------------------------------------------------------------------
+	Insert API
+----------------------------------------------------------------------------------------*/
+void
+insert (
+	CsmgrdT_Content_Entry* entry			/* content entry 							*/
+) {
+	unsigned char 	key[CsmgrdC_Key_Max];
+	int 			key_len;
+	CrlibT_Queue*	place = &small_q;
+	CrlibT_Object* 	obj;
+	int 			new_f;
+
+	/* The object which has been evicted from the small FIFO recently enters the 	*/
+	/* main FIFO directly 															*/
+	key_len = crlib_object_entry_key(entry, key);
+	if (crlib_object_lookup(key, key_len) == NULL &&
+		crlib_ghost_take(&ghost_g, key, crlib_object_key_len(key, key_len)) > 0) {
+		place = &main_q;
+	}
+
+	while (crlib_object_chunk_total() >= cache_cap) {
+		s3fifo_evict();
+	}
+	obj = crlib_object_store(entry, &new_f);
+	if (obj == NULL) {
+		fprintf(stderr, "[S3-FIFO LIB] failed to insert\n");
+		return;
+	}
+	if (new_f) {
+		crlib_queue_push(place, obj);
+	}
+}
+
+/*--------------------------------------------------------------------------------------
+	Erase API
+----------------------------------------------------------------------------------------*/
+void
+erase (
+	unsigned char* key, 					/* key of content entry removed from cache 	*/
+											/* table									*/
+	int key_len								/* length of the key 						*/
+) {
+	CrlibT_Chunk* chunk = crlib_object_chunk_lookup(key, key_len);
+
+	if (chunk == NULL) {
+		fprintf(stderr, "[S3-FIFO LIB] failed to erace\n");
+		return;
+	}
+	s3fifo_chunk_erase(chunk);
+}
+
+/*--------------------------------------------------------------------------------------
+	Hit API
+----------------------------------------------------------------------------------------*/
+void
+hit (
+	unsigned char* key, 					/* key of the content entry hits in the 	*/
+											/* cache table 								*/
+	int key_len								/* length of the key 						*/
+) {
+	CrlibT_Chunk* chunk = crlib_object_chunk_lookup(key, key_len);
+
+	if (chunk == NULL) {
+		fprintf(stderr, "[S3-FIFO LIB] invalid hit\n");
+		return;
+	}
+	s3fifo_chunk_hit(chunk);
+}
+
+/*--------------------------------------------------------------------------------------
+	Miss API
+----------------------------------------------------------------------------------------*/
+void
+miss (
+	unsigned char* key, 					/* key of the content entry fails to hit 	*/
+											/* in the cache table						*/
+	int key_len								/* length of the key 						*/
+) {
+	// NOTHING TO DO
+	return;
+}
+
+/*--------------------------------------------------------------------------------------
+	Status API
+----------------------------------------------------------------------------------------*/
+void
+status (
+	void* arg								/* state information						*/
+) {
+	return;
+}
+
+/*--------------------------------------------------------------------------------------
+	Walk API
+----------------------------------------------------------------------------------------*/
+void
+walk (
+	void (*callback)(unsigned char*, int, int, void*),
+											/* called with the key, the length of the 	*/
+											/* key and the frequency of each entry 		*/
+	void* arg								/* argument of the callback 				*/
+) {
+	crlib_queue_walk(&small_q, s3fifo_object_freq, callback, arg);
+	crlib_queue_walk(&main_q, s3fifo_object_freq, callback, arg);
+}
+
+/*--------------------------------------------------------------------------------------
+	Mode API
+----------------------------------------------------------------------------------------*/
+void
+mode_set (
+	int mode								/* CsmgrdC_Lib_Mode_XXX flags 				*/
+) {
+	lib_mode = mode;
+}
+
+/*--------------------------------------------------------------------------------------
+	Handle APIs
+----------------------------------------------------------------------------------------*/
+void
+hit_by_handle (
+	void* handle							/* algo_h of the content entry hits in the 	*/
+											/* cache table 								*/
+) {
+	s3fifo_chunk_hit((CrlibT_Chunk*) handle);
+}
+
+void
+erase_by_handle (
+	void* handle							/* algo_h of content entry removed from 	*/
+											/* cache table 								*/
+) {
+	s3fifo_chunk_erase((CrlibT_Chunk*) handle);
+}
+
+/*--------------------------------------------------------------------------------------
+	Static Functions
+----------------------------------------------------------------------------------------*/
+
+/* Removes a chunk from the small FIFO while it exceeds its size, or from the main	*/
+/* FIFO otherwise 																	*/
+static void s3fifo_evict(void) {
+	CrlibT_Object* obj;
+
+	for (;;) {
+		if (small_q.chunk_num >= small_cap || main_q.obj_num == 0) {
+			obj = small_q.tail;
+			if (obj->freq >= S3fifoC_Promote_Freq) {
+				obj->freq = 0;
+				crlib_queue_push(&main_q, obj);
+				continue;
+			}
+			crlib_object_chunk_evict(obj);
+			if (obj->chunk_num == 0) {
+				crlib_ghost_add(&ghost_g, obj);
+				while (ghost_g.chunk_num > main_cap && ghost_g.entry_num > 1) {
+					crlib_ghost_drop(&ghost_g);
+				}
+				crlib_queue_unlink(obj);
+				crlib_object_free(obj);
+			}
+			return;
+		}
+
+		obj = main_q.tail;
+		if (obj->freq > 0) {
+			obj->freq--;
+			crlib_queue_push(&main_q, obj);
+			continue;
+		}
+		crlib_object_chunk_evict(obj);
+		if (obj->chunk_num == 0) {
+			crlib_queue_unlink(obj);
+			crlib_object_free(obj);
+		}
+		return;
+	}
+}
+
+static int s3fifo_object_freq(CrlibT_Object* obj) {
+	return obj->freq;
+}
+
+static void s3fifo_chunk_hit(CrlibT_Chunk* chunk) {
+	if (chunk->obj->freq < S3fifoC_Max_Freq) {
+		chunk->obj->freq++;
+	}
+}
+
+static void s3fifo_chunk_erase(CrlibT_Chunk* chunk) {
+	CrlibT_Object* obj = crlib_object_chunk_forget(chunk);
+
+	if (obj->chunk_num == 0) {
+		crlib_queue_unlink(obj);
+		crlib_object_free(obj);
+	}
+}
@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * wtinylfu.c
+ */
+
+/*
+	wtinylfu.c is an implementation of W-TinyLFU. A new object enters a small window
+	LRU. The object pushed out of the window is admitted to the main segmented LRU
+	only if the count-min sketch estimates that it is accessed more often than the
+	victim of the main, so a large sequential download passes through the window
+	without flushing the working set.
+*/
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <csmgrd/csmgrd_plugin.h>
+#include "cache_replace_lib.h"
+#include "cache_object_lib.h"
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define WtlfuC_Window_Ratio 		1		/* window size (% of the capacity)			*/
+#define WtlfuC_Protected_Ratio 		80		/* protected segment size (% of the main)	*/
+
+#define WtlfuC_Sketch_Depth 		4		/* number of rows of the sketch 			*/
+#define WtlfuC_Sketch_Min_Width 	16
+#define WtlfuC_Sketch_Max_Width 	(1 << 24)
+#define WtlfuC_Sketch_Max_Count 	15		/* counters saturate as 4-bit counters		*/
+#define WtlfuC_Sketch_Sample 		10		/* counters are halved after (width * 10)	*/
+											/* increments to age the frequencies		*/
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static int cache_cap = 0;					/* Maximum number of entries that can be 	*/
+											/* listed (it is the same value as the 		*/
+											/* maximum value of the cache table) 		*/
+static int lib_mode = 0;					/* CsmgrdC_Lib_Mode_XXX flags				*/
+
+static CrlibT_Queue window_q;				/* window LRU								*/
+static CrlibT_Queue probation_q;			/* probation segment of the main			*/
+static CrlibT_Queue protected_q;			/* protected segment of the main			*/
+static int window_cap;						/* chunks of the window						*/
+static int main_cap;						/* chunks of the main						*/
+static int protected_cap;					/* chunks of the protected segment			*/
+
+static uint8_t* sketch = NULL;				/* count-min sketch							*/
+static uint32_t sketch_mask;				/* width of a row - 1						*/
+static uint32_t sketch_incs;				/* increments since the last aging			*/
+static uint32_t sketch_reset_at;			/* increments which trigger the aging		*/
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+static void wtlfu_evict(void);
+static void wtlfu_chunk_evict(CrlibT_Object* obj);
+static void wtlfu_window_drain(void);
+static void wtlfu_protected_drain(void);
+static void wtlfu_sketch_increment(const unsigned char* key, int key_len);
+static int wtlfu_sketch_estimate(const unsigned char* key, int key_len);
+static int wtlfu_object_freq(CrlibT_Object* obj);
+static void wtlfu_chunk_hit(CrlibT_Chunk* chunk);
+static void wtlfu_chunk_erase(CrlibT_Chunk* chunk);
+
+/****************************************************************************************
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Init API
+----------------------------------------------------------------------------------------*/
+int 							/* If the error occurs, this value is a negative value	*/
+init (
+	int capacity, 							/* Maximum number of entries that can be 	*/
+											/* listed (it is the same value as the 		*/
+											/* maximum value of the cache table) 		*/
+	int (*store)(CsmgrdT_Content_Entry*), 	/* store a content entry API 				*/
+	void (*remove)(unsigned char*, int)		/* remove a content entry API 				*/
+) {
+	uint32_t width;
+
+	/* Records the capacity of cache		*/
+	if (capacity < 1) {
+		fprintf (stderr, "[W-TinyLFU LIB] Invalid Cacacity\n");
+		return (-1);
+	}
+	cache_cap = capacity;
+
+	/* Records store and remove APIs 		*/
+	if ((store == NULL) || (remove == NULL)) {
+		fprintf (stderr, "[W-TinyLFU LIB] Not specified store or remove API\n");
+		return (-1);
+	}
+
+	/* Splits the capacity into the window and the main 	*/
+	window_cap = cache_cap * WtlfuC_Window_Ratio / 100;
+	if (window_cap < 1) {
+		window_cap = 1;
+	}
+	main_cap = cache_cap - window_cap;
+	protected_cap = main_cap * WtlfuC_Protected_Ratio / 100;
+	memset(&window_q, 0, sizeof(CrlibT_Queue));
+	memset(&probation_q, 0, sizeof(CrlibT_Queue));
+	memset(&protected_q, 0, sizeof(CrlibT_Queue));
+
+	/* Creates the sketch which has a counter per entry in each row 	*/
+	for (width = WtlfuC_Sketch_Min_Width ;
+		width < (uint32_t) cache_cap && width < WtlfuC_Sketch_Max_Width ; width <<= 1);
+	sketch = (uint8_t*) calloc(WtlfuC_Sketch_Depth, width);
+	if (sketch == NULL) {
+		fprintf (stderr, "[W-TinyLFU LIB] Failed to create the sketch\n");
+		return (-1);
+	}
+	sketch_mask = width - 1;
+	sketch_incs = 0;
+	sketch_reset_at = width * WtlfuC_Sketch_Sample;
+
+	if (crlib_object_init(cache_cap,
+			(lib_mode & CsmgrdC_Lib_Mode_Chunk_Aware) ? 1 : 0, store, remove) < 0) {
+		fprintf (stderr, "[W-TinyLFU LIB] Failed to create the lookup table\n");
+		free(sketch);
+		sketch = NULL;
+		return (-1);
+	}
+
+	return (0);
+}
+
+/*--------------------------------------------------------------------------------------
+	Destroy API
+----------------------------------------------------------------------------------------*/
+void
+destroy (
+	void
+) {
+	crlib_queue_clear(&window_q);
+	crlib_queue_clear(&probation_q);
+	crlib_queue_clear(&protected_q);
+	crlib_object_destroy();
+	free(sketch);
+	sketch = NULL;
+	cache_cap = 0;
+}
+
+/*--------------------------------------------------------------------------------------
+	Insert API
+----------------------------------------------------------------------------------------*/
+void
+insert (
+	CsmgrdT_Content_Entry* entry			/* content entry 							*/
+) {
+	CrlibT_Object* obj;
+	int new_f;
+
+	while (crlib_object_chunk_total() >= cache_cap) {
+		wtlfu_evict();
+	}
+	obj = crlib_object_store(entry, &new_f);
+	if (obj == NULL) {
+		fprintf(stderr, "[W-TinyLFU LIB] failed to insert\n");
+		return;
+	}
+	if (new_f) {
+		crlib_queue_push(&window_q, obj);
+		wtlfu_window_drain();
+	}
+}
+
+/*--------------------------------------------------------------------------------------
+	Erase API
+----------------------------------------------------------------------------------------*/
+void
+erase (
+	unsigned char* key, 					/* key of content entry removed from cache 	*/
+											/* table									*/
+	int key_len								/* length of the key 						*/
+) {
+	CrlibT_Chunk* chunk = crlib_object_chunk_lookup(key, key_len);
+
+	if (chunk == NULL) {
+		fprintf(stderr, "[W-TinyLFU LIB] failed to erace\n");
+		return;
+	}
+	wtlfu_chunk_erase(chunk);
+}
+
+/*--------------------------------------------------------------------------------------
+	Hit API
+----------------------------------------------------------------------------------------*/
+void
+hit (
+	unsigned char* key, 					/* key of the content entry hits in the 	*/
+											/* cache table 								*/
+	int key_len								/* length of the key 						*/
+) {
+	CrlibT_Chunk* chunk = crlib_object_chunk_lookup(key, key_len);
+
+	if (chunk == NULL) {
+		fprintf(stderr, "[W-TinyLFU LIB] invalid hit\n");
+		return;
+	}
+	wtlfu_chunk_hit(chunk);
+}
+
+/*--------------------------------------------------------------------------------------
+	Miss API
+----------------------------------------------------------------------------------------*/
+void
+miss (
+	unsigned char* key, 					/* key of the content entry fails to hit 	*/
+											/* in the cache table						*/
+	int key_len								/* length of the key 						*/
+) {
+	/* In the chunk-aware mode, the chunks following the first one of a content	*/
+	/* are not counted while the content is cached 								*/
+	if (crlib_object_lookup(key, key_len) == NULL) {
+		wtlfu_sketch_increment(key, crlib_object_key_len(key, key_len));
+	}
+}
+
+/*--------------------------------------------------------------------------------------
+	Status API
+----------------------------------------------------------------------------------------*/
+void
+status (
+	void* arg								/* state information						*/
+) {
+	return;
+}
+
+/*--------------------------------------------------------------------------------------
+	Walk API
+----------------------------------------------------------------------------------------*/
+void
+walk (
+	void (*callback)(unsigned char*, int, int, void*),
+											/* called with the key, the length of the 	*/
+											/* key and the frequency of each entry 		*/
+	void* arg								/* argument of the callback 				*/
+) {
+	crlib_queue_walk(&probation_q, wtlfu_object_freq, callback, arg);
+	crlib_queue_walk(&protected_q, wtlfu_object_freq, callback, arg);
+	crlib_queue_walk(&window_q, wtlfu_object_freq, callback, arg);
+}
+
+/*--------------------------------------------------------------------------------------
+	Mode API
+----------------------------------------------------------------------------------------*/
+void
+mode_set (
+	int mode								/* CsmgrdC_Lib_Mode_XXX flags 				*/
+) {
+	lib_mode = mode;
+}
+
+/*--------------------------------------------------------------------------------------
+	Handle APIs
+----------------------------------------------------------------------------------------*/
+void
+hit_by_handle (
+	void* handle							/* algo_h of the content entry hits in the 	*/
+											/* cache table 								*/
+) {
+	wtlfu_chunk_hit((CrlibT_Chunk*) handle);
+}
+
+void
+erase_by_handle (
+	void* handle							/* algo_h of content entry removed from 	*/
+											/* cache table 								*/
+) {
+	wtlfu_chunk_erase((CrlibT_Chunk*) handle);
+}
+
+/*--------------------------------------------------------------------------------------
+	Static Functions
+----------------------------------------------------------------------------------------*/
+
+/* Removes a chunk. The object pushed out of the window competes with the victim	*/
+/* of the main, and the loser gives up the chunk 									*/
+static void wtlfu_evict(void) {
+	CrlibT_Object* cand;
+	CrlibT_Object* victim;
+
+	for (;;) {
+		cand = window_q.tail;
+		if (cand == NULL || window_q.chunk_num < window_cap) {
+			break;
+		}
+		if (probation_q.chunk_num + protected_q.chunk_num + cand->chunk_num <= main_cap) {
+			crlib_queue_push(&probation_q, cand);
+			continue;
+		}
+		victim = probation_q.tail ? probation_q.tail : protected_q.tail;
+		if (victim &&
+			wtlfu_object_freq(cand) > wtlfu_object_freq(victim)) {
+			crlib_queue_push(&probation_q, cand);
+			wtlfu_chunk_evict(victim);
+		} else {
+			wtlfu_chunk_evict(cand);
+		}
+		return;
+	}
+
+	victim = probation_q.tail;
+	if (victim == NULL) {
+		victim = protected_q.tail ? protected_q.tail : window_q.tail;
+	}
+	wtlfu_chunk_evict(victim);
+}
+
+static void wtlfu_chunk_evict(CrlibT_Object* obj) {
+	crlib_object_chunk_evict(obj);
+	if (obj->chunk_num == 0) {
+		crlib_queue_unlink(obj);
+		crlib_object_free(obj);
+	}
+}
+
+/* Moves the objects pushed out of the window to the main while the main has room 	*/
+static void wtlfu_window_drain(void) {
+	CrlibT_Object* cand;
+
+	while (window_q.chunk_num > window_cap && window_q.obj_num > 1) {
+		cand = window_q.tail;
+		if (probation_q.chunk_num + protected_q.chunk_num + cand->chunk_num > main_cap) {
+			break;
+		}
+		crlib_queue_push(&probation_q, cand);
+	}
+}
+
+/* Demotes the objects pushed out of the protected segment to the probation 	*/
+static void wtlfu_protected_drain(void) {
+	while (protected_q.chunk_num > protected_cap && protected_q.obj_num > 1) {
+		crlib_queue_push(&probation_q, protected_q.tail);
+	}
+}
+
+static void wtlfu_sketch_increment(const unsigned char* key, int key_len) {
+	uint32_t hash = crlib_xhash_get_str(key, key_len, 0);
+	uint8_t* cnt[WtlfuC_Sketch_Depth];
+	uint8_t min = WtlfuC_Sketch_Max_Count;
+	uint32_t i;
+
+	/* Conservative update, only the smallest counters are incremented 	*/
+	for (i = 0 ; i < WtlfuC_Sketch_Depth ; i++) {
+		cnt[i] = &sketch[i * (sketch_mask + 1) + (crlib_xhash_get(hash, i + 1) & sketch_mask)];
+		if (*cnt[i] < min) {
+			min = *cnt[i];
+		}
+	}
+	if (min >= WtlfuC_Sketch_Max_Count) {
+		return;
+	}
+	for (i = 0 ; i < WtlfuC_Sketch_Depth ; i++) {
+		if (*cnt[i] == min) {
+			(*cnt[i])++;
+		}
+	}
+
+	/* Halves all counters so that the old accesses fade out 	*/
+	if (++sketch_incs >= sketch_reset_at) {
+		for (i = 0 ; i < WtlfuC_Sketch_Depth * (sketch_mask + 1) ; i++) {
+			sketch[i] >>= 1;
+		}
+		sketch_incs /= 2;
+	}
+}
+
+static int wtlfu_sketch_estimate(const unsigned char* key, int key_len) {
+	uint32_t hash = crlib_xhash_get_str(key, key_len, 0);
+	uint8_t min = WtlfuC_Sketch_Max_Count;
+	uint8_t val;
+	uint32_t i;
+
+	for (i = 0 ; i < WtlfuC_Sketch_Depth ; i++) {
+		val = sketch[i * (sketch_mask + 1) + (crlib_xhash_get(hash, i + 1) & sketch_mask)];
+		if (val < min) {
+			min = val;
+		}
+	}
+	return min;
+}
+
+static int wtlfu_object_freq(CrlibT_Object* obj) {
+	return wtlfu_sketch_estimate(obj->key, obj->key_len);
+}
+
+static void wtlfu_chunk_hit(CrlibT_Chunk* chunk) {
+	CrlibT_Object* obj = chunk->obj;
+
+	wtlfu_sketch_increment(obj->key, obj->key_len);
+
+	if (obj->queue == &window_q) {
+		crlib_queue_push(&window_q, obj);
+	} else {
+		/* Promotes the object in the probation to the protected 	*/
+		crlib_queue_push(&protected_q, obj);
+		wtlfu_protected_drain();
+	}
+}
+
+static void wtlfu_chunk_erase(CrlibT_Chunk* chunk) {
+	CrlibT_Object* obj = crlib_object_chunk_forget(chunk);
+
+	if (obj->chunk_num == 0) {
+		crlib_queue_unlink(obj);
+		crlib_object_free(obj);
+	}
+}
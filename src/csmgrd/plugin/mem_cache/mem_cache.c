@@ -53,6 +53,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <semaphore.h>
@@ -88,10 +89,48 @@
 
 #define MemC_SEMNAME					"/cefmemsem"
 
+#define MemC_Lock_Shards			16		/* Number of the locks of the cache table	*/
+
+#define MemC_Slab_Size				(256 * 1024)	/* Size of a slab					*/
+#define MemC_Slab_Min_Objs			4				/* Entries which a slab holds at least	*/
+#define MemC_Slab_Class_Min			256				/* Size of the smallest size class	*/
+#define MemC_Slab_Class_Top			65536			/* The size classes are spaced by a	*/
+													/* quarter of a power of two up to	*/
+													/* 1.25 times of this size			*/
+#define MemC_Slab_Class_Max			40
+#define MemC_Slab_Align(n)			(((n) + 15) & ~((size_t) 15))
+
+/* Size of the block which holds the entry, the key, the version and the message 	*/
+#define MemC_Entry_Size(klen, ver_len, msg_len)	\
+	(sizeof (CsmgrdT_Content_Mem_Entry) + (klen) + (ver_len) + (msg_len))
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
+/********** Slab which holds the entries of a size class ***********/
+typedef struct MemT_Slab {
+	struct MemT_Slab*	prev;					/* Neighbours in the list of the class	*/
+	struct MemT_Slab*	next;
+	unsigned char*		free;					/* Entries returned to this slab		*/
+	unsigned char*		bump;					/* Entries which have never been used	*/
+	uint32_t			inuse;					/* Entries allocated from this slab		*/
+	uint32_t			obj_num;				/* Entries which this slab holds		*/
+	int					class_id;				/* Size class of this slab				*/
+} MemT_Slab;
+
+/********** Size class of the slabs ***********/
 typedef struct {
+	uint32_t			obj_size;				/* Size of an entry of this class		*/
+	uint32_t			slab_size;				/* Size of a slab of this class			*/
+	MemT_Slab*			partial;				/* Slabs which have a free entry		*/
+	MemT_Slab*			full;					/* Slabs whose entries are all used		*/
+	MemT_Slab*			empty;					/* An empty slab kept for reuse			*/
+	uint64_t			slab_num;				/* Slabs mapped for this class			*/
+	uint64_t			obj_inuse;				/* Entries allocated from this class	*/
+	uint64_t			req_bytes;				/* Bytes requested by the entries		*/
+} MemT_Slab_Class;
+
+typedef struct CsmgrdT_Content_Mem_Entry {
 
 	/********** Content Object in mem cache		***********/
 	unsigned char	*msg;						/* Message								*/
@@ -107,19 +146,21 @@ typedef struct {
 	uint64_t		ins_time;					/* Insert time							*/
 	unsigned char*	version;					/* version								*/
 	uint16_t		ver_len;					/* Length of version					*/
-} CsmgrdT_Content_Mem_Entry;
 
-typedef struct CefT_Mem_Hash_Cell {
-
-	uint32_t 					hash;
-	unsigned char* 				key;
-	uint32_t 					klen;
-	CsmgrdT_Content_Mem_Entry* 	elem;
-	struct CefT_Mem_Hash_Cell	*next;
-} CefT_Mem_Hash_Cell;
+	/********** Lookup and allocation	***********/
+	uint32_t		klen;						/* Length of the key, which is the name	*/
+												/* followed by the chunk number			*/
+	uint32_t		hash;						/* Hash value of the key				*/
+	struct CsmgrdT_Content_Mem_Entry* next;		/* Next entry in the same bucket		*/
+	MemT_Slab*		slab;						/* Slab which holds this entry, or NULL	*/
+												/* if it is allocated by malloc			*/
+	void*			algo_h;						/* Handle of the entry in the cache		*/
+												/* algorithm library					*/
+	/* The key, the version and the message follow this structure 	*/
+} CsmgrdT_Content_Mem_Entry;
 
 typedef struct CefT_Mem_Hash {
-	CefT_Mem_Hash_Cell**	tbl;
+	CsmgrdT_Content_Mem_Entry**	tbl;
 	uint32_t 				tabl_max;
 	uint64_t 				elem_max;
 	uint64_t 				elem_num;
@@ -144,7 +185,23 @@ static CsmgrT_Stat_Handle 		csmgr_stat_hdl;
 static pthread_t				mem_cache_delete_th;
 static int						delete_pipe_fd[2];
 
-static pthread_mutex_t 			mem_cs_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Lookups hold the shard of the key for reading, and the others hold all of them 	*/
+static pthread_rwlock_t 		mem_cs_lock[MemC_Lock_Shards];
+/* The cache algorithm library is not thread-safe, so the calls to it are still 	*/
+/* serialized by this mutex. The stat table has its own global mutex as well. 		*/
+static pthread_mutex_t 			mem_algo_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Copy of the hit Cob, which is sent after the shard lock is released. 		*/
+/* The key frees the copy of each thread when the thread exits. 				*/
+static __thread unsigned char* 	mem_get_buff = NULL;
+static pthread_key_t 			mem_get_buff_key;
+static int 						mem_get_buff_key_f = 0;
+
+/* Size classes of the slabs which hold the cache entries 	*/
+static MemT_Slab_Class 			mem_slab_class[MemC_Slab_Class_Max];
+static int 						mem_slab_class_num = 0;
+static pthread_mutex_t 			mem_slab_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t 				mem_large_num = 0;		/* Entries allocated by malloc		*/
+static uint64_t 				mem_large_bytes = 0;
 
 /****************************************************************************************
  Static Function Declaration
@@ -157,6 +214,44 @@ static int							/* The return value is negative if an error occurs	*/
 mem_cs_create (
 	CsmgrT_Stat_Handle stat_hdl, int			//0.8.3c
 );
+/*--------------------------------------------------------------------------------------
+	Locks the shard of the cache table which the key belongs to for reading
+----------------------------------------------------------------------------------------*/
+static pthread_rwlock_t*
+mem_cs_read_lock (
+	const unsigned char* key,
+	uint32_t klen
+);
+/*--------------------------------------------------------------------------------------
+	Frees the copy of the hit Cob when the thread exits
+----------------------------------------------------------------------------------------*/
+static void
+mem_get_buff_free (
+	void* buff
+);
+/*--------------------------------------------------------------------------------------
+	Frees the copy of the hit Cob when the thread exits
+----------------------------------------------------------------------------------------*/
+static void
+mem_get_buff_free (
+	void* buff
+) {
+	free (buff);
+}
+/*--------------------------------------------------------------------------------------
+	Locks all shards of the cache table for writing
+----------------------------------------------------------------------------------------*/
+static int							/* Returns 0 if try_f is set and a shard is busy	*/
+mem_cs_write_lock (
+	int try_f
+);
+/*--------------------------------------------------------------------------------------
+	Unlocks all shards of the cache table
+----------------------------------------------------------------------------------------*/
+static void
+mem_cs_write_unlock (
+	void
+);
 /*--------------------------------------------------------------------------------------
 	Destroy content store
 ----------------------------------------------------------------------------------------*/
@@ -255,10 +350,8 @@ cef_mem_hash_number_create (
 	const unsigned char* key,
 	uint32_t klen
 );
-static int
+static void
 cef_mem_hash_tbl_item_set (
-	const unsigned char* key,
-	uint32_t klen,
 	CsmgrdT_Content_Mem_Entry* elem,
 	CsmgrdT_Content_Mem_Entry** old_elem
 );
@@ -279,6 +372,131 @@ csmgrd_key_create_by_Mem_Entry (
 	unsigned char* key
 );
 
+/*--------------------------------------------------------------------------------------
+	Creates the size classes of the slabs
+----------------------------------------------------------------------------------------*/
+static void
+mem_slab_init (
+	size_t typical_size							/* Size of the entry of a typical Cob	*/
+);
+/*--------------------------------------------------------------------------------------
+	Unmaps all slabs
+----------------------------------------------------------------------------------------*/
+static void
+mem_slab_destroy (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Allocates a block from the slab of the smallest size class which fits
+----------------------------------------------------------------------------------------*/
+static void*									/* Block, or NULL if it fails			*/
+mem_slab_alloc (
+	size_t size,								/* Size of the block					*/
+	MemT_Slab** slab_p							/* Slab which holds the block, or NULL	*/
+												/* if the block is allocated by malloc	*/
+);
+/*--------------------------------------------------------------------------------------
+	Returns a block to its slab, and unmaps the slab if it becomes empty
+----------------------------------------------------------------------------------------*/
+static void
+mem_slab_free (
+	void* ptr,									/* Block								*/
+	MemT_Slab* slab,							/* Slab which holds the block			*/
+	size_t size									/* Size requested to mem_slab_alloc		*/
+);
+/*--------------------------------------------------------------------------------------
+	Creates the cache entry of the Cob in one block
+----------------------------------------------------------------------------------------*/
+static CsmgrdT_Content_Mem_Entry*
+mem_entry_create (
+	const CsmgrdT_Content_Entry* cob
+);
+/*--------------------------------------------------------------------------------------
+	Frees the cache entry
+----------------------------------------------------------------------------------------*/
+static void
+mem_entry_free (
+	CsmgrdT_Content_Mem_Entry* entry
+);
+/*--------------------------------------------------------------------------------------
+	Frees the buffers of the received Cob
+----------------------------------------------------------------------------------------*/
+static void
+mem_cob_buffers_free (
+	CsmgrdT_Content_Entry* cob
+);
+/*--------------------------------------------------------------------------------------
+	Tells the cache algorithm library that the cached entry hits
+----------------------------------------------------------------------------------------*/
+static void
+mem_algo_hit (
+	CsmgrdT_Content_Mem_Entry* entry,
+	unsigned char* key,
+	int key_len
+);
+/*--------------------------------------------------------------------------------------
+	Tells the cache algorithm library that the entry has been removed
+----------------------------------------------------------------------------------------*/
+static void
+mem_algo_erase (
+	CsmgrdT_Content_Mem_Entry* entry,			/* Removed entry, or NULL if the entry	*/
+												/* has not been found					*/
+	unsigned char* key,
+	int key_len
+);
+/*--------------------------------------------------------------------------------------
+	Passes the Cob to the cache algorithm library, which stores it via mem_cs_store
+----------------------------------------------------------------------------------------*/
+static void
+mem_algo_insert (
+	CsmgrdT_Content_Entry* cob
+);
+/*--------------------------------------------------------------------------------------
+	Tells the cache algorithm library that the lookup has failed
+----------------------------------------------------------------------------------------*/
+static void
+mem_algo_miss (
+	unsigned char* key,
+	int key_len
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the usage of the memory
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails	*/
+mem_cache_mem_stat_get (
+	CsmgrdT_Mem_Stat* stat
+);
+/*--------------------------------------------------------------------------------------
+	Finds the smallest size class which fits the size
+----------------------------------------------------------------------------------------*/
+static int										/* Size class, or -1 if none fits		*/
+mem_slab_class_find (
+	size_t size
+);
+/*--------------------------------------------------------------------------------------
+	Maps a new slab of the size class
+----------------------------------------------------------------------------------------*/
+static MemT_Slab*
+mem_slab_create (
+	int class_id
+);
+/*--------------------------------------------------------------------------------------
+	Links the slab to the head of the list
+----------------------------------------------------------------------------------------*/
+static void
+mem_slab_list_add (
+	MemT_Slab** head,
+	MemT_Slab* slab
+);
+/*--------------------------------------------------------------------------------------
+	Unlinks the slab from the list
+----------------------------------------------------------------------------------------*/
+static void
+mem_slab_list_del (
+	MemT_Slab** head,
+	MemT_Slab* slab
+);
+
 static int
 mem_cache_delete_thread_create (
 	void
@@ -318,6 +536,7 @@ csmgrd_memory_plugin_load (
 	CSMGRD_SET_CALLBACKS (
 		mem_cs_create, mem_cs_destroy, mem_cs_expire_check, mem_cache_item_get,
 		mem_cache_item_puts, mem_cs_ac_cnt_inc, mem_cache_lifetime_get);
+	cs_in->mem_stat_get = mem_cache_mem_stat_get;
 
 	if (config_dir) {
 		strcpy (csmgr_conf_dir, config_dir);
@@ -364,6 +583,7 @@ mem_cs_create (
 	strcpy (hdl->algo_name, conf_param.algo_name);
 	hdl->algo_name_size = conf_param.algo_name_size;
 	hdl->algo_cob_size = conf_param.algo_cob_size;
+	hdl->algo_chunk_aware = conf_param.algo_chunk_aware;
 	hdl->cache_cobs = 0;
 
 	/* Check for excessive or insufficient memory resources for cache algorithm library */
@@ -376,6 +596,24 @@ mem_cs_create (
 	}
 
 	/* Creates the memory cache 		*/
+	mem_slab_init (MemC_Entry_Size (
+		hdl->algo_name_size + CefC_S_TLF + CefC_S_ChunkNum, 0, hdl->algo_cob_size));
+	for (i = 0 ; i < MemC_Lock_Shards ; i++) {
+		pthread_rwlockattr_t attr;
+
+		pthread_rwlockattr_init (&attr);
+#ifndef __APPLE__
+		/* The Cob put thread must not starve behind the lookups 	*/
+		pthread_rwlockattr_setkind_np (&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif // __APPLE__
+		pthread_rwlock_init (&mem_cs_lock[i], &attr);
+		pthread_rwlockattr_destroy (&attr);
+	}
+	if (pthread_key_create (&mem_get_buff_key, mem_get_buff_free) != 0) {
+		csmgrd_log_write (CefC_Log_Error, "Failed to create the key of the get buffer\n");
+		return (-1);
+	}
+	mem_get_buff_key_f = 1;
 	mem_hash_tbl = cef_mem_hash_tbl_create (hdl->cache_capacity);
 	if (mem_hash_tbl ==  NULL) {
 		csmgrd_log_write (CefC_Log_Error, "Unable to create mem hash table\n");
@@ -397,6 +635,14 @@ mem_cs_create (
 			return (-1);
 		}
 
+		if (hdl->algo_chunk_aware) {
+			if (hdl->algo_apis.mode_set) {
+				(*(hdl->algo_apis.mode_set))(CsmgrdC_Lib_Mode_Chunk_Aware);
+			} else {
+				csmgrd_log_write (CefC_Log_Warn,
+					"%s does not support CACHE_ALGO_CHUNK_AWARE\n", hdl->algo_name);
+			}
+		}
 		if (hdl->algo_apis.init) {
 			(*(hdl->algo_apis.init))(hdl->cache_capacity, mem_cs_store, mem_cs_remove);
 		}
@@ -473,9 +719,9 @@ mem_cob_process_thread (
 				csmgrd_dbg_write (CefC_Dbg_Fine,
 					"cob put thread starts to write %d cobs\n", mem_proc_cob_buff_idx[i]);
 #endif // CefC_Debug
-				pthread_mutex_lock (&mem_cs_mutex);
+				mem_cs_write_lock (0);
 				mem_cache_cob_write (&mem_proc_cob_buff[i][0], mem_proc_cob_buff_idx[i]);
-				pthread_mutex_unlock (&mem_cs_mutex);
+				mem_cs_write_unlock ();
 				mem_proc_cob_buff_idx[i] = 0;
 				if (i >= MemC_Min_Buff) {
 					free (mem_proc_cob_buff[i]);
@@ -507,44 +753,18 @@ mem_cs_store (
 ) {
 	CsmgrdT_Content_Mem_Entry* entry;
 	CsmgrdT_Content_Mem_Entry* old_entry = NULL;
-	int key_len;
-	unsigned char key[65535];
 	uint64_t 	nowt;
 	struct timeval tv;
 
-	/* Creates the key 		*/
-	key_len = csmgrd_key_create (new_entry, key);
-
-	/* Creates the entry 		*/
-	entry =
-		(CsmgrdT_Content_Mem_Entry*) calloc (1, sizeof (CsmgrdT_Content_Mem_Entry));
+	/* Copies the received Cob to an entry in one block 	*/
+	entry = mem_entry_create (new_entry);
+	mem_cob_buffers_free (new_entry);
 	if (entry == NULL) {
 		return (-1);
 	}
 
 	/* Inserts the cache entry 		*/
-	entry->msg 		= new_entry->msg;
-	entry->msg_len	= new_entry->msg_len;
-	entry->name		= new_entry->name;
-	entry->name_len = new_entry->name_len;
-	entry->pay_len		 = new_entry->pay_len;
-	entry->chunk_num		 = new_entry->chunk_num;
-	entry->cache_time	 = new_entry->cache_time;
-	entry->expiry		 = new_entry->expiry;
-	entry->node			 = new_entry->node;
-	entry->ins_time		 = new_entry->ins_time;
-	entry->ver_len		 = new_entry->ver_len;
-	entry->version		 = new_entry->version;
-
-	if (cef_mem_hash_tbl_item_set (
-		key, key_len, entry, &old_entry) < 0) {
-		free (entry->msg);
-		free (entry->name);
-		if (entry->ver_len)
-			free (entry->version);
-		free (entry);
-		return (-1);
-	}
+	cef_mem_hash_tbl_item_set (entry, &old_entry);
 
 	/* Updates the content information 			*/
 	gettimeofday (&tv, NULL);
@@ -560,11 +780,7 @@ mem_cs_store (
 	}
 
 	if (old_entry) {
-		free (old_entry->msg);
-		free (old_entry->name);
-		if (old_entry->ver_len)
-			free (old_entry->version);
-		free (old_entry);
+		mem_entry_free (old_entry);
 	} else {
 		hdl->cache_cobs++;
 	}
@@ -583,14 +799,13 @@ mem_cs_remove (
 	CsmgrdT_Content_Mem_Entry* entry;
 
 	entry = cef_mem_hash_tbl_item_remove (key, key_len);
+	cef_csmgr_shm_invalidate (key, key_len);
 
 	if (entry) {
 		csmgrd_stat_cob_remove (
 			csmgr_stat_hdl, entry->name, entry->name_len,
 			entry->chunk_num, entry->pay_len);
-		free (entry->msg);
-		free (entry->name);
-		free (entry);
+		mem_entry_free (entry);
 		hdl->cache_cobs--;
 	}
 
@@ -608,13 +823,25 @@ mem_cs_destroy (
 	int i;
 	void* status;
 
-	pthread_mutex_destroy (&mem_cs_mutex);
-
 	if (mem_thread_f) {
 		mem_thread_f = 0;
 		sem_post (mem_comn_buff_sem);	/* To avoid deadlock */
 		pthread_join (mem_thread_th, &status);
 	}
+	for (i = 0 ; i < MemC_Lock_Shards ; i++) {
+		pthread_rwlock_destroy (&mem_cs_lock[i]);
+	}
+	/* The key is deleted before this plugin is unloaded, so the destructor 	*/
+	/* is not called after that. The buffer of this thread is freed here. 		*/
+	if (mem_get_buff_key_f) {
+		pthread_setspecific (mem_get_buff_key, NULL);
+		pthread_key_delete (mem_get_buff_key);
+		mem_get_buff_key_f = 0;
+	}
+	if (mem_get_buff) {
+		free (mem_get_buff);
+		mem_get_buff = NULL;
+	}
 	sem_close (mem_comn_buff_sem);
 	sem_unlink (MemC_SEMNAME);
 
@@ -630,19 +857,23 @@ mem_cs_destroy (
 	}
 	if (mem_hash_tbl) {
 		for (i = 0 ; i < mem_hash_tbl->tabl_max ; i++) {
-			CefT_Mem_Hash_Cell* cp;
-			CefT_Mem_Hash_Cell* wcp;
+			CsmgrdT_Content_Mem_Entry* cp;
+			CsmgrdT_Content_Mem_Entry* wcp;
 			cp = mem_hash_tbl->tbl[i];
 			while (cp != NULL) {
 				wcp = cp->next;
-				free (cp->elem);
-				free (cp);
+				/* The entries in the slabs are released with the slabs 	*/
+				if (cp->slab == NULL) {
+					mem_entry_free (cp);
+				}
 				cp = wcp;
 			}
 		}
 		free (mem_hash_tbl->tbl);
 		free (mem_hash_tbl);
+		mem_hash_tbl = NULL;
 	}
+	mem_slab_destroy ();
 
 	if (hdl->algo_lib) {
 		if (hdl->algo_apis.destroy) {
@@ -674,7 +905,7 @@ mem_cs_expire_check (
 	unsigned char trg_key[65535];
 	int trg_key_len;
 
-	if (pthread_mutex_trylock (&mem_cs_mutex) != 0) {
+	if (!mem_cs_write_lock (1)) {
 		return;
 	}
 
@@ -686,34 +917,29 @@ mem_cs_expire_check (
 			continue;
 		}
 		{
-			CefT_Mem_Hash_Cell* cp;
-			CefT_Mem_Hash_Cell* wcp;
-			cp = mem_hash_tbl->tbl[n];
-			for (; cp != NULL; cp = wcp) {
-				entry = cp->elem;
-				wcp = cp->next;
+			CsmgrdT_Content_Mem_Entry* wcp;
+			entry = mem_hash_tbl->tbl[n];
+			for (; entry != NULL; entry = wcp) {
+				wcp = entry->next;
 				if ((entry->cache_time < nowt) ||
 					((entry->expiry != 0) && (entry->expiry < nowt))) {
 					/* Removes the expiry cache entry 		*/
 					trg_key_len = csmgrd_key_create_by_Mem_Entry (entry, trg_key);
 					entry1 = cef_mem_hash_tbl_item_remove (trg_key, trg_key_len);
-					if (hdl->algo_apis.erase) {
-						(*(hdl->algo_apis.erase))(trg_key, trg_key_len);
-					}
+					cef_csmgr_shm_invalidate (trg_key, trg_key_len);
+					mem_algo_erase (entry1, trg_key, trg_key_len);
 					if ( !entry1 )
 						continue;
 					csmgrd_stat_cob_remove (
 						csmgr_stat_hdl, entry->name, entry->name_len,
 						entry->chunk_num, entry->pay_len);
 					hdl->cache_cobs--;
-					free (entry1->msg);
-					free (entry1->name);
-					free (entry1);
+					mem_entry_free (entry1);
 				}
 			}
 		}
 	}
-	pthread_mutex_unlock (&mem_cs_mutex);
+	mem_cs_write_unlock ();
 
 	return;
 }
@@ -742,6 +968,24 @@ mem_cache_item_get (
 	CsmgrdT_Content_Mem_Entry** entry_p = NULL;
 	int exist_f = CefC_Csmgr_Cob_NotExist;
 	int				rc = CefC_CV_Inconsistent;
+	pthread_rwlock_t* shard;
+	int 			expired_f = 0;
+	uint16_t 		msg_len = 0;
+	uint16_t 		cob_ver_len = 0;
+	uint64_t 		cache_time = 0;
+	uint64_t 		expiry = 0;
+	uint64_t 		ins_time = 0;
+
+	/* Holds the version and the message of the hit Cob 	*/
+	if (mem_get_buff == NULL) {
+		mem_get_buff = (unsigned char*) malloc (CefC_Max_Length * 2);
+		if (mem_get_buff == NULL) {
+			return (CefC_Csmgr_Cob_NotExist);
+		}
+		if (mem_get_buff_key_f) {
+			pthread_setspecific (mem_get_buff_key, mem_get_buff);
+		}
+	}
 
 #ifdef __MEMCACHE_VERSION__
 	fprintf (stderr, "--- mem_cache_item_get()\n");
@@ -751,6 +995,7 @@ mem_cache_item_get (
 	trg_key_len = csmgrd_name_chunknum_concatenate (key, key_size, seqno, trg_key);
 
 	/* Access the specified entry 	*/
+	shard = mem_cs_read_lock (trg_key, trg_key_len);
 	entry = cef_mem_hash_tbl_item_get (trg_key, trg_key_len);
 
 	if (entry) {
@@ -789,50 +1034,79 @@ mem_cache_item_get (
 				goto CobNotExist;
 			}
 
-			pthread_mutex_lock (&mem_cs_mutex);
-			if (hdl->algo_apis.hit) {
-				(*(hdl->algo_apis.hit))(trg_key, trg_key_len);
-			}
+			mem_algo_hit (entry, trg_key, trg_key_len);
 
 			csmgrd_stat_access_count_update (
 					csmgr_stat_hdl, entry->name, entry->name_len);
 
-			/* Send Cob to cefnetd */
-			csmgrd_plugin_cob_msg_send (sock, entry->msg, entry->msg_len);
+			/* The sending may wait for cefnetd, so the Cob is copied and sent 	*/
+			/* after the shard lock is released 									*/
+			cob_ver_len = entry->ver_len;
+			msg_len 	= entry->msg_len;
+			cache_time 	= entry->cache_time;
+			expiry 		= entry->expiry;
+			ins_time 	= entry->ins_time;
+			if (cob_ver_len) {
+				memcpy (mem_get_buff, entry->version, cob_ver_len);
+			}
+			memcpy (&mem_get_buff[cob_ver_len], entry->msg, msg_len);
 			exist_f = CefC_Csmgr_Cob_Exist;
-			pthread_mutex_unlock (&mem_cs_mutex);
  		}
 		else {
-			pthread_mutex_lock (&mem_cs_mutex);
-			/* Removes the expiry cache entry 		*/
+			expired_f = 1;
+		}
+	}
+CobNotExist:;
+	pthread_rwlock_unlock (shard);
+
+	if (exist_f == CefC_Csmgr_Cob_Exist) {
+		/* Send Cob to cefnetd */
+		csmgrd_plugin_cob_msg_send (sock, &mem_get_buff[cob_ver_len], msg_len);
+
+		/* Later Interests for the hit Cob are served by cefnetd from the index */
+		cef_csmgr_shm_publish (trg_key, trg_key_len, mem_get_buff, cob_ver_len,
+			&mem_get_buff[cob_ver_len], msg_len, cache_time, expiry);
+
+		/* The entry may have been removed or replaced before it was published, 	*/
+		/* and its removal has invalidated the index before the publication 		*/
+		shard = mem_cs_read_lock (trg_key, trg_key_len);
+		entry = cef_mem_hash_tbl_item_get (trg_key, trg_key_len);
+		if ((entry == NULL) || (entry->ins_time != ins_time) ||
+			(entry->cache_time != cache_time)) {
+			cef_csmgr_shm_invalidate (trg_key, trg_key_len);
+		}
+		pthread_rwlock_unlock (shard);
+	}
+
+	if (expired_f) {
+		mem_cs_write_lock (0);
+		/* Removes the expiry cache entry unless it has been replaced meanwhile 	*/
+		entry = cef_mem_hash_tbl_item_get (trg_key, trg_key_len);
+		if (entry && !(((entry->expiry == 0) || (nowt < entry->expiry)) &&
+					   (nowt < entry->cache_time))) {
 			entry = cef_mem_hash_tbl_item_remove (trg_key, trg_key_len);
+		} else {
+			entry = NULL;
+		}
 
-			if ( entry ){
-				if (hdl->algo_apis.erase) {
-					(*(hdl->algo_apis.erase))(trg_key, trg_key_len);
-				}
-				hdl->cache_cobs--;
+		if ( entry ){
+			mem_algo_erase (entry, trg_key, trg_key_len);
+			hdl->cache_cobs--;
 
-				csmgrd_stat_cob_remove (
-					csmgr_stat_hdl, entry->name, entry->name_len,
-					entry->chunk_num, entry->pay_len);
+			csmgrd_stat_cob_remove (
+				csmgr_stat_hdl, entry->name, entry->name_len,
+				entry->chunk_num, entry->pay_len);
 
-				free (entry->msg);
-				free (entry->name);
-				free (entry);
-			}
-			pthread_mutex_unlock (&mem_cs_mutex);
+			mem_entry_free (entry);
 		}
+		mem_cs_write_unlock ();
 	}
-CobNotExist:;
 
 	if (entry_p != NULL) {
 		free (entry_p);
 	}
 	if (exist_f != CefC_Csmgr_Cob_Exist) {
-		if (hdl->algo_apis.miss) {
-			(*(hdl->algo_apis.miss))(trg_key, trg_key_len);
-		}
+		mem_algo_miss (trg_key, trg_key_len);
 	}
 	return (exist_f);
 }
@@ -948,11 +1222,7 @@ mem_cache_cob_write (
 	while (index < cob_num) {
 
 		if (cobs[index].expiry < nowt) {
-			free (cobs[index].msg);
-			free (cobs[index].name);
-			if (cobs[index].ver_len) {
-				free (cobs[index].version);
-			}
+			mem_cob_buffers_free (&cobs[index]);
 			index++;
 			continue;
 		}
@@ -964,7 +1234,7 @@ mem_cache_cob_write (
 #ifdef __MEMCACHE_VERSION__
 				fprintf (stderr, "  * new insert %u\n", cobs[index].chunk_num);
 #endif //__MEMCACHE_VERSION__
-				(*(hdl->algo_apis.insert))(&cobs[index]);
+				mem_algo_insert (&cobs[index]);
 			} else {
 				rc = cef_csmgr_cache_version_compare (cobs[index].version, cobs[index].ver_len, entry->version, entry->ver_len);
 #ifdef __MEMCACHE_VERSION__
@@ -989,16 +1259,11 @@ mem_cache_cob_write (
 #endif //__MEMCACHE_VERSION__
 						/* Delete older version of data. */
 						entry = cef_mem_hash_tbl_item_remove(trg_key, trg_key_len);
-						if (hdl->algo_apis.erase) {
-							(*(hdl->algo_apis.erase))(trg_key, trg_key_len);
-						}
+						cef_csmgr_shm_invalidate (trg_key, trg_key_len);
+						mem_algo_erase (entry, trg_key, trg_key_len);
 						hdl->cache_cobs--;
 						if (entry) {
-							free (entry->msg);
-							free (entry->name);
-							if (entry->ver_len) {
-								free (entry->version);
-							}
+							mem_entry_free (entry);
 						} else {
 							return (-1);
 						}
@@ -1037,7 +1302,7 @@ mem_cache_cob_write (
 						}
 
 						/* Insert a new version of data. */
-						(*(hdl->algo_apis.insert))(&cobs[index]);
+						mem_algo_insert (&cobs[index]);
 
 						if (rc == CefC_CV_Newest_1stArg) {
 							/* csmgrd_stat_cob_update is called in store API called in insert API. */
@@ -1068,81 +1333,40 @@ mem_cache_cob_write (
 						fprintf (stderr, "  * ---Same\n");
 #endif //__MEMCACHE_VERSION__
 						/* cached yet */
-						free (cobs[index].msg);
-						free (cobs[index].name);
-						if (cobs[index].ver_len) {
-							free (cobs[index].version);
-						}
+						mem_cob_buffers_free (&cobs[index]);
 					} else {
 #ifdef __MEMCACHE_VERSION__
 						fprintf (stderr, "  * ---Old\n");
 #endif //__MEMCACHE_VERSION__
-						free (cobs[index].msg);
-						free (cobs[index].name);
-						if (cobs[index].ver_len) {
-							free (cobs[index].version);
-						}
+						mem_cob_buffers_free (&cobs[index]);
 					}
 				} else {
 #ifdef __MEMCACHE_VERSION__
 					fprintf (stderr, "  * ---Inconsistent\n");
 #endif //__MEMCACHE_VERSION__
-					free (cobs[index].msg);
-					free (cobs[index].name);
-					if (cobs[index].ver_len) {
-						free (cobs[index].version);
-					}
+					mem_cob_buffers_free (&cobs[index]);
 				}
 			}
 		} else {
 			if (hdl->cache_cobs >= hdl->cache_capacity) {
-				free (cobs[index].msg);
-				free (cobs[index].name);
-				if (cobs[index].ver_len)
-					free (cobs[index].version);
+				mem_cob_buffers_free (&cobs[index]);
 				index++;
 				continue;
 			}
 			/* Caches the content entry without the cache algorithm library 	*/
-			entry =
-				(CsmgrdT_Content_Mem_Entry*) calloc (1, sizeof (CsmgrdT_Content_Mem_Entry));
+			entry = mem_entry_create (&cobs[index]);
+			mem_cob_buffers_free (&cobs[index]);
 			if (entry == NULL) {
-				return (-1);
+				index++;
+				continue;
 			}
 
-			/* Creates the key 				*/
-			trg_key_len = csmgrd_name_chunknum_concatenate (
-							cobs[index].name, cobs[index].name_len,
-							cobs[index].chunk_num, trg_key);
-
-			/* Inserts the cache entry 		*/
-			entry->msg		= cobs[index].msg;
-			entry->msg_len	= cobs[index].msg_len;
-			entry->name		= cobs[index].name;
-			entry->name_len	= cobs[index].name_len;
-			entry->pay_len		 = cobs[index].pay_len;
-			entry->chunk_num		 = cobs[index].chunk_num;
-			entry->cache_time	 = cobs[index].cache_time;
-			entry->expiry		 = cobs[index].expiry;
-			entry->node			 = cobs[index].node;
-			entry->ins_time		 = cobs[index].ins_time;
-			entry->ver_len		 = cobs[index].ver_len;
-			entry->version		 = cobs[index].version;
-
-			old_entry = cef_mem_hash_tbl_item_get (trg_key, trg_key_len);
+			old_entry = cef_mem_hash_tbl_item_get (entry->name, entry->klen);
 			if (old_entry == NULL) {
 #ifdef __MEMCACHE_VERSION__
 				fprintf (stderr, "  * new insert %u\n", entry->chunk_num);
 #endif //__MEMCACHE_VERSION__
-				if (cef_mem_hash_tbl_item_set (
-					trg_key, trg_key_len, entry, &old_entry) < 0) {
-					free (entry->msg);
-					free (entry->name);
-					if (entry->ver_len)
-						free (entry->version);
-					free (entry);
-					return (-1);
-				}
+				cef_mem_hash_tbl_item_set (entry, &old_entry);
 
 				/* Updates the content information 			*/
 				csmgrd_stat_cob_update (csmgr_stat_hdl, entry->name, entry->name_len,
@@ -1164,26 +1388,19 @@ mem_cache_cob_write (
 				}
 				fprintf (stderr, "(%d)\n", old_entry->ver_len);
 				fprintf (stderr, "  * cob: ");
-				for (int i = 0; i < cobs[index].ver_len; i++) {
-					if (isprint (cobs[index].version[i])) fprintf (stderr, "%c ", cobs[index].version[i]);
-					else fprintf (stderr, "%02x ", cobs[index].version[i]);
+				for (int i = 0; i < entry->ver_len; i++) {
+					if (isprint (entry->version[i])) fprintf (stderr, "%c ", entry->version[i]);
+					else fprintf (stderr, "%02x ", entry->version[i]);
 				}
-				fprintf (stderr, "(%d)\n", cobs[index].ver_len);
+				fprintf (stderr, "(%d)\n", entry->ver_len);
 #endif //__MEMCACHE_VERSION__
 				if (rc != CefC_CV_Inconsistent) {
 					if (rc == CefC_CV_Newest_1stArg) {
 #ifdef __MEMCACHE_VERSION__
 						fprintf (stderr, "  * ---New\n");
 #endif //__MEMCACHE_VERSION__
-						if (cef_mem_hash_tbl_item_set (
-							trg_key, trg_key_len, entry, &old_entry) < 0) {
-							free (entry->msg);
-							free (entry->name);
-							if (entry->ver_len)
-								free (entry->version);
-							free (entry);
-							return (-1);
-						}
+						cef_csmgr_shm_invalidate (entry->name, entry->klen);
+						cef_mem_hash_tbl_item_set (entry, &old_entry);
 
 						rcd = csmgrd_stat_content_info_get (csmgr_stat_hdl, entry->name, entry->name_len);
 						rc = cef_csmgr_cache_version_compare (entry->version, entry->ver_len, rcd->version, rcd->ver_len);
@@ -1218,11 +1435,7 @@ mem_cache_cob_write (
 #endif //__MEMCACHE_VERSION__
 						}
 						if (old_entry) {
-							free (old_entry->msg);
-							free (old_entry->name);
-							if (old_entry->ver_len)
-								free (old_entry->version);
-							free (old_entry);
+							mem_entry_free (old_entry);
 						}
 
 						/* Updates the content information 			*/
@@ -1247,43 +1460,23 @@ mem_cache_cob_write (
 						fprintf (stderr, "  * ---Same\n");
 #endif //__MEMCACHE_VERSION__
 						/* cached yet */
-						if (cef_mem_hash_tbl_item_set (
-							trg_key, trg_key_len, entry, &old_entry) < 0) {
-							free (entry->msg);
-							free (entry->name);
-							if (entry->ver_len)
-								free (entry->version);
-							free (entry);
-							return (-1);
-						}
+						cef_mem_hash_tbl_item_set (entry, &old_entry);
 						if (old_entry) {
 							csmgrd_stat_content_lifetime_update (csmgr_stat_hdl,
 								entry->name, entry->name_len, entry->expiry);
-							free (old_entry->msg);
-							free (old_entry->name);
-							if (old_entry->ver_len)
-								free (old_entry->version);
-							free (old_entry);
+							mem_entry_free (old_entry);
 						}
 					} else {
 #ifdef __MEMCACHE_VERSION__
 						fprintf (stderr, "  * ---Old\n");
 #endif //__MEMCACHE_VERSION__
-						free (cobs[index].msg);
-						free (cobs[index].name);
-						if (cobs[index].ver_len) {
-							free (cobs[index].version);
-						}
+						mem_entry_free (entry);
 					}
 				} else {
 #ifdef __MEMCACHE_VERSION__
 					fprintf (stderr, "  * ---Inconsistent\n");
 #endif //__MEMCACHE_VERSION__
-					free (cobs[index].msg);
-					free (cobs[index].name);
-					if (cobs[index].ver_len) {
-						free (cobs[index].version);
-					}
+					mem_entry_free (entry);
 				}
 			}
 		}
@@ -1302,23 +1495,76 @@ mem_cs_ac_cnt_inc (
 	uint32_t seq_num							/* sequence number						*/
 ) {
 	CsmgrdT_Content_Mem_Entry* entry;
+	pthread_rwlock_t* shard;
 
+	shard = mem_cs_read_lock (key, key_size);
 	entry = cef_mem_hash_tbl_item_get (key, key_size);
 	if (!entry) {
+		pthread_rwlock_unlock (shard);
 		return;
 	}
 
-	pthread_mutex_lock (&mem_cs_mutex);
-	if (hdl->algo_apis.hit) {
-		(*(hdl->algo_apis.hit))(key, key_size);
-	}
-	pthread_mutex_unlock (&mem_cs_mutex);
+	mem_algo_hit (entry, key, key_size);
 
 	csmgrd_stat_access_count_update (
 			csmgr_stat_hdl, entry->name, entry->name_len);
+	pthread_rwlock_unlock (shard);
 
 	return;
 }
+/*--------------------------------------------------------------------------------------
+	Locks the shard of the cache table which the key belongs to for reading
+----------------------------------------------------------------------------------------*/
+static pthread_rwlock_t*
+mem_cs_read_lock (
+	const unsigned char* key,
+	uint32_t klen
+) {
+	uint32_t hash = 2166136261u;
+	uint32_t i;
+
+	/* FNV-1a, which is cheaper than the hash of the table for this purpose 	*/
+	for (i = 0 ; i < klen ; i++) {
+		hash = (hash ^ key[i]) * 16777619u;
+	}
+	pthread_rwlock_rdlock (&mem_cs_lock[hash % MemC_Lock_Shards]);
+
+	return (&mem_cs_lock[hash % MemC_Lock_Shards]);
+}
+/*--------------------------------------------------------------------------------------
+	Locks all shards of the cache table for writing
+----------------------------------------------------------------------------------------*/
+static int							/* Returns 0 if try_f is set and a shard is busy	*/
+mem_cs_write_lock (
+	int try_f
+) {
+	int i;
+
+	for (i = 0 ; i < MemC_Lock_Shards ; i++) {
+		if (!try_f) {
+			pthread_rwlock_wrlock (&mem_cs_lock[i]);
+		} else if (pthread_rwlock_trywrlock (&mem_cs_lock[i]) != 0) {
+			while (--i >= 0) {
+				pthread_rwlock_unlock (&mem_cs_lock[i]);
+			}
+			return (0);
+		}
+	}
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Unlocks all shards of the cache table
+----------------------------------------------------------------------------------------*/
+static void
+mem_cs_write_unlock (
+	void
+) {
+	int i;
+
+	for (i = MemC_Lock_Shards - 1 ; i >= 0 ; i--) {
+		pthread_rwlock_unlock (&mem_cs_lock[i]);
+	}
+}
 
 /*--------------------------------------------------------------------------------------
 	Read config file
@@ -1412,6 +1658,14 @@ mem_config_read (
 				return (-1);
 			}
 			params->algo_cob_size = res;
+		} else if (strcmp (option, "CACHE_ALGO_CHUNK_AWARE") == 0) {
+			res = atoi (value);
+			if ((res != 0) && (res != 1)) {
+				csmgrd_log_write (CefC_Log_Error, "CACHE_ALGO_CHUNK_AWARE must be 0 or 1.\n");
+				fclose (fp);
+				return (-1);
+			}
+			params->algo_chunk_aware = res;
 		} else if (strcmp (option, "CACHE_CAPACITY") == 0) {
 			char *endptr = "";
 			params->cache_capacity = strtoul (value, &endptr, 0);
@@ -1443,20 +1697,11 @@ mem_config_read (
 #endif // CefC_Debug
 
 	if (strcmp (params->algo_name, "None") != 0) {
-		if (strcmp (params->algo_name, "libcsmgrd_lfu") == 0) {
-			if (params->cache_capacity > 819200) {
-				csmgrd_log_write (CefC_Log_Error,
-				"Cache capacity value must be less than or equal to 819200 when using algorithm lfu.\n");
-				fclose (fp);
-				return (-1);
-			}
-		} else {
-			if (params->cache_capacity > 2147483647) {
-				csmgrd_log_write (CefC_Log_Error,
-				"Cache capacity value must be less than or equal to 2147483647 when using algorithms lfu, fifo, etc..\n");
-				fclose (fp);
-				return (-1);
-			}
+		if (params->cache_capacity > 2147483647) {
+			csmgrd_log_write (CefC_Log_Error,
+			"Cache capacity value must be less than or equal to 2147483647 when using algorithms lfu, fifo, etc..\n");
+			fclose (fp);
+			return (-1);
 		}
 	}
 	fclose (fp);
@@ -1578,14 +1823,14 @@ cef_mem_hash_tbl_create (
 	}
 	memset (ht, 0, sizeof (CefT_Mem_Hash));
 
-	ht->tbl = (CefT_Mem_Hash_Cell**) calloc (sizeof (CefT_Mem_Hash_Cell*), table_size);
+	ht->tbl = (CsmgrdT_Content_Mem_Entry**) calloc (sizeof (CsmgrdT_Content_Mem_Entry*), table_size);
 
 	if (ht->tbl  == NULL) {
 		free (ht->tbl);
 		free (ht);
 		return (NULL);
 	}
-	memset (ht->tbl, 0, sizeof (CefT_Mem_Hash_Cell*) * table_size);
+	memset (ht->tbl, 0, sizeof (CsmgrdT_Content_Mem_Entry*) * table_size);
 
 	srand ((unsigned) time (NULL));
 	ht->elem_max = capacity;
@@ -1596,61 +1841,39 @@ cef_mem_hash_tbl_create (
 	return (ht);
 }
 
-static int
+/*
+ * Links the entry to the table. The key is held in the entry, and the entry which has
+ * the same key is replaced and returned to old_elem.
+ */
+static void
 cef_mem_hash_tbl_item_set (
-	const unsigned char* key,
-	uint32_t klen,
 	CsmgrdT_Content_Mem_Entry* elem,
 	CsmgrdT_Content_Mem_Entry** old_elem
 ) {
 	CefT_Mem_Hash* ht = (CefT_Mem_Hash*) mem_hash_tbl;
-	uint32_t hash = 0;
+	CsmgrdT_Content_Mem_Entry** cpp;
+	CsmgrdT_Content_Mem_Entry* cp;
 	uint32_t y;
-	CefT_Mem_Hash_Cell* cp;
-	CefT_Mem_Hash_Cell* wcp;
 	*old_elem = NULL;
 
-	hash = cef_mem_hash_number_create (key, klen);
-	y = hash % ht->tabl_max;
-
-	if (ht->tbl[y] == NULL) {
-		ht->tbl[y] = (CefT_Mem_Hash_Cell* )calloc (1, sizeof (CefT_Mem_Hash_Cell) + klen);
-		if (ht->tbl[y] == NULL) {
-			return (-1);
-		}
-		ht->tbl[y]->key = ((unsigned char*)ht->tbl[y]) + sizeof (CefT_Mem_Hash_Cell);
-		cp = ht->tbl[y];
-		cp->elem = elem;
-		cp->klen = klen;
-		memcpy (cp->key, key, klen);
-		ht->elem_num++;
-		return (1);
-	} else {
-		/* exist check & replace */
-		for (cp = ht->tbl[y]; cp != NULL; cp = cp->next) {
-			if ((cp->klen == klen) &&
-			   (memcmp (cp->key, key, klen) == 0)) {
-				*old_elem = cp->elem;
-				cp->elem = elem;
-				return (1);
-		   }
-		}
-		/* insert */
-		wcp = ht->tbl[y];
-		ht->tbl[y] = (CefT_Mem_Hash_Cell* )calloc (1, sizeof (CefT_Mem_Hash_Cell) + klen);
-		if (ht->tbl[y] == NULL) {
-			return (-1);
+	elem->hash = cef_mem_hash_number_create (elem->name, elem->klen);
+	y = elem->hash % ht->tabl_max;
+
+	/* exist check & replace */
+	for (cpp = &ht->tbl[y] ; *cpp != NULL ; cpp = &(*cpp)->next) {
+		cp = *cpp;
+		if ((cp->hash == elem->hash) && (cp->klen == elem->klen) &&
+			(memcmp (cp->name, elem->name, elem->klen) == 0)) {
+			elem->next = cp->next;
+			*cpp = elem;
+			*old_elem = cp;
+			return;
 		}
-		ht->tbl[y]->key = ((unsigned char*)ht->tbl[y]) + sizeof (CefT_Mem_Hash_Cell);
-		cp = ht->tbl[y];
-		cp->next = wcp;
-		cp->elem = elem;
-		cp->klen = klen;
-		memcpy (cp->key, key, klen);
-
-		ht->elem_num++;
-		return (1);
 	}
+	/* insert */
+	elem->next = ht->tbl[y];
+	ht->tbl[y] = elem;
+	ht->elem_num++;
 }
 static CsmgrdT_Content_Mem_Entry*
 cef_mem_hash_tbl_item_get (
@@ -1659,23 +1882,17 @@ cef_mem_hash_tbl_item_get (
 ) {
 	CefT_Mem_Hash* ht = (CefT_Mem_Hash*) mem_hash_tbl;
 	uint32_t hash = 0;
-	uint32_t y;
-	CefT_Mem_Hash_Cell* cp;
+	CsmgrdT_Content_Mem_Entry* cp;
 
 	if ((klen > MemC_Max_KLen) || (ht == NULL)) {
 		return (NULL);
 	}
 	hash = cef_mem_hash_number_create (key, klen);
-	y = hash % ht->tabl_max;
 
-	cp = ht->tbl[y];
-	if (cp == NULL) {
-		return (NULL);
-	}
-	for (; cp != NULL; cp = cp->next) {
-		if ((cp->klen == klen) &&
-		   (memcmp (cp->key, key, klen) == 0)) {
-		   	return (cp->elem);
+	for (cp = ht->tbl[hash % ht->tabl_max] ; cp != NULL ; cp = cp->next) {
+		if ((cp->hash == hash) && (cp->klen == klen) &&
+			(memcmp (cp->name, key, klen) == 0)) {
+			return (cp);
 		}
 	}
 
@@ -1689,42 +1906,22 @@ cef_mem_hash_tbl_item_remove (
 ) {
 	CefT_Mem_Hash* ht = (CefT_Mem_Hash*) mem_hash_tbl;
 	uint32_t hash = 0;
-	uint32_t y;
-	CsmgrdT_Content_Mem_Entry* ret_elem;
-	CefT_Mem_Hash_Cell* cp;
-	CefT_Mem_Hash_Cell* wcp;
+	CsmgrdT_Content_Mem_Entry** cpp;
+	CsmgrdT_Content_Mem_Entry* cp;
 
 	if ((klen > MemC_Max_KLen) || (ht == NULL)) {
 		return (NULL);
 	}
-
 	hash = cef_mem_hash_number_create (key, klen);
-	y = hash % ht->tabl_max;
 
-	cp = ht->tbl[y];
-	if (cp == NULL) {
-		return (NULL);
-	}
-	if (cp != NULL) {
-		if ((cp->klen == klen) &&
-		   (memcmp (cp->key, key, klen) == 0)) {
-		   	ht->tbl[y] = cp->next;
+	for (cpp = &ht->tbl[hash % ht->tabl_max] ; *cpp != NULL ; cpp = &(*cpp)->next) {
+		cp = *cpp;
+		if ((cp->hash == hash) && (cp->klen == klen) &&
+			(memcmp (cp->name, key, klen) == 0)) {
+			*cpp = cp->next;
+			cp->next = NULL;
 			ht->elem_num--;
-		   	ret_elem = cp->elem;
-		   	free (cp);
-		   	return (ret_elem);
-		} else {
-			for (; cp->next != NULL; cp = cp->next) {
-				if ((cp->next->klen == klen) &&
-				   (memcmp (cp->next->key, key, klen) == 0)) {
-				   	wcp = cp->next;
-				   	cp->next = cp->next->next;
-					ht->elem_num--;
-				   	ret_elem = wcp->elem;
-					free (wcp);
-					return (ret_elem);
-				}
-			}
+			return (cp);
 		}
 	}
 
@@ -1847,7 +2044,7 @@ mem_cache_delete_thread (
 				memcpy (del_version, stat_p->version, stat_p->ver_len);
 			}
 
-			pthread_mutex_lock (&mem_cs_mutex);
+			mem_cs_write_lock (0);
 
 #ifdef __MEMCACHE_VERSION__
 			fprintf (stderr, "--- mem_cache_delete_thread()\n");
@@ -1865,23 +2062,18 @@ mem_cache_delete_thread (
 				rc = cef_csmgr_cache_version_compare (del_version, del_ver_len, entry->version, entry->ver_len);
 				if (rc == CefC_CV_Same) {
 					entry = cef_mem_hash_tbl_item_remove (trg_key, trg_key_len);
+					cef_csmgr_shm_invalidate (trg_key, trg_key_len);
 					if (entry) {
-						if (hdl->algo_apis.erase) {
-							(*(hdl->algo_apis.erase))(trg_key, trg_key_len);
-						}
+						mem_algo_erase (entry, trg_key, trg_key_len);
 						hdl->cache_cobs--;
-						free (entry->msg);
-						free (entry->name);
-						if (entry->ver_len)
-							free (entry->version);
-						free (entry);
+						mem_entry_free (entry);
 					}
 				}
 			}
 #ifdef __MEMCACHE_VERSION__
 			fprintf (stderr, "  + (*) cache_cobs="FMTU64"\n", hdl->cache_cobs);
 #endif //__MEMCACHE_VERSION__
-			pthread_mutex_unlock (&mem_cs_mutex);
+			mem_cs_write_unlock ();
 		}
 	}
 
@@ -1889,3 +2081,460 @@ mem_cache_delete_thread (
 	return 0;
 }
 
+/****************************************************************************************
+ Slabs for the cache entries
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Creates the size classes of the slabs
+----------------------------------------------------------------------------------------*/
+static void
+mem_slab_init (
+	size_t typical_size							/* Size of the entry of a typical Cob	*/
+) {
+	uint32_t base, size;
+	int i, n;
+
+	memset (mem_slab_class, 0, sizeof (mem_slab_class));
+	mem_slab_class_num = 0;
+	mem_large_num = 0;
+	mem_large_bytes = 0;
+
+	/* The waste of rounding up an entry to its size class is less than 25% 	*/
+	base = MemC_Slab_Class_Min;
+	for (size = base ;
+		 size <= MemC_Slab_Class_Top + MemC_Slab_Class_Top / 4 ; size += base / 4) {
+		if (size >= base * 2) {
+			base *= 2;
+		}
+		mem_slab_class[mem_slab_class_num++].obj_size = size;
+	}
+
+	/* Cobs of a content have the same size except the last one, so that the entries	*/
+	/* of the block size configured for the algorithm fit a size class exactly 			*/
+	typical_size = MemC_Slab_Align (typical_size);
+	n = mem_slab_class_find (typical_size);
+	if ((n >= 0) && (mem_slab_class[n].obj_size != typical_size) &&
+		(mem_slab_class_num < MemC_Slab_Class_Max)) {
+		for (i = mem_slab_class_num ; i > n ; i--) {
+			mem_slab_class[i] = mem_slab_class[i - 1];
+		}
+		mem_slab_class[n].obj_size = (uint32_t) typical_size;
+		mem_slab_class_num++;
+	}
+
+	for (i = 0 ; i < mem_slab_class_num ; i++) {
+		size = mem_slab_class[i].obj_size * MemC_Slab_Min_Objs
+					+ MemC_Slab_Align (sizeof (MemT_Slab));
+		if (size < MemC_Slab_Size) {
+			size = MemC_Slab_Size;
+		}
+		/* Slabs are mapped by pages 	*/
+		mem_slab_class[i].slab_size = (size + 4095) & ~4095U;
+	}
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Unmaps all slabs
+----------------------------------------------------------------------------------------*/
+static void
+mem_slab_destroy (
+	void
+) {
+	MemT_Slab_Class* cls;
+	MemT_Slab* slab;
+	int i;
+
+	pthread_mutex_lock (&mem_slab_mutex);
+	for (i = 0 ; i < mem_slab_class_num ; i++) {
+		cls = &mem_slab_class[i];
+		while ((slab = cls->partial) != NULL) {
+			mem_slab_list_del (&cls->partial, slab);
+			munmap (slab, cls->slab_size);
+		}
+		while ((slab = cls->full) != NULL) {
+			mem_slab_list_del (&cls->full, slab);
+			munmap (slab, cls->slab_size);
+		}
+		if (cls->empty) {
+			munmap (cls->empty, cls->slab_size);
+		}
+	}
+	memset (mem_slab_class, 0, sizeof (mem_slab_class));
+	mem_slab_class_num = 0;
+	pthread_mutex_unlock (&mem_slab_mutex);
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Allocates a block from the slab of the smallest size class which fits
+----------------------------------------------------------------------------------------*/
+static void*									/* Block, or NULL if it fails			*/
+mem_slab_alloc (
+	size_t size,								/* Size of the block					*/
+	MemT_Slab** slab_p							/* Slab which holds the block, or NULL	*/
+												/* if the block is allocated by malloc	*/
+) {
+	MemT_Slab_Class* cls;
+	MemT_Slab* slab;
+	unsigned char* ptr;
+	int class_id;
+
+	*slab_p = NULL;
+	class_id = mem_slab_class_find (size);
+
+	pthread_mutex_lock (&mem_slab_mutex);
+
+	if (class_id < 0) {
+		/* Larger than all size classes 	*/
+		ptr = (unsigned char*) malloc (size);
+		if (ptr) {
+			mem_large_num++;
+			mem_large_bytes += size;
+		}
+		pthread_mutex_unlock (&mem_slab_mutex);
+		return (ptr);
+	}
+	cls = &mem_slab_class[class_id];
+
+	slab = cls->partial;
+	if (slab == NULL) {
+		if (cls->empty) {
+			slab = cls->empty;
+			cls->empty = NULL;
+		} else {
+			slab = mem_slab_create (class_id);
+			if (slab == NULL) {
+				pthread_mutex_unlock (&mem_slab_mutex);
+				return (NULL);
+			}
+		}
+		mem_slab_list_add (&cls->partial, slab);
+	}
+
+	if (slab->free) {
+		ptr = slab->free;
+		memcpy (&slab->free, ptr, sizeof (unsigned char*));
+	} else {
+		ptr = slab->bump;
+		slab->bump += cls->obj_size;
+	}
+	slab->inuse++;
+	if (slab->inuse == slab->obj_num) {
+		mem_slab_list_del (&cls->partial, slab);
+		mem_slab_list_add (&cls->full, slab);
+	}
+	cls->obj_inuse++;
+	cls->req_bytes += size;
+
+	pthread_mutex_unlock (&mem_slab_mutex);
+
+	*slab_p = slab;
+	return (ptr);
+}
+/*--------------------------------------------------------------------------------------
+	Returns a block to its slab, and unmaps the slab if it becomes empty
+----------------------------------------------------------------------------------------*/
+static void
+mem_slab_free (
+	void* ptr,									/* Block								*/
+	MemT_Slab* slab,							/* Slab which holds the block			*/
+	size_t size									/* Size requested to mem_slab_alloc		*/
+) {
+	MemT_Slab_Class* cls;
+
+	pthread_mutex_lock (&mem_slab_mutex);
+
+	if (slab == NULL) {
+		free (ptr);
+		mem_large_num--;
+		mem_large_bytes -= size;
+		pthread_mutex_unlock (&mem_slab_mutex);
+		return;
+	}
+	cls = &mem_slab_class[slab->class_id];
+
+	memcpy (ptr, &slab->free, sizeof (unsigned char*));
+	slab->free = (unsigned char*) ptr;
+	if (slab->inuse == slab->obj_num) {
+		mem_slab_list_del (&cls->full, slab);
+		mem_slab_list_add (&cls->partial, slab);
+	}
+	slab->inuse--;
+	cls->obj_inuse--;
+	cls->req_bytes -= size;
+
+	if (slab->inuse == 0) {
+		/* One empty slab is kept so that the eviction followed by the insertion 	*/
+		/* does not map and unmap a slab every time 								*/
+		mem_slab_list_del (&cls->partial, slab);
+		if (cls->empty == NULL) {
+			cls->empty = slab;
+		} else {
+			munmap (slab, cls->slab_size);
+			cls->slab_num--;
+		}
+	}
+
+	pthread_mutex_unlock (&mem_slab_mutex);
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Finds the smallest size class which fits the size
+----------------------------------------------------------------------------------------*/
+static int										/* Size class, or -1 if none fits		*/
+mem_slab_class_find (
+	size_t size
+) {
+	int lo = 0;
+	int hi = mem_slab_class_num;
+	int mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (mem_slab_class[mid].obj_size < size) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return ((lo < mem_slab_class_num) ? lo : -1);
+}
+/*--------------------------------------------------------------------------------------
+	Maps a new slab of the size class
+----------------------------------------------------------------------------------------*/
+static MemT_Slab*
+mem_slab_create (
+	int class_id
+) {
+	MemT_Slab_Class* cls = &mem_slab_class[class_id];
+	MemT_Slab* slab;
+	size_t hdr_size = MemC_Slab_Align (sizeof (MemT_Slab));
+
+	/* Slabs are mapped directly, so that an unmapped slab is returned to the OS 	*/
+	slab = (MemT_Slab*) mmap (NULL, cls->slab_size,
+				PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+	if (slab == MAP_FAILED) {
+		csmgrd_log_write (CefC_Log_Error, "Failed to map a slab (%s)\n", strerror (errno));
+		return (NULL);
+	}
+	slab->prev 		= NULL;
+	slab->next 		= NULL;
+	slab->free 		= NULL;
+	slab->bump 		= (unsigned char*) slab + hdr_size;
+	slab->inuse 	= 0;
+	slab->obj_num 	= (uint32_t)((cls->slab_size - hdr_size) / cls->obj_size);
+	slab->class_id 	= class_id;
+	cls->slab_num++;
+
+	return (slab);
+}
+/*--------------------------------------------------------------------------------------
+	Links the slab to the head of the list
+----------------------------------------------------------------------------------------*/
+static void
+mem_slab_list_add (
+	MemT_Slab** head,
+	MemT_Slab* slab
+) {
+	slab->prev = NULL;
+	slab->next = *head;
+	if (*head) {
+		(*head)->prev = slab;
+	}
+	*head = slab;
+}
+/*--------------------------------------------------------------------------------------
+	Unlinks the slab from the list
+----------------------------------------------------------------------------------------*/
+static void
+mem_slab_list_del (
+	MemT_Slab** head,
+	MemT_Slab* slab
+) {
+	if (slab->prev) {
+		slab->prev->next = slab->next;
+	} else {
+		*head = slab->next;
+	}
+	if (slab->next) {
+		slab->next->prev = slab->prev;
+	}
+	slab->prev = NULL;
+	slab->next = NULL;
+}
+/*--------------------------------------------------------------------------------------
+	Creates the cache entry of the Cob in one block
+----------------------------------------------------------------------------------------*/
+static CsmgrdT_Content_Mem_Entry*
+mem_entry_create (
+	const CsmgrdT_Content_Entry* cob
+) {
+	CsmgrdT_Content_Mem_Entry* entry;
+	MemT_Slab* slab;
+	unsigned char* bp;
+	uint32_t klen;
+
+	klen = cob->name_len + CefC_S_TLF + CefC_S_ChunkNum;
+	entry = (CsmgrdT_Content_Mem_Entry*) mem_slab_alloc (
+				MemC_Entry_Size (klen, cob->ver_len, cob->msg_len), &slab);
+	if (entry == NULL) {
+		return (NULL);
+	}
+	memset (entry, 0, sizeof (CsmgrdT_Content_Mem_Entry));
+	bp = (unsigned char*)(entry + 1);
+
+	/* The name is followed by the chunk number to be used as the key 	*/
+	entry->name		= bp;
+	entry->name_len	= cob->name_len;
+	entry->klen 	= (uint32_t) csmgrd_name_chunknum_concatenate (
+							cob->name, cob->name_len, cob->chunk_num, bp);
+	bp += entry->klen;
+	if (cob->ver_len) {
+		entry->version = bp;
+		entry->ver_len = cob->ver_len;
+		memcpy (entry->version, cob->version, cob->ver_len);
+		bp += cob->ver_len;
+	}
+	entry->msg		= bp;
+	entry->msg_len	= cob->msg_len;
+	memcpy (entry->msg, cob->msg, cob->msg_len);
+
+	entry->pay_len		 = cob->pay_len;
+	entry->chunk_num	 = cob->chunk_num;
+	entry->cache_time	 = cob->cache_time;
+	entry->expiry		 = cob->expiry;
+	entry->node			 = cob->node;
+	entry->ins_time		 = cob->ins_time;
+	entry->algo_h		 = cob->algo_h;
+	entry->slab			 = slab;
+
+	return (entry);
+}
+/*--------------------------------------------------------------------------------------
+	Frees the cache entry
+----------------------------------------------------------------------------------------*/
+static void
+mem_entry_free (
+	CsmgrdT_Content_Mem_Entry* entry
+) {
+	mem_slab_free (entry, entry->slab,
+		MemC_Entry_Size (entry->klen, entry->ver_len, entry->msg_len));
+}
+/*--------------------------------------------------------------------------------------
+	Frees the buffers of the received Cob
+----------------------------------------------------------------------------------------*/
+static void
+mem_cob_buffers_free (
+	CsmgrdT_Content_Entry* cob
+) {
+	free (cob->msg);
+	free (cob->name);
+	if (cob->ver_len) {
+		free (cob->version);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Tells the cache algorithm library that the cached entry hits
+----------------------------------------------------------------------------------------*/
+static void
+mem_algo_hit (
+	CsmgrdT_Content_Mem_Entry* entry,
+	unsigned char* key,
+	int key_len
+) {
+	/* The caller holds the shard lock, so the library cannot release the 	*/
+	/* handle of the entry meanwhile 										*/
+	if (hdl->algo_apis.hit_by_handle) {
+		pthread_mutex_lock (&mem_algo_mutex);
+		(*(hdl->algo_apis.hit_by_handle))(entry->algo_h);
+		pthread_mutex_unlock (&mem_algo_mutex);
+	} else if (hdl->algo_apis.hit) {
+		pthread_mutex_lock (&mem_algo_mutex);
+		(*(hdl->algo_apis.hit))(key, key_len);
+		pthread_mutex_unlock (&mem_algo_mutex);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Tells the cache algorithm library that the entry has been removed
+----------------------------------------------------------------------------------------*/
+static void
+mem_algo_erase (
+	CsmgrdT_Content_Mem_Entry* entry,			/* Removed entry, or NULL if the entry	*/
+												/* has not been found					*/
+	unsigned char* key,
+	int key_len
+) {
+	if (entry && hdl->algo_apis.erase_by_handle) {
+		pthread_mutex_lock (&mem_algo_mutex);
+		(*(hdl->algo_apis.erase_by_handle))(entry->algo_h);
+		pthread_mutex_unlock (&mem_algo_mutex);
+	} else if (hdl->algo_apis.erase) {
+		pthread_mutex_lock (&mem_algo_mutex);
+		(*(hdl->algo_apis.erase))(key, key_len);
+		pthread_mutex_unlock (&mem_algo_mutex);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Passes the Cob to the cache algorithm library, which stores it via mem_cs_store
+----------------------------------------------------------------------------------------*/
+static void
+mem_algo_insert (
+	CsmgrdT_Content_Entry* cob
+) {
+	/* The store and remove APIs called back from the library run under 	*/
+	/* the mutex, and they do not take it again 							*/
+	pthread_mutex_lock (&mem_algo_mutex);
+	(*(hdl->algo_apis.insert))(cob);
+	pthread_mutex_unlock (&mem_algo_mutex);
+}
+/*--------------------------------------------------------------------------------------
+	Tells the cache algorithm library that the lookup has failed
+----------------------------------------------------------------------------------------*/
+static void
+mem_algo_miss (
+	unsigned char* key,
+	int key_len
+) {
+	if (hdl->algo_apis.miss) {
+		pthread_mutex_lock (&mem_algo_mutex);
+		(*(hdl->algo_apis.miss))(key, key_len);
+		pthread_mutex_unlock (&mem_algo_mutex);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the usage of the memory
+----------------------------------------------------------------------------------------*/
+static int										/* Returns a negative value if it fails	*/
+mem_cache_mem_stat_get (
+	CsmgrdT_Mem_Stat* stat
+) {
+	MemT_Slab_Class* cls;
+	int i;
+
+	memset (stat, 0, sizeof (CsmgrdT_Mem_Stat));
+	if ((hdl == NULL) || (mem_hash_tbl == NULL)) {
+		return (-1);
+	}
+
+	pthread_mutex_lock (&mem_slab_mutex);
+	for (i = 0 ; i < mem_slab_class_num ; i++) {
+		cls = &mem_slab_class[i];
+		stat->entry_bytes 	+= cls->req_bytes;
+		stat->block_bytes 	+= cls->obj_inuse * cls->obj_size;
+		stat->slab_num 		+= cls->slab_num;
+		stat->slab_bytes 	+= cls->slab_num * cls->slab_size;
+	}
+	stat->entry_bytes 	+= mem_large_bytes;
+	stat->block_bytes 	+= mem_large_bytes;
+	stat->large_bytes 	 = mem_large_bytes;
+	pthread_mutex_unlock (&mem_slab_mutex);
+
+	stat->cob_num 		= hdl->cache_cobs;
+	stat->index_bytes 	= sizeof (CefT_Mem_Hash)
+							+ (uint64_t) mem_hash_tbl->tabl_max * sizeof (CsmgrdT_Content_Mem_Entry*);
+
+	return (1);
+}
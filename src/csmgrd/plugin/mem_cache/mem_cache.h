@@ -65,6 +65,8 @@ typedef struct {
 												/* by algorithm							*/
 	int				algo_cob_size;				/* average Cob size of Cob processed 	*/
                                   				/* by algorithm							*/
+	int				algo_chunk_aware;			/* algorithm treats the chunks of a		*/
+												/* content as one entry					*/
 	uint64_t 	 	cache_capacity;				/* size of cache capacity				*/
 	
 } MemT_Config_Param;
@@ -77,6 +79,8 @@ typedef struct {
 												/* by algorithm							*/
 	int				algo_cob_size;				/* average Cob size of Cob processed 	*/
                                   				/* by algorithm							*/
+	int				algo_chunk_aware;			/* algorithm treats the chunks of a		*/
+												/* content as one entry					*/
 	int 			cache_capacity;				/* size of cache table 					*/
 	
 	/********** cache algorithm library **********/
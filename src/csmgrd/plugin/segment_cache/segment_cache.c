@@ -0,0 +1,1879 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * segment_cache.c
+ */
+#define __CSMGRD_SEGMENT_CACHE_SOURCE__
+
+/*
+	segment_cache.c is a log-structured cache. The Cobs are appended to the
+	preallocated segment files, and are located with the index from name and
+	chunk number to the segment and offset. The space is reclaimed by segment:
+	the oldest segment is evicted as a whole when no free segment is left, and
+	the segments which hold many deleted records are compacted lazily.
+*/
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <dirent.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include "segment_cache.h"
+#include <cefore/cef_client.h>
+#include <cefore/cef_csmgr.h>
+#include <cefore/cef_frame.h>
+#include <csmgrd/csmgrd_plugin.h>
+#include <cefore/cef_pthread.h>
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define SegC_Max_Buff 				4
+#define SegC_SEMNAME				"/cefsegsem"
+
+#define SegC_Dir_Name				"csmgr_seg"
+#define SegC_Index_File				"segment.idx"
+#define SegC_Rec_Magic				0x43534547		/* "CSEG"							*/
+#define SegC_Idx_Magic				0x43534958		/* "CSIX"							*/
+#define SegC_Idx_Version			1
+
+#define SegC_Chunk_Len				8				/* Length of the chunk number TLV	*/
+#define SegC_Rec_Align				8				/* Records are aligned to 8 bytes	*/
+#define SegC_Rec_Max				\
+	(sizeof (SegT_Rec_Head) + CsmgrdC_Key_Max + CefC_Max_Length + CefC_Max_Msg_Size + SegC_Rec_Align)
+#define SegC_Wbuf_Size				(1024 * 1024)	/* Appended records written at once	*/
+#define SegC_Lock_Cobs				256				/* Cobs written per write lock		*/
+#define SegC_Compact_Ratio			50				/* Dead bytes (%) to be compacted	*/
+#define SegC_Hash_Min				1024
+#define SegC_Hash_Max				(1 << 24)
+
+#define SegC_State_Free				0				/* Not used							*/
+#define SegC_State_Active			1				/* Records are appended				*/
+#define SegC_State_Sealed			2				/* Full, and only read				*/
+#define SegC_State_Reclaim			3				/* Being evicted or compacted		*/
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/********** Head of a record in the segment file ***********/
+/* The head is followed by the key (name and chunk number), the version and the Cob 	*/
+typedef struct {
+	uint32_t		magic;						/* SegC_Rec_Magic						*/
+	uint16_t		key_len;					/* Length of the key					*/
+	uint16_t		ver_len;					/* Length of the version				*/
+	uint16_t		msg_len;					/* Length of the Cob					*/
+	uint16_t		pay_len;					/* Payload length						*/
+	uint32_t		chunk_num;					/* Chunk number							*/
+	uint64_t		cache_time;					/* Cache time							*/
+	uint64_t		expiry;						/* Expiry								*/
+} SegT_Rec_Head;
+
+/********** Index entry of a cached Cob ***********/
+typedef struct SegT_Entry {
+	struct SegT_Entry*	hash_next;				/* Next entry in the same bucket		*/
+	struct SegT_Entry*	seg_prev;				/* Entries in the same segment			*/
+	struct SegT_Entry*	seg_next;
+	uint64_t		offset;						/* Offset of the record in the segment	*/
+	uint64_t		cache_time;					/* Cache time							*/
+	uint64_t		expiry;						/* Expiry								*/
+	uint64_t		gen;						/* Generation when the entry was added	*/
+	uint32_t		hash;						/* Hash value of the key				*/
+	uint32_t		rec_len;					/* Length of the record					*/
+	uint32_t		chunk_num;					/* Chunk number							*/
+	uint16_t		seg_index;					/* Segment which the record is in		*/
+	uint16_t		key_len;					/* Length of the key					*/
+	uint16_t		ver_len;					/* Length of the version				*/
+	uint16_t		msg_len;					/* Length of the Cob					*/
+	uint16_t		pay_len;					/* Payload length						*/
+	unsigned char	key[];						/* Name and chunk number				*/
+} SegT_Entry;
+
+/********** Segment file ***********/
+typedef struct {
+	int				fd;							/* FD of the segment file				*/
+	int				state;						/* SegC_State_XXX						*/
+	uint64_t		wr_off;						/* Offset to append the next record		*/
+	uint64_t		dead_bytes;					/* Bytes of the deleted records			*/
+	uint64_t		seal_seq;					/* Order in which segments were sealed	*/
+	uint32_t		live_num;					/* Number of the cached records			*/
+	SegT_Entry*		entries;					/* Entries of the cached records		*/
+} SegT_Segment;
+
+/********** Persisted index ***********/
+typedef struct {
+	uint32_t		magic;						/* SegC_Idx_Magic						*/
+	uint32_t		version;					/* SegC_Idx_Version						*/
+	uint64_t		segment_size;				/* Size of a segment file				*/
+	uint32_t		segment_num;				/* Number of segment files				*/
+	int32_t			active;						/* Segment which records are appended to	*/
+	uint64_t		seal_seq;					/* Last sealed order					*/
+	uint64_t		entry_num;					/* Number of the following entries		*/
+} SegT_Idx_Head;
+
+typedef struct {
+	uint64_t		wr_off;
+	uint64_t		seal_seq;
+	uint32_t		state;
+	uint32_t		reserved;
+} SegT_Idx_Seg;
+
+typedef struct {
+	uint64_t		offset;
+	uint32_t		rec_len;
+	uint16_t		seg_index;
+	uint16_t		reserved;
+} SegT_Idx_Rec;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static SegT_Cache_Handle* 		hdl = NULL;
+static char 					csmgr_conf_dir[PATH_MAX] = {"/usr/local/cefore"};
+static pthread_mutex_t 			seg_comn_buff_mutex[SegC_Max_Buff];
+static sem_t*					seg_comn_buff_sem;
+static pthread_t				seg_thread_th;
+static int 						seg_thread_f = 0;
+static CsmgrdT_Content_Entry* 	seg_proc_cob_buff[SegC_Max_Buff]		= {0};
+static int 						seg_proc_cob_buff_idx[SegC_Max_Buff] 	= {0};
+static CsmgrT_Stat_Handle 		csmgr_stat_hdl;
+
+/* Lookups hold the lock for reading, and the others hold it for writing 	*/
+static pthread_rwlock_t 		seg_cs_lock;
+
+static SegT_Entry**				seg_hash_tbl = NULL;
+static uint32_t					seg_hash_mask = 0;
+static SegT_Segment*			seg_segments = NULL;
+static int						seg_active = -1;			/* -1 if no segment is active	*/
+static uint64_t					seg_seal_seq = 0;
+static unsigned char*			seg_wbuf = NULL;			/* Records not written yet		*/
+static uint32_t					seg_wbuf_len = 0;
+static uint64_t					seg_wbuf_off = 0;			/* Offset of seg_wbuf in segment	*/
+static unsigned char*			seg_rec_buff = NULL;		/* Work buffer to move records	*/
+static uint64_t					seg_entry_gen = 0;			/* Generation of the last entry	*/
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Init content store
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_cs_create (
+	CsmgrT_Stat_Handle stat_hdl, int
+);
+/*--------------------------------------------------------------------------------------
+	Destroy content store
+----------------------------------------------------------------------------------------*/
+static void
+seg_cs_destroy (
+	int		Last_Node_f
+);
+/*--------------------------------------------------------------------------------------
+	Check content expire
+----------------------------------------------------------------------------------------*/
+static void
+seg_cs_expire_check (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Function to read a ContentObject from Segment Cache
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_cache_item_get (
+	unsigned char* key,							/* content name							*/
+	uint16_t key_size,							/* content name Length					*/
+	uint32_t seqno,								/* chunk num							*/
+	int sock,									/* received socket						*/
+	unsigned char* version,						/* version								*/
+	uint16_t ver_len,							/* length of version					*/
+	unsigned char* csact_val,					/* Plain Text							*/
+	uint16_t csact_len,							/* length of Plain Text					*/
+	unsigned char* signature_val,				/* signature							*/
+	uint16_t signature_len						/* length of signature					*/
+);
+/*--------------------------------------------------------------------------------------
+	Upload content byte steream
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_cache_item_puts (
+	unsigned char* msg,
+	int msg_len
+);
+/*--------------------------------------------------------------------------------------
+	function for processing the received message
+----------------------------------------------------------------------------------------*/
+static void*
+seg_cob_process_thread (
+	void* arg
+);
+/*--------------------------------------------------------------------------------------
+	writes the cobs to segment cache
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_cache_cob_write (
+	CsmgrdT_Content_Entry* cobs,
+	int cob_num
+);
+/*--------------------------------------------------------------------------------------
+	Read config file
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_config_read (
+	SegT_Config_Param* conf_param				/* Segment cache config parameter		*/
+);
+/*--------------------------------------------------------------------------------------
+	Function to increment access count
+----------------------------------------------------------------------------------------*/
+static void
+seg_cs_ac_cnt_inc (
+	unsigned char* key,							/* content name							*/
+	uint16_t key_size,							/* content name Length					*/
+	uint32_t seq_num							/* sequence number						*/
+);
+/*--------------------------------------------------------------------------------------
+	get lifetime for ccninfo
+----------------------------------------------------------------------------------------*/
+static int										/* This value MAY be -1 if the router does not know or cannot report. */
+seg_cache_lifetime_get (
+	unsigned char* name,						/* content name							*/
+	uint16_t name_len,							/* content name Length					*/
+	uint32_t* cache_time,						/* The elapsed time (seconds) after the oldest	*/
+												/* content object of the content is cached.		*/
+	uint32_t* lifetime,							/* The lifetime (seconds) of a content object, 	*/
+												/* which is removed first among the cached content objects.*/
+	uint8_t partial_f							/* when flag is 0, exact match			*/
+												/* when flag is 1, partial match		*/
+);
+/*--------------------------------------------------------------------------------------
+	Index APIs for Segment Cache Plugin
+----------------------------------------------------------------------------------------*/
+static uint32_t
+seg_hash_number_create (
+	const unsigned char* key,
+	uint32_t klen
+);
+static SegT_Entry*
+seg_entry_lookup (
+	const unsigned char* key,
+	uint32_t klen
+);
+static void
+seg_entry_link (
+	SegT_Entry* entry,
+	int seg_index
+);
+static void
+seg_entry_unlink (
+	SegT_Entry* entry
+);
+static void
+seg_entry_remove (
+	SegT_Entry* entry
+);
+static void
+seg_content_drop (
+	CsmgrT_Stat* rcd
+);
+/*--------------------------------------------------------------------------------------
+	Segment APIs for Segment Cache Plugin
+----------------------------------------------------------------------------------------*/
+static unsigned char*				/* Area of the record, or NULL if it fails			*/
+seg_record_reserve (
+	uint32_t rec_len,
+	int* seg_index,
+	uint64_t* offset
+);
+static void
+seg_wbuf_flush (
+	void
+);
+static int							/* The return value is negative if an error occurs	*/
+seg_segment_rotate (
+	void
+);
+static void
+seg_segment_evict (
+	int seg_index
+);
+static void
+seg_segment_compact (
+	void
+);
+static int							/* The return value is negative if an error occurs	*/
+seg_segment_files_open (
+	void
+);
+static void
+seg_segment_files_close (
+	int remove_f
+);
+/*--------------------------------------------------------------------------------------
+	Persisted index APIs for Segment Cache Plugin
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_index_save (
+	void
+);
+static int							/* Number of the loaded entries, or negative value	*/
+seg_index_load (
+	void
+);
+
+/****************************************************************************************
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Road the cache plugin
+----------------------------------------------------------------------------------------*/
+int
+csmgrd_segment_plugin_load (
+	CsmgrdT_Plugin_Interface* cs_in,
+	const char* config_dir
+) {
+	CSMGRD_SET_CALLBACKS (
+		seg_cs_create, seg_cs_destroy, seg_cs_expire_check, seg_cache_item_get,
+		seg_cache_item_puts, seg_cs_ac_cnt_inc, seg_cache_lifetime_get);
+
+	if (config_dir) {
+		strcpy (csmgr_conf_dir, config_dir);
+	}
+
+	/* Init logging 	*/
+	csmgrd_log_init ("segment", 1);
+	csmgrd_log_init2 (csmgr_conf_dir);
+#ifdef CefC_Debug
+	csmgrd_dbg_init ("segment", csmgr_conf_dir);
+#endif // CefC_Debug
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Init API
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_cs_create (
+	CsmgrT_Stat_Handle stat_hdl, int first_node_f
+) {
+	SegT_Config_Param conf_param;
+	pthread_rwlockattr_t attr;
+	uint64_t hash_size;
+	int res, i;
+
+	/* create handle 		*/
+	if (hdl != NULL) {
+		free (hdl);
+		hdl = NULL;
+	}
+
+	hdl = (SegT_Cache_Handle*) malloc (sizeof (SegT_Cache_Handle));
+	if (hdl == NULL) {
+		csmgrd_log_write (CefC_Log_Error, "malloc error\n");
+		return (-1);
+	}
+	memset (hdl, 0, sizeof (SegT_Cache_Handle));
+	csmgr_stat_hdl = stat_hdl;
+
+	/* Reads config 		*/
+	if (seg_config_read (&conf_param) < 0) {
+		csmgrd_log_write (CefC_Log_Error, "[%s] read config\n", __func__);
+		return (-1);
+	}
+	strcpy (hdl->seg_root_path, conf_param.seg_root_path);
+	hdl->cache_capacity = conf_param.cache_capacity;
+	hdl->segment_size 	= conf_param.segment_size;
+	hdl->segment_num 	= conf_param.segment_num;
+	hdl->index_persist 	= conf_param.index_persist;
+	hdl->cache_cobs = 0;
+
+	pthread_rwlockattr_init (&attr);
+#ifndef __APPLE__
+	/* The Cob put thread must not starve behind the lookups 	*/
+	pthread_rwlockattr_setkind_np (&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif // __APPLE__
+	pthread_rwlock_init (&seg_cs_lock, &attr);
+	pthread_rwlockattr_destroy (&attr);
+
+	/* Creates the index 		*/
+	hash_size = SegC_Hash_Min;
+	while (hash_size < hdl->cache_capacity && hash_size < SegC_Hash_Max) {
+		hash_size <<= 1;
+	}
+	seg_hash_tbl = (SegT_Entry**) calloc (hash_size, sizeof (SegT_Entry*));
+	seg_segments = (SegT_Segment*) calloc (hdl->segment_num, sizeof (SegT_Segment));
+	seg_wbuf 	 = (unsigned char*) malloc (SegC_Wbuf_Size);
+	seg_rec_buff = (unsigned char*) malloc (SegC_Rec_Max);
+	if (!seg_hash_tbl || !seg_segments || !seg_wbuf || !seg_rec_buff) {
+		csmgrd_log_write (CefC_Log_Error, "Unable to create the segment cache index\n");
+		return (-1);
+	}
+	seg_hash_mask = (uint32_t)(hash_size - 1);
+	for (i = 0 ; i < hdl->segment_num ; i++) {
+		seg_segments[i].fd = -1;
+	}
+
+	/* Creates the segment files 		*/
+	if (seg_segment_files_open () < 0) {
+		return (-1);
+	}
+	csmgrd_log_write (CefC_Log_Info,
+		"Creation the segment files (%s, %d x "FMTU64" bytes) ... OK\n",
+		hdl->seg_cache_path, hdl->segment_num, hdl->segment_size);
+
+	for (i = 0 ; i < SegC_Max_Buff ; i++) {
+		seg_proc_cob_buff[i] = (CsmgrdT_Content_Entry*)
+			malloc (sizeof (CsmgrdT_Content_Entry) * CsmgrC_Buff_Num);
+		if (seg_proc_cob_buff[i] == NULL) {
+			csmgrd_log_write (CefC_Log_Error,
+				"Failed to allocation process cob buffer\n");
+			return (-1);
+		}
+		seg_proc_cob_buff_idx[i] = 0;
+		pthread_mutex_init (&seg_comn_buff_mutex[i], NULL);
+	}
+	seg_comn_buff_sem = sem_open (SegC_SEMNAME, O_CREAT | O_EXCL, 0777, 0);
+	if (seg_comn_buff_sem == SEM_FAILED && errno == EEXIST) {
+		sem_unlink (SegC_SEMNAME);
+		seg_comn_buff_sem = sem_open (SegC_SEMNAME, O_CREAT | O_EXCL, 0777, 0);
+	}
+	if (seg_comn_buff_sem == SEM_FAILED) {
+		csmgrd_log_write (CefC_Log_Error, "Failed to create the new semaphore\n");
+		return (-1);
+	}
+
+	if (cef_pthread_create (&seg_thread_th, NULL, seg_cob_process_thread, hdl) == -1) {
+		csmgrd_log_write (CefC_Log_Error, "Failed to create the new thread\n");
+		return (-1);
+	}
+
+	csmgrd_log_write (CefC_Log_Info, "Start\n");
+	csmgrd_log_write (CefC_Log_Info, "Cache Capacity : "FMTU64"\n", hdl->cache_capacity);
+	csmgrd_log_write (CefC_Log_Info, "Index Persist  : %s\n", hdl->index_persist ? "Yes" : "No");
+
+	csmgrd_stat_cache_capacity_update (csmgr_stat_hdl, hdl->cache_capacity);
+
+	/* Restores the index saved at the last shutdown. This must follow the 	*/
+	/* capacity update, which clears the content information.				*/
+	if (hdl->index_persist) {
+		pthread_rwlock_wrlock (&seg_cs_lock);
+		res = seg_index_load ();
+		pthread_rwlock_unlock (&seg_cs_lock);
+		if (res >= 0) {
+			csmgrd_log_write (CefC_Log_Info, "Index : %d cobs are restored\n", res);
+		}
+	}
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	function for processing the received message
+----------------------------------------------------------------------------------------*/
+static void*
+seg_cob_process_thread (
+	void* arg
+) {
+	int i;
+
+	seg_thread_f = 1;
+
+	while (seg_thread_f) {
+		sem_wait (seg_comn_buff_sem);
+		if (!seg_thread_f)
+			break;
+		for (i = 0 ; i < SegC_Max_Buff ; i++) {
+			if (pthread_mutex_trylock (&seg_comn_buff_mutex[i]) != 0) {
+				continue;
+			}
+			if (seg_proc_cob_buff_idx[i] > 0) {
+#ifdef CefC_Debug
+				csmgrd_dbg_write (CefC_Dbg_Fine,
+					"cob put thread starts to write %d cobs\n", seg_proc_cob_buff_idx[i]);
+#endif // CefC_Debug
+				seg_cache_cob_write (&seg_proc_cob_buff[i][0], seg_proc_cob_buff_idx[i]);
+				seg_proc_cob_buff_idx[i] = 0;
+#ifdef CefC_Debug
+				csmgrd_dbg_write (CefC_Dbg_Fine,
+					"cob put thread completed writing cobs\n");
+#endif // CefC_Debug
+			}
+			pthread_mutex_unlock (&seg_comn_buff_mutex[i]);
+		}
+	}
+
+#ifdef CefC_Debug
+	csmgrd_dbg_write (CefC_Dbg_Fine, "%s terminate.\n", __func__);
+#endif // CefC_Debug
+
+	pthread_exit (NULL);
+
+	return ((void*) NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Destroy content store
+----------------------------------------------------------------------------------------*/
+static void
+seg_cs_destroy (
+	int		Last_Node_f
+) {
+	SegT_Entry* entry;
+	SegT_Entry* next;
+	void* status;
+	uint32_t n;
+	int i;
+
+	if (seg_thread_f) {
+		seg_thread_f = 0;
+		sem_post (seg_comn_buff_sem);	/* To avoid deadlock */
+		pthread_join (seg_thread_th, &status);
+	}
+	sem_close (seg_comn_buff_sem);
+	sem_unlink (SegC_SEMNAME);
+
+	for (i = 0 ; i < SegC_Max_Buff ; i++) {
+		if (seg_proc_cob_buff[i]) {
+			free (seg_proc_cob_buff[i]);
+			seg_proc_cob_buff[i] = NULL;
+		}
+		pthread_mutex_destroy (&seg_comn_buff_mutex[i]);
+	}
+
+	if (hdl == NULL) {
+		return;
+	}
+
+	pthread_rwlock_wrlock (&seg_cs_lock);
+	if (seg_segments) {
+		seg_wbuf_flush ();
+		if (hdl->index_persist && seg_hash_tbl) {
+			if (seg_index_save () < 0) {
+				csmgrd_log_write (CefC_Log_Warn, "Failed to save the index\n");
+			}
+		}
+		seg_segment_files_close (!hdl->index_persist);
+		free (seg_segments);
+		seg_segments = NULL;
+	}
+	if (seg_hash_tbl) {
+		for (n = 0 ; n <= seg_hash_mask ; n++) {
+			for (entry = seg_hash_tbl[n] ; entry ; entry = next) {
+				next = entry->hash_next;
+				free (entry);
+			}
+		}
+		free (seg_hash_tbl);
+		seg_hash_tbl = NULL;
+	}
+	if (seg_wbuf) {
+		free (seg_wbuf);
+		seg_wbuf = NULL;
+	}
+	if (seg_rec_buff) {
+		free (seg_rec_buff);
+		seg_rec_buff = NULL;
+	}
+	pthread_rwlock_unlock (&seg_cs_lock);
+	pthread_rwlock_destroy (&seg_cs_lock);
+
+	free (hdl);
+	hdl = NULL;
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Check content expire
+----------------------------------------------------------------------------------------*/
+static void
+seg_cs_expire_check (
+	void
+) {
+	CsmgrT_Stat* 	rcd = NULL;
+	int 			index = 0;
+
+	if (pthread_rwlock_trywrlock (&seg_cs_lock) != 0) {
+		return;
+	}
+	while (1) {
+		rcd = csmgrd_stat_expired_content_info_get (csmgr_stat_hdl, &index);
+		if (!rcd) {
+			break;
+		}
+		seg_content_drop (rcd);
+	}
+
+	/* Reclaims the space of the deleted records while the lookups wait anyway 	*/
+	seg_segment_compact ();
+	pthread_rwlock_unlock (&seg_cs_lock);
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Function to read a ContentObject from segment cache
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_cache_item_get (
+	unsigned char* key,							/* content name							*/
+	uint16_t key_size,							/* content name Length					*/
+	uint32_t seqno,								/* chunk num							*/
+	int sock,									/* received socket						*/
+	unsigned char* version,						/* version								*/
+	uint16_t ver_len,							/* length of version					*/
+	unsigned char* csact_val,					/* Plain Text							*/
+	uint16_t csact_len,							/* length of Plain Text					*/
+	unsigned char* signature_val,				/* signature							*/
+	uint16_t signature_len						/* length of signature					*/
+) {
+	CsmgrT_Stat* 	rcd;
+	SegT_Entry* 	entry;
+	unsigned char 	trg_key[CsmgrdC_Key_Max];
+	int 			trg_key_len;
+	unsigned char 	msg[CefC_Max_Msg_Size];
+	unsigned char 	cob_ver[CefC_Max_Length];
+	uint16_t 		cob_ver_len = 0;
+	uint16_t 		msg_len = 0;
+	uint64_t 		cache_time = 0;
+	uint64_t 		expiry = 0;
+	uint64_t 		gen = 0;
+	uint64_t 		nowt;
+	struct timeval 	tv;
+	int 			exist_f = CefC_Csmgr_Cob_NotExist;
+	int				rc;
+
+	if (key_size + SegC_Chunk_Len > CsmgrdC_Key_Max) {
+		return (CefC_Csmgr_Cob_NotExist);
+	}
+	trg_key_len = csmgrd_name_chunknum_concatenate (key, key_size, seqno, trg_key);
+
+	pthread_rwlock_rdlock (&seg_cs_lock);
+
+	/* Obtain the information of the specified content 		*/
+	rcd = csmgrd_stat_content_info_access (csmgr_stat_hdl, key, key_size);
+	if (!rcd || rcd->expire_f) {
+		/* The expired content is removed by seg_cs_expire_check 	*/
+		goto CobNotExist;
+	}
+	rc = cef_csmgr_cache_version_compare (version, ver_len, rcd->version, rcd->ver_len);
+	if (rc == CefC_CV_Inconsistent) {
+		if (!(ver_len == 0 && rcd->ver_len != 0)) {
+			goto CobNotExist;
+		}
+		/* Request is "None", so any version is OK */
+	} else if (rc != CefC_CV_Same) {
+		goto CobNotExist;
+	}
+
+	entry = seg_entry_lookup (trg_key, trg_key_len);
+	if (entry == NULL) {
+		goto CobNotExist;
+	}
+	gettimeofday (&tv, NULL);
+	nowt = tv.tv_sec * 1000000llu + tv.tv_usec;
+	if (((entry->expiry != 0) && (entry->expiry < nowt)) || (entry->cache_time < nowt)) {
+		goto CobNotExist;
+	}
+
+	/* Reads the Cob from the segment file 		*/
+	if (pread (seg_segments[entry->seg_index].fd, msg, entry->msg_len,
+			(off_t)(entry->offset + sizeof (SegT_Rec_Head) + entry->key_len + entry->ver_len))
+				!= entry->msg_len) {
+#ifdef CefC_Debug
+		csmgrd_dbg_write (CefC_Dbg_Finer,
+			"Failed to read the request chunk (segment=%d, chunk_num=%u)\n",
+			entry->seg_index, seqno);
+#endif // CefC_Debug
+		goto CobNotExist;
+	}
+	csmgrd_stat_access_count_update (csmgr_stat_hdl, key, key_size);
+
+	/* The sending may wait for cefnetd, so the Cob is sent after the lock 	*/
+	/* is released. The Cob has been copied into msg by the pread above 	*/
+	cob_ver_len = rcd->ver_len;
+	if (cob_ver_len) {
+		memcpy (cob_ver, rcd->version, cob_ver_len);
+	}
+	msg_len 	= entry->msg_len;
+	cache_time 	= entry->cache_time;
+	expiry 		= entry->expiry;
+	gen 		= entry->gen;
+	exist_f 	= CefC_Csmgr_Cob_Exist;
+
+CobNotExist:;
+	pthread_rwlock_unlock (&seg_cs_lock);
+
+	if (exist_f == CefC_Csmgr_Cob_Exist) {
+		/* Send Cob to cefnetd */
+		csmgrd_plugin_cob_msg_send (sock, msg, msg_len);
+
+		/* Later Interests for the hit Cob are served by cefnetd from the index */
+		cef_csmgr_shm_publish (trg_key, trg_key_len, cob_ver, cob_ver_len,
+			msg, msg_len, cache_time, expiry);
+
+		/* The entry may have been removed or replaced before it was published, 	*/
+		/* and its removal has invalidated the index before the publication 		*/
+		pthread_rwlock_rdlock (&seg_cs_lock);
+		entry = seg_entry_lookup (trg_key, trg_key_len);
+		if ((entry == NULL) || (entry->gen != gen)) {
+			cef_csmgr_shm_invalidate (trg_key, trg_key_len);
+		}
+		pthread_rwlock_unlock (&seg_cs_lock);
+	}
+
+	return (exist_f);
+}
+/*--------------------------------------------------------------------------------------
+	Upload content byte steream
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_cache_item_puts (
+	unsigned char* msg,
+	int msg_len
+) {
+	CsmgrdT_Content_Entry entry;
+	int i;
+	int res;
+	int index = 0;
+	int write_f = 0;
+
+#ifdef CefC_Debug
+	csmgrd_dbg_write (CefC_Dbg_Fine, "cob rcv thread receives %d bytes\n", msg_len);
+#endif // CefC_Debug
+
+	for (i = 0 ; i < SegC_Max_Buff ; i++) {
+
+		if (pthread_mutex_trylock (&seg_comn_buff_mutex[i]) != 0) {
+			continue;
+		}
+
+		if (seg_proc_cob_buff_idx[i] == 0) {
+			while (index < msg_len) {
+				res = cef_csmgr_con_entry_create (&msg[index], msg_len - index, &entry);
+
+				if (res < 0) {
+					break;
+				}
+				memcpy (
+					&seg_proc_cob_buff[i][seg_proc_cob_buff_idx[i]],
+					&entry,
+					sizeof (CsmgrdT_Content_Entry));
+
+				seg_proc_cob_buff_idx[i] += 1;
+				index += res;
+
+				if (seg_proc_cob_buff_idx[i] + 1 == CsmgrC_Buff_Num) {
+					break;
+				}
+			}
+		}
+
+		if (seg_proc_cob_buff_idx[i] > 0)
+			write_f++;
+		pthread_mutex_unlock (&seg_comn_buff_mutex[i]);
+
+		if (index >= msg_len) {
+			break;
+		}
+	}
+	if (write_f > 0)
+		sem_post (seg_comn_buff_sem);
+
+#ifdef CefC_Debug
+	if (i == SegC_Max_Buff) {
+		csmgrd_dbg_write (CefC_Dbg_Fine,
+			"cob rcv thread lost %d bytes\n", msg_len - index);
+	}
+#endif // CefC_Debug
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	writes the cobs to segment cache
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_cache_cob_write (
+	CsmgrdT_Content_Entry* cobs,
+	int cob_num
+) {
+	CsmgrdT_Content_Entry* cob;
+	CsmgrT_Stat* 	rcd;
+	SegT_Entry* 	entry;
+	SegT_Rec_Head	head;
+	unsigned char 	trg_key[CsmgrdC_Key_Max];
+	int 			trg_key_len;
+	unsigned char*	rec;
+	uint32_t		rec_len;
+	int				seg_index;
+	uint64_t		offset;
+	uint64_t 		nowt;
+	struct timeval 	tv;
+	int				index;
+	int				locked_cobs = 0;
+	int				rc;
+
+	gettimeofday (&tv, NULL);
+	nowt = tv.tv_sec * 1000000llu + tv.tv_usec;
+
+	for (index = 0 ; index < cob_num ; index++) {
+		cob = &cobs[index];
+
+		if (locked_cobs == 0) {
+			pthread_rwlock_wrlock (&seg_cs_lock);
+		}
+		locked_cobs++;
+
+		if (!seg_thread_f || (cob->expiry < nowt) ||
+			(cob->name_len + SegC_Chunk_Len > CsmgrdC_Key_Max)) {
+			goto NEXTCOB;
+		}
+		trg_key_len = csmgrd_name_chunknum_concatenate (
+						cob->name, cob->name_len, cob->chunk_num, trg_key);
+
+		/* Checks the version of the cached content 		*/
+		rcd = csmgrd_stat_content_info_access (csmgr_stat_hdl, cob->name, cob->name_len);
+		if (rcd && rcd->expire_f) {
+			seg_content_drop (rcd);
+			rcd = NULL;
+		}
+		if (rcd) {
+			rc = cef_csmgr_cache_version_compare (
+					cob->version, cob->ver_len, rcd->version, rcd->ver_len);
+			if (rc == CefC_CV_Newest_1stArg) {
+				/* Deletes the older version of the content 	*/
+				seg_content_drop (rcd);
+			} else if (rc == CefC_CV_Same) {
+				entry = seg_entry_lookup (trg_key, trg_key_len);
+				if (entry) {
+					/* cached yet */
+					goto NEXTCOB;
+				}
+			} else {
+				goto NEXTCOB;
+			}
+		}
+
+		/* Evicts the oldest segment when the capacity is reached 		*/
+		if (hdl->cache_cobs >= hdl->cache_capacity) {
+			int i, trg = -1;
+			for (i = 0 ; i < hdl->segment_num ; i++) {
+				if ((seg_segments[i].state == SegC_State_Sealed) &&
+					((trg < 0) || (seg_segments[i].seal_seq < seg_segments[trg].seal_seq))) {
+					trg = i;
+				}
+			}
+			if (trg < 0) {
+				goto NEXTCOB;
+			}
+			seg_segment_evict (trg);
+		}
+
+		/* Appends the record to the active segment 		*/
+		rec_len = sizeof (SegT_Rec_Head) + trg_key_len + cob->ver_len + cob->msg_len;
+		rec_len = (rec_len + SegC_Rec_Align - 1) & ~(SegC_Rec_Align - 1);
+		rec = seg_record_reserve (rec_len, &seg_index, &offset);
+		if (rec == NULL) {
+			goto NEXTCOB;
+		}
+		memset (&head, 0, sizeof (SegT_Rec_Head));
+		head.magic 		= SegC_Rec_Magic;
+		head.key_len 	= (uint16_t) trg_key_len;
+		head.ver_len 	= cob->ver_len;
+		head.msg_len 	= cob->msg_len;
+		head.pay_len 	= cob->pay_len;
+		head.chunk_num 	= cob->chunk_num;
+		head.cache_time = cob->cache_time;
+		head.expiry 	= cob->expiry;
+		memcpy (rec, &head, sizeof (SegT_Rec_Head));
+		memcpy (&rec[sizeof (SegT_Rec_Head)], trg_key, trg_key_len);
+		if (cob->ver_len) {
+			memcpy (&rec[sizeof (SegT_Rec_Head) + trg_key_len], cob->version, cob->ver_len);
+		}
+		memcpy (&rec[sizeof (SegT_Rec_Head) + trg_key_len + cob->ver_len],
+			cob->msg, cob->msg_len);
+
+		/* Inserts the index entry 		*/
+		entry = (SegT_Entry*) malloc (sizeof (SegT_Entry) + trg_key_len);
+		if (entry == NULL) {
+			seg_segments[seg_index].dead_bytes += rec_len;
+			goto NEXTCOB;
+		}
+		memset (entry, 0, sizeof (SegT_Entry));
+		memcpy (entry->key, trg_key, trg_key_len);
+		entry->key_len 		= (uint16_t) trg_key_len;
+		entry->hash 		= seg_hash_number_create (trg_key, trg_key_len);
+		entry->offset 		= offset;
+		entry->rec_len 		= rec_len;
+		entry->cache_time 	= cob->cache_time;
+		entry->expiry 		= cob->expiry;
+		entry->chunk_num 	= cob->chunk_num;
+		entry->ver_len 		= cob->ver_len;
+		entry->msg_len 		= cob->msg_len;
+		entry->pay_len 		= cob->pay_len;
+		entry->gen 			= ++seg_entry_gen;
+		entry->hash_next 	= seg_hash_tbl[entry->hash & seg_hash_mask];
+		seg_hash_tbl[entry->hash & seg_hash_mask] = entry;
+		seg_entry_link (entry, seg_index);
+		hdl->cache_cobs++;
+
+		/* Updates the content information 			*/
+		csmgrd_stat_cob_update (csmgr_stat_hdl, cob->name, cob->name_len,
+			cob->chunk_num, cob->pay_len, cob->expiry, nowt, cob->node);
+		rcd = csmgrd_stat_content_info_get (csmgr_stat_hdl, cob->name, cob->name_len);
+		if (rcd && cob->ver_len && !rcd->ver_len) {
+			csmgrd_stat_content_info_version_init (
+				csmgr_stat_hdl, rcd, cob->version, cob->ver_len);
+		}
+
+NEXTCOB:
+		free (cob->msg);
+		cob->msg = NULL;
+		free (cob->name);
+		cob->name = NULL;
+		if (cob->ver_len) {
+			free (cob->version);
+		}
+		cob->version = NULL;
+
+		/* Lets the lookups in after a while, with the records written 	*/
+		if ((locked_cobs == SegC_Lock_Cobs) || (index + 1 == cob_num)) {
+			seg_wbuf_flush ();
+			pthread_rwlock_unlock (&seg_cs_lock);
+			locked_cobs = 0;
+		}
+	}
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Function to increment access count
+----------------------------------------------------------------------------------------*/
+static void
+seg_cs_ac_cnt_inc (
+	unsigned char* key,							/* content name							*/
+	uint16_t key_size,							/* content name Length					*/
+	uint32_t seq_num							/* sequence number						*/
+) {
+	SegT_Entry* entry;
+
+	pthread_rwlock_rdlock (&seg_cs_lock);
+	entry = seg_entry_lookup (key, key_size);
+	if (entry) {
+		csmgrd_stat_access_count_update (
+				csmgr_stat_hdl, entry->key, entry->key_len - SegC_Chunk_Len);
+	}
+	pthread_rwlock_unlock (&seg_cs_lock);
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	get lifetime for ccninfo
+----------------------------------------------------------------------------------------*/
+static int										/* This value MAY be -1 if the router does not know or cannot report. */
+seg_cache_lifetime_get (
+	unsigned char* name,						/* content name							*/
+	uint16_t name_len,							/* content name Length					*/
+	uint32_t* cache_time,						/* The elapsed time (seconds) after the oldest	*/
+												/* content object of the content is cached.		*/
+	uint32_t* lifetime,							/* The lifetime (seconds) of a content object, 	*/
+												/* which is removed first among the cached content objects.*/
+	uint8_t partial_f							/* when flag is 0, exact match			*/
+												/* when flag is 1, partial match		*/
+) {
+	CsmgrT_Stat* rcd = NULL;
+	uint64_t nowt;
+	struct timeval tv;
+	uint16_t name_len_wo_chunk;
+	uint32_t seqno = 0;
+
+	*lifetime = 0;
+	*cache_time = 0;
+
+	gettimeofday (&tv, NULL);
+	nowt = tv.tv_sec * 1000000llu + tv.tv_usec;
+
+	if (partial_f == 0) {
+		name_len_wo_chunk = cef_frame_get_name_without_chunkno (name, name_len, &seqno);
+		if (name_len_wo_chunk == 0) {
+			return (-1);
+		}
+		name_len = name_len_wo_chunk;
+	}
+
+	pthread_rwlock_rdlock (&seg_cs_lock);
+	rcd = csmgrd_stat_content_info_get (csmgr_stat_hdl, name, name_len);
+	if (!rcd || rcd->expire_f) {
+		pthread_rwlock_unlock (&seg_cs_lock);
+		return (-1);
+	}
+	*cache_time = (uint32_t)((nowt - rcd->cached_time) / 1000000);
+	if (rcd->expiry < nowt) {
+		*lifetime = 0;
+	} else {
+		*lifetime = (uint32_t)((rcd->expiry - nowt) / 1000000);
+	}
+	pthread_rwlock_unlock (&seg_cs_lock);
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Read config file
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_config_read (
+	SegT_Config_Param* params						/* record parameters				*/
+) {
+	FILE*	fp = NULL;								/* file pointer						*/
+	char	file_name[PATH_MAX];					/* file name						*/
+
+	char	param[4096] = {0};						/* parameter						*/
+	char	param_buff[4096] = {0};					/* param buff						*/
+	int		len;									/* read length						*/
+
+	char*	option;									/* deny option						*/
+	char*	value;									/* parameter						*/
+	int		res;
+
+	int		i, n;
+
+	/* Inits parameters		*/
+	memset (params, 0, sizeof (SegT_Config_Param));
+	strcpy (params->seg_root_path, csmgr_conf_dir);
+	params->cache_capacity = 819200;
+	params->segment_size = 64 * 1024 * 1024;
+	params->segment_num = 16;
+	params->index_persist = 0;
+
+	int sn = snprintf (file_name, sizeof(file_name), "%s/csmgrd.conf", csmgr_conf_dir);
+	if (sn < 0) {
+		csmgrd_log_write (CefC_Log_Error, "[%s] Config file dir path too long(%s)\n", __func__, csmgr_conf_dir);
+		return (-1);
+	}
+
+	/* Opens the config file. */
+	fp = fopen (file_name, "r");
+	if (fp == NULL) {
+		csmgrd_log_write (CefC_Log_Error, "[%s] open %s\n", __func__, file_name);
+		return (-1);
+	}
+
+	/* get parameter	*/
+	while (fgets (param_buff, sizeof (param_buff), fp) != NULL) {
+
+		/* Trims a read line 		*/
+		len = strlen (param_buff);
+		if ((param_buff[0] == '#') || (param_buff[0] == '\n') || (len == 0)) {
+			continue;
+		}
+		if (param_buff[len - 1] == '\n') {
+			param_buff[len - 1] = '\0';
+		}
+		for (i = 0, n = 0 ; i < len ; i++) {
+			if (param_buff[i] != ' ') {
+				param[n] = param_buff[i];
+				n++;
+			}
+		}
+
+		/* Gets option */
+		value 	= param;
+		option 	= strsep (&value, "=");
+
+		if (value == NULL) {
+			continue;
+		}
+
+		/* Records a parameter 			*/
+		if (strcmp (option, "CACHE_PATH") == 0) {
+			if (strlen (value) >= CefC_Csmgr_File_Path_Length) {
+				csmgrd_log_write (
+					CefC_Log_Error, "[%s] Invalid value %s=%s\n", __func__, option, value);
+				fclose (fp);
+				return (-1);
+			}
+			strcpy (params->seg_root_path, value);
+		} else if (strcmp (option, "CACHE_CAPACITY") == 0) {
+			char *endptr = "";
+			params->cache_capacity = strtoul (value, &endptr, 0);
+			if (strcmp (endptr, "") != 0) {
+				csmgrd_log_write (
+					CefC_Log_Error, "[%s] Invalid value %s=%s\n", __func__, option, value);
+				fclose (fp);
+				return (-1);
+			}
+			if ((params->cache_capacity < 1) || (params->cache_capacity > 0xFFFFFFFFF)) {
+				csmgrd_log_write (CefC_Log_Error,
+				"CACHE_CAPACITY must be between 1 and 68,719,476,735 (0xFFFFFFFFF) inclusive.\n");
+				fclose (fp);
+				return (-1);
+			}
+		} else if (strcmp (option, "CACHE_ALGORITHM") == 0) {
+			if (strcmp (value, "None") != 0) {
+				csmgrd_log_write (CefC_Log_Warn,
+					"CACHE_ALGORITHM is ignored, the segment cache evicts the oldest segment.\n");
+			}
+		} else if (strcmp (option, "CACHE_SEGMENT_SIZE") == 0) {
+			res = atoi (value);
+			if ((res < SegC_Segment_Size_Min) || (res > SegC_Segment_Size_Max)) {
+				csmgrd_log_write (CefC_Log_Error,
+					"CACHE_SEGMENT_SIZE must be between %d and %d inclusive.\n",
+					SegC_Segment_Size_Min, SegC_Segment_Size_Max);
+				fclose (fp);
+				return (-1);
+			}
+			params->segment_size = (uint64_t) res * 1024 * 1024;
+		} else if (strcmp (option, "CACHE_SEGMENT_NUM") == 0) {
+			res = atoi (value);
+			if ((res < SegC_Segment_Num_Min) || (res > SegC_Segment_Num_Max)) {
+				csmgrd_log_write (CefC_Log_Error,
+					"CACHE_SEGMENT_NUM must be between %d and %d inclusive.\n",
+					SegC_Segment_Num_Min, SegC_Segment_Num_Max);
+				fclose (fp);
+				return (-1);
+			}
+			params->segment_num = res;
+		} else if (strcmp (option, "CACHE_INDEX_PERSIST") == 0) {
+			res = atoi (value);
+			if ((res != 0) && (res != 1)) {
+				csmgrd_log_write (CefC_Log_Error, "CACHE_INDEX_PERSIST must be 0 or 1.\n");
+				fclose (fp);
+				return (-1);
+			}
+			params->index_persist = res;
+		} else {
+			/* NOP */;
+		}
+	}
+	fclose (fp);
+
+	if (!(    access (params->seg_root_path, F_OK) == 0
+		   && access (params->seg_root_path, R_OK) == 0
+		   && access (params->seg_root_path, W_OK) == 0
+		   && access (params->seg_root_path, X_OK) == 0)) {
+		csmgrd_log_write (CefC_Log_Error,
+			"EXCACHE_PLUGIN (Invalid value CACHE_PATH=%s) - %s\n",
+			params->seg_root_path, strerror (errno));
+		return (-1);
+	}
+#ifdef CefC_Debug
+	csmgrd_dbg_write (CefC_Dbg_Fine, "params->cache_capacity="FMTU64"\n",
+						params->cache_capacity);
+	csmgrd_dbg_write (CefC_Dbg_Fine, "params->segment_size="FMTU64"\n",
+						params->segment_size);
+	csmgrd_dbg_write (CefC_Dbg_Fine, "params->segment_num=%d\n",
+						params->segment_num);
+#endif // CefC_Debug
+
+	return (0);
+}
+
+/****************************************************************************************
+ ****************************************************************************************/
+static uint32_t
+seg_hash_number_create (
+	const unsigned char* key,
+	uint32_t klen
+) {
+	uint32_t hash = 2166136261u;
+	uint32_t i;
+
+	/* FNV-1a 	*/
+	for (i = 0 ; i < klen ; i++) {
+		hash = (hash ^ key[i]) * 16777619u;
+	}
+	return (hash);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the index entry of the specified key
+----------------------------------------------------------------------------------------*/
+static SegT_Entry*
+seg_entry_lookup (
+	const unsigned char* key,
+	uint32_t klen
+) {
+	SegT_Entry* entry;
+	uint32_t hash;
+
+	if (seg_hash_tbl == NULL) {
+		return (NULL);
+	}
+	hash = seg_hash_number_create (key, klen);
+
+	for (entry = seg_hash_tbl[hash & seg_hash_mask] ; entry ; entry = entry->hash_next) {
+		if ((entry->hash == hash) && (entry->key_len == klen) &&
+			(memcmp (entry->key, key, klen) == 0)) {
+			return (entry);
+		}
+	}
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Adds the index entry to the list of the segment
+----------------------------------------------------------------------------------------*/
+static void
+seg_entry_link (
+	SegT_Entry* entry,
+	int seg_index
+) {
+	SegT_Segment* seg = &seg_segments[seg_index];
+
+	entry->seg_index = (uint16_t) seg_index;
+	entry->seg_prev = NULL;
+	entry->seg_next = seg->entries;
+	if (seg->entries) {
+		seg->entries->seg_prev = entry;
+	}
+	seg->entries = entry;
+	seg->live_num++;
+}
+/*--------------------------------------------------------------------------------------
+	Removes the index entry from the list of the segment
+----------------------------------------------------------------------------------------*/
+static void
+seg_entry_unlink (
+	SegT_Entry* entry
+) {
+	SegT_Segment* seg = &seg_segments[entry->seg_index];
+
+	if (entry->seg_prev) {
+		entry->seg_prev->seg_next = entry->seg_next;
+	} else {
+		seg->entries = entry->seg_next;
+	}
+	if (entry->seg_next) {
+		entry->seg_next->seg_prev = entry->seg_prev;
+	}
+	entry->seg_prev = NULL;
+	entry->seg_next = NULL;
+	seg->live_num--;
+	seg->dead_bytes += entry->rec_len;
+}
+/*--------------------------------------------------------------------------------------
+	Deletes the cached Cob. The record is left in the segment as dead bytes.
+----------------------------------------------------------------------------------------*/
+static void
+seg_entry_remove (
+	SegT_Entry* entry
+) {
+	SegT_Entry** pp;
+	SegT_Segment* seg = &seg_segments[entry->seg_index];
+
+	for (pp = &seg_hash_tbl[entry->hash & seg_hash_mask] ; *pp ; pp = &(*pp)->hash_next) {
+		if (*pp == entry) {
+			*pp = entry->hash_next;
+			break;
+		}
+	}
+	seg_entry_unlink (entry);
+
+	cef_csmgr_shm_invalidate (entry->key, entry->key_len);
+	csmgrd_stat_cob_remove (csmgr_stat_hdl, entry->key,
+		entry->key_len - SegC_Chunk_Len, entry->chunk_num, entry->pay_len);
+	hdl->cache_cobs--;
+	free (entry);
+
+	/* A sealed segment without live records is free at once 	*/
+	if ((seg->state == SegC_State_Sealed) && (seg->live_num == 0)) {
+		seg->state 		= SegC_State_Free;
+		seg->wr_off 	= 0;
+		seg->dead_bytes = 0;
+		seg->seal_seq 	= 0;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Deletes all cached Cobs and the information of the specified content
+----------------------------------------------------------------------------------------*/
+static void
+seg_content_drop (
+	CsmgrT_Stat* rcd
+) {
+	unsigned char 	name[CsmgrdC_Key_Max];
+	uint16_t		name_len;
+	unsigned char 	trg_key[CsmgrdC_Key_Max];
+	int 			trg_key_len;
+	uint64_t*		cob_map;
+	uint32_t		map_max;
+	uint32_t		i, n;
+	SegT_Entry*		entry;
+
+	name_len = rcd->name_len;
+	if (name_len + SegC_Chunk_Len > CsmgrdC_Key_Max) {
+		csmgrd_stat_content_info_delete (csmgr_stat_hdl, rcd->name, rcd->name_len);
+		return;
+	}
+	memcpy (name, rcd->name, name_len);
+
+	/* The record is freed when its last Cob is removed 	*/
+	map_max = rcd->map_max;
+	cob_map = (uint64_t*) malloc (sizeof (uint64_t) * map_max);
+	if (cob_map == NULL) {
+		return;
+	}
+	memcpy (cob_map, rcd->cob_map, sizeof (uint64_t) * map_max);
+
+	for (i = 0 ; i < map_max ; i++) {
+		if (cob_map[i] == 0) {
+			continue;
+		}
+		for (n = 0 ; n < 64 ; n++) {
+			if (!(cob_map[i] & (1llu << n))) {
+				continue;
+			}
+			trg_key_len = csmgrd_name_chunknum_concatenate (
+							name, name_len, i * 64 + n, trg_key);
+			entry = seg_entry_lookup (trg_key, trg_key_len);
+			if (entry) {
+				seg_entry_remove (entry);
+			}
+		}
+	}
+	free (cob_map);
+
+	csmgrd_stat_content_info_delete (csmgr_stat_hdl, name, name_len);
+}
+/*--------------------------------------------------------------------------------------
+	Reserves the area of the record at the tail of the active segment
+----------------------------------------------------------------------------------------*/
+static unsigned char*				/* Area of the record, or NULL if it fails			*/
+seg_record_reserve (
+	uint32_t rec_len,
+	int* seg_index,
+	uint64_t* offset
+) {
+	SegT_Segment* seg;
+	unsigned char* rec;
+
+	if (rec_len > hdl->segment_size || rec_len > SegC_Wbuf_Size) {
+		return (NULL);
+	}
+	if ((seg_active < 0) ||
+		(seg_segments[seg_active].wr_off + rec_len > hdl->segment_size)) {
+		if (seg_segment_rotate () < 0) {
+			return (NULL);
+		}
+	}
+	if (seg_wbuf_len + rec_len > SegC_Wbuf_Size) {
+		seg_wbuf_flush ();
+	}
+	seg = &seg_segments[seg_active];
+
+	rec = &seg_wbuf[seg_wbuf_len];
+	*seg_index 	= seg_active;
+	*offset 	= seg->wr_off;
+	seg_wbuf_len += rec_len;
+	seg->wr_off  += rec_len;
+
+	return (rec);
+}
+/*--------------------------------------------------------------------------------------
+	Writes the appended records to the active segment
+----------------------------------------------------------------------------------------*/
+static void
+seg_wbuf_flush (
+	void
+) {
+	uint32_t done = 0;
+	ssize_t res;
+
+	if ((seg_active < 0) || (seg_wbuf_len == 0)) {
+		return;
+	}
+	while (done < seg_wbuf_len) {
+		res = pwrite (seg_segments[seg_active].fd, &seg_wbuf[done],
+				seg_wbuf_len - done, (off_t)(seg_wbuf_off + done));
+		if (res < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			csmgrd_log_write (CefC_Log_Error,
+				"Failed to write the segment file (%s)\n", strerror (errno));
+			break;
+		}
+		done += (uint32_t) res;
+	}
+	seg_wbuf_off += seg_wbuf_len;
+	seg_wbuf_len = 0;
+}
+/*--------------------------------------------------------------------------------------
+	Seals the active segment and activates the free or the oldest segment
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_segment_rotate (
+	void
+) {
+	SegT_Segment* seg;
+	int i, trg = -1;
+
+	if (seg_active >= 0) {
+		seg_wbuf_flush ();
+		seg = &seg_segments[seg_active];
+		if (seg->live_num == 0) {
+			seg->state = SegC_State_Free;
+		} else {
+			seg->state = SegC_State_Sealed;
+			seg->seal_seq = ++seg_seal_seq;
+		}
+		seg_active = -1;
+	}
+
+	for (i = 0 ; i < hdl->segment_num ; i++) {
+		if (seg_segments[i].state == SegC_State_Free) {
+			trg = i;
+			break;
+		}
+	}
+	if (trg < 0) {
+		for (i = 0 ; i < hdl->segment_num ; i++) {
+			if ((seg_segments[i].state == SegC_State_Sealed) &&
+				((trg < 0) || (seg_segments[i].seal_seq < seg_segments[trg].seal_seq))) {
+				trg = i;
+			}
+		}
+		if (trg < 0) {
+			return (-1);
+		}
+		seg_segment_evict (trg);
+	}
+
+	seg = &seg_segments[trg];
+	seg->state 		= SegC_State_Active;
+	seg->wr_off 	= 0;
+	seg->dead_bytes = 0;
+	seg->seal_seq 	= 0;
+	seg_active 		= trg;
+	seg_wbuf_off 	= 0;
+	seg_wbuf_len 	= 0;
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Deletes all Cobs in the specified segment
+----------------------------------------------------------------------------------------*/
+static void
+seg_segment_evict (
+	int seg_index
+) {
+	SegT_Segment* seg = &seg_segments[seg_index];
+
+#ifdef CefC_Debug
+	csmgrd_dbg_write (CefC_Dbg_Fine,
+		"Evicts the segment#%d (%u cobs)\n", seg_index, seg->live_num);
+#endif // CefC_Debug
+	seg->state = SegC_State_Reclaim;
+	while (seg->entries) {
+		seg_entry_remove (seg->entries);
+	}
+	seg->state 		= SegC_State_Free;
+	seg->wr_off 	= 0;
+	seg->dead_bytes = 0;
+	seg->seal_seq 	= 0;
+}
+/*--------------------------------------------------------------------------------------
+	Moves the live records of the most fragmented segment to the active segment
+----------------------------------------------------------------------------------------*/
+static void
+seg_segment_compact (
+	void
+) {
+	SegT_Segment* seg;
+	SegT_Segment* victim;
+	SegT_Entry* entry;
+	unsigned char* rec;
+	int seg_index;
+	uint64_t offset;
+	uint64_t nowt;
+	struct timeval tv;
+	int i, free_num = 0, trg = -1;
+
+	/* Compaction is deferred until the free segments run out 	*/
+	for (i = 0 ; i < hdl->segment_num ; i++) {
+		seg = &seg_segments[i];
+		if (seg->state == SegC_State_Free) {
+			free_num++;
+		} else if ((seg->state == SegC_State_Sealed) &&
+			(seg->dead_bytes * 100 >= seg->wr_off * SegC_Compact_Ratio) &&
+			((trg < 0) || (seg->dead_bytes > seg_segments[trg].dead_bytes))) {
+			trg = i;
+		}
+	}
+	if ((free_num > 1) || (trg < 0)) {
+		return;
+	}
+	victim = &seg_segments[trg];
+	victim->state = SegC_State_Reclaim;
+#ifdef CefC_Debug
+	csmgrd_dbg_write (CefC_Dbg_Fine, "Compacts the segment#%d ("FMTU64"/"FMTU64" bytes dead)\n",
+		trg, victim->dead_bytes, victim->wr_off);
+#endif // CefC_Debug
+
+	gettimeofday (&tv, NULL);
+	nowt = tv.tv_sec * 1000000llu + tv.tv_usec;
+
+	while ((entry = victim->entries) != NULL) {
+		if (((entry->expiry != 0) && (entry->expiry < nowt)) || (entry->cache_time < nowt) ||
+			(pread (victim->fd, seg_rec_buff, entry->rec_len, (off_t) entry->offset)
+				!= entry->rec_len)) {
+			seg_entry_remove (entry);
+			continue;
+		}
+		rec = seg_record_reserve (entry->rec_len, &seg_index, &offset);
+		if (rec == NULL) {
+			break;
+		}
+		memcpy (rec, seg_rec_buff, entry->rec_len);
+		seg_entry_unlink (entry);
+		entry->offset = offset;
+		seg_entry_link (entry, seg_index);
+	}
+	seg_wbuf_flush ();
+
+	/* Cobs which could not be moved are deleted with the segment 		*/
+	seg_segment_evict (trg);
+}
+/*--------------------------------------------------------------------------------------
+	Opens the segment files, which are preallocated
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_segment_files_open (
+	void
+) {
+	char file_path[PATH_MAX];
+	struct stat st;
+	int i, fd, res;
+
+	int rc = snprintf (hdl->seg_cache_path, sizeof (hdl->seg_cache_path),
+				"%s/%s", hdl->seg_root_path, SegC_Dir_Name);
+	if ((rc < 0) || (rc >= sizeof (hdl->seg_cache_path))) {
+		csmgrd_log_write (CefC_Log_Error, "Failed to cache_path name create\n");
+		return (-1);
+	}
+	if ((mkdir (hdl->seg_cache_path, 0766) != 0) && (errno != EEXIST)) {
+		csmgrd_log_write (CefC_Log_Error,
+			"Failed to create the cache directory in %s (%s)\n",
+			hdl->seg_root_path, strerror (errno));
+		return (-1);
+	}
+
+	for (i = 0 ; i < hdl->segment_num ; i++) {
+		snprintf (file_path, sizeof (file_path), "%s/segment_%04d", hdl->seg_cache_path, i);
+		fd = open (file_path, O_RDWR | O_CREAT, 0666);
+		if (fd < 0) {
+			csmgrd_log_write (CefC_Log_Error,
+				"Failed to open the segment file (%s) - %s\n", file_path, strerror (errno));
+			return (-1);
+		}
+		seg_segments[i].fd = fd;
+		seg_segments[i].state = SegC_State_Free;
+
+		if ((fstat (fd, &st) == 0) && (st.st_size == (off_t) hdl->segment_size)) {
+			continue;
+		}
+		/* Allocates the blocks in advance, so that the appends never extend the file 	*/
+		if (ftruncate (fd, 0) < 0) {
+			csmgrd_log_write (CefC_Log_Error,
+				"Failed to truncate the segment file (%s) - %s\n", file_path, strerror (errno));
+			return (-1);
+		}
+#ifdef __APPLE__
+		res = ftruncate (fd, (off_t) hdl->segment_size);
+#else // __APPLE__
+		res = posix_fallocate (fd, 0, (off_t) hdl->segment_size);
+		if ((res == EOPNOTSUPP) || (res == EINVAL)) {
+			/* The filesystem does not support the preallocation 	*/
+			res = ftruncate (fd, (off_t) hdl->segment_size);
+		} else if (res != 0) {
+			errno = res;
+			res = -1;
+		}
+#endif // __APPLE__
+		if (res != 0) {
+			csmgrd_log_write (CefC_Log_Error,
+				"Failed to allocate the segment file (%s) - %s\n", file_path, strerror (errno));
+			return (-1);
+		}
+	}
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Closes the segment files
+----------------------------------------------------------------------------------------*/
+static void
+seg_segment_files_close (
+	int remove_f
+) {
+	char file_path[PATH_MAX];
+	int i;
+
+	for (i = 0 ; i < hdl->segment_num ; i++) {
+		if (seg_segments[i].fd < 0) {
+			continue;
+		}
+		close (seg_segments[i].fd);
+		seg_segments[i].fd = -1;
+		if (remove_f) {
+			snprintf (file_path, sizeof (file_path), "%s/segment_%04d", hdl->seg_cache_path, i);
+			unlink (file_path);
+		}
+	}
+	if (remove_f) {
+		snprintf (file_path, sizeof (file_path), "%s/%s", hdl->seg_cache_path, SegC_Index_File);
+		unlink (file_path);
+		rmdir (hdl->seg_cache_path);
+	}
+	seg_active = -1;
+}
+/*--------------------------------------------------------------------------------------
+	Saves the index to the segment directory
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+seg_index_save (
+	void
+) {
+	char file_path[PATH_MAX];
+	char tmp_path[PATH_MAX + 8];
+	SegT_Idx_Head head;
+	SegT_Idx_Seg iseg;
+	SegT_Idx_Rec irec;
+	SegT_Entry* entry;
+	FILE* fp;
+	uint32_t n;
+	int i, err = 0;
+
+	snprintf (file_path, sizeof (file_path), "%s/%s", hdl->seg_cache_path, SegC_Index_File);
+	snprintf (tmp_path, sizeof (tmp_path), "%s.tmp", file_path);
+	fp = fopen (tmp_path, "wb");
+	if (fp == NULL) {
+		return (-1);
+	}
+
+	memset (&head, 0, sizeof (SegT_Idx_Head));
+	head.magic 			= SegC_Idx_Magic;
+	head.version 		= SegC_Idx_Version;
+	head.segment_size 	= hdl->segment_size;
+	head.segment_num 	= (uint32_t) hdl->segment_num;
+	head.active 		= seg_active;
+	head.seal_seq 		= seg_seal_seq;
+	head.entry_num 		= hdl->cache_cobs;
+	if (fwrite (&head, sizeof (SegT_Idx_Head), 1, fp) != 1) {
+		err = 1;
+	}
+	for (i = 0 ; i < hdl->segment_num && !err ; i++) {
+		memset (&iseg, 0, sizeof (SegT_Idx_Seg));
+		iseg.wr_off 	= seg_segments[i].wr_off;
+		iseg.seal_seq 	= seg_segments[i].seal_seq;
+		iseg.state 		= (uint32_t) seg_segments[i].state;
+		if (fwrite (&iseg, sizeof (SegT_Idx_Seg), 1, fp) != 1) {
+			err = 1;
+		}
+	}
+	for (n = 0 ; n <= seg_hash_mask && !err ; n++) {
+		for (entry = seg_hash_tbl[n] ; entry ; entry = entry->hash_next) {
+			memset (&irec, 0, sizeof (SegT_Idx_Rec));
+			irec.offset 	= entry->offset;
+			irec.rec_len 	= entry->rec_len;
+			irec.seg_index 	= entry->seg_index;
+			if (fwrite (&irec, sizeof (SegT_Idx_Rec), 1, fp) != 1) {
+				err = 1;
+				break;
+			}
+		}
+	}
+	if (fclose (fp) != 0) {
+		err = 1;
+	}
+	if (err || (rename (tmp_path, file_path) != 0)) {
+		unlink (tmp_path);
+		return (-1);
+	}
+	for (i = 0 ; i < hdl->segment_num ; i++) {
+		fsync (seg_segments[i].fd);
+	}
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Loads the index saved at the last shutdown, and validates it with the segments
+----------------------------------------------------------------------------------------*/
+static int							/* Number of the loaded entries, or negative value	*/
+seg_index_load (
+	void
+) {
+	char file_path[PATH_MAX];
+	SegT_Idx_Head head;
+	SegT_Idx_Seg iseg;
+	SegT_Idx_Rec irec;
+	SegT_Rec_Head rhead;
+	SegT_Segment* seg;
+	SegT_Entry* entry;
+	CsmgrT_Stat* rcd;
+	struct in_addr node;
+	unsigned char* version;
+	uint64_t nowt;
+	struct timeval tv;
+	uint64_t n;
+	FILE* fp;
+	int i, loaded = 0;
+
+	snprintf (file_path, sizeof (file_path), "%s/%s", hdl->seg_cache_path, SegC_Index_File);
+	fp = fopen (file_path, "rb");
+	if (fp == NULL) {
+		return (-1);
+	}
+	/* The index is stale once the segments are written again 	*/
+	unlink (file_path);
+
+	if ((fread (&head, sizeof (SegT_Idx_Head), 1, fp) != 1) ||
+		(head.magic != SegC_Idx_Magic) || (head.version != SegC_Idx_Version) ||
+		(head.segment_size != hdl->segment_size) ||
+		(head.segment_num != (uint32_t) hdl->segment_num) ||
+		(head.active >= hdl->segment_num)) {
+		csmgrd_log_write (CefC_Log_Warn, "Index does not match the segments, ignored\n");
+		fclose (fp);
+		return (-1);
+	}
+	for (i = 0 ; i < hdl->segment_num ; i++) {
+		if ((fread (&iseg, sizeof (SegT_Idx_Seg), 1, fp) != 1) ||
+			(iseg.wr_off > hdl->segment_size) || (iseg.state > SegC_State_Sealed)) {
+			csmgrd_log_write (CefC_Log_Warn, "Index is broken, ignored\n");
+			fclose (fp);
+			for (i = 0 ; i < hdl->segment_num ; i++) {
+				seg_segments[i].state = SegC_State_Free;
+				seg_segments[i].wr_off = 0;
+			}
+			return (-1);
+		}
+		seg_segments[i].wr_off 		= iseg.wr_off;
+		seg_segments[i].seal_seq 	= iseg.seal_seq;
+		seg_segments[i].state 		= (int) iseg.state;
+	}
+	seg_seal_seq = head.seal_seq;
+	seg_active = head.active;
+	if (seg_active >= 0) {
+		seg_wbuf_off = seg_segments[seg_active].wr_off;
+	}
+
+	gettimeofday (&tv, NULL);
+	nowt = tv.tv_sec * 1000000llu + tv.tv_usec;
+	memset (&node, 0, sizeof (struct in_addr));
+
+	for (n = 0 ; n < head.entry_num ; n++) {
+		if (fread (&irec, sizeof (SegT_Idx_Rec), 1, fp) != 1) {
+			break;
+		}
+		if ((irec.seg_index >= hdl->segment_num) || (irec.rec_len > SegC_Rec_Max) ||
+			(irec.offset + irec.rec_len > seg_segments[irec.seg_index].wr_off)) {
+			continue;
+		}
+		seg = &seg_segments[irec.seg_index];
+
+		/* Checks that the record is still in the segment 		*/
+		if (pread (seg->fd, seg_rec_buff, irec.rec_len, (off_t) irec.offset) != irec.rec_len) {
+			continue;
+		}
+		memcpy (&rhead, seg_rec_buff, sizeof (SegT_Rec_Head));
+		if ((rhead.magic != SegC_Rec_Magic) ||
+			(rhead.key_len <= SegC_Chunk_Len) || (rhead.key_len > CsmgrdC_Key_Max) ||
+			(sizeof (SegT_Rec_Head) + rhead.key_len + rhead.ver_len + rhead.msg_len
+				> irec.rec_len)) {
+			continue;
+		}
+		if (((rhead.expiry != 0) && (rhead.expiry < nowt)) || (rhead.cache_time < nowt) ||
+			(hdl->cache_cobs >= hdl->cache_capacity)) {
+			continue;
+		}
+		if (seg_entry_lookup (&seg_rec_buff[sizeof (SegT_Rec_Head)], rhead.key_len)) {
+			continue;
+		}
+
+		entry = (SegT_Entry*) malloc (sizeof (SegT_Entry) + rhead.key_len);
+		if (entry == NULL) {
+			break;
+		}
+		memset (entry, 0, sizeof (SegT_Entry));
+		memcpy (entry->key, &seg_rec_buff[sizeof (SegT_Rec_Head)], rhead.key_len);
+		entry->key_len 		= rhead.key_len;
+		entry->hash 		= seg_hash_number_create (entry->key, entry->key_len);
+		entry->offset 		= irec.offset;
+		entry->rec_len 		= irec.rec_len;
+		entry->cache_time 	= rhead.cache_time;
+		entry->expiry 		= rhead.expiry;
+		entry->chunk_num 	= rhead.chunk_num;
+		entry->ver_len 		= rhead.ver_len;
+		entry->msg_len 		= rhead.msg_len;
+		entry->pay_len 		= rhead.pay_len;
+		entry->gen 			= ++seg_entry_gen;
+		entry->hash_next 	= seg_hash_tbl[entry->hash & seg_hash_mask];
+		seg_hash_tbl[entry->hash & seg_hash_mask] = entry;
+		seg_entry_link (entry, irec.seg_index);
+		hdl->cache_cobs++;
+		loaded++;
+
+		csmgrd_stat_cob_update (csmgr_stat_hdl, entry->key, entry->key_len - SegC_Chunk_Len,
+			entry->chunk_num, entry->pay_len, entry->expiry, nowt, node);
+		rcd = csmgrd_stat_content_info_get (
+				csmgr_stat_hdl, entry->key, entry->key_len - SegC_Chunk_Len);
+		if (rcd && entry->ver_len && !rcd->ver_len) {
+			version = &seg_rec_buff[sizeof (SegT_Rec_Head) + entry->key_len];
+			csmgrd_stat_content_info_version_init (
+				csmgr_stat_hdl, rcd, version, entry->ver_len);
+		}
+	}
+	fclose (fp);
+
+	/* The bytes which are not referred by the index are dead 		*/
+	for (i = 0 ; i < hdl->segment_num ; i++) {
+		uint64_t live_bytes = 0;
+		seg = &seg_segments[i];
+		for (entry = seg->entries ; entry ; entry = entry->seg_next) {
+			live_bytes += entry->rec_len;
+		}
+		seg->dead_bytes = seg->wr_off - live_bytes;
+		if ((seg->state == SegC_State_Sealed) && (seg->live_num == 0)) {
+			seg->state 		= SegC_State_Free;
+			seg->wr_off 	= 0;
+			seg->dead_bytes = 0;
+			seg->seal_seq 	= 0;
+		}
+	}
+
+	return (loaded);
+}
@@ -27,47 +27,65 @@
  * SUCH DAMAGE.
  */
 /*
- * lru.h
+ * segment_cache.h
  */
+#ifndef __CSMGRD_SEGMENT_CACHE_HEADER__
+#define __CSMGRD_SEGMENT_CACHE_HEADER__
 
 /****************************************************************************************
  Include Files
  ****************************************************************************************/
-
-#include <stdio.h>
-#include <stdlib.h>
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <netinet/in.h>
 #include <stdint.h>
-#include <csmgrd/csmgrd_plugin.h>
 
+#include <cefore/cef_define.h>
+#include <cefore/cef_csmgr.h>
+#include <csmgrd/csmgrd_plugin.h>
 
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
 
+/*------------------------------------------------------------------
+	Limitation
+--------------------------------------------------------------------*/
+#define SegC_Segment_Size_Min		1				/* Size of a segment file (MB)	*/
+#define SegC_Segment_Size_Max		4096
+#define SegC_Segment_Num_Min		2				/* Number of segment files		*/
+#define SegC_Segment_Num_Max		1024
 
 /****************************************************************************************
- Function Declaration
+ Structure Declarations
  ****************************************************************************************/
 
-/* lookup table (capsulation) */
-void crlib_lookup_table_init(int capacity);
-void crlib_lookup_table_destroy();
-int crlib_lookup_table_search(const unsigned char* key, int key_len);
-void* crlib_lookup_table_search_v(const unsigned char* key, int key_len);
-void crlib_lookup_table_add(const unsigned char* key, int key_len, int index);
-void crlib_lookup_table_add_v(const unsigned char* key, int key_len, void* value);
-void crlib_lookup_table_remove(const unsigned char* key, int key_len);
-int crlib_lookup_table_count(const unsigned char* key, int key_len);
+typedef struct {
+
+	char			seg_root_path[CefC_Csmgr_File_Path_Length];
+												/* Directory to create segment files	*/
+	uint64_t 		cache_capacity;				/* size of cache capacity				*/
+	uint64_t		segment_size;				/* Size of a segment file (bytes)		*/
+	int				segment_num;				/* Number of segment files				*/
+	int				index_persist;				/* Index is saved at shutdown and		*/
+												/* loaded at startup					*/
+
+} SegT_Config_Param;
+
+typedef struct {
 
-/* xxHash */
-uint32_t crlib_xhash_mask_max(int max);
-uint32_t crlib_xhash_mask_width(int width);
-uint32_t crlib_xhash_get(uint32_t value, int xhash_seed);
-uint32_t crlib_xhash_get_str(const unsigned char* str, int len, int xhash_seed);
+	/********** Segment Cache Status ***********/
+	char			seg_root_path[CefC_Csmgr_File_Path_Length];
+	char			seg_cache_path[CefC_Csmgr_File_Path_Length];
+												/* Directory of segment files			*/
+	uint64_t		segment_size;				/* Size of a segment file (bytes)		*/
+	int				segment_num;				/* Number of segment files				*/
+	int				index_persist;				/* Index is saved at shutdown			*/
 
-/* random */
-void crlib_xorshift_set_seed(uint32_t seed);
-uint32_t crlib_xorshift_rand();
+	uint64_t 		cache_cobs;					/* cached cobs 							*/
+	uint64_t		cache_capacity;
 
-/* debug */
-void crlib_force_print_name(const unsigned char* key, uint16_t len);
-void crlib_force_print_entry(CsmgrdT_Content_Entry* entry);
-void crlib_force_print_name_wl(const unsigned char* key, uint16_t len);
+} SegT_Cache_Handle;
 
+#endif // __CSMGRD_SEGMENT_CACHE_HEADER__
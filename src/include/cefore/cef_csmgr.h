@@ -93,6 +93,36 @@
 #define CefC_Csmgr_Cmd_MaxLen			1024
 #define CefC_Csmgr_Cmd_ConnOK			"CMD://CsmgrConnOK"
 
+/*------------------------------------------------------------------*/
+/* Shared memory index published by csmgrd							*/
+/*------------------------------------------------------------------*/
+#define CefC_ParamName_CsShmSize		"CS_SHM_SIZE"
+#define CefC_Csmgr_Shm_Magic			0x43534d49	/* "CSMI"							*/
+#define CefC_Csmgr_Shm_Version			1
+#define CefC_Csmgr_Shm_Size_Max			4096		/* Max size of the region (MB)		*/
+#define CefC_Csmgr_Shm_Slot_Bytes		2048		/* Arena bytes per index slot		*/
+#define CefC_Csmgr_Shm_Probe			8			/* Slots probed for a name			*/
+#define CefC_Csmgr_Shm_Retry_Time		1000000		/* Interval to retry attach (usec)	*/
+
+/*------------------------------------------------------------------*/
+/* Link between cefnetd and csmgrd									*/
+/*------------------------------------------------------------------*/
+#define CefC_ParamName_CsmgrLinkVer		"CSMGR_LINK_VERSION"
+#define CefC_Csmgr_Link_Ver1			1			/* One message per Interest			*/
+#define CefC_Csmgr_Link_Ver2			2			/* Batches with request IDs			*/
+#define CefC_Default_Csmgr_Link_Ver		CefC_Csmgr_Link_Ver1
+#define CefC_Csmgr_Link_Batch_Size		16384		/* Max bytes of lookups per write	*/
+#define CefC_Csmgr_Link_Window			4096		/* Max lookups not answered yet		*/
+													/* (must be a power of 2)			*/
+#define CefC_Csmgr_Link_Credit			1024		/* Credit csmgrd advertises			*/
+#define CefC_Csmgr_Link_Stall_Time		1000000		/* Time to give up answers (usec)	*/
+#define CefC_Csmgr_Link_ReqId_Len		4			/* Request ID in a batch record		*/
+#define CefC_Csmgr_Link_Answer_Len		5			/* Request ID and result			*/
+#define CefC_Csmgr_PT_Answer			0x20		/* Answer to a batch, framed like	*/
+													/* a CCNx fixed header				*/
+#define CefC_O_Csmgr_Answer_Credit		4			/* Offset of the credit				*/
+#define CefC_Csmgr_Answer_HeaderLen		8
+
 /*------------------------------------------------------------------*/
 /* type of queue entry												*/
 /*------------------------------------------------------------------*/
@@ -125,7 +155,8 @@
 #define CefC_Csmgr_Msg_Type_SockID		0x16		/* Type Sending Socket Identifier	*/
 #define CefC_Csmgr_Msg_Type_CnpbCntAdd	0x17		/* Type Conpub Contents Add			*/
 #define CefC_Csmgr_Msg_Type_CnpbCntDel	0x18		/* Type Conpub Contents Delete		*/
-#define CefC_Csmgr_Msg_Type_Num			0x19
+#define CefC_Csmgr_Msg_Type_Batch		0x19		/* Type Batched Interests (link v2)	*/
+#define CefC_Csmgr_Msg_Type_Num			0x1a
 //#define CefC_Csmgr_Msg_Type_Num			0x15
 
 #define CefC_Csmgr_Cob_Exist			0x00		/* Type Content is exist			*/
@@ -160,6 +191,7 @@
 #define CefC_Csmgr_Stat_Opt_None		0x00
 #define CefC_Csmgr_Stat_Opt_Clear		0x01
 #define CefC_Csmgr_Stat_Opt_Range		0x02
+#define CefC_Csmgr_Stat_Opt_Memory		0x04	/* Reports the memory usage of the cache	*/
 
 /*------------------------------------------------------------------*/
 /* Macros for Massage Buffer										*/
@@ -250,6 +282,23 @@ typedef struct {
 													/*  1: for Local cache				*/
 	int				to_csmgrd_pipe_fd[2];
 
+	/********** Shared memory index of csmgrd ***********/
+	void*			shm_base;						/* Mapped region (read only)		*/
+	size_t			shm_size;						/* Size of the mapped region		*/
+	uint64_t		shm_retry_t;					/* Time to retry attaching (usec)	*/
+	unsigned char*	shm_buff;						/* Cob copied from the region		*/
+	uint64_t		shm_hits;						/* Cobs served from the region		*/
+
+	/********** Link to csmgrd 		***********/
+	uint8_t			link_ver;						/* CSMGR_LINK_VERSION				*/
+	uint32_t		link_req_id;					/* Request ID of the next lookup	*/
+	uint32_t*		link_req_tbl;					/* Request IDs not answered yet		*/
+	uint32_t		link_pending;					/* Number of them					*/
+	uint32_t		link_credit;					/* Lookups csmgrd accepts			*/
+	uint64_t		link_answer_t;					/* Time of the last answer (usec)	*/
+	uint64_t		link_hits;						/* Lookups answered as hit			*/
+	uint64_t		link_misses;					/* Lookups answered as miss			*/
+	uint64_t		link_skips;						/* Lookups skipped for no credit	*/
 
 } CefT_Cs_Stat;
 
@@ -320,6 +369,20 @@ struct CefT_Csmgr_Status_Rep {
 
 } __attribute__((__packed__));
 
+/* Follows CefT_Csmgr_Status_Hdr when CefC_Csmgr_Stat_Opt_Memory is requested 	*/
+struct CefT_Csmgr_Status_Mem {
+
+	uint16_t 		mem_f;					/* 1 if the cache reports the usage 		*/
+	uint64_t 		cob_num;				/* Cached Cobs 								*/
+	uint64_t 		entry_bytes;			/* Bytes of the entries which hold the Cobs */
+	uint64_t 		block_bytes;			/* Bytes of the blocks of the entries 		*/
+	uint64_t 		slab_bytes;				/* Bytes of the slabs 						*/
+	uint64_t 		slab_num;
+	uint64_t 		large_bytes;			/* Bytes of the entries out of the slabs 	*/
+	uint64_t 		index_bytes;			/* Bytes of the lookup table 				*/
+
+} __attribute__((__packed__));
+
 struct CefT_Csmgr_CnpbStatus_TL {
 	uint16_t 	type;
 	uint16_t 	length;
@@ -409,6 +472,22 @@ void
 cef_csmgr_excache_item_push (
 	CefT_Cs_Stat* cs_stat					/* Content Store status						*/
 );
+/*--------------------------------------------------------------------------------------
+	Sends the lookups queued in this event loop pass to csmgrd
+----------------------------------------------------------------------------------------*/
+void
+cef_csmgr_excache_lookup_flush (
+	CefT_Cs_Stat* cs_stat					/* Content Store status						*/
+);
+/*--------------------------------------------------------------------------------------
+	Handles the answer to a batch of lookups
+----------------------------------------------------------------------------------------*/
+void
+cef_csmgr_link_answer_process (
+	CefT_Cs_Stat* cs_stat,					/* Content Store status						*/
+	const unsigned char* msg,				/* Answer message							*/
+	int msg_len								/* Length of the message					*/
+);
 /*--------------------------------------------------------------------------------------
 	Search and queue entry
 ----------------------------------------------------------------------------------------*/
@@ -567,4 +646,42 @@ cef_csmgr_csmgr_connect_local (
 	CefT_Cs_Stat* cs_stat					/* Content Store Status						*/
 );
 
+/*--------------------------------------------------------------------------------------
+	Creates the shared memory index which csmgrd publishes the Cobs to
+----------------------------------------------------------------------------------------*/
+int									/* The return value is negative if an error occurs	*/
+cef_csmgr_shm_create (
+	const char* local_sock_name,			/* Local socket name of csmgrd				*/
+	uint32_t size_mb						/* Size of the region (MB)					*/
+);
+/*--------------------------------------------------------------------------------------
+	Destroys the shared memory index
+----------------------------------------------------------------------------------------*/
+void
+cef_csmgr_shm_destroy (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Publishes the Cob to the shared memory index
+----------------------------------------------------------------------------------------*/
+void
+cef_csmgr_shm_publish (
+	const unsigned char* key,				/* Content name with the chunk number		*/
+	uint16_t klen,							/* Length of the key						*/
+	const unsigned char* version,			/* Version of the Cob						*/
+	uint16_t ver_len,						/* Length of the version					*/
+	const unsigned char* msg,				/* Cob message								*/
+	uint16_t msg_len,						/* Length of the Cob message				*/
+	uint64_t cache_time,					/* Cache time (usec)						*/
+	uint64_t expiry							/* Expiry (usec), or 0						*/
+);
+/*--------------------------------------------------------------------------------------
+	Removes the Cob from the shared memory index
+----------------------------------------------------------------------------------------*/
+void
+cef_csmgr_shm_invalidate (
+	const unsigned char* key,				/* Content name with the chunk number		*/
+	uint16_t klen							/* Length of the key						*/
+);
+
 #endif // __CEF_CSMGR_HEADER__
@@ -321,6 +321,27 @@ csmgr_stat_content_info_version_init (
 	unsigned char* version,
 	uint16_t ver_len
 );
+/*--------------------------------------------------------------------------------------
+	Calls the callback for each content information
+----------------------------------------------------------------------------------------*/
+void
+csmgr_stat_content_info_walk (
+	CsmgrT_Stat_Handle hdl,
+	void (*callback)(CsmgrT_Stat*, void*),	/* called with each content information 	*/
+	void* arg								/* argument of the callback 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Restores the bitmap of the cached Cobs of the specified content
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+csmgr_stat_cob_map_restore (
+	CsmgrT_Stat_Handle hdl,
+	CsmgrT_Stat* rcd,
+	const uint64_t* cob_map,				/* bitmap of the cached Cobs 				*/
+	uint32_t map_max,						/* number of the elements of cob_map 		*/
+	uint64_t cob_num,						/* number of the cached Cobs 				*/
+	uint64_t con_size						/* total size of the cached Cobs 			*/
+);
 /*--------------------------------------------------------------------------------------
 	Deletes the content information
 ----------------------------------------------------------------------------------------*/
@@ -524,6 +545,10 @@ csmgr_stat_cob_remove_for_pub (
 		 csmgr_stat_content_info_init(hdl, name, name_len, cob_map)
 #define csmgrd_stat_content_info_version_init(hdl, rcd, version, ver_len) \
 		 csmgr_stat_content_info_version_init(hdl, rcd, version, ver_len)
+#define csmgrd_stat_content_info_walk(hdl, callback, arg) \
+		 csmgr_stat_content_info_walk(hdl, callback, arg)
+#define csmgrd_stat_cob_map_restore(hdl, rcd, cob_map, map_max, cob_num, con_size) \
+		 csmgr_stat_cob_map_restore(hdl, rcd, cob_map, map_max, cob_num, con_size)
 #define csmgrd_stat_content_info_delete(hdl, name, name_len) \
 		 csmgr_stat_content_info_delete(hdl, name, name_len)
 #define csmgrd_stat_cache_capacity_update(hdl, capacity) \
@@ -55,6 +55,7 @@
 #include <cefore/cef_define.h>
 #include <cefore/cef_frame.h>
 #include <cefore/cef_rcvbuf.h>
+#include <cefore/cef_shmring.h>
 
 /****************************************************************************************
  Macros
@@ -79,6 +80,12 @@
 /********** Invalid File Descriptor value	**********/
 #define CefC_Fd_Invalid				-1
 
+/********** Batched transmission			**********/
+#define CefC_Face_Batch_Max			32			/* Messages per batched send call 		*/
+#ifdef __linux__
+#define CefC_Face_SendMmsg						/* UDP batches are sent by sendmmsg 	*/
+#endif // __linux__
+
 /********** Identifier to close Face 		**********/
 #define CefC_Face_Close				"/CLOSE:Face"
 
@@ -229,6 +236,14 @@ cef_face_update_listen_faces (
 	uint16_t* intcpfaces,
 	uint16_t* intcpfdc
 );
+/*--------------------------------------------------------------------------------------
+	Obtains the generation of the Face Table
+	  NOTE: The value changes whenever FD of any Face is opened or closed
+----------------------------------------------------------------------------------------*/
+uint32_t									/* generation of the Face Table 			*/
+cef_face_tbl_generation_get (
+	void
+);
 /*--------------------------------------------------------------------------------------
 	Converts the specified Face-ID into the corresponding file descriptor
 ----------------------------------------------------------------------------------------*/
@@ -277,6 +292,16 @@ cef_face_frame_send (
 	unsigned char* 	msg, 					/* a message to send						*/
 	size_t			msg_len					/* length of the message to send 			*/
 );
+/*--------------------------------------------------------------------------------------
+	Sends the messages via the specified Face with as few system calls as possible
+----------------------------------------------------------------------------------------*/
+int											/* number of messages completely sent		*/
+cef_face_frame_send_batch (
+	uint16_t 		faceid, 				/* Face-ID indicating the destination 		*/
+	unsigned char* 	msgs[], 				/* messages to send							*/
+	size_t			msg_lens[],				/* length of each message 					*/
+	int				msg_num					/* number of messages 						*/
+);
 /*--------------------------------------------------------------------------------------
 	Obtains the Face structure from the specified Face-ID
 ----------------------------------------------------------------------------------------*/
@@ -312,6 +337,15 @@ int											/* Returns a negative value if it fails 	*/
 cef_face_down (
 	int faceid								/* Face-ID									*/
 );
+/*--------------------------------------------------------------------------------------
+	Attaches the shared memory rings to the local Face, or detaches them with NULL.
+	The frames sent to the Face are put into the rings instead of the socket
+----------------------------------------------------------------------------------------*/
+void
+cef_face_shmring_set (
+	uint16_t 		faceid,					/* Face-ID of the application 				*/
+	CefT_Shmring* 	shm						/* rings, or NULL to detach 				*/
+);
 /*--------------------------------------------------------------------------------------
 	Sends a frame if the specified is local Face
 ----------------------------------------------------------------------------------------*/
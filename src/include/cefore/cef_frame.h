@@ -664,6 +664,9 @@ typedef struct _CefT_CcnMsg_OptHdr_t {
 	uint16_t			MsgHash_f;				/* Offset of OPT_MSGHASH				*/
 	uint16_t			MsgHash_len;			/* Length of OPT_MSGHASH				*/
 	CefT_HashData 		MsgHash;				/* MsgHashData							*/
+	const unsigned char* MsgHash_src;			/* Payload to calculate MsgHash from	*/
+												/* on demand, or NULL					*/
+	uint16_t			MsgHash_src_len;		/* Length of MsgHash_src				*/
 
 	/***** Vendor Specific Information	*****/
 	uint16_t 	org_len;						/* Length of Vendor Specific Information */
@@ -966,6 +969,14 @@ cef_frame_message_parse (
 	CefT_CcnMsg_MsgBdy* pm, 				/* Structure to set parsed CEFORE message	*/
 	int target_type							/* Type of the message to expect			*/
 );
+/*--------------------------------------------------------------------------------------
+	Obtains the Message Hash of the parsed message. If the message has no MsgHash
+	option header, it is calculated from the payload at the first call.
+----------------------------------------------------------------------------------------*/
+int 										/* Length of MsgHash, or 0 if it has none	*/
+cef_frame_opheader_msghash_get (
+	CefT_CcnMsg_OptHdr* poh 				/* Parsed Option Header						*/
+);
 /*--------------------------------------------------------------------------------------
 	Obtains a Link Request message
 ----------------------------------------------------------------------------------------*/
@@ -65,6 +65,8 @@
 #define CefC_Max_KLen 				1024
 #endif
 
+#define CefC_Hash_Group 			16			/* control bytes probed at one time 		*/
+
 /* [Coefficients for expanding hash tables]                                         */
 /* Hash tables other than the following do not use coefficients.                    */
 #define CefC_Hash_Coef_FIB			1			/* for FIB (Normal, App, c3)                       */
@@ -78,20 +80,38 @@
 typedef size_t CefT_Hash_Handle;
 
 #if 1
+/*
+ * Entry of the hash table. The index of an entry is returned by cef_hash_tbl_item_set
+ * and stays valid until the entry is removed.
+ */
 typedef struct CefT_Hash_Table {
-	uint32_t 		hash;
-	unsigned char 	key[CefC_Max_KLen + 1];
+	uint64_t 		hash;
+	unsigned char* 	key;				/* stored out of line 					*/
 	void* 			elem;
 	uint32_t 		klen;
+	uint32_t 		kcap;				/* size of the key buffer 				*/
+	uint32_t 		next_free;			/* next unused entry 					*/
 	uint8_t			opt_f;
+	uint8_t			used_f;
 } CefT_Hash_Table;
 
 typedef struct CefT_Hash {
 	uint32_t 			seed;
 	CefT_Hash_Table*	tbl;
-	uint32_t 			elem_max;			/* Prime numbers larger than the user defined maximum size */
+	uint32_t 			elem_max;			/* Number of the entries 					*/
 	uint32_t 			elem_num;
 	uint32_t 			def_elem_max;		/* User defined maximum size	*/
+	uint32_t 			tbl_used;			/* Entries which have ever been used 		*/
+	uint32_t 			free_head;			/* List of the removed entries 				*/
+
+	/* Probe table which maps the hash values to the entries. Each control byte	*/
+	/* holds 7 bits of the hash value of a full position, or empty/deleted.		*/
+	uint8_t* 			ctrl;				/* ctrl_num + CefC_Hash_Group bytes 		*/
+	uint32_t* 			ctrl_idx;			/* index of the entry in each position 		*/
+	uint32_t 			ctrl_mask;			/* ctrl_num - 1 							*/
+	uint32_t 			ctrl_deleted;		/* positions marked as deleted 				*/
+	uint32_t 			ctrl_growth;		/* positions that can be filled before 		*/
+											/* rebuilding the probe table				*/
 } CefT_Hash;
 #endif
 /****************************************************************************************
@@ -142,6 +162,23 @@ cef_hash_tbl_hashv_get (
 	uint32_t klen
 );
 
+int
+cef_hash_tbl_prefix_hashv_get (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	const uint16_t plens[],
+	int pnum,
+	uint64_t hashvs[]
+);
+
+void*
+cef_hash_tbl_item_get_with_hashv (
+	CefT_Hash_Handle handle,
+	uint64_t hashv,
+	const unsigned char* key,
+	uint32_t klen
+);
+
 void*
 cef_hash_tbl_item_get (
 	CefT_Hash_Handle handle,
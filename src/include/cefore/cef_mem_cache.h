@@ -141,6 +141,13 @@ void *
 cef_mem_cache_put_thread (
 	void *p
 );
+/*--------------------------------------------------------------------------------------
+	Number of messages the put thread has stored or discarded
+----------------------------------------------------------------------------------------*/
+uint64_t
+cef_mem_cache_put_count_get (
+	void
+);
 /*--------------------------------------------------------------------------------------
 	Thread to clear expirly content object of local cache
 ----------------------------------------------------------------------------------------*/
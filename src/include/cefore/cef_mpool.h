@@ -40,6 +40,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
 #include <cefore/cef_define.h>
@@ -50,6 +51,7 @@
 #endif
 
 #include <pthread.h>
+#include <stdatomic.h>
 
 /****************************************************************************************
  Macros
@@ -58,11 +60,34 @@
 #define CefC_Tx_Que_Size 				512
 #define CefC_Rx_Que_Size 				256
 
+/***** size classes of the packet buffers 	*****/
+#define CefC_PktBuf_Classes 			4
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 typedef size_t CefT_Mp_Handle;
 
+/***** Statistics of a memory pool 		*****/
+typedef struct {
+	char				key[32];		/* key to identify the memory pool 			*/
+	size_t				block_size;		/* size of one memory block 				*/
+	size_t				block_num;		/* number of pooled memory blocks 			*/
+	size_t				free_num;		/* blocks in the shared free list 			*/
+	size_t				seg_num;		/* number of allocations of the pool 		*/
+	uint64_t			cache_hits;		/* alloc/free served by the thread caches 	*/
+	uint64_t			cache_misses;	/* alloc/free which locked the pool 		*/
+} CefT_Mp_Stat;
+
+/***** Reference-counted packet buffer 	*****/
+typedef struct {
+	atomic_uint 		refcnt;			/* number of the holders of this buffer 	*/
+	uint8_t 			size_class;		/* size class, or CefC_PktBuf_Classes if 	*/
+										/* the buffer is allocated by malloc 		*/
+	uint32_t 			size;			/* capacity of data 						*/
+	unsigned char 		data[];			/* message 									*/
+} CefT_Pkt_Buf;
+
 /****************************************************************************************
  Function declaration
  ****************************************************************************************/
@@ -88,4 +113,48 @@ cef_mpool_free (
 	CefT_Mp_Handle ph,
 	void* ptr
 );
+
+/*
+ * Obtains the statistics of the memory pool.
+ * The thread caches report their hits when they exchange blocks with the pool.
+ */
+int											/* Returns a negative value if it fails 	*/
+cef_mpool_stat_get (
+	CefT_Mp_Handle ph,
+	CefT_Mp_Stat* stat
+);
+
+/*
+ * Allocates a packet buffer which can hold the specified length from the pool of the
+ * smallest size class. The returned buffer has one reference.
+ */
+CefT_Pkt_Buf* 								/* packet buffer, or NULL if it fails 		*/
+cef_pktbuf_alloc (
+	size_t len
+);
+
+/*
+ * Adds a reference to the packet buffer, so that its holders share one message.
+ */
+CefT_Pkt_Buf*
+cef_pktbuf_ref (
+	CefT_Pkt_Buf* pkt
+);
+
+/*
+ * Drops a reference, and returns the buffer to its pool when no holder remains.
+ */
+void
+cef_pktbuf_release (
+	CefT_Pkt_Buf* pkt
+);
+
+/*
+ * Obtains the memory pools of the packet buffers.
+ */
+int 										/* Number of the returned pools 			*/
+cef_pktbuf_mpool_handles_get (
+	CefT_Mp_Handle* mps,
+	int max
+);
 #endif // __CEF_MPOOL_HEADER__
@@ -41,8 +41,10 @@
 #include <stdint.h>
 #include <sys/time.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 #include <cefore/cef_hash.h>
+#include <cefore/cef_mpool.h>
 #include <cefore/cef_define.h>
 #include <cefore/cef_frame.h>
 
@@ -53,6 +55,16 @@
 											/* registered in 1 Down Face Entry (other than AnyVer) */
 
 #define	CefC_Pit_CleaningTime		1000000U
+#define	CefC_Pit_Wheel_Tick			10000U	/* Tick of the PIT expiry wheel (usec)		*/
+#define	CefC_Pit_Wheel_Bits			6		/* log2 of the number of slots per level	*/
+#define	CefC_Pit_Wheel_Slots		(1 << CefC_Pit_Wheel_Bits)
+#define	CefC_Pit_Wheel_Levels		4		/* Levels of the PIT expiry wheel			*/
+#define	CefC_Pit_Wheel_Max			4		/* Max number of PITs having the wheel		*/
+#define	CefC_Pit_Inline_DnFaces		2		/* Down Faces stored in the PIT entry		*/
+#define	CefC_Pit_Inline_UpFaces		1		/* Up Faces stored in the PIT entry			*/
+#define	CefC_Pit_Slab_Classes		3		/* Size classes of the PIT entry slabs		*/
+#define	CefC_Pit_Slab_Malloc		0xFF	/* slab_class of the malloc'ed entries		*/
+#define	CefC_Pit_Mpool_Max			(CefC_Pit_Slab_Classes + 2)
 #define	CefC_Pit_WithoutLOCK	0
 #define	CefC_Pit_WithLOCK		(~CefC_Pit_WithoutLOCK)
 
@@ -98,7 +110,7 @@ typedef struct CefT_Up_Faces {
 /* PIT entry														*/
 /*------------------------------------------------------------------*/
 
-typedef struct {
+typedef struct CefT_Pit_Entry {
 
 	unsigned char 		resv4malloc[16];	/* reserved area for malloc					*/
 
@@ -125,15 +137,48 @@ typedef struct {
 	uint8_t				hoplimit;			/* Hop Limit of Forwarding Interest 		*/
 	int					PitType;			/* PitType									*/
 	int64_t				Last_chunk_num;		/* Last Forward Object Chunk Number 		*/
+	uint8_t 			objhash_f;			/* set to 1 if the key has ObjHashRestr		*/
+
+	atomic_uint 		pe_lock;			/* 1 while the entry is locked				*/
 
-	pthread_mutex_t 	pe_mutex_pt;		/* mutex for thread safe for Pthread 		*/
+	/*--------------------------------------------
+		Variables related to the PIT memory
+	----------------------------------------------*/
+	uint8_t 			slab_class;			/* size class of the slab holding the entry	*/
+	uint8_t 			dnface_inl_used;	/* bitmap of the used dnface_inl			*/
+	uint8_t 			upface_inl_used;	/* bitmap of the used upface_inl			*/
+	CefT_Down_Faces 	dnface_inl[CefC_Pit_Inline_DnFaces];
+	CefT_Up_Faces 		upface_inl[CefC_Pit_Inline_UpFaces];
+
+	/*--------------------------------------------
+		Variables related to the expiry wheel
+	----------------------------------------------*/
+	struct CefT_Pit_Wheel* 	tw_wheel;		/* expiry wheel of the PIT					*/
+	struct CefT_Pit_Entry* 	tw_next;		/* next entry in the same slot				*/
+	struct CefT_Pit_Entry** tw_pprev;		/* link which points to this entry			*/
+	uint64_t 				tw_tick;		/* tick when this entry is checked			*/
 
 	/********************** Key entity follows here **************************/
-	/*  entry = (CefT_Pit_Entry*) malloc(sizeof (CefT_Pit_Entry) + name_len) */
-	/*  entry->key = (unsigned char*)entry + sizeof (CefT_Pit_Entry)         */
+	/*  entry is taken from the slab which holds sizeof (CefT_Pit_Entry)     */
+	/*  + name_len, and entry->key = (unsigned char*)entry + sizeof (...)    */
 	/********************** Key entity follows here **************************/
 } CefT_Pit_Entry;
 
+/*------------------------------------------------------------------*/
+/* Statistics of the PIT expiry wheel								*/
+/*------------------------------------------------------------------*/
+
+typedef struct {
+
+	uint32_t 			tick_us;			/* Tick of the wheel (usec)					*/
+	uint32_t 			scheduled;			/* Number of the entries in the wheel		*/
+	uint64_t 			ticks;				/* Number of the processed ticks			*/
+	uint64_t 			expired;			/* Number of the expired entries			*/
+	uint32_t 			last_expired;		/* Expired entries at the last advance		*/
+	uint32_t 			max_tick_expired;	/* Max number of entries expired in a tick 	*/
+
+} CefT_Pit_Expiry_Stat;
+
 /****************************************************************************************
  Global Variables
  ****************************************************************************************/
@@ -333,6 +378,59 @@ cef_pit_entry_lookup_with_lock (
 	int	with_lock,							/* entry lock flag							*/
 	unsigned int key_type_f					/* Flag to make PIT key with KeyID or COH	*/
 );
+/*--------------------------------------------------------------------------------------
+	Creates the expiry wheel of the specified PIT
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+cef_pit_expiry_init (
+	CefT_Hash_Handle pit,					/* PIT										*/
+	uint64_t nowt							/* current time (usec)						*/
+);
+/*--------------------------------------------------------------------------------------
+	Destroys the expiry wheel of the specified PIT
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_expiry_destroy (
+	CefT_Hash_Handle pit					/* PIT										*/
+);
+/*--------------------------------------------------------------------------------------
+	Advances the expiry wheel and collects the entries which need to be checked
+----------------------------------------------------------------------------------------*/
+int											/* Number of the collected entries			*/
+cef_pit_expiry_advance (
+	CefT_Hash_Handle pit,					/* PIT										*/
+	uint64_t nowt							/* current time (usec)						*/
+);
+/*--------------------------------------------------------------------------------------
+	Takes out one of the entries collected by cef_pit_expiry_advance
+----------------------------------------------------------------------------------------*/
+CefT_Pit_Entry* 							/* PIT entry, or NULL if no entry remains	*/
+cef_pit_expiry_pop (
+	CefT_Hash_Handle pit					/* PIT										*/
+);
+/*--------------------------------------------------------------------------------------
+	Schedules the check of the specified PIT entry at the next time it needs
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_entry_expiry_refresh (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the statistics of the expiry wheel of the specified PIT
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+cef_pit_expiry_stat_get (
+	CefT_Hash_Handle pit,					/* PIT										*/
+	CefT_Pit_Expiry_Stat* stat				/* statistics to return						*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the memory pools which hold the PIT entries and their faces
+----------------------------------------------------------------------------------------*/
+int											/* Number of the returned pools				*/
+cef_pit_mpool_handles_get (
+	CefT_Mp_Handle* mps,					/* memory pools to return					*/
+	int max									/* capacity of mps							*/
+);
 #ifdef REFLEXIVE_FORWARDING
 /*--------------------------------------------------------------------------------------
 	Searches a t-PIT entry matching the specified Name with chunk number
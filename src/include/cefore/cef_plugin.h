@@ -188,7 +188,9 @@ typedef	enum	{
 typedef struct {
 
 	int 			type;							/* CefC_Elem_Type_XXX 				*/
-	unsigned char	msg[CefC_Max_Msg_Size]; 		/* message 							*/
+	unsigned char*	msg; 							/* message, which is held by pkt 	*/
+	CefT_Pkt_Buf*	pkt;							/* buffer shared by the elements 	*/
+													/* which send the same message 		*/
 
 	uint16_t 		msg_len;						/* length of the message 			*/
 	uint16_t 		faceids[CefC_Elem_Face_Num];	/* outgoing FaceIDs that were 		*/
@@ -422,6 +424,32 @@ CefT_Plugin_Tag* 									/* tag informations					*/
 cef_plugin_tag_get (
 	const char* tag 								/* tag 								*/
 );
+/*--------------------------------------------------------------------------------------
+	Sets the copy of the specified message to the TX element
+----------------------------------------------------------------------------------------*/
+int 												/* Returns a negative value if it 	*/
+													/* fails 							*/
+cef_plugin_tx_elem_msg_set (
+	CefT_Tx_Elem* 		tx_elem,					/* TX element 						*/
+	const unsigned char* msg,						/* message 							*/
+	uint16_t 			msg_len						/* length of the message 			*/
+);
+/*--------------------------------------------------------------------------------------
+	Lets the TX element refer to the message of the other one without copying it
+----------------------------------------------------------------------------------------*/
+void
+cef_plugin_tx_elem_msg_share (
+	CefT_Tx_Elem* 		tx_elem,					/* TX element 						*/
+	const CefT_Tx_Elem* src_elem					/* TX element which has the message */
+);
+/*--------------------------------------------------------------------------------------
+	Releases the message of the TX element and frees the element
+----------------------------------------------------------------------------------------*/
+void
+cef_plugin_tx_elem_free (
+	CefT_Mp_Handle 		tx_que_mp,					/* Memory Pool for CefT_Tx_Elem 	*/
+	CefT_Tx_Elem* 		tx_elem						/* TX element 						*/
+);
 
 
 /*=======================================================================================
@@ -38,12 +38,23 @@
  ****************************************************************************************/
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <pthread.h>
 
 /****************************************************************************************
  Macros
  ****************************************************************************************/
 
+#define CefC_Rngque_CacheLine		64			/* size of a cache line 				*/
+#define CefC_Rngque_Max				(1 << 30)	/* maximum capacity 					*/
+
+/********** Flags of cef_rngque_create_ext 	**********/
+#define CefC_Rngque_MultiThread		0x00		/* any thread pushes and pops 			*/
+#define CefC_Rngque_SingleProd		0x01		/* only one thread pushes 				*/
+#define CefC_Rngque_SingleCons		0x02		/* only one thread pops 				*/
+#define CefC_Rngque_Mpsc			CefC_Rngque_SingleCons
+#define CefC_Rngque_Spsc			(CefC_Rngque_SingleProd | CefC_Rngque_SingleCons)
 
 /****************************************************************************************
  Structure Declarations
@@ -55,16 +66,25 @@ typedef struct {
 
 } CefT_Rngque_Elem;
 
+/********** Position of the producers or the consumers 	**********/
+typedef struct {
+
+	_Atomic uint32_t head;			/* next index to be reserved 						*/
+	_Atomic uint32_t tail;			/* index up to which the reservations completed 	*/
+
+} __attribute__ ((aligned (CefC_Rngque_CacheLine))) CefT_Rngque_Pos;
+
 /********** Tx queue (ring buffer) 	**********/
 typedef struct {
 
-	int top;						/* top of the ring buffer 							*/
-	int bottom;						/* bottom of the ring buffer 						*/
-	int mask;						/* capacity of the ring buffer 						*/
+	CefT_Rngque_Pos prod;			/* producers (bottom of the ring buffer) 			*/
+	CefT_Rngque_Pos cons;			/* consumers (top of the ring buffer) 				*/
+	uint32_t mask;					/* capacity of the ring buffer - 1 					*/
+	uint32_t capacity;				/* capacity of the ring buffer 						*/
+	int flags;						/* CefC_Rngque_XXX 									*/
 	CefT_Rngque_Elem* que;			/* line buffer 										*/
-	pthread_mutex_t mutex;			/* mutex for thread safe 							*/
-	
-} CefT_Rngque;
+
+} __attribute__ ((aligned (CefC_Rngque_CacheLine))) CefT_Rngque;
 
 /****************************************************************************************
  Global Variables
@@ -76,10 +96,21 @@ typedef struct {
  Function Declarations
  ****************************************************************************************/
 
+/*--------------------------------------------------------------------------------------
+	Creates Ring Queue which any thread can push to and pop from
+----------------------------------------------------------------------------------------*/
 CefT_Rngque* 								/* Created Ring Queue Information 			*/
 cef_rngque_create (
 	int capacity							/* Capacity of Ring queue 					*/
 );
+/*--------------------------------------------------------------------------------------
+	Creates Ring Queue specialized for the number of producers and consumers
+----------------------------------------------------------------------------------------*/
+CefT_Rngque* 								/* Created Ring Queue Information 			*/
+cef_rngque_create_ext (
+	int capacity,							/* Capacity of Ring queue 					*/
+	int flags								/* CefC_Rngque_XXX 							*/
+);
 void
 cef_rngque_destroy (
 	CefT_Rngque* qp							/* Ring Queue Information 					*/
@@ -95,6 +126,24 @@ void*										/* item which is removed from queue 		*/
 cef_rngque_pop (
 	CefT_Rngque* qp							/* Ring Queue Information 					*/
 );
+/*--------------------------------------------------------------------------------------
+	Inserts the items to the bottom of Ring Queue as many as possible
+----------------------------------------------------------------------------------------*/
+int											/* number of inserted items 				*/
+cef_rngque_push_bulk (
+	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
+	void* items[],
+	int num									/* number of items 							*/
+);
+/*--------------------------------------------------------------------------------------
+	Removes up to the specified number of items from the top of Ring Queue
+----------------------------------------------------------------------------------------*/
+int											/* number of removed items 					*/
+cef_rngque_pop_bulk (
+	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
+	void* items[],
+	int num									/* maximum number of items 					*/
+);
 /*--------------------------------------------------------------------------------------
 	Read the value (int) from the top of Ring Queue
 ----------------------------------------------------------------------------------------*/
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cef_shmring.h
+ */
+
+#ifndef __CEF_SHMRING_HEADER__
+#define __CEF_SHMRING_HEADER__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdint.h>
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Shmring_Desc_Num		4096		/* descriptors of a ring (power of 2) 	*/
+#define CefC_Shmring_Data_Size		0x400000	/* buffers of a ring (power of 2) 		*/
+#define CefC_Shmring_Fd_Num			3			/* memfd and eventfds of both rings 	*/
+#define CefC_Shmring_Attach_Wait	1000		/* wait for the answer of cefnetd (ms) 	*/
+
+/* Roles of the ends. cefnetd creates the shared memory and the application 	*/
+/* attaches it with the FDs passed over the local socket 						*/
+#define CefC_Shmring_Side_Netd		0
+#define CefC_Shmring_Side_App		1
+
+/* Messages exchanged over the local socket to attach the shared memory 	*/
+#define CefC_Shmring_Attach			"/ATTACH:Shmring"
+#define CefC_Shmring_Attach_Ok		"/ACCEPT:Shmring"
+#define CefC_Shmring_Attach_Ng		"/REJECT:Shmring"
+
+/****************************************************************************************
+ Structure Declarations
+ ****************************************************************************************/
+
+/********** Pair of the rings shared by an application and cefnetd 	**********/
+typedef struct CefT_Shmring CefT_Shmring;
+
+/****************************************************************************************
+ Function Declarations
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Creates the shared memory with the rings of both directions and the eventfds.
+	Returns NULL if memfd or eventfd is not available (e.g. not Linux)
+----------------------------------------------------------------------------------------*/
+CefT_Shmring*								/* created rings or NULL 					*/
+cef_shmring_create (
+	void
+);
+/*--------------------------------------------------------------------------------------
+	Maps the shared memory created by cefnetd. The FDs are owned by the returned
+	rings, or closed if it fails
+----------------------------------------------------------------------------------------*/
+CefT_Shmring*								/* attached rings or NULL 					*/
+cef_shmring_attach (
+	int fds[]								/* FDs received by cef_shmring_fds_recv 	*/
+);
+/*--------------------------------------------------------------------------------------
+	Unmaps the shared memory and closes the FDs
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_destroy (
+	CefT_Shmring* shm
+);
+/*--------------------------------------------------------------------------------------
+	Sends the message with the FDs of the shared memory (SCM_RIGHTS)
+----------------------------------------------------------------------------------------*/
+int											/* bytes sent, negative if it fails 		*/
+cef_shmring_fds_send (
+	int sock,								/* local socket of the application 			*/
+	CefT_Shmring* shm,
+	const void* msg,
+	int msg_len
+);
+/*--------------------------------------------------------------------------------------
+	Receives the message and the FDs sent by cef_shmring_fds_send. The FDs which
+	were not passed are set to -1
+----------------------------------------------------------------------------------------*/
+int											/* bytes received, negative if it fails 	*/
+cef_shmring_fds_recv (
+	int sock,								/* local socket connected to cefnetd 		*/
+	void* buff,
+	int buff_len,
+	int fds[]								/* CefC_Shmring_Fd_Num entries 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Returns the eventfd which becomes readable when the peer puts the frames
+	into the receive ring while this end sleeps
+----------------------------------------------------------------------------------------*/
+int
+cef_shmring_event_fd (
+	CefT_Shmring* shm
+);
+/*--------------------------------------------------------------------------------------
+	Reserves the contiguous buffer of the specified length in the send ring, so
+	that the frame is created in place. The ring is locked until the commit
+----------------------------------------------------------------------------------------*/
+unsigned char*								/* NULL if the ring is full 				*/
+cef_shmring_reserve (
+	CefT_Shmring* shm,
+	int len
+);
+/*--------------------------------------------------------------------------------------
+	Passes the frame created in the reserved buffer to the peer, and wakes it up
+	if it sleeps. Zero length cancels the reservation
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_commit (
+	CefT_Shmring* shm,
+	int len									/* length of the frame 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Copies the frame into the send ring
+----------------------------------------------------------------------------------------*/
+int											/* length sent, 0 if the ring is full 		*/
+cef_shmring_send (
+	CefT_Shmring* shm,
+	const unsigned char* msg,
+	int msg_len
+);
+/*--------------------------------------------------------------------------------------
+	Copies the frames in the receive ring into the buffer like a stream socket.
+	A frame longer than the buffer is read by the following calls
+----------------------------------------------------------------------------------------*/
+int											/* bytes copied, 0 if the ring is empty, 	*/
+											/* negative if the ring is broken 			*/
+cef_shmring_recv (
+	CefT_Shmring* shm,
+	unsigned char* buff,
+	int buff_len
+);
+/*--------------------------------------------------------------------------------------
+	Clears the eventfd and asks the peer to wake this end up with the next frame.
+	Returns 0 without sleeping if the frames have arrived in the meantime
+----------------------------------------------------------------------------------------*/
+int											/* 1 if the caller may wait on the eventfd 	*/
+cef_shmring_sleep (
+	CefT_Shmring* shm
+);
+/*--------------------------------------------------------------------------------------
+	Makes the eventfd of this end readable, so that the receiver which has
+	stopped with the frames left in the ring is called again
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_kick (
+	CefT_Shmring* shm
+);
+
+#endif // __CEF_SHMRING_HEADER__
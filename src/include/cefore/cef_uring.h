@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cef_uring.h
+ */
+
+#ifndef __CEF_URING_HEADER__
+#define __CEF_URING_HEADER__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdint.h>
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Uring_Depth_Max		256			/* maximum number of I/Os in flight 	*/
+#define CefC_Uring_Align			4096		/* alignment of the buffers (O_DIRECT) 	*/
+#define CefC_Uring_No_Buff			-1			/* I/O which uses no buffer 			*/
+
+/****************************************************************************************
+ Structure Declarations
+ ****************************************************************************************/
+
+/********** io_uring instance and its registered buffers 	**********/
+typedef struct CefT_Uring CefT_Uring;
+
+/****************************************************************************************
+ Function Declarations
+ ****************************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+	Creates the io_uring instance and registers the buffers used by the I/Os.
+	Returns NULL if io_uring is not available (e.g. not Linux or disabled kernel)
+----------------------------------------------------------------------------------------*/
+CefT_Uring*									/* created instance or NULL 				*/
+cef_uring_create (
+	int depth,								/* number of I/Os in flight (and buffers) 	*/
+	uint32_t buff_size						/* size of each buffer 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Destroys the io_uring instance. The I/Os in flight are waited for
+----------------------------------------------------------------------------------------*/
+void
+cef_uring_destroy (
+	CefT_Uring* ring						/* io_uring instance 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Returns a free buffer. NULL if all buffers are used by the I/Os in flight
+----------------------------------------------------------------------------------------*/
+unsigned char*								/* head of the buffer 						*/
+cef_uring_buff_get (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int* buff_idx							/* index of the buffer 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Queues the write of the buffer. The buffer is released when the write completes
+----------------------------------------------------------------------------------------*/
+int											/* negative if the queue is full 			*/
+cef_uring_write (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int fd,
+	int buff_idx,							/* index of the buffer to write 			*/
+	uint32_t len,
+	uint64_t offset,
+	uint16_t tag							/* returned with the completion 			*/
+);
+/*--------------------------------------------------------------------------------------
+	Queues the read into the buffer. The buffer is released when the read
+	completes, so the caller reads it before the next cef_uring_buff_get
+----------------------------------------------------------------------------------------*/
+int											/* negative if the queue is full 			*/
+cef_uring_read (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int fd,
+	int buff_idx,							/* index of the buffer to read into 		*/
+	uint32_t len,
+	uint64_t offset,
+	uint16_t tag							/* returned with the completion 			*/
+);
+/*--------------------------------------------------------------------------------------
+	Queues the posix_fadvise of the range of the file (e.g. read-ahead)
+----------------------------------------------------------------------------------------*/
+int											/* negative if the queue is full 			*/
+cef_uring_fadvise (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int fd,
+	uint64_t offset,
+	uint32_t len,
+	int advice,								/* POSIX_FADV_XXX 							*/
+	uint16_t tag							/* returned with the completion 			*/
+);
+/*--------------------------------------------------------------------------------------
+	Submits the queued I/Os to the kernel
+----------------------------------------------------------------------------------------*/
+int											/* number of submitted I/Os 				*/
+cef_uring_submit (
+	CefT_Uring* ring						/* io_uring instance 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains a completion. With wait_f, waits until one of the I/Os completes
+----------------------------------------------------------------------------------------*/
+int											/* 1: completed, 0: none, negative: error 	*/
+cef_uring_reap (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int wait_f,
+	uint16_t* tag,							/* tag of the I/O 							*/
+	int* fd,								/* FD of the I/O 							*/
+	int* res								/* result (bytes or -errno) 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Returns the number of the I/Os queued or in flight
+----------------------------------------------------------------------------------------*/
+int
+cef_uring_inflight (
+	CefT_Uring* ring						/* io_uring instance 						*/
+);
+
+#endif // __CEF_URING_HEADER__
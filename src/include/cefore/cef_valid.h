@@ -46,6 +46,12 @@
 #define	CefC_ValidTypeStr_RSA256 "rsa-sha256"
 // #define CRC32C_POLY 0x1EDC6F41    /* Forward polynomial of CRC. */
 
+/* Implementations of CRC32C for cef_valid_crc32c_impl_set 		*/
+#define CefC_Crc32c_Impl_Auto		0		/* Fastest one which the CPU supports	*/
+#define CefC_Crc32c_Impl_Table		1		/* One byte per step (original)			*/
+#define CefC_Crc32c_Impl_Slice8		2		/* Slicing-by-8							*/
+#define CefC_Crc32c_Impl_Sse42		3		/* crc32 instruction of SSE4.2 (x86-64)	*/
+
 /****************************************************************************************
  Structure Declarations
  ****************************************************************************************/
@@ -83,6 +89,14 @@ cef_valid_crc32c_calc (
 	const unsigned char* buf,
 	size_t len
 );
+/*--------------------------------------------------------------------------------------
+	Selects the implementation used by cef_valid_crc32c_calc. Returns the selected
+	CefC_Crc32c_Impl_XXX, or -1 if the CPU does not support it.
+----------------------------------------------------------------------------------------*/
+int
+cef_valid_crc32c_impl_set (
+	int impl
+);
 int
 cef_valid_get_pubkey (
 	const unsigned char* msg,
@@ -110,6 +124,15 @@ cef_valid_msg_verify (
 	const unsigned char* msg,
 	int msg_len
 );
+/*--------------------------------------------------------------------------------------
+	Checks whether cef_valid_msg_verify has to verify the public key signature of
+	the message, which costs far more than the CRC32C.
+----------------------------------------------------------------------------------------*/
+int 								/* 1 if the message is signed with RSA-SHA256		*/
+cef_valid_msg_pubkey_signed (
+	const unsigned char* msg,
+	int msg_len
+);
 
 int
 cef_valid_keyid_create_forccninfo (
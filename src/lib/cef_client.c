@@ -73,6 +73,7 @@ static char cbd_lsock_name[2048] = {"/tmp/cbd_9896.0"};
 static char cef_conf_dir[PATH_MAX*2] = {"/usr/local/cefore"};
 static int  cef_port_num = CefC_Default_PortNum;
 static unsigned char* work_buff = NULL;
+static int  cef_shmring_use_f = 0;				/* Uses the rings shared with cefnetd 	*/
 
 /****************************************************************************************
  Static Function Declaration
@@ -87,6 +88,30 @@ cef_client_trim_line_string (
 	char* p2,									/* name string after trimming			*/
 	char* p3									/* value string after trimming			*/
 );
+/*--------------------------------------------------------------------------------------
+	Asks cefnetd for the shared memory rings. The connection keeps using the
+	socket if cefnetd rejects it or does not answer
+----------------------------------------------------------------------------------------*/
+static void
+cef_client_shmring_attach (
+	CefT_Connect* conn							/* connection to cefnetd 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Reserves the buffer to create a frame in the shared memory
+----------------------------------------------------------------------------------------*/
+static unsigned char* 							/* NULL if cefnetd does not read it 	*/
+cef_client_shmring_reserve (
+	CefT_Connect* conn							/* connection to cefnetd 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Reads the frames from the shared memory
+----------------------------------------------------------------------------------------*/
+static int 										/* length of read buffer 				*/
+cef_client_shmring_read (
+	CefT_Connect* conn,							/* connection to cefnetd 				*/
+	unsigned char* buff, 						/* buffer to write the message 			*/
+	int len 									/* length of buffer 					*/
+);
 
 
 /*--------------------------------------------------------------------------------------
@@ -170,6 +195,15 @@ cef_client_init (
 				return (-1);
 			}
 			strcpy (lsock_id, ws);
+		} else if (strcmp (pname, CefC_ParamName_LocalShmRing) == 0) {
+			res = atoi (ws);
+			if ((res != 0) && (res != 1)) {
+				cef_log_write (CefC_Log_Error,
+					"[client] %s must be 0 or 1.\n", CefC_ParamName_LocalShmRing);
+				fclose (fp);
+				return (-1);
+			}
+			cef_shmring_use_f = res;
 		}
 	}
 	if (port_num == CefC_Unset_Port) {
@@ -300,6 +334,10 @@ cef_client_connect (
 	memset (conn, 0, sizeof (CefT_Connect));
 	conn->sock = sock;
 
+	if (cef_shmring_use_f) {
+		cef_client_shmring_attach (conn);
+	}
+
 	return ((CefT_Client_Handle) conn);
 }
 CefT_Client_Handle 								/* created client handle 				*/
@@ -534,8 +572,10 @@ cef_client_close (
 	if (conn->ai) {
 		free (conn);
 	} else {
+		/* cefnetd reads the frames left in the rings before it closes the Face 	*/
 		send (conn->sock, CefC_Face_Close, strlen (CefC_Face_Close), 0);
 		close (conn->sock);
+		cef_shmring_destroy (conn->shm);
 		free (conn);
 	}
 	if (work_buff) {
@@ -730,6 +770,88 @@ cef_client_conn_send(
 	}
 	return ( ret );
 }
+/*--------------------------------------------------------------------------------------
+	Asks cefnetd for the shared memory rings. The connection keeps using the
+	socket if cefnetd rejects it or does not answer
+----------------------------------------------------------------------------------------*/
+static void
+cef_client_shmring_attach (
+	CefT_Connect* conn							/* connection to cefnetd 				*/
+) {
+	int req_len = strlen (CefC_Shmring_Attach);
+	int rsp_len = strlen (CefC_Shmring_Attach_Ok);
+	char rsp[64];
+	int fds[CefC_Shmring_Fd_Num];
+	struct pollfd infds[1];
+	int i;
+
+	if (send (conn->sock, CefC_Shmring_Attach, req_len, 0) != req_len) {
+		return;
+	}
+	infds[0].fd = conn->sock;
+	infds[0].events = POLLIN | POLLERR;
+	if (poll (infds, 1, CefC_Shmring_Attach_Wait) < 1) {
+		cef_log_write (CefC_Log_Warn,
+			"[client] cefnetd did not answer to the request of the shared memory\n");
+		return;
+	}
+
+	/* Both answers have the same length, so the following frames are not read 	*/
+	if ((cef_shmring_fds_recv (conn->sock, rsp, rsp_len, fds) == rsp_len) &&
+		(memcmp (rsp, CefC_Shmring_Attach_Ok, rsp_len) == 0)) {
+		conn->shm = cef_shmring_attach (fds);
+	} else {
+		for (i = 0 ; i < CefC_Shmring_Fd_Num ; i++) {
+			if (fds[i] >= 0) {
+				close (fds[i]);
+			}
+		}
+	}
+	if (conn->shm) {
+		cef_log_write (CefC_Log_Info, "[client] Frames are exchanged via the shared memory\n");
+	} else {
+		cef_log_write (CefC_Log_Info, "[client] Frames are exchanged via the local socket\n");
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Reserves the buffer to create a frame in the shared memory. It waits for
+	cefnetd to read the rings as long as the send to the socket is retried
+----------------------------------------------------------------------------------------*/
+static unsigned char* 							/* NULL if cefnetd does not read it 	*/
+cef_client_shmring_reserve (
+	CefT_Connect* conn							/* connection to cefnetd 				*/
+) {
+	unsigned char* wp;
+
+	for ( int i = 0; i < CefC_Conn_Send_RetryMax; i++ ){
+		wp = cef_shmring_reserve (conn->shm, CefC_Max_Length);
+		if (wp) {
+			return (wp);
+		}
+		CefC_Conn_Send_RetryWait(i);
+	}
+cef_dbg_write (CefC_Dbg_Fine, "Failure:shared memory is full\n");
+
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Reads the frames from the shared memory
+----------------------------------------------------------------------------------------*/
+static int 										/* length of read buffer 				*/
+cef_client_shmring_read (
+	CefT_Connect* conn,							/* connection to cefnetd 				*/
+	unsigned char* buff, 						/* buffer to write the message 			*/
+	int len 									/* length of buffer 					*/
+) {
+	int recv_len;
+
+	recv_len = cef_shmring_recv (conn->shm, buff, len);
+	if (recv_len < 0) {
+		/* cefnetd has broken the rings 	*/
+		return (CefC_AppConn_Eof);
+	}
+	return (recv_len);
+}
 /*--------------------------------------------------------------------------------------
 	Inputs the unformatted message to the socket
 ----------------------------------------------------------------------------------------*/
@@ -742,6 +864,24 @@ cef_client_message_input (
 	CefT_Connect* conn = (CefT_Connect*) fhdl;
 	int	send_len = 0, frame_len = len;
 
+	if (conn->shm) {
+		/* cefnetd reads the rings as a stream, so a long message is split 	*/
+		for ( int i = 0; i < CefC_Conn_Send_RetryMax && send_len < frame_len; ){
+			int seg_len = frame_len - send_len;
+
+			if (seg_len > CefC_Max_Length) {
+				seg_len = CefC_Max_Length;
+			}
+			if (cef_shmring_send (conn->shm, &msg[send_len], seg_len) == seg_len) {
+				send_len += seg_len;
+				continue;
+			}
+			CefC_Conn_Send_RetryWait(i);
+			i++;
+		}
+		return ( send_len );
+	}
+
 	for ( int i = 0; i < CefC_Conn_Send_RetryMax; i++ ){
 		int		ret = 0;
 
@@ -776,6 +916,18 @@ cef_client_interest_input (
 	unsigned char buff[CefC_Max_Length];
 	int	send_len = 0, frame_len;
 
+	if (conn->shm) {
+		/* The frame is created in the rings instead of the stack buffer 		*/
+		unsigned char* wp = cef_client_shmring_reserve (conn);
+
+		if (wp == NULL) {
+			return ( 0 );
+		}
+		frame_len = cef_frame_interest_create (wp, opt, tlvs);
+		cef_shmring_commit (conn->shm, (frame_len > 0) ? frame_len : 0);
+		return ( frame_len );
+	}
+
 	frame_len = cef_frame_interest_create (buff, opt, tlvs);
 	if ( frame_len < 0 ) {
 		return( frame_len );
@@ -815,6 +967,18 @@ cef_client_object_input (
 	unsigned char buff[CefC_Max_Length];
 	int	send_len = 0, frame_len;
 
+	if (conn->shm) {
+		/* The frame is created in the rings instead of the stack buffer 		*/
+		unsigned char* wp = cef_client_shmring_reserve (conn);
+
+		if (wp == NULL) {
+			return ( 0 );
+		}
+		frame_len = cef_frame_object_create (wp, opt, tlvs);
+		cef_shmring_commit (conn->shm, (frame_len > 0) ? frame_len : 0);
+		return ( frame_len );
+	}
+
 	frame_len = cef_frame_object_create (buff, opt, tlvs);
 	if ( frame_len < 0 ) {
 		return( frame_len );
@@ -853,6 +1017,18 @@ cef_client_ccninfo_input (
 	unsigned char buff[CefC_Max_Length];
 	int	send_len = 0, frame_len;
 
+	if (conn->shm) {
+		/* The frame is created in the rings instead of the stack buffer 		*/
+		unsigned char* wp = cef_client_shmring_reserve (conn);
+
+		if (wp == NULL) {
+			return ( 0 );
+		}
+		frame_len = cef_frame_ccninfo_req_create (wp, tlvs);
+		cef_shmring_commit (conn->shm, (frame_len > 0) ? frame_len : 0);
+		return ( frame_len );
+	}
+
 	frame_len = cef_frame_ccninfo_req_create (buff, tlvs);
 	if ( frame_len < 0 ) {
 		return( frame_len );
@@ -891,18 +1067,43 @@ cef_client_read_core (
 ) {
 	CefT_Connect* conn = (CefT_Connect*) fhdl;
 	int recv_len = 0;
-	struct pollfd infds[1];
+	struct pollfd infds[2];
+	int nfds = 1;
 	struct sockaddr_storage sas;
 	socklen_t sas_len = (socklen_t) sizeof (struct sockaddr_storage);
 
 	infds[0].fd = conn->sock;
 	infds[0].events = POLLIN | POLLERR;
+	infds[0].revents = 0;
+
+	if (conn->shm) {
+		/* The frames come from the rings, and the responses to the control 	*/
+		/* messages and the hang-up of cefnetd come from the socket 			*/
+		recv_len = cef_client_shmring_read (conn, buff, len);
+		if (recv_len != 0) {
+			return (recv_len);
+		}
+		infds[1].fd = cef_shmring_event_fd (conn->shm);
+		infds[1].events = POLLIN;
+		infds[1].revents = 0;
+		nfds = 2;
+		if (cef_shmring_sleep (conn->shm) == 0) {
+			timeout = 0;
+		}
+	}
 
 	/* ppoll can improve the accuracy of timeout,
 	   but ppoll is Linux-specific and not portable. */
-	poll (infds, 1, timeout);
+	poll (infds, nfds, timeout);
 	errno = 0;
 
+	if (conn->shm) {
+		recv_len = cef_client_shmring_read (conn, buff, len);
+		if (recv_len != 0) {
+			return (recv_len);
+		}
+	}
+
 	if (infds[0].revents != 0) {
 		if (infds[0].revents & (POLLERR | POLLNVAL | POLLHUP)) {
 			if (conn->ai) {
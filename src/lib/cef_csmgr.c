@@ -40,6 +40,10 @@
 /****************************************************************************************
  Include Files
  ****************************************************************************************/
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+
 #include <cefore/cef_client.h>
 #include <cefore/cef_csmgr.h>
 #include <cefore/cef_define.h>
@@ -59,10 +63,63 @@ uint32_t bchunk = 0xFFFF;
 #define	CefC_PipeWrite_RetryMax		30
 #define	CefC_PipeWrite_RetryWait(n)	usleep((n+1)*1000)
 
+#define	CefC_Lcache_Pending_Max		1024		/* Power of 2 						*/
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/*------------------------------------------------------------------*/
+/* Shared memory index published by csmgrd. The region consists of	*/
+/* the header, the slots and the arena. Only csmgrd writes to it;	*/
+/* cefnetd maps it read only and validates every copy it takes.		*/
+/*------------------------------------------------------------------*/
+typedef struct {
+	uint32_t 			magic;
+	uint32_t 			version;
+	uint32_t 			slot_num;					/* Power of 2						*/
+	uint32_t 			seed;						/* Seed of the hash of the names	*/
+	uint64_t 			arena_size;
+	atomic_uint 		active;						/* Cleared when csmgrd stops		*/
+	_Atomic uint64_t 	arena_head;					/* Monotonic write position			*/
+} CefT_Csmgr_Shm_Hdr;
+
+typedef struct {
+	atomic_uint 		seq;						/* Odd while the slot is updated	*/
+	uint32_t 			hashv;
+	uint16_t 			key_len;					/* 0 if the slot is empty			*/
+	uint16_t 			ver_len;
+	uint16_t 			msg_len;
+	uint16_t 			reserved;
+	uint64_t 			pos;						/* Position of the record (key,		*/
+													/* version, Cob) in the arena		*/
+	uint64_t 			cache_time;
+	uint64_t 			expiry;
+} CefT_Csmgr_Shm_Slot;
+
+#define CefC_Csmgr_Shm_Hdr_Size		((sizeof (CefT_Csmgr_Shm_Hdr) + 63) & ~((size_t) 63))
+#define CefC_Csmgr_Shm_Slots(hdr)	\
+	((CefT_Csmgr_Shm_Slot*)((unsigned char*)(hdr) + CefC_Csmgr_Shm_Hdr_Size))
+#define CefC_Csmgr_Shm_Hash_Init(hdr)	(2166136261u ^ (hdr)->seed)
+#define CefC_Csmgr_Shm_Arena(hdr)	\
+	((unsigned char*)(CefC_Csmgr_Shm_Slots (hdr) + (hdr)->slot_num))
+
+#ifdef CefC_CefnetdCache
+/*------------------------------------------------------------------*/
+/* Cob which cefnetd has written to the put thread of the local		*/
+/* cache and which the thread may not have stored yet				*/
+/*------------------------------------------------------------------*/
+typedef struct {
+	uint32_t 			hashv;
+	uint16_t 			name_len;
+	uint16_t 			ver_len;
+	uint16_t 			msg_len;
+	uint64_t 			cache_time;
+	uint64_t 			expiry;
+	unsigned char* 		buff;						/* Name, version and Cob			*/
+} CefT_Lcache_Pending;
+#endif // CefC_CefnetdCache
+
 
 /****************************************************************************************
  State Variables
@@ -71,6 +128,21 @@ uint32_t bchunk = 0xFFFF;
 static unsigned char* 	cefnetd_msg_buff 		= NULL;
 static int 				cefnetd_msg_buff_index 	= 0;
 static unsigned char* 	work_msg_buff 			= NULL;
+static unsigned char* 	cefnetd_lookup_buff 	= NULL;
+static int 				cefnetd_lookup_buff_index = 0;
+
+static CefT_Csmgr_Shm_Hdr* 	csmgr_shm_hdr 		= NULL;		/* csmgrd side 				*/
+static size_t 				csmgr_shm_size 		= 0;
+static char 				csmgr_shm_name[256] 	= {0};
+static pthread_mutex_t 		csmgr_shm_mutex 	= PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef CefC_CefnetdCache
+/* Cobs written to the put thread in the order of the writes. Only the main thread 	*/
+/* of cefnetd touches them; the n-th write is lcache_pending[n & (Max - 1)]. 		*/
+static CefT_Lcache_Pending 	lcache_pending[CefC_Lcache_Pending_Max];
+static uint64_t 			lcache_pending_head = 0;	/* Oldest write held			*/
+static uint64_t 			lcache_pending_tail = 0;	/* Number of writes 			*/
+#endif // CefC_CefnetdCache
 
 /****************************************************************************************
  Static Function Declaration
@@ -105,6 +177,89 @@ cef_csmgr_send_msg_to_csmgr (
 	unsigned char* msg,						/* send message								*/
 	int msg_len								/* message length							*/
 );
+/*--------------------------------------------------------------------------------------
+	Queues the Interest message for csmgrd until the end of this event loop pass
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+cef_csmgr_excache_lookup_queue (
+	CefT_Cs_Stat* cs_stat,					/* Content Store status						*/
+	unsigned char* msg,						/* Interest message							*/
+	int msg_len								/* message length							*/
+);
+/*--------------------------------------------------------------------------------------
+	Creates the name of the shared memory index from the local socket name
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_shm_name_create (
+	const char* local_sock_name,			/* Local socket name of csmgrd				*/
+	char* name								/* Name of the region						*/
+);
+/*--------------------------------------------------------------------------------------
+	Computes the hash value of the name in the shared memory index
+----------------------------------------------------------------------------------------*/
+static uint32_t
+cef_csmgr_shm_hashv_get (
+	uint32_t hashv,							/* Hash value of the preceding bytes		*/
+	const unsigned char* key,
+	uint16_t klen
+);
+/*--------------------------------------------------------------------------------------
+	Clears the active flag of the region left by csmgrd which was killed
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_shm_stale_deactivate (
+	const char* name						/* Name of the region						*/
+);
+/*--------------------------------------------------------------------------------------
+	Attaches to the shared memory index published by csmgrd
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+cef_csmgr_shm_attach (
+	CefT_Cs_Stat* cs_stat					/* Content Store status						*/
+);
+/*--------------------------------------------------------------------------------------
+	Detaches from the shared memory index
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_shm_detach (
+	CefT_Cs_Stat* cs_stat					/* Content Store status						*/
+);
+/*--------------------------------------------------------------------------------------
+	Searches the Cob in the shared memory index published by csmgrd
+----------------------------------------------------------------------------------------*/
+static int							/* Returns 1 if the Cob is found 					*/
+cef_csmgr_shm_lookup (
+	CefT_Cs_Stat* cs_stat,					/* Content Store status						*/
+	CefT_CcnMsg_MsgBdy* pm,					/* Parsed CEFORE message					*/
+	unsigned char** cob
+);
+#ifdef CefC_CefnetdCache
+/*--------------------------------------------------------------------------------------
+	Holds the Cob written to the put thread of the local cache
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_lcache_pending_add (
+	unsigned char* msg, 					/* Cob written to the put thread			*/
+	uint16_t msg_len,						/* length of the Cob						*/
+	CefT_CcnMsg_MsgBdy* pm,					/* Parsed CEFORE message					*/
+	CefT_CcnMsg_OptHdr* poh					/* Parsed Option Header						*/
+);
+/*--------------------------------------------------------------------------------------
+	Releases the Cobs which the put thread has finished with
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_lcache_pending_purge (
+	int all_f								/* Releases all the Cobs if 1				*/
+);
+/*--------------------------------------------------------------------------------------
+	Searches the Cob which the put thread has not stored yet
+----------------------------------------------------------------------------------------*/
+static int							/* Returns 1 if the Cob is found 					*/
+cef_csmgr_lcache_pending_lookup (
+	CefT_CcnMsg_MsgBdy* pm,					/* Parsed CEFORE message					*/
+	unsigned char** cob
+);
+#endif // CefC_CefnetdCache
 
 
 /****************************************************************************************
@@ -356,6 +511,31 @@ cef_csmgr_stat_create (
 		return (NULL);
 	}
 	cefnetd_msg_buff_index = 0;
+
+	if (cs_stat->cache_type == CefC_Cache_Type_Excache) {
+		if (cefnetd_lookup_buff) {
+			free (cefnetd_lookup_buff);
+		}
+		cefnetd_lookup_buff = malloc (sizeof (unsigned char) * CefC_Csmgr_Link_Batch_Size);
+		if (cefnetd_lookup_buff == NULL) {
+			cef_csmgr_stat_destroy (&cs_stat);
+			cef_log_write (CefC_Log_Error, "%s (alloc lookup buffer)\n", __func__);
+			return (NULL);
+		}
+		cefnetd_lookup_buff_index = 0;
+
+		if (cs_stat->link_ver == CefC_Csmgr_Link_Ver2) {
+			cs_stat->link_req_tbl =
+				(uint32_t*) calloc (CefC_Csmgr_Link_Window, sizeof (uint32_t));
+			if (cs_stat->link_req_tbl == NULL) {
+				cef_csmgr_stat_destroy (&cs_stat);
+				cef_log_write (CefC_Log_Error, "%s (alloc request table)\n", __func__);
+				return (NULL);
+			}
+			cs_stat->link_req_id = 1;
+			cs_stat->link_credit = CefC_Csmgr_Link_Credit;
+		}
+	}
 	cef_csmgr_buffer_init ();
 
 	return (cs_stat);
@@ -439,6 +619,7 @@ cef_csmgr_config_read (
 	cs_stat->def_rct		= CefC_Default_Def_Rct;
 	cs_stat->cache_cap 		= CefC_Default_Cache_Capacity;
 	cs_stat->tcp_port_num 	= CefC_Default_Tcp_Prot;
+	cs_stat->link_ver 		= CefC_Default_Csmgr_Link_Ver;
 	strcpy (cs_stat->peer_id_str, CefC_Default_Node_Path);
 #ifdef CefC_CefnetdCache
 	cs_stat->local_cache_capacity = 65535;
@@ -499,6 +680,15 @@ cef_csmgr_config_read (
 				return (-1);
 			}
 			strcpy (local_sock_id, value);
+		} else if (strcmp (option, CefC_ParamName_CsmgrLinkVer) == 0) {
+			res = cef_csmgr_config_get_value (option, value);
+			if ((res != CefC_Csmgr_Link_Ver1) && (res != CefC_Csmgr_Link_Ver2)) {
+				cef_log_write (CefC_Log_Error,
+					"%s must be 1 or 2.\n", CefC_ParamName_CsmgrLinkVer);
+				fclose (fp);
+				return (-1);
+			}
+			cs_stat->link_ver = (uint8_t) res;
 		}
 		else if (strcmp (option, "LOCAL_CACHE_DEFAULT_RCT") == 0) {
 			res = cef_csmgr_config_get_value (option, value);
@@ -875,10 +1065,18 @@ cef_csmgr_stat_destroy (
 		}
 		if (stat->cache_type == CefC_Cache_Type_Excache) {
 			csmgr_sock_close (stat);
+			cef_csmgr_shm_detach (stat);
+			if (stat->shm_buff) {
+				free (stat->shm_buff);
+			}
+			if (stat->link_req_tbl) {
+				free (stat->link_req_tbl);
+			}
 		}
 #ifdef CefC_CefnetdCache
 		if(stat->cache_type == CefC_Cache_Type_Localcache){
 			cef_mem_cache_destroy ();
+			cef_csmgr_lcache_pending_purge (1);
 			if(stat->pipe_fd[0] != -1){
 				close(stat->pipe_fd[0]);
 			}
@@ -899,6 +1097,11 @@ cef_csmgr_stat_destroy (
 		cefnetd_msg_buff = NULL;
 	}
 	cefnetd_msg_buff_index = 0;
+	if (cefnetd_lookup_buff) {
+		free (cefnetd_lookup_buff);
+		cefnetd_lookup_buff = NULL;
+	}
+	cefnetd_lookup_buff_index = 0;
 
 
 	return;
@@ -979,7 +1182,14 @@ cef_csmgr_cache_lookup (
 				return (1);
 			}
 		}
-
+		/* Probes the index which csmgrd publishes the Cobs to 	*/
+		if (cef_csmgr_shm_lookup (cs_stat, pm, cob) > 0) {
+			if (pm->chunk_num_f) {
+				cef_csmgr_excache_access_increment (
+					cs_stat, pm->name, pm->name_len, pm->chunk_num);
+			}
+			return (1);
+		}
 	}
 #ifdef CefC_CefnetdCache
 	else if (cs_stat->cache_type == CefC_Cache_Type_Localcache){
@@ -1001,6 +1211,10 @@ cef_csmgr_cache_lookup (
 				}
 			}
 		}
+		/* The put thread may not have stored the Cob cefnetd wrote to it yet 	*/
+		if (pm->chunk_num_f) {
+			return (cef_csmgr_lcache_pending_lookup (pm, cob));
+		}
 	}
 #endif //CefC_CefnetdCache
 
@@ -1173,6 +1387,8 @@ cef_dbg_write (CefC_Dbg_Finest, "i=%d, msg_len=%d, write_len=%d, ret=%d\n", i, m
 			if ( 0 < ret ){
 				write_len += ret;
 				if ( msg_len <= write_len ){
+					/* Keeps the Cob visible until the put thread stores it 	*/
+					cef_csmgr_lcache_pending_add (msg, msg_len, pm, poh);
 					/* normal return */
 					return;
 				}
@@ -1453,14 +1669,162 @@ cef_csmgr_excache_lookup (
 	/* Create Interest message 		*/
 	cef_csmgr_interest_msg_create (buff, &index, poh, pm);
 
-	/* Send messages 				*/
-	res = cef_csmgr_send_msg_to_csmgr (cs_stat, buff, index);
+	/* Queues the message, which is sent at the end of this event loop pass 	*/
+	res = cef_csmgr_excache_lookup_queue (cs_stat, buff, index);
 	if (res < 0) {
 		cef_log_write (CefC_Log_Warn, "%s (%s)\n", __func__, strerror (errno));
 	}
 
 	return;
 }
+/*--------------------------------------------------------------------------------------
+	Queues the Interest message for csmgrd until the end of this event loop pass
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+cef_csmgr_excache_lookup_queue (
+	CefT_Cs_Stat* cs_stat,					/* Content Store status						*/
+	unsigned char* msg,						/* Interest message							*/
+	int msg_len								/* message length							*/
+) {
+	uint32_t req_id;
+	uint32_t value32;
+	uint32_t* slot;
+	uint64_t nowt;
+	int rec_len = msg_len;
+
+	if (cs_stat->link_req_tbl) {
+		rec_len += CefC_Csmgr_Link_ReqId_Len;
+	}
+	if ((cefnetd_lookup_buff == NULL) ||
+		(CefC_Csmgr_Msg_HeaderLen + rec_len > CefC_Csmgr_Link_Batch_Size)) {
+		return (cef_csmgr_send_msg_to_csmgr (cs_stat, msg, msg_len));
+	}
+	if (cefnetd_lookup_buff_index + rec_len > CefC_Csmgr_Link_Batch_Size) {
+		cef_csmgr_excache_lookup_flush (cs_stat);
+	}
+
+	if (cs_stat->link_req_tbl == NULL) {
+		/* Version 1 simply concatenates the messages 	*/
+		memcpy (&cefnetd_lookup_buff[cefnetd_lookup_buff_index], msg, msg_len);
+		cefnetd_lookup_buff_index += msg_len;
+		return (msg_len);
+	}
+
+	/* Checks the credit granted by csmgrd 	*/
+	nowt = cef_client_present_timeus_get ();
+	if (cs_stat->link_pending >= cs_stat->link_credit) {
+		if (nowt < cs_stat->link_answer_t + CefC_Csmgr_Link_Stall_Time) {
+			/* The Interest is forwarded upstream without the lookup 	*/
+			cs_stat->link_skips++;
+			return (0);
+		}
+		cef_log_write (CefC_Log_Warn,
+			"No answer from csmgrd, so %u lookups are given up\n", cs_stat->link_pending);
+		memset (cs_stat->link_req_tbl, 0, sizeof (uint32_t) * CefC_Csmgr_Link_Window);
+		cs_stat->link_pending = 0;
+	}
+
+	/* Assigns the request ID 	*/
+	req_id = cs_stat->link_req_id++;
+	if (cs_stat->link_req_id == 0) {
+		cs_stat->link_req_id = 1;
+	}
+	slot = &cs_stat->link_req_tbl[req_id & (CefC_Csmgr_Link_Window - 1)];
+	if (*slot != 0) {
+		/* The answer to the request which used this slot has been lost 	*/
+		cs_stat->link_pending--;
+	}
+	*slot = req_id;
+	if (cs_stat->link_pending == 0) {
+		cs_stat->link_answer_t = nowt;
+	}
+	cs_stat->link_pending++;
+
+	/* Appends the record [Request ID][Interest message] to the batch 	*/
+	if (cefnetd_lookup_buff_index == 0) {
+		cefnetd_lookup_buff[CefC_O_Fix_Ver]  = CefC_Version;
+		cefnetd_lookup_buff[CefC_O_Fix_Type] = CefC_Csmgr_Msg_Type_Batch;
+		cefnetd_lookup_buff_index = CefC_Csmgr_Msg_HeaderLen;
+	}
+	value32 = htonl (req_id);
+	memcpy (&cefnetd_lookup_buff[cefnetd_lookup_buff_index], &value32, sizeof (uint32_t));
+	memcpy (&cefnetd_lookup_buff[cefnetd_lookup_buff_index + CefC_Csmgr_Link_ReqId_Len],
+		msg, msg_len);
+	cefnetd_lookup_buff_index += rec_len;
+
+	return (msg_len);
+}
+/*--------------------------------------------------------------------------------------
+	Sends the lookups queued in this event loop pass to csmgrd
+----------------------------------------------------------------------------------------*/
+void
+cef_csmgr_excache_lookup_flush (
+	CefT_Cs_Stat* cs_stat					/* Content Store status						*/
+) {
+	uint16_t value16;
+
+	if (cefnetd_lookup_buff_index == 0) {
+		return;
+	}
+	if (cs_stat->link_req_tbl) {
+		value16 = htons ((uint16_t) cefnetd_lookup_buff_index);
+		memcpy (&cefnetd_lookup_buff[CefC_O_Fix_PacketLength], &value16, CefC_S_Length);
+	}
+	if (cef_csmgr_send_msg_to_csmgr (
+			cs_stat, cefnetd_lookup_buff, cefnetd_lookup_buff_index) < 0) {
+		cef_log_write (CefC_Log_Warn, "%s (%s)\n", __func__, strerror (errno));
+	}
+	cefnetd_lookup_buff_index = 0;
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Handles the answer to a batch of lookups
+----------------------------------------------------------------------------------------*/
+void
+cef_csmgr_link_answer_process (
+	CefT_Cs_Stat* cs_stat,					/* Content Store status						*/
+	const unsigned char* msg,				/* Answer message							*/
+	int msg_len								/* Length of the message					*/
+) {
+	uint16_t value16;
+	uint32_t value32;
+	uint32_t req_id;
+	uint32_t* slot;
+	int index;
+
+	if (cs_stat->link_req_tbl == NULL) {
+		return;
+	}
+	memcpy (&value16, &msg[CefC_O_Csmgr_Answer_Credit], sizeof (uint16_t));
+	value16 = ntohs (value16);
+	cs_stat->link_credit =
+		(value16 < CefC_Csmgr_Link_Window) ? value16 : CefC_Csmgr_Link_Window;
+
+	/* Answers may complete the requests in any order 	*/
+	for (index = CefC_Csmgr_Answer_HeaderLen ;
+			index + CefC_Csmgr_Link_Answer_Len <= msg_len ;
+			index += CefC_Csmgr_Link_Answer_Len) {
+		memcpy (&value32, &msg[index], sizeof (uint32_t));
+		req_id = ntohl (value32);
+		slot = &cs_stat->link_req_tbl[req_id & (CefC_Csmgr_Link_Window - 1)];
+		if (*slot != req_id) {
+			/* Already given up 	*/
+			continue;
+		}
+		*slot = 0;
+		cs_stat->link_pending--;
+
+		if (msg[index + CefC_Csmgr_Link_ReqId_Len] == CefC_Csmgr_Cob_Exist) {
+			cs_stat->link_hits++;
+		} else {
+			cs_stat->link_misses++;
+		}
+	}
+	cs_stat->link_answer_t = cef_client_present_timeus_get ();
+
+	return;
+}
 /*--------------------------------------------------------------------------------------
 	Get frame from received message
 ----------------------------------------------------------------------------------------*/
@@ -1616,6 +1980,12 @@ csmgr_sock_close (
 		cs_stat->tcp_sock = -1;
 	}
 
+	/* Answers to the lookups sent on the closed connection never come 	*/
+	if (cs_stat->link_req_tbl) {
+		memset (cs_stat->link_req_tbl, 0, sizeof (uint32_t) * CefC_Csmgr_Link_Window);
+		cs_stat->link_pending = 0;
+	}
+
 	return;
 }
 /*--------------------------------------------------------------------------------------
@@ -2547,3 +2917,569 @@ cef_csmgr_cache_version_compare (
 	}
 	return (CefC_CV_Newest_2ndArg);
 }
+
+/*--------------------------------------------------------------------------------------
+	Creates the name of the shared memory index from the local socket name
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_shm_name_create (
+	const char* local_sock_name,			/* Local socket name of csmgrd				*/
+	char* name								/* Name of the region						*/
+) {
+	const char* base;
+
+	base = strrchr (local_sock_name, '/');
+	base = (base) ? base + 1 : local_sock_name;
+	snprintf (name, 256, "/%.240s.cs", base);
+}
+/*--------------------------------------------------------------------------------------
+	Computes the hash value of the name in the shared memory index
+----------------------------------------------------------------------------------------*/
+static uint32_t
+cef_csmgr_shm_hashv_get (
+	uint32_t hashv,							/* Hash value of the preceding bytes		*/
+	const unsigned char* key,
+	uint16_t klen
+) {
+	uint16_t i;
+
+	/* FNV-1a; both processes must compute the same value 	*/
+	for (i = 0 ; i < klen ; i++) {
+		hashv ^= key[i];
+		hashv *= 16777619u;
+	}
+	return (hashv);
+}
+/*--------------------------------------------------------------------------------------
+	Clears the active flag of the region left by csmgrd which was killed
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_shm_stale_deactivate (
+	const char* name						/* Name of the region						*/
+) {
+	CefT_Csmgr_Shm_Hdr* hdr;
+	struct stat st;
+	void* base;
+	int fd;
+
+	fd = shm_open (name, O_RDWR, 0);
+	if (fd < 0) {
+		return;
+	}
+	if ((fstat (fd, &st) < 0) || (st.st_size < (off_t) CefC_Csmgr_Shm_Hdr_Size)) {
+		close (fd);
+		return;
+	}
+	base = mmap (NULL, CefC_Csmgr_Shm_Hdr_Size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (base == MAP_FAILED) {
+		return;
+	}
+	hdr = (CefT_Csmgr_Shm_Hdr*) base;
+	if ((hdr->magic == CefC_Csmgr_Shm_Magic) && (hdr->version == CefC_Csmgr_Shm_Version)) {
+		atomic_store_explicit (&hdr->active, 0, memory_order_release);
+	}
+	munmap (base, CefC_Csmgr_Shm_Hdr_Size);
+}
+/*--------------------------------------------------------------------------------------
+	Creates the shared memory index which csmgrd publishes the Cobs to
+----------------------------------------------------------------------------------------*/
+int									/* The return value is negative if an error occurs	*/
+cef_csmgr_shm_create (
+	const char* local_sock_name,			/* Local socket name of csmgrd				*/
+	uint32_t size_mb						/* Size of the region (MB)					*/
+) {
+	uint64_t arena_size;
+	uint32_t slot_num = 1024;
+	size_t size;
+	void* base;
+	int fd;
+
+	if (csmgr_shm_hdr) {
+		return (0);
+	}
+	if ((size_mb == 0) || (size_mb > CefC_Csmgr_Shm_Size_Max)) {
+		return (-1);
+	}
+	arena_size = (uint64_t) size_mb * 1024 * 1024;
+	while ((uint64_t) slot_num * CefC_Csmgr_Shm_Slot_Bytes < arena_size) {
+		slot_num <<= 1;
+	}
+	size = CefC_Csmgr_Shm_Hdr_Size
+			+ sizeof (CefT_Csmgr_Shm_Slot) * slot_num + arena_size;
+
+	cef_csmgr_shm_name_create (local_sock_name, csmgr_shm_name);
+	/* A region left by csmgrd which was killed is replaced. cefnetd may still	*/
+	/* map it, so it is deactivated first to make cefnetd attach the new one 	*/
+	cef_csmgr_shm_stale_deactivate (csmgr_shm_name);
+	shm_unlink (csmgr_shm_name);
+	fd = shm_open (csmgr_shm_name, O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (fd < 0) {
+		cef_log_write (CefC_Log_Error, "%s (shm_open:%s)\n", __func__, strerror (errno));
+		return (-1);
+	}
+	if (ftruncate (fd, size) < 0) {
+		cef_log_write (CefC_Log_Error, "%s (ftruncate:%s)\n", __func__, strerror (errno));
+		close (fd);
+		shm_unlink (csmgr_shm_name);
+		return (-1);
+	}
+	base = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (base == MAP_FAILED) {
+		cef_log_write (CefC_Log_Error, "%s (mmap:%s)\n", __func__, strerror (errno));
+		shm_unlink (csmgr_shm_name);
+		return (-1);
+	}
+
+	/* The region is zero-filled, so all slots are empty 	*/
+	csmgr_shm_hdr = (CefT_Csmgr_Shm_Hdr*) base;
+	csmgr_shm_size = size;
+	csmgr_shm_hdr->magic 		= CefC_Csmgr_Shm_Magic;
+	csmgr_shm_hdr->version 		= CefC_Csmgr_Shm_Version;
+	csmgr_shm_hdr->slot_num 	= slot_num;
+	csmgr_shm_hdr->seed 		= (uint32_t) random ();
+	csmgr_shm_hdr->arena_size 	= arena_size;
+	atomic_store_explicit (&csmgr_shm_hdr->arena_head, 0, memory_order_relaxed);
+	atomic_store_explicit (&csmgr_shm_hdr->active, 1, memory_order_release);
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Destroys the shared memory index
+----------------------------------------------------------------------------------------*/
+void
+cef_csmgr_shm_destroy (
+	void
+) {
+	pthread_mutex_lock (&csmgr_shm_mutex);
+	if (csmgr_shm_hdr) {
+		/* cefnetd detaches when it sees the flag cleared 	*/
+		atomic_store_explicit (&csmgr_shm_hdr->active, 0, memory_order_release);
+		munmap (csmgr_shm_hdr, csmgr_shm_size);
+		shm_unlink (csmgr_shm_name);
+		csmgr_shm_hdr = NULL;
+		csmgr_shm_size = 0;
+	}
+	pthread_mutex_unlock (&csmgr_shm_mutex);
+}
+/*--------------------------------------------------------------------------------------
+	Publishes the Cob to the shared memory index
+----------------------------------------------------------------------------------------*/
+void
+cef_csmgr_shm_publish (
+	const unsigned char* key,				/* Content name with the chunk number		*/
+	uint16_t klen,							/* Length of the key						*/
+	const unsigned char* version,			/* Version of the Cob						*/
+	uint16_t ver_len,						/* Length of the version					*/
+	const unsigned char* msg,				/* Cob message								*/
+	uint16_t msg_len,						/* Length of the Cob message				*/
+	uint64_t cache_time,					/* Cache time (usec)						*/
+	uint64_t expiry							/* Expiry (usec), or 0						*/
+) {
+	CefT_Csmgr_Shm_Hdr* hdr;
+	CefT_Csmgr_Shm_Slot* slots;
+	CefT_Csmgr_Shm_Slot* slot;
+	CefT_Csmgr_Shm_Slot* victim = NULL;
+	unsigned char* arena;
+	uint64_t head, off, rec_len;
+	uint32_t hashv, mask, seq;
+	int i;
+
+	if ((csmgr_shm_hdr == NULL) || (klen == 0)) {
+		return;
+	}
+	pthread_mutex_lock (&csmgr_shm_mutex);
+	hdr = csmgr_shm_hdr;
+	if (hdr == NULL) {
+		pthread_mutex_unlock (&csmgr_shm_mutex);
+		return;
+	}
+	slots = CefC_Csmgr_Shm_Slots (hdr);
+	arena = CefC_Csmgr_Shm_Arena (hdr);
+	mask  = hdr->slot_num - 1;
+	rec_len = ((uint64_t) klen + ver_len + msg_len + 7) & ~((uint64_t) 7);
+	if (rec_len > hdr->arena_size / 4) {
+		pthread_mutex_unlock (&csmgr_shm_mutex);
+		return;
+	}
+	hashv = cef_csmgr_shm_hashv_get (CefC_Csmgr_Shm_Hash_Init (hdr), key, klen);
+	head  = atomic_load_explicit (&hdr->arena_head, memory_order_relaxed);
+
+	/* Reuses the slot of the same name, otherwise an empty or the oldest one 	*/
+	for (i = 0 ; i < CefC_Csmgr_Shm_Probe ; i++) {
+		slot = &slots[(hashv + i) & mask];
+		if ((slot->key_len == klen) && (slot->hashv == hashv) &&
+			(slot->pos + hdr->arena_size >= head) &&
+			(memcmp (&arena[slot->pos % hdr->arena_size], key, klen) == 0)) {
+			victim = slot;
+			break;
+		}
+		if ((slot->key_len == 0) || (slot->pos + hdr->arena_size < head)) {
+			if ((victim == NULL) || (victim->key_len != 0)) {
+				victim = slot;
+			}
+		} else if ((victim == NULL) ||
+				   ((victim->key_len != 0) && (slot->pos < victim->pos))) {
+			victim = slot;
+		}
+	}
+
+	/* Reserves the record; it does not wrap around the end of the arena 	*/
+	off = head % hdr->arena_size;
+	if (off + rec_len > hdr->arena_size) {
+		head += hdr->arena_size - off;
+		off = 0;
+	}
+	/* Moves the head before the records which it overwrites are changed 	*/
+	atomic_store_explicit (&hdr->arena_head, head + rec_len, memory_order_relaxed);
+	atomic_thread_fence (memory_order_release);
+	memcpy (&arena[off], key, klen);
+	if (ver_len) {
+		memcpy (&arena[off + klen], version, ver_len);
+	}
+	memcpy (&arena[off + klen + ver_len], msg, msg_len);
+
+	seq = atomic_load_explicit (&victim->seq, memory_order_relaxed);
+	atomic_store_explicit (&victim->seq, seq + 1, memory_order_relaxed);
+	atomic_thread_fence (memory_order_release);
+	victim->hashv 		= hashv;
+	victim->key_len 	= klen;
+	victim->ver_len 	= ver_len;
+	victim->msg_len 	= msg_len;
+	victim->pos 		= head;
+	victim->cache_time 	= cache_time;
+	victim->expiry 		= expiry;
+	atomic_store_explicit (&victim->seq, seq + 2, memory_order_release);
+
+	pthread_mutex_unlock (&csmgr_shm_mutex);
+}
+/*--------------------------------------------------------------------------------------
+	Removes the Cob from the shared memory index
+----------------------------------------------------------------------------------------*/
+void
+cef_csmgr_shm_invalidate (
+	const unsigned char* key,				/* Content name with the chunk number		*/
+	uint16_t klen							/* Length of the key						*/
+) {
+	CefT_Csmgr_Shm_Hdr* hdr;
+	CefT_Csmgr_Shm_Slot* slot;
+	unsigned char* arena;
+	uint32_t hashv, mask, seq;
+	int i;
+
+	if (csmgr_shm_hdr == NULL) {
+		return;
+	}
+	pthread_mutex_lock (&csmgr_shm_mutex);
+	hdr = csmgr_shm_hdr;
+	if (hdr == NULL) {
+		pthread_mutex_unlock (&csmgr_shm_mutex);
+		return;
+	}
+	arena = CefC_Csmgr_Shm_Arena (hdr);
+	mask  = hdr->slot_num - 1;
+	hashv = cef_csmgr_shm_hashv_get (CefC_Csmgr_Shm_Hash_Init (hdr), key, klen);
+
+	for (i = 0 ; i < CefC_Csmgr_Shm_Probe ; i++) {
+		slot = &CefC_Csmgr_Shm_Slots (hdr)[(hashv + i) & mask];
+		if ((slot->key_len != klen) || (slot->hashv != hashv) ||
+			(memcmp (&arena[slot->pos % hdr->arena_size], key, klen) != 0)) {
+			continue;
+		}
+		seq = atomic_load_explicit (&slot->seq, memory_order_relaxed);
+		atomic_store_explicit (&slot->seq, seq + 1, memory_order_relaxed);
+		atomic_thread_fence (memory_order_release);
+		slot->key_len = 0;
+		atomic_store_explicit (&slot->seq, seq + 2, memory_order_release);
+	}
+	pthread_mutex_unlock (&csmgr_shm_mutex);
+}
+/*--------------------------------------------------------------------------------------
+	Attaches to the shared memory index published by csmgrd
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+cef_csmgr_shm_attach (
+	CefT_Cs_Stat* cs_stat					/* Content Store status						*/
+) {
+	CefT_Csmgr_Shm_Hdr* hdr;
+	char name[256];
+	struct stat st;
+	void* base;
+	int fd;
+
+	cef_csmgr_shm_name_create (cs_stat->local_sock_name, name);
+	fd = shm_open (name, O_RDONLY, 0);
+	if (fd < 0) {
+		return (-1);
+	}
+	if ((fstat (fd, &st) < 0) || (st.st_size < (off_t) CefC_Csmgr_Shm_Hdr_Size)) {
+		close (fd);
+		return (-1);
+	}
+	base = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+	if (base == MAP_FAILED) {
+		return (-1);
+	}
+	hdr = (CefT_Csmgr_Shm_Hdr*) base;
+	if ((hdr->magic != CefC_Csmgr_Shm_Magic) ||
+		(hdr->version != CefC_Csmgr_Shm_Version) ||
+		(atomic_load_explicit (&hdr->active, memory_order_acquire) == 0) ||
+		(CefC_Csmgr_Shm_Hdr_Size + sizeof (CefT_Csmgr_Shm_Slot) * (uint64_t) hdr->slot_num
+			+ hdr->arena_size != (uint64_t) st.st_size)) {
+		munmap (base, st.st_size);
+		return (-1);
+	}
+	if (cs_stat->shm_buff == NULL) {
+		cs_stat->shm_buff = (unsigned char*) malloc (CefC_Max_Length * 2);
+		if (cs_stat->shm_buff == NULL) {
+			munmap (base, st.st_size);
+			return (-1);
+		}
+	}
+	cs_stat->shm_base = base;
+	cs_stat->shm_size = st.st_size;
+	cef_log_write (CefC_Log_Info, "Attached the shared memory index of csmgrd (%s)\n", name);
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Detaches from the shared memory index
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_shm_detach (
+	CefT_Cs_Stat* cs_stat					/* Content Store status						*/
+) {
+	if (cs_stat->shm_base) {
+		munmap (cs_stat->shm_base, cs_stat->shm_size);
+		cs_stat->shm_base = NULL;
+		cs_stat->shm_size = 0;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Searches the Cob in the shared memory index published by csmgrd
+----------------------------------------------------------------------------------------*/
+static int							/* Returns 1 if the Cob is found 					*/
+cef_csmgr_shm_lookup (
+	CefT_Cs_Stat* cs_stat,					/* Content Store status						*/
+	CefT_CcnMsg_MsgBdy* pm,					/* Parsed CEFORE message					*/
+	unsigned char** cob
+) {
+	CefT_Csmgr_Shm_Hdr* hdr;
+	CefT_Csmgr_Shm_Slot* slot;
+	unsigned char* arena;
+	uint64_t nowt, pos, off, head, cache_time, expiry;
+	uint32_t hashv, mask, seq;
+	uint32_t value32;
+	uint16_t name_len, klen, ver_len, msg_len;
+	unsigned char chunk_key[8];
+	int i, match, rc;
+
+	hdr = (CefT_Csmgr_Shm_Hdr*) cs_stat->shm_base;
+	if (hdr == NULL) {
+		/* csmgrd may not publish the index, so it is not tried every time 	*/
+		nowt = cef_client_present_timeus_get ();
+		if (nowt < cs_stat->shm_retry_t) {
+			return (-1);
+		}
+		cs_stat->shm_retry_t = nowt + CefC_Csmgr_Shm_Retry_Time;
+		if (cef_csmgr_shm_attach (cs_stat) < 0) {
+			return (-1);
+		}
+		hdr = (CefT_Csmgr_Shm_Hdr*) cs_stat->shm_base;
+	}
+	if (atomic_load_explicit (&hdr->active, memory_order_acquire) == 0) {
+		/* csmgrd has stopped; the restarted one creates a new region 	*/
+		cef_csmgr_shm_detach (cs_stat);
+		return (-1);
+	}
+	/* csmgrd keys the Cobs by the name and the chunk number in its own 	*/
+	/* format (see csmgrd_name_chunknum_concatenate) 						*/
+	if (!pm->chunk_num_f) {
+		return (-1);
+	}
+	name_len = pm->name_len - (CefC_S_Type + CefC_S_Length + CefC_S_ChunkNum);
+	klen = name_len + sizeof (chunk_key);
+	chunk_key[0] = 0x00;
+	chunk_key[1] = 0x10;
+	chunk_key[2] = 0x00;
+	chunk_key[3] = 0x04;
+	value32 = htonl (pm->chunk_num);
+	memcpy (&chunk_key[4], &value32, sizeof (uint32_t));
+
+	arena = CefC_Csmgr_Shm_Arena (hdr);
+	mask  = hdr->slot_num - 1;
+	hashv = cef_csmgr_shm_hashv_get (CefC_Csmgr_Shm_Hash_Init (hdr), pm->name, name_len);
+	hashv = cef_csmgr_shm_hashv_get (hashv, chunk_key, sizeof (chunk_key));
+
+	for (i = 0 ; i < CefC_Csmgr_Shm_Probe ; i++) {
+		slot = &CefC_Csmgr_Shm_Slots (hdr)[(hashv + i) & mask];
+		seq = atomic_load_explicit (&slot->seq, memory_order_acquire);
+		if ((seq & 1) || (slot->key_len != klen) || (slot->hashv != hashv)) {
+			continue;
+		}
+		ver_len 	= slot->ver_len;
+		msg_len 	= slot->msg_len;
+		pos 		= slot->pos;
+		cache_time 	= slot->cache_time;
+		expiry 		= slot->expiry;
+		off 		= pos % hdr->arena_size;
+		if ((off + klen + ver_len + msg_len > hdr->arena_size) ||
+			(ver_len + msg_len > CefC_Max_Length * 2)) {
+			continue;
+		}
+		head = atomic_load_explicit (&hdr->arena_head, memory_order_acquire);
+		if (head > pos + hdr->arena_size) {
+			continue;
+		}
+
+		/* Copies the record, then checks that csmgrd did not change it 	*/
+		match = ((memcmp (&arena[off], pm->name, name_len) == 0) &&
+				 (memcmp (&arena[off + name_len], chunk_key, sizeof (chunk_key)) == 0));
+		if (match) {
+			memcpy (cs_stat->shm_buff, &arena[off + klen], ver_len + msg_len);
+		}
+		atomic_thread_fence (memory_order_acquire);
+		if ((atomic_load_explicit (&slot->seq, memory_order_relaxed) != seq) ||
+			(atomic_load_explicit (&hdr->arena_head, memory_order_relaxed)
+				> pos + hdr->arena_size)) {
+			continue;
+		}
+		if (!match) {
+			continue;
+		}
+
+		nowt = cef_client_present_timeus_get ();
+		if ((nowt >= cache_time) || ((expiry != 0) && (nowt >= expiry))) {
+			return (-1);
+		}
+		rc = cef_csmgr_cache_version_compare (cs_stat->shm_buff, ver_len,
+												pm->org.version_val, pm->org.version_len);
+		if (rc == CefC_CV_Inconsistent) {
+			if (!(pm->org.version_len == 0 && ver_len != 0)) {
+				return (-1);
+			}
+		} else if (rc != CefC_CV_Same) {
+			return (-1);
+		}
+		*cob = cs_stat->shm_buff + ver_len;
+		cs_stat->shm_hits++;
+		return (1);
+	}
+	return (-1);
+}
+#ifdef CefC_CefnetdCache
+/*--------------------------------------------------------------------------------------
+	Holds the Cob written to the put thread of the local cache
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_lcache_pending_add (
+	unsigned char* msg, 					/* Cob written to the put thread			*/
+	uint16_t msg_len,						/* length of the Cob						*/
+	CefT_CcnMsg_MsgBdy* pm,					/* Parsed CEFORE message					*/
+	CefT_CcnMsg_OptHdr* poh					/* Parsed Option Header						*/
+) {
+	CefT_Lcache_Pending* ent;
+	uint16_t ver_len = 0;
+
+	cef_csmgr_lcache_pending_purge (0);
+
+	/* Every write takes a position, since the put thread counts all of them 	*/
+	if (lcache_pending_tail - lcache_pending_head == CefC_Lcache_Pending_Max) {
+		/* The oldest Cob is only hidden until the put thread stores it 		*/
+		ent = &lcache_pending[lcache_pending_head & (CefC_Lcache_Pending_Max - 1)];
+		free (ent->buff);
+		ent->buff = NULL;
+		lcache_pending_head++;
+	}
+	ent = &lcache_pending[lcache_pending_tail & (CefC_Lcache_Pending_Max - 1)];
+	lcache_pending_tail++;
+	ent->buff = NULL;
+
+	/* The put thread discards the Cob which has no chunk number 	*/
+	if (!pm->chunk_num_f) {
+		return;
+	}
+	if (pm->org.version_f) {
+		ver_len = pm->org.version_len;
+	}
+	ent->buff = (unsigned char*) malloc (pm->name_len + ver_len + msg_len);
+	if (ent->buff == NULL) {
+		return;
+	}
+	memcpy (ent->buff, pm->name, pm->name_len);
+	if (ver_len) {
+		memcpy (ent->buff + pm->name_len, pm->org.version_val, ver_len);
+	}
+	memcpy (ent->buff + pm->name_len + ver_len, msg, msg_len);
+	ent->hashv 		= cef_csmgr_shm_hashv_get (2166136261u, pm->name, pm->name_len);
+	ent->name_len 	= pm->name_len;
+	ent->ver_len 	= ver_len;
+	ent->msg_len 	= msg_len;
+	ent->cache_time = poh->cachetime;
+	ent->expiry 	= pm->expiry;
+}
+/*--------------------------------------------------------------------------------------
+	Releases the Cobs which the put thread has finished with
+----------------------------------------------------------------------------------------*/
+static void
+cef_csmgr_lcache_pending_purge (
+	int all_f								/* Releases all the Cobs if 1				*/
+) {
+	CefT_Lcache_Pending* ent;
+	uint64_t done;
+
+	done = (all_f) ? lcache_pending_tail : cef_mem_cache_put_count_get ();
+
+	while ((lcache_pending_head < lcache_pending_tail) && (lcache_pending_head < done)) {
+		ent = &lcache_pending[lcache_pending_head & (CefC_Lcache_Pending_Max - 1)];
+		free (ent->buff);
+		ent->buff = NULL;
+		lcache_pending_head++;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Searches the Cob which the put thread has not stored yet
+----------------------------------------------------------------------------------------*/
+static int							/* Returns 1 if the Cob is found 					*/
+cef_csmgr_lcache_pending_lookup (
+	CefT_CcnMsg_MsgBdy* pm,					/* Parsed CEFORE message					*/
+	unsigned char** cob
+) {
+	CefT_Lcache_Pending* ent;
+	uint32_t hashv;
+	uint64_t nowt;
+	uint64_t n;
+
+	cef_csmgr_lcache_pending_purge (0);
+	if (lcache_pending_head == lcache_pending_tail) {
+		return (-1);
+	}
+	hashv = cef_csmgr_shm_hashv_get (2166136261u, pm->name, pm->name_len);
+	nowt = cef_client_present_timeus_get ();
+
+	/* Newest first, so that a refreshed Cob wins over the older one 	*/
+	for (n = lcache_pending_tail ; n > lcache_pending_head ; n--) {
+		ent = &lcache_pending[(n - 1) & (CefC_Lcache_Pending_Max - 1)];
+		if ((ent->buff == NULL) || (ent->hashv != hashv) ||
+			(ent->name_len != pm->name_len) ||
+			(memcmp (ent->buff, pm->name, pm->name_len) != 0)) {
+			continue;
+		}
+		/* Same checks as the ones applied to the Cob in the local cache 	*/
+		if ((nowt >= ent->cache_time) || (nowt >= ent->expiry)) {
+			return (-1);
+		}
+		if ((pm->org.version_f) &&
+			((ent->ver_len != pm->org.version_len) ||
+			 (memcmp (ent->buff + ent->name_len,
+			 			pm->org.version_val, ent->ver_len) != 0))) {
+			return (-1);
+		}
+		*cob = ent->buff + ent->name_len + ent->ver_len;
+		return (1);
+	}
+	return (-1);
+}
+#endif // CefC_CefnetdCache
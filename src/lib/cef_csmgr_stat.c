@@ -942,6 +942,78 @@ csmgr_stat_content_info_version_init (
 	pthread_mutex_unlock (&tbl->stat_mutex);
 	return (1);
 }
+/*--------------------------------------------------------------------------------------
+	Calls the callback for each content information
+----------------------------------------------------------------------------------------*/
+void
+csmgr_stat_content_info_walk (
+	CsmgrT_Stat_Handle hdl,
+	void (*callback)(CsmgrT_Stat*, void*),	/* called with each content information 	*/
+	void* arg								/* argument of the callback 				*/
+) {
+	CsmgrT_Stat_Table* tbl = (CsmgrT_Stat_Table*) hdl;
+	CsmgrT_Stat* cp;
+	int i;
+
+	if (!tbl) {
+		return;
+	}
+
+	pthread_mutex_lock (&tbl->stat_mutex);
+	for (i = 0 ; i < CsmgrT_Stat_Max ; i++) {
+		for (cp = tbl->rcds[i] ; cp != NULL ; cp = cp->next) {
+			(*callback)(cp, arg);
+		}
+	}
+	pthread_mutex_unlock (&tbl->stat_mutex);
+}
+/*--------------------------------------------------------------------------------------
+	Restores the bitmap of the cached Cobs of the specified content
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+csmgr_stat_cob_map_restore (
+	CsmgrT_Stat_Handle hdl,
+	CsmgrT_Stat* rcd,
+	const uint64_t* cob_map,				/* bitmap of the cached Cobs 				*/
+	uint32_t map_max,						/* number of the elements of cob_map 		*/
+	uint64_t cob_num,						/* number of the cached Cobs 				*/
+	uint64_t con_size						/* total size of the cached Cobs 			*/
+) {
+	CsmgrT_Stat_Table* tbl = (CsmgrT_Stat_Table*) hdl;
+	uint64_t* ptr;
+	uint32_t map_bsize;
+
+	if (!tbl || !rcd) {
+		return (-1);
+	}
+
+	pthread_mutex_lock (&tbl->stat_mutex);
+	if (rcd->map_max < map_max) {
+		map_bsize = map_max / CsmgrT_Add_Maps;
+		if (map_max % CsmgrT_Add_Maps != 0) {
+			map_bsize++;
+		}
+		map_bsize *= CsmgrT_Add_Maps;
+		ptr = (uint64_t*) calloc (1, sizeof (uint64_t) * map_bsize);
+		if (ptr == NULL) {
+			pthread_mutex_unlock (&tbl->stat_mutex);
+			return (-1);
+		}
+		free (rcd->cob_map);
+		rcd->cob_map = ptr;
+		rcd->map_max = map_bsize;
+	}
+	memset (rcd->cob_map, 0, sizeof (uint64_t) * rcd->map_max);
+	memcpy (rcd->cob_map, cob_map, sizeof (uint64_t) * map_max);
+
+	tbl->cached_cob_num -= rcd->cob_num;
+	tbl->cached_cob_num += cob_num;
+	rcd->cob_num 	= cob_num;
+	rcd->con_size 	= con_size;
+	pthread_mutex_unlock (&tbl->stat_mutex);
+
+	return (1);
+}
 /*--------------------------------------------------------------------------------------
 	Deletes the content information
 ----------------------------------------------------------------------------------------*/
@@ -32,6 +32,8 @@
 
 #define __CEF_FACE_SOURECE__
 
+#define _GNU_SOURCE
+
 //#define		CEF_FACE_SEND_USLEEP	100000
 #define		CEF_FACE_SEND_TIMEOUT	1		/* 1ms */
 
@@ -52,12 +54,14 @@
 
 #include <sys/ioctl.h>
 #include <arpa/inet.h>
+#include <pthread.h>
 
 #include <cefore/cef_hash.h>
 #include <cefore/cef_face.h>
 #include <cefore/cef_frame.h>
 #include <cefore/cef_log.h>
 #include <cefore/cef_client.h>
+#include <cefore/cef_shmring.h>
 
 
 /****************************************************************************************
@@ -73,10 +77,18 @@
 
 #define	CEF_FACE_SEND_RETRY_LIMITS	10
 
+#define CefC_Face_Shmring_Detached	-2		/* The rings have been detached 			*/
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/***** Shared memory rings attached to a local Face 	*****/
+typedef struct {
+	pthread_mutex_t 	mutex;				/* held while the rings are used 			*/
+	CefT_Shmring* 		shm;
+} CefT_Face_Shmring;
+
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
@@ -97,6 +109,9 @@ static int babel_sock_path_len = 0;
 static int my_udp_listen_port_num = 0;
 static int my_tcp_listen_port_num = 0;
 
+static uint32_t face_tbl_gen = 0;				/* Incremented when FD of Face changes	*/
+static CefT_Face_Shmring* face_shm = NULL;		/* Rings of the local Faces				*/
+
 /****************************************************************************************
  Static Function Declaration
  ****************************************************************************************/
@@ -247,6 +262,10 @@ cef_face_init (
 	for (i = 0; i < face_tbl_max; i++) {
 		cef_face_init_entry(&face_tbl[i]);
 	}
+	face_shm = (CefT_Face_Shmring*) calloc (face_tbl_max, sizeof (CefT_Face_Shmring));
+	for (i = 0; i < face_tbl_max; i++) {
+		pthread_mutex_init (&face_shm[i].mutex, NULL);
+	}
 	sock_tbl = cef_hash_tbl_create ((uint16_t) face_tbl_max);
 
 	local_sock_path_len = cef_client_local_sock_name_get (local_sock_path);
@@ -467,6 +486,7 @@ cef_face_lookup_local_faceid (
 	face_tbl[faceid].index = index;
 	face_tbl[faceid].fd = entry->skfd;
 	face_tbl[faceid].local_f = 1;
+	face_tbl_gen++;
 
 #ifdef CefC_Debug
 	cef_dbg_write (CefC_Dbg_Finer,
@@ -502,8 +522,10 @@ cef_face_close (
 			entry->skfd = face_tbl[entry->faceid].fd = CefC_Fd_Invalid;
 		}
 //		close (entry->skfd);
+		cef_face_shmring_set (faceid, NULL);
 		cef_face_init_entry(&face_tbl[faceid]);
 		cef_face_sock_entry_destroy (entry);
+		face_tbl_gen++;
 	}
 
 	return (1);
@@ -528,6 +550,7 @@ cef_face_close_for_down (
 		if ( !entry->listener ){
 			close (entry->skfd);
 			entry->skfd = face_tbl[entry->faceid].fd = CefC_Fd_Invalid;
+			face_tbl_gen++;
 		}
 //		close (entry->skfd);
 	}
@@ -554,6 +577,7 @@ cef_face_down (
 #endif // CefC_Debug
 		cef_face_reset_entry(&face_tbl[faceid]);
 		cef_face_update_entry(faceid);
+		face_tbl_gen++;
 	}
 
 	return (1);
@@ -960,6 +984,7 @@ cef_face_accept_connect (
 		face_tbl[entry->faceid].fd = entry->skfd;
 		face_tbl[entry->faceid].protocol = CefC_Face_Type_Tcp;
 		cef_face_update_entry(entry->faceid);
+		face_tbl_gen++;
 		return (entry->faceid);
 	}
 	else {
@@ -982,6 +1007,7 @@ cef_face_accept_connect (
 				face_tbl[entry->faceid].fd = entry->skfd;
 				face_tbl[entry->faceid].protocol = CefC_Face_Type_Tcp;
 				cef_face_update_entry(entry->faceid);
+				face_tbl_gen++;
 				return (entry->faceid);
 			}
 		}
@@ -1006,6 +1032,7 @@ cef_face_accept_connect (
 	face_tbl[faceid].fd = entry->skfd;
 	face_tbl[faceid].protocol = CefC_Face_Type_Tcp;
 	cef_face_update_entry(faceid);
+	face_tbl_gen++;
 
 #if 0
 	{
@@ -1192,6 +1219,16 @@ cef_face_get_fd_from_faceid (
 ) {
 	return (face_tbl[faceid].fd);
 }
+/*--------------------------------------------------------------------------------------
+	Obtains the generation of the Face Table
+	  NOTE: The value changes whenever FD of any Face is opened or closed
+----------------------------------------------------------------------------------------*/
+uint32_t									/* generation of the Face Table 			*/
+cef_face_tbl_generation_get (
+	void
+) {
+	return (face_tbl_gen);
+}
 /*--------------------------------------------------------------------------------------
 	Obtains the Face structure from the specified Face-ID
 ----------------------------------------------------------------------------------------*/
@@ -1214,6 +1251,46 @@ cef_face_get_seqnum_from_faceid (
 	return (face_tbl[faceid].seqnum);
 }
 
+/*--------------------------------------------------------------------------------------
+	Attaches the shared memory rings to the local Face, or detaches them with NULL
+----------------------------------------------------------------------------------------*/
+void
+cef_face_shmring_set (
+	uint16_t 		faceid,					/* Face-ID of the application 				*/
+	CefT_Shmring* 	shm						/* rings, or NULL to detach 				*/
+) {
+	if (face_shm == NULL) {
+		return;
+	}
+	/* The transmit workers may be putting a frame into the rings 	*/
+	pthread_mutex_lock (&face_shm[faceid].mutex);
+	__atomic_store_n (&face_shm[faceid].shm, shm, __ATOMIC_RELAXED);
+	pthread_mutex_unlock (&face_shm[faceid].mutex);
+}
+/*--------------------------------------------------------------------------------------
+	Puts a message into the shared memory rings of the local Face
+----------------------------------------------------------------------------------------*/
+static int
+cef_face_shmring_send (
+	int				faceid,					/* Face-ID indicating the destination 		*/
+	unsigned char* 	msg, 					/* a message to send						*/
+	int				msg_len					/* length of the message to send 			*/
+) {
+	int	res = CefC_Face_Shmring_Detached;
+
+	pthread_mutex_lock (&face_shm[faceid].mutex);
+	if (face_shm[faceid].shm) {
+		res = cef_shmring_send (face_shm[faceid].shm, msg, msg_len);
+		if (res == 0) {
+			/* The application has not read the rings 	*/
+			errno = EAGAIN;
+			res = -1;
+		}
+	}
+	pthread_mutex_unlock (&face_shm[faceid].mutex);
+
+	return res;
+}
 /*--------------------------------------------------------------------------------------
 	Sends a message via the specified Face
 ----------------------------------------------------------------------------------------*/
@@ -1239,6 +1316,14 @@ cef_face_send_sockentry (
 		/*********************/
 		/*	1. local socket  */
 		/*********************/
+		if (face_shm &&
+			__atomic_load_n (&face_shm[entry->faceid].shm, __ATOMIC_RELAXED)) {
+			/* The application reads the frames from the shared memory 	*/
+			res = cef_face_shmring_send (entry->faceid, msg, msg_len);
+			if (res != CefC_Face_Shmring_Detached) {
+				return (res);
+			}
+		}
 		res = send (entry->skfd, msg, msg_len, 0);
 	} else if (faceinf->protocol == CefC_Face_Type_Tcp) {
 		/************/
@@ -1381,6 +1466,80 @@ cef_face_frame_send (
 	return cef_face_frame_send_core(entry, &face_tbl[faceid], faceid, msg, msg_len);
 }
 
+/*--------------------------------------------------------------------------------------
+	Sends the messages via the specified Face with as few system calls as possible
+----------------------------------------------------------------------------------------*/
+int											/* number of messages completely sent		*/
+cef_face_frame_send_batch (
+	uint16_t 		faceid, 				/* Face-ID indicating the destination 		*/
+	unsigned char* 	msgs[], 				/* messages to send							*/
+	size_t			msg_lens[],				/* length of each message 					*/
+	int				msg_num					/* number of messages 						*/
+) {
+	CefT_Sock* entry;
+	CefT_Face* faceinf;
+	int sent = 0;
+	int i;
+
+	entry = (CefT_Sock*) cef_hash_tbl_item_get_from_index (
+										sock_tbl, face_tbl[faceid].index);
+	if (entry == NULL) {
+		return -1;
+	}
+	faceinf = &face_tbl[faceid];
+
+#ifdef CefC_Face_SendMmsg
+	if (!faceinf->local_f && faceinf->protocol == CefC_Face_Type_Udp) {
+		struct mmsghdr mmsg[CefC_Face_Batch_Max];
+		struct iovec iov[CefC_Face_Batch_Max];
+		int pos = 0;
+		int num, res;
+
+		while (pos < msg_num) {
+			num = msg_num - pos;
+			if (num > CefC_Face_Batch_Max) {
+				num = CefC_Face_Batch_Max;
+			}
+			memset (mmsg, 0, sizeof (struct mmsghdr) * num);
+			for (i = 0 ; i < num ; i++) {
+				iov[i].iov_base = msgs[pos + i];
+				iov[i].iov_len  = msg_lens[pos + i];
+				mmsg[i].msg_hdr.msg_name    = entry->ai_addr;
+				mmsg[i].msg_hdr.msg_namelen = entry->ai_addrlen;
+				mmsg[i].msg_hdr.msg_iov     = &iov[i];
+				mmsg[i].msg_hdr.msg_iovlen  = 1;
+			}
+			res = sendmmsg (entry->skfd, mmsg, num, 0);
+			if (res > 0) {
+				for (i = 0 ; i < res ; i++) {
+					if (mmsg[i].msg_len == msg_lens[pos + i]) {
+						sent++;
+					}
+				}
+				pos += res;
+				continue;
+			}
+			/* The head message is handed to the single send path which 	*/
+			/* waits for the socket to be writable and retries. 			*/
+			if (cef_face_frame_send_core (entry, faceinf,
+					faceid, msgs[pos], msg_lens[pos]) == (int) msg_lens[pos]) {
+				sent++;
+			}
+			pos++;
+		}
+		return (sent);
+	}
+#endif // CefC_Face_SendMmsg
+
+	for (i = 0 ; i < msg_num ; i++) {
+		if (cef_face_frame_send_core (entry, faceinf,
+				faceid, msgs[i], msg_lens[i]) == (int) msg_lens[i]) {
+			sent++;
+		}
+	}
+	return (sent);
+}
+
 void
 cef_face_frame_send_forced (
 	uint16_t 		faceid, 				/* Face-ID indicating the destination 		*/
@@ -1955,6 +2114,7 @@ cef_face_lookup_faceid (
 		face_tbl[faceid].index = index;
 		face_tbl[faceid].fd = entry->skfd;
 		face_tbl[faceid].protocol = (uint8_t) protocol;
+		face_tbl_gen++;
 
 		if (create_f) {
 			*create_f = 1;
@@ -62,6 +62,7 @@
 
 #define CefC_Fib_DefaultRoute_Len	4
 #define CefC_Fib_Addr_Max		32
+#define CefC_Fib_Prefix_Max		128				/* prefixes probed without re-parsing 	*/
 
 /****************************************************************************************
  Structures Declaration
@@ -79,6 +80,31 @@ static char 	fib_dbg_msg[2048];
 /****************************************************************************************
  Static Function Declaration
  ****************************************************************************************/
+/*--------------------------------------------------------------------------------------
+	Obtains the lengths of the prefixes to be probed in ascending order
+----------------------------------------------------------------------------------------*/
+static int									/* number of prefixes, or -1 if too many	*/
+cef_fib_prefix_lens_get (
+	const unsigned char* name, 				/* Key of the FIB entry						*/
+	uint16_t name_len,						/* Length of Key							*/
+	uint16_t plens[]						/* lengths of the prefixes 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Searches FIB entry shortening the Key one component at a time
+----------------------------------------------------------------------------------------*/
+static CefT_Fib_Entry* 						/* FIB entry 								*/
+cef_fib_entry_search_by_shortening (
+	CefT_Hash_Handle fib,					/* FIB										*/
+	unsigned char* name, 					/* Key of the FIB entry						*/
+	uint16_t name_len						/* Length of Key							*/
+);
+/*--------------------------------------------------------------------------------------
+	Outputs the FIB entry matched by the search
+----------------------------------------------------------------------------------------*/
+static inline void
+cef_fib_entry_match_dbg (
+	CefT_Fib_Entry* entry					/* FIB entry 								*/
+);
 
 /****************************************************************************************
  ****************************************************************************************/
@@ -91,6 +117,77 @@ cef_fib_entry_search (
 	CefT_Hash_Handle fib,					/* FIB										*/
 	unsigned char* name, 					/* Key of the FIB entry						*/
 	uint16_t name_len						/* Length of Key							*/
+) {
+	CefT_Fib_Entry* entry;
+	uint16_t plens[CefC_Fib_Prefix_Max];
+	uint64_t hashvs[CefC_Fib_Prefix_Max];
+	int pnum;
+	int i;
+
+	/* Finds the boundaries of the components once, then probes the prefixes 	*/
+	/* from the longest one with the hash values computed in one pass 			*/
+	pnum = cef_fib_prefix_lens_get (name, name_len, plens);
+	if (pnum < 0) {
+		return (cef_fib_entry_search_by_shortening (fib, name, name_len));
+	}
+	pnum = cef_hash_tbl_prefix_hashv_get (fib, name, plens, pnum, hashvs);
+
+	for (i = pnum - 1 ; i >= 0 ; i--) {
+		entry = (CefT_Fib_Entry*)
+			cef_hash_tbl_item_get_with_hashv (fib, hashvs[i], name, plens[i]);
+
+		if (entry != NULL) {
+			cef_fib_entry_match_dbg (entry);
+			return (entry);
+		}
+	}
+
+	return (default_route);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the lengths of the prefixes to be probed in ascending order.
+	They are the starts of the 2nd and later components, and the whole name.
+----------------------------------------------------------------------------------------*/
+static int									/* number of prefixes, or -1 if too many	*/
+cef_fib_prefix_lens_get (
+	const unsigned char* name, 				/* Key of the FIB entry						*/
+	uint16_t name_len,						/* Length of Key							*/
+	uint16_t plens[]						/* lengths of the prefixes 					*/
+) {
+	const unsigned char* msp = name;
+	const unsigned char* mep = name + name_len - 1;
+	uint16_t length;
+	int pnum = 0;
+
+	if (name_len == 0) {
+		return (0);
+	}
+	while (msp < mep) {
+		memcpy (&length, &msp[CefC_S_Length], CefC_S_Length);
+		length = ntohs (length);
+
+		if (msp + CefC_S_Type + CefC_S_Length + length < mep) {
+			msp += CefC_S_Type + CefC_S_Length + length;
+		} else {
+			break;
+		}
+		if (pnum >= CefC_Fib_Prefix_Max - 1) {
+			return (-1);
+		}
+		plens[pnum++] = (uint16_t)(msp - name);
+	}
+	plens[pnum++] = name_len;
+
+	return (pnum);
+}
+/*--------------------------------------------------------------------------------------
+	Searches FIB entry shortening the Key one component at a time
+----------------------------------------------------------------------------------------*/
+static CefT_Fib_Entry* 						/* FIB entry 								*/
+cef_fib_entry_search_by_shortening (
+	CefT_Hash_Handle fib,					/* FIB										*/
+	unsigned char* name, 					/* Key of the FIB entry						*/
+	uint16_t name_len						/* Length of Key							*/
 ) {
 	CefT_Fib_Entry* entry;
 	unsigned char* msp;
@@ -102,18 +199,7 @@ cef_fib_entry_search (
 		entry = (CefT_Fib_Entry*) cef_hash_tbl_item_get (fib, name, len);
 
 		if (entry != NULL) {
-#ifdef CefC_Debug
-			{
-				int dbg_x;
-				int len = 0;
-
-				len = sprintf (fib_dbg_msg, "[fib] matched to the entry [");
-				for (dbg_x = 0 ; dbg_x < entry->klen ; dbg_x++) {
-					len = len + sprintf (fib_dbg_msg + len, " %02X", entry->key[dbg_x]);
-				}
-				cef_dbg_write (CefC_Dbg_Finest, "%s ]\n", fib_dbg_msg);
-			}
-#endif // CefC_Debug
+			cef_fib_entry_match_dbg (entry);
 			return (entry);
 		}
 
@@ -134,6 +220,24 @@ cef_fib_entry_search (
 
 	return (default_route);
 }
+/*--------------------------------------------------------------------------------------
+	Outputs the FIB entry matched by the search
+----------------------------------------------------------------------------------------*/
+static inline void
+cef_fib_entry_match_dbg (
+	CefT_Fib_Entry* entry					/* FIB entry 								*/
+) {
+#ifdef CefC_Debug
+	int dbg_x;
+	int len = 0;
+
+	len = sprintf (fib_dbg_msg, "[fib] matched to the entry [");
+	for (dbg_x = 0 ; dbg_x < entry->klen ; dbg_x++) {
+		len = len + sprintf (fib_dbg_msg + len, " %02X", entry->key[dbg_x]);
+	}
+	cef_dbg_write (CefC_Dbg_Finest, "%s ]\n", fib_dbg_msg);
+#endif // CefC_Debug
+}
 /*--------------------------------------------------------------------------------------
 	Obtains Face-ID(s) to forward the Interest matching the specified FIB entry
 ----------------------------------------------------------------------------------------*/
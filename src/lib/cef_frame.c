@@ -731,15 +731,13 @@ cef_frame_message_parse (
 		offset += CefC_S_TLF + tlv_len;
 	}
 
-	/*** Calculate cobhash of this message ***/
+	/*** cobhash of this message is calculated by cef_frame_opheader_msghash_get ***/
 	if ( !poh->MsgHash_len ){
-		uint16_t MsgHash_index = header_len;
-		uint16_t MsgHash_len = payload_len;
-
-		cef_valid_sha256( &msg[MsgHash_index], MsgHash_len, poh->MsgHash.hash_value ); /* for OpenSSL 3.x */
-		poh->MsgHash_len = CefC_HashVal_Len + CefC_S_TLF;
-		poh->MsgHash.hash_type = CefC_T_SHA_256;
-		poh->MsgHash.hash_length = CefC_HashVal_Len;
+		poh->MsgHash_src = &msg[header_len];
+		poh->MsgHash_src_len = payload_len;
+	} else {
+		poh->MsgHash_src = NULL;
+		poh->MsgHash_src_len = 0;
 	}
 
 	/*----------------------------------------------------------------------*/
@@ -919,6 +917,24 @@ cef_dbg_write(CefC_Dbg_Finest, "trailer_len=%u\n", trailer_len);
 ret:
 	return (1);
 }
+/*--------------------------------------------------------------------------------------
+	Obtains the Message Hash of the parsed message. If the message has no MsgHash
+	option header, it is calculated from the payload at the first call.
+----------------------------------------------------------------------------------------*/
+int 										/* Length of MsgHash, or 0 if it has none	*/
+cef_frame_opheader_msghash_get (
+	CefT_CcnMsg_OptHdr* poh 				/* Parsed Option Header						*/
+) {
+	if ( !poh->MsgHash_len && poh->MsgHash_src ){
+		cef_valid_sha256( poh->MsgHash_src, poh->MsgHash_src_len,
+							poh->MsgHash.hash_value ); /* for OpenSSL 3.x */
+		poh->MsgHash_len = CefC_HashVal_Len + CefC_S_TLF;
+		poh->MsgHash.hash_type = CefC_T_SHA_256;
+		poh->MsgHash.hash_length = CefC_HashVal_Len;
+		poh->MsgHash_src = NULL;
+	}
+	return (poh->MsgHash_len);
+}
 /*--------------------------------------------------------------------------------------
 	Parses a payload form the specified message
 ----------------------------------------------------------------------------------------*/
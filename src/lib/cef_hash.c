@@ -41,6 +41,11 @@
 #include <cefore/cef_hash.h>
 #include <cefore/cef_valid.h>	/* for OpenSSL 3.x */
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CefC_Hash_Sse2
+#endif
+
 /****************************************************************************************
  Macros
  ****************************************************************************************/
@@ -51,6 +56,15 @@
 #define CefC_Cleanup_Smax	 		4
 #endif
 
+#define CefC_Hash_Ctrl_Empty		0x80		/* never used 								*/
+#define CefC_Hash_Ctrl_Deleted		0xFE		/* removed (tombstone) 						*/
+#define CefC_Hash_Ctrl_H2(h)		((uint8_t)((h) & 0x7F))
+#define CefC_Hash_No_Index			UINT32_MAX
+#define CefC_Hash_Elem_Max			INT32_MAX	/* index is returned as int 				*/
+#define CefC_Hash_Key_Unit			64			/* unit of the key buffer size 				*/
+#define CefC_Hash_Mul				0xc6a4a7935bd1e995ULL
+#define CefC_Hash_Shift				47
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
@@ -79,9 +93,21 @@ typedef struct CefT_List_Hash {
 /****************************************************************************************
  Static Function Declaration
  ****************************************************************************************/
-static uint32_t
+static inline uint64_t
+cef_hash_block_mix (
+	uint64_t hash,
+	const unsigned char* p
+);
+static inline uint64_t
+cef_hash_final_mix (
+	uint64_t hash,
+	const unsigned char* p,
+	uint32_t rest,
+	uint32_t klen
+);
+static uint64_t
 cef_hash_number_create (
-	uint32_t hash,
+	uint32_t seed,
 	const unsigned char* key,
 	uint32_t klen
 );
@@ -90,6 +116,36 @@ cef_lhash_number_create (
 	const unsigned char* key,
 	uint32_t klen
 );
+static uint64_t
+cef_hash_prime_get (
+	uint64_t n
+);
+static int64_t
+cef_hash_tbl_index_find (
+	CefT_Hash* ht,
+	uint64_t hash,
+	const unsigned char* key,
+	uint32_t klen
+);
+static int
+cef_hash_tbl_index_insert (
+	CefT_Hash* ht,
+	uint64_t hash,
+	const unsigned char* key,
+	uint32_t klen,
+	uint8_t opt,
+	void* elem
+);
+static void*
+cef_hash_tbl_index_release (
+	CefT_Hash* ht,
+	uint32_t index
+);
+static int
+cef_hash_tbl_key_reserve (
+	CefT_Hash_Table* ent,
+	uint32_t klen
+);
 
 /****************************************************************************************
  ****************************************************************************************/
@@ -97,53 +153,7 @@ CefT_Hash_Handle
 cef_hash_tbl_create (
 	uint32_t table_size
 ) {
-	CefT_Hash* ht = NULL;
-	int i, n;
-	int flag;
-	int def_tbl_size = table_size;
-	
-	/* A prime number larger than the maximum size defined by the user	*/
-	/* is set as the table size.										*/
-	/* The maximum size defined by the user is set to "def_elem_max".	*/
-	for (i = table_size ; i > 1 ; i++) {
-		flag = 0;
-		
-		for (n = 2 ; n < table_size ; n++) {
-			if (table_size % n == 0) {
-				flag = 1;
-				break;
-			}
-		}
-		if (flag) {
-			table_size++;
-		} else {
-			break;
-		}
-	}
-	
-	if (table_size > UINT_MAX) {
-		return ((CefT_Hash_Handle) NULL);
-	}
-
-	ht = (CefT_Hash*) malloc (sizeof (CefT_Hash));
-	if (ht == NULL) {
-		return ((CefT_Hash_Handle) NULL);
-	}
-	memset (ht, 0, sizeof (CefT_Hash));
-
-	ht->tbl = (CefT_Hash_Table*) malloc (sizeof (CefT_Hash_Table) * table_size);
-	if (ht->tbl == NULL) {
-		free (ht);
-		return ((CefT_Hash_Handle) NULL);
-	}
-	memset (ht->tbl, 0, sizeof (CefT_Hash_Table) * table_size);
-
-	srand ((unsigned) time (NULL));
-	ht->seed = (uint32_t)(rand () + 1);
-	ht->elem_max = table_size;
-	ht->def_elem_max = def_tbl_size;
-
-	return ((CefT_Hash_Handle) ht);
+	return (cef_hash_tbl_create_ext (table_size, 1));
 }
 
 CefT_Hash_Handle
@@ -152,36 +162,23 @@ cef_hash_tbl_create_ext (
 	uint8_t coef
 ) {
 	CefT_Hash* ht = NULL;
-	int i, n;
-	int flag;
-	uint32_t def_tbl_size = table_size;
 	uint64_t table_size64;
-	
-	table_size64 = table_size * coef;
-	
-	/* A prime number larger than the maximum size defined by the user	*/
-	/* is set as the table size.										*/
+	uint64_t ctrl_num;
+
 	/* The maximum size defined by the user is set to "def_elem_max".	*/
-	for (i = table_size64 ; i > 1 ; i++) {
-		flag = 0;
-		
-		for (n = 2 ; n < table_size64 ; n++) {
-			if (table_size64 % n == 0) {
-				flag = 1;
-				break;
-			}
-		}
-		if (flag) {
-			table_size64++;
-		} else {
-			break;
-		}
+	table_size64 = (uint64_t) table_size * (coef ? coef : 1);
+	if (table_size64 < 1) {
+		table_size64 = 1;
 	}
-	
-	if (table_size64 > UINT32_MAX) {
-		table_size64 = UINT32_MAX;
+	if (table_size64 > CefC_Hash_Elem_Max) {
+		table_size64 = CefC_Hash_Elem_Max;
+	}
+
+	/* The probe table is kept at most 7/8 full		*/
+	ctrl_num = CefC_Hash_Group;
+	while (ctrl_num - ctrl_num / 8 < table_size64) {
+		ctrl_num <<= 1;
 	}
-	table_size = (uint32_t)table_size64;
 
 	ht = (CefT_Hash*) malloc (sizeof (CefT_Hash));
 	if (ht == NULL) {
@@ -189,17 +186,23 @@ cef_hash_tbl_create_ext (
 	}
 	memset (ht, 0, sizeof (CefT_Hash));
 
-	ht->tbl = (CefT_Hash_Table*) malloc (sizeof (CefT_Hash_Table) * table_size);
-	if (ht->tbl == NULL) {
-		free (ht);
+	/* calloc leaves the pages of unused entries untouched 	*/
+	ht->tbl = (CefT_Hash_Table*) calloc (table_size64, sizeof (CefT_Hash_Table));
+	ht->ctrl = (uint8_t*) malloc (ctrl_num + CefC_Hash_Group);
+	ht->ctrl_idx = (uint32_t*) calloc (ctrl_num, sizeof (uint32_t));
+	if ((ht->tbl == NULL) || (ht->ctrl == NULL) || (ht->ctrl_idx == NULL)) {
+		cef_hash_tbl_destroy ((CefT_Hash_Handle) ht);
 		return ((CefT_Hash_Handle) NULL);
 	}
-	memset (ht->tbl, 0, sizeof (CefT_Hash_Table) * table_size);
+	memset (ht->ctrl, CefC_Hash_Ctrl_Empty, ctrl_num + CefC_Hash_Group);
 
 	srand ((unsigned) time (NULL));
 	ht->seed = (uint32_t)(rand () + 1);
-	ht->elem_max = table_size;
-	ht->def_elem_max = def_tbl_size;
+	ht->elem_max = (uint32_t) table_size64;
+	ht->def_elem_max = table_size;
+	ht->free_head = CefC_Hash_No_Index;
+	ht->ctrl_mask = (uint32_t)(ctrl_num - 1);
+	ht->ctrl_growth = (uint32_t)(ctrl_num - ctrl_num / 8);
 
 	return ((CefT_Hash_Handle) ht);
 }
@@ -209,11 +212,21 @@ cef_hash_tbl_destroy (
 	CefT_Hash_Handle handle
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
+	uint32_t i;
 
 	if (ht == NULL) {
 		return;
 	}
-	free (ht->tbl);
+	if (ht->tbl) {
+		for (i = 0 ; i < ht->elem_max ; i++) {
+			if (ht->tbl[i].key) {
+				free (ht->tbl[i].key);
+			}
+		}
+		free (ht->tbl);
+	}
+	free (ht->ctrl);
+	free (ht->ctrl_idx);
 	free (ht);
 
 	return;
@@ -227,81 +240,21 @@ cef_hash_tbl_item_set (
 	void* elem
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
-	uint32_t i;
-	uint32_t empty_index = 0;
-	uint32_t empty_ff = 0;
+	uint64_t hash;
+	int64_t index;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (CefC_Hash_Faile);
 	}
 
 	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
-	if (ht->tbl[index].klen == 0) {
-		ht->tbl[index].hash = hash;
+	index = cef_hash_tbl_index_find (ht, hash, key, klen);
+	if (index >= 0) {
 		ht->tbl[index].elem = elem;
-		ht->tbl[index].klen = klen;
-		memcpy (ht->tbl[index].key, key, klen);
-		ht->elem_num++;
-		return (index);
+		return ((int) index);
 	}
 
-	for (i = index + 1 ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i].klen == 0) {
-			ht->tbl[i].hash = hash;
-			ht->tbl[i].elem = elem;
-			ht->tbl[i].klen = klen;
-			memcpy (ht->tbl[i].key, key, klen);
-			ht->elem_num++;
-			return (i);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			ht->tbl[i].elem = elem;
-			
-			return (i);
-		}
-		if ((ht->tbl[i].klen == -1) && 
-			(empty_ff == 0)){
-			empty_index = i;
-			empty_ff = 1;
-		}
-	}
-
-	for (i = 0 ; i < index ; i++) {
-		if (ht->tbl[i].klen == 0) {
-			ht->tbl[i].hash = hash;
-			ht->tbl[i].elem = elem;
-			ht->tbl[i].klen = klen;
-			memcpy (ht->tbl[i].key, key, klen);
-			ht->elem_num++;
-			return (i);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			ht->tbl[i].elem = elem;
-			return (i);
-		}
-		if ((ht->tbl[i].klen == -1) && 
-			(empty_ff == 0)){
-			empty_index = i;
-			empty_ff = 1;
-		}
-	}
-	
-	if (empty_ff) {
-		ht->tbl[empty_index].hash = hash;
-		ht->tbl[empty_index].elem = elem;
-		ht->tbl[empty_index].klen = klen;
-		memcpy (ht->tbl[empty_index].key, key, klen);
-		ht->elem_num++;
-		return (empty_index);
-	}
-	return (CefC_Hash_Faile);
+	return (cef_hash_tbl_index_insert (ht, hash, key, klen, 0, elem));
 }
 
 int
@@ -313,95 +266,24 @@ cef_hash_tbl_item_set_for_app (
 	void* elem
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
-	uint32_t i;
-	uint32_t empty_index = 0;
-	uint32_t empty_ff = 0;
-	int		 res;
-
-	/*--------------------------*/
-	/* Temporary Implimentation */
-	/*--------------------------*/
+	uint64_t hash;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (CefC_Hash_Faile);
 	}
-	res = cef_hash_tbl_item_check_exact( handle, key, klen );
-	if ( res > 0 ) {
-		return (CefC_Hash_Faile);
-	}
 
 	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
-
-	if (ht->tbl[index].klen == 0) {
-		ht->tbl[index].hash = hash;
-		ht->tbl[index].elem = elem;
-		ht->tbl[index].klen = klen;
-		ht->tbl[index].opt_f = opt;
-		memcpy (ht->tbl[index].key, key, klen);
-		ht->elem_num++;
-		return (index);
-	}
-
-	for (i = index + 1 ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i].klen == 0) {
-			ht->tbl[i].hash = hash;
-			ht->tbl[i].elem = elem;
-			ht->tbl[i].klen = klen;
-			ht->tbl[i].opt_f = opt;
-			memcpy (ht->tbl[i].key, key, klen);
-			ht->elem_num++;
-			return (i);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			return (CefC_Hash_Faile);
-		}
-		if ((ht->tbl[i].klen == -1) && 
-			(empty_ff == 0)){
-			empty_index = i;
-			empty_ff = 1;
-		}
-	}
-
-	for (i = 0 ; i < index ; i++) {
-		if (ht->tbl[i].klen == 0) {
-			ht->tbl[i].hash = hash;
-			ht->tbl[i].elem = elem;
-			ht->tbl[i].klen = klen;
-			ht->tbl[i].opt_f = opt;
-			memcpy (ht->tbl[i].key, key, klen);
-			ht->elem_num++;
-			return (i);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			return (CefC_Hash_Faile);
-		}
-		if ((ht->tbl[i].klen == -1) && 
-			(empty_ff == 0)){
-			empty_index = i;
-			empty_ff = 1;
-		}
-	}
-
-	if (empty_ff) {
-		ht->tbl[empty_index].hash = hash;
-		ht->tbl[empty_index].elem = elem;
-		ht->tbl[empty_index].klen = klen;
-		ht->tbl[empty_index].opt_f = opt;
-		memcpy (ht->tbl[empty_index].key, key, klen);
-		ht->elem_num++;
-		return (empty_index);
+	if (cef_hash_tbl_index_find (ht, hash, key, klen) >= 0) {
+		return (CefC_Hash_Faile);
 	}
 
-	return (CefC_Hash_Faile);
+	return (cef_hash_tbl_index_insert (ht, hash, key, klen, opt, elem));
 }
 
+/*
+ * The "prg" functions use the table as a direct mapped cache. A new entry replaces
+ * the entry which has the same index and the replaced one is returned to the caller.
+ */
 void* 
 cef_hash_tbl_item_set_prg (
 	CefT_Hash_Handle handle,
@@ -410,23 +292,27 @@ cef_hash_tbl_item_set_prg (
 	void* elem
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
+	CefT_Hash_Table* ent;
+	uint64_t hash;
 	void* old_elem = (void*) NULL;
 	
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
 	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
+	ent = &ht->tbl[hash % ht->elem_max];
 	
-	if (ht->tbl[index].klen != 0 && ht->tbl[index].klen != -1) {
-		old_elem = ht->tbl[index].elem;
+	if (cef_hash_tbl_key_reserve (ent, klen) < 0) {
+		return ((void*) NULL);
+	}
+	if (ent->used_f) {
+		old_elem = ent->elem;
 	}
-	ht->tbl[index].hash = hash;
-	ht->tbl[index].elem = elem;
-	ht->tbl[index].klen = klen;
-	memcpy (ht->tbl[index].key, key, klen);
+	ent->hash = hash;
+	ent->elem = elem;
+	ent->klen = klen;
+	ent->used_f = 1;
+	memcpy (ent->key, key, klen);
 	
 	return (old_elem);
 }
@@ -438,21 +324,19 @@ cef_hash_tbl_item_get_prg (
 	uint32_t klen
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
+	CefT_Hash_Table* ent;
+	uint64_t hash;
 	
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
 	
 	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
+	ent = &ht->tbl[hash % ht->elem_max];
 	
-	if (ht->tbl[index].hash == hash) {
-		if ((ht->tbl[index].klen == klen) && 
-			(memcmp (key, ht->tbl[index].key, klen) == 0)) {
-			return ((void*) ht->tbl[index].elem);
-		}
+	if ((ent->used_f) && (ent->hash == hash) && (ent->klen == klen) &&
+		(memcmp (key, ent->key, klen) == 0)) {
+		return ((void*) ent->elem);
 	}
 	
 	return ((void*) NULL);
@@ -469,56 +353,91 @@ cef_hash_tbl_hashv_get (
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (0);
 	}
-	return (cef_hash_number_create (ht->seed, key, klen));
+	return ((uint32_t) cef_hash_number_create (ht->seed, key, klen));
 }
 
+/*
+ * Computes the hash values of the prefixes of the key in one pass. The lengths of the
+ * prefixes must be in ascending order.
+ */
+int											/* number of the hash values 				*/
+cef_hash_tbl_prefix_hashv_get (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	const uint16_t plens[],					/* lengths of the prefixes 					*/
+	int pnum,
+	uint64_t hashvs[]						/* hash value of each prefix 				*/
+) {
+	CefT_Hash* ht = (CefT_Hash*) handle;
+	uint64_t hash;
+	uint32_t pos = 0;
+	int i;
+
+	if (ht == NULL) {
+		return (0);
+	}
+	hash = ht->seed;
+
+	for (i = 0 ; i < pnum ; i++) {
+		if ((plens[i] > CefC_Max_KLen) || ((i > 0) && (plens[i] < plens[i - 1]))) {
+			break;
+		}
+		while (pos + sizeof (uint64_t) <= plens[i]) {
+			hash = cef_hash_block_mix (hash, &key[pos]);
+			pos += sizeof (uint64_t);
+		}
+		hashvs[i] = cef_hash_final_mix (hash, &key[pos], plens[i] - pos, plens[i]);
+	}
+
+	return (i);
+}
+
+/*
+ * Same as cef_hash_tbl_item_get with the hash value of cef_hash_tbl_prefix_hashv_get.
+ */
 void*
-cef_hash_tbl_item_get (
+cef_hash_tbl_item_get_with_hashv (
 	CefT_Hash_Handle handle,
+	uint64_t hashv,
 	const unsigned char* key,
 	uint32_t klen
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
-	uint32_t i;
+	int64_t index;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return ((void*) NULL);
 	}
 
-	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
-
-	if ((ht->tbl[index].hash == hash) &&
-		(ht->tbl[index].klen == klen) &&
-		(memcmp(ht->tbl[index].key, key, klen) == 0)) {
-		return ((void*) ht->tbl[index].elem);
+	index = cef_hash_tbl_index_find (ht, hashv, key, klen);
+	if (index < 0) {
+		return ((void*) NULL);
 	}
 
-	for (i = index + 1 ; i < ht->elem_max ; i++) {
-		if(ht->tbl[i].klen == 0){
-			return ((void*) NULL);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			return ((void*) ht->tbl[i].elem);
-		}
+	return ((void*) ht->tbl[index].elem);
+}
+
+void*
+cef_hash_tbl_item_get (
+	CefT_Hash_Handle handle,
+	const unsigned char* key,
+	uint32_t klen
+) {
+	CefT_Hash* ht = (CefT_Hash*) handle;
+	uint64_t hash;
+	int64_t index;
+
+	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
+		return ((void*) NULL);
 	}
 
-	for (i = 0 ; i < index ; i++) {
-		if(ht->tbl[i].klen == 0){
-			return ((void*) NULL);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			return ((void*) ht->tbl[i].elem);
-		}
+	hash = cef_hash_number_create (ht->seed, key, klen);
+	index = cef_hash_tbl_index_find (ht, hash, key, klen);
+	if (index < 0) {
+		return ((void*) NULL);
 	}
 
-	return ((void*) NULL);
+	return ((void*) ht->tbl[index].elem);
 }
 
 void*
@@ -528,7 +447,8 @@ cef_hash_tbl_item_get_for_app (
 	uint32_t klen
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
+	CefT_Hash_Table* ent;
+	uint64_t hash;
 	uint32_t i;
 	uint32_t entry_klen = 0;
 
@@ -539,24 +459,25 @@ cef_hash_tbl_item_get_for_app (
 	/* for exact match */
 	hash = cef_hash_number_create (ht->seed, key, klen);
 
-	for (i = 0 ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i].klen == 0 || ht->tbl[i].klen == -1)
+	for (i = 0 ; i < ht->tbl_used ; i++) {
+		ent = &ht->tbl[i];
+		if (!ent->used_f)
 			continue;
 		
-		if (ht->tbl[i].opt_f) {
+		if (ent->opt_f) {
 			/* prefix match */
-			entry_klen = ht->tbl[i].klen;
+			entry_klen = ent->klen;
 			if ((entry_klen <= klen) &&
-				(memcmp (ht->tbl[i].key, key, entry_klen) == 0)) {
+				(memcmp (ent->key, key, entry_klen) == 0)) {
 				if (entry_klen == klen) {
-					return ((void*) ht->tbl[i].elem);
+					return ((void*) ent->elem);
 				} else if (entry_klen + 5 <= klen) {
 					/* eg) ccn:/test, ccn:/test/a */
 					/*                         ^^ */
 					/* separator(4) and prefix(more than 1) */
 					if ((key[entry_klen] == 0x00) &&
 						(key[entry_klen + 1] == 0x01)) {
-						return ((void*) ht->tbl[i].elem);
+						return ((void*) ent->elem);
 					}
 				} else {
 					continue;
@@ -564,10 +485,10 @@ cef_hash_tbl_item_get_for_app (
 			}
 		} else {
 			/* exact match */
-			if ((ht->tbl[i].hash == hash) &&
-				(ht->tbl[i].klen == klen) &&
-				(memcmp (ht->tbl[i].key, key, klen) == 0)) {
-				return ((void*) ht->tbl[i].elem);
+			if ((ent->hash == hash) &&
+				(ent->klen == klen) &&
+				(memcmp (ent->key, key, klen) == 0)) {
+				return ((void*) ent->elem);
 			}
 		}
 	}
@@ -583,7 +504,7 @@ cef_hash_tbl_item_get_from_index (
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
 
-	if (index > ht->elem_max) {
+	if ((index >= ht->elem_max) || (!ht->tbl[index].used_f)) {
 		return ((void*) NULL);
 	}
 
@@ -597,106 +518,20 @@ cef_hash_tbl_item_remove (
 	uint32_t klen
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
-	uint32_t i;
-	void* rtc = (void*) NULL;
-	int removed_f = 0;
-	int si;
-	uint32_t removed_indx;
+	uint64_t hash;
+	int64_t index;
 
 	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
 		return (CefC_Hash_False);
 	}
 
 	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
-
-	if ((ht->tbl[index].hash == hash) &&
-		(ht->tbl[index].klen == klen) &&
-		(memcmp(ht->tbl[index].key, key, klen) == 0)) {
-		ht->tbl[index].hash = 0;
-		ht->tbl[index].klen = -1;
-		ht->tbl[index].opt_f = 0;
-		ht->elem_num--;
-		rtc = (void*) ht->tbl[index].elem;
-		ht->tbl[index].elem = NULL;
-		removed_f = 1;
-		removed_indx = index;
-		goto ENDFUNC;
-	}
-
-	for (i = index + 1 ; i < ht->elem_max ; i++) {
-		if(ht->tbl[i].klen == 0){
-			rtc = (void*) NULL;
-			goto ENDFUNC;
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			ht->tbl[i].hash = 0;
-			ht->tbl[i].klen = -1;
-			ht->tbl[i].opt_f = 0;
-			ht->elem_num--;
-			rtc = (void*) ht->tbl[i].elem;
-			ht->tbl[i].elem = NULL;
-			removed_f = 1;
-			removed_indx = i;
-			goto ENDFUNC;
-		}
-	}
-
-	for (i = 0 ; i < index ; i++) {
-		if(ht->tbl[i].klen == 0){
-			return ((void*) NULL);
-		}
-		if ((ht->tbl[i].hash == hash) &&
-			(ht->tbl[i].klen == klen) &&
-			(memcmp(ht->tbl[i].key, key, klen) == 0)) {
-			ht->tbl[i].hash = 0;
-			ht->tbl[i].klen = -1;
-			ht->tbl[i].opt_f = 0;
-			ht->elem_num--;
-			rtc = (void*) ht->tbl[i].elem;
-			ht->tbl[i].elem = NULL;
-			removed_f = 1;
-			removed_indx = i;
-			goto ENDFUNC;
-		}
+	index = cef_hash_tbl_index_find (ht, hash, key, klen);
+	if (index < 0) {
+		return ((void*) NULL);
 	}
 
-ENDFUNC:
-	if(removed_f == 1){
-		/* compaction */
-		if(removed_indx == (ht->elem_max-1)){
-			if(ht->tbl[0].klen == 0){
-				ht->tbl[removed_indx].klen = 0;
-			}
-		} else {
-			if(ht->tbl[removed_indx+1].klen == 0){
-				ht->tbl[removed_indx].klen = 0;
-			}
-		}
-		if(ht->tbl[removed_indx].klen == 0){
-			for(si = (removed_indx-1); si >= 0; si--){
-				if(ht->tbl[si].klen == -1){
-					ht->tbl[si].klen = 0;
-				} else {
-					break;
-				}
-			}
-			if(ht->tbl[0].klen == 0){
-				for(si = (ht->elem_max-1); si > removed_indx; si--){
-					if(ht->tbl[si].klen == -1){
-						ht->tbl[si].klen = 0;
-					} else {
-						break;
-					}
-				}
-			}
-		}
-	}
-	return (rtc);
+	return (cef_hash_tbl_index_release (ht, (uint32_t) index));
 }
 
 void*
@@ -711,8 +546,8 @@ cef_hash_tbl_item_check_from_index (
 		return ((void*) NULL);
 	}
 
-	for (i = *index ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i].klen != 0 && ht->tbl[i].klen != -1){
+	for (i = *index ; i < ht->tbl_used ; i++) {
+		if (ht->tbl[i].used_f) {
 			*index = i;
 			return ((void*) ht->tbl[i].elem);
 		}
@@ -727,22 +562,12 @@ cef_hash_tbl_item_remove_from_index (
 	uint32_t index
 ) {
 	CefT_Hash* ht = (CefT_Hash*) handle;
-	void* rtc = (void*) NULL;
 
-	if (index > ht->elem_max) {
+	if ((index >= ht->elem_max) || (!ht->tbl[index].used_f)) {
 		return ((void*) NULL);
 	}
 
-	if (ht->tbl[index].klen != 0 && ht->tbl[index].klen != -1) {
-		ht->tbl[index].hash = 0;
-		ht->tbl[index].klen = -1;
-		ht->elem_num--;
-		rtc = (void*) ht->tbl[index].elem;
-		ht->tbl[index].elem = NULL;
-		return (rtc);
-	}
-
-	return ((void*) NULL);
+	return (cef_hash_tbl_index_release (ht, index));
 }
 
 int
@@ -779,15 +604,15 @@ cef_hash_tbl_elem_get (
 		return ((void*) NULL);
 	}
 
-	for (i = *index ; i < ht->elem_max ; i++) {
-		if (ht->tbl[i].klen != 0 && ht->tbl[i].klen != -1) {
+	for (i = *index ; i < ht->tbl_used ; i++) {
+		if (ht->tbl[i].used_f) {
 			*index = i;
 			return ((void*) ht->tbl[i].elem);
 		}
 	}
 
-	for (i = 0 ; i < *index ; i++) {
-		if (ht->tbl[i].klen != 0 && ht->tbl[i].klen != -1) {
+	for (i = 0 ; i < *index && i < ht->tbl_used ; i++) {
+		if (ht->tbl[i].used_f) {
 			*index = i;
 			return ((void*) ht->tbl[i].elem);
 		}
@@ -803,23 +628,7 @@ cef_hash_tbl_no_col_item_get (
 	const unsigned char* key,
 	uint32_t klen
 ) {
-	CefT_Hash* ht = (CefT_Hash*) handle;
-	uint32_t hash;
-	uint32_t index;
-
-	if ((klen > CefC_Max_KLen) || (ht == NULL)) {
-		return ((void*) NULL);
-	}
-
-	hash = cef_hash_number_create (ht->seed, key, klen);
-	index = hash % ht->elem_max;
-
-	if ((ht->tbl[index].hash == hash) &&
-		(ht->tbl[index].klen == klen) && 
-		(memcmp(ht->tbl[index].key, key, klen) == 0)) {
-		return ((void*) ht->tbl[index].elem);
-	}
-	return ((void*) NULL);
+	return (cef_hash_tbl_item_get (handle, key, klen));
 }
 
 void* 
@@ -860,29 +669,13 @@ cef_lhash_tbl_create (
 	uint32_t table_size
 ) {
 	CefT_List_Hash* ht = NULL;
-	int i, n;
-	int flag;
 	int def_tbl_size = table_size;
 
 	if (table_size > INT32_MAX) {
 		table_size = INT32_MAX;
 	}
 	
-	for (i = table_size ; i > 1 ; i++) {
-		flag = 0;
-		
-		for (n = 2 ; n < table_size ; n++) {
-			if (table_size % n == 0) {
-				flag = 1;
-				break;
-			}
-		}
-		if (flag) {
-			table_size++;
-		} else {
-			break;
-		}
-	}
+	table_size = cef_hash_prime_get (table_size);
 
 	ht = (CefT_List_Hash*) malloc (sizeof (CefT_List_Hash));
 	if (ht == NULL) {
@@ -909,28 +702,12 @@ cef_lhash_tbl_create_ext (
 	uint8_t coef
 ) {
 	CefT_List_Hash* ht = NULL;
-	int i, n;
-	int flag;
 	uint64_t table_size64;
 	int def_tbl_size = table_size;
 	
-	table_size64 = table_size * coef;
+	table_size64 = (uint64_t) table_size * coef;
 	
-	for (i = table_size64 ; i > 1 ; i++) {
-		flag = 0;
-		
-		for (n = 2 ; n < table_size64 ; n++) {
-			if (table_size64 % n == 0) {
-				flag = 1;
-				break;
-			}
-		}
-		if (flag) {
-			table_size64++;
-		} else {
-			break;
-		}
-	}
+	table_size64 = cef_hash_prime_get (table_size64);
 	
 	if (table_size64 > UINT32_MAX) {
 		table_size64 = UINT32_MAX;
@@ -961,29 +738,15 @@ cef_lhash_tbl_create_u32 (
 	uint32_t table_size
 ) {
 	CefT_List_Hash* ht = NULL;
-	int i, n;
-	int flag;
+	uint64_t table_size64;
 	int def_tbl_size = table_size;
 	
-	for (i = table_size ; i > 1 ; i++) {
-		flag = 0;
-		
-		for (n = 2 ; n < table_size ; n++) {
-			if (table_size % n == 0) {
-				flag = 1;
-				break;
-			}
-		}
-		if (flag) {
-			table_size++;
-		} else {
-			break;
-		}
-	}
+	table_size64 = cef_hash_prime_get (table_size);
 
-	if (table_size > UINT_MAX) {
-		table_size = UINT_MAX;
+	if (table_size64 > UINT_MAX) {
+		table_size64 = UINT_MAX;
 	}
+	table_size = (uint32_t) table_size64;
 
 	ht = (CefT_List_Hash*) malloc (sizeof (CefT_List_Hash));
 	if (ht == NULL) {
@@ -1010,31 +773,15 @@ cef_lhash_tbl_create_u32_ext (
 	uint8_t coef
 ) {
 	CefT_List_Hash* ht = NULL;
-	int i, n;
-	int flag;
 	uint64_t table_size64;
 	int def_tbl_size = table_size;
 	
-	table_size64 = table_size * coef;
+	table_size64 = (uint64_t) table_size * coef;
 	
-	for (i = table_size64 ; i > 1 ; i++) {
-		flag = 0;
-		
-		for (n = 2 ; n < table_size64 ; n++) {
-			if (table_size64 % n == 0) {
-				flag = 1;
-				break;
-			}
-		}
-		if (flag) {
-			table_size64++;
-		} else {
-			break;
-		}
-	}
+	table_size64 = cef_hash_prime_get (table_size64);
 
 	if (table_size64 > UINT32_MAX) {
-		table_size = UINT32_MAX;
+		table_size64 = UINT32_MAX;
 	}
 	table_size = (uint32_t)table_size64;
 
@@ -1478,31 +1225,67 @@ cef_lhash_tbl_item_check_exact (
 /****************************************************************************************
  ****************************************************************************************/
 
-static uint32_t
+/*
+ * Seeded 64 bit hash of the key, derived from MurmurHash64A. The length is mixed in
+ * at the end so that the hashes of all prefixes can be computed in one pass.
+ */
+static inline uint64_t
+cef_hash_block_mix (
+	uint64_t hash,
+	const unsigned char* p
+) {
+	uint64_t k;
+
+	memcpy (&k, p, sizeof (uint64_t));
+	k *= CefC_Hash_Mul;
+	k ^= k >> CefC_Hash_Shift;
+	k *= CefC_Hash_Mul;
+	hash ^= k;
+	hash *= CefC_Hash_Mul;
+
+	return (hash);
+}
+
+static inline uint64_t
+cef_hash_final_mix (
+	uint64_t hash,
+	const unsigned char* p,					/* bytes after the last 8 byte block 		*/
+	uint32_t rest,
+	uint32_t klen
+) {
+	uint64_t k = 0;
+	uint32_t i;
+
+	if (rest) {
+		for (i = 0 ; i < rest ; i++) {
+			k |= (uint64_t) p[i] << (i * 8);
+		}
+		hash ^= k;
+		hash *= CefC_Hash_Mul;
+	}
+	hash ^= (uint64_t) klen;
+	hash *= CefC_Hash_Mul;
+	hash ^= hash >> CefC_Hash_Shift;
+	hash *= CefC_Hash_Mul;
+	hash ^= hash >> CefC_Hash_Shift;
+
+	return (hash);
+}
+
+static uint64_t
 cef_hash_number_create (
-	uint32_t hash,
+	uint32_t seed,
 	const unsigned char* key,
 	uint32_t klen
 ) {
-#if 0
-	int i;
-	char* p = (char*) key;
+	uint64_t hash = seed;
+	uint32_t pos;
 
-	hash += p[0];
-	hash += p[klen - 1];
-	hash += p[(klen - 1) / 2];
-
-	for (i = 0 ; i < klen ; i++) {
-		hash = hash * 33 + p[i];
+	for (pos = 0 ; pos + sizeof (uint64_t) <= klen ; pos += sizeof (uint64_t)) {
+		hash = cef_hash_block_mix (hash, &key[pos]);
 	}
-#endif
-	unsigned char out[MD5_DIGEST_LENGTH];
-	
-//	MD5 (key, klen, out);
-	cef_valid_md5( key, klen, out );	/* for Openssl 3.x */
-	memcpy (&hash, &out[12], sizeof (uint32_t));
 
-	return (hash);
+	return (cef_hash_final_mix (hash, &key[pos], klen - pos, klen));
 }
 
 static uint32_t
@@ -1519,3 +1302,308 @@ cef_lhash_number_create (
 
 	return (hash);
 }
+
+/*
+ * Returns the smallest prime number which is equal to or larger than n.
+ */
+static uint64_t
+cef_hash_prime_get (
+	uint64_t n
+) {
+	uint64_t d;
+
+	if (n < 3) {
+		return (n);
+	}
+	if ((n & 1) == 0) {
+		n++;
+	}
+	for ( ; ; n += 2) {
+		for (d = 3 ; d * d <= n ; d += 2) {
+			if (n % d == 0) {
+				break;
+			}
+		}
+		if (d * d > n) {
+			return (n);
+		}
+	}
+}
+
+/*
+ * Bitmask of the control bytes in the group that are equal to v.
+ */
+static inline uint32_t
+cef_hash_group_match (
+	const uint8_t* ctrl,
+	uint8_t v
+) {
+#ifdef CefC_Hash_Sse2
+	__m128i group = _mm_loadu_si128 ((const __m128i*) ctrl);
+	return ((uint32_t) _mm_movemask_epi8 (_mm_cmpeq_epi8 (group, _mm_set1_epi8 ((char) v))));
+#else // CefC_Hash_Sse2
+	uint32_t mask = 0;
+	int i;
+
+	for (i = 0 ; i < CefC_Hash_Group ; i++) {
+		mask |= (uint32_t)(ctrl[i] == v) << i;
+	}
+	return (mask);
+#endif // CefC_Hash_Sse2
+}
+
+/*
+ * Bitmask of the empty or deleted control bytes in the group.
+ */
+static inline uint32_t
+cef_hash_group_match_free (
+	const uint8_t* ctrl
+) {
+#ifdef CefC_Hash_Sse2
+	return ((uint32_t) _mm_movemask_epi8 (_mm_loadu_si128 ((const __m128i*) ctrl)));
+#else // CefC_Hash_Sse2
+	uint32_t mask = 0;
+	int i;
+
+	for (i = 0 ; i < CefC_Hash_Group ; i++) {
+		mask |= (uint32_t)(ctrl[i] >> 7) << i;
+	}
+	return (mask);
+#endif // CefC_Hash_Sse2
+}
+
+/*
+ * Sets the control byte. The first group is mirrored after the end of the table so
+ * that a group can be loaded from any position.
+ */
+static inline void
+cef_hash_ctrl_set (
+	CefT_Hash* ht,
+	uint32_t pos,
+	uint8_t v
+) {
+	ht->ctrl[pos] = v;
+	ht->ctrl[((pos - CefC_Hash_Group) & ht->ctrl_mask) + CefC_Hash_Group] = v;
+}
+
+static int64_t
+cef_hash_tbl_index_find (
+	CefT_Hash* ht,
+	uint64_t hash,
+	const unsigned char* key,
+	uint32_t klen
+) {
+	CefT_Hash_Table* ent;
+	uint32_t pos = (uint32_t)(hash >> 7) & ht->ctrl_mask;
+	uint32_t stride = 0;
+	uint32_t match;
+	uint32_t index;
+
+	while (1) {
+		match = cef_hash_group_match (&ht->ctrl[pos], CefC_Hash_Ctrl_H2 (hash));
+		while (match) {
+			index = ht->ctrl_idx[(pos + __builtin_ctz (match)) & ht->ctrl_mask];
+			ent = &ht->tbl[index];
+			if ((ent->hash == hash) &&
+				(ent->klen == klen) &&
+				(memcmp (ent->key, key, klen) == 0)) {
+				return ((int64_t) index);
+			}
+			match &= match - 1;
+		}
+		if (cef_hash_group_match (&ht->ctrl[pos], CefC_Hash_Ctrl_Empty)) {
+			return (-1);
+		}
+		stride += CefC_Hash_Group;
+		if (stride > ht->ctrl_mask) {
+			return (-1);
+		}
+		pos = (pos + stride) & ht->ctrl_mask;
+	}
+}
+
+/*
+ * Returns the first empty or deleted position in the probe sequence of the hash.
+ */
+static uint32_t
+cef_hash_tbl_position_free (
+	CefT_Hash* ht,
+	uint64_t hash
+) {
+	uint32_t pos = (uint32_t)(hash >> 7) & ht->ctrl_mask;
+	uint32_t stride = 0;
+	uint32_t match;
+
+	while (1) {
+		match = cef_hash_group_match_free (&ht->ctrl[pos]);
+		if (match) {
+			return ((pos + __builtin_ctz (match)) & ht->ctrl_mask);
+		}
+		stride += CefC_Hash_Group;
+		pos = (pos + stride) & ht->ctrl_mask;
+	}
+}
+
+/*
+ * Rebuilds the probe table to drop the deleted positions. The entries do not move, so
+ * the indexes held by the callers remain valid.
+ */
+static void
+cef_hash_tbl_ctrl_rebuild (
+	CefT_Hash* ht
+) {
+	uint32_t i, pos;
+
+	memset (ht->ctrl, CefC_Hash_Ctrl_Empty, ht->ctrl_mask + 1 + CefC_Hash_Group);
+
+	for (i = 0 ; i < ht->tbl_used ; i++) {
+		if (!ht->tbl[i].used_f) {
+			continue;
+		}
+		pos = cef_hash_tbl_position_free (ht, ht->tbl[i].hash);
+		cef_hash_ctrl_set (ht, pos, CefC_Hash_Ctrl_H2 (ht->tbl[i].hash));
+		ht->ctrl_idx[pos] = i;
+	}
+	ht->ctrl_deleted = 0;
+	ht->ctrl_growth = (ht->ctrl_mask + 1) - (ht->ctrl_mask + 1) / 8 - ht->elem_num;
+}
+
+static int
+cef_hash_tbl_key_reserve (
+	CefT_Hash_Table* ent,
+	uint32_t klen
+) {
+	unsigned char* key;
+	uint32_t kcap;
+
+	if ((ent->key != NULL) && (ent->kcap >= klen)) {
+		return (1);
+	}
+	kcap = (klen + CefC_Hash_Key_Unit) & ~(CefC_Hash_Key_Unit - 1);
+	key = (unsigned char*) realloc (ent->key, kcap);
+	if (key == NULL) {
+		return (-1);
+	}
+	ent->key = key;
+	ent->kcap = kcap;
+
+	return (1);
+}
+
+/*
+ * Stores the key which does not exist in the table yet.
+ */
+static int
+cef_hash_tbl_index_insert (
+	CefT_Hash* ht,
+	uint64_t hash,
+	const unsigned char* key,
+	uint32_t klen,
+	uint8_t opt,
+	void* elem
+) {
+	CefT_Hash_Table* ent;
+	uint32_t index;
+	uint32_t pos;
+
+	if (ht->elem_num >= ht->elem_max) {
+		return (CefC_Hash_Faile);
+	}
+
+	pos = cef_hash_tbl_position_free (ht, hash);
+	if ((ht->ctrl[pos] == CefC_Hash_Ctrl_Empty) && (ht->ctrl_growth == 0)) {
+		cef_hash_tbl_ctrl_rebuild (ht);
+		pos = cef_hash_tbl_position_free (ht, hash);
+	}
+
+	/* takes a removed entry first to keep the used range small	*/
+	index = (ht->free_head != CefC_Hash_No_Index) ? ht->free_head : ht->tbl_used;
+	ent = &ht->tbl[index];
+	if (cef_hash_tbl_key_reserve (ent, klen) < 0) {
+		return (CefC_Hash_Faile);
+	}
+	if (index == ht->free_head) {
+		ht->free_head = ent->next_free;
+	} else {
+		ht->tbl_used++;
+	}
+
+	ent->hash 	= hash;
+	ent->elem 	= elem;
+	ent->klen 	= klen;
+	ent->opt_f 	= opt;
+	ent->used_f = 1;
+	memcpy (ent->key, key, klen);
+
+	if (ht->ctrl[pos] == CefC_Hash_Ctrl_Deleted) {
+		ht->ctrl_deleted--;
+	} else {
+		ht->ctrl_growth--;
+	}
+	cef_hash_ctrl_set (ht, pos, CefC_Hash_Ctrl_H2 (hash));
+	ht->ctrl_idx[pos] = index;
+	ht->elem_num++;
+
+	return ((int) index);
+}
+
+static void*
+cef_hash_tbl_index_release (
+	CefT_Hash* ht,
+	uint32_t index
+) {
+	CefT_Hash_Table* ent = &ht->tbl[index];
+	uint32_t pos = (uint32_t)(ent->hash >> 7) & ht->ctrl_mask;
+	uint32_t stride = 0;
+	uint32_t match;
+	uint32_t empty_before, empty_after;
+	uint32_t n;
+	void* elem;
+
+	/* clears the position of the entry in the probe table 	*/
+	while (stride <= ht->ctrl_mask) {
+		match = cef_hash_group_match (&ht->ctrl[pos], CefC_Hash_Ctrl_H2 (ent->hash));
+		while (match) {
+			n = (pos + __builtin_ctz (match)) & ht->ctrl_mask;
+			if (ht->ctrl_idx[n] == index) {
+				break;
+			}
+			match &= match - 1;
+		}
+		if (match) {
+			/* The position can be empty again if no probe has passed over it, 	*/
+			/* that is, no group containing it has ever been full.				*/
+			empty_before = cef_hash_group_match (
+				&ht->ctrl[(n - CefC_Hash_Group) & ht->ctrl_mask], CefC_Hash_Ctrl_Empty);
+			empty_after = cef_hash_group_match (&ht->ctrl[n], CefC_Hash_Ctrl_Empty);
+			if (empty_before && empty_after &&
+				((__builtin_clz (empty_before) - (32 - CefC_Hash_Group))
+					+ __builtin_ctz (empty_after) < CefC_Hash_Group)) {
+				cef_hash_ctrl_set (ht, n, CefC_Hash_Ctrl_Empty);
+				ht->ctrl_growth++;
+			} else {
+				cef_hash_ctrl_set (ht, n, CefC_Hash_Ctrl_Deleted);
+				ht->ctrl_deleted++;
+			}
+			break;
+		}
+		if (cef_hash_group_match (&ht->ctrl[pos], CefC_Hash_Ctrl_Empty)) {
+			break;
+		}
+		stride += CefC_Hash_Group;
+		pos = (pos + stride) & ht->ctrl_mask;
+	}
+
+	/* the key buffer is kept for the next use of the entry 	*/
+	elem = ent->elem;
+	ent->hash 	= 0;
+	ent->elem 	= NULL;
+	ent->klen 	= 0;
+	ent->opt_f 	= 0;
+	ent->used_f = 0;
+	ent->next_free = ht->free_head;
+	ht->free_head = index;
+	ht->elem_num--;
+
+	return (elem);
+}
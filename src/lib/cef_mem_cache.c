@@ -170,6 +170,8 @@ static uint32_t 				mem_tabl_max;			/* max size 					*/
 														/* of caching hash table		*/
 
 static pthread_mutex_t 			cef_mem_cs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t 				cef_mem_cache_put_cnt = 0;	/* messages the put 		*/
+														/* thread has finished with		*/
 
 static int	cache_cs_expire_check_stat = 0;
 
@@ -478,7 +480,7 @@ cef_mem_cache_put_thread (
 							msg, payload_len, header_len, &poh, &pm, CefC_PT_OBJECT);
 
 			if (res < 0) {
-				continue;
+				goto PUT_DONE;
 			}
 			chunk_field_len = CefC_S_Type + CefC_S_Length + CefC_S_ChunkNum;
 			entry = (CefMemCacheT_Content_Entry*)malloc (sizeof (CefMemCacheT_Content_Entry));
@@ -489,7 +491,7 @@ cef_mem_cache_put_thread (
 				entry->name_len = pm.name_len - chunk_field_len;
 			} else {
 				free (entry);
-				continue;
+				goto PUT_DONE;
 			}
 			entry->pay_len = pm.payload_len;
 			entry->chunk_num = pm.chunk_num;
@@ -512,11 +514,23 @@ cef_mem_cache_put_thread (
 			if (entry->ver_len > 0)
 				free (entry->version);
 			free (entry);
+PUT_DONE:;
+			/* Lets cefnetd stop looking at its copy of this message 		*/
+			__atomic_add_fetch (&cef_mem_cache_put_cnt, 1, __ATOMIC_RELEASE);
 	    }
 	}
 	pthread_exit (NULL);
 	return 0;
 }
+/*--------------------------------------------------------------------------------------
+	Number of messages the put thread has stored or discarded
+----------------------------------------------------------------------------------------*/
+uint64_t
+cef_mem_cache_put_count_get (
+	void
+) {
+	return (__atomic_load_n (&cef_mem_cache_put_cnt, __ATOMIC_ACQUIRE));
+}
 /*--------------------------------------------------------------------------------------
 	Thread to clear expirly content object of memory cache
 ----------------------------------------------------------------------------------------*/
@@ -47,14 +47,31 @@
 #define CefC_Mp_Block_UnitBytes		16
 #define CefC_Mp_Max_Elem_Size		819200
 
+#define CefC_Mp_Cache_Pools			64		/* pools which have the thread caches 		*/
+#define CefC_Mp_Magazine_Size		64		/* blocks cached by a thread for a pool		*/
+#define CefC_Mp_Magazine_Batch		(CefC_Mp_Magazine_Size / 2)
+											/* blocks exchanged with the pool at once 	*/
+#define CefC_PktBuf_Increment		64		/* packet buffers pooled at one time 		*/
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/*
+ * Each block is preceded by this header, so that the owner is found from the
+ * address without searching the pools.
+ */
+typedef union CefT_Mp_Block_Hdr {
+	struct {
+		struct CefT_Mp_Mng*			mng;	/* memory pool which owns the block 		*/
+		union CefT_Mp_Block_Hdr*	next;	/* next block in the free list 				*/
+	} h;
+	unsigned char 			pad[CefC_Mp_Block_UnitBytes];
+} CefT_Mp_Block_Hdr;
+
 typedef struct CefT_Mp_Pool {
-	unsigned char* 			head;
-	unsigned char* 			tail;
 	unsigned char* 			blocks;
+	struct CefT_Mp_Pool*	next;
 } CefT_Mp_Pool;
 
 /*
@@ -65,25 +82,54 @@ typedef struct CefT_Mp_Mng {
 	size_t					klen;
 
 	size_t					size;			/* size of one memory block 				*/
+											/* including CefT_Mp_Block_Hdr 				*/
 	int						increment;		/* number of blocks to allocate at one time	*/
 
 	CefT_Mp_Pool*			pool;			/* memory pool 		 						*/
 	size_t 					pool_num;
 
-	unsigned char**			free;
-	size_t 					head;
-	size_t 					tail;
+	CefT_Mp_Block_Hdr*		free;			/* free list 								*/
+	size_t 					free_num;
 	size_t 					block_num;		/* number of allocated memory blocked 		*/
-	size_t 					mask;
+
+	int						cache_id;		/* index of the thread caches, or -1 		*/
+	uint64_t				gen;			/* generation to detect stale caches 		*/
+	uint64_t				cache_hits;
+	uint64_t				cache_misses;
 
 	pthread_mutex_t 		mp_mutex_pt;	/* mutex for thread safe for Pthread 		*/
 
 } CefT_Mp_Mng;
 
+/*
+ * Blocks cached by a thread for a memory pool.
+ */
+typedef struct CefT_Mp_Magazine {
+	CefT_Mp_Mng*			mng;
+	uint64_t				gen;
+	uint64_t				hits;			/* not yet reported to the pool 			*/
+	int						num;
+	CefT_Mp_Block_Hdr*		blocks[CefC_Mp_Magazine_Size];
+} CefT_Mp_Magazine;
+
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
+static __thread CefT_Mp_Magazine* mp_magazines[CefC_Mp_Cache_Pools];
+
+static pthread_key_t mp_tls_key;
+static pthread_once_t mp_tls_once = PTHREAD_ONCE_INIT;
 
+static pthread_mutex_t mp_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static CefT_Mp_Mng* mp_registry[CefC_Mp_Cache_Pools];
+static uint64_t mp_generation = 0;
+
+/* Capacities of the size classes of the packet buffers 	*/
+static const uint32_t pktbuf_class_size[CefC_PktBuf_Classes] = {
+	256, 2048, 9216, CefC_Max_Length + 1
+};
+static CefT_Mp_Handle pktbuf_mps[CefC_PktBuf_Classes];
+static pthread_once_t pktbuf_once = PTHREAD_ONCE_INIT;
 
 /****************************************************************************************
  Static Function Declaration
@@ -105,6 +151,21 @@ cef_mpool_handle_destroy (
 	CefT_Mp_Mng* mpmng
 );
 
+static CefT_Mp_Magazine*
+cef_mpool_magazine_get (
+	CefT_Mp_Mng* mpmng
+);
+
+static void
+cef_pktbuf_pools_create (
+	void
+);
+
+static void
+cef_mpool_magazine_release (
+	void* arg
+);
+
 /****************************************************************************************
  ****************************************************************************************/
 
@@ -144,44 +205,44 @@ cef_mpool_alloc (
 	CefT_Mp_Handle mph
 ) {
 	CefT_Mp_Mng* mpmng = (CefT_Mp_Mng*) mph;
-	size_t index;
-	int res;
+	CefT_Mp_Magazine* mag;
+	CefT_Mp_Block_Hdr* hdr = NULL;
 
-	while (1) {
-		res = pthread_mutex_trylock (&mpmng->mp_mutex_pt);
+	mag = cef_mpool_magazine_get (mpmng);
 
-		if (res != 0) {
-			if (res == EBUSY) {
-				const struct timespec ts_req = { 0, 1000000 };	/* 1 mili sec. */
-
-				nanosleep(&ts_req, NULL);
-				continue;
-			}
-			return (NULL);
-		}
-		break;
+	if (mag && mag->num > 0) {
+		mag->hits++;
+		hdr = mag->blocks[--mag->num];
+		return ((void*)(hdr + 1));
 	}
 
+	pthread_mutex_lock (&mpmng->mp_mutex_pt);
 
-	if (mpmng->tail != mpmng->head) {
-		index = mpmng->head;
-		mpmng->head = (mpmng->head + 1) & mpmng->mask;
+	if ((mpmng->free == NULL) && (cef_mpool_handle_update (mpmng) < 0)) {
 		pthread_mutex_unlock (&mpmng->mp_mutex_pt);
-		return ((void*) mpmng->free[index]);
+		return ((void*) NULL);
 	}
-
-	res = cef_mpool_handle_update (mpmng);
-
-	if (res > 0) {
-		index = mpmng->head;
-		mpmng->head = (mpmng->head + 1) & mpmng->mask;
-		pthread_mutex_unlock (&mpmng->mp_mutex_pt);
-		return ((void*) mpmng->free[index]);
+	mpmng->cache_misses++;
+
+	if (mag) {
+		/* Refills the thread cache 	*/
+		mpmng->cache_hits += mag->hits;
+		mag->hits = 0;
+		while ((mpmng->free != NULL) && (mag->num < CefC_Mp_Magazine_Batch)) {
+			mag->blocks[mag->num++] = mpmng->free;
+			mpmng->free = mpmng->free->h.next;
+			mpmng->free_num--;
+		}
+		hdr = mag->blocks[--mag->num];
+	} else {
+		hdr = mpmng->free;
+		mpmng->free = hdr->h.next;
+		mpmng->free_num--;
 	}
 
 	pthread_mutex_unlock (&mpmng->mp_mutex_pt);
 
-	return ((void*) NULL);
+	return ((void*)(hdr + 1));
 }
 
 void
@@ -190,32 +251,43 @@ cef_mpool_free (
 	void* ptr
 ) {
 	CefT_Mp_Mng* mpmng = (CefT_Mp_Mng*) mph;
-	int i = 0;
-	int res;
+	CefT_Mp_Magazine* mag;
+	CefT_Mp_Block_Hdr* hdr;
 
-	while (1) {
-		res = pthread_mutex_trylock (&mpmng->mp_mutex_pt);
+	if (ptr == NULL) {
+		return;
+	}
+	hdr = (CefT_Mp_Block_Hdr*) ptr - 1;
+	if (hdr->h.mng != mpmng) {
+		/* not a block of this memory pool 	*/
+		return;
+	}
 
-		if (res != 0) {
-			if (res == EBUSY) {
-				const struct timespec ts_req = { 0, 1000000 };	/* 1 mili sec. */
+	mag = cef_mpool_magazine_get (mpmng);
 
-				nanosleep(&ts_req, NULL);
-				continue;
-			}
-			return;
-		}
-		break;
+	if (mag && mag->num < CefC_Mp_Magazine_Size) {
+		mag->hits++;
+		mag->blocks[mag->num++] = hdr;
+		return;
 	}
 
-	while (i < mpmng->pool_num) {
-		if (((unsigned char*) ptr > mpmng->pool[i].head) &&
-			((unsigned char*) ptr < mpmng->pool[i].tail)) {
-			mpmng->tail = (mpmng->tail + 1) & mpmng->mask;
-			mpmng->free[mpmng->tail] = ptr;
-			break;
+	pthread_mutex_lock (&mpmng->mp_mutex_pt);
+	mpmng->cache_misses++;
+
+	if (mag) {
+		/* Returns the half of the thread cache to the pool 	*/
+		mpmng->cache_hits += mag->hits;
+		mag->hits = 0;
+		while (mag->num > CefC_Mp_Magazine_Size - CefC_Mp_Magazine_Batch) {
+			mag->blocks[--mag->num]->h.next = mpmng->free;
+			mpmng->free = mag->blocks[mag->num];
+			mpmng->free_num++;
 		}
-		i++;
+		mag->blocks[mag->num++] = hdr;
+	} else {
+		hdr->h.next = mpmng->free;
+		mpmng->free = hdr;
+		mpmng->free_num++;
 	}
 
 	pthread_mutex_unlock (&mpmng->mp_mutex_pt);
@@ -235,6 +307,113 @@ cef_mpool_destroy (
 	}
 }
 
+/*
+ * Obtains the statistics of the memory pool.
+ * The thread caches report their hits when they exchange blocks with the pool.
+ */
+int											/* Returns a negative value if it fails 	*/
+cef_mpool_stat_get (
+	CefT_Mp_Handle mph,
+	CefT_Mp_Stat* stat
+) {
+	CefT_Mp_Mng* mpmng = (CefT_Mp_Mng*) mph;
+
+	if ((mpmng == NULL) || (stat == NULL)) {
+		return (-1);
+	}
+	memset (stat, 0, sizeof (CefT_Mp_Stat));
+
+	pthread_mutex_lock (&mpmng->mp_mutex_pt);
+	if (mpmng->key) {
+		strncpy (stat->key, mpmng->key, sizeof (stat->key) - 1);
+	}
+	stat->block_size 	= mpmng->size - sizeof (CefT_Mp_Block_Hdr);
+	stat->block_num 	= mpmng->block_num;
+	stat->free_num 		= mpmng->free_num;
+	stat->seg_num 		= mpmng->pool_num;
+	stat->cache_hits 	= mpmng->cache_hits;
+	stat->cache_misses 	= mpmng->cache_misses;
+	pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+
+	return (1);
+}
+
+CefT_Pkt_Buf*
+cef_pktbuf_alloc (
+	size_t len
+) {
+	CefT_Pkt_Buf* pkt = NULL;
+	int i;
+
+	pthread_once (&pktbuf_once, cef_pktbuf_pools_create);
+
+	for (i = 0 ; i < CefC_PktBuf_Classes ; i++) {
+		if (len <= pktbuf_class_size[i]) {
+			break;
+		}
+	}
+	if ((i < CefC_PktBuf_Classes) && (pktbuf_mps[i] != 0)) {
+		pkt = (CefT_Pkt_Buf*) cef_mpool_alloc (pktbuf_mps[i]);
+		if (pkt) {
+			pkt->size = pktbuf_class_size[i];
+		}
+	} else {
+		i = CefC_PktBuf_Classes;
+		pkt = (CefT_Pkt_Buf*) malloc (sizeof (CefT_Pkt_Buf) + len);
+		if (pkt) {
+			pkt->size = (uint32_t) len;
+		}
+	}
+	if (pkt == NULL) {
+		return (NULL);
+	}
+	pkt->size_class = (uint8_t) i;
+	atomic_init (&pkt->refcnt, 1);
+
+	return (pkt);
+}
+
+CefT_Pkt_Buf*
+cef_pktbuf_ref (
+	CefT_Pkt_Buf* pkt
+) {
+	atomic_fetch_add_explicit (&pkt->refcnt, 1, memory_order_relaxed);
+	return (pkt);
+}
+
+void
+cef_pktbuf_release (
+	CefT_Pkt_Buf* pkt
+) {
+	if (pkt == NULL) {
+		return;
+	}
+	if (atomic_fetch_sub_explicit (&pkt->refcnt, 1, memory_order_acq_rel) != 1) {
+		return;
+	}
+	if (pkt->size_class < CefC_PktBuf_Classes) {
+		cef_mpool_free (pktbuf_mps[pkt->size_class], pkt);
+	} else {
+		free (pkt);
+	}
+}
+
+int
+cef_pktbuf_mpool_handles_get (
+	CefT_Mp_Handle* mps,
+	int max
+) {
+	int num = 0;
+	int i;
+
+	for (i = 0 ; i < CefC_PktBuf_Classes && num < max ; i++) {
+		if (pktbuf_mps[i] != 0) {
+			mps[num++] = pktbuf_mps[i];
+		}
+	}
+	return (num);
+}
+
 /*=======================================================================================
  =======================================================================================*/
 
@@ -247,17 +426,7 @@ cef_mpool_handle_create (
 											/* one time.								*/
 ) {
 	CefT_Mp_Mng* mpmng;
-	size_t i;
-	unsigned char* bp;
-
-	int p;
-
-	increment--;
-
-	for (p = 0 ; increment != 0 ; increment >>= 1) {
-		p = (p << 1) + 1;
-	}
-	increment = p + 1;
+	int i;
 
 	/* allocation the memory for the new memory pool 	*/
 	mpmng = (CefT_Mp_Mng*) malloc (sizeof (CefT_Mp_Mng));
@@ -265,7 +434,7 @@ cef_mpool_handle_create (
 		return (NULL);
 	}
 	memset (mpmng, 0, sizeof (CefT_Mp_Mng));
-
+	mpmng->cache_id = -1;
 
 	if (key != NULL) {
 		mpmng->klen = (size_t) strlen (key);
@@ -280,7 +449,7 @@ cef_mpool_handle_create (
 	/* set the block size to a multiple of 16 for the alignment 	*/
 	mpmng->size
 		= ((size + CefC_Mp_Block_UnitBytes - 1) / CefC_Mp_Block_UnitBytes)
-			* CefC_Mp_Block_UnitBytes;
+			* CefC_Mp_Block_UnitBytes + sizeof (CefT_Mp_Block_Hdr);
 
 	/* record the number of blocks to allocate at one time 		*/
 	mpmng->increment = increment;
@@ -289,46 +458,23 @@ cef_mpool_handle_create (
 	}
 
 	/* allocate the memory pool 	*/
-	mpmng->pool_num = 1;
-	mpmng->pool = (CefT_Mp_Pool*) calloc (mpmng->pool_num, sizeof (CefT_Mp_Pool));
-
-	if (mpmng->pool == NULL) {
+	if (cef_mpool_handle_update (mpmng) < 0) {
 		cef_mpool_handle_destroy (mpmng);
 		return (NULL);
 	}
-	memset (mpmng->pool, 0, sizeof (CefT_Mp_Pool) * mpmng->pool_num);
-
-	mpmng->pool[0].blocks
-		= (unsigned char*) calloc (mpmng->increment, mpmng->size);
-	if (mpmng->pool[0].blocks == NULL) {
-		cef_mpool_handle_destroy (mpmng);
-		return (NULL);
-	}
-	memset (mpmng->pool[0].blocks, 0, mpmng->increment * mpmng->size);
-
-	mpmng->pool[0].head = mpmng->pool[0].blocks - 1;
-	mpmng->pool[0].tail
-		= mpmng->pool[0].blocks + mpmng->increment * (mpmng->size - 1) + 1;
-
-	/* prepare management information 	*/
-	mpmng->block_num = mpmng->increment;
-	mpmng->mask = mpmng->block_num - 1;
-	mpmng->free
-		= (unsigned char**) malloc (sizeof (unsigned char*) * mpmng->block_num);
-	if (mpmng->free == NULL) {
-		cef_mpool_handle_destroy (mpmng);
-		return (NULL);
-	}
-	mpmng->head = 0;
-	mpmng->tail = mpmng->block_num - 1;
-
-	bp = mpmng->pool[0].blocks;
+	pthread_mutex_init (&mpmng->mp_mutex_pt, NULL);
 
-	for (i = 0 ; i < mpmng->block_num ; i++) {
-		mpmng->free[i] = bp;
-		bp += mpmng->size;
+	/* assign the thread caches 	*/
+	pthread_mutex_lock (&mp_registry_mutex);
+	mpmng->gen = ++mp_generation;
+	for (i = 0 ; i < CefC_Mp_Cache_Pools ; i++) {
+		if (mp_registry[i] == NULL) {
+			mp_registry[i] = mpmng;
+			mpmng->cache_id = i;
+			break;
+		}
 	}
-	pthread_mutex_init (&mpmng->mp_mutex_pt, NULL);
+	pthread_mutex_unlock (&mp_registry_mutex);
 
 	return (mpmng);
 }
@@ -338,61 +484,35 @@ cef_mpool_handle_update (
 	CefT_Mp_Mng* mpmng
 ) {
 	CefT_Mp_Pool* new_pool;
-	unsigned char** new_free;
-	size_t new_block_num;
-	size_t i;
+	CefT_Mp_Block_Hdr* hdr;
 	unsigned char* bp;
+	int i;
 
 	/* allocate the memory pool 	*/
-	new_pool = (CefT_Mp_Pool*) calloc (mpmng->pool_num + 1, sizeof (CefT_Mp_Pool));
+	new_pool = (CefT_Mp_Pool*) calloc (1, sizeof (CefT_Mp_Pool));
 	if (new_pool == NULL) {
 		return (-1);
 	}
-	memset (new_pool, 0, sizeof (CefT_Mp_Pool) * (mpmng->pool_num + 1));
-
-	for (i = 0 ; i < mpmng->pool_num ; i++) {
-		new_pool[i].blocks 	= mpmng->pool[i].blocks;
-		new_pool[i].head 	= mpmng->pool[i].head;
-		new_pool[i].tail 	= mpmng->pool[i].tail;
-	}
-	new_pool[i].blocks = (unsigned char*) calloc (mpmng->increment, mpmng->size);
-	if (new_pool[i].blocks == NULL) {
+	new_pool->blocks = (unsigned char*) calloc (mpmng->increment, mpmng->size);
+	if (new_pool->blocks == NULL) {
 		free (new_pool);
 		return (-1);
 	}
-	memset (new_pool[i].blocks, 0, mpmng->increment * mpmng->size);
-
-	new_pool[i].head = new_pool[i].blocks - 1;
-	new_pool[i].tail = new_pool[i].blocks + mpmng->increment * (mpmng->size - 1) + 1;
-
-
-	free (mpmng->pool);
+	new_pool->next = mpmng->pool;
 	mpmng->pool = new_pool;
 	mpmng->pool_num++;
 
-	/* prepare management information 	*/
-	new_block_num = mpmng->block_num + mpmng->increment;
-	new_free = (unsigned char**) malloc (sizeof (unsigned char*) * new_block_num);
-	if (new_free == NULL) {
-		mpmng->pool_num--;
-		return (-1);
+	/* link the new blocks to the free list 	*/
+	bp = new_pool->blocks + (size_t)(mpmng->increment - 1) * mpmng->size;
+	for (i = 0 ; i < mpmng->increment ; i++) {
+		hdr = (CefT_Mp_Block_Hdr*) bp;
+		hdr->h.mng = mpmng;
+		hdr->h.next = mpmng->free;
+		mpmng->free = hdr;
+		bp -= mpmng->size;
 	}
-
-	bp = mpmng->pool[i].blocks;
-	for (i = mpmng->block_num ; i < new_block_num ; i++) {
-		new_free[i] = bp;
-		bp += mpmng->size;
-	}
-	for (i = 0 ; i < mpmng->block_num ; i++) {
-		new_free[i] = mpmng->free[i];
-	}
-	free (mpmng->free);
-	mpmng->free = new_free;
-
-	mpmng->head = mpmng->block_num;
-	mpmng->block_num = new_block_num;
-	mpmng->mask = mpmng->block_num - 1;
-	mpmng->tail = mpmng->block_num - 1;
+	mpmng->free_num += mpmng->increment;
+	mpmng->block_num += mpmng->increment;
 
 	return (1);
 }
@@ -401,28 +521,126 @@ static void
 cef_mpool_handle_destroy (
 	CefT_Mp_Mng* mpmng
 ) {
-	int i;
+	CefT_Mp_Pool* pool;
 
 	if (mpmng == NULL) {
 		return;
 	}
 
-	if (mpmng->pool) {
-		for (i = 0 ; i < mpmng->pool_num ; i++) {
-			free (mpmng->pool[i].blocks);
-		}
-		free (mpmng->pool);
+	if (mpmng->cache_id >= 0) {
+		pthread_mutex_lock (&mp_registry_mutex);
+		mp_registry[mpmng->cache_id] = NULL;
+		pthread_mutex_unlock (&mp_registry_mutex);
 	}
 
-	if (mpmng->key) {
-		free (mpmng->key);
+	while (mpmng->pool) {
+		pool = mpmng->pool;
+		mpmng->pool = pool->next;
+		free (pool->blocks);
+		free (pool);
 	}
 
-	if (mpmng->free) {
-		free (mpmng->free);
+	if (mpmng->key) {
+		free (mpmng->key);
 	}
 
 	free (mpmng);
 
 	return;
 }
+
+static void
+cef_mpool_tls_key_create (
+	void
+) {
+	pthread_key_create (&mp_tls_key, cef_mpool_magazine_release);
+}
+
+/*
+ * Returns the cache of the calling thread for the memory pool.
+ * A cache left by a destroyed memory pool is emptied without touching its blocks.
+ */
+static CefT_Mp_Magazine*
+cef_mpool_magazine_get (
+	CefT_Mp_Mng* mpmng
+) {
+	CefT_Mp_Magazine* mag;
+
+	if (mpmng->cache_id < 0) {
+		return (NULL);
+	}
+	mag = mp_magazines[mpmng->cache_id];
+
+	if (mag == NULL) {
+		mag = (CefT_Mp_Magazine*) calloc (1, sizeof (CefT_Mp_Magazine));
+		if (mag == NULL) {
+			return (NULL);
+		}
+		mp_magazines[mpmng->cache_id] = mag;
+
+		/* the caches are returned to the pools when the thread exits 	*/
+		pthread_once (&mp_tls_once, cef_mpool_tls_key_create);
+		pthread_setspecific (mp_tls_key, mp_magazines);
+	}
+	if ((mag->mng != mpmng) || (mag->gen != mpmng->gen)) {
+		mag->mng = mpmng;
+		mag->gen = mpmng->gen;
+		mag->hits = 0;
+		mag->num = 0;
+	}
+
+	return (mag);
+}
+
+/*
+ * Returns the blocks cached by the exiting thread to the memory pools.
+ */
+static void
+cef_mpool_magazine_release (
+	void* arg
+) {
+	CefT_Mp_Magazine** mags = (CefT_Mp_Magazine**) arg;
+	CefT_Mp_Magazine* mag;
+	CefT_Mp_Mng* mpmng;
+	int i;
+
+	pthread_mutex_lock (&mp_registry_mutex);
+
+	for (i = 0 ; i < CefC_Mp_Cache_Pools ; i++) {
+		mag = mags[i];
+		if (mag == NULL) {
+			continue;
+		}
+		mpmng = mp_registry[i];
+
+		if (mpmng && (mag->mng == mpmng) && (mag->gen == mpmng->gen)) {
+			pthread_mutex_lock (&mpmng->mp_mutex_pt);
+			mpmng->cache_hits += mag->hits;
+			while (mag->num > 0) {
+				mag->blocks[--mag->num]->h.next = mpmng->free;
+				mpmng->free = mag->blocks[mag->num];
+				mpmng->free_num++;
+			}
+			pthread_mutex_unlock (&mpmng->mp_mutex_pt);
+		}
+		free (mag);
+		mags[i] = NULL;
+	}
+
+	pthread_mutex_unlock (&mp_registry_mutex);
+}
+
+static void
+cef_pktbuf_pools_create (
+	void
+) {
+	char key[32];
+	int i;
+
+	/* If a pool is not created, the buffers of its size class are allocated by malloc */
+	for (i = 0 ; i < CefC_PktBuf_Classes ; i++) {
+		sprintf (key, "CefPktBuf%u", pktbuf_class_size[i]);
+		pktbuf_mps[i] = cef_mpool_init (key,
+			sizeof (CefT_Pkt_Buf) + pktbuf_class_size[i], CefC_PktBuf_Increment);
+	}
+}
@@ -57,10 +57,27 @@
  Macros
  ****************************************************************************************/
 
+#define	CefC_Pit_Wheel_Collected	UINT64_MAX	/* tw_tick of the collected entries 	*/
+#define	CefC_Pit_Slab_Increment		256			/* entries pooled at one time			*/
+#define	CefC_Pit_Face_Increment		1024		/* faces pooled at one time				*/
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
 
+/*------------------------------------------------------------------*/
+/* Hierarchical timing wheel which drives the expiry of a PIT		*/
+/*------------------------------------------------------------------*/
+typedef struct CefT_Pit_Wheel {
+
+	CefT_Hash_Handle 	pit;				/* PIT which owns this wheel				*/
+	uint64_t 			cur_tick;			/* next tick to be processed				*/
+	CefT_Pit_Entry* 	slots[CefC_Pit_Wheel_Levels][CefC_Pit_Wheel_Slots];
+	CefT_Pit_Entry* 	expired;			/* entries collected by the last advance	*/
+	CefT_Pit_Expiry_Stat stat;				/* statistics								*/
+	uint32_t 			objhash_num;		/* entries whose key has ObjHashRestr		*/
+
+} CefT_Pit_Wheel;
 
 /****************************************************************************************
  State Variables
@@ -74,6 +91,14 @@ static uint32_t ccninfo_reply_timeout = CefC_Default_CcninfoReplyTimeout;
 static uint32_t symbolic_max_lifetime;
 static uint32_t regular_max_lifetime;
 
+static CefT_Pit_Wheel* pit_wheels[CefC_Pit_Wheel_Max] = { NULL };
+
+/* Key capacities of the size classes of the PIT entry slabs 	*/
+static const size_t pit_slab_key_size[CefC_Pit_Slab_Classes] = { 128, 512, CefC_NAME_BUFSIZ };
+static CefT_Mp_Handle pit_entry_mp[CefC_Pit_Slab_Classes] = { 0 };
+static CefT_Mp_Handle pit_dnface_mp = 0;
+static CefT_Mp_Handle pit_upface_mp = 0;
+
 #define	CefC_IR_SUPPORT_NUM			3
 uint8_t	IR_PRIORITY_TBL[CefC_IR_SUPPORT_NUM] = {
 	CefC_IR_HOPLIMIT_EXCEEDED,
@@ -113,6 +138,81 @@ cef_pit_cleanup (
 	CefT_Hash_Handle pit,					/* PIT										*/
 	CefT_Pit_Entry* entry 					/* PIT entry 								*/
 );
+/*--------------------------------------------------------------------------------------
+	Returns the expiry wheel of the specified PIT
+----------------------------------------------------------------------------------------*/
+static CefT_Pit_Wheel*						/* expiry wheel, or NULL if it has no wheel */
+cef_pit_wheel_get (
+	CefT_Hash_Handle pit					/* PIT										*/
+);
+/*--------------------------------------------------------------------------------------
+	Links the specified PIT entry to the slot of the specified tick
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_wheel_link (
+	CefT_Pit_Wheel* wheel,					/* expiry wheel								*/
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	uint64_t tick							/* tick when the entry is checked			*/
+);
+/*--------------------------------------------------------------------------------------
+	Unlinks the specified PIT entry from the expiry wheel
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_wheel_unlink (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Schedules the check of the specified PIT entry if it is earlier than the current one
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_entry_expiry_set (
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	uint64_t due_us							/* time when the entry is checked (usec)	*/
+);
+/*--------------------------------------------------------------------------------------
+	Allocates a PIT entry which holds the key of the specified length
+----------------------------------------------------------------------------------------*/
+static CefT_Pit_Entry*						/* PIT entry, or NULL if it fails			*/
+cef_pit_entry_alloc (
+	int key_len								/* Length of the key						*/
+);
+/*--------------------------------------------------------------------------------------
+	Releases the memory of the specified PIT entry
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_entry_release (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Allocates a Down Face entry of the specified PIT entry
+----------------------------------------------------------------------------------------*/
+static CefT_Down_Faces*						/* Down Face entry, or NULL if it fails		*/
+cef_pit_dnface_alloc (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Releases the specified Down Face entry
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_dnface_release (
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	CefT_Down_Faces* dnface					/* Down Face entry							*/
+);
+/*--------------------------------------------------------------------------------------
+	Allocates an Up Face entry of the specified PIT entry
+----------------------------------------------------------------------------------------*/
+static CefT_Up_Faces*						/* Up Face entry, or NULL if it fails		*/
+cef_pit_upface_alloc (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+);
+/*--------------------------------------------------------------------------------------
+	Releases the specified Up Face entry
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_upface_release (
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	CefT_Up_Faces* upface					/* Up Face entry							*/
+);
 /****************************************************************************************
  ****************************************************************************************/
 
@@ -128,6 +228,23 @@ cef_pit_init (
 	ccninfo_reply_timeout = reply_timeout;
 	symbolic_max_lifetime = symbolic_max_lt;
 	regular_max_lifetime = regular_max_lt;
+
+	/* Creates the slabs of the PIT entries and faces. If a slab is not created, 	*/
+	/* its blocks are allocated by malloc.											*/
+	if (pit_dnface_mp == 0) {
+		char key[32];
+		int i;
+
+		for (i = 0 ; i < CefC_Pit_Slab_Classes ; i++) {
+			sprintf (key, "CefPitEntry%zu", pit_slab_key_size[i]);
+			pit_entry_mp[i] = cef_mpool_init (key,
+				sizeof (CefT_Pit_Entry) + pit_slab_key_size[i], CefC_Pit_Slab_Increment);
+		}
+		pit_dnface_mp = cef_mpool_init ("CefPitDnFace",
+				sizeof (CefT_Down_Faces), CefC_Pit_Face_Increment);
+		pit_upface_mp = cef_mpool_init ("CefPitUpFace",
+				sizeof (CefT_Up_Faces), CefC_Pit_Face_Increment);
+	}
 	return;
 }
 /*--------------------------------------------------------------------------------------
@@ -243,11 +360,22 @@ cef_dbg_write (CefC_Dbg_Finer, "[pit] chunk=%u, alg.valid_type=%d, alg.keyid_len
 	}
 
 	/* PIT search key extended by ObjectHash */
+	if ( key_type_f & CefC_PitKey_With_COBHASH ){
+		CefT_Pit_Wheel* wheel = cef_pit_wheel_get (pit);
+
+		/* No entry can match, so the SHA-256 of the Object is not calculated */
+		if ( wheel && wheel->objhash_num == 0 ){
+			*ret_key_len = 0;
+			return (NULL);
+		}
+		cef_frame_opheader_msghash_get (poh);
+	}
 	if ( (key_type_f & CefC_PitKey_With_COBHASH) && (0 < poh->MsgHash_len)
 			&& ((key_len + poh->MsgHash_len) < CefC_NAME_BUFSIZ) ){
 
 		key_len += cef_pit_set_typelen(&key_buff[key_len], CefC_T_PIT_COBHASH, poh->MsgHash_len);
 		memcpy(&key_buff[key_len], &(poh->MsgHash), poh->MsgHash_len);
+		key_len += poh->MsgHash_len;
 #ifdef CefC_Debug
 cef_dbg_write (CefC_Dbg_Finer, "[pit] MsgHash_len=%d, type=%u,length=%u, MsgHash=0x%02x%02x%02x%02x\n",
 	poh->MsgHash_len, poh->MsgHash.hash_type, poh->MsgHash.hash_length,
@@ -328,24 +456,18 @@ cef_pit_entry_lookup_with_lock (
 
 	/* allocate a new PIT entry, if it dose not match 	*/
 	if (entry == NULL) {
-		size_t	alloc_size = (((sizeof (CefT_Pit_Entry) + key_len + 15) / 16) * 16);
-
 		if(cef_lhash_tbl_item_num_get(pit) == cef_lhash_tbl_def_max_get(pit)) {
 			cef_log_write (CefC_Log_Error,
 				"PIT table is full(PIT_SIZE = %d)\n", cef_lhash_tbl_def_max_get(pit));
 			return (NULL);
 		}
 
-		entry = (CefT_Pit_Entry*) malloc (alloc_size);
+		entry = cef_pit_entry_alloc (key_len);
 		if ( entry == NULL ){
-			cef_log_write (CefC_Log_Error, "%s(%u) malloc(%zu) failed, %s\n", __func__, __LINE__,
-				alloc_size, strerror(errno));
+			cef_log_write (CefC_Log_Error, "%s(%u) cef_pit_entry_alloc(%d) failed\n",
+				__func__, __LINE__, key_len);
 			return (NULL);
 		}
-		memset (entry, 0, alloc_size);
-		entry->key = (unsigned char*)entry + sizeof (CefT_Pit_Entry);
-
-		pthread_mutex_init (&entry->pe_mutex_pt, NULL);
 
 		f_new_entry = 1;
 	}
@@ -354,7 +476,7 @@ cef_pit_entry_lookup_with_lock (
 	if (with_lock && !cef_pit_entry_lock (entry)) {
 		cef_log_write (CefC_Log_Error, "%s(%u) cef_pit_entry_lock failed.\n", __func__, __LINE__);
 		if (f_new_entry) {
-			free(entry);
+			cef_pit_entry_release (entry);
 		}
 		return (NULL);
 	}
@@ -380,6 +502,18 @@ cef_pit_entry_lookup_with_lock (
 		entry->hoplimit = 0;
 		entry->PitType  = pm->InterestType;
 		entry->Last_chunk_num = 0;
+
+		/* The entry which gets no Down Face is released at the first check 	*/
+		entry->tw_wheel = cef_pit_wheel_get (pit);
+
+		/* Counts the entries which Objects have to be matched with ObjHash 	*/
+		entry->objhash_f = ((key_type_f & CefC_PitKey_With_COBHASH)
+							&& (pm->top_level_type != CefC_T_OBJECT)
+							&& (0 < pm->ObjHashRestr_len)) ? 1 : 0;
+		if (entry->objhash_f && entry->tw_wheel) {
+			entry->tw_wheel->objhash_num++;
+		}
+		cef_pit_entry_expiry_set (entry, entry->clean_us);
 	}
 #ifdef CefC_Debug
 	{
@@ -721,6 +855,7 @@ cef_dbg_write (CefC_Dbg_Finer, "\t entry->longlife_f=%d\n", entry->longlife_f );
 	prev_adv_lifetime_us = entry->adv_lifetime_us;
 	prev_lifetime_us  = face->lifetime_us;
 	face->lifetime_us = nowt_us + extent_us;
+	cef_pit_entry_expiry_set (entry, face->lifetime_us);
 
 #ifdef	__PIT_DEBUG__
 cef_dbg_write (CefC_Dbg_Finer, "\t extent_us= "FMTU64"\n", extent_us / 1000 );
@@ -942,6 +1077,11 @@ cef_pit_entry_free (
 cef_dbg_write (CefC_Dbg_Finer, "IN entry=%p , dnfacenum=%d\n", entry, entry->dnfacenum );
 #endif
 
+	cef_pit_wheel_unlink (entry);
+	if (entry->objhash_f && entry->tw_wheel) {
+		entry->tw_wheel->objhash_num--;
+	}
+
 	rm_entry = (CefT_Pit_Entry*) cef_lhash_tbl_item_remove (pit, entry->key, entry->klen);
 	if ( rm_entry != entry ){
 		cef_log_write (CefC_Log_Error, "%s(%u) cef_lhash_tbl_item_remove() failed, entry=%p, rm_entry=%p.\n",
@@ -952,7 +1092,7 @@ cef_dbg_write (CefC_Dbg_Finer, "IN entry=%p , dnfacenum=%d\n", entry, entry->dnf
 {	CefT_Up_Faces* upface = entry->upfaces.next;
 	while (upface) {
 		CefT_Up_Faces* upface_next = upface->next;
-		free (upface);
+		cef_pit_upface_release (entry, upface);
 		upface = upface_next;
 	}
 }
@@ -967,7 +1107,7 @@ cef_dbg_write (CefC_Dbg_Finer, "\t dnface->IR_len:%d Type:%d\n", dnface->IR_len,
 #endif
 			free( dnface->IR_msg );
 		}
-		free (dnface);
+		cef_pit_dnface_release (entry, dnface);
 		dnface = dnface_next;
 	}
 
@@ -981,18 +1121,16 @@ cef_dbg_write (CefC_Dbg_Finer, "\t clean dnface->IR_len:%d Type:%d\n", dnface->I
 #endif
 			free( dnface->IR_msg );
 		}
-		free (dnface);
+		cef_pit_dnface_release (entry, dnface);
 		dnface = dnface_next;
 	}
 }
 
-	pthread_mutex_destroy (&entry->pe_mutex_pt);
-
 #ifdef	__PIT_DEBUG__
 cef_dbg_write (CefC_Dbg_Finer, "OUT free(%p)\n", entry);
 #endif
 
-	free (entry);
+	cef_pit_entry_release (entry);
 
 	return;
 }
@@ -1027,9 +1165,9 @@ cef_pit_entry_down_face_lookup (
 		}
 	}
 
-	dnface->next = (CefT_Down_Faces*) malloc (sizeof (CefT_Down_Faces));
+	dnface->next = cef_pit_dnface_alloc (entry);
 	if (dnface->next == NULL) {
-		cef_log_write (CefC_Log_Error, "%s(%u) malloc(%zu) failed\n", __func__, __LINE__, sizeof (CefT_Down_Faces));
+		cef_log_write (CefC_Log_Error, "%s(%u) cef_pit_dnface_alloc failed\n", __func__, __LINE__);
 		return (0);
 	}
 	memset (dnface->next, 0, sizeof (CefT_Down_Faces));
@@ -1122,7 +1260,12 @@ cef_pit_entry_up_face_lookup (
 			return (0);
 		}
 	}
-	face->next = (CefT_Up_Faces*) malloc (sizeof (CefT_Up_Faces));
+	face->next = cef_pit_upface_alloc (entry);
+	if (face->next == NULL) {
+		cef_log_write (CefC_Log_Error, "%s(%u) cef_pit_upface_alloc failed\n", __func__, __LINE__);
+		*rt_face = NULL;
+		return (0);
+	}
 	face->next->faceid = faceid;
 	face->next->next = NULL;
 
@@ -1636,25 +1779,22 @@ cef_pit_entry_lock (
 	CefT_Pit_Entry* entry 					/* PIT entry 								*/
 ) {
 	int	ret = CefC_PitEntry_Lock;
-	int i, res;
+	int i;
+	unsigned int res;
 	const struct timespec ts_req = { 0, 1000000 };	/* 1 mili sec. */
 
 	for ( i = res = 0;
 				i < CefC_PitEntry_Lock_Retry &&
-				(res = pthread_mutex_trylock (&entry->pe_mutex_pt)) != 0;
+				(res = atomic_exchange_explicit (
+							&entry->pe_lock, 1, memory_order_acquire)) != 0;
 						i++ ) {
 #ifdef CefC_Debug
-		cef_dbg_write (CefC_Dbg_Finer, "pthread_mutex_trylock=%d:%s\n", res, strerror(errno));
+		cef_dbg_write (CefC_Dbg_Finer, "entry=%p is locked, retry=%d\n", entry, i);
 #endif // CefC_Debug
-
-		if (EBUSY != res) {
-			cef_log_write (CefC_Log_Error, "%s(%u) mutex_trylock=%d\n", __func__, __LINE__, res);
-			break;
-		}
 		nanosleep(&ts_req, NULL);
 	}
 	if ( res != 0 ){
-		cef_log_write (CefC_Log_Error, "%s(%u) mutex_trylock, %d retries exceeded.\n", __func__, __LINE__, CefC_PitEntry_Lock_Retry);
+		cef_log_write (CefC_Log_Error, "%s(%u) entry lock, %d retries exceeded.\n", __func__, __LINE__, CefC_PitEntry_Lock_Retry);
 		ret = CefC_PitEntry_NoLock;		// lock failed
 	}
 
@@ -1665,14 +1805,493 @@ cef_pit_entry_unlock (
 	CefT_Pit_Entry* entry 					/* PIT entry 								*/
 ) {
 #ifdef CefC_Debug
-	int	res = pthread_mutex_unlock (&entry->pe_mutex_pt);
-	if ( res ){
-		cef_dbg_write (CefC_Dbg_Fine, "pthread_mutex_unlock=%d:%s\n", res, strerror(errno));
+	if (atomic_load_explicit (&entry->pe_lock, memory_order_relaxed) == 0) {
+		cef_dbg_write (CefC_Dbg_Fine, "entry=%p is not locked\n", entry);
 	}
-#else // CefC_Debug
-	pthread_mutex_unlock (&entry->pe_mutex_pt);
 #endif // CefC_Debug
+	atomic_store_explicit (&entry->pe_lock, 0, memory_order_release);
+
+	return;
+}
 
+/*--------------------------------------------------------------------------------------
+	Creates the expiry wheel of the specified PIT
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+cef_pit_expiry_init (
+	CefT_Hash_Handle pit,					/* PIT										*/
+	uint64_t nowt							/* current time (usec)						*/
+) {
+	CefT_Pit_Wheel* wheel;
+	int i;
+
+	if (cef_pit_wheel_get (pit)) {
+		return (0);
+	}
+	for (i = 0 ; i < CefC_Pit_Wheel_Max ; i++) {
+		if (pit_wheels[i] == NULL) {
+			break;
+		}
+	}
+	if (i == CefC_Pit_Wheel_Max) {
+		cef_log_write (CefC_Log_Error, "%s the number of PITs exceeds %d\n"
+						, __func__, CefC_Pit_Wheel_Max);
+		return (-1);
+	}
+	wheel = (CefT_Pit_Wheel*) calloc (1, sizeof (CefT_Pit_Wheel));
+	if (wheel == NULL) {
+		cef_log_write (CefC_Log_Error, "%s(%u) calloc failed, %s\n"
+						, __func__, __LINE__, strerror(errno));
+		return (-1);
+	}
+	wheel->pit 			= pit;
+	wheel->cur_tick 	= nowt / CefC_Pit_Wheel_Tick;
+	wheel->stat.tick_us = CefC_Pit_Wheel_Tick;
+	pit_wheels[i] = wheel;
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Destroys the expiry wheel of the specified PIT
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_expiry_destroy (
+	CefT_Hash_Handle pit					/* PIT										*/
+) {
+	CefT_Pit_Wheel* wheel;
+	CefT_Pit_Entry* entry;
+	int level, idx, i;
+
+	for (i = 0 ; i < CefC_Pit_Wheel_Max ; i++) {
+		if (pit_wheels[i] && pit_wheels[i]->pit == pit) {
+			break;
+		}
+	}
+	if (i == CefC_Pit_Wheel_Max) {
+		return;
+	}
+	wheel = pit_wheels[i];
+	pit_wheels[i] = NULL;
+
+	/* The entries remain in the PIT without the wheel 		*/
+	for (level = 0 ; level < CefC_Pit_Wheel_Levels ; level++) {
+		for (idx = 0 ; idx < CefC_Pit_Wheel_Slots ; idx++) {
+			while ((entry = wheel->slots[level][idx]) != NULL) {
+				cef_pit_wheel_unlink (entry);
+				entry->tw_wheel = NULL;
+			}
+		}
+	}
+	while ((entry = wheel->expired) != NULL) {
+		cef_pit_wheel_unlink (entry);
+		entry->tw_wheel = NULL;
+	}
+	free (wheel);
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Advances the expiry wheel and collects the entries which need to be checked
+----------------------------------------------------------------------------------------*/
+int											/* Number of the collected entries			*/
+cef_pit_expiry_advance (
+	CefT_Hash_Handle pit,					/* PIT										*/
+	uint64_t nowt							/* current time (usec)						*/
+) {
+	CefT_Pit_Wheel* wheel;
+	CefT_Pit_Entry* entry;
+	CefT_Pit_Entry* next;
+	uint64_t target;
+	uint32_t tick_num;
+	uint32_t collected = 0;
+	int level, idx;
+
+	wheel = cef_pit_wheel_get (pit);
+	if (wheel == NULL) {
+		return (0);
+	}
+	target = nowt / CefC_Pit_Wheel_Tick;
+
+	while (wheel->cur_tick <= target) {
+		if (wheel->stat.scheduled == 0) {
+			/* Skips the idle ticks 		*/
+			wheel->stat.ticks += target - wheel->cur_tick + 1;
+			wheel->cur_tick = target + 1;
+			break;
+		}
+
+		/* Moves the entries of the upper level down when the lower level wraps 	*/
+		for (level = 1 ; level < CefC_Pit_Wheel_Levels ; level++) {
+			if (wheel->cur_tick & ((1ULL << (CefC_Pit_Wheel_Bits * level)) - 1)) {
+				break;
+			}
+			idx = (int)((wheel->cur_tick >> (CefC_Pit_Wheel_Bits * level))
+							& (CefC_Pit_Wheel_Slots - 1));
+			entry = wheel->slots[level][idx];
+			wheel->slots[level][idx] = NULL;
+
+			while (entry) {
+				next = entry->tw_next;
+				cef_pit_wheel_link (wheel, entry, entry->tw_tick);
+				entry = next;
+			}
+		}
+
+		/* Collects the entries of this tick 		*/
+		idx = (int)(wheel->cur_tick & (CefC_Pit_Wheel_Slots - 1));
+		entry = wheel->slots[0][idx];
+		wheel->slots[0][idx] = NULL;
+		tick_num = 0;
+
+		while (entry) {
+			next = entry->tw_next;
+			entry->tw_tick = CefC_Pit_Wheel_Collected;
+			entry->tw_next = wheel->expired;
+			if (wheel->expired) {
+				wheel->expired->tw_pprev = &entry->tw_next;
+			}
+			entry->tw_pprev = &wheel->expired;
+			wheel->expired = entry;
+			tick_num++;
+			entry = next;
+		}
+		wheel->stat.scheduled -= tick_num;
+		if (tick_num > wheel->stat.max_tick_expired) {
+			wheel->stat.max_tick_expired = tick_num;
+		}
+		collected += tick_num;
+		wheel->stat.ticks++;
+		wheel->cur_tick++;
+	}
+	wheel->stat.expired += collected;
+	wheel->stat.last_expired = collected;
+
+	return ((int) collected);
+}
+/*--------------------------------------------------------------------------------------
+	Takes out one of the entries collected by cef_pit_expiry_advance
+----------------------------------------------------------------------------------------*/
+CefT_Pit_Entry* 							/* PIT entry, or NULL if no entry remains	*/
+cef_pit_expiry_pop (
+	CefT_Hash_Handle pit					/* PIT										*/
+) {
+	CefT_Pit_Wheel* wheel;
+	CefT_Pit_Entry* entry;
+
+	wheel = cef_pit_wheel_get (pit);
+	if ((wheel == NULL) || (wheel->expired == NULL)) {
+		return (NULL);
+	}
+	entry = wheel->expired;
+	cef_pit_wheel_unlink (entry);
+
+	return (entry);
+}
+/*--------------------------------------------------------------------------------------
+	Schedules the check of the specified PIT entry at the next time it needs
+----------------------------------------------------------------------------------------*/
+void
+cef_pit_entry_expiry_refresh (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+) {
+	CefT_Down_Faces* face;
+	uint64_t due_us;
+
+	if (entry->tw_wheel == NULL) {
+		return;
+	}
+
+	/* Down Faces are checked when the earliest of them expires, and the entry 	*/
+	/* without Down Face is checked when it should be released 					*/
+	if (entry->dnfaces.next) {
+		due_us = entry->adv_lifetime_us;
+		for (face = entry->dnfaces.next ; face ; face = face->next) {
+			if (face->lifetime_us < due_us) {
+				due_us = face->lifetime_us;
+			}
+		}
+	} else {
+		due_us = entry->drp_lifetime_us;
+	}
+	cef_pit_wheel_unlink (entry);
+	cef_pit_entry_expiry_set (entry, due_us);
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the statistics of the expiry wheel of the specified PIT
+----------------------------------------------------------------------------------------*/
+int											/* Returns a negative value if it fails 	*/
+cef_pit_expiry_stat_get (
+	CefT_Hash_Handle pit,					/* PIT										*/
+	CefT_Pit_Expiry_Stat* stat				/* statistics to return						*/
+) {
+	CefT_Pit_Wheel* wheel;
+
+	wheel = cef_pit_wheel_get (pit);
+	if (wheel == NULL) {
+		return (-1);
+	}
+	memcpy (stat, &wheel->stat, sizeof (CefT_Pit_Expiry_Stat));
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the memory pools which hold the PIT entries and their faces
+----------------------------------------------------------------------------------------*/
+int											/* Number of the returned pools				*/
+cef_pit_mpool_handles_get (
+	CefT_Mp_Handle* mps,					/* memory pools to return					*/
+	int max									/* capacity of mps							*/
+) {
+	int num = 0;
+	int i;
+
+	for (i = 0 ; i < CefC_Pit_Slab_Classes && num < max ; i++) {
+		if (pit_entry_mp[i] != 0) {
+			mps[num++] = pit_entry_mp[i];
+		}
+	}
+	if ((pit_dnface_mp != 0) && (num < max)) {
+		mps[num++] = pit_dnface_mp;
+	}
+	if ((pit_upface_mp != 0) && (num < max)) {
+		mps[num++] = pit_upface_mp;
+	}
+	return (num);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the expiry wheel of the specified PIT
+----------------------------------------------------------------------------------------*/
+static CefT_Pit_Wheel*						/* expiry wheel, or NULL if it has no wheel */
+cef_pit_wheel_get (
+	CefT_Hash_Handle pit					/* PIT										*/
+) {
+	int i;
+
+	for (i = 0 ; i < CefC_Pit_Wheel_Max ; i++) {
+		if (pit_wheels[i] && pit_wheels[i]->pit == pit) {
+			return (pit_wheels[i]);
+		}
+	}
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Links the specified PIT entry to the slot of the specified tick
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_wheel_link (
+	CefT_Pit_Wheel* wheel,					/* expiry wheel								*/
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	uint64_t tick							/* tick when the entry is checked			*/
+) {
+	CefT_Pit_Entry** slot;
+	uint64_t diff;
+	int level;
+
+	if (tick < wheel->cur_tick) {
+		tick = wheel->cur_tick;
+	}
+	diff = tick - wheel->cur_tick;
+
+	/* Level N holds the entries which are checked within 2^(Bits*(N+1)) ticks 	*/
+	for (level = 0 ; level < CefC_Pit_Wheel_Levels - 1 ; level++) {
+		if (diff < (1ULL << (CefC_Pit_Wheel_Bits * (level + 1)))) {
+			break;
+		}
+	}
+	if (diff >= (1ULL << (CefC_Pit_Wheel_Bits * CefC_Pit_Wheel_Levels))) {
+		/* Beyond the range of the wheel, the entry is checked and rescheduled 	*/
+		tick = wheel->cur_tick + (1ULL << (CefC_Pit_Wheel_Bits * CefC_Pit_Wheel_Levels)) - 1;
+	}
+	slot = &wheel->slots[level][(tick >> (CefC_Pit_Wheel_Bits * level))
+									& (CefC_Pit_Wheel_Slots - 1)];
+
+	entry->tw_tick = tick;
+	entry->tw_next = *slot;
+	if (*slot) {
+		(*slot)->tw_pprev = &entry->tw_next;
+	}
+	entry->tw_pprev = slot;
+	*slot = entry;
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Unlinks the specified PIT entry from the expiry wheel
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_wheel_unlink (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+) {
+	if (entry->tw_pprev == NULL) {
+		return;
+	}
+	if (entry->tw_tick != CefC_Pit_Wheel_Collected) {
+		entry->tw_wheel->stat.scheduled--;
+	}
+	*(entry->tw_pprev) = entry->tw_next;
+	if (entry->tw_next) {
+		entry->tw_next->tw_pprev = entry->tw_pprev;
+	}
+	entry->tw_next  = NULL;
+	entry->tw_pprev = NULL;
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Schedules the check of the specified PIT entry if it is earlier than the current one
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_entry_expiry_set (
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	uint64_t due_us							/* time when the entry is checked (usec)	*/
+) {
+	uint64_t tick;
+
+	if (entry->tw_wheel == NULL) {
+		return;
+	}
+	tick = (due_us + CefC_Pit_Wheel_Tick - 1) / CefC_Pit_Wheel_Tick;
+
+	/* Only an earlier check moves the entry. The entry checked too early is 	*/
+	/* rescheduled by cef_pit_entry_expiry_refresh, so refreshing Down Faces 	*/
+	/* does not touch the wheel 												*/
+	if (entry->tw_pprev) {
+		if ((entry->tw_tick == CefC_Pit_Wheel_Collected) || (entry->tw_tick <= tick)) {
+			return;
+		}
+		cef_pit_wheel_unlink (entry);
+	}
+	cef_pit_wheel_link (entry->tw_wheel, entry, tick);
+	entry->tw_wheel->stat.scheduled++;
+
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Allocates a PIT entry which holds the key of the specified length
+----------------------------------------------------------------------------------------*/
+static CefT_Pit_Entry*						/* PIT entry, or NULL if it fails			*/
+cef_pit_entry_alloc (
+	int key_len								/* Length of the key						*/
+) {
+	CefT_Pit_Entry* entry;
+	size_t alloc_size;
+	int i;
+
+	for (i = 0 ; i < CefC_Pit_Slab_Classes ; i++) {
+		if ((size_t) key_len <= pit_slab_key_size[i]) {
+			break;
+		}
+	}
+	if ((i < CefC_Pit_Slab_Classes) && (pit_entry_mp[i] != 0)) {
+		entry = (CefT_Pit_Entry*) cef_mpool_alloc (pit_entry_mp[i]);
+	} else {
+		alloc_size = (((sizeof (CefT_Pit_Entry) + key_len + 15) / 16) * 16);
+		entry = (CefT_Pit_Entry*) malloc (alloc_size);
+		i = CefC_Pit_Slab_Malloc;
+	}
+	if (entry == NULL) {
+		return (NULL);
+	}
+
+	/* The key is copied by the caller, so only the header is cleared 	*/
+	memset (entry, 0, sizeof (CefT_Pit_Entry));
+	entry->key = (unsigned char*)entry + sizeof (CefT_Pit_Entry);
+	entry->slab_class = (uint8_t) i;
+	atomic_init (&entry->pe_lock, 0);
+
+	return (entry);
+}
+/*--------------------------------------------------------------------------------------
+	Releases the memory of the specified PIT entry
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_entry_release (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+) {
+	if (entry->slab_class < CefC_Pit_Slab_Classes) {
+		cef_mpool_free (pit_entry_mp[entry->slab_class], entry);
+	} else {
+		free (entry);
+	}
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Allocates a Down Face entry of the specified PIT entry
+----------------------------------------------------------------------------------------*/
+static CefT_Down_Faces*						/* Down Face entry, or NULL if it fails		*/
+cef_pit_dnface_alloc (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+) {
+	int i;
+
+	/* Most entries have a few Down Faces, which are kept in the entry itself 	*/
+	for (i = 0 ; i < CefC_Pit_Inline_DnFaces ; i++) {
+		if (!(entry->dnface_inl_used & (1 << i))) {
+			entry->dnface_inl_used |= (1 << i);
+			return (&entry->dnface_inl[i]);
+		}
+	}
+	if (pit_dnface_mp != 0) {
+		return ((CefT_Down_Faces*) cef_mpool_alloc (pit_dnface_mp));
+	}
+	return ((CefT_Down_Faces*) malloc (sizeof (CefT_Down_Faces)));
+}
+/*--------------------------------------------------------------------------------------
+	Releases the specified Down Face entry
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_dnface_release (
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	CefT_Down_Faces* dnface					/* Down Face entry							*/
+) {
+	if ((dnface >= &entry->dnface_inl[0]) &&
+		(dnface < &entry->dnface_inl[CefC_Pit_Inline_DnFaces])) {
+		entry->dnface_inl_used &= ~(1 << (dnface - &entry->dnface_inl[0]));
+	} else if (pit_dnface_mp != 0) {
+		cef_mpool_free (pit_dnface_mp, dnface);
+	} else {
+		free (dnface);
+	}
+	return;
+}
+/*--------------------------------------------------------------------------------------
+	Allocates an Up Face entry of the specified PIT entry
+----------------------------------------------------------------------------------------*/
+static CefT_Up_Faces*						/* Up Face entry, or NULL if it fails		*/
+cef_pit_upface_alloc (
+	CefT_Pit_Entry* entry 					/* PIT entry 								*/
+) {
+	int i;
+
+	for (i = 0 ; i < CefC_Pit_Inline_UpFaces ; i++) {
+		if (!(entry->upface_inl_used & (1 << i))) {
+			entry->upface_inl_used |= (1 << i);
+			return (&entry->upface_inl[i]);
+		}
+	}
+	if (pit_upface_mp != 0) {
+		return ((CefT_Up_Faces*) cef_mpool_alloc (pit_upface_mp));
+	}
+	return ((CefT_Up_Faces*) malloc (sizeof (CefT_Up_Faces)));
+}
+/*--------------------------------------------------------------------------------------
+	Releases the specified Up Face entry
+----------------------------------------------------------------------------------------*/
+static void
+cef_pit_upface_release (
+	CefT_Pit_Entry* entry, 					/* PIT entry 								*/
+	CefT_Up_Faces* upface					/* Up Face entry							*/
+) {
+	if ((upface >= &entry->upface_inl[0]) &&
+		(upface < &entry->upface_inl[CefC_Pit_Inline_UpFaces])) {
+		entry->upface_inl_used &= ~(1 << (upface - &entry->upface_inl[0]));
+	} else if (pit_upface_mp != 0) {
+		cef_mpool_free (pit_upface_mp, upface);
+	} else {
+		free (upface);
+	}
 	return;
 }
 
@@ -36,14 +36,20 @@
  Include Files
  ****************************************************************************************/
 
+#include <sched.h>
+
 #include <cefore/cef_rngque.h>
 
 /****************************************************************************************
  Macros
  ****************************************************************************************/
 
-#define cef_mpool_mutex_lock		pthread_mutex_lock
-#define cef_mpool_mutex_unlock		pthread_mutex_unlock
+/*
+	The producers and the consumers reserve slots by advancing their head and
+	publish them by advancing their tail. With a single producer (consumer) the
+	head is simply stored; otherwise it is reserved by CAS and the tail is
+	advanced in the order of the reservations.
+*/
 
 /****************************************************************************************
  Structures Declaration
@@ -59,41 +65,86 @@
  Static Function Declaration
  ****************************************************************************************/
 
+/*--------------------------------------------------------------------------------------
+	Reserves the slots to push
+----------------------------------------------------------------------------------------*/
+static uint32_t								/* number of reserved slots 				*/
+cef_rngque_prod_reserve (
+	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
+	uint32_t num,							/* number of slots requested 				*/
+	uint32_t* headp							/* head of the reserved slots 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Reserves the slots to pop
+----------------------------------------------------------------------------------------*/
+static uint32_t								/* number of reserved slots 				*/
+cef_rngque_cons_reserve (
+	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
+	uint32_t num,							/* number of slots requested 				*/
+	uint32_t* headp							/* head of the reserved slots 				*/
+);
+/*--------------------------------------------------------------------------------------
+	Publishes the reserved slots
+----------------------------------------------------------------------------------------*/
+static void
+cef_rngque_pos_publish (
+	CefT_Rngque_Pos* pos,					/* producers or consumers 					*/
+	int single_f,							/* only one thread uses this side 			*/
+	uint32_t head,							/* head of the reserved slots 				*/
+	uint32_t num							/* number of reserved slots 				*/
+);
+
 /****************************************************************************************
  ****************************************************************************************/
 
 /*--------------------------------------------------------------------------------------
-	Creates Ring Queue
+	Creates Ring Queue which any thread can push to and pop from
 ----------------------------------------------------------------------------------------*/
 CefT_Rngque* 								/* Created Ring Queue Information 			*/
 cef_rngque_create (
 	int capacity							/* Capacity of Ring queue 					*/
 ) {
-	int p;
+	return (cef_rngque_create_ext (capacity, CefC_Rngque_MultiThread));
+}
+
+/*--------------------------------------------------------------------------------------
+	Creates Ring Queue specialized for the number of producers and consumers
+----------------------------------------------------------------------------------------*/
+CefT_Rngque* 								/* Created Ring Queue Information 			*/
+cef_rngque_create_ext (
+	int capacity,							/* Capacity of Ring queue 					*/
+	int flags								/* CefC_Rngque_XXX 							*/
+) {
+	uint32_t size;
 	CefT_Rngque* qp;
 
 	/* Obtains the capacity of index queue 		*/
 	if (capacity < 32) {
 		capacity = 32;
 	}
-	if (capacity > 65536) {
-		capacity = 65536;
+	if (capacity > CefC_Rngque_Max) {
+		capacity = CefC_Rngque_Max;
 	}
-	capacity--;
-
-	for (p = 0 ; capacity != 0 ; capacity >>= 1) {
-		p = (p << 1) + 1;
+	for (size = 1 ; size < (uint32_t) capacity ; size <<= 1) {
+		/* NOP */;
 	}
-	capacity = p + 1;
 
 	/* Allocates the index queue 			*/
-	qp = (CefT_Rngque*) malloc (sizeof (CefT_Rngque));
-	qp->top = 0;
-	qp->bottom = 0;
-	qp->mask = capacity - 1;
-	qp->que = (CefT_Rngque_Elem*) malloc (sizeof (CefT_Rngque_Elem) * capacity);
-	
-	pthread_mutex_init (&qp->mutex, NULL);
+	if (posix_memalign ((void**) &qp, CefC_Rngque_CacheLine, sizeof (CefT_Rngque)) != 0) {
+		return (NULL);
+	}
+	qp->que = (CefT_Rngque_Elem*) malloc (sizeof (CefT_Rngque_Elem) * size);
+	if (qp->que == NULL) {
+		free (qp);
+		return (NULL);
+	}
+	atomic_init (&qp->prod.head, 0);
+	atomic_init (&qp->prod.tail, 0);
+	atomic_init (&qp->cons.head, 0);
+	atomic_init (&qp->cons.tail, 0);
+	qp->mask = size - 1;
+	qp->capacity = size;
+	qp->flags = flags;
 
 	return (qp);
 }
@@ -105,11 +156,94 @@ void
 cef_rngque_destroy (
 	CefT_Rngque* qp							/* Ring Queue Information 					*/
 ) {
-	pthread_mutex_destroy (&qp->mutex);
 	free (qp->que);
 	free (qp);
 }
 
+/*--------------------------------------------------------------------------------------
+	Reserves the slots to push
+----------------------------------------------------------------------------------------*/
+static uint32_t								/* number of reserved slots 				*/
+cef_rngque_prod_reserve (
+	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
+	uint32_t num,							/* number of slots requested 				*/
+	uint32_t* headp							/* head of the reserved slots 				*/
+) {
+	uint32_t head;
+	uint32_t free_num;
+
+	head = atomic_load_explicit (&qp->prod.head, memory_order_relaxed);
+	do {
+		free_num = qp->capacity
+			+ atomic_load_explicit (&qp->cons.tail, memory_order_acquire) - head;
+		if (num > free_num) {
+			num = free_num;
+		}
+		if (num == 0) {
+			return (0);
+		}
+		if (qp->flags & CefC_Rngque_SingleProd) {
+			atomic_store_explicit (&qp->prod.head, head + num, memory_order_relaxed);
+			break;
+		}
+	} while (!atomic_compare_exchange_weak_explicit (&qp->prod.head, &head, head + num,
+				memory_order_relaxed, memory_order_relaxed));
+
+	*headp = head;
+	return (num);
+}
+
+/*--------------------------------------------------------------------------------------
+	Reserves the slots to pop
+----------------------------------------------------------------------------------------*/
+static uint32_t								/* number of reserved slots 				*/
+cef_rngque_cons_reserve (
+	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
+	uint32_t num,							/* number of slots requested 				*/
+	uint32_t* headp							/* head of the reserved slots 				*/
+) {
+	uint32_t head;
+	uint32_t used_num;
+
+	head = atomic_load_explicit (&qp->cons.head, memory_order_relaxed);
+	do {
+		used_num = atomic_load_explicit (&qp->prod.tail, memory_order_acquire) - head;
+		if (num > used_num) {
+			num = used_num;
+		}
+		if (num == 0) {
+			return (0);
+		}
+		if (qp->flags & CefC_Rngque_SingleCons) {
+			atomic_store_explicit (&qp->cons.head, head + num, memory_order_relaxed);
+			break;
+		}
+	} while (!atomic_compare_exchange_weak_explicit (&qp->cons.head, &head, head + num,
+				memory_order_relaxed, memory_order_relaxed));
+
+	*headp = head;
+	return (num);
+}
+
+/*--------------------------------------------------------------------------------------
+	Publishes the reserved slots
+----------------------------------------------------------------------------------------*/
+static void
+cef_rngque_pos_publish (
+	CefT_Rngque_Pos* pos,					/* producers or consumers 					*/
+	int single_f,							/* only one thread uses this side 			*/
+	uint32_t head,							/* head of the reserved slots 				*/
+	uint32_t num							/* number of reserved slots 				*/
+) {
+	if (!single_f) {
+		/* Waits for the threads which reserved the preceding slots 	*/
+		while (atomic_load_explicit (&pos->tail, memory_order_relaxed) != head) {
+			sched_yield ();
+		}
+	}
+	atomic_store_explicit (&pos->tail, head + num, memory_order_release);
+}
+
 /*--------------------------------------------------------------------------------------
 	Removes the value (int) from the top of Ring Queue
 ----------------------------------------------------------------------------------------*/
@@ -117,17 +251,11 @@ void*										/* item which is removed from queue 		*/
 cef_rngque_pop (
 	CefT_Rngque* qp							/* Ring Queue Information 					*/
 ) {
-	int value;
-
-	if (qp->bottom != qp->top) {
-		cef_mpool_mutex_lock (&qp->mutex);
-		value = qp->top;
-		qp->top = (qp->top + 1) & qp->mask;
-		cef_mpool_mutex_unlock (&qp->mutex);
-		return (qp->que[value].body);
-	}
+	void* item = NULL;
 
-	return (NULL);
+	cef_rngque_pop_bulk (qp, &item, 1);
+
+	return (item);
 }
 
 /*--------------------------------------------------------------------------------------
@@ -138,16 +266,59 @@ cef_rngque_push (
 	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
 	void* item
 ) {
+	return (cef_rngque_push_bulk (qp, &item, 1));
+}
+
+/*--------------------------------------------------------------------------------------
+	Inserts the items to the bottom of Ring Queue as many as possible
+----------------------------------------------------------------------------------------*/
+int											/* number of inserted items 				*/
+cef_rngque_push_bulk (
+	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
+	void* items[],
+	int num									/* number of items 							*/
+) {
+	uint32_t head;
+	uint32_t n, i;
+
+	if (num <= 0) {
+		return (0);
+	}
+	n = cef_rngque_prod_reserve (qp, (uint32_t) num, &head);
+	for (i = 0 ; i < n ; i++) {
+		qp->que[(head + i) & qp->mask].body = items[i];
+	}
+	if (n > 0) {
+		cef_rngque_pos_publish (&qp->prod, qp->flags & CefC_Rngque_SingleProd, head, n);
+	}
+
+	return ((int) n);
+}
+
+/*--------------------------------------------------------------------------------------
+	Removes up to the specified number of items from the top of Ring Queue
+----------------------------------------------------------------------------------------*/
+int											/* number of removed items 					*/
+cef_rngque_pop_bulk (
+	CefT_Rngque* qp, 						/* Ring Queue Information 					*/
+	void* items[],
+	int num									/* maximum number of items 					*/
+) {
+	uint32_t head;
+	uint32_t n, i;
 
-	if (((qp->bottom + 1) & qp->mask) != qp->top) {
-		cef_mpool_mutex_lock (&qp->mutex);
-		qp->que[qp->bottom].body = item;
-		qp->bottom = (qp->bottom + 1) & qp->mask;
-		cef_mpool_mutex_unlock (&qp->mutex);
-		return (1);
+	if (num <= 0) {
+		return (0);
+	}
+	n = cef_rngque_cons_reserve (qp, (uint32_t) num, &head);
+	for (i = 0 ; i < n ; i++) {
+		items[i] = qp->que[(head + i) & qp->mask].body;
+	}
+	if (n > 0) {
+		cef_rngque_pos_publish (&qp->cons, qp->flags & CefC_Rngque_SingleCons, head, n);
 	}
 
-	return (0);
+	return ((int) n);
 }
 
 /*--------------------------------------------------------------------------------------
@@ -157,13 +328,11 @@ void*										/* item which is removed from queue 		*/
 cef_rngque_read (
 	CefT_Rngque* qp							/* Ring Queue Information 					*/
 ) {
-	int value;
+	uint32_t head;
 
-	if (qp->bottom != qp->top) {
-		cef_mpool_mutex_lock (&qp->mutex);
-		value = qp->top;
-		cef_mpool_mutex_unlock (&qp->mutex);
-		return (qp->que[value].body);
+	head = atomic_load_explicit (&qp->cons.head, memory_order_relaxed);
+	if (atomic_load_explicit (&qp->prod.tail, memory_order_acquire) != head) {
+		return (qp->que[head & qp->mask].body);
 	}
 
 	return (NULL);
@@ -0,0 +1,784 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cef_shmring.c
+ */
+
+#define __CEF_SHMRING_SOURECE__
+
+#define _GNU_SOURCE
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cefore/cef_define.h>
+#include <cefore/cef_shmring.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/eventfd.h>) && __has_include(<linux/memfd.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/memfd.h>
+#ifdef __NR_memfd_create
+#define CefC_Shmring_Enable
+#endif // __NR_memfd_create
+#endif // __has_include(<sys/eventfd.h>) && __has_include(<linux/memfd.h>)
+#endif // __linux__ && __has_include
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+#define CefC_Shmring_Magic			0x43454652	/* "CEFR" 								*/
+#define CefC_Shmring_Version		1
+#define CefC_Shmring_Cacheline		64
+#define CefC_Shmring_Page			4096
+
+#define CefC_Shmring_A2N			0			/* ring from the application 			*/
+#define CefC_Shmring_N2A			1			/* ring to the application 				*/
+
+/*
+	The shared memory is laid out as follows. The descriptors and the buffers of
+	each ring start at a page boundary. A frame is never split at the end of the
+	buffers; the producer skips to the head instead, and the space is released
+	with the frame which follows it.
+
+		+------------------+ 0
+		| header and the   |
+		| indexes of rings |
+		+------------------+ CefC_Shmring_Page
+		| descriptors A2N  |
+		| descriptors N2A  |
+		+------------------+
+		| buffers A2N      |
+		| buffers N2A      |
+		+------------------+
+*/
+#define CefC_Shmring_Desc_Off(_r) 									\
+	(CefC_Shmring_Page + (_r) * CefC_Shmring_Desc_Num * sizeof (CefT_Shmring_Desc))
+#define CefC_Shmring_Data_Off(_r) 									\
+	(CefC_Shmring_Desc_Off (2) + (size_t)(_r) * CefC_Shmring_Data_Size)
+#define CefC_Shmring_Size			CefC_Shmring_Data_Off (2)
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/***** Indexes of a ring. The producer and the consumer write their own line 	*****/
+typedef struct {
+
+	/********** Written by the producer 	**********/
+	uint32_t 		desc_head;				/* descriptors put 							*/
+	uint8_t 		pad0[CefC_Shmring_Cacheline - 4];
+
+	/********** Written by the consumer 	**********/
+	uint32_t 		desc_tail;				/* descriptors taken 						*/
+	uint32_t 		data_tail;				/* end of the released buffers 				*/
+	uint32_t 		sleep_f;				/* consumer waits on the eventfd 			*/
+	uint8_t 		pad1[CefC_Shmring_Cacheline - 12];
+
+} CefT_Shmring_Idx;
+
+/***** Descriptor of a frame 	*****/
+typedef struct {
+	uint32_t 		end;					/* position which follows the frame 		*/
+	uint32_t 		len;					/* length of the frame 						*/
+} CefT_Shmring_Desc;
+
+/***** Head of the shared memory 	*****/
+typedef struct {
+	uint32_t 		magic;
+	uint32_t 		version;
+	uint32_t 		desc_num;
+	uint32_t 		data_size;
+	uint8_t 		pad[CefC_Shmring_Cacheline - 16];
+	CefT_Shmring_Idx idx[2];				/* indexes of A2N and N2A 					*/
+} CefT_Shmring_Hdr;
+
+struct CefT_Shmring {
+
+	int 				fds[CefC_Shmring_Fd_Num];
+											/* memfd, eventfd of A2N and of N2A 		*/
+	unsigned char* 		base;				/* mapped shared memory 					*/
+	pthread_mutex_t 	tx_mutex;			/* held from the reserve to the commit 		*/
+
+	/********** Send ring (this end is the producer) 	**********/
+	CefT_Shmring_Idx* 	tx_idx;
+	CefT_Shmring_Desc* 	tx_desc;
+	unsigned char* 		tx_data;
+	int 				tx_evfd;			/* eventfd the peer waits on 				*/
+	uint32_t 			tx_desc_head;
+	uint32_t 			tx_data_head;
+	uint32_t 			tx_rsv_pos;			/* position of the reserved buffer 			*/
+
+	/********** Receive ring (this end is the consumer) 	**********/
+	CefT_Shmring_Idx* 	rx_idx;
+	CefT_Shmring_Desc* 	rx_desc;
+	unsigned char* 		rx_data;
+	int 				rx_evfd;			/* eventfd this end waits on 				*/
+	uint32_t 			rx_desc_tail;
+	uint32_t 			rx_read_len;		/* bytes of the head frame already read 	*/
+};
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+#ifdef CefC_Shmring_Enable
+/*--------------------------------------------------------------------------------------
+	Maps the shared memory and sets the rings of the specified end
+----------------------------------------------------------------------------------------*/
+static int									/* negative if it fails 					*/
+cef_shmring_map (
+	CefT_Shmring* shm,
+	int side								/* CefC_Shmring_Side_XXX 					*/
+);
+/*--------------------------------------------------------------------------------------
+	Allocates the rings whose FDs are not opened yet
+----------------------------------------------------------------------------------------*/
+static CefT_Shmring*
+cef_shmring_alloc (
+	void
+);
+#endif // CefC_Shmring_Enable
+
+/****************************************************************************************
+ ****************************************************************************************/
+
+#ifdef CefC_Shmring_Enable
+/*--------------------------------------------------------------------------------------
+	Creates the shared memory with the rings of both directions and the eventfds.
+	Returns NULL if memfd or eventfd is not available (e.g. not Linux)
+----------------------------------------------------------------------------------------*/
+CefT_Shmring*								/* created rings or NULL 					*/
+cef_shmring_create (
+	void
+) {
+	CefT_Shmring* shm;
+	CefT_Shmring_Hdr* hdr;
+	int i;
+
+	shm = cef_shmring_alloc ();
+	if (shm == NULL) {
+		return (NULL);
+	}
+	shm->fds[0] = (int) syscall (__NR_memfd_create,
+						"cefore-shmring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (shm->fds[0] < 0) {
+		goto ERROR;
+	}
+	if (ftruncate (shm->fds[0], CefC_Shmring_Size) < 0) {
+		goto ERROR;
+	}
+#ifdef F_ADD_SEALS
+	/* The application can neither shrink nor grow the memory under cefnetd 	*/
+	fcntl (shm->fds[0], F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+#endif // F_ADD_SEALS
+	for (i = 1 ; i < CefC_Shmring_Fd_Num ; i++) {
+		shm->fds[i] = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (shm->fds[i] < 0) {
+			goto ERROR;
+		}
+	}
+	if (cef_shmring_map (shm, CefC_Shmring_Side_Netd) < 0) {
+		goto ERROR;
+	}
+
+	hdr = (CefT_Shmring_Hdr*) shm->base;
+	hdr->magic 		= CefC_Shmring_Magic;
+	hdr->version 	= CefC_Shmring_Version;
+	hdr->desc_num 	= CefC_Shmring_Desc_Num;
+	hdr->data_size 	= CefC_Shmring_Data_Size;
+
+	/* Both consumers wait for the first frame 	*/
+	hdr->idx[CefC_Shmring_A2N].sleep_f = 1;
+	hdr->idx[CefC_Shmring_N2A].sleep_f = 1;
+
+	return (shm);
+
+ERROR:
+	cef_shmring_destroy (shm);
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Maps the shared memory created by cefnetd. The FDs are owned by the returned
+	rings, or closed if it fails
+----------------------------------------------------------------------------------------*/
+CefT_Shmring*								/* attached rings or NULL 					*/
+cef_shmring_attach (
+	int fds[]								/* FDs received by cef_shmring_fds_recv 	*/
+) {
+	CefT_Shmring* shm;
+	CefT_Shmring_Hdr* hdr;
+	struct stat st;
+	int i;
+
+	shm = cef_shmring_alloc ();
+	if (shm == NULL) {
+		for (i = 0 ; i < CefC_Shmring_Fd_Num ; i++) {
+			if (fds[i] >= 0) {
+				close (fds[i]);
+			}
+		}
+		return (NULL);
+	}
+	for (i = 0 ; i < CefC_Shmring_Fd_Num ; i++) {
+		shm->fds[i] = fds[i];
+		if (fds[i] < 0) {
+			goto ERROR;
+		}
+	}
+
+	/* The layout is fixed at the build, so both ends must agree on it 	*/
+	if ((fstat (shm->fds[0], &st) < 0) || (st.st_size != CefC_Shmring_Size)) {
+		goto ERROR;
+	}
+	if (cef_shmring_map (shm, CefC_Shmring_Side_App) < 0) {
+		goto ERROR;
+	}
+	hdr = (CefT_Shmring_Hdr*) shm->base;
+	if ((hdr->magic != CefC_Shmring_Magic) ||
+		(hdr->version != CefC_Shmring_Version) ||
+		(hdr->desc_num != CefC_Shmring_Desc_Num) ||
+		(hdr->data_size != CefC_Shmring_Data_Size)) {
+		goto ERROR;
+	}
+
+	return (shm);
+
+ERROR:
+	cef_shmring_destroy (shm);
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Unmaps the shared memory and closes the FDs
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_destroy (
+	CefT_Shmring* shm
+) {
+	int i;
+
+	if (shm == NULL) {
+		return;
+	}
+	if (shm->base) {
+		munmap (shm->base, CefC_Shmring_Size);
+	}
+	for (i = 0 ; i < CefC_Shmring_Fd_Num ; i++) {
+		if (shm->fds[i] >= 0) {
+			close (shm->fds[i]);
+		}
+	}
+	pthread_mutex_destroy (&shm->tx_mutex);
+	free (shm);
+}
+/*--------------------------------------------------------------------------------------
+	Sends the message with the FDs of the shared memory (SCM_RIGHTS)
+----------------------------------------------------------------------------------------*/
+int											/* bytes sent, negative if it fails 		*/
+cef_shmring_fds_send (
+	int sock,								/* local socket of the application 			*/
+	CefT_Shmring* shm,
+	const void* msg,
+	int msg_len
+) {
+	struct msghdr mh;
+	struct iovec iov;
+	struct cmsghdr* cmsg;
+	union {
+		struct cmsghdr 	align;
+		char 			buff[CMSG_SPACE (sizeof (int) * CefC_Shmring_Fd_Num)];
+	} ctrl;
+
+	memset (&mh, 0, sizeof (mh));
+	iov.iov_base 	= (void*) msg;
+	iov.iov_len 	= msg_len;
+	mh.msg_iov 		= &iov;
+	mh.msg_iovlen 	= 1;
+
+	/* The rejection has no FDs 	*/
+	if (shm) {
+		memset (&ctrl, 0, sizeof (ctrl));
+		mh.msg_control 		= ctrl.buff;
+		mh.msg_controllen 	= sizeof (ctrl.buff);
+		cmsg = CMSG_FIRSTHDR (&mh);
+		cmsg->cmsg_level 	= SOL_SOCKET;
+		cmsg->cmsg_type 	= SCM_RIGHTS;
+		cmsg->cmsg_len 		= CMSG_LEN (sizeof (int) * CefC_Shmring_Fd_Num);
+		memcpy (CMSG_DATA (cmsg), shm->fds, sizeof (int) * CefC_Shmring_Fd_Num);
+	}
+
+	return ((int) sendmsg (sock, &mh, MSG_NOSIGNAL));
+}
+/*--------------------------------------------------------------------------------------
+	Receives the message and the FDs sent by cef_shmring_fds_send. The FDs which
+	were not passed are set to -1
+----------------------------------------------------------------------------------------*/
+int											/* bytes received, negative if it fails 	*/
+cef_shmring_fds_recv (
+	int sock,								/* local socket connected to cefnetd 		*/
+	void* buff,
+	int buff_len,
+	int fds[]								/* CefC_Shmring_Fd_Num entries 				*/
+) {
+	struct msghdr mh;
+	struct iovec iov;
+	struct cmsghdr* cmsg;
+	union {
+		struct cmsghdr 	align;
+		char 			buff[CMSG_SPACE (sizeof (int) * CefC_Shmring_Fd_Num)];
+	} ctrl;
+	int rcvd[CefC_Shmring_Fd_Num];
+	int num;
+	int res;
+	int i;
+
+	for (i = 0 ; i < CefC_Shmring_Fd_Num ; i++) {
+		fds[i] = -1;
+	}
+	memset (&mh, 0, sizeof (mh));
+	iov.iov_base 		= buff;
+	iov.iov_len 		= buff_len;
+	mh.msg_iov 			= &iov;
+	mh.msg_iovlen 		= 1;
+	mh.msg_control 		= ctrl.buff;
+	mh.msg_controllen 	= sizeof (ctrl.buff);
+
+	res = (int) recvmsg (sock, &mh, MSG_CMSG_CLOEXEC);
+	if (res < 0) {
+		return (res);
+	}
+	for (cmsg = CMSG_FIRSTHDR (&mh) ; cmsg ; cmsg = CMSG_NXTHDR (&mh, cmsg)) {
+		if ((cmsg->cmsg_level != SOL_SOCKET) || (cmsg->cmsg_type != SCM_RIGHTS)) {
+			continue;
+		}
+		num = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+		if (num > CefC_Shmring_Fd_Num) {
+			num = CefC_Shmring_Fd_Num;
+		}
+		memcpy (rcvd, CMSG_DATA (cmsg), sizeof (int) * num);
+		for (i = 0 ; i < num ; i++) {
+			fds[i] = rcvd[i];
+		}
+	}
+
+	return (res);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the eventfd which becomes readable when the peer puts the frames
+	into the receive ring while this end sleeps
+----------------------------------------------------------------------------------------*/
+int
+cef_shmring_event_fd (
+	CefT_Shmring* shm
+) {
+	return (shm->rx_evfd);
+}
+/*--------------------------------------------------------------------------------------
+	Reserves the contiguous buffer of the specified length in the send ring, so
+	that the frame is created in place. The ring is locked until the commit
+----------------------------------------------------------------------------------------*/
+unsigned char*								/* NULL if the ring is full 				*/
+cef_shmring_reserve (
+	CefT_Shmring* shm,
+	int len
+) {
+	CefT_Shmring_Idx* idx = shm->tx_idx;
+	uint32_t used;
+	uint32_t pos;
+	uint32_t off;
+
+	if ((len < 1) || (len > CefC_Shmring_Data_Size)) {
+		return (NULL);
+	}
+	pthread_mutex_lock (&shm->tx_mutex);
+
+	if (shm->tx_desc_head - __atomic_load_n (&idx->desc_tail, __ATOMIC_ACQUIRE)
+			>= CefC_Shmring_Desc_Num) {
+		goto FULL;
+	}
+	used = shm->tx_data_head - __atomic_load_n (&idx->data_tail, __ATOMIC_ACQUIRE);
+	if (used > CefC_Shmring_Data_Size) {
+		/* The peer has broken the index 	*/
+		goto FULL;
+	}
+
+	/* A frame which would cross the end is put at the head 	*/
+	pos = shm->tx_data_head;
+	off = pos & (CefC_Shmring_Data_Size - 1);
+	if (off + len > CefC_Shmring_Data_Size) {
+		pos += CefC_Shmring_Data_Size - off;
+		off = 0;
+	}
+	if (used + (pos - shm->tx_data_head) + len > CefC_Shmring_Data_Size) {
+		goto FULL;
+	}
+	shm->tx_rsv_pos = pos;
+
+	return (&shm->tx_data[off]);
+
+FULL:
+	pthread_mutex_unlock (&shm->tx_mutex);
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Passes the frame created in the reserved buffer to the peer, and wakes it up
+	if it sleeps. Zero length cancels the reservation
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_commit (
+	CefT_Shmring* shm,
+	int len									/* length of the frame 						*/
+) {
+	CefT_Shmring_Idx* idx = shm->tx_idx;
+	CefT_Shmring_Desc* desc;
+	uint64_t val = 1;
+
+	if (len > 0) {
+		desc = &shm->tx_desc[shm->tx_desc_head & (CefC_Shmring_Desc_Num - 1)];
+		desc->end = shm->tx_rsv_pos + (uint32_t) len;
+		desc->len = (uint32_t) len;
+		shm->tx_data_head = desc->end;
+		shm->tx_desc_head++;
+		__atomic_store_n (&idx->desc_head, shm->tx_desc_head, __ATOMIC_RELEASE);
+
+		/* Pairs with the fence in cef_shmring_sleep, so that either the 	*/
+		/* consumer sees the frame or this end sees it sleeping 			*/
+		__atomic_thread_fence (__ATOMIC_SEQ_CST);
+		if (__atomic_load_n (&idx->sleep_f, __ATOMIC_RELAXED)) {
+			if (write (shm->tx_evfd, &val, sizeof (val)) < 0) {
+				/* NOP */;
+			}
+		}
+	}
+	pthread_mutex_unlock (&shm->tx_mutex);
+}
+/*--------------------------------------------------------------------------------------
+	Copies the frame into the send ring
+----------------------------------------------------------------------------------------*/
+int											/* length sent, 0 if the ring is full 		*/
+cef_shmring_send (
+	CefT_Shmring* shm,
+	const unsigned char* msg,
+	int msg_len
+) {
+	unsigned char* wp;
+
+	wp = cef_shmring_reserve (shm, msg_len);
+	if (wp == NULL) {
+		return (0);
+	}
+	memcpy (wp, msg, msg_len);
+	cef_shmring_commit (shm, msg_len);
+
+	return (msg_len);
+}
+/*--------------------------------------------------------------------------------------
+	Copies the frames in the receive ring into the buffer like a stream socket.
+	A frame longer than the buffer is read by the following calls
+----------------------------------------------------------------------------------------*/
+int											/* bytes copied, 0 if the ring is empty, 	*/
+											/* negative if the ring is broken 			*/
+cef_shmring_recv (
+	CefT_Shmring* shm,
+	unsigned char* buff,
+	int buff_len
+) {
+	CefT_Shmring_Idx* idx = shm->rx_idx;
+	CefT_Shmring_Desc* desc;
+	uint32_t head;
+	uint32_t tail = shm->rx_desc_tail;
+	uint32_t end;
+	uint32_t done_end = 0;						/* end of the last frame read entirely	*/
+	uint32_t len;
+	uint32_t off;
+	int copied = 0;
+	int n;
+
+	head = __atomic_load_n (&idx->desc_head, __ATOMIC_ACQUIRE);
+	if (head - tail > CefC_Shmring_Desc_Num) {
+		return (-1);
+	}
+
+	while ((tail != head) && (copied < buff_len)) {
+		/* The peer may rewrite the descriptor, so it is read only once 	*/
+		desc = &shm->rx_desc[tail & (CefC_Shmring_Desc_Num - 1)];
+		end = __atomic_load_n (&desc->end, __ATOMIC_RELAXED);
+		len = __atomic_load_n (&desc->len, __ATOMIC_RELAXED);
+		off = (end - len) & (CefC_Shmring_Data_Size - 1);
+		if ((len == 0) || (len > CefC_Max_Length) ||
+			(off + len > CefC_Shmring_Data_Size) || (shm->rx_read_len >= len)) {
+			return (-1);
+		}
+
+		n = (int)(len - shm->rx_read_len);
+		if (n > buff_len - copied) {
+			n = buff_len - copied;
+		}
+		memcpy (&buff[copied], &shm->rx_data[off + shm->rx_read_len], n);
+		copied += n;
+		shm->rx_read_len += n;
+		if (shm->rx_read_len < len) {
+			break;
+		}
+		shm->rx_read_len = 0;
+		tail++;
+		done_end = end;
+	}
+
+	/* The data of a frame read partly must not be released to the producer	*/
+	if (tail != shm->rx_desc_tail) {
+		shm->rx_desc_tail = tail;
+		__atomic_store_n (&idx->data_tail, done_end, __ATOMIC_RELEASE);
+		__atomic_store_n (&idx->desc_tail, tail, __ATOMIC_RELEASE);
+	}
+	if (copied > 0) {
+		/* The producer does not need to wake this end up while it reads 	*/
+		__atomic_store_n (&idx->sleep_f, 0, __ATOMIC_RELAXED);
+	}
+
+	return (copied);
+}
+/*--------------------------------------------------------------------------------------
+	Clears the eventfd and asks the peer to wake this end up with the next frame.
+	Returns 0 without sleeping if the frames have arrived in the meantime
+----------------------------------------------------------------------------------------*/
+int											/* 1 if the caller may wait on the eventfd 	*/
+cef_shmring_sleep (
+	CefT_Shmring* shm
+) {
+	CefT_Shmring_Idx* idx = shm->rx_idx;
+	uint64_t val;
+
+	if (read (shm->rx_evfd, &val, sizeof (val)) < 0) {
+		/* NOP */;
+	}
+	__atomic_store_n (&idx->sleep_f, 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n (&idx->desc_head, __ATOMIC_ACQUIRE) != shm->rx_desc_tail) {
+		__atomic_store_n (&idx->sleep_f, 0, __ATOMIC_RELAXED);
+		return (0);
+	}
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Makes the eventfd of this end readable, so that the receiver which has
+	stopped with the frames left in the ring is called again
+----------------------------------------------------------------------------------------*/
+void
+cef_shmring_kick (
+	CefT_Shmring* shm
+) {
+	uint64_t val = 1;
+
+	if (write (shm->rx_evfd, &val, sizeof (val)) < 0) {
+		/* NOP */;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Maps the shared memory and sets the rings of the specified end
+----------------------------------------------------------------------------------------*/
+static int									/* negative if it fails 					*/
+cef_shmring_map (
+	CefT_Shmring* shm,
+	int side								/* CefC_Shmring_Side_XXX 					*/
+) {
+	CefT_Shmring_Hdr* hdr;
+	int tx, rx;
+	void* base;
+
+	base = mmap (NULL, CefC_Shmring_Size,
+				PROT_READ | PROT_WRITE, MAP_SHARED, shm->fds[0], 0);
+	if (base == MAP_FAILED) {
+		return (-1);
+	}
+	shm->base = (unsigned char*) base;
+	hdr = (CefT_Shmring_Hdr*) base;
+
+	if (side == CefC_Shmring_Side_Netd) {
+		tx = CefC_Shmring_N2A;
+		rx = CefC_Shmring_A2N;
+	} else {
+		tx = CefC_Shmring_A2N;
+		rx = CefC_Shmring_N2A;
+	}
+	shm->tx_idx 	= &hdr->idx[tx];
+	shm->tx_desc 	= (CefT_Shmring_Desc*) &shm->base[CefC_Shmring_Desc_Off (tx)];
+	shm->tx_data 	= &shm->base[CefC_Shmring_Data_Off (tx)];
+	shm->tx_evfd 	= shm->fds[1 + tx];
+	shm->rx_idx 	= &hdr->idx[rx];
+	shm->rx_desc 	= (CefT_Shmring_Desc*) &shm->base[CefC_Shmring_Desc_Off (rx)];
+	shm->rx_data 	= &shm->base[CefC_Shmring_Data_Off (rx)];
+	shm->rx_evfd 	= shm->fds[1 + rx];
+
+	return (1);
+}
+/*--------------------------------------------------------------------------------------
+	Allocates the rings whose FDs are not opened yet
+----------------------------------------------------------------------------------------*/
+static CefT_Shmring*
+cef_shmring_alloc (
+	void
+) {
+	CefT_Shmring* shm;
+	int i;
+
+	shm = (CefT_Shmring*) calloc (1, sizeof (CefT_Shmring));
+	if (shm == NULL) {
+		return (NULL);
+	}
+	for (i = 0 ; i < CefC_Shmring_Fd_Num ; i++) {
+		shm->fds[i] = -1;
+	}
+	pthread_mutex_init (&shm->tx_mutex, NULL);
+
+	return (shm);
+}
+#else // CefC_Shmring_Enable
+/*--------------------------------------------------------------------------------------
+	The shared memory is not available on this platform, so the applications
+	keep using the local socket
+----------------------------------------------------------------------------------------*/
+CefT_Shmring*
+cef_shmring_create (
+	void
+) {
+	return (NULL);
+}
+CefT_Shmring*
+cef_shmring_attach (
+	int fds[]
+) {
+	int i;
+
+	for (i = 0 ; i < CefC_Shmring_Fd_Num ; i++) {
+		if (fds[i] >= 0) {
+			close (fds[i]);
+		}
+	}
+	return (NULL);
+}
+void
+cef_shmring_destroy (
+	CefT_Shmring* shm
+) {
+	return;
+}
+int
+cef_shmring_fds_send (
+	int sock,
+	CefT_Shmring* shm,
+	const void* msg,
+	int msg_len
+) {
+	return ((int) send (sock, msg, msg_len, 0));
+}
+int
+cef_shmring_fds_recv (
+	int sock,
+	void* buff,
+	int buff_len,
+	int fds[]
+) {
+	int i;
+
+	for (i = 0 ; i < CefC_Shmring_Fd_Num ; i++) {
+		fds[i] = -1;
+	}
+	return ((int) recv (sock, buff, buff_len, 0));
+}
+int
+cef_shmring_event_fd (
+	CefT_Shmring* shm
+) {
+	return (-1);
+}
+unsigned char*
+cef_shmring_reserve (
+	CefT_Shmring* shm,
+	int len
+) {
+	return (NULL);
+}
+void
+cef_shmring_commit (
+	CefT_Shmring* shm,
+	int len
+) {
+	return;
+}
+int
+cef_shmring_send (
+	CefT_Shmring* shm,
+	const unsigned char* msg,
+	int msg_len
+) {
+	return (0);
+}
+int
+cef_shmring_recv (
+	CefT_Shmring* shm,
+	unsigned char* buff,
+	int buff_len
+) {
+	return (-1);
+}
+int
+cef_shmring_sleep (
+	CefT_Shmring* shm
+) {
+	return (1);
+}
+void
+cef_shmring_kick (
+	CefT_Shmring* shm
+) {
+	return;
+}
+#endif // CefC_Shmring_Enable
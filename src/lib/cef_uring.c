@@ -0,0 +1,592 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cef_uring.c
+ */
+
+#define __CEF_URING_SOURECE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cefore/cef_uring.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#ifdef __NR_io_uring_setup
+#define CefC_Uring_Enable
+#endif // __NR_io_uring_setup
+#endif // __has_include(<linux/io_uring.h>)
+#endif // __linux__ && __has_include
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+
+/*
+	The rings are driven with the raw system calls, so that liburing is not
+	required. The user_data of an I/O holds the tag (bits 48-63), the index of
+	the buffer plus one (bits 32-47, zero if no buffer) and the FD (bits 0-31).
+*/
+#define CefC_Uring_Ud(tag, idx, fd)		\
+	(((uint64_t)(tag) << 48) | ((uint64_t)((idx) + 1) << 32) | (uint32_t)(fd))
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+struct CefT_Uring {
+
+	int 			ring_fd;				/* FD of the io_uring instance 				*/
+	int 			depth;					/* number of the buffers 					*/
+	int 			queued;					/* I/Os queued but not submitted 			*/
+	int 			inflight;				/* I/Os queued or in flight 				*/
+
+	/********** Submission queue 	**********/
+	void* 			sq_ptr;
+	size_t 			sq_len;
+	unsigned* 		sq_head;
+	unsigned* 		sq_tail;
+	unsigned* 		sq_mask;
+	unsigned* 		sq_array;
+	unsigned 		sq_entries;
+	unsigned 		sq_local_tail;			/* tail including the queued I/Os 			*/
+	void* 			sqes;
+	size_t 			sqes_len;
+
+	/********** Completion queue 	**********/
+	void* 			cq_ptr;
+	size_t 			cq_len;
+	unsigned* 		cq_head;
+	unsigned* 		cq_tail;
+	unsigned* 		cq_mask;
+	void* 			cqes;
+
+	/********** Buffers 	**********/
+	unsigned char* 	buff;					/* aligned to CefC_Uring_Align 				*/
+	uint32_t 		buff_size;
+	struct iovec* 	iovs;
+	int* 			free_idx;				/* stack of the free buffers 				*/
+	int 			free_num;
+	int 			fixed_f;				/* buffers are registered to the kernel 	*/
+};
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+
+#ifdef CefC_Uring_Enable
+/*--------------------------------------------------------------------------------------
+	Obtains the free entry of the submission queue
+----------------------------------------------------------------------------------------*/
+static struct io_uring_sqe*					/* NULL if the queue is full 				*/
+cef_uring_sqe_get (
+	CefT_Uring* ring						/* io_uring instance 						*/
+);
+/*--------------------------------------------------------------------------------------
+	Queues the read or write of the buffer
+----------------------------------------------------------------------------------------*/
+static int									/* negative if the queue is full 			*/
+cef_uring_rw_queue (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int write_f,
+	int fd,
+	int buff_idx,
+	uint32_t len,
+	uint64_t offset,
+	uint16_t tag
+);
+#endif // CefC_Uring_Enable
+
+/****************************************************************************************
+ ****************************************************************************************/
+
+#ifdef CefC_Uring_Enable
+/*--------------------------------------------------------------------------------------
+	Creates the io_uring instance and registers the buffers used by the I/Os.
+	Returns NULL if io_uring is not available (e.g. not Linux or disabled kernel)
+----------------------------------------------------------------------------------------*/
+CefT_Uring*									/* created instance or NULL 				*/
+cef_uring_create (
+	int depth,								/* number of I/Os in flight (and buffers) 	*/
+	uint32_t buff_size						/* size of each buffer 						*/
+) {
+	CefT_Uring* ring;
+	struct io_uring_params params;
+	void* buff;
+	int i;
+
+	if ((depth < 1) || (depth > CefC_Uring_Depth_Max)) {
+		return (NULL);
+	}
+	ring = (CefT_Uring*) calloc (1, sizeof (CefT_Uring));
+	if (ring == NULL) {
+		return (NULL);
+	}
+	ring->depth = depth;
+	ring->buff_size
+		= (buff_size + CefC_Uring_Align - 1) / CefC_Uring_Align * CefC_Uring_Align;
+
+	/* Sets up the rings. The read-ahead shares the queue with the buffer I/Os 	*/
+	memset (&params, 0, sizeof (params));
+	ring->ring_fd = (int) syscall (__NR_io_uring_setup, depth * 2, &params);
+	if (ring->ring_fd < 0) {
+		free (ring);
+		return (NULL);
+	}
+	ring->sq_len = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+	ring->cq_len = params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_len > ring->sq_len) {
+			ring->sq_len = ring->cq_len;
+		}
+		ring->cq_len = 0;
+	}
+#endif // IORING_FEAT_SINGLE_MMAP
+	ring->sq_ptr = mmap (NULL, ring->sq_len, PROT_READ | PROT_WRITE,
+						MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQ_RING);
+	if (ring->sq_ptr == MAP_FAILED) {
+		ring->sq_ptr = NULL;
+		goto ERROR;
+	}
+	if (ring->cq_len) {
+		ring->cq_ptr = mmap (NULL, ring->cq_len, PROT_READ | PROT_WRITE,
+						MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_CQ_RING);
+		if (ring->cq_ptr == MAP_FAILED) {
+			ring->cq_ptr = NULL;
+			goto ERROR;
+		}
+	} else {
+		ring->cq_ptr = ring->sq_ptr;
+	}
+	ring->sqes_len = params.sq_entries * sizeof (struct io_uring_sqe);
+	ring->sqes = mmap (NULL, ring->sqes_len, PROT_READ | PROT_WRITE,
+						MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED) {
+		ring->sqes = NULL;
+		goto ERROR;
+	}
+	ring->sq_head 	= (unsigned*)((char*) ring->sq_ptr + params.sq_off.head);
+	ring->sq_tail 	= (unsigned*)((char*) ring->sq_ptr + params.sq_off.tail);
+	ring->sq_mask 	= (unsigned*)((char*) ring->sq_ptr + params.sq_off.ring_mask);
+	ring->sq_array 	= (unsigned*)((char*) ring->sq_ptr + params.sq_off.array);
+	ring->sq_entries 	= params.sq_entries;
+	ring->sq_local_tail = *ring->sq_tail;
+	ring->cq_head 	= (unsigned*)((char*) ring->cq_ptr + params.cq_off.head);
+	ring->cq_tail 	= (unsigned*)((char*) ring->cq_ptr + params.cq_off.tail);
+	ring->cq_mask 	= (unsigned*)((char*) ring->cq_ptr + params.cq_off.ring_mask);
+	ring->cqes 		= (char*) ring->cq_ptr + params.cq_off.cqes;
+
+	/* Allocates the buffers and registers them if the kernel accepts 	*/
+	if (posix_memalign (&buff, CefC_Uring_Align, (size_t) ring->buff_size * depth) != 0) {
+		goto ERROR;
+	}
+	ring->buff 		= (unsigned char*) buff;
+	ring->iovs 		= (struct iovec*) calloc (depth, sizeof (struct iovec));
+	ring->free_idx 	= (int*) calloc (depth, sizeof (int));
+	if ((ring->iovs == NULL) || (ring->free_idx == NULL)) {
+		goto ERROR;
+	}
+	for (i = 0 ; i < depth ; i++) {
+		ring->iovs[i].iov_base 	= &ring->buff[(size_t) ring->buff_size * i];
+		ring->iovs[i].iov_len 	= ring->buff_size;
+		ring->free_idx[i] 		= depth - 1 - i;
+	}
+	ring->free_num = depth;
+	if (syscall (__NR_io_uring_register, ring->ring_fd,
+			IORING_REGISTER_BUFFERS, ring->iovs, depth) == 0) {
+		ring->fixed_f = 1;
+	}
+
+	return (ring);
+
+ERROR:
+	cef_uring_destroy (ring);
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Destroys the io_uring instance. The I/Os in flight are waited for
+----------------------------------------------------------------------------------------*/
+void
+cef_uring_destroy (
+	CefT_Uring* ring						/* io_uring instance 						*/
+) {
+	uint16_t tag;
+	int fd, res;
+
+	if (ring == NULL) {
+		return;
+	}
+	if (ring->sqes && ring->cq_ptr) {
+		while (cef_uring_reap (ring, 1, &tag, &fd, &res) > 0) {
+			;
+		}
+	}
+	if (ring->sqes) {
+		munmap (ring->sqes, ring->sqes_len);
+	}
+	if (ring->cq_ptr && ring->cq_ptr != ring->sq_ptr) {
+		munmap (ring->cq_ptr, ring->cq_len);
+	}
+	if (ring->sq_ptr) {
+		munmap (ring->sq_ptr, ring->sq_len);
+	}
+	close (ring->ring_fd);
+	free (ring->buff);
+	free (ring->iovs);
+	free (ring->free_idx);
+	free (ring);
+}
+/*--------------------------------------------------------------------------------------
+	Returns a free buffer. NULL if all buffers are used by the I/Os in flight
+----------------------------------------------------------------------------------------*/
+unsigned char*								/* head of the buffer 						*/
+cef_uring_buff_get (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int* buff_idx							/* index of the buffer 						*/
+) {
+	if (ring->free_num == 0) {
+		return (NULL);
+	}
+	ring->free_num--;
+	*buff_idx = ring->free_idx[ring->free_num];
+	return ((unsigned char*) ring->iovs[*buff_idx].iov_base);
+}
+/*--------------------------------------------------------------------------------------
+	Queues the write of the buffer. The buffer is released when the write completes
+----------------------------------------------------------------------------------------*/
+int											/* negative if the queue is full 			*/
+cef_uring_write (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int fd,
+	int buff_idx,							/* index of the buffer to write 			*/
+	uint32_t len,
+	uint64_t offset,
+	uint16_t tag							/* returned with the completion 			*/
+) {
+	return (cef_uring_rw_queue (ring, 1, fd, buff_idx, len, offset, tag));
+}
+/*--------------------------------------------------------------------------------------
+	Queues the read into the buffer. The buffer is released when the read
+	completes, so the caller reads it before the next cef_uring_buff_get
+----------------------------------------------------------------------------------------*/
+int											/* negative if the queue is full 			*/
+cef_uring_read (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int fd,
+	int buff_idx,							/* index of the buffer to read into 		*/
+	uint32_t len,
+	uint64_t offset,
+	uint16_t tag							/* returned with the completion 			*/
+) {
+	return (cef_uring_rw_queue (ring, 0, fd, buff_idx, len, offset, tag));
+}
+/*--------------------------------------------------------------------------------------
+	Queues the posix_fadvise of the range of the file (e.g. read-ahead)
+----------------------------------------------------------------------------------------*/
+int											/* negative if the queue is full 			*/
+cef_uring_fadvise (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int fd,
+	uint64_t offset,
+	uint32_t len,
+	int advice,								/* POSIX_FADV_XXX 							*/
+	uint16_t tag							/* returned with the completion 			*/
+) {
+#ifdef IORING_FEAT_RW_CUR_POS
+	struct io_uring_sqe* sqe;
+
+	sqe = cef_uring_sqe_get (ring);
+	if (sqe == NULL) {
+		return (-1);
+	}
+	sqe->opcode 		= IORING_OP_FADVISE;
+	sqe->fd 			= fd;
+	sqe->off 			= offset;
+	sqe->len 			= len;
+	sqe->fadvise_advice = (uint32_t) advice;
+	sqe->user_data 		= CefC_Uring_Ud (tag, CefC_Uring_No_Buff, fd);
+	return (0);
+#else // IORING_FEAT_RW_CUR_POS
+	/* IORING_OP_FADVISE appeared with IORING_FEAT_RW_CUR_POS (Linux 5.6) 	*/
+	return (-1);
+#endif // IORING_FEAT_RW_CUR_POS
+}
+/*--------------------------------------------------------------------------------------
+	Submits the queued I/Os to the kernel
+----------------------------------------------------------------------------------------*/
+int											/* number of submitted I/Os 				*/
+cef_uring_submit (
+	CefT_Uring* ring						/* io_uring instance 						*/
+) {
+	int res;
+
+	if (ring->queued == 0) {
+		return (0);
+	}
+	__atomic_store_n (ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+	res = (int) syscall (__NR_io_uring_enter, ring->ring_fd, ring->queued, 0, 0, NULL, 0);
+	if (res < 0) {
+		if ((errno == EINTR) || (errno == EAGAIN) || (errno == EBUSY)) {
+			return (0);
+		}
+		return (-1);
+	}
+	ring->queued -= res;
+	return (res);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains a completion. With wait_f, waits until one of the I/Os completes
+----------------------------------------------------------------------------------------*/
+int											/* 1: completed, 0: none, negative: error 	*/
+cef_uring_reap (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int wait_f,
+	uint16_t* tag,							/* tag of the I/O 							*/
+	int* fd,								/* FD of the I/O 							*/
+	int* res								/* result (bytes or -errno) 				*/
+) {
+	struct io_uring_cqe* cqe;
+	unsigned head, tail;
+	uint64_t ud;
+	int idx;
+
+	while (1) {
+		head = *ring->cq_head;
+		tail = __atomic_load_n (ring->cq_tail, __ATOMIC_ACQUIRE);
+		if (head != tail) {
+			cqe = &((struct io_uring_cqe*) ring->cqes)[head & *ring->cq_mask];
+			ud 	 = cqe->user_data;
+			*res = cqe->res;
+			__atomic_store_n (ring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+			*tag = (uint16_t)(ud >> 48);
+			*fd  = (int)(uint32_t) ud;
+			idx  = (int)((ud >> 32) & 0xFFFF) - 1;
+			if (idx >= 0) {
+				ring->free_idx[ring->free_num] = idx;
+				ring->free_num++;
+			}
+			ring->inflight--;
+			return (1);
+		}
+		if ((wait_f == 0) || (ring->inflight == 0)) {
+			return (0);
+		}
+		if (ring->queued) {
+			if (cef_uring_submit (ring) < 0) {
+				return (-1);
+			}
+			continue;
+		}
+		if (syscall (__NR_io_uring_enter, ring->ring_fd, 0, 1,
+				IORING_ENTER_GETEVENTS, NULL, 0) < 0) {
+			if (errno != EINTR) {
+				return (-1);
+			}
+		}
+	}
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Returns the number of the I/Os queued or in flight
+----------------------------------------------------------------------------------------*/
+int
+cef_uring_inflight (
+	CefT_Uring* ring						/* io_uring instance 						*/
+) {
+	return (ring->inflight);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the free entry of the submission queue
+----------------------------------------------------------------------------------------*/
+static struct io_uring_sqe*					/* NULL if the queue is full 				*/
+cef_uring_sqe_get (
+	CefT_Uring* ring						/* io_uring instance 						*/
+) {
+	struct io_uring_sqe* sqe;
+	unsigned head;
+	unsigned idx;
+
+	/* The completion queue is twice as long, so it never overflows 	*/
+	if (ring->inflight >= (int) ring->sq_entries) {
+		return (NULL);
+	}
+	head = __atomic_load_n (ring->sq_head, __ATOMIC_ACQUIRE);
+	if (ring->sq_local_tail - head >= ring->sq_entries) {
+		return (NULL);
+	}
+	idx = ring->sq_local_tail & *ring->sq_mask;
+	sqe = &((struct io_uring_sqe*) ring->sqes)[idx];
+	memset (sqe, 0, sizeof (struct io_uring_sqe));
+	ring->sq_array[idx] = idx;
+	ring->sq_local_tail++;
+	ring->queued++;
+	ring->inflight++;
+
+	return (sqe);
+}
+/*--------------------------------------------------------------------------------------
+	Queues the read or write of the buffer
+----------------------------------------------------------------------------------------*/
+static int									/* negative if the queue is full 			*/
+cef_uring_rw_queue (
+	CefT_Uring* ring,						/* io_uring instance 						*/
+	int write_f,
+	int fd,
+	int buff_idx,
+	uint32_t len,
+	uint64_t offset,
+	uint16_t tag
+) {
+	struct io_uring_sqe* sqe;
+
+	if ((buff_idx < 0) || (buff_idx >= ring->depth) || (len > ring->buff_size)) {
+		return (-1);
+	}
+	sqe = cef_uring_sqe_get (ring);
+	if (sqe == NULL) {
+		return (-1);
+	}
+	sqe->fd 	= fd;
+	sqe->off 	= offset;
+	if (ring->fixed_f) {
+		sqe->opcode 	= write_f ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+		sqe->addr 		= (uint64_t)(uintptr_t) ring->iovs[buff_idx].iov_base;
+		sqe->len 		= len;
+		sqe->buf_index 	= (uint16_t) buff_idx;
+	} else {
+		/* The length of the iovec is fixed, so the single-buffer vector is used 	*/
+		sqe->opcode 	= write_f ? IORING_OP_WRITEV : IORING_OP_READV;
+		ring->iovs[buff_idx].iov_len = len;
+		sqe->addr 		= (uint64_t)(uintptr_t) &ring->iovs[buff_idx];
+		sqe->len 		= 1;
+	}
+	sqe->user_data = CefC_Uring_Ud (tag, buff_idx, fd);
+
+	return (0);
+}
+#else // CefC_Uring_Enable
+/*--------------------------------------------------------------------------------------
+	io_uring is not available on this platform, so the callers use their
+	synchronous I/O
+----------------------------------------------------------------------------------------*/
+CefT_Uring*
+cef_uring_create (
+	int depth,
+	uint32_t buff_size
+) {
+	return (NULL);
+}
+void
+cef_uring_destroy (
+	CefT_Uring* ring
+) {
+	return;
+}
+unsigned char*
+cef_uring_buff_get (
+	CefT_Uring* ring,
+	int* buff_idx
+) {
+	return (NULL);
+}
+int
+cef_uring_write (
+	CefT_Uring* ring,
+	int fd,
+	int buff_idx,
+	uint32_t len,
+	uint64_t offset,
+	uint16_t tag
+) {
+	return (-1);
+}
+int
+cef_uring_read (
+	CefT_Uring* ring,
+	int fd,
+	int buff_idx,
+	uint32_t len,
+	uint64_t offset,
+	uint16_t tag
+) {
+	return (-1);
+}
+int
+cef_uring_fadvise (
+	CefT_Uring* ring,
+	int fd,
+	uint64_t offset,
+	uint32_t len,
+	int advice,
+	uint16_t tag
+) {
+	return (-1);
+}
+int
+cef_uring_submit (
+	CefT_Uring* ring
+) {
+	return (-1);
+}
+int
+cef_uring_reap (
+	CefT_Uring* ring,
+	int wait_f,
+	uint16_t* tag,
+	int* fd,
+	int* res
+) {
+	return (-1);
+}
+int
+cef_uring_inflight (
+	CefT_Uring* ring
+) {
+	return (0);
+}
+#endif // CefC_Uring_Enable
@@ -38,6 +38,8 @@
 
 #include <string.h>
 #include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
 #include <arpa/inet.h>
 
 #include <openssl/rsa.h>
@@ -55,10 +57,27 @@
 #include <cefore/cef_valid.h>
 #include <cefore/cef_hash.h>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CefC_Crc32c_Sse42_Enable
+#include <nmmintrin.h>
+#endif // __x86_64__
+
 /****************************************************************************************
  Macros
  ****************************************************************************************/
 
+#define CefC_Crc32c_Poly			0x82F63B78	/* Reflected polynomial of CRC32C		*/
+#define CefC_Crc32c_Long			2048		/* Bytes of each of 3 interleaved long	*/
+												/* blocks (must be a power of 2)		*/
+#define CefC_Crc32c_Short			256			/* Bytes of each of 3 interleaved short	*/
+												/* blocks (must be a power of 2)		*/
+#define CefC_Valid_Pkey_Cache_Num	256			/* Public keys cached by KeyId			*/
+												/* (must be a power of 2)				*/
+#define CefC_Valid_Verified_Num		4096		/* Verified signatures kept in the LRU	*/
+												/* (must be a power of 2)				*/
+#define CefC_Valid_Verified_Bucket(_d, _k) \
+	((((_d)[0] | ((_d)[1] << 8)) ^ ((_k)[0] | ((_k)[1] << 8))) & (CefC_Valid_Verified_Num - 1))
+
 /****************************************************************************************
  Structures Declaration
  ****************************************************************************************/
@@ -78,6 +97,32 @@ typedef struct {
 
 } CefT_Keys;
 
+/*------------------------------------------------------------------*/
+/* Public key received in T_PUBLICKEY and parsed once for its KeyId	*/
+/*------------------------------------------------------------------*/
+typedef struct {
+
+	unsigned char 	keyid[SHA256_DIGEST_LENGTH];	/* SHA-256 of pub_key_bi		*/
+	unsigned char* 	pub_key_bi;						/* DER of the public key		*/
+	int 			pub_key_bi_len;
+	EVP_PKEY*		pub_key;						/* NULL if the slot is empty	*/
+
+} CefT_Valid_Pkey;
+
+/*------------------------------------------------------------------*/
+/* Message which has been verified with the KeyId					*/
+/*------------------------------------------------------------------*/
+typedef struct {
+
+	unsigned char 	digest[SHA256_DIGEST_LENGTH];	/* Of the signed part and the	*/
+													/* signature					*/
+	unsigned char 	keyid[SHA256_DIGEST_LENGTH];
+	int 			chain;							/* Next entry in the bucket		*/
+	int 			prev;							/* Newer entry in the LRU list	*/
+	int 			next;							/* Older entry in the LRU list	*/
+
+} CefT_Valid_Verified;
+
 /****************************************************************************************
  State Variables
  ****************************************************************************************/
@@ -117,6 +162,14 @@ static uint32_t 			crc_table[256] =  /* this lookup table made with normal form
                                     0x243cc87a, 0x3ae0a73b, 0x198416f8, 0x075879b9, 0x5f4d757e, 0x41911a3f, 0x62f5abfc, 0x7c29c4bd,
                                     0xd2dfb272, 0xcc03dd33, 0xef676cf0, 0xf1bb03b1, 0xa9ae0f76, 0xb7726037, 0x9416d1f4, 0x8acabeb5
                                 };
+static uint32_t			crc32c_slice[8][256];	/* Tables of slicing-by-8			*/
+#ifdef CefC_Crc32c_Sse42_Enable
+static uint32_t			crc32c_long[4][256];	/* Shifts the CRC by a long block	*/
+static uint32_t			crc32c_short[4][256];	/* Shifts the CRC by a short block	*/
+#endif // CefC_Crc32c_Sse42_Enable
+static pthread_once_t		crc32c_once = PTHREAD_ONCE_INIT;
+static uint32_t (*crc32c_func)(const unsigned char*, size_t) = NULL;
+												/* Implementation selected at run time	*/
 static CefT_Hash_Handle		key_table;
 static CefT_Keys* 			default_key_entry = NULL;
 static char					ccninfo_sha256_prvkey_path[PATH_MAX*2];
@@ -126,6 +179,15 @@ size_t 						ccninfo_sha256_pub_key_bi_len;
 EVP_PKEY*					ccninfo_sha256_pub_key;
 EVP_PKEY*					ccninfo_sha256_prv_key;
 
+static pthread_mutex_t		pkey_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static CefT_Valid_Pkey		pkey_cache[CefC_Valid_Pkey_Cache_Num];
+static pthread_mutex_t		verified_mutex = PTHREAD_MUTEX_INITIALIZER;
+static CefT_Valid_Verified*	verified_ent = NULL;	/* Allocated at the first insert	*/
+static int*					verified_bucket = NULL;
+static int					verified_num = 0;
+static int					verified_head = -1;		/* Most recently verified			*/
+static int					verified_tail = -1;		/* Least recently verified			*/
+
 /****************************************************************************************
  Static Function Declaration
  ****************************************************************************************/
@@ -134,6 +196,32 @@ static void
 cef_valid_crc32c_init (
 	void
 );
+static void
+cef_valid_crc32c_tables_init (
+	void
+);
+static uint32_t
+cef_valid_crc32c_calc_table (
+	const unsigned char* buf,
+	size_t len
+);
+static uint32_t
+cef_valid_crc32c_calc_slice8 (
+	const unsigned char* buf,
+	size_t len
+);
+#ifdef CefC_Crc32c_Sse42_Enable
+static uint32_t
+cef_valid_crc32c_calc_sse42 (
+	const unsigned char* buf,
+	size_t len
+);
+static void
+cef_valid_crc32c_zeros (
+	uint32_t zeros[][256],
+	size_t len
+);
+#endif // CefC_Crc32c_Sse42_Enable
 static int
 cef_valid_trim_line_string (
 	const char* p1,
@@ -284,6 +372,45 @@ cef_valid_rsa_verify (
 	unsigned int			siglen,
 	EVP_PKEY*				pkey
 );
+/*--------------------------------------------------------------------------------------
+	Obtains the public key received in T_PUBLICKEY, parsing it only when it is not
+	in the cache of the KeyId
+----------------------------------------------------------------------------------------*/
+static EVP_PKEY*					/* The caller must free it with EVP_PKEY_free		*/
+cef_valid_pkey_cache_get (
+	const unsigned char*	keyid,			/* KeyId (32 bytes), or NULL				*/
+	const unsigned char*	pub_key_bi,
+	int						pub_key_bi_len,
+	int*					bound_f			/* Set to 1 if the KeyId is the SHA-256 of	*/
+											/* the public key							*/
+);
+/*--------------------------------------------------------------------------------------
+	Searches the LRU for the message verified with the KeyId
+----------------------------------------------------------------------------------------*/
+static int							/* 1 if it has been verified						*/
+cef_valid_verified_lookup (
+	const unsigned char*	digest,
+	const unsigned char*	keyid
+);
+/*--------------------------------------------------------------------------------------
+	Records the message verified with the KeyId, evicting the least recent one
+----------------------------------------------------------------------------------------*/
+static void
+cef_valid_verified_insert (
+	const unsigned char*	digest,
+	const unsigned char*	keyid
+);
+/*--------------------------------------------------------------------------------------
+	Unlinks the entry from the LRU list / links it to the head of the LRU list
+----------------------------------------------------------------------------------------*/
+static void
+cef_valid_verified_lru_unlink (
+	int idx
+);
+static void
+cef_valid_verified_lru_push (
+	int idx
+);
 
 /****************************************************************************************
  ****************************************************************************************/
@@ -373,6 +500,65 @@ uint32_t
 cef_valid_crc32c_calc (
 	const unsigned char* buf,
 	size_t len
+) {
+	if (crc32c_func == NULL) {
+		cef_valid_crc32c_impl_set (CefC_Crc32c_Impl_Auto);
+	}
+	return ((*crc32c_func)(buf, len));
+}
+
+int												/* Selected implementation, or -1 if	*/
+												/* the CPU does not support it			*/
+cef_valid_crc32c_impl_set (
+	int impl									/* CefC_Crc32c_Impl_XXX					*/
+) {
+	pthread_once (&crc32c_once, cef_valid_crc32c_tables_init);
+
+	if (impl == CefC_Crc32c_Impl_Auto) {
+#ifdef CefC_Crc32c_Sse42_Enable
+		if (__builtin_cpu_supports ("sse4.2")) {
+			impl = CefC_Crc32c_Impl_Sse42;
+		} else {
+			impl = CefC_Crc32c_Impl_Slice8;
+		}
+#else // CefC_Crc32c_Sse42_Enable
+		impl = CefC_Crc32c_Impl_Slice8;
+#endif // CefC_Crc32c_Sse42_Enable
+	}
+
+	switch (impl) {
+		case CefC_Crc32c_Impl_Table: {
+			crc32c_func = cef_valid_crc32c_calc_table;
+			break;
+		}
+		case CefC_Crc32c_Impl_Slice8: {
+			crc32c_func = cef_valid_crc32c_calc_slice8;
+			break;
+		}
+#ifdef CefC_Crc32c_Sse42_Enable
+		case CefC_Crc32c_Impl_Sse42: {
+			if (!__builtin_cpu_supports ("sse4.2")) {
+				return (-1);
+			}
+			crc32c_func = cef_valid_crc32c_calc_sse42;
+			break;
+		}
+#endif // CefC_Crc32c_Sse42_Enable
+		default: {
+			return (-1);
+		}
+	}
+	return (impl);
+}
+
+/*--------------------------------------------------------------------------------------
+	Calculates CRC32C one byte per step with the table of the normal form polynomial.
+	This is the original implementation, and it is kept for reference.
+----------------------------------------------------------------------------------------*/
+static uint32_t
+cef_valid_crc32c_calc_table (
+	const unsigned char* buf,
+	size_t len
 ) {
     uint32_t c = 0xFFFFFFFF;
 
@@ -384,6 +570,197 @@ cef_valid_crc32c_calc (
     return (c ^ 0xFFFFFFFF);
 }
 
+/*--------------------------------------------------------------------------------------
+	Calculates CRC32C eight bytes per step with the tables of slicing-by-8
+----------------------------------------------------------------------------------------*/
+static uint32_t
+cef_valid_crc32c_calc_slice8 (
+	const unsigned char* buf,
+	size_t len
+) {
+	uint32_t c = 0xFFFFFFFF;
+
+	/* The bytes are loaded one by one, so this does not depend on the byte order 	*/
+	while (len >= 8) {
+		c ^= (uint32_t) buf[0] | ((uint32_t) buf[1] << 8) |
+			 ((uint32_t) buf[2] << 16) | ((uint32_t) buf[3] << 24);
+		c = crc32c_slice[7][c & 0xFF] ^ crc32c_slice[6][(c >> 8) & 0xFF] ^
+			crc32c_slice[5][(c >> 16) & 0xFF] ^ crc32c_slice[4][c >> 24] ^
+			crc32c_slice[3][buf[4]] ^ crc32c_slice[2][buf[5]] ^
+			crc32c_slice[1][buf[6]] ^ crc32c_slice[0][buf[7]];
+		buf += 8;
+		len -= 8;
+	}
+	while (len--) {
+		c = (c >> 8) ^ crc32c_slice[0][(c ^ *buf++) & 0xFF];
+	}
+	return (c ^ 0xFFFFFFFF);
+}
+
+#ifdef CefC_Crc32c_Sse42_Enable
+/*--------------------------------------------------------------------------------------
+	Shifts the CRC by the bytes of zeros with the table made by cef_valid_crc32c_zeros
+----------------------------------------------------------------------------------------*/
+static inline uint32_t
+cef_valid_crc32c_shift (
+	uint32_t zeros[][256],
+	uint32_t crc
+) {
+	return (zeros[0][crc & 0xFF] ^ zeros[1][(crc >> 8) & 0xFF] ^
+			zeros[2][(crc >> 16) & 0xFF] ^ zeros[3][crc >> 24]);
+}
+
+static inline uint64_t
+cef_valid_crc32c_load64 (
+	const unsigned char* p
+) {
+	uint64_t v;
+	memcpy (&v, p, sizeof (uint64_t));
+	return (v);
+}
+
+/*--------------------------------------------------------------------------------------
+	Calculates CRC32C with the crc32 instruction of SSE4.2
+----------------------------------------------------------------------------------------*/
+__attribute__((target("sse4.2")))
+static uint32_t
+cef_valid_crc32c_calc_sse42 (
+	const unsigned char* buf,
+	size_t len
+) {
+	uint64_t c0, c1, c2;
+	const unsigned char* end;
+
+	c0 = 0xFFFFFFFF;
+	while (len && ((uintptr_t) buf & 7)) {
+		c0 = _mm_crc32_u8 ((uint32_t) c0, *buf++);
+		len--;
+	}
+
+	/* The crc32 instruction takes 3 cycles but can start every cycle, so three 	*/
+	/* blocks are calculated at once and the CRCs are combined at the end 			*/
+	while (len >= CefC_Crc32c_Long * 3) {
+		c1 = 0;
+		c2 = 0;
+		end = buf + CefC_Crc32c_Long;
+		do {
+			c0 = _mm_crc32_u64 (c0, cef_valid_crc32c_load64 (buf));
+			c1 = _mm_crc32_u64 (c1, cef_valid_crc32c_load64 (buf + CefC_Crc32c_Long));
+			c2 = _mm_crc32_u64 (c2, cef_valid_crc32c_load64 (buf + CefC_Crc32c_Long * 2));
+			buf += 8;
+		} while (buf < end);
+		c0 = cef_valid_crc32c_shift (crc32c_long, (uint32_t) c0) ^ c1;
+		c0 = cef_valid_crc32c_shift (crc32c_long, (uint32_t) c0) ^ c2;
+		buf += CefC_Crc32c_Long * 2;
+		len -= CefC_Crc32c_Long * 3;
+	}
+	while (len >= CefC_Crc32c_Short * 3) {
+		c1 = 0;
+		c2 = 0;
+		end = buf + CefC_Crc32c_Short;
+		do {
+			c0 = _mm_crc32_u64 (c0, cef_valid_crc32c_load64 (buf));
+			c1 = _mm_crc32_u64 (c1, cef_valid_crc32c_load64 (buf + CefC_Crc32c_Short));
+			c2 = _mm_crc32_u64 (c2, cef_valid_crc32c_load64 (buf + CefC_Crc32c_Short * 2));
+			buf += 8;
+		} while (buf < end);
+		c0 = cef_valid_crc32c_shift (crc32c_short, (uint32_t) c0) ^ c1;
+		c0 = cef_valid_crc32c_shift (crc32c_short, (uint32_t) c0) ^ c2;
+		buf += CefC_Crc32c_Short * 2;
+		len -= CefC_Crc32c_Short * 3;
+	}
+
+	while (len >= 8) {
+		c0 = _mm_crc32_u64 (c0, cef_valid_crc32c_load64 (buf));
+		buf += 8;
+		len -= 8;
+	}
+	while (len--) {
+		c0 = _mm_crc32_u8 ((uint32_t) c0, *buf++);
+	}
+	return ((uint32_t) c0 ^ 0xFFFFFFFF);
+}
+
+/*--------------------------------------------------------------------------------------
+	Functions of the matrices over GF(2) which shift the CRC by zeros
+	(c.f. crc32_combine of zlib)
+----------------------------------------------------------------------------------------*/
+static uint32_t
+cef_valid_gf2_matrix_times (
+	const uint32_t* mat,
+	uint32_t vec
+) {
+	uint32_t sum = 0;
+
+	while (vec) {
+		if (vec & 1) {
+			sum ^= *mat;
+		}
+		vec >>= 1;
+		mat++;
+	}
+	return (sum);
+}
+
+static void
+cef_valid_gf2_matrix_square (
+	uint32_t* square,
+	const uint32_t* mat
+) {
+	int n;
+
+	for (n = 0 ; n < 32 ; n++) {
+		square[n] = cef_valid_gf2_matrix_times (mat, mat[n]);
+	}
+}
+
+/*--------------------------------------------------------------------------------------
+	Makes the table which shifts the CRC by len bytes of zeros (len is a power of 2)
+----------------------------------------------------------------------------------------*/
+static void
+cef_valid_crc32c_zeros (
+	uint32_t zeros[][256],
+	size_t len
+) {
+	uint32_t even[32];							/* Operator of even powers of 2 bits	*/
+	uint32_t odd[32];							/* Operator of odd powers of 2 bits		*/
+	uint32_t* op;
+	uint32_t row;
+	int n;
+
+	/* Operator for one zero bit 		*/
+	odd[0] = CefC_Crc32c_Poly;
+	row = 1;
+	for (n = 1 ; n < 32 ; n++) {
+		odd[n] = row;
+		row <<= 1;
+	}
+	cef_valid_gf2_matrix_square (even, odd);	/* 2 bits	*/
+	cef_valid_gf2_matrix_square (odd, even);	/* 4 bits	*/
+
+	/* Squares the operator from one byte until len is rotated down to zero 	*/
+	op = even;
+	do {
+		cef_valid_gf2_matrix_square (even, odd);
+		op = even;
+		len >>= 1;
+		if (len == 0) {
+			break;
+		}
+		cef_valid_gf2_matrix_square (odd, even);
+		op = odd;
+		len >>= 1;
+	} while (len);
+
+	for (n = 0 ; n < 256 ; n++) {
+		zeros[0][n] = cef_valid_gf2_matrix_times (op, n);
+		zeros[1][n] = cef_valid_gf2_matrix_times (op, n << 8);
+		zeros[2][n] = cef_valid_gf2_matrix_times (op, n << 16);
+		zeros[3][n] = cef_valid_gf2_matrix_times (op, n << 24);
+	}
+}
+#endif // CefC_Crc32c_Sse42_Enable
+
 int
 cef_valid_keyid_create (
 	unsigned char* name,
@@ -601,6 +978,47 @@ cef_valid_msg_verify (
 	return (res);
 }
 
+int 								/* 1 if the message is signed with RSA-SHA256		*/
+cef_valid_msg_pubkey_signed (
+	const unsigned char* msg,
+	int msg_len
+) {
+	struct fixed_hdr* 	fixed_hp;
+	struct tlv_hdr* 	tlv_ptr;
+	uint16_t 	index;
+	uint16_t 	hdr_len;
+	uint16_t 	val_len;
+
+	if (msg_len < CefC_S_Fix_Header + CefC_S_TLF) {
+		return (0);
+	}
+	fixed_hp = (struct fixed_hdr*) msg;
+	if (ntohs (fixed_hp->pkt_len) != msg_len) {
+		return (0);
+	}
+	hdr_len = fixed_hp->hdr_len;
+
+	/* Skips the CCN message 		*/
+	if (hdr_len + CefC_S_TLF > msg_len) {
+		return (0);
+	}
+	tlv_ptr = (struct tlv_hdr*) &msg[hdr_len];
+	val_len = ntohs (tlv_ptr->length);
+	index = hdr_len + CefC_S_TLF + val_len;
+	if (index + CefC_S_TLF + CefC_S_TLF > msg_len) {
+		return (0);
+	}
+
+	/* Checks Algorithm Type 		*/
+	tlv_ptr = (struct tlv_hdr*) &msg[index];
+	if (ntohs (tlv_ptr->type) != CefC_T_VALIDATION_ALG) {
+		return (0);
+	}
+	tlv_ptr = (struct tlv_hdr*) &msg[index + CefC_S_TLF];
+
+	return ((ntohs (tlv_ptr->type) == CefC_T_RSA_SHA256) ? 1 : 0);
+}
+
 int
 cef_valid_keyid_create_forccninfo (
 	unsigned char* pubkey,
@@ -959,8 +1377,10 @@ cef_valid_rsa_sha256_std_verify (
 	uint16_t 			length;
 	unsigned char 		hash[SHA256_DIGEST_LENGTH];
 	int 				res;
-	unsigned char* 		pub_key_bi;
-	int 				pub_key_bi_len;
+	const unsigned char* keyid = NULL;
+	int 				bound_f;
+	unsigned char 		vkey_src[SHA256_DIGEST_LENGTH * 2];
+	unsigned char 		vkey[SHA256_DIGEST_LENGTH];
 	EVP_PKEY*			pub_key;
 
 	/* Obtains the Name 		*/
@@ -973,14 +1393,21 @@ cef_valid_rsa_sha256_std_verify (
 	{
 		uint16_t 		pkey_offset;
 		uint16_t 		type;
-		unsigned char* 	ptr_for_free;
 
 		pkey_offset = alg_offset;
 		pkey_offset += CefC_S_TLF; 			/* Move offset by TL size of T_VALIDATION_ALG	*/
 		pkey_offset += CefC_S_TLF; 			/* Move offset by TL size of T_RSA-SHA256		*/
 		tlv_ptr = (struct tlv_hdr*) 		/* Move offset by TLV size of T_KEYID			*/
 					&msg[pkey_offset];
+		type = ntohs (tlv_ptr->type);
 		length = ntohs (tlv_ptr->length);
+		if ((type == CefC_T_KEYID) && (length == CefC_S_TLF + SHA256_DIGEST_LENGTH)) {
+			tlv_ptr = (struct tlv_hdr*) &msg[pkey_offset + CefC_S_TLF];
+			if ((ntohs (tlv_ptr->type) == CefC_T_SHA_256) &&
+				(ntohs (tlv_ptr->length) == SHA256_DIGEST_LENGTH)) {
+				keyid = &msg[pkey_offset + CefC_S_TLF + CefC_S_TLF];
+			}
+		}
 		pkey_offset += (CefC_S_TLF + length);
 		/* Obtain */
 		tlv_ptr = (struct tlv_hdr*) &msg[pkey_offset];
@@ -989,13 +1416,8 @@ cef_valid_rsa_sha256_std_verify (
 		if (type != CefC_T_PUBLICKEY) {
 			return (1);
 		}
-		length = ntohs (tlv_ptr->length);
-		ptr_for_free = pub_key_bi = (unsigned char*)calloc(length, 1);
-		pub_key_bi_len = length;
-		memcpy (pub_key_bi, &msg[pkey_offset+CefC_S_TLF], pub_key_bi_len);
-
-		pub_key = cef_valid_d2i_rsa_pubkey ((const unsigned char**)&pub_key_bi, pub_key_bi_len);
-		free(ptr_for_free);
+		pub_key = cef_valid_pkey_cache_get (
+					keyid, &msg[pkey_offset+CefC_S_TLF], length, &bound_f);
 		if (pub_key == NULL) {
 			return (1);
 		}
@@ -1009,10 +1431,29 @@ cef_valid_rsa_sha256_std_verify (
 //	SHA256 (&msg[hdr_len], pld_offset - hdr_len, hash);
 	cef_valid_sha256( &msg[hdr_len], pld_offset - hdr_len, hash );	/* for OpenSSL 3.x */
 
+	/* A retransmitted message whose signed part and signature have been 		*/
+	/* verified with the same key is accepted without the RSA operation 		*/
+	if (bound_f) {
+		memcpy (vkey_src, hash, SHA256_DIGEST_LENGTH);
+		cef_valid_sha256 (&msg[index], length, &vkey_src[SHA256_DIGEST_LENGTH]);
+		cef_valid_sha256 (vkey_src, sizeof (vkey_src), vkey);
+	}
+	if (bound_f && cef_valid_verified_lookup (vkey, keyid)) {
+		EVP_PKEY_free (pub_key);
+#ifdef CefC_Debug
+		cef_dbg_write (CefC_Dbg_Finest, "[SHA256] validation is OK (verified before)\n");
+#endif // CefC_Debug
+		return (0);
+	}
+
 	res = cef_valid_rsa_verify (
 		NID_sha256, hash, SHA256_DIGEST_LENGTH, &msg[index], length, pub_key);
 	EVP_PKEY_free (pub_key);
 
+	if ((res == 1) && bound_f) {
+		cef_valid_verified_insert (vkey, keyid);
+	}
+
 #ifdef CefC_Debug
 	cef_dbg_write (CefC_Dbg_Finest,
 		"[SHA256] validation is %s\n", (res == 1) ? "OK" : "NG");
@@ -1470,11 +1911,39 @@ cef_valid_sha256_keypath_ccninfoRT(
 static void
 cef_valid_crc32c_init (
 	void
+) {
+	cef_valid_crc32c_impl_set (CefC_Crc32c_Impl_Auto);
+}
+
+static void
+cef_valid_crc32c_tables_init (
+	void
 ) {
     /*
     Castagnoli CRC32 (iSCSI, ext4, etc.) with normal form polynomial 0x1EDC6F41.
     From "Description" of "Table 10: CCNx Validation Types" of RFC8609.
     */
+	uint32_t n, k, v;
+
+	/* Tables of slicing-by-8 with the reflected polynomial 	*/
+	for (n = 0 ; n < 256 ; n++) {
+		v = n;
+		for (k = 0 ; k < 8 ; k++) {
+			v = (v & 1) ? (v >> 1) ^ CefC_Crc32c_Poly : (v >> 1);
+		}
+		crc32c_slice[0][n] = v;
+	}
+	for (n = 0 ; n < 256 ; n++) {
+		v = crc32c_slice[0][n];
+		for (k = 1 ; k < 8 ; k++) {
+			v = crc32c_slice[0][v & 0xFF] ^ (v >> 8);
+			crc32c_slice[k][n] = v;
+		}
+	}
+#ifdef CefC_Crc32c_Sse42_Enable
+	cef_valid_crc32c_zeros (crc32c_long, CefC_Crc32c_Long);
+	cef_valid_crc32c_zeros (crc32c_short, CefC_Crc32c_Short);
+#endif // CefC_Crc32c_Sse42_Enable
 
 #ifdef CRC32C_POLY
     uint32_t i, c;
@@ -1839,6 +2308,202 @@ err:
 	return ret;
 }
 
+static EVP_PKEY*					/* The caller must free it with EVP_PKEY_free		*/
+cef_valid_pkey_cache_get (
+	const unsigned char*	keyid,			/* KeyId (32 bytes), or NULL				*/
+	const unsigned char*	pub_key_bi,
+	int						pub_key_bi_len,
+	int*					bound_f			/* Set to 1 if the KeyId is the SHA-256 of	*/
+											/* the public key							*/
+) {
+	CefT_Valid_Pkey* 		ent = NULL;
+	EVP_PKEY*				pub_key;
+	const unsigned char*	ptr;
+	unsigned char* 			bi;
+	unsigned char 			hash[SHA256_DIGEST_LENGTH];
+
+	*bound_f = 0;
+
+	if (keyid) {
+		ent = &pkey_cache[(keyid[0] | (keyid[1] << 8)) & (CefC_Valid_Pkey_Cache_Num - 1)];
+
+		pthread_mutex_lock (&pkey_cache_mutex);
+		if ((ent->pub_key) &&
+			(ent->pub_key_bi_len == pub_key_bi_len) &&
+			(memcmp (ent->keyid, keyid, SHA256_DIGEST_LENGTH) == 0) &&
+			(memcmp (ent->pub_key_bi, pub_key_bi, pub_key_bi_len) == 0)) {
+			pub_key = ent->pub_key;
+			EVP_PKEY_up_ref (pub_key);
+			pthread_mutex_unlock (&pkey_cache_mutex);
+			*bound_f = 1;
+			return (pub_key);
+		}
+		pthread_mutex_unlock (&pkey_cache_mutex);
+	}
+
+	ptr = pub_key_bi;
+	pub_key = cef_valid_d2i_rsa_pubkey (&ptr, pub_key_bi_len);
+	if ((pub_key == NULL) || (keyid == NULL)) {
+		return (pub_key);
+	}
+
+	/* Caches only the key which the KeyId actually identifies, so that the 	*/
+	/* KeyId can be trusted as the name of the key by the verified LRU			*/
+	cef_valid_sha256 (pub_key_bi, pub_key_bi_len, hash);
+	if (memcmp (hash, keyid, SHA256_DIGEST_LENGTH) != 0) {
+		return (pub_key);
+	}
+	*bound_f = 1;
+
+	bi = (unsigned char*) malloc (pub_key_bi_len);
+	if (bi == NULL) {
+		return (pub_key);
+	}
+	memcpy (bi, pub_key_bi, pub_key_bi_len);
+	EVP_PKEY_up_ref (pub_key);
+
+	pthread_mutex_lock (&pkey_cache_mutex);
+	if (ent->pub_key) {
+		EVP_PKEY_free (ent->pub_key);
+		free (ent->pub_key_bi);
+	}
+	memcpy (ent->keyid, keyid, SHA256_DIGEST_LENGTH);
+	ent->pub_key_bi 	= bi;
+	ent->pub_key_bi_len = pub_key_bi_len;
+	ent->pub_key 		= pub_key;
+	pthread_mutex_unlock (&pkey_cache_mutex);
+
+	return (pub_key);
+}
+
+static int							/* 1 if it has been verified						*/
+cef_valid_verified_lookup (
+	const unsigned char*	digest,
+	const unsigned char*	keyid
+) {
+	int idx;
+
+	pthread_mutex_lock (&verified_mutex);
+	if (verified_ent == NULL) {
+		pthread_mutex_unlock (&verified_mutex);
+		return (0);
+	}
+	idx = verified_bucket[CefC_Valid_Verified_Bucket (digest, keyid)];
+
+	while (idx >= 0) {
+		if ((memcmp (verified_ent[idx].digest, digest, SHA256_DIGEST_LENGTH) == 0) &&
+			(memcmp (verified_ent[idx].keyid, keyid, SHA256_DIGEST_LENGTH) == 0)) {
+			if (idx != verified_head) {
+				cef_valid_verified_lru_unlink (idx);
+				cef_valid_verified_lru_push (idx);
+			}
+			pthread_mutex_unlock (&verified_mutex);
+			return (1);
+		}
+		idx = verified_ent[idx].chain;
+	}
+	pthread_mutex_unlock (&verified_mutex);
+
+	return (0);
+}
+
+static void
+cef_valid_verified_insert (
+	const unsigned char*	digest,
+	const unsigned char*	keyid
+) {
+	CefT_Valid_Verified* ent;
+	int* 	prev_p;
+	int 	bucket;
+	int 	idx;
+	int 	i;
+
+	pthread_mutex_lock (&verified_mutex);
+	if (verified_ent == NULL) {
+		verified_ent = (CefT_Valid_Verified*)
+			malloc (sizeof (CefT_Valid_Verified) * CefC_Valid_Verified_Num);
+		verified_bucket = (int*) malloc (sizeof (int) * CefC_Valid_Verified_Num);
+		if ((verified_ent == NULL) || (verified_bucket == NULL)) {
+			free (verified_ent);
+			free (verified_bucket);
+			verified_ent 	= NULL;
+			verified_bucket = NULL;
+			pthread_mutex_unlock (&verified_mutex);
+			return;
+		}
+		for (i = 0 ; i < CefC_Valid_Verified_Num ; i++) {
+			verified_bucket[i] = -1;
+		}
+	}
+	bucket = CefC_Valid_Verified_Bucket (digest, keyid);
+
+	/* Another thread may have verified the same signature meanwhile 	*/
+	for (idx = verified_bucket[bucket] ; idx >= 0 ; idx = verified_ent[idx].chain) {
+		if ((memcmp (verified_ent[idx].digest, digest, SHA256_DIGEST_LENGTH) == 0) &&
+			(memcmp (verified_ent[idx].keyid, keyid, SHA256_DIGEST_LENGTH) == 0)) {
+			pthread_mutex_unlock (&verified_mutex);
+			return;
+		}
+	}
+
+	if (verified_num < CefC_Valid_Verified_Num) {
+		idx = verified_num;
+		verified_num++;
+	} else {
+		/* Evicts the least recently verified one 	*/
+		idx = verified_tail;
+		ent = &verified_ent[idx];
+		cef_valid_verified_lru_unlink (idx);
+
+		prev_p = &verified_bucket[CefC_Valid_Verified_Bucket (ent->digest, ent->keyid)];
+		while (*prev_p != idx) {
+			prev_p = &verified_ent[*prev_p].chain;
+		}
+		*prev_p = ent->chain;
+	}
+	ent = &verified_ent[idx];
+	memcpy (ent->digest, digest, SHA256_DIGEST_LENGTH);
+	memcpy (ent->keyid, keyid, SHA256_DIGEST_LENGTH);
+	ent->chain = verified_bucket[bucket];
+	verified_bucket[bucket] = idx;
+	cef_valid_verified_lru_push (idx);
+	pthread_mutex_unlock (&verified_mutex);
+}
+
+static void
+cef_valid_verified_lru_unlink (
+	int idx
+) {
+	CefT_Valid_Verified* ent = &verified_ent[idx];
+
+	if (ent->prev >= 0) {
+		verified_ent[ent->prev].next = ent->next;
+	} else {
+		verified_head = ent->next;
+	}
+	if (ent->next >= 0) {
+		verified_ent[ent->next].prev = ent->prev;
+	} else {
+		verified_tail = ent->prev;
+	}
+}
+
+static void
+cef_valid_verified_lru_push (
+	int idx
+) {
+	CefT_Valid_Verified* ent = &verified_ent[idx];
+
+	ent->prev = -1;
+	ent->next = verified_head;
+	if (verified_head >= 0) {
+		verified_ent[verified_head].prev = idx;
+	} else {
+		verified_tail = idx;
+	}
+	verified_head = idx;
+}
+
 int
 cef_valid_get_keyid_from_specified_pubkey (
 	const char* key_path,	// path of publickey
@@ -220,6 +220,56 @@ cef_plugin_tag_get (
 	return (NULL);
 }
 
+/*--------------------------------------------------------------------------------------
+	Sets the copy of the specified message to the TX element
+----------------------------------------------------------------------------------------*/
+int 												/* Returns a negative value if it 	*/
+													/* fails 							*/
+cef_plugin_tx_elem_msg_set (
+	CefT_Tx_Elem* 		tx_elem,					/* TX element 						*/
+	const unsigned char* msg,						/* message 							*/
+	uint16_t 			msg_len						/* length of the message 			*/
+) {
+	/* The buffer is sized to the message, not to CefC_Max_Msg_Size 	*/
+	tx_elem->pkt = cef_pktbuf_alloc (msg_len);
+	if (tx_elem->pkt == NULL) {
+		tx_elem->msg = NULL;
+		tx_elem->msg_len = 0;
+		return (-1);
+	}
+	memcpy (tx_elem->pkt->data, msg, msg_len);
+	tx_elem->msg = tx_elem->pkt->data;
+	tx_elem->msg_len = msg_len;
+
+	return (0);
+}
+
+/*--------------------------------------------------------------------------------------
+	Lets the TX element refer to the message of the other one without copying it
+----------------------------------------------------------------------------------------*/
+void
+cef_plugin_tx_elem_msg_share (
+	CefT_Tx_Elem* 		tx_elem,					/* TX element 						*/
+	const CefT_Tx_Elem* src_elem					/* TX element which has the message */
+) {
+	tx_elem->pkt = cef_pktbuf_ref (src_elem->pkt);
+	tx_elem->msg = src_elem->msg;
+	tx_elem->msg_len = src_elem->msg_len;
+}
+
+/*--------------------------------------------------------------------------------------
+	Releases the message of the TX element and frees the element
+----------------------------------------------------------------------------------------*/
+void
+cef_plugin_tx_elem_free (
+	CefT_Mp_Handle 		tx_que_mp,					/* Memory Pool for CefT_Tx_Elem 	*/
+	CefT_Tx_Elem* 		tx_elem						/* TX element 						*/
+) {
+	cef_pktbuf_release (tx_elem->pkt);
+	tx_elem->pkt = NULL;
+	cef_mpool_free (tx_que_mp, tx_elem);
+}
+
 /*--------------------------------------------------------------------------------------
 	Gets values of specified tag and parameter
 ----------------------------------------------------------------------------------------*/
@@ -143,20 +143,23 @@ cef_plugin_samptp_cob (
 	if (idx > 0) {
 		/* Creates the forward object 				*/
 		tx_elem = (CefT_Tx_Elem*) cef_mpool_alloc (tp->tx_que_mp);
+		memset (tx_elem, 0, sizeof (CefT_Tx_Elem));
 		tx_elem->type 		= CefC_Elem_Type_Object;
-		tx_elem->msg_len 	= rx_elem->msg_len;
 		tx_elem->faceid_num = idx;
 
 		for (i = 0 ; i < idx ; i++) {
 			tx_elem->faceids[i] = faceids[i];
 		}
-		memcpy (tx_elem->msg, rx_elem->msg, rx_elem->msg_len);
+		if (cef_plugin_tx_elem_msg_set (tx_elem, rx_elem->msg, rx_elem->msg_len) < 0) {
+			cef_mpool_free (tp->tx_que_mp, tx_elem);
+			return (CefC_Pi_Object_NoSend);
+		}
 
 		/* Pushes the forward object to tx buffer	*/
 		i = cef_rngque_push (tp->tx_que, tx_elem);
 
 		if (i < 1) {
-			cef_mpool_free (tp->tx_que_mp, tx_elem);
+			cef_plugin_tx_elem_free (tp->tx_que_mp, tx_elem);
 		}
 		/* Updates statistics 		*/
 		m_stat_cob_tx += idx;
@@ -181,20 +184,23 @@ cef_plugin_samptp_interest (
 
 	/* Creates the forward object 				*/
 	tx_elem = (CefT_Tx_Elem*) cef_mpool_alloc (tp->tx_que_mp);
+	memset (tx_elem, 0, sizeof (CefT_Tx_Elem));
 	tx_elem->type 		= CefC_Elem_Type_Interest;
-	tx_elem->msg_len 	= rx_elem->msg_len;
 	tx_elem->faceid_num = rx_elem->out_faceid_num;
 
 	for (i = 0 ; i < rx_elem->out_faceid_num ; i++) {
 		tx_elem->faceids[i] = rx_elem->out_faceids[i];
 	}
-	memcpy (tx_elem->msg, rx_elem->msg, rx_elem->msg_len);
+	if (cef_plugin_tx_elem_msg_set (tx_elem, rx_elem->msg, rx_elem->msg_len) < 0) {
+		cef_mpool_free (tp->tx_que_mp, tx_elem);
+		return (CefC_Pi_Interest_NoSend);
+	}
 
 	/* Pushes the forward object to tx buffer	*/
 	i = cef_rngque_push (tp->tx_que, tx_elem);
 
 	if (i < 1) {
-		cef_mpool_free (tp->tx_que_mp, tx_elem);
+		cef_plugin_tx_elem_free (tp->tx_que_mp, tx_elem);
 	}
 
 	/* Updates statistics 		*/
@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefhashbench.c
+ */
+
+#define __CEF_HASHBENCH_SOURCE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <cefore/cef_define.h>
+#include <cefore/cef_frame.h>
+#include <cefore/cef_hash.h>
+#include <cefore/cef_log.h>
+
+
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+#define	USAGE			print_usage(CefFp_Usage)
+#define	printerr(...)	fprintf(stderr,"[cefhashbench] ERROR: " __VA_ARGS__)
+
+#define CefhbC_Default_Lookups	5000000		/* Lookups of each kind per table size		*/
+#define CefhbC_Default_Fill		100			/* Percentage of the table which is filled	*/
+#define CefhbC_Max_Sizes		8
+#define CefhbC_Chunks			64			/* Chunks of each content					*/
+#define CefhbC_Key_Len			32			/* Length of the names						*/
+#define CefhbC_Stride			2654435761u	/* Visits the entries in a scattered order	*/
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/***** Results of a table size *****/
+typedef struct {
+	double 		create;						/* Creation (ms)							*/
+	double 		insert;						/* Per insertion (ns)						*/
+	double 		hit;						/* Per lookup of a stored name (ns)			*/
+	double 		miss;						/* Per lookup of an unknown name (ns)		*/
+	double 		remove;						/* Per removal (ns)							*/
+	double 		key;						/* Per creation of a name (ns)				*/
+} CefhbT_Result;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+);
+/*--------------------------------------------------------------------------------------
+	Creates the name of the n-th chunk, as cefnetd looks up the PIT and the FIB
+----------------------------------------------------------------------------------------*/
+static void
+bench_key_create (
+	unsigned char key[],					/* CefhbC_Key_Len bytes						*/
+	uint64_t n
+);
+/*--------------------------------------------------------------------------------------
+	Measures the table of the specified size
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+bench_run (
+	uint32_t entries,
+	uint32_t lookups,
+	int fill,								/* Percentage of the table to fill			*/
+	CefhbT_Result* res
+);
+/*--------------------------------------------------------------------------------------
+	Elapsed time between two times (sec)
+----------------------------------------------------------------------------------------*/
+static double
+bench_elapsed (
+	struct timeval* t_start,
+	struct timeval* t_end
+);
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+);
+
+
+/****************************************************************************************
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+) {
+	CefhbT_Result res;
+	uint32_t sizes[CefhbC_Max_Sizes];
+	char* work_arg;
+	int size_num = 0;
+	long long val;
+	int i;
+
+	/***** parameters 	*****/
+	uint32_t lookups 	= CefhbC_Default_Lookups;
+	int fill 			= CefhbC_Default_Fill;
+
+	/* Obtains options 		*/
+	for (i = 1 ; i < argc ; i++) {
+
+		work_arg = argv[i];
+		if (work_arg == NULL || work_arg[0] == 0) {
+			break;
+		}
+
+		if ((strcmp (work_arg, "-n") == 0) && (i + 1 < argc)) {
+			if (size_num == CefhbC_Max_Sizes) {
+				printerr("-n can be specified up to %d times.\n", CefhbC_Max_Sizes);
+				USAGE;
+				return (-1);
+			}
+			val = atoll (argv[++i]);
+			if (val < 1 || val > 16777215) {
+				printerr("entries must be 1 to 16777215.\n");
+				USAGE;
+				return (-1);
+			}
+			sizes[size_num++] = (uint32_t) val;
+		} else if ((strcmp (work_arg, "-l") == 0) && (i + 1 < argc)) {
+			val = atoll (argv[++i]);
+			if (val < 1 || val > UINT32_MAX) {
+				printerr("lookups must be higher than 0.\n");
+				USAGE;
+				return (-1);
+			}
+			lookups = (uint32_t) val;
+		} else if ((strcmp (work_arg, "-f") == 0) && (i + 1 < argc)) {
+			fill = atoi (argv[++i]);
+			if (fill < 1 || fill > 100) {
+				printerr("fill must be 1 to 100.\n");
+				USAGE;
+				return (-1);
+			}
+		} else {
+			printerr("unknown option is specified.\n");
+			USAGE;
+			return (-1);
+		}
+	}
+	if (size_num == 0) {
+		sizes[size_num++] = 1000000;
+		sizes[size_num++] = 10000000;
+	}
+
+	cef_log_init ("cefhashbench", 1);
+	fprintf (stdout, "Lookups  : %u of each kind per table\n", lookups);
+	fprintf (stdout, "Fill     : %d%% of the table size\n", fill);
+	fprintf (stdout, "Names    : %d bytes, %d chunks per content\n\n",
+		CefhbC_Key_Len, CefhbC_Chunks);
+	fprintf (stdout, "%10s %12s %12s %12s %12s %12s\n",
+		"Entries", "Create(ms)", "Insert(ns)", "Hit(ns)", "Miss(ns)", "Remove(ns)");
+
+	for (i = 0 ; i < size_num ; i++) {
+		if (bench_run (sizes[i], lookups, fill, &res) < 0) {
+			return (-1);
+		}
+		fprintf (stdout, "%10u %12.1f %12.1f %12.1f %12.1f %12.1f\n", sizes[i],
+			res.create, res.insert, res.hit, res.miss, res.remove);
+	}
+	fprintf (stdout, "\nThe times per operation exclude %.1f ns to create a name.\n", res.key);
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Creates the name of the n-th chunk, as cefnetd looks up the PIT and the FIB
+----------------------------------------------------------------------------------------*/
+static void
+bench_key_create (
+	unsigned char key[],					/* CefhbC_Key_Len bytes						*/
+	uint64_t n
+) {
+	uint64_t content = n / CefhbC_Chunks;
+	uint32_t chunk = (uint32_t)(n % CefhbC_Chunks);
+	int i;
+
+	/* /bench/<content>/Chunk=<chunk> 	*/
+	key[0]  = 0x00;		key[1]  = CefC_T_NAMESEGMENT;
+	key[2]  = 0x00;		key[3]  = 5;
+	memcpy (&key[4], "bench", 5);
+	key[9]  = 0x00;		key[10] = CefC_T_NAMESEGMENT;
+	key[11] = 0x00;		key[12] = 11;
+	memcpy (&key[13], "obj", 3);
+	for (i = 0 ; i < 8 ; i++) {
+		key[16 + i] = (unsigned char)(content >> (56 - i * 8));
+	}
+	key[24] = 0x00;		key[25] = CefC_T_CHUNK;
+	key[26] = 0x00;		key[27] = 4;
+	key[28] = (unsigned char)(chunk >> 24);
+	key[29] = (unsigned char)(chunk >> 16);
+	key[30] = (unsigned char)(chunk >> 8);
+	key[31] = (unsigned char)(chunk);
+}
+/*--------------------------------------------------------------------------------------
+	Measures the table of the specified size
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+bench_run (
+	uint32_t entries,
+	uint32_t lookups,
+	int fill,								/* Percentage of the table to fill			*/
+	CefhbT_Result* res
+) {
+	struct timeval t_start, t_end;
+	CefT_Hash_Handle tbl;
+	unsigned char key[CefhbC_Key_Len];
+	volatile uintptr_t sink = 0;
+	uint64_t n;
+	uint64_t size;
+	uint32_t i;
+	int found = 0;
+
+	memset (res, 0, sizeof (CefhbT_Result));
+	size = (uint64_t) entries * 100 / fill;
+	if (size > UINT32_MAX) {
+		size = UINT32_MAX;
+	}
+
+	gettimeofday (&t_start, NULL);
+	tbl = cef_hash_tbl_create ((uint32_t) size);
+	gettimeofday (&t_end, NULL);
+	if (tbl == (CefT_Hash_Handle) NULL) {
+		printerr("failed to create the table of " FMTU64 " entries.\n", size);
+		return (-1);
+	}
+	res->create = bench_elapsed (&t_start, &t_end) * 1000.0;
+
+	/* Cost of creating the names, which is subtracted from the results 	*/
+	gettimeofday (&t_start, NULL);
+	for (i = 0 ; i < lookups ; i++) {
+		bench_key_create (key, (uint64_t) i * CefhbC_Stride % entries);
+		sink += key[CefhbC_Key_Len - 1];
+	}
+	gettimeofday (&t_end, NULL);
+	res->key = bench_elapsed (&t_start, &t_end) * 1000000000.0 / lookups;
+
+	/* Elements are the index + 1 so that none of them is NULL 	*/
+	gettimeofday (&t_start, NULL);
+	for (n = 0 ; n < entries ; n++) {
+		bench_key_create (key, n);
+		if (cef_hash_tbl_item_set (tbl, key, CefhbC_Key_Len, (void*)(uintptr_t)(n + 1)) < 0) {
+			printerr("failed to insert the entry %u of %u.\n", (uint32_t) n, entries);
+			cef_hash_tbl_destroy (tbl);
+			return (-1);
+		}
+	}
+	gettimeofday (&t_end, NULL);
+	res->insert = bench_elapsed (&t_start, &t_end) * 1000000000.0 / entries - res->key;
+
+	gettimeofday (&t_start, NULL);
+	for (i = 0 ; i < lookups ; i++) {
+		n = (uint64_t) i * CefhbC_Stride % entries;
+		bench_key_create (key, n);
+		if ((uintptr_t) cef_hash_tbl_item_get (tbl, key, CefhbC_Key_Len) == n + 1) {
+			found++;
+		}
+	}
+	gettimeofday (&t_end, NULL);
+	res->hit = bench_elapsed (&t_start, &t_end) * 1000000000.0 / lookups - res->key;
+	if (found != (int) lookups) {
+		printerr("%u of %u stored names were not found.\n", lookups - found, lookups);
+		cef_hash_tbl_destroy (tbl);
+		return (-1);
+	}
+
+	gettimeofday (&t_start, NULL);
+	for (i = 0 ; i < lookups ; i++) {
+		bench_key_create (key, entries + (uint64_t) i * CefhbC_Stride % entries);
+		sink += (uintptr_t) cef_hash_tbl_item_get (tbl, key, CefhbC_Key_Len);
+	}
+	gettimeofday (&t_end, NULL);
+	res->miss = bench_elapsed (&t_start, &t_end) * 1000000000.0 / lookups - res->key;
+	if (sink & 1) {
+		printerr("unknown names were found.\n");
+	}
+
+	gettimeofday (&t_start, NULL);
+	for (n = 0 ; n < entries ; n++) {
+		bench_key_create (key, n);
+		cef_hash_tbl_item_remove (tbl, key, CefhbC_Key_Len);
+	}
+	gettimeofday (&t_end, NULL);
+	res->remove = bench_elapsed (&t_start, &t_end) * 1000000000.0 / entries - res->key;
+
+	cef_hash_tbl_destroy (tbl);
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Elapsed time between two times (sec)
+----------------------------------------------------------------------------------------*/
+static double
+bench_elapsed (
+	struct timeval* t_start,
+	struct timeval* t_end
+) {
+	return ((double)(t_end->tv_sec - t_start->tv_sec)
+				+ (double)(t_end->tv_usec - t_start->tv_usec) / 1000000.0);
+}
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+) {
+	fprintf (ofp,
+		"\n\nUsage: cefhashbench\n\n"
+		"  cefhashbench [-n entries ...] [-l lookups] [-f fill]\n\n"
+		"  entries    Entries of the table. -n can be specified up to 8 times.\n"
+		"             The default values are 1000000 and 10000000.\n"
+		"  lookups    Lookups of stored names and unknown names for each table.\n"
+		"             The default value is 5000000.\n"
+		"  fill       Percentage of the table size filled with the entries.\n"
+		"             The default value is 100.\n\n"
+	);
+	return;
+}
@@ -0,0 +1,519 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefparsebench.c
+ */
+
+#define __CEF_PARSEBENCH_SOURCE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <cefore/cef_frame.h>
+#include <cefore/cef_log.h>
+
+
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+#define	USAGE			print_usage(CefFp_Usage)
+#define	printerr(...)	fprintf(stderr,"[cefparsebench] ERROR: " __VA_ARGS__)
+
+#define CefpbC_Default_Repeat	20			/* Times to parse the capture				*/
+
+/*------------------------------------------------------------------*/
+/* Link types and magic numbers of pcap								*/
+/*------------------------------------------------------------------*/
+#define CefpbC_Pcap_Magic		0xa1b2c3d4	/* timestamps in usec						*/
+#define CefpbC_Pcap_Magic_Ns	0xa1b23c4d	/* timestamps in nsec						*/
+#define CefpbC_Pcap_Hdr_Len		24			/* global header							*/
+#define CefpbC_Pcap_Rec_Len		16			/* record header							*/
+
+#define CefpbC_Link_Null		0			/* BSD loopback								*/
+#define CefpbC_Link_Ether		1			/* Ethernet									*/
+#define CefpbC_Link_Raw			101			/* Raw IP									*/
+#define CefpbC_Link_Sll			113			/* Linux cooked capture						*/
+#define CefpbC_Link_Sll2		276			/* Linux cooked capture v2					*/
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/***** CEFORE messages extracted from the capture *****/
+typedef struct {
+	unsigned char* 	buf;					/* Messages									*/
+	size_t 			len;					/* Bytes used in buf						*/
+	size_t 			size;					/* Size of buf								*/
+	uint32_t 		msg_num;				/* Number of the messages					*/
+	uint32_t 		int_num;				/* Number of the Interests					*/
+	uint32_t 		obj_num;				/* Number of the Content Objects			*/
+	uint64_t 		skip_bytes;				/* Bytes of payloads which are not parsed	*/
+} CefpbT_Msgs;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+);
+/*--------------------------------------------------------------------------------------
+	Reads the CEFORE messages carried over UDP and TCP from the pcap file
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+capture_read (
+	const char* path,						/* pcap file								*/
+	CefpbT_Msgs* msgs						/* Messages to return						*/
+);
+/*--------------------------------------------------------------------------------------
+	Obtains the UDP or TCP payload of the captured frame
+----------------------------------------------------------------------------------------*/
+static const unsigned char*					/* Payload, or NULL if it is not UDP or TCP	*/
+capture_payload_get (
+	const unsigned char* frame,
+	uint32_t frame_len,
+	uint32_t link_type,
+	uint32_t* payload_len
+);
+/*--------------------------------------------------------------------------------------
+	Appends the CEFORE messages in the payload
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+capture_msgs_add (
+	CefpbT_Msgs* msgs,
+	const unsigned char* payload,
+	uint32_t payload_len
+);
+/*--------------------------------------------------------------------------------------
+	Parses all messages repeatedly
+----------------------------------------------------------------------------------------*/
+static double								/* Elapsed time (sec)						*/
+bench_run (
+	CefpbT_Msgs* msgs,
+	int repeat,
+	int msghash_f							/* Obtains MsgHash of each message if 1		*/
+);
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+);
+
+
+/****************************************************************************************
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+) {
+	static const char* modes[] = { "parse", "parse+msghash" };
+	CefpbT_Msgs msgs;
+	char* work_arg;
+	char* capture = NULL;
+	double elapsed;
+	double total_msgs, total_bytes;
+	int i;
+
+	/***** parameters 	*****/
+	int repeat 			= CefpbC_Default_Repeat;
+
+	/* Obtains options 		*/
+	for (i = 1 ; i < argc ; i++) {
+
+		work_arg = argv[i];
+		if (work_arg == NULL || work_arg[0] == 0) {
+			break;
+		}
+
+		if ((strcmp (work_arg, "-n") == 0) && (i + 1 < argc)) {
+			repeat = atoi (argv[++i]);
+			if (repeat < 1) {
+				printerr("repeat must be higher than 0.\n");
+				USAGE;
+				return (-1);
+			}
+		} else if (work_arg[0] == '-') {
+			printerr("unknown option is specified.\n");
+			USAGE;
+			return (-1);
+		} else {
+			if (capture) {
+				printerr("capture is duplicated.\n");
+				USAGE;
+				return (-1);
+			}
+			capture = work_arg;
+		}
+	}
+	if (capture == NULL) {
+		printerr("capture is not specified.\n");
+		USAGE;
+		return (-1);
+	}
+
+	cef_log_init ("cefparsebench", 1);
+	cef_frame_init ();
+	memset (&msgs, 0, sizeof (CefpbT_Msgs));
+	if (capture_read (capture, &msgs) < 0) {
+		free (msgs.buf);
+		return (-1);
+	}
+	if (msgs.msg_num == 0) {
+		printerr("%s has no CEFORE messages.\n", capture);
+		free (msgs.buf);
+		return (-1);
+	}
+	fprintf (stdout, "Capture  : %s (%u messages, %u Interests, %u Objects, %zu bytes)\n",
+		capture, msgs.msg_num, msgs.int_num, msgs.obj_num, msgs.len);
+	if (msgs.skip_bytes) {
+		fprintf (stdout, "Skipped  : " FMTU64 " bytes of payloads which are not parsed\n",
+			msgs.skip_bytes);
+	}
+	fprintf (stdout, "Repeat   : %d\n\n", repeat);
+	fprintf (stdout, "%-16s %14s %10s %10s\n", "Mode", "Messages/s", "MB/s", "Time(s)");
+
+	total_msgs  = (double) msgs.msg_num * repeat;
+	total_bytes = (double) msgs.len * repeat;
+	for (i = 0 ; i < 2 ; i++) {
+		elapsed = bench_run (&msgs, repeat, i);
+		if (elapsed <= 0.0) {
+			elapsed = 0.000001;
+		}
+		fprintf (stdout, "%-16s %14.0f %10.1f %10.3f\n", modes[i],
+			total_msgs / elapsed, total_bytes / elapsed / 1000000.0, elapsed);
+	}
+
+	free (msgs.buf);
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Reads the CEFORE messages carried over UDP and TCP from the pcap file
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+capture_read (
+	const char* path,						/* pcap file								*/
+	CefpbT_Msgs* msgs						/* Messages to return						*/
+) {
+	FILE* fp;
+	unsigned char hdr[CefpbC_Pcap_Hdr_Len];
+	unsigned char* frame;
+	const unsigned char* payload;
+	uint32_t magic, link_type, frame_len, payload_len;
+	int swap_f;
+	int res = 0;
+
+	fp = fopen (path, "rb");
+	if (fp == NULL) {
+		printerr("%s cannot be opened.\n", path);
+		return (-1);
+	}
+	if (fread (hdr, CefpbC_Pcap_Hdr_Len, 1, fp) != 1) {
+		printerr("%s is not a pcap file.\n", path);
+		fclose (fp);
+		return (-1);
+	}
+	memcpy (&magic, hdr, sizeof (uint32_t));
+	if ((magic == CefpbC_Pcap_Magic) || (magic == CefpbC_Pcap_Magic_Ns)) {
+		swap_f = 0;
+	} else if ((__builtin_bswap32 (magic) == CefpbC_Pcap_Magic) ||
+			   (__builtin_bswap32 (magic) == CefpbC_Pcap_Magic_Ns)) {
+		swap_f = 1;
+	} else {
+		printerr("%s is not a pcap file (pcapng is not supported).\n", path);
+		fclose (fp);
+		return (-1);
+	}
+	memcpy (&link_type, &hdr[20], sizeof (uint32_t));
+	if (swap_f) {
+		link_type = __builtin_bswap32 (link_type);
+	}
+	link_type &= 0xFFFF;
+
+	frame = (unsigned char*) malloc (CefC_Max_Msg_Size * 4);
+	if (frame == NULL) {
+		printerr("failed to allocate the buffer.\n");
+		fclose (fp);
+		return (-1);
+	}
+
+	while (fread (hdr, CefpbC_Pcap_Rec_Len, 1, fp) == 1) {
+		memcpy (&frame_len, &hdr[8], sizeof (uint32_t));
+		if (swap_f) {
+			frame_len = __builtin_bswap32 (frame_len);
+		}
+		if (frame_len > CefC_Max_Msg_Size * 4) {
+			printerr("%s has a too large frame (%u bytes).\n", path, frame_len);
+			res = -1;
+			break;
+		}
+		if (fread (frame, 1, frame_len, fp) != frame_len) {
+			break;
+		}
+		payload = capture_payload_get (frame, frame_len, link_type, &payload_len);
+		if (payload == NULL || payload_len == 0) {
+			continue;
+		}
+		if (capture_msgs_add (msgs, payload, payload_len) < 0) {
+			res = -1;
+			break;
+		}
+	}
+
+	free (frame);
+	fclose (fp);
+	return (res);
+}
+/*--------------------------------------------------------------------------------------
+	Obtains the UDP or TCP payload of the captured frame
+----------------------------------------------------------------------------------------*/
+static const unsigned char*					/* Payload, or NULL if it is not UDP or TCP	*/
+capture_payload_get (
+	const unsigned char* frame,
+	uint32_t frame_len,
+	uint32_t link_type,
+	uint32_t* payload_len
+) {
+	const unsigned char* ip;
+	uint32_t len, hlen;
+	uint16_t ether_type = 0;
+	uint8_t proto;
+
+	/* Link layer 		*/
+	switch (link_type) {
+		case CefpbC_Link_Ether: {
+			if (frame_len < 14) {
+				return (NULL);
+			}
+			ether_type = (frame[12] << 8) | frame[13];
+			hlen = 14;
+			while ((ether_type == 0x8100 || ether_type == 0x88a8) && (frame_len >= hlen + 4)) {
+				ether_type = (frame[hlen + 2] << 8) | frame[hlen + 3];
+				hlen += 4;
+			}
+			break;
+		}
+		case CefpbC_Link_Sll: {
+			if (frame_len < 16) {
+				return (NULL);
+			}
+			ether_type = (frame[14] << 8) | frame[15];
+			hlen = 16;
+			break;
+		}
+		case CefpbC_Link_Sll2: {
+			if (frame_len < 20) {
+				return (NULL);
+			}
+			ether_type = (frame[0] << 8) | frame[1];
+			hlen = 20;
+			break;
+		}
+		case CefpbC_Link_Null:
+		case CefpbC_Link_Raw: {
+			hlen = (link_type == CefpbC_Link_Null) ? 4 : 0;
+			if (frame_len <= hlen) {
+				return (NULL);
+			}
+			ether_type = ((frame[hlen] >> 4) == 6) ? 0x86dd : 0x0800;
+			break;
+		}
+		default: {
+			return (NULL);
+		}
+	}
+	ip  = frame + hlen;
+	len = frame_len - hlen;
+
+	/* Network layer 	*/
+	if (ether_type == 0x0800) {
+		if (len < 20 || (ip[0] >> 4) != 4) {
+			return (NULL);
+		}
+		/* Fragments after the first one are not parsed 	*/
+		if (((ip[6] & 0x1F) << 8 | ip[7]) != 0) {
+			return (NULL);
+		}
+		hlen = (ip[0] & 0x0F) * 4;
+		proto = ip[9];
+		if (((uint32_t)(ip[2] << 8 | ip[3])) < len) {
+			len = ip[2] << 8 | ip[3];
+		}
+	} else if (ether_type == 0x86dd) {
+		if (len < 40 || (ip[0] >> 4) != 6) {
+			return (NULL);
+		}
+		hlen = 40;
+		proto = ip[6];
+		if (((uint32_t)(ip[4] << 8 | ip[5])) + 40 < len) {
+			len = (ip[4] << 8 | ip[5]) + 40;
+		}
+	} else {
+		return (NULL);
+	}
+	if (len < hlen) {
+		return (NULL);
+	}
+	ip  += hlen;
+	len -= hlen;
+
+	/* Transport layer 	*/
+	if (proto == IPPROTO_UDP) {
+		hlen = 8;
+	} else if (proto == IPPROTO_TCP) {
+		if (len < 20) {
+			return (NULL);
+		}
+		hlen = (ip[12] >> 4) * 4;
+	} else {
+		return (NULL);
+	}
+	if (len < hlen) {
+		return (NULL);
+	}
+	*payload_len = len - hlen;
+	return (ip + hlen);
+}
+/*--------------------------------------------------------------------------------------
+	Appends the CEFORE messages in the payload
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+capture_msgs_add (
+	CefpbT_Msgs* msgs,
+	const unsigned char* payload,
+	uint32_t payload_len
+) {
+	struct fixed_hdr* chp;
+	unsigned char* new_buf;
+	uint16_t pkt_len;
+	uint32_t index = 0;
+
+	/* Messages which are split into several segments are skipped 	*/
+	while (payload_len - index >= CefC_S_Fix_Header) {
+		chp = (struct fixed_hdr*) &payload[index];
+		pkt_len = ntohs (chp->pkt_len);
+
+		if ((chp->ccn_ver != CefC_Version) || (chp->type > CefC_PT_MAX) ||
+			(chp->hdr_len < CefC_S_Fix_Header) || (pkt_len <= chp->hdr_len) ||
+			(pkt_len > payload_len - index)) {
+			break;
+		}
+		if (msgs->len + pkt_len > msgs->size) {
+			msgs->size = (msgs->size == 0) ? 1024 * 1024 : msgs->size * 2;
+			new_buf = (unsigned char*) realloc (msgs->buf, msgs->size);
+			if (new_buf == NULL) {
+				printerr("failed to allocate the buffer.\n");
+				return (-1);
+			}
+			msgs->buf = new_buf;
+		}
+		memcpy (&msgs->buf[msgs->len], &payload[index], pkt_len);
+		msgs->len += pkt_len;
+		msgs->msg_num++;
+		if (chp->type == CefC_PT_INTEREST) {
+			msgs->int_num++;
+		} else if (chp->type == CefC_PT_OBJECT) {
+			msgs->obj_num++;
+		}
+		index += pkt_len;
+	}
+	msgs->skip_bytes += payload_len - index;
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Parses all messages repeatedly
+----------------------------------------------------------------------------------------*/
+static double								/* Elapsed time (sec)						*/
+bench_run (
+	CefpbT_Msgs* msgs,
+	int repeat,
+	int msghash_f							/* Obtains MsgHash of each message if 1		*/
+) {
+	static CefT_CcnMsg_MsgBdy pm;
+	static CefT_CcnMsg_OptHdr poh;
+	struct timeval t_start, t_end;
+	struct fixed_hdr* chp;
+	uint16_t pkt_len;
+	size_t index;
+	int n;
+
+	gettimeofday (&t_start, NULL);
+	for (n = 0 ; n < repeat ; n++) {
+		for (index = 0 ; index < msgs->len ; index += pkt_len) {
+			chp = (struct fixed_hdr*) &msgs->buf[index];
+			pkt_len = ntohs (chp->pkt_len);
+
+			/* As cefnetd does, the parsed structures are cleared for each message 	*/
+			memset (&pm, 0, sizeof (CefT_CcnMsg_MsgBdy));
+			memset (&poh, 0, sizeof (CefT_CcnMsg_OptHdr));
+			if (cef_frame_message_parse (&msgs->buf[index], pkt_len - chp->hdr_len,
+					chp->hdr_len, &poh, &pm, chp->type) < 0) {
+				continue;
+			}
+			if (msghash_f) {
+				cef_frame_opheader_msghash_get (&poh);
+			}
+		}
+	}
+	gettimeofday (&t_end, NULL);
+
+	return ((double)(t_end.tv_sec - t_start.tv_sec)
+				+ (double)(t_end.tv_usec - t_start.tv_usec) / 1000000.0);
+}
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+) {
+	fprintf (ofp,
+		"\n\nUsage: cefparsebench\n\n"
+		"  cefparsebench capture [-n repeat]\n\n"
+		"  capture    pcap file which holds CEFORE messages over UDP or TCP\n"
+		"  repeat     Times to parse all messages. The default value is 20.\n\n"
+	);
+	return;
+}
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefpitbench.c
+ */
+
+#define __CEF_PITBENCH_SOURCE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <cefore/cef_define.h>
+#include <cefore/cef_client.h>
+#include <cefore/cef_frame.h>
+#include <cefore/cef_hash.h>
+#include <cefore/cef_log.h>
+#include <cefore/cef_pit.h>
+
+
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+#define	USAGE			print_usage(CefFp_Usage)
+#define	printerr(...)	fprintf(stderr,"[cefpitbench] ERROR: " __VA_ARGS__)
+
+#define CefpitbC_Default_Interests	5000000		/* Interests inserted and consumed		*/
+#define CefpitbC_Default_Window		4096		/* Interests pending at a time			*/
+#define CefpitbC_Default_Repeat		3
+#define CefpitbC_Max_Window			1000000
+#define CefpitbC_FaceId				16			/* Face which the Interests came from	*/
+#define CefpitbC_Uri				"ccnx:/pitbench/content"
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+);
+/*--------------------------------------------------------------------------------------
+	Sets the chunk number of the parsed Interest
+----------------------------------------------------------------------------------------*/
+static void
+bench_chunk_set (
+	CefT_CcnMsg_MsgBdy* pm,
+	uint32_t chunk_num
+);
+/*--------------------------------------------------------------------------------------
+	Inserts and consumes the Interests in rounds of the window
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+bench_run (
+	CefT_Hash_Handle pit,
+	CefT_CcnMsg_MsgBdy* pm,
+	CefT_CcnMsg_OptHdr* poh,
+	unsigned char* msg,						/* Interest									*/
+	uint32_t interests,
+	uint32_t window,
+	double* insert_sec,						/* Time to insert the Interests				*/
+	double* consume_sec						/* Time to consume the PIT entries			*/
+);
+/*--------------------------------------------------------------------------------------
+	Elapsed time between two times (sec)
+----------------------------------------------------------------------------------------*/
+static double
+bench_elapsed (
+	struct timeval* t_start,
+	struct timeval* t_end
+);
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+);
+
+
+/****************************************************************************************
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+) {
+	static CefT_CcnMsg_MsgBdy params;
+	static CefT_CcnMsg_OptHdr opt;
+	static CefT_CcnMsg_MsgBdy pm;
+	static CefT_CcnMsg_OptHdr poh;
+	unsigned char msg[CefC_Max_Length];
+	struct fixed_hdr* chp;
+	CefT_Hash_Handle pit;
+	char* work_arg;
+	double insert_sec, consume_sec;
+	long long val;
+	int msg_len, res;
+	int i;
+
+	/***** parameters 	*****/
+	uint32_t interests 	= CefpitbC_Default_Interests;
+	uint32_t window 	= CefpitbC_Default_Window;
+	int repeat 			= CefpitbC_Default_Repeat;
+
+	/* Obtains options 		*/
+	for (i = 1 ; i < argc ; i++) {
+
+		work_arg = argv[i];
+		if (work_arg == NULL || work_arg[0] == 0) {
+			break;
+		}
+
+		if ((strcmp (work_arg, "-n") == 0) && (i + 1 < argc)) {
+			val = atoll (argv[++i]);
+			if (val < 1 || val > UINT32_MAX) {
+				printerr("interests must be higher than 0.\n");
+				USAGE;
+				return (-1);
+			}
+			interests = (uint32_t) val;
+		} else if ((strcmp (work_arg, "-w") == 0) && (i + 1 < argc)) {
+			val = atoll (argv[++i]);
+			if (val < 1 || val > CefpitbC_Max_Window) {
+				printerr("window must be 1 to %d.\n", CefpitbC_Max_Window);
+				USAGE;
+				return (-1);
+			}
+			window = (uint32_t) val;
+		} else if ((strcmp (work_arg, "-r") == 0) && (i + 1 < argc)) {
+			repeat = atoi (argv[++i]);
+			if (repeat < 1) {
+				printerr("repeat must be higher than 0.\n");
+				USAGE;
+				return (-1);
+			}
+		} else {
+			printerr("unknown option is specified.\n");
+			USAGE;
+			return (-1);
+		}
+	}
+
+	cef_log_init ("cefpitbench", 1);
+	cef_frame_init ();
+	cef_pit_init (CefC_Default_CcninfoReplyTimeout,
+		CefC_Default_SYMBOLIC_LIFETIME, CefC_Default_REGULAR_LIFETIME);
+
+	/* Creates the Interest which is parsed as cefnetd does 	*/
+	res = cef_frame_conversion_uri_to_name (CefpitbC_Uri, params.name);
+	if (res < 0) {
+		printerr("failed to convert the URI.\n");
+		return (-1);
+	}
+	params.name_len 	= res;
+	params.hoplimit 	= 32;
+	opt.lifetime_f 		= 1;
+	opt.lifetime 		= 10000;
+	Cef_Int_Regular(params);
+	params.chunk_num_f 	= 1;
+	params.chunk_num 	= 0;
+	msg_len = cef_frame_interest_create (msg, &opt, &params);
+	if (msg_len < 1) {
+		printerr("failed to create the Interest.\n");
+		return (-1);
+	}
+	chp = (struct fixed_hdr*) msg;
+	res = cef_frame_message_parse (msg, ntohs (chp->pkt_len) - chp->hdr_len,
+				chp->hdr_len, &poh, &pm, CefC_PT_INTEREST);
+	if (res < 0 || pm.chunk_num_f == 0) {
+		printerr("failed to parse the Interest.\n");
+		return (-1);
+	}
+
+	/* The PIT is created as cefnetd creates it 	*/
+	pit = cef_lhash_tbl_create_ext (window, CefC_Hash_Coef_PIT);
+	if (pit == (CefT_Hash_Handle) NULL) {
+		printerr("failed to create the PIT.\n");
+		return (-1);
+	}
+	if (cef_pit_expiry_init (pit, cef_client_present_timeus_calc ()) < 0) {
+		printerr("failed to initialize the expiry of the PIT.\n");
+		return (-1);
+	}
+
+	fprintf (stdout, "Interests: %u, Window : %u\n\n", interests, window);
+	fprintf (stdout, "%-6s %16s %12s %16s %12s\n",
+		"Run", "Inserts/s", "ns/Insert", "Consumes/s", "ns/Consume");
+	for (i = 0 ; i < repeat ; i++) {
+		if (bench_run (pit, &pm, &poh, msg, interests, window,
+				&insert_sec, &consume_sec) < 0) {
+			return (-1);
+		}
+		if (insert_sec <= 0.0) {
+			insert_sec = 0.000001;
+		}
+		if (consume_sec <= 0.0) {
+			consume_sec = 0.000001;
+		}
+		fprintf (stdout, "%-6d %16.0f %12.1f %16.0f %12.1f\n", i + 1,
+			interests / insert_sec, insert_sec * 1000000000.0 / interests,
+			interests / consume_sec, consume_sec * 1000000000.0 / interests);
+	}
+
+	cef_pit_expiry_destroy (pit);
+	cef_lhash_tbl_destroy (pit);
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Sets the chunk number of the parsed Interest
+----------------------------------------------------------------------------------------*/
+static void
+bench_chunk_set (
+	CefT_CcnMsg_MsgBdy* pm,
+	uint32_t chunk_num
+) {
+	uint32_t value = htonl (chunk_num);
+
+	/* The Chunk Number is the last segment of the name 	*/
+	memcpy (&pm->name[pm->name_len - CefC_S_ChunkNum], &value, CefC_S_ChunkNum);
+	pm->chunk_num = chunk_num;
+}
+/*--------------------------------------------------------------------------------------
+	Inserts and consumes the Interests in rounds of the window
+----------------------------------------------------------------------------------------*/
+static int									/* Returns a negative value if it fails 	*/
+bench_run (
+	CefT_Hash_Handle pit,
+	CefT_CcnMsg_MsgBdy* pm,
+	CefT_CcnMsg_OptHdr* poh,
+	unsigned char* msg,						/* Interest									*/
+	uint32_t interests,
+	uint32_t window,
+	double* insert_sec,						/* Time to insert the Interests				*/
+	double* consume_sec						/* Time to consume the PIT entries			*/
+) {
+	static uint32_t chunk_base = 0;
+	struct timeval t_start, t_end;
+	CefT_Pit_Entry* pe;
+	CefT_Down_Faces* face;
+	unsigned int restr;
+	uint32_t done, num, i;
+	int pit_res;
+
+	*insert_sec  = 0.0;
+	*consume_sec = 0.0;
+	restr = cef_frame_get_restr_type_from_pm (pm);
+
+	for (done = 0 ; done < interests ; done += num) {
+		num = (interests - done < window) ? interests - done : window;
+
+		/* Interests from a consumer, as cefnetd_incoming_interest_process does 	*/
+		gettimeofday (&t_start, NULL);
+		for (i = 0 ; i < num ; i++) {
+			bench_chunk_set (pm, chunk_base + i);
+			pe = cef_pit_entry_lookup_and_down_face_update (pit, pm, poh, NULL, 0,
+					CefpitbC_FaceId, msg, CefC_IntRetrans_Type_RFC, &pit_res, restr);
+			if (pe == NULL || pit_res == 0) {
+				printerr("failed to insert the PIT entry of chunk %u.\n", chunk_base + i);
+				return (-1);
+			}
+		}
+		gettimeofday (&t_end, NULL);
+		*insert_sec += bench_elapsed (&t_start, &t_end);
+
+		/* Content Objects which satisfy them, as cefnetd_incoming_object_process does */
+		gettimeofday (&t_start, NULL);
+		for (i = 0 ; i < num ; i++) {
+			bench_chunk_set (pm, chunk_base + i);
+			pe = cef_pit_entry_search (pit, pm, poh, NULL, 0, CefC_PitKey_With_NAME);
+			if (pe == NULL) {
+				printerr("the PIT entry of chunk %u is not found.\n", chunk_base + i);
+				return (-1);
+			}
+			face = &(pe->dnfaces);
+			while (face->next) {
+				face = face->next;
+				if (face->faceid == CefpitbC_FaceId) {
+					cef_pit_entry_down_face_remove (pe, face, pm);
+					break;
+				}
+			}
+			if (pe->stole_f && cef_pit_entry_lock (pe)) {
+				cef_pit_entry_free (pit, pe);
+			}
+		}
+		gettimeofday (&t_end, NULL);
+		*consume_sec += bench_elapsed (&t_start, &t_end);
+
+		chunk_base += num;
+	}
+	if (cef_lhash_tbl_item_num_get (pit) != 0) {
+		printerr("%d PIT entries are left.\n", cef_lhash_tbl_item_num_get (pit));
+		return (-1);
+	}
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Elapsed time between two times (sec)
+----------------------------------------------------------------------------------------*/
+static double
+bench_elapsed (
+	struct timeval* t_start,
+	struct timeval* t_end
+) {
+	return ((double)(t_end->tv_sec - t_start->tv_sec)
+				+ (double)(t_end->tv_usec - t_start->tv_usec) / 1000000.0);
+}
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+) {
+	fprintf (ofp,
+		"\n\nUsage: cefpitbench\n\n"
+		"  cefpitbench [-n interests] [-w window] [-r repeat]\n\n"
+		"  interests  Interests inserted and consumed in each run. The default value is 5000000.\n"
+		"  window     Interests pending in the PIT at a time. The default value is 4096.\n"
+		"  repeat     Number of the runs. The default value is 3.\n\n"
+	);
+	return;
+}
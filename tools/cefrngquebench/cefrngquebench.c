@@ -0,0 +1,571 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefrngquebench.c
+ */
+
+#define __CEF_RNGQUEBENCH_SOURCE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <cefore/cef_define.h>
+#include <cefore/cef_rngque.h>
+#include <cefore/cef_log.h>
+
+
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+#define	USAGE			print_usage(CefFp_Usage)
+#define	printerr(...)	fprintf(stderr,"[cefrngquebench] ERROR: " __VA_ARGS__)
+
+#define CefrbC_Default_Items	10000000	/* Items passed in each measurement			*/
+#define CefrbC_Default_Prod		4			/* Producers of the MPSC measurement		*/
+#define CefrbC_Default_Batch	32			/* Items moved by one bulk call				*/
+#define CefrbC_Default_Capacity	4096		/* Capacity of the rings					*/
+#define CefrbC_Max_Prod			32
+#define CefrbC_Max_Batch		1024
+
+#define CefrbC_Item_Shift		40			/* Item = producer << shift | sequence		*/
+
+/*------------------------------------------------------------------*/
+/* Implementations to measure										*/
+/*------------------------------------------------------------------*/
+#define CefrbC_Impl_Mutex		0			/* Ring with a mutex, as formerly used		*/
+#define CefrbC_Impl_LockFree	1			/* cef_rngque_push/pop						*/
+#define CefrbC_Impl_Bulk		2			/* cef_rngque_push_bulk/pop_bulk			*/
+#define CefrbC_Impl_Num			3
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/***** Reference ring which takes a mutex for each item *****/
+typedef struct {
+	pthread_mutex_t 	mutex;
+	uint32_t 			top;
+	uint32_t 			bottom;
+	uint32_t 			mask;
+	void** 				que;
+} CefrbT_Mutex_Que;
+
+/***** A measurement *****/
+typedef struct {
+	int 				impl;				/* CefrbC_Impl_XXX							*/
+	int 				prod_num;			/* Number of the producer threads			*/
+	uint64_t 			items;				/* Items pushed by each producer			*/
+	int 				batch;
+	CefT_Rngque* 		rque;
+	CefrbT_Mutex_Que* 	mque;
+	pthread_barrier_t 	barrier;
+	int 				error_f;			/* Set if an item is lost or reordered		*/
+} CefrbT_Run;
+
+typedef struct {
+	CefrbT_Run* 		run;
+	uint64_t 			id;
+} CefrbT_Prod;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+);
+/*--------------------------------------------------------------------------------------
+	Creates the reference ring
+----------------------------------------------------------------------------------------*/
+static CefrbT_Mutex_Que*
+mutex_que_create (
+	int capacity							/* Power of 2								*/
+);
+/*--------------------------------------------------------------------------------------
+	Destroys the reference ring
+----------------------------------------------------------------------------------------*/
+static void
+mutex_que_destroy (
+	CefrbT_Mutex_Que* qp
+);
+/*--------------------------------------------------------------------------------------
+	Pushes the items to the ring of the measurement
+----------------------------------------------------------------------------------------*/
+static int									/* Number of pushed items					*/
+bench_push (
+	CefrbT_Run* run,
+	void* items[],
+	int num
+);
+/*--------------------------------------------------------------------------------------
+	Pops the items from the ring of the measurement
+----------------------------------------------------------------------------------------*/
+static int									/* Number of popped items					*/
+bench_pop (
+	CefrbT_Run* run,
+	void* items[],
+	int num
+);
+/*--------------------------------------------------------------------------------------
+	Producer thread
+----------------------------------------------------------------------------------------*/
+static void*
+bench_producer (
+	void* arg
+);
+/*--------------------------------------------------------------------------------------
+	Checks that the items of each producer are popped in order
+----------------------------------------------------------------------------------------*/
+static void
+bench_item_check (
+	CefrbT_Run* run,
+	uint64_t next[],						/* Next sequence of each producer			*/
+	void* items[],
+	int num
+);
+/*--------------------------------------------------------------------------------------
+	Pushes and pops the items on one thread
+----------------------------------------------------------------------------------------*/
+static double								/* Elapsed time (sec)						*/
+bench_run_single (
+	CefrbT_Run* run
+);
+/*--------------------------------------------------------------------------------------
+	Runs the producers and pops the items on the calling thread
+----------------------------------------------------------------------------------------*/
+static double								/* Elapsed time (sec)						*/
+bench_run_threads (
+	CefrbT_Run* run
+);
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+);
+
+
+/****************************************************************************************
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+) {
+	static const char* impls[] = { "mutex", "lock-free", "lock-free bulk" };
+	char scenario[32];
+	CefrbT_Run run;
+	char* work_arg;
+	double elapsed, total;
+	int i, s, impl;
+
+	/***** parameters 	*****/
+	uint64_t items 		= CefrbC_Default_Items;
+	int prod_num 		= CefrbC_Default_Prod;
+	int batch 			= CefrbC_Default_Batch;
+	int capacity 		= CefrbC_Default_Capacity;
+
+	/* Obtains options 		*/
+	for (i = 1 ; i < argc ; i++) {
+
+		work_arg = argv[i];
+		if (work_arg == NULL || work_arg[0] == 0) {
+			break;
+		}
+
+		if ((strcmp (work_arg, "-n") == 0) && (i + 1 < argc)) {
+			items = strtoull (argv[++i], NULL, 10);
+			if (items < 1) {
+				printerr("items must be higher than 0.\n");
+				USAGE;
+				return (-1);
+			}
+		} else if ((strcmp (work_arg, "-p") == 0) && (i + 1 < argc)) {
+			prod_num = atoi (argv[++i]);
+			if (prod_num < 2 || prod_num > CefrbC_Max_Prod) {
+				printerr("producers must be 2 to %d.\n", CefrbC_Max_Prod);
+				USAGE;
+				return (-1);
+			}
+		} else if ((strcmp (work_arg, "-b") == 0) && (i + 1 < argc)) {
+			batch = atoi (argv[++i]);
+			if (batch < 1 || batch > CefrbC_Max_Batch) {
+				printerr("batch must be 1 to %d.\n", CefrbC_Max_Batch);
+				USAGE;
+				return (-1);
+			}
+		} else if ((strcmp (work_arg, "-q") == 0) && (i + 1 < argc)) {
+			capacity = atoi (argv[++i]);
+			if (capacity < 2 || capacity > 65536 || (capacity & (capacity - 1))) {
+				printerr("capacity must be a power of 2 from 2 to 65536.\n");
+				USAGE;
+				return (-1);
+			}
+		} else {
+			printerr("unknown option is specified.\n");
+			USAGE;
+			return (-1);
+		}
+	}
+	if (batch > capacity) {
+		batch = capacity;
+	}
+
+	cef_log_init ("cefrngquebench", 1);
+	fprintf (stdout, "Items    : " FMTU64 " per measurement\n", items);
+	fprintf (stdout, "Capacity : %d, Batch : %d\n\n", capacity, batch);
+	fprintf (stdout, "%-10s %-16s %14s %10s %10s\n",
+		"Scenario", "Ring", "Items/s", "ns/item", "Time(s)");
+
+	/* Scenario 0 runs on one thread, 1 is SPSC and 2 is MPSC 	*/
+	for (s = 0 ; s < 3 ; s++) {
+		for (impl = 0 ; impl < CefrbC_Impl_Num ; impl++) {
+			memset (&run, 0, sizeof (CefrbT_Run));
+			run.impl 	 = impl;
+			run.prod_num = (s == 2) ? prod_num : 1;
+			run.items 	 = items / run.prod_num;
+			run.batch 	 = (impl == CefrbC_Impl_Bulk) ? batch : 1;
+			total = (double) run.items * run.prod_num;
+
+			if (impl == CefrbC_Impl_Mutex) {
+				run.mque = mutex_que_create (capacity);
+			} else {
+				run.rque = cef_rngque_create_ext (capacity,
+							(s == 2) ? CefC_Rngque_Mpsc : CefC_Rngque_Spsc);
+			}
+			if (run.mque == NULL && run.rque == NULL) {
+				printerr("failed to create the ring.\n");
+				return (-1);
+			}
+			elapsed = (s == 0) ? bench_run_single (&run) : bench_run_threads (&run);
+			if (elapsed <= 0.0) {
+				elapsed = 0.000001;
+			}
+			if (run.mque) {
+				mutex_que_destroy (run.mque);
+			} else {
+				cef_rngque_destroy (run.rque);
+			}
+			if (run.error_f) {
+				printerr("%s lost or reordered the items.\n", impls[impl]);
+				return (-1);
+			}
+
+			if (s == 0) {
+				sprintf (scenario, "1 thread");
+			} else if (s == 1) {
+				sprintf (scenario, "SPSC");
+			} else {
+				sprintf (scenario, "MPSC x%d", prod_num);
+			}
+			fprintf (stdout, "%-10s %-16s %14.0f %10.1f %10.3f\n", scenario, impls[impl],
+				total / elapsed, elapsed * 1000000000.0 / total, elapsed);
+		}
+	}
+
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Creates the reference ring
+----------------------------------------------------------------------------------------*/
+static CefrbT_Mutex_Que*
+mutex_que_create (
+	int capacity							/* Power of 2								*/
+) {
+	CefrbT_Mutex_Que* qp;
+
+	qp = (CefrbT_Mutex_Que*) calloc (1, sizeof (CefrbT_Mutex_Que));
+	if (qp == NULL) {
+		return (NULL);
+	}
+	qp->que = (void**) calloc (capacity, sizeof (void*));
+	if (qp->que == NULL) {
+		free (qp);
+		return (NULL);
+	}
+	qp->mask = capacity - 1;
+	pthread_mutex_init (&qp->mutex, NULL);
+	return (qp);
+}
+/*--------------------------------------------------------------------------------------
+	Destroys the reference ring
+----------------------------------------------------------------------------------------*/
+static void
+mutex_que_destroy (
+	CefrbT_Mutex_Que* qp
+) {
+	pthread_mutex_destroy (&qp->mutex);
+	free (qp->que);
+	free (qp);
+}
+/*--------------------------------------------------------------------------------------
+	Pushes the items to the ring of the measurement
+----------------------------------------------------------------------------------------*/
+static int									/* Number of pushed items					*/
+bench_push (
+	CefrbT_Run* run,
+	void* items[],
+	int num
+) {
+	CefrbT_Mutex_Que* qp;
+	int res = 0;
+
+	switch (run->impl) {
+		case CefrbC_Impl_Mutex: {
+			qp = run->mque;
+			pthread_mutex_lock (&qp->mutex);
+			if (((qp->bottom + 1) & qp->mask) != qp->top) {
+				qp->que[qp->bottom] = items[0];
+				qp->bottom = (qp->bottom + 1) & qp->mask;
+				res = 1;
+			}
+			pthread_mutex_unlock (&qp->mutex);
+			break;
+		}
+		case CefrbC_Impl_LockFree: {
+			res = cef_rngque_push (run->rque, items[0]);
+			break;
+		}
+		default: {
+			res = cef_rngque_push_bulk (run->rque, items, num);
+			break;
+		}
+	}
+	return (res);
+}
+/*--------------------------------------------------------------------------------------
+	Pops the items from the ring of the measurement
+----------------------------------------------------------------------------------------*/
+static int									/* Number of popped items					*/
+bench_pop (
+	CefrbT_Run* run,
+	void* items[],
+	int num
+) {
+	CefrbT_Mutex_Que* qp;
+	int res = 0;
+
+	switch (run->impl) {
+		case CefrbC_Impl_Mutex: {
+			qp = run->mque;
+			pthread_mutex_lock (&qp->mutex);
+			if (qp->bottom != qp->top) {
+				items[0] = qp->que[qp->top];
+				qp->top = (qp->top + 1) & qp->mask;
+				res = 1;
+			}
+			pthread_mutex_unlock (&qp->mutex);
+			break;
+		}
+		case CefrbC_Impl_LockFree: {
+			items[0] = cef_rngque_pop (run->rque);
+			res = (items[0] != NULL) ? 1 : 0;
+			break;
+		}
+		default: {
+			res = cef_rngque_pop_bulk (run->rque, items, num);
+			break;
+		}
+	}
+	return (res);
+}
+/*--------------------------------------------------------------------------------------
+	Producer thread
+----------------------------------------------------------------------------------------*/
+static void*
+bench_producer (
+	void* arg
+) {
+	CefrbT_Prod* prod = (CefrbT_Prod*) arg;
+	CefrbT_Run* run = prod->run;
+	void* items[CefrbC_Max_Batch];
+	uint64_t seq = 0;
+	int i, num, pushed, res;
+
+	pthread_barrier_wait (&run->barrier);
+
+	while (seq < run->items) {
+		num = run->batch;
+		if (run->items - seq < (uint64_t) num) {
+			num = (int)(run->items - seq);
+		}
+		/* Sequences start from 1 so that no item is NULL 	*/
+		for (i = 0 ; i < num ; i++) {
+			items[i] = (void*)(uintptr_t)((prod->id << CefrbC_Item_Shift) | (seq + i + 1));
+		}
+		for (pushed = 0 ; pushed < num ; pushed += res) {
+			res = bench_push (run, &items[pushed], num - pushed);
+			if (res == 0) {
+				sched_yield ();
+			}
+		}
+		seq += num;
+	}
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Checks that the items of each producer are popped in order
+----------------------------------------------------------------------------------------*/
+static void
+bench_item_check (
+	CefrbT_Run* run,
+	uint64_t next[],						/* Next sequence of each producer			*/
+	void* items[],
+	int num
+) {
+	uint64_t item, id;
+	int i;
+
+	for (i = 0 ; i < num ; i++) {
+		item = (uint64_t)(uintptr_t) items[i];
+		id = item >> CefrbC_Item_Shift;
+		if ((id >= (uint64_t) run->prod_num) ||
+			((item & ((1ULL << CefrbC_Item_Shift) - 1)) != next[id])) {
+			run->error_f = 1;
+			return;
+		}
+		next[id]++;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Pushes and pops the items on one thread
+----------------------------------------------------------------------------------------*/
+static double								/* Elapsed time (sec)						*/
+bench_run_single (
+	CefrbT_Run* run
+) {
+	struct timeval t_start, t_end;
+	void* items[CefrbC_Max_Batch];
+	uint64_t next[1] = { 1 };
+	uint64_t seq = 0;
+	int i, num, res;
+
+	gettimeofday (&t_start, NULL);
+	while (seq < run->items) {
+		num = run->batch;
+		if (run->items - seq < (uint64_t) num) {
+			num = (int)(run->items - seq);
+		}
+		for (i = 0 ; i < num ; i++) {
+			items[i] = (void*)(uintptr_t)(seq + i + 1);
+		}
+		for (i = 0 ; i < num ; i += res) {
+			res = bench_push (run, &items[i], num - i);
+		}
+		for (i = 0 ; i < num ; i += res) {
+			res = bench_pop (run, &items[i], num - i);
+		}
+		bench_item_check (run, next, items, num);
+		seq += num;
+	}
+	gettimeofday (&t_end, NULL);
+
+	return ((double)(t_end.tv_sec - t_start.tv_sec)
+				+ (double)(t_end.tv_usec - t_start.tv_usec) / 1000000.0);
+}
+/*--------------------------------------------------------------------------------------
+	Runs the producers and pops the items on the calling thread
+----------------------------------------------------------------------------------------*/
+static double								/* Elapsed time (sec)						*/
+bench_run_threads (
+	CefrbT_Run* run
+) {
+	struct timeval t_start, t_end;
+	pthread_t tids[CefrbC_Max_Prod];
+	CefrbT_Prod prods[CefrbC_Max_Prod];
+	void* items[CefrbC_Max_Batch];
+	uint64_t next[CefrbC_Max_Prod];
+	uint64_t total, popped = 0;
+	int i, res;
+
+	pthread_barrier_init (&run->barrier, NULL, run->prod_num + 1);
+	for (i = 0 ; i < run->prod_num ; i++) {
+		next[i] = 1;
+		prods[i].run = run;
+		prods[i].id  = i;
+		if (pthread_create (&tids[i], NULL, bench_producer, &prods[i]) != 0) {
+			printerr("failed to create the producer thread.\n");
+			exit (-1);
+		}
+	}
+	total = run->items * run->prod_num;
+
+	pthread_barrier_wait (&run->barrier);
+	gettimeofday (&t_start, NULL);
+	while (popped < total) {
+		res = bench_pop (run, items, run->batch);
+		if (res == 0) {
+			sched_yield ();
+			continue;
+		}
+		bench_item_check (run, next, items, res);
+		popped += res;
+	}
+	gettimeofday (&t_end, NULL);
+
+	for (i = 0 ; i < run->prod_num ; i++) {
+		pthread_join (tids[i], NULL);
+	}
+	pthread_barrier_destroy (&run->barrier);
+
+	return ((double)(t_end.tv_sec - t_start.tv_sec)
+				+ (double)(t_end.tv_usec - t_start.tv_usec) / 1000000.0);
+}
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+) {
+	fprintf (ofp,
+		"\n\nUsage: cefrngquebench\n\n"
+		"  cefrngquebench [-n items] [-p producers] [-b batch] [-q capacity]\n\n"
+		"  items      Items passed in each measurement. The default value is 10000000.\n"
+		"  producers  Producer threads of the MPSC measurement. The default value is 4.\n"
+		"  batch      Items moved by one bulk call. The default value is 32.\n"
+		"  capacity   Capacity of the rings (power of 2). The default value is 4096.\n\n"
+	);
+	return;
+}
@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * ceftxbufbench.c
+ */
+
+#define __CEF_TXBUFBENCH_SOURCE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <cefore/cef_define.h>
+#include <cefore/cef_frame.h>
+#include <cefore/cef_log.h>
+#include <cefore/cef_mpool.h>
+
+
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+#define	USAGE			print_usage(CefFp_Usage)
+#define	printerr(...)	fprintf(stderr,"[ceftxbufbench] ERROR: " __VA_ARGS__)
+
+#define CeftbC_Default_Msgs		200000		/* Messages sent for each size and faces	*/
+#define CeftbC_Default_Depth	64			/* Messages queued before they are sent		*/
+#define CeftbC_Max_Depth		4096
+#define CeftbC_Max_Faces		16
+#define CeftbC_Face_Num			32			/* Same as CefC_Elem_Face_Num				*/
+
+/*------------------------------------------------------------------*/
+/* Methods to measure												*/
+/*------------------------------------------------------------------*/
+#define CeftbC_Method_Copy		0			/* 64 KB elements, one copy per face		*/
+#define CeftbC_Method_Ref		1			/* Shared reference-counted buffers			*/
+#define CeftbC_Method_Num		2
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/***** TX element which embeds the message, as formerly used *****/
+typedef struct {
+	int 			type;
+	unsigned char	msg[CefC_Max_Msg_Size];
+	uint16_t 		msg_len;
+	uint16_t 		faceids[CeftbC_Face_Num];
+	int				faceid_num;
+	int				tx_prio;
+	int				tx_copies;
+} CeftbT_Copy_Elem;
+
+/***** TX element which refers to a packet buffer *****/
+typedef struct {
+	int 			type;
+	unsigned char*	msg;
+	CefT_Pkt_Buf*	pkt;
+	uint16_t 		msg_len;
+	uint16_t 		faceids[CeftbC_Face_Num];
+	int				faceid_num;
+	int				tx_prio;
+	int				tx_copies;
+} CeftbT_Ref_Elem;
+
+/***** A measurement *****/
+typedef struct {
+	int 			method;					/* CeftbC_Method_XXX						*/
+	CefT_Mp_Handle 	mp;						/* Pool of the TX elements					*/
+	void** 			queue;					/* Elements queued to the faces				*/
+	unsigned char* 	sock_buf;				/* Where the messages are sent to			*/
+	uint64_t 		sum;					/* Keeps the sends from being optimized out	*/
+} CeftbT_Run;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+);
+/*--------------------------------------------------------------------------------------
+	Queues the message to the faces, as cefnetd_frame_send_core and the TX
+	dispatcher do
+----------------------------------------------------------------------------------------*/
+static int									/* Number of the queued elements			*/
+bench_enqueue (
+	CeftbT_Run* run,
+	const unsigned char* msg,
+	uint16_t msg_len,
+	int faces,
+	void** queue
+);
+/*--------------------------------------------------------------------------------------
+	Sends the queued element and frees it, as the transmit workers do
+----------------------------------------------------------------------------------------*/
+static void
+bench_send (
+	CeftbT_Run* run,
+	void* elem
+);
+/*--------------------------------------------------------------------------------------
+	Measures a message size and a number of faces
+----------------------------------------------------------------------------------------*/
+static double								/* Elapsed time (sec)						*/
+bench_run (
+	CeftbT_Run* run,
+	const unsigned char* msg,
+	uint16_t msg_len,
+	int faces,
+	int msgs,
+	int depth
+);
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+);
+
+
+/****************************************************************************************
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+) {
+	static const int def_sizes[] = { 100, 1400, 8000, 65000 };
+	static const int def_faces[] = { 1, 4 };
+	static const size_t elem_sizes[] = { sizeof (CeftbT_Copy_Elem), sizeof (CeftbT_Ref_Elem) };
+	CeftbT_Run runs[CeftbC_Method_Num];
+	unsigned char* msg;
+	char* work_arg;
+	double elapsed[CeftbC_Method_Num];
+	int i, s, f, m;
+
+	/***** parameters 	*****/
+	int msgs 			= CeftbC_Default_Msgs;
+	int depth 			= CeftbC_Default_Depth;
+
+	/* Obtains options 		*/
+	for (i = 1 ; i < argc ; i++) {
+
+		work_arg = argv[i];
+		if (work_arg == NULL || work_arg[0] == 0) {
+			break;
+		}
+
+		if ((strcmp (work_arg, "-n") == 0) && (i + 1 < argc)) {
+			msgs = atoi (argv[++i]);
+			if (msgs < 1) {
+				printerr("msgs must be higher than 0.\n");
+				USAGE;
+				return (-1);
+			}
+		} else if ((strcmp (work_arg, "-q") == 0) && (i + 1 < argc)) {
+			depth = atoi (argv[++i]);
+			if (depth < 1 || depth > CeftbC_Max_Depth) {
+				printerr("depth must be 1 to %d.\n", CeftbC_Max_Depth);
+				USAGE;
+				return (-1);
+			}
+		} else {
+			printerr("unknown option is specified.\n");
+			USAGE;
+			return (-1);
+		}
+	}
+
+	cef_log_init ("ceftxbufbench", 1);
+	msg = (unsigned char*) malloc (CefC_Max_Msg_Size);
+	if (msg == NULL) {
+		printerr("failed to allocate the buffer.\n");
+		return (-1);
+	}
+	for (i = 0 ; i < CefC_Max_Msg_Size ; i++) {
+		msg[i] = (unsigned char) rand ();
+	}
+	for (m = 0 ; m < CeftbC_Method_Num ; m++) {
+		memset (&runs[m], 0, sizeof (CeftbT_Run));
+		runs[m].method 	 = m;
+		runs[m].mp 		 = cef_mpool_init ("CefTxBench", elem_sizes[m], CeftbC_Max_Depth);
+		runs[m].queue 	 = (void**) malloc (sizeof (void*) * depth * CeftbC_Max_Faces);
+		runs[m].sock_buf = (unsigned char*) malloc (CefC_Max_Msg_Size);
+		if (runs[m].mp == 0 || runs[m].queue == NULL || runs[m].sock_buf == NULL) {
+			printerr("failed to allocate the buffer.\n");
+			return (-1);
+		}
+	}
+
+	fprintf (stdout, "Messages : %d for each size and faces, Depth : %d\n", msgs, depth);
+	fprintf (stdout, "Element  : %zu bytes (copy), %zu bytes (refcount)\n\n",
+		elem_sizes[CeftbC_Method_Copy], elem_sizes[CeftbC_Method_Ref]);
+	fprintf (stdout, "%8s %6s %16s %16s %9s\n",
+		"Size", "Faces", "copy(ns/msg)", "refcount(ns/msg)", "Speedup");
+
+	for (s = 0 ; s < (int)(sizeof (def_sizes) / sizeof (def_sizes[0])) ; s++) {
+		for (f = 0 ; f < (int)(sizeof (def_faces) / sizeof (def_faces[0])) ; f++) {
+			for (m = 0 ; m < CeftbC_Method_Num ; m++) {
+				elapsed[m] = bench_run (&runs[m], msg, def_sizes[s], def_faces[f], msgs, depth);
+				if (elapsed[m] <= 0.0) {
+					elapsed[m] = 0.000001;
+				}
+			}
+			fprintf (stdout, "%8d %6d %16.1f %16.1f %8.2fx\n", def_sizes[s], def_faces[f],
+				elapsed[CeftbC_Method_Copy] * 1000000000.0 / msgs,
+				elapsed[CeftbC_Method_Ref] * 1000000000.0 / msgs,
+				elapsed[CeftbC_Method_Copy] / elapsed[CeftbC_Method_Ref]);
+		}
+	}
+	fprintf (stdout, "\nEach message is also copied once per face to stand for the send.\n");
+
+	for (m = 0 ; m < CeftbC_Method_Num ; m++) {
+		if (runs[m].sum == 0) {
+			printerr("no message was sent.\n");
+		}
+		cef_mpool_destroy (runs[m].mp);
+		free (runs[m].queue);
+		free (runs[m].sock_buf);
+	}
+	free (msg);
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Queues the message to the faces, as cefnetd_frame_send_core and the TX
+	dispatcher do
+----------------------------------------------------------------------------------------*/
+static int									/* Number of the queued elements			*/
+bench_enqueue (
+	CeftbT_Run* run,
+	const unsigned char* msg,
+	uint16_t msg_len,
+	int faces,
+	void** queue
+) {
+	CeftbT_Copy_Elem* copy_elem;
+	CeftbT_Copy_Elem* copy_wkr;
+	CeftbT_Ref_Elem* ref_elem;
+	CeftbT_Ref_Elem* ref_wkr;
+	int i;
+
+	if (run->method == CeftbC_Method_Copy) {
+		/* The element is cleared and the message is copied into it 	*/
+		copy_elem = (CeftbT_Copy_Elem*) cef_mpool_alloc (run->mp);
+		memset (copy_elem, 0, sizeof (CeftbT_Copy_Elem));
+		memcpy (copy_elem->msg, msg, msg_len);
+		copy_elem->msg_len = msg_len;
+		copy_elem->faceid_num = faces;
+
+		/* The dispatcher copies it again for each face 	*/
+		for (i = 0 ; i < faces ; i++) {
+			copy_wkr = (CeftbT_Copy_Elem*) cef_mpool_alloc (run->mp);
+			copy_wkr->type = copy_elem->type;
+			memcpy (copy_wkr->msg, copy_elem->msg, copy_elem->msg_len);
+			copy_wkr->msg_len = copy_elem->msg_len;
+			copy_wkr->faceids[0] = (uint16_t) i;
+			copy_wkr->faceid_num = 1;
+			queue[i] = copy_wkr;
+		}
+		cef_mpool_free (run->mp, copy_elem);
+	} else {
+		/* The message is copied once into a buffer sized to it 	*/
+		ref_elem = (CeftbT_Ref_Elem*) cef_mpool_alloc (run->mp);
+		memset (ref_elem, 0, sizeof (CeftbT_Ref_Elem));
+		ref_elem->pkt = cef_pktbuf_alloc (msg_len);
+		if (ref_elem->pkt == NULL) {
+			printerr("failed to allocate the packet buffer.\n");
+			exit (-1);
+		}
+		ref_elem->msg = ref_elem->pkt->data;
+		memcpy (ref_elem->msg, msg, msg_len);
+		ref_elem->msg_len = msg_len;
+		ref_elem->faceid_num = faces;
+
+		/* The elements of the faces share the buffer 	*/
+		for (i = 0 ; i < faces ; i++) {
+			ref_wkr = (CeftbT_Ref_Elem*) cef_mpool_alloc (run->mp);
+			ref_wkr->type = ref_elem->type;
+			ref_wkr->pkt = cef_pktbuf_ref (ref_elem->pkt);
+			ref_wkr->msg = ref_elem->msg;
+			ref_wkr->msg_len = ref_elem->msg_len;
+			ref_wkr->faceids[0] = (uint16_t) i;
+			ref_wkr->faceid_num = 1;
+			queue[i] = ref_wkr;
+		}
+		cef_pktbuf_release (ref_elem->pkt);
+		cef_mpool_free (run->mp, ref_elem);
+	}
+	return (faces);
+}
+/*--------------------------------------------------------------------------------------
+	Sends the queued element and frees it, as the transmit workers do
+----------------------------------------------------------------------------------------*/
+static void
+bench_send (
+	CeftbT_Run* run,
+	void* elem
+) {
+	CeftbT_Copy_Elem* copy_elem;
+	CeftbT_Ref_Elem* ref_elem;
+
+	/* The kernel copies the message into the socket buffer 	*/
+	if (run->method == CeftbC_Method_Copy) {
+		copy_elem = (CeftbT_Copy_Elem*) elem;
+		memcpy (run->sock_buf, copy_elem->msg, copy_elem->msg_len);
+		run->sum += run->sock_buf[copy_elem->msg_len - 1] + 1;
+		cef_mpool_free (run->mp, copy_elem);
+	} else {
+		ref_elem = (CeftbT_Ref_Elem*) elem;
+		memcpy (run->sock_buf, ref_elem->msg, ref_elem->msg_len);
+		run->sum += run->sock_buf[ref_elem->msg_len - 1] + 1;
+		cef_pktbuf_release (ref_elem->pkt);
+		cef_mpool_free (run->mp, ref_elem);
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Measures a message size and a number of faces
+----------------------------------------------------------------------------------------*/
+static double								/* Elapsed time (sec)						*/
+bench_run (
+	CeftbT_Run* run,
+	const unsigned char* msg,
+	uint16_t msg_len,
+	int faces,
+	int msgs,
+	int depth
+) {
+	struct timeval t_start, t_end;
+	int done, num, queued, i;
+
+	gettimeofday (&t_start, NULL);
+	for (done = 0 ; done < msgs ; done += num) {
+		num = (msgs - done < depth) ? msgs - done : depth;
+
+		/* Up to the depth of messages wait in the queues before they are sent 	*/
+		for (queued = 0, i = 0 ; i < num ; i++) {
+			queued += bench_enqueue (run, msg, msg_len, faces, &run->queue[queued]);
+		}
+		for (i = 0 ; i < queued ; i++) {
+			bench_send (run, run->queue[i]);
+		}
+	}
+	gettimeofday (&t_end, NULL);
+
+	return ((double)(t_end.tv_sec - t_start.tv_sec)
+				+ (double)(t_end.tv_usec - t_start.tv_usec) / 1000000.0);
+}
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+) {
+	fprintf (ofp,
+		"\n\nUsage: ceftxbufbench\n\n"
+		"  ceftxbufbench [-n msgs] [-q depth]\n\n"
+		"  msgs       Messages sent for each size and faces. The default value is 200000.\n"
+		"  depth      Messages queued before they are sent. The default value is 64.\n\n"
+	);
+	return;
+}
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * cefvalidbench.c
+ */
+
+#define __CEF_VALIDBENCH_SOURCE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <cefore/cef_frame.h>
+#include <cefore/cef_valid.h>
+
+
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+#define	USAGE			print_usage(CefFp_Usage)
+#define	printerr(...)	fprintf(stderr,"[cefvalidbench] ERROR: " __VA_ARGS__)
+
+#define CefvbC_Default_Mbytes	256			/* Bytes calculated per measurement (MB)	*/
+#define CefvbC_Max_Sizes		16			/* Max number of sizes						*/
+#define CefvbC_Max_Size			65535		/* Max size of a message					*/
+#define CefvbC_Check_Value		0xE3069283	/* CRC32C of "123456789"					*/
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/***** implementation of CRC32C *****/
+typedef struct {
+	int 			impl;					/* CefC_Crc32c_Impl_XXX						*/
+	const char*		label;					/* Label of the column						*/
+} CefvbT_Impl;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static const CefvbT_Impl impls[] = {
+	{CefC_Crc32c_Impl_Table,	"table"},
+	{CefC_Crc32c_Impl_Slice8,	"slice8"},
+	{CefC_Crc32c_Impl_Sse42,	"sse42"},
+};
+#define CefvbC_Impl_Num		((int)(sizeof (impls) / sizeof (impls[0])))
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+);
+/*--------------------------------------------------------------------------------------
+	Measures the throughput of the selected implementation
+----------------------------------------------------------------------------------------*/
+static double								/* GB/s										*/
+bench_run (
+	const unsigned char* buf,
+	size_t size,
+	uint64_t total,							/* Bytes to calculate						*/
+	uint32_t* crc							/* CRC32C of the buffer						*/
+);
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+);
+
+
+/****************************************************************************************
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+) {
+	static const size_t def_sizes[] = {64, 256, 1024, 1500, 4096, 8192, 65000, 0};
+	size_t sizes[CefvbC_Max_Sizes];
+	int size_num = 0;
+	unsigned char* buf;
+	char* work_arg;
+	uint32_t crc, ref_crc;
+	double gbps;
+	int supported[CefvbC_Impl_Num];
+	int i, n;
+	int res = 0;
+
+	/***** parameters 	*****/
+	long mbytes 		= CefvbC_Default_Mbytes;
+	long size;
+
+	/* Obtains options 		*/
+	for (i = 1 ; i < argc ; i++) {
+
+		work_arg = argv[i];
+		if (work_arg == NULL || work_arg[0] == 0) {
+			break;
+		}
+
+		if ((strcmp (work_arg, "-s") == 0) && (i + 1 < argc)) {
+			if (size_num == CefvbC_Max_Sizes) {
+				printerr("too many sizes are specified (max %d).\n", CefvbC_Max_Sizes);
+				USAGE;
+				return (-1);
+			}
+			size = atol (argv[++i]);
+			if (size <= 0 || size > CefvbC_Max_Size) {
+				printerr("size must be between 1 and %d.\n", CefvbC_Max_Size);
+				USAGE;
+				return (-1);
+			}
+			sizes[size_num] = (size_t) size;
+			size_num++;
+		} else if ((strcmp (work_arg, "-m") == 0) && (i + 1 < argc)) {
+			mbytes = atol (argv[++i]);
+			if (mbytes <= 0) {
+				printerr("megabytes must be higher than 0.\n");
+				USAGE;
+				return (-1);
+			}
+		} else {
+			printerr("unknown option is specified.\n");
+			USAGE;
+			return (-1);
+		}
+	}
+	if (size_num == 0) {
+		for (size_num = 0 ; def_sizes[size_num] ; size_num++) {
+			sizes[size_num] = def_sizes[size_num];
+		}
+	}
+
+	/* Checks each implementation with the check value of CRC32C 	*/
+	for (n = 0 ; n < CefvbC_Impl_Num ; n++) {
+		supported[n] = (cef_valid_crc32c_impl_set (impls[n].impl) >= 0);
+		if (supported[n] &&
+			cef_valid_crc32c_calc ((const unsigned char*) "123456789", 9) != CefvbC_Check_Value) {
+			printerr("%s returns a wrong check value.\n", impls[n].label);
+			res = -1;
+		}
+	}
+	n = cef_valid_crc32c_impl_set (CefC_Crc32c_Impl_Auto);
+	for (i = 0 ; i < CefvbC_Impl_Num ; i++) {
+		if (impls[i].impl == n) {
+			fprintf (stdout, "Selected : %s\n", impls[i].label);
+		}
+	}
+	fprintf (stdout, "Data     : %ld MB per measurement\n\n", mbytes);
+
+	buf = (unsigned char*) malloc (CefvbC_Max_Size + 1);
+	if (buf == NULL) {
+		printerr("failed to allocate the buffer.\n");
+		return (-1);
+	}
+	srand (0);
+	for (i = 0 ; i < CefvbC_Max_Size + 1 ; i++) {
+		buf[i] = (unsigned char) rand ();
+	}
+
+	fprintf (stdout, "%8s", "Size(B)");
+	for (n = 0 ; n < CefvbC_Impl_Num ; n++) {
+		fprintf (stdout, " %9s GB/s", impls[n].label);
+	}
+	fprintf (stdout, "\n");
+
+	for (i = 0 ; i < size_num ; i++) {
+		fprintf (stdout, "%8zu", sizes[i]);
+		ref_crc = 0;
+		for (n = 0 ; n < CefvbC_Impl_Num ; n++) {
+			if (!supported[n]) {
+				fprintf (stdout, " %14s", "-");
+				continue;
+			}
+			cef_valid_crc32c_impl_set (impls[n].impl);
+			/* Starts at an odd address to include the unaligned head 	*/
+			gbps = bench_run (buf + 1, sizes[i], (uint64_t) mbytes * 1000000, &crc);
+			fprintf (stdout, " %14.3f", gbps);
+			if (n == 0) {
+				ref_crc = crc;
+			} else if (crc != ref_crc) {
+				printerr("%s returns 0x%08x for %zu bytes, but table returns 0x%08x.\n",
+					impls[n].label, crc, sizes[i], ref_crc);
+				res = -1;
+			}
+		}
+		fprintf (stdout, "\n");
+	}
+
+	free (buf);
+	return (res);
+}
+/*--------------------------------------------------------------------------------------
+	Measures the throughput of the selected implementation
+----------------------------------------------------------------------------------------*/
+static double								/* GB/s										*/
+bench_run (
+	const unsigned char* buf,
+	size_t size,
+	uint64_t total,							/* Bytes to calculate						*/
+	uint32_t* crc							/* CRC32C of the buffer						*/
+) {
+	struct timeval t_start, t_end;
+	uint64_t count = total / size + 1;
+	uint64_t n;
+	uint32_t sink = 0;
+	double elapsed;
+
+	*crc = cef_valid_crc32c_calc (buf, size);
+
+	gettimeofday (&t_start, NULL);
+	for (n = 0 ; n < count ; n++) {
+		/* Folds the results so that the calculation is not removed 	*/
+		sink ^= cef_valid_crc32c_calc (buf, size);
+	}
+	gettimeofday (&t_end, NULL);
+	elapsed = (double)(t_end.tv_sec - t_start.tv_sec)
+				+ (double)(t_end.tv_usec - t_start.tv_usec) / 1000000.0;
+	if (sink == *crc + 1) {
+		fprintf (stderr, " ");
+	}
+	if (elapsed <= 0.0) {
+		elapsed = 0.000001;
+	}
+	return ((double)(count * size) / elapsed / 1000000000.0);
+}
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+) {
+	fprintf (ofp,
+		"\n\nUsage: cefvalidbench\n\n"
+		"  cefvalidbench [-s size ...] [-m megabytes]\n\n"
+		"  size       Bytes of the message whose CRC32C is calculated. -s can be\n"
+		"             repeated. By default, 64, 256, 1024, 1500, 4096, 8192 and 65000\n"
+		"             bytes are measured.\n"
+		"  megabytes  Megabytes calculated per measurement. The default value is 256.\n\n"
+	);
+	return;
+}
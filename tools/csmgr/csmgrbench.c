@@ -0,0 +1,647 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * csmgrbench.c
+ */
+
+#define __CSMGR_BENCH_SOURCE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <cefore/cef_csmgr.h>
+#include <cefore/cef_client.h>
+#include <cefore/cef_frame.h>
+
+
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+#define	USAGE			print_usage(CefFp_Usage)
+#define	printerr(...)	fprintf(stderr,"[csmgrbench] ERROR: " __VA_ARGS__)
+
+#define CsmgrbenchC_Default_Lookups		100000
+#define CsmgrbenchC_Default_Chunks		1000
+#define CsmgrbenchC_Max_Contents		16			/* Max number of URIs				*/
+#define CsmgrbenchC_Max_Threads			16			/* Max number of threads			*/
+#define CsmgrbenchC_Wait_Time			10000		/* Time to wait for csmgrd (msec)	*/
+#define CsmgrbenchC_Idle_Time			1000		/* Time to wait for the echo (msec)	*/
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+typedef struct {
+	int 			sock;
+	unsigned char	rcv_buff[CefC_CsPipeBuffSize];
+	int 			rcv_len;
+	uint64_t		cobs;						/* Cobs received						*/
+	uint64_t		hits;						/* Answers of hit						*/
+	uint64_t		misses;						/* Answers of miss						*/
+	uint32_t		credit;						/* Credit advertised by csmgrd			*/
+	int 			echo_f;						/* Echo response received				*/
+	struct timeval	rcv_t;						/* Time of the last reception			*/
+} CsmgrbenchT_Link;
+
+typedef struct {
+	pthread_t		th;
+	int 			index;						/* Index of the thread					*/
+	int 			link_ver;
+	uint32_t		lookups;					/* Lookups sent by the thread			*/
+	uint32_t		chunks;
+	CsmgrbenchT_Link link;						/* Connection of the thread				*/
+	int 			res;						/* Negative if an error occurred		*/
+	struct timeval	t_end;						/* Time when the thread finished		*/
+} CsmgrbenchT_Thread;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+/* Set before the threads start, and only read by them 	*/
+static unsigned char 	bench_name[CsmgrbenchC_Max_Contents][CefC_Max_Length];
+static int 				bench_name_len[CsmgrbenchC_Max_Contents];
+static int 				bench_cont_num = 0;
+static char 			bench_dst[64] = {0};
+static char 			bench_port_str[32] = {0};
+
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+);
+/*--------------------------------------------------------------------------------------
+	Sends the lookups of a thread and receives the answers
+----------------------------------------------------------------------------------------*/
+static void*
+bench_thread (
+	void* arg
+);
+/*--------------------------------------------------------------------------------------
+	Creates the csmgr Interest message for the chunk
+----------------------------------------------------------------------------------------*/
+static uint16_t								/* Length of the message					*/
+interest_msg_create (
+	unsigned char* buff,
+	const unsigned char* name,
+	uint16_t name_len,
+	uint32_t chunk_num
+);
+/*--------------------------------------------------------------------------------------
+	Sends the message to csmgrd
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+link_send (
+	CsmgrbenchT_Link* link,
+	const unsigned char* msg,
+	int msg_len
+);
+/*--------------------------------------------------------------------------------------
+	Receives the messages from csmgrd
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+link_recv (
+	CsmgrbenchT_Link* link,
+	int timeout									/* msec									*/
+);
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+);
+
+
+/****************************************************************************************
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+) {
+	CsmgrbenchT_Thread* ths;
+	char* uri[CsmgrbenchC_Max_Contents];
+	char*	work_arg;
+	int i;
+	int err_f = 0;
+	uint64_t lookups_all = 0;
+	uint64_t cobs = 0;
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	struct timeval t_start, t_end;
+	double elapsed;
+
+	/***** flags 		*****/
+	int host_f 			= 0;
+	int port_f 			= 0;
+
+	/***** parameters 	*****/
+	int link_ver 		= CefC_Csmgr_Link_Ver2;
+	uint32_t lookups 	= CsmgrbenchC_Default_Lookups;
+	uint32_t chunks 	= CsmgrbenchC_Default_Chunks;
+	int thread_num 		= 1;
+
+	/* Obtains options 		*/
+	for (i = 1 ; i < argc ; i++) {
+
+		work_arg = argv[i];
+		if (work_arg == NULL || work_arg[0] == 0) {
+			break;
+		}
+
+		if ((strcmp (work_arg, "-h") == 0) && (i + 1 < argc)) {
+			if (host_f) {
+				printerr("host is duplicated.\n");
+				USAGE;
+				return (-1);
+			}
+			strncpy (bench_dst, argv[++i], sizeof (bench_dst) - 1);
+			host_f++;
+		} else if ((strcmp (work_arg, "-p") == 0) && (i + 1 < argc)) {
+			if (port_f) {
+				printerr("port is duplicated.\n");
+				USAGE;
+				return (-1);
+			}
+			strncpy (bench_port_str, argv[++i], sizeof (bench_port_str) - 1);
+			port_f++;
+		} else if ((strcmp (work_arg, "-v") == 0) && (i + 1 < argc)) {
+			link_ver = atoi (argv[++i]);
+			if ((link_ver != CefC_Csmgr_Link_Ver1) && (link_ver != CefC_Csmgr_Link_Ver2)) {
+				printerr("link version must be 1 or 2.\n");
+				USAGE;
+				return (-1);
+			}
+		} else if ((strcmp (work_arg, "-n") == 0) && (i + 1 < argc)) {
+			lookups = (uint32_t) strtoul (argv[++i], NULL, 10);
+			if (lookups == 0) {
+				printerr("number of lookups must be higher than 0.\n");
+				USAGE;
+				return (-1);
+			}
+		} else if ((strcmp (work_arg, "-c") == 0) && (i + 1 < argc)) {
+			chunks = (uint32_t) strtoul (argv[++i], NULL, 10);
+			if (chunks == 0) {
+				printerr("number of chunks must be higher than 0.\n");
+				USAGE;
+				return (-1);
+			}
+		} else if ((strcmp (work_arg, "-t") == 0) && (i + 1 < argc)) {
+			thread_num = atoi (argv[++i]);
+			if ((thread_num < 1) || (thread_num > CsmgrbenchC_Max_Threads)) {
+				printerr("number of threads must be 1 to %d.\n", CsmgrbenchC_Max_Threads);
+				USAGE;
+				return (-1);
+			}
+		} else if (work_arg[0] == '-') {
+			printerr("unknown option is specified.\n");
+			USAGE;
+			return (-1);
+		} else {
+			if (bench_cont_num == CsmgrbenchC_Max_Contents) {
+				printerr("too many uris are specified (max %d).\n", CsmgrbenchC_Max_Contents);
+				USAGE;
+				return (-1);
+			}
+			if (strlen (work_arg) >= CefC_NAME_MAXLEN) {
+				printerr("uri is too long.\n");
+				USAGE;
+				return (-1);
+			}
+			uri[bench_cont_num] = work_arg;
+			bench_cont_num++;
+		}
+	}
+	if (bench_cont_num == 0) {
+		printerr("uri is not specified.\n");
+		USAGE;
+		return (-1);
+	}
+	if (port_f == 0) {
+		sprintf (bench_port_str, "%d", CefC_Default_Tcp_Prot);
+	}
+	if (host_f == 0) {
+		strcpy (bench_dst, "127.0.0.1");
+	}
+
+	cef_frame_init ();
+	for (i = 0 ; i < bench_cont_num ; i++) {
+		bench_name_len[i] = cef_frame_conversion_uri_to_name (uri[i], bench_name[i]);
+		if (bench_name_len[i] <= 0) {
+			printerr("URI is Invalid (%s)\n", uri[i]);
+			return (-1);
+		}
+	}
+
+	/* Each thread has its own connection to csmgrd 	*/
+	ths = (CsmgrbenchT_Thread*) calloc (thread_num, sizeof (CsmgrbenchT_Thread));
+	if (ths == NULL) {
+		printerr("Failed to allocate the threads\n");
+		return (-1);
+	}
+	for (i = 0 ; i < thread_num ; i++) {
+		ths[i].index 	= i;
+		ths[i].link_ver = link_ver;
+		ths[i].lookups 	= lookups;
+		ths[i].chunks 	= chunks;
+		ths[i].link.sock = cef_csmgr_connect_tcp_to_csmgr (bench_dst, bench_port_str);
+		if (ths[i].link.sock < 1) {
+			printerr("Connection failed to %s:%s\n", bench_dst, bench_port_str);
+			for (i-- ; i >= 0 ; i--) {
+				close (ths[i].link.sock);
+			}
+			free (ths);
+			return (-1);
+		}
+		ths[i].link.credit = CefC_Csmgr_Link_Credit;
+	}
+
+	gettimeofday (&t_start, NULL);
+
+	if (thread_num == 1) {
+		bench_thread (&ths[0]);
+	} else {
+		for (i = 0 ; i < thread_num ; i++) {
+			if (pthread_create (&ths[i].th, NULL, bench_thread, &ths[i]) != 0) {
+				printerr("Failed to create the thread\n");
+				ths[i].res = -1;
+				close (ths[i].link.sock);
+				ths[i].link.sock = -1;
+			}
+		}
+		for (i = 0 ; i < thread_num ; i++) {
+			if (ths[i].link.sock >= 0) {
+				pthread_join (ths[i].th, NULL);
+			}
+		}
+	}
+
+	/* The run ends when the last thread has finished 	*/
+	t_end = t_start;
+	for (i = 0 ; i < thread_num ; i++) {
+		if (ths[i].res < 0) {
+			err_f = 1;
+			continue;
+		}
+		if (timercmp (&ths[i].t_end, &t_end, >)) {
+			t_end = ths[i].t_end;
+		}
+		lookups_all += lookups;
+		cobs 	+= ths[i].link.cobs;
+		hits 	+= ths[i].link.hits;
+		misses 	+= ths[i].link.misses;
+	}
+
+	elapsed = (double)(t_end.tv_sec - t_start.tv_sec)
+				+ (double)(t_end.tv_usec - t_start.tv_usec) / 1000000.0;
+	if (elapsed <= 0) {
+		elapsed = 0.000001;
+	}
+	fprintf (stdout, "Link Version : %d\n", link_ver);
+	fprintf (stdout, "Contents     : %d\n", bench_cont_num);
+	fprintf (stdout, "Threads      : %d\n", thread_num);
+	fprintf (stdout, "Lookups      : "FMTU64"\n", lookups_all);
+	fprintf (stdout, "Elapsed Time : %.3f sec\n", elapsed);
+	fprintf (stdout, "Lookups/sec  : %.0f\n", (double) lookups_all / elapsed);
+	fprintf (stdout, "Cobs         : "FMTU64"\n", cobs);
+	if (link_ver == CefC_Csmgr_Link_Ver2) {
+		fprintf (stdout, "Answers      : hit "FMTU64", miss "FMTU64"\n", hits, misses);
+	}
+	free (ths);
+
+	return (err_f ? -1 : 0);
+}
+/*--------------------------------------------------------------------------------------
+	Sends the lookups of a thread and receives the answers
+----------------------------------------------------------------------------------------*/
+static void*
+bench_thread (
+	void* arg
+) {
+	CsmgrbenchT_Thread* th = (CsmgrbenchT_Thread*) arg;
+	CsmgrbenchT_Link* link = &th->link;
+	unsigned char buff[CefC_Csmgr_Link_Batch_Size];
+	unsigned char msg[CefC_Max_Length];
+	uint16_t msg_len;
+	uint16_t value16;
+	uint32_t value32;
+	uint32_t sent = 0;
+	uint32_t req_id = 1;
+	int index;
+	int cont;
+	int res;
+
+	/* Sends the lookups of the chunks 0 to (chunks - 1) in turn. When several 	*/
+	/* URIs are specified, the lookups of the contents are interleaved as if 	*/
+	/* a consumer of each content were downloading it at the same time. Each 	*/
+	/* thread starts from another content, so that the threads look up 		*/
+	/* different contents at the same time 									*/
+	if (th->link_ver == CefC_Csmgr_Link_Ver1) {
+		/* One message per write, as cefnetd did before the batches 	*/
+		for (sent = 0 ; sent < th->lookups ; sent++) {
+			cont = (sent + th->index) % bench_cont_num;
+			msg_len = interest_msg_create (msg, bench_name[cont],
+						bench_name_len[cont], (sent / bench_cont_num) % th->chunks);
+			if (link_send (link, msg, msg_len) < 0) {
+				goto ERROR;
+			}
+			if (link_recv (link, 0) < 0) {
+				goto ERROR;
+			}
+		}
+		/* The echo response follows the Cobs of all the lookups. Since csmgrd 	*/
+		/* drops the messages which it cannot send, the end is also detected 	*/
+		/* by the silence of the link 											*/
+		msg[CefC_O_Fix_Ver]  = CefC_Version;
+		msg[CefC_O_Fix_Type] = CefC_Csmgr_Msg_Type_Echo;
+		value16 = htons (CefC_Csmgr_Msg_HeaderLen);
+		memcpy (&msg[CefC_O_Fix_PacketLength], &value16, CefC_S_Length);
+		if (link_send (link, msg, CefC_Csmgr_Msg_HeaderLen) < 0) {
+			goto ERROR;
+		}
+		while (link->echo_f == 0) {
+			res = link_recv (link, CsmgrbenchC_Idle_Time);
+			if (res < 0) {
+				goto ERROR;
+			}
+			if (res == 0) {
+				fprintf (stdout, "No echo response from csmgrd\n");
+				break;
+			}
+		}
+	} else {
+		while (link->hits + link->misses < th->lookups) {
+			/* Fills a batch within the credit 	*/
+			index = CefC_Csmgr_Msg_HeaderLen;
+			while ((sent < th->lookups) &&
+				   (sent - (link->hits + link->misses) < link->credit)) {
+				cont = (sent + th->index) % bench_cont_num;
+				msg_len = interest_msg_create (msg, bench_name[cont],
+							bench_name_len[cont], (sent / bench_cont_num) % th->chunks);
+				if (index + CefC_Csmgr_Link_ReqId_Len + msg_len > CefC_Csmgr_Link_Batch_Size) {
+					break;
+				}
+				value32 = htonl (req_id++);
+				memcpy (&buff[index], &value32, sizeof (uint32_t));
+				memcpy (&buff[index + CefC_Csmgr_Link_ReqId_Len], msg, msg_len);
+				index += CefC_Csmgr_Link_ReqId_Len + msg_len;
+				sent++;
+			}
+			if (index > CefC_Csmgr_Msg_HeaderLen) {
+				buff[CefC_O_Fix_Ver]  = CefC_Version;
+				buff[CefC_O_Fix_Type] = CefC_Csmgr_Msg_Type_Batch;
+				value16 = htons ((uint16_t) index);
+				memcpy (&buff[CefC_O_Fix_PacketLength], &value16, CefC_S_Length);
+				if (link_send (link, buff, index) < 0) {
+					goto ERROR;
+				}
+				res = link_recv (link, 0);
+			} else {
+				res = link_recv (link, CsmgrbenchC_Wait_Time);
+			}
+			if (res < 0) {
+				goto ERROR;
+			}
+		}
+	}
+	gettimeofday (&th->t_end, NULL);
+	if ((th->link_ver == CefC_Csmgr_Link_Ver1) && (link->echo_f == 0) && (link->cobs > 0)) {
+		th->t_end = link->rcv_t;
+	}
+	close (link->sock);
+	th->res = 0;
+	return (NULL);
+
+ERROR:;
+	printerr("csmgrd did not respond (%u lookups sent, "FMTU64" Cobs received)\n"
+		, sent, link->cobs);
+	close (link->sock);
+	th->res = -1;
+	return (NULL);
+}
+/*--------------------------------------------------------------------------------------
+	Creates the csmgr Interest message for the chunk
+----------------------------------------------------------------------------------------*/
+static uint16_t								/* Length of the message					*/
+interest_msg_create (
+	unsigned char* buff,
+	const unsigned char* name,
+	uint16_t name_len,
+	uint32_t chunk_num
+) {
+	uint16_t index = CefC_Csmgr_Msg_HeaderLen;
+	uint16_t value16;
+	uint32_t value32;
+
+	buff[CefC_O_Fix_Ver]  = CefC_Version;
+	buff[CefC_O_Fix_Type] = CefC_Csmgr_Msg_Type_Interest;
+
+	buff[index++] = CefC_Csmgr_Interest_Type_Normal;
+	buff[index++] = CefC_Csmgr_Interest_ChunkNum_Exist;
+
+	value16 = htons (name_len);
+	memcpy (&buff[index], &value16, CefC_S_Length);
+	memcpy (&buff[index + CefC_S_Length], name, name_len);
+	index += CefC_S_Length + name_len;
+
+	value32 = htonl (chunk_num);
+	memcpy (&buff[index], &value32, CefC_S_ChunkNum);
+	index += CefC_S_ChunkNum;
+
+	/* No version, Plain Text and signature 	*/
+	memset (&buff[index], 0, CefC_S_Length * 3);
+	index += CefC_S_Length * 3;
+
+	value16 = htons (index);
+	memcpy (&buff[CefC_O_Fix_PacketLength], &value16, CefC_S_Length);
+
+	return (index);
+}
+/*--------------------------------------------------------------------------------------
+	Sends the message to csmgrd
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+link_send (
+	CsmgrbenchT_Link* link,
+	const unsigned char* msg,
+	int msg_len
+) {
+	struct pollfd fds[1];
+	int res;
+
+	while (msg_len > 0) {
+		res = send (link->sock, msg, msg_len, MSG_DONTWAIT);
+		if (res > 0) {
+			msg += res;
+			msg_len -= res;
+			continue;
+		}
+		if ((res < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+			printerr("Send message error (%s)\n", strerror (errno));
+			return (-1);
+		}
+		/* Drains the Cobs so that csmgrd can go on reading 	*/
+		if (link_recv (link, 0) < 0) {
+			return (-1);
+		}
+		fds[0].fd = link->sock;
+		fds[0].events = POLLOUT;
+		poll (fds, 1, 1);
+	}
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Receives the messages from csmgrd
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+link_recv (
+	CsmgrbenchT_Link* link,
+	int timeout									/* msec									*/
+) {
+	struct pollfd fds[1];
+	uint16_t value16;
+	uint16_t len;
+	int index;
+	int res;
+	int rcvd = 0;
+
+	fds[0].fd = link->sock;
+	fds[0].events = POLLIN | POLLERR;
+
+	while (poll (fds, 1, timeout) > 0) {
+		res = recv (link->sock, &link->rcv_buff[link->rcv_len],
+				sizeof (link->rcv_buff) - link->rcv_len, MSG_DONTWAIT);
+		if (res <= 0) {
+			if ((res < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+				break;
+			}
+			printerr("Connection closed by csmgrd\n");
+			return (-1);
+		}
+		link->rcv_len += res;
+		rcvd += res;
+		timeout = 0;
+		gettimeofday (&link->rcv_t, NULL);
+
+		/* Cobs, answers and the echo response all carry the length at the 	*/
+		/* same offset as the CCNx fixed header 								*/
+		index = 0;
+		while (link->rcv_len - index >= CefC_Csmgr_Msg_HeaderLen) {
+			memcpy (&value16, &link->rcv_buff[index + CefC_O_Fix_PacketLength], CefC_S_Length);
+			len = ntohs (value16);
+			if (len < CefC_Csmgr_Msg_HeaderLen) {
+				printerr("Broken message from csmgrd\n");
+				return (-1);
+			}
+			if (index + len > link->rcv_len) {
+				break;
+			}
+			switch (link->rcv_buff[index + CefC_O_Fix_Type]) {
+				case CefC_PT_OBJECT: {
+					link->cobs++;
+					break;
+				}
+				case CefC_Csmgr_Msg_Type_Echo: {
+					link->echo_f = 1;
+					break;
+				}
+				case CefC_Csmgr_PT_Answer: {
+					int n;
+
+					memcpy (&value16,
+						&link->rcv_buff[index + CefC_O_Csmgr_Answer_Credit], sizeof (uint16_t));
+					link->credit = ntohs (value16);
+					for (n = CefC_Csmgr_Answer_HeaderLen ;
+							n + CefC_Csmgr_Link_Answer_Len <= len ;
+							n += CefC_Csmgr_Link_Answer_Len) {
+						if (link->rcv_buff[index + n + CefC_Csmgr_Link_ReqId_Len]
+								== CefC_Csmgr_Cob_Exist) {
+							link->hits++;
+						} else {
+							link->misses++;
+						}
+					}
+					break;
+				}
+				default: {
+					break;
+				}
+			}
+			index += len;
+		}
+		if (index > 0) {
+			memmove (link->rcv_buff, &link->rcv_buff[index], link->rcv_len - index);
+			link->rcv_len -= index;
+		}
+	}
+	return (rcvd);
+}
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+) {
+	fprintf (ofp,
+		"\n\nUsage: csmgrbench\n\n"
+		"  csmgrbench uri [uri ...] [-h host] [-p port] [-v version] [-n lookups] [-c chunks]\n"
+		"             [-t threads]\n\n"
+		"  uri      Name of the content to look up. When up to 16 uris are specified,\n"
+		"           the lookups of the contents are interleaved.\n"
+		"  host     Specify the host identifier (e.g., IP address) on which csmgrd \n"
+		"           is running. The default value is localhost (i.e., 127.0.0.1).\n"
+		"  port     Port number to connect csmgrd. The default value is 9799.\n"
+		"  version  Link protocol between cefnetd and csmgrd (1 or 2).\n"
+		"           The default value is 2.\n"
+		"  lookups  Number of lookups each thread sends. The default value is 100000.\n"
+		"  chunks   Lookups go round the chunks 0 to (chunks - 1).\n"
+		"           The default value is 1000.\n"
+		"  threads  Number of threads, each of which connects to csmgrd and sends\n"
+		"           the lookups at the same time (1 to 16). The default value is 1.\n\n"
+	);
+	return;
+}
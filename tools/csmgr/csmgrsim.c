@@ -0,0 +1,487 @@
+/*
+ * Copyright (c) 2016-2023, National Institute of Information and Communications
+ * Technology (NICT). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the NICT nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NICT AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE NICT OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+/*
+ * csmgrsim.c
+ */
+
+#define __CSMGR_SIM_SOURCE__
+
+/****************************************************************************************
+ Include Files
+ ****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <sys/time.h>
+#include <cefore/cef_frame.h>
+#include <cefore/cef_hash.h>
+#include <csmgrd/csmgrd_plugin.h>
+
+
+
+/****************************************************************************************
+ Macros
+ ****************************************************************************************/
+#define	USAGE			print_usage(CefFp_Usage)
+#define	printerr(...)	fprintf(stderr,"[csmgrsim] ERROR: " __VA_ARGS__)
+
+#ifdef __APPLE__
+#define CsmgrsimC_Library_Name	".dylib"
+#else // __APPLE__
+#define CsmgrsimC_Library_Name	".so"
+#endif // __APPLE__
+
+#define CsmgrsimC_Default_Capacity	10000
+#define CsmgrsimC_Max_Libs			16			/* Max number of libraries			*/
+#define CsmgrsimC_Line_Max			(CefC_NAME_MAXLEN + 64)
+
+/****************************************************************************************
+ Structures Declaration
+ ****************************************************************************************/
+
+/***** content requested in the trace *****/
+typedef struct {
+	unsigned char*	name;						/* Name of the content					*/
+	uint16_t		name_len;					/* Length of the name					*/
+} CsmgrsimT_Name;
+
+/***** request read from the trace *****/
+typedef struct {
+	uint32_t		name_idx;					/* Index of CsmgrsimT_Name				*/
+	uint32_t		chunk_num;					/* Chunk number							*/
+} CsmgrsimT_Request;
+
+/****************************************************************************************
+ State Variables
+ ****************************************************************************************/
+
+static CefT_Hash_Handle sim_cache = 0;			/* Keys of the cached Cobs				*/
+static uint64_t sim_evictions = 0;				/* Cobs removed by the library			*/
+
+/****************************************************************************************
+ Static Function Declaration
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+);
+/*--------------------------------------------------------------------------------------
+	Reads the requests from the trace
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+trace_read (
+	const char* path,
+	CsmgrsimT_Name** names,
+	uint32_t* name_num,
+	CsmgrsimT_Request** reqs,
+	uint32_t* req_num
+);
+/*--------------------------------------------------------------------------------------
+	Replays the requests against the library
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+trace_replay (
+	const char* lib_name,
+	int capacity,
+	int chunk_aware,
+	const CsmgrsimT_Name* names,
+	const CsmgrsimT_Request* reqs,
+	uint32_t req_num
+);
+/*--------------------------------------------------------------------------------------
+	Store API given to the library
+----------------------------------------------------------------------------------------*/
+static int
+sim_store (
+	CsmgrdT_Content_Entry* entry
+);
+/*--------------------------------------------------------------------------------------
+	Remove API given to the library
+----------------------------------------------------------------------------------------*/
+static void
+sim_remove (
+	unsigned char* key,
+	int key_len
+);
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+);
+
+
+/****************************************************************************************
+ ****************************************************************************************/
+int
+main (
+	int argc,
+	char** argv
+) {
+	static const char* def_libs[] = {
+		"libcsmgrd_fifo", "libcsmgrd_lru", "libcsmgrd_lfu",
+		"libcsmgrd_arc", "libcsmgrd_s3fifo", "libcsmgrd_wtinylfu", NULL
+	};
+	const char* libs[CsmgrsimC_Max_Libs];
+	int lib_num = 0;
+	char* trace = NULL;
+	char* work_arg;
+	CsmgrsimT_Name* names = NULL;
+	CsmgrsimT_Request* reqs = NULL;
+	uint32_t name_num = 0;
+	uint32_t req_num = 0;
+	uint32_t n;
+	int i;
+	int res = 0;
+
+	/***** flags 		*****/
+	int chunk_aware_f	= 0;
+
+	/***** parameters 	*****/
+	int capacity 		= CsmgrsimC_Default_Capacity;
+
+	/* Obtains options 		*/
+	for (i = 1 ; i < argc ; i++) {
+
+		work_arg = argv[i];
+		if (work_arg == NULL || work_arg[0] == 0) {
+			break;
+		}
+
+		if ((strcmp (work_arg, "-c") == 0) && (i + 1 < argc)) {
+			capacity = atoi (argv[++i]);
+			if (capacity <= 0) {
+				printerr("capacity must be higher than 0.\n");
+				USAGE;
+				return (-1);
+			}
+		} else if ((strcmp (work_arg, "-l") == 0) && (i + 1 < argc)) {
+			if (lib_num == CsmgrsimC_Max_Libs) {
+				printerr("too many libraries are specified (max %d).\n", CsmgrsimC_Max_Libs);
+				USAGE;
+				return (-1);
+			}
+			libs[lib_num] = argv[++i];
+			lib_num++;
+		} else if (strcmp (work_arg, "-a") == 0) {
+			chunk_aware_f++;
+		} else if (work_arg[0] == '-') {
+			printerr("unknown option is specified.\n");
+			USAGE;
+			return (-1);
+		} else {
+			if (trace) {
+				printerr("trace is duplicated.\n");
+				USAGE;
+				return (-1);
+			}
+			trace = work_arg;
+		}
+	}
+	if (trace == NULL) {
+		printerr("trace is not specified.\n");
+		USAGE;
+		return (-1);
+	}
+	if (lib_num == 0) {
+		for (lib_num = 0 ; def_libs[lib_num] ; lib_num++) {
+			libs[lib_num] = def_libs[lib_num];
+		}
+	}
+
+	cef_frame_init ();
+	if (trace_read (trace, &names, &name_num, &reqs, &req_num) < 0) {
+		return (-1);
+	}
+	fprintf (stdout, "Trace    : %s (%u requests, %u contents)\n", trace, req_num, name_num);
+	fprintf (stdout, "Capacity : %d Cobs%s\n\n", capacity,
+		chunk_aware_f ? ", chunk-aware mode" : "");
+	fprintf (stdout, "%-24s %12s %12s %12s %10s %10s\n",
+		"Library", "Requests", "Hits", "Evictions", "Hit Ratio", "Time(s)");
+
+	for (i = 0 ; i < lib_num ; i++) {
+		if (trace_replay (libs[i], capacity, chunk_aware_f, names, reqs, req_num) < 0) {
+			res = -1;
+		}
+	}
+
+	for (n = 0 ; n < name_num ; n++) {
+		free (names[n].name);
+	}
+	free (names);
+	free (reqs);
+	return (res);
+}
+/*--------------------------------------------------------------------------------------
+	Reads the requests from the trace
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+trace_read (
+	const char* path,
+	CsmgrsimT_Name** names,
+	uint32_t* name_num,
+	CsmgrsimT_Request** reqs,
+	uint32_t* req_num
+) {
+	FILE* fp;
+	char line[CsmgrsimC_Line_Max];
+	unsigned char name[CefC_Max_Length];
+	char* uri;
+	char* chunk;
+	char* save;
+	int name_len;
+	uint32_t name_max = 0;
+	uint32_t req_max = 0;
+	uint32_t lineno = 0;
+	void* val;
+	CefT_Hash_Handle tbl;
+
+	fp = fopen (path, "r");
+	if (fp == NULL) {
+		printerr("Failed to open %s\n", path);
+		return (-1);
+	}
+	tbl = cef_lhash_tbl_create (65536);
+
+	/* Each line is "uri [chunk]", the chunk number is 0 if it is omitted. The 	*/
+	/* lines starting with '#' are ignored 										*/
+	while (fgets (line, sizeof (line), fp) != NULL) {
+		lineno++;
+		uri = strtok_r (line, " \t\r\n", &save);
+		if (uri == NULL || uri[0] == '#') {
+			continue;
+		}
+		chunk = strtok_r (NULL, " \t\r\n", &save);
+
+		val = cef_lhash_tbl_item_get (tbl, (unsigned char*) uri, strlen (uri));
+		if (val == NULL) {
+			name_len = cef_frame_conversion_uri_to_name (uri, name);
+			if (name_len <= 0) {
+				printerr("URI is Invalid (%s:%u)\n", path, lineno);
+				goto ERROR;
+			}
+			if (*name_num == name_max) {
+				name_max = name_max ? name_max * 2 : 1024;
+				*names = (CsmgrsimT_Name*) realloc (*names, sizeof (CsmgrsimT_Name) * name_max);
+				if (*names == NULL) {
+					printerr("Failed to allocate the names\n");
+					goto ERROR;
+				}
+			}
+			(*names)[*name_num].name = (unsigned char*) malloc (name_len);
+			if ((*names)[*name_num].name == NULL) {
+				printerr("Failed to allocate the names\n");
+				goto ERROR;
+			}
+			memcpy ((*names)[*name_num].name, name, name_len);
+			(*names)[*name_num].name_len = (uint16_t) name_len;
+			(*name_num)++;
+			/* The index is stored plus 1 not to be NULL 	*/
+			val = (void*)(uintptr_t) *name_num;
+			cef_lhash_tbl_item_set (tbl, (unsigned char*) uri, strlen (uri), val);
+		}
+
+		if (*req_num == req_max) {
+			req_max = req_max ? req_max * 2 : 65536;
+			*reqs = (CsmgrsimT_Request*) realloc (*reqs, sizeof (CsmgrsimT_Request) * req_max);
+			if (*reqs == NULL) {
+				printerr("Failed to allocate the requests\n");
+				goto ERROR;
+			}
+		}
+		(*reqs)[*req_num].name_idx = (uint32_t)(uintptr_t) val - 1;
+		(*reqs)[*req_num].chunk_num = chunk ? (uint32_t) strtoul (chunk, NULL, 10) : 0;
+		(*req_num)++;
+	}
+	cef_lhash_tbl_destroy (tbl);
+	fclose (fp);
+
+	if (*req_num == 0) {
+		printerr("No request in %s\n", path);
+		return (-1);
+	}
+	return (0);
+
+ERROR:
+	cef_lhash_tbl_destroy (tbl);
+	fclose (fp);
+	return (-1);
+}
+/*--------------------------------------------------------------------------------------
+	Replays the requests against the library
+----------------------------------------------------------------------------------------*/
+static int							/* The return value is negative if an error occurs	*/
+trace_replay (
+	const char* lib_name,
+	int capacity,
+	int chunk_aware,
+	const CsmgrsimT_Name* names,
+	const CsmgrsimT_Request* reqs,
+	uint32_t req_num
+) {
+	char path[1024];
+	void* lib = NULL;
+	CsmgrdT_Lib_Interface apis;
+	CsmgrdT_Content_Entry entry;
+	unsigned char key[CsmgrdC_Key_Max];
+	int key_len;
+	void* val;
+	uint64_t hits = 0;
+	uint32_t n;
+	struct timeval t_start, t_end;
+	double elapsed;
+
+	/* A name without '/' is looked up like CACHE_ALGORITHM in csmgrd.conf 	*/
+	if (strchr (lib_name, '/')) {
+		snprintf (path, sizeof (path), "%s", lib_name);
+	} else {
+		snprintf (path, sizeof (path), "%s%s", lib_name, CsmgrsimC_Library_Name);
+	}
+	memset (&apis, 0, sizeof (CsmgrdT_Lib_Interface));
+	if (csmgrd_lib_api_get (path, &lib, &apis) < 0 ||
+		!apis.init || !apis.insert || !apis.hit || !apis.miss) {
+		printerr("Failed to load %s (%s)\n", path, lib ? "missing APIs" : dlerror ());
+		goto ERROR;
+	}
+	if (chunk_aware) {
+		if (apis.mode_set) {
+			(*apis.mode_set)(CsmgrdC_Lib_Mode_Chunk_Aware);
+		} else {
+			fprintf (stderr, "[csmgrsim] %s does not support the chunk-aware mode\n", lib_name);
+		}
+	}
+
+	sim_cache = cef_lhash_tbl_create_ext (capacity, CefC_Hash_Coef_Cache);
+	sim_evictions = 0;
+	if ((*apis.init)(capacity, sim_store, sim_remove) < 0) {
+		printerr("Failed to initialize %s\n", lib_name);
+		goto ERROR;
+	}
+
+	/* A miss is followed by the insert of the Cob, as the Cob forwarded to the 	*/
+	/* consumer is cached 															*/
+	gettimeofday (&t_start, NULL);
+	memset (&entry, 0, sizeof (CsmgrdT_Content_Entry));
+	for (n = 0 ; n < req_num ; n++) {
+		entry.name 		= names[reqs[n].name_idx].name;
+		entry.name_len 	= names[reqs[n].name_idx].name_len;
+		entry.chunk_num = reqs[n].chunk_num;
+		key_len = csmgrd_key_create (&entry, key);
+
+		val = cef_lhash_tbl_item_get (sim_cache, key, key_len);
+		if (val) {
+			hits++;
+			if (apis.hit_by_handle) {
+				(*apis.hit_by_handle)(val);
+			} else {
+				(*apis.hit)(key, key_len);
+			}
+		} else {
+			(*apis.miss)(key, key_len);
+			entry.algo_h = NULL;
+			(*apis.insert)(&entry);
+		}
+	}
+	gettimeofday (&t_end, NULL);
+	elapsed = (double)(t_end.tv_sec - t_start.tv_sec)
+				+ (double)(t_end.tv_usec - t_start.tv_usec) / 1000000.0;
+
+	fprintf (stdout, "%-24s %12u %12"PRIu64" %12"PRIu64" %8.2f %% %10.3f\n",
+		lib_name, req_num, hits, sim_evictions, (double) hits * 100.0 / req_num, elapsed);
+
+	if (apis.destroy) {
+		(*apis.destroy)();
+	}
+	cef_lhash_tbl_destroy (sim_cache);
+	sim_cache = 0;
+	dlclose (lib);
+	return (0);
+
+ERROR:
+	if (sim_cache) {
+		cef_lhash_tbl_destroy (sim_cache);
+		sim_cache = 0;
+	}
+	if (lib) {
+		dlclose (lib);
+	}
+	return (-1);
+}
+/*--------------------------------------------------------------------------------------
+	Store API given to the library
+----------------------------------------------------------------------------------------*/
+static int
+sim_store (
+	CsmgrdT_Content_Entry* entry
+) {
+	unsigned char key[CsmgrdC_Key_Max];
+	int key_len;
+
+	key_len = csmgrd_key_create (entry, key);
+	/* Keeps the handle set by the library to give it to the handle APIs 	*/
+	cef_lhash_tbl_item_set (sim_cache, key, key_len,
+		entry->algo_h ? entry->algo_h : (void*) sim_cache);
+	return (0);
+}
+/*--------------------------------------------------------------------------------------
+	Remove API given to the library
+----------------------------------------------------------------------------------------*/
+static void
+sim_remove (
+	unsigned char* key,
+	int key_len
+) {
+	if (cef_lhash_tbl_item_remove (sim_cache, key, key_len)) {
+		sim_evictions++;
+	}
+}
+/*--------------------------------------------------------------------------------------
+	Output Usage
+----------------------------------------------------------------------------------------*/
+static void
+print_usage (
+	FILE* ofp
+) {
+	fprintf (ofp,
+		"\n\nUsage: csmgrsim\n\n"
+		"  csmgrsim trace [-c capacity] [-a] [-l library ...]\n\n"
+		"  trace     File of the requests. Each line is \"uri [chunk]\", and the\n"
+		"            chunk number is 0 if it is omitted. Every miss inserts the Cob.\n"
+		"  capacity  Number of the Cobs the cache holds. The default value is 10000.\n"
+		"  -a        Runs the libraries in the chunk-aware mode, in which the chunks\n"
+		"            of a content are treated as one entry.\n"
+		"  library   Cache algorithm library as CACHE_ALGORITHM (e.g. libcsmgrd_lru),\n"
+		"            or path of the library. -l can be repeated. By default, fifo,\n"
+		"            lru, lfu, arc, s3fifo and wtinylfu are compared.\n\n"
+	);
+	return;
+}
@@ -294,6 +294,7 @@ main (
 	if (stt_f) {
 		option |= CefC_Csmgr_Stat_Opt_Range;
 	}
+	option |= CefC_Csmgr_Stat_Opt_Memory;
 	buff[index] = option;
 	index++;
 	if (stt_f) {
@@ -451,6 +452,7 @@ output_result (
 	int32_t	disp_stt
 ) {
 	struct CefT_Csmgr_Status_Hdr stat_hdr;
+	struct CefT_Csmgr_Status_Mem stat_mem;
 	struct CefT_Csmgr_Status_Rep stat_rep;
 	unsigned char name[CefC_Max_Length];
 	char get_uri[CefC_Max_Length];
@@ -472,6 +474,36 @@ output_result (
 	fprintf (ofp, "Number of Cached Contents      : %d\n\n", stat_hdr.con_num);
 	index += sizeof (struct CefT_Csmgr_Status_Hdr);
 
+	if (frame_size - index < sizeof (struct CefT_Csmgr_Status_Mem)) {
+		return;
+	}
+	memcpy (&stat_mem, &frame[index], sizeof (struct CefT_Csmgr_Status_Mem));
+	index += sizeof (struct CefT_Csmgr_Status_Mem);
+	if (ntohs (stat_mem.mem_f)) {
+		uint64_t slab_bytes  = cef_client_ntohb (stat_mem.slab_bytes);
+		uint64_t block_bytes = cef_client_ntohb (stat_mem.block_bytes);
+		uint64_t large_bytes = cef_client_ntohb (stat_mem.large_bytes);
+		uint64_t index_bytes = cef_client_ntohb (stat_mem.index_bytes);
+
+		fprintf (ofp, "*****   Cache Memory Report        *****\n");
+		fprintf (ofp, "Number of Cached Cobs          : %llu\n",
+			(unsigned long long) cef_client_ntohb (stat_mem.cob_num));
+		fprintf (ofp, "Entries                        : %llu Bytes\n",
+			(unsigned long long) cef_client_ntohb (stat_mem.entry_bytes));
+		fprintf (ofp, "Allocated Blocks               : %llu Bytes\n",
+			(unsigned long long) block_bytes);
+		fprintf (ofp, "Slabs                          : %llu Bytes (%llu slabs, %.1f%% used)\n",
+			(unsigned long long) slab_bytes,
+			(unsigned long long) cef_client_ntohb (stat_mem.slab_num),
+			slab_bytes ? (double)(block_bytes - large_bytes) * 100.0 / slab_bytes : 0.0);
+		fprintf (ofp, "Large Entries                  : %llu Bytes\n",
+			(unsigned long long) large_bytes);
+		fprintf (ofp, "Lookup Table                   : %llu Bytes\n",
+			(unsigned long long) index_bytes);
+		fprintf (ofp, "Total                          : %llu Bytes\n\n",
+			(unsigned long long)(slab_bytes + large_bytes + index_bytes));
+	}
+
 	while (index < frame_size) {
 		if (frame_size - index < sizeof (struct CefT_Csmgr_Status_Rep)) {
 			break;